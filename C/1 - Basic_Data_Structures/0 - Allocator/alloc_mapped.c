@@ -0,0 +1,501 @@
+/** @file alloc_mapped.c
+ *
+ * @brief Mapped allocator: one memory mapping per block, resized in place
+ *        or by mremap().
+ *
+ * Every block starts with a 64-byte header holding the length of its
+ * mapping, the size last asked for and its backing file, if any; the
+ * caller's memory follows it. Mappings are whole pages, or whole 2 MiB
+ * huge pages when they came from the MAP_HUGETLB pool, and never shorter
+ * than the reservation. A resize that fits the mapping only records the
+ * new size, and gives back any whole pages a shrink left unused. A resize
+ * that does not fit extends the backing file, if any, and remaps; only if
+ * that fails is a new block mapped and the contents copied.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "alloc_mapped.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define HEADER_BYTES    (64u)
+#define HUGETLB_BYTES   ((size_t)2u * 1024u * 1024u)
+#define BACKING_NAME    ("/alloc_mapped.XXXXXX")
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE   (0)
+#endif
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* At the start of every mapping, HEADER_BYTES before the caller's memory */
+typedef struct
+{
+    size_t   mapped;    /* Length of the mapping, header included */
+    size_t   size;      /* Bytes the caller asked for */
+    int      fd;        /* Backing file; -1 for anonymous memory */
+    bool     b_hugetlb; /* Mapped from the huge page pool */
+} block_header_t;
+
+struct alloc_mapped
+{
+    allocator_t           allocator; /* Handed to containers; p_ctx is us */
+    alloc_mapped_config_t config;
+    size_t                page_bytes;
+    alloc_mapped_stats_t  stats;
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void *           mapped_alloc(void *       p_ctx,
+                                     size_t       size,
+                                     const char * p_site);
+static void *           mapped_realloc(void *       p_ctx,
+                                       void *       p_old,
+                                       size_t       size,
+                                       const char * p_site);
+static void             mapped_free(void * p_ctx, void * p_ptr);
+static block_header_t * map_block(alloc_mapped_t * p_mapped, size_t size);
+static block_header_t * remap_block(alloc_mapped_t * p_mapped,
+                                    block_header_t * p_block,
+                                    size_t           mapped);
+static void             unmap_block(alloc_mapped_t * p_mapped,
+                                    block_header_t * p_block);
+static int              open_backing_file(const char * p_dir);
+static void             advise(const alloc_mapped_t * p_mapped,
+                               void *                 p_start,
+                               size_t                 length);
+static size_t           mapping_length(const alloc_mapped_t * p_mapped,
+                                       const block_header_t * p_block,
+                                       size_t                 size);
+static void             count_mapped(alloc_mapped_t * p_mapped,
+                                     size_t           old_mapped,
+                                     size_t           mapped);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Creates a mapped allocator.
+ *
+ * @param[in] p_config Configuration; NULL for the defaults
+ *
+ * @return Pointer to the allocator, or NULL on failure
+ */
+alloc_mapped_t *
+alloc_mapped_create(const alloc_mapped_config_t * p_config)
+{
+    alloc_mapped_t * p_mapped = calloc(1, sizeof(alloc_mapped_t));
+    if (NULL == p_mapped)
+    {
+        return NULL;
+    }
+
+    p_mapped->allocator.alloc_fn   = mapped_alloc;
+    p_mapped->allocator.realloc_fn = mapped_realloc;
+    p_mapped->allocator.free_fn    = mapped_free;
+    p_mapped->allocator.p_ctx      = p_mapped;
+
+    if (NULL != p_config)
+    {
+        p_mapped->config = *p_config;
+    }
+
+    long page_bytes = sysconf(_SC_PAGESIZE);
+    p_mapped->page_bytes = (page_bytes > 0) ? (size_t)page_bytes : 4096u;
+
+    return p_mapped;
+}
+
+/*!
+ * @brief The allocator to hand to a container.
+ *
+ * @param[in] p_mapped Mapped allocator
+ *
+ * @return Allocator that maps a block per allocation
+ */
+const allocator_t *
+alloc_mapped_allocator(alloc_mapped_t * p_mapped)
+{
+    return (NULL == p_mapped) ? NULL : &p_mapped->allocator;
+}
+
+/*!
+ * @brief Counters since the allocator was created.
+ *
+ * @param[in]  p_mapped Mapped allocator
+ * @param[out] p_stats  Counters
+ */
+void
+alloc_mapped_stats(const alloc_mapped_t * p_mapped,
+                   alloc_mapped_stats_t * p_stats)
+{
+    if ((NULL != p_mapped) && (NULL != p_stats))
+    {
+        *p_stats = p_mapped->stats;
+    }
+}
+
+/*!
+ * @brief Frees a mapped allocator.
+ *
+ * @param[in,out] pp_mapped Pointer to the allocator pointer; set to NULL
+ */
+void
+alloc_mapped_destroy(alloc_mapped_t ** pp_mapped)
+{
+    if (NULL != pp_mapped)
+    {
+        free(*pp_mapped);
+        *pp_mapped = NULL;
+    }
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static void *
+mapped_alloc(void * p_ctx, size_t size, const char * p_site)
+{
+    alloc_mapped_t * p_mapped = p_ctx;
+    (void)p_site;
+
+    if (0 == size)
+    {
+        return NULL;
+    }
+
+    block_header_t * p_block = map_block(p_mapped, size);
+    return (NULL == p_block) ? NULL : (uint8_t *)p_block + HEADER_BYTES;
+}
+
+static void *
+mapped_realloc(void * p_ctx, void * p_old, size_t size, const char * p_site)
+{
+    alloc_mapped_t * p_mapped = p_ctx;
+
+    if (NULL == p_old)
+    {
+        return mapped_alloc(p_ctx, size, p_site);
+    }
+
+    if (0 == size)
+    {
+        mapped_free(p_ctx, p_old);
+        return NULL;
+    }
+
+    block_header_t * p_block = (block_header_t *)((uint8_t *)p_old
+                                                  - HEADER_BYTES);
+    size_t           length  = mapping_length(p_mapped, p_block, size);
+
+    if (0 == length)
+    {
+        return NULL;
+    }
+
+    // Fits: the pages beyond what has been touched cost nothing until used
+    if (length <= p_block->mapped)
+    {
+        // Hand back a tail that has shrunk out of the reservation too
+        if ((length < p_block->mapped)
+            && (0 == munmap((uint8_t *)p_block + length,
+                            p_block->mapped - length)))
+        {
+            if (p_block->fd >= 0)
+            {
+                (void)ftruncate(p_block->fd, (off_t)length);
+            }
+
+            count_mapped(p_mapped, p_block->mapped, length);
+            p_block->mapped = length;
+        }
+
+        if (size > p_block->size)
+        {
+            p_mapped->stats.grows_reserved++;
+        }
+
+        p_block->size = size;
+        return p_old;
+    }
+
+    block_header_t * p_grown = remap_block(p_mapped, p_block, length);
+
+    if (NULL != p_grown)
+    {
+        p_mapped->stats.grows_remapped++;
+        p_grown->size = size;
+        return (uint8_t *)p_grown + HEADER_BYTES;
+    }
+
+    // The mapping could not be extended: copy, as realloc() would
+    p_grown = map_block(p_mapped, size);
+
+    if (NULL == p_grown)
+    {
+        return NULL;
+    }
+
+    p_mapped->stats.grows_copied++;
+    memcpy((uint8_t *)p_grown + HEADER_BYTES, p_old, p_block->size);
+    unmap_block(p_mapped, p_block);
+
+    return (uint8_t *)p_grown + HEADER_BYTES;
+}
+
+static void
+mapped_free(void * p_ctx, void * p_ptr)
+{
+    if (NULL != p_ptr)
+    {
+        unmap_block(p_ctx, (block_header_t *)((uint8_t *)p_ptr
+                                              - HEADER_BYTES));
+    }
+}
+
+/*!
+ * @brief Maps a block of size bytes, reserving the configured address
+ *        space if that is more.
+ *
+ * @return The block's header, or NULL on failure
+ */
+static block_header_t *
+map_block(alloc_mapped_t * p_mapped, size_t size)
+{
+    block_header_t   probe   = { 0u, 0u, -1, false };
+    const char *     p_dir   = p_mapped->config.p_backing_dir;
+    block_header_t * p_block = MAP_FAILED;
+    size_t           length  = 0u;
+
+#if defined(MAP_HUGETLB)
+    // Reserving the huge pages up front makes this fail while the pool is
+    // short, which is usually, rather than fault when they are first used
+    probe.b_hugetlb = p_mapped->config.b_hugetlb && (NULL == p_dir);
+    length          = mapping_length(p_mapped, &probe, size);
+
+    if (probe.b_hugetlb && (0u != length))
+    {
+        p_block = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+
+    if (MAP_FAILED == p_block)
+    {
+        probe.b_hugetlb = false;
+        length          = mapping_length(p_mapped, &probe, size);
+
+        if (0u == length)
+        {
+            return NULL;
+        }
+
+        if (NULL != p_dir)
+        {
+            probe.fd = open_backing_file(p_dir);
+
+            if ((probe.fd < 0) || (0 != ftruncate(probe.fd, (off_t)length)))
+            {
+                if (probe.fd >= 0)
+                {
+                    (void)close(probe.fd);
+                }
+
+                return NULL;
+            }
+        }
+
+        p_block = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                       (probe.fd < 0)
+                           ? (MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE)
+                           : MAP_SHARED,
+                       probe.fd, 0);
+    }
+
+    if (MAP_FAILED == p_block)
+    {
+        if (probe.fd >= 0)
+        {
+            (void)close(probe.fd);
+        }
+
+        return NULL;
+    }
+
+    advise(p_mapped, p_block, length);
+
+    *p_block        = probe;
+    p_block->mapped = length;
+    p_block->size   = size;
+
+    p_mapped->stats.maps++;
+    count_mapped(p_mapped, 0u, length);
+
+    return p_block;
+}
+
+/*!
+ * @brief Extends a block's mapping to mapped bytes without copying.
+ *
+ * @return The block's header, possibly moved, or NULL if the mapping
+ *         could not be extended (the block is then unchanged)
+ */
+static block_header_t *
+remap_block(alloc_mapped_t * p_mapped,
+            block_header_t * p_block,
+            size_t           mapped)
+{
+#if defined(MREMAP_MAYMOVE)
+    if ((p_block->fd >= 0) && (0 != ftruncate(p_block->fd, (off_t)mapped)))
+    {
+        return NULL;
+    }
+
+    size_t           old_mapped = p_block->mapped;
+    block_header_t * p_grown    = mremap(p_block, old_mapped, mapped,
+                                         MREMAP_MAYMOVE);
+
+    if (MAP_FAILED == p_grown)
+    {
+        // A file only ever needs to be as long as its mapping
+        if (p_block->fd >= 0)
+        {
+            (void)ftruncate(p_block->fd, (off_t)old_mapped);
+        }
+
+        return NULL;
+    }
+
+    advise(p_mapped, p_grown, mapped);
+    p_grown->mapped = mapped;
+    count_mapped(p_mapped, old_mapped, mapped);
+
+    return p_grown;
+#else
+    (void)p_mapped;
+    (void)p_block;
+    (void)mapped;
+    return NULL;
+#endif
+}
+
+static void
+unmap_block(alloc_mapped_t * p_mapped, block_header_t * p_block)
+{
+    int    fd     = p_block->fd;
+    size_t mapped = p_block->mapped;
+
+    (void)munmap(p_block, mapped);
+
+    if (fd >= 0)
+    {
+        (void)close(fd);
+    }
+
+    p_mapped->stats.maps--;
+    count_mapped(p_mapped, mapped, 0u);
+}
+
+/*!
+ * @brief Creates a file in p_dir that is removed as soon as it is closed.
+ *
+ * @return File descriptor, or -1 on failure
+ */
+static int
+open_backing_file(const char * p_dir)
+{
+    size_t dir_len = strlen(p_dir);
+    char * p_path  = malloc(dir_len + sizeof(BACKING_NAME));
+
+    if (NULL == p_path)
+    {
+        return -1;
+    }
+
+    memcpy(p_path, p_dir, dir_len);
+    memcpy(p_path + dir_len, BACKING_NAME, sizeof(BACKING_NAME));
+
+    int fd = mkstemp(p_path);
+
+    if (fd >= 0)
+    {
+        (void)unlink(p_path);
+    }
+
+    free(p_path);
+    return fd;
+}
+
+/* Asks for transparent huge pages; the kernel may ignore the advice */
+static void
+advise(const alloc_mapped_t * p_mapped, void * p_start, size_t length)
+{
+#if defined(MADV_HUGEPAGE)
+    if (p_mapped->config.b_huge_pages)
+    {
+        (void)madvise(p_start, length, MADV_HUGEPAGE);
+    }
+#else
+    (void)p_mapped;
+    (void)p_start;
+    (void)length;
+#endif
+}
+
+/*!
+ * @brief Length of a mapping for size bytes after the header, in whole
+ *        pages of the kind p_block uses, and no less than the reservation.
+ *
+ * @return Length, or 0 if it would overflow
+ */
+static size_t
+mapping_length(const alloc_mapped_t * p_mapped,
+               const block_header_t * p_block,
+               size_t                 size)
+{
+    size_t granule = p_block->b_hugetlb ? HUGETLB_BYTES : p_mapped->page_bytes;
+
+    if (size < p_mapped->config.reserve_bytes)
+    {
+        size = p_mapped->config.reserve_bytes;
+    }
+
+    if (size > (SIZE_MAX - HEADER_BYTES - granule))
+    {
+        return 0u;
+    }
+
+    return (HEADER_BYTES + size + granule - 1u) / granule * granule;
+}
+
+static void
+count_mapped(alloc_mapped_t * p_mapped, size_t old_mapped, size_t mapped)
+{
+    p_mapped->stats.mapped_bytes = p_mapped->stats.mapped_bytes - old_mapped
+                                   + mapped;
+
+    if (p_mapped->stats.mapped_bytes > p_mapped->stats.peak_mapped_bytes)
+    {
+        p_mapped->stats.peak_mapped_bytes = p_mapped->stats.mapped_bytes;
+    }
+}
+
+/*** end of file ***/
@@ -0,0 +1,116 @@
+/** @file alloc_mapped.h
+ *
+ * @brief Allocator for very large blocks that grow without copying.
+ *
+ * realloc() of a multi-gigabyte block may have to copy it to a new
+ * address, which briefly needs twice the memory and takes seconds. An
+ * alloc_mapped_t gives every block its own memory mapping instead, and
+ * resizes it by page-table changes only:
+ *
+ * - With reserve_bytes set, each block reserves that much address space
+ *   when it is allocated. Growth within the reservation costs nothing
+ *   but the page faults that happen anyway as the memory is first used.
+ * - Growth past the reservation uses mremap(), which moves the existing
+ *   pages to a larger range without copying them.
+ * - With p_backing_dir set, each block is backed by an unlinked file in
+ *   that directory, so it may be larger than RAM and the kernel pages it
+ *   out to the file rather than failing.
+ * - b_huge_pages asks for transparent huge pages, which cut page faults
+ *   and TLB misses 512-fold on x86-64; b_hugetlb first tries the
+ *   preallocated huge page pool (MAP_HUGETLB) for anonymous blocks and
+ *   falls back to ordinary pages when the pool is empty.
+ *
+ * Hand the allocator to a container's *_init_ex / *_create_ex function,
+ * e.g. dynamic_array_init_ex(), whose storage is then one such block.
+ * Small blocks still take at least one page each, so this is not an
+ * allocator for nodes. Where mremap() is not available (outside Linux)
+ * growth past the reservation maps a new block and copies. Like the
+ * containers, an alloc_mapped_t is not thread-safe.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef ALLOC_MAPPED_H
+#define ALLOC_MAPPED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "allocator.h"
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct
+{
+    size_t       reserve_bytes; /* Address space each block reserves up
+                                   front; 0 to map only what is asked for */
+    const char * p_backing_dir; /* Directory for backing files; NULL for
+                                   anonymous memory */
+    bool         b_huge_pages;  /* Advise transparent huge pages */
+    bool         b_hugetlb;     /* Try MAP_HUGETLB first (anonymous only) */
+} alloc_mapped_config_t;
+
+typedef struct
+{
+    uint64_t maps;              /* Blocks mapped now */
+    uint64_t grows_reserved;    /* Growths that fit the block's mapping */
+    uint64_t grows_remapped;    /* Growths that remapped without copying */
+    uint64_t grows_copied;      /* Growths that had to copy */
+    uint64_t mapped_bytes;      /* Address space mapped now */
+    uint64_t peak_mapped_bytes; /* Most address space mapped at once */
+} alloc_mapped_stats_t;
+
+typedef struct alloc_mapped alloc_mapped_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Creates a mapped allocator.
+ *
+ * @param[in] p_config Configuration (copied, but p_backing_dir must
+ *                     outlive the allocator); NULL for anonymous memory
+ *                     with no reservation
+ *
+ * @return Pointer to the allocator, or NULL on failure
+ */
+alloc_mapped_t *
+alloc_mapped_create(const alloc_mapped_config_t * p_config);
+
+/*!
+ * @brief The allocator to hand to a container. It stays valid until the
+ *        mapped allocator is destroyed, which must be after the container
+ *        is.
+ *
+ * @param[in] p_mapped Mapped allocator
+ *
+ * @return Allocator that maps a block per allocation
+ */
+const allocator_t *
+alloc_mapped_allocator(alloc_mapped_t * p_mapped);
+
+/*!
+ * @brief Counters since the allocator was created.
+ *
+ * @param[in]  p_mapped Mapped allocator
+ * @param[out] p_stats  Counters
+ */
+void
+alloc_mapped_stats(const alloc_mapped_t * p_mapped,
+                   alloc_mapped_stats_t * p_stats);
+
+/*!
+ * @brief Frees a mapped allocator. Blocks still live are not unmapped.
+ *
+ * @param[in,out] pp_mapped Pointer to the allocator pointer; set to NULL
+ */
+void
+alloc_mapped_destroy(alloc_mapped_t ** pp_mapped);
+
+#endif /* ALLOC_MAPPED_H */
+
+/*** end of file ***/
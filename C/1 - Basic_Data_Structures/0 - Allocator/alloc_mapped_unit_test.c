@@ -0,0 +1,276 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "alloc_mapped.h"
+
+#define KIB (1024u)
+#define MIB (1024u * 1024u)
+
+static alloc_mapped_t * g_p_mapped;
+
+static void
+fill_pattern(uint8_t * p_bytes, size_t size)
+{
+    for (size_t idx = 0; idx < size; idx++)
+    {
+        p_bytes[idx] = (uint8_t)((idx * 31u) + 7u);
+    }
+}
+
+static bool
+has_pattern(const uint8_t * p_bytes, size_t size)
+{
+    for (size_t idx = 0; idx < size; idx++)
+    {
+        if (p_bytes[idx] != (uint8_t)((idx * 31u) + 7u))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void
+mapped_teardown(void)
+{
+    alloc_mapped_destroy(&g_p_mapped);
+}
+
+START_TEST(test_growth_within_and_past_reservation)
+{
+    alloc_mapped_config_t config = { .reserve_bytes = 1u * MIB };
+    alloc_mapped_stats_t  stats;
+
+    g_p_mapped                 = alloc_mapped_create(&config);
+    const allocator_t * p_alloc = alloc_mapped_allocator(g_p_mapped);
+    ck_assert_ptr_nonnull(p_alloc);
+
+    uint8_t * p_bytes = ALLOC_NEW(p_alloc, 4u * KIB);
+    ck_assert_ptr_nonnull(p_bytes);
+    fill_pattern(p_bytes, 4u * KIB);
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 1);
+    ck_assert_uint_ge(stats.mapped_bytes, 1u * MIB);
+
+    // Within the reservation the block stays where it is
+    uint8_t * p_grown = ALLOC_RESIZE(p_alloc, p_bytes, 512u * KIB);
+    ck_assert_ptr_eq(p_grown, p_bytes);
+    ck_assert(has_pattern(p_grown, 4u * KIB));
+    fill_pattern(p_grown, 512u * KIB);
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.grows_reserved, 1);
+    ck_assert_uint_eq(stats.grows_remapped + stats.grows_copied, 0);
+
+    // Past it the block grows, with everything written so far intact
+    p_grown = ALLOC_RESIZE(p_alloc, p_grown, 3u * MIB);
+    ck_assert_ptr_nonnull(p_grown);
+    ck_assert(has_pattern(p_grown, 512u * KIB));
+    p_grown[(3u * MIB) - 1u] = 0xA5u;
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.grows_reserved, 1);
+    ck_assert_uint_eq(stats.grows_remapped + stats.grows_copied, 1);
+    ck_assert_uint_ge(stats.mapped_bytes, 3u * MIB);
+    ck_assert_uint_eq(stats.peak_mapped_bytes, stats.mapped_bytes);
+
+    ALLOC_FREE(p_alloc, p_grown);
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 0);
+    ck_assert_uint_eq(stats.mapped_bytes, 0);
+}
+END_TEST
+
+START_TEST(test_growth_by_mremap)
+{
+    alloc_mapped_stats_t stats;
+
+    g_p_mapped                 = alloc_mapped_create(NULL);
+    const allocator_t * p_alloc = alloc_mapped_allocator(g_p_mapped);
+    ck_assert_ptr_nonnull(p_alloc);
+
+    size_t    size    = 1u * KIB;
+    uint8_t * p_bytes = ALLOC_NEW(p_alloc, size);
+    ck_assert_ptr_nonnull(p_bytes);
+    fill_pattern(p_bytes, size);
+
+    // With no reservation every doubling past a page needs a bigger mapping
+    uint32_t grows = 0;
+    while (size < (16u * MIB))
+    {
+        size *= 2u;
+        p_bytes = ALLOC_RESIZE(p_alloc, p_bytes, size);
+        ck_assert_ptr_nonnull(p_bytes);
+        ck_assert(has_pattern(p_bytes, size / 2u));
+        fill_pattern(p_bytes, size);
+        grows++;
+    }
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 1);
+#if defined(__linux__)
+    ck_assert_uint_eq(stats.grows_copied, 0);
+    ck_assert_uint_gt(stats.grows_remapped, 0);
+#endif
+    ck_assert_uint_eq(stats.grows_reserved + stats.grows_remapped
+                          + stats.grows_copied,
+                      grows);
+
+    // Shrinking hands whole pages back and keeps the front
+    uint64_t before = stats.mapped_bytes;
+    p_bytes         = ALLOC_RESIZE(p_alloc, p_bytes, 64u * KIB);
+    ck_assert_ptr_nonnull(p_bytes);
+    ck_assert(has_pattern(p_bytes, 64u * KIB));
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_lt(stats.mapped_bytes, before);
+    ck_assert_uint_eq(stats.peak_mapped_bytes, before);
+
+    // Resizing to 0 frees, as realloc_fn promises
+    ck_assert_ptr_null(ALLOC_RESIZE(p_alloc, p_bytes, 0));
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 0);
+    ck_assert_uint_eq(stats.mapped_bytes, 0);
+}
+END_TEST
+
+START_TEST(test_file_backed_round_trip)
+{
+    char                 dir[] = "/tmp/alloc_mapped_test.XXXXXX";
+    alloc_mapped_stats_t stats;
+
+    ck_assert_ptr_nonnull(mkdtemp(dir));
+
+    alloc_mapped_config_t config = { .p_backing_dir = dir };
+    g_p_mapped                   = alloc_mapped_create(&config);
+    const allocator_t * p_alloc  = alloc_mapped_allocator(g_p_mapped);
+    ck_assert_ptr_nonnull(p_alloc);
+
+    uint8_t * p_first  = ALLOC_NEW(p_alloc, 100u * KIB);
+    uint8_t * p_second = ALLOC_NEW(p_alloc, 10u * KIB);
+    ck_assert_ptr_nonnull(p_first);
+    ck_assert_ptr_nonnull(p_second);
+    fill_pattern(p_first, 100u * KIB);
+    memset(p_second, 0x5A, 10u * KIB);
+
+    // Growing extends the file under the mapping
+    p_first = ALLOC_RESIZE(p_alloc, p_first, 4u * MIB);
+    ck_assert_ptr_nonnull(p_first);
+    ck_assert(has_pattern(p_first, 100u * KIB));
+    fill_pattern(p_first, 4u * MIB);
+
+    // And shrinking truncates it, without touching the other block
+    p_first = ALLOC_RESIZE(p_alloc, p_first, 8u * KIB);
+    ck_assert_ptr_nonnull(p_first);
+    ck_assert(has_pattern(p_first, 8u * KIB));
+    for (size_t idx = 0; idx < (10u * KIB); idx++)
+    {
+        ck_assert_uint_eq(p_second[idx], 0x5A);
+    }
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 2);
+
+    ALLOC_FREE(p_alloc, p_first);
+    ALLOC_FREE(p_alloc, p_second);
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 0);
+    ck_assert_uint_eq(stats.mapped_bytes, 0);
+
+    // The backing files were unlinked as they were made, so none is left
+    ck_assert_int_eq(rmdir(dir), 0);
+}
+END_TEST
+
+START_TEST(test_failure_paths)
+{
+    alloc_mapped_stats_t stats;
+
+    // A backing directory that does not exist fails the allocation
+    alloc_mapped_config_t config = {
+        .p_backing_dir = "/nonexistent/alloc_mapped_test"
+    };
+    g_p_mapped                  = alloc_mapped_create(&config);
+    const allocator_t * p_alloc = alloc_mapped_allocator(g_p_mapped);
+    ck_assert_ptr_nonnull(p_alloc);
+    ck_assert_ptr_null(ALLOC_NEW(p_alloc, 4u * KIB));
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 0);
+    ck_assert_uint_eq(stats.mapped_bytes, 0);
+    alloc_mapped_destroy(&g_p_mapped);
+    ck_assert_ptr_null(g_p_mapped);
+
+    // Sizes whose mapping length would overflow are refused up front
+    g_p_mapped = alloc_mapped_create(NULL);
+    p_alloc    = alloc_mapped_allocator(g_p_mapped);
+    ck_assert_ptr_null(ALLOC_NEW(p_alloc, SIZE_MAX));
+    ck_assert_ptr_null(ALLOC_NEW(p_alloc, SIZE_MAX - 64u));
+    ck_assert_ptr_null(ALLOC_NEW(p_alloc, 0));
+
+    uint8_t * p_bytes = ALLOC_NEW(p_alloc, 4u * KIB);
+    ck_assert_ptr_nonnull(p_bytes);
+    fill_pattern(p_bytes, 4u * KIB);
+
+    // A failed resize leaves the block as it was
+    ck_assert_ptr_null(ALLOC_RESIZE(p_alloc, p_bytes, SIZE_MAX - 64u));
+    ck_assert(has_pattern(p_bytes, 4u * KIB));
+
+    alloc_mapped_stats(g_p_mapped, &stats);
+    ck_assert_uint_eq(stats.maps, 1);
+    ck_assert_uint_eq(stats.grows_reserved + stats.grows_remapped
+                          + stats.grows_copied,
+                      0);
+
+    ALLOC_FREE(p_alloc, p_bytes);
+    ck_assert_ptr_null(alloc_mapped_allocator(NULL));
+}
+END_TEST
+
+//
+// Define test suite and add test cases
+//
+Suite *
+alloc_mapped_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Alloc_Mapped");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_checked_fixture(tc_core, NULL, mapped_teardown);
+    tcase_add_test(tc_core, test_growth_within_and_past_reservation);
+    tcase_add_test(tc_core, test_growth_by_mremap);
+    tcase_add_test(tc_core, test_file_backed_round_trip);
+    tcase_add_test(tc_core, test_failure_paths);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = alloc_mapped_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
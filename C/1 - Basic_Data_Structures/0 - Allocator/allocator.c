@@ -0,0 +1,650 @@
+/** @file allocator.c
+ *
+ * @brief Default and tracking allocators.
+ *
+ * The tracker puts a 16-byte header in front of every block it hands out,
+ * holding the block's size and call site, so frees and resizes can be
+ * charged to the right site without the container passing sizes around.
+ * Call sites are string literals; they are looked up by address in a
+ * small open-addressing table. An address seen for the first time is
+ * compared with strcmp() against the known sites, so the same "file:line"
+ * literal emitted at a different address is still one site.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#include <unistd.h>
+#define ALLOC_HAVE_BACKTRACE (1)
+#else
+#define ALLOC_HAVE_BACKTRACE (0)
+#endif
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define SITE_SLOTS  (2u * ALLOC_TRACKER_MAX_SITES) /* Power of two */
+#define OTHER_SITE  (ALLOC_TRACKER_MAX_SITES)      /* Index of "other" */
+#define OTHER_NAME  ("other")
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Placed before every tracked block; 16 bytes keeps malloc's alignment */
+typedef struct
+{
+    uint64_t size;
+    uint32_t site;
+    uint32_t reserved;
+} block_header_t;
+
+struct alloc_tracker
+{
+    allocator_t         allocator; /* Handed to containers; p_ctx is us */
+    const allocator_t * p_parent;
+    uint32_t            sample_every;
+    uint32_t            until_sample;
+    alloc_stats_t       total;
+    alloc_stats_t       sites[ALLOC_TRACKER_MAX_SITES + 1];
+    uint32_t            site_count;
+    uint8_t             site_slots[SITE_SLOTS]; /* Site index + 1; 0 empty */
+    alloc_sample_t      samples[ALLOC_TRACKER_MAX_SAMPLES];
+    uint32_t            sample_next;
+    uint32_t            sample_count;
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void *   default_alloc(void * p_ctx, size_t size, const char * p_site);
+static void *   default_realloc(void *       p_ctx,
+                                void *       p_old,
+                                size_t       size,
+                                const char * p_site);
+static void     default_free(void * p_ctx, void * p_ptr);
+static void *   tracked_alloc(void * p_ctx, size_t size, const char * p_site);
+static void *   tracked_realloc(void *       p_ctx,
+                                void *       p_old,
+                                size_t       size,
+                                const char * p_site);
+static void     tracked_free(void * p_ctx, void * p_ptr);
+static uint32_t find_site(alloc_tracker_t * p_tracker, const char * p_site);
+static void     charge(alloc_stats_t * p_stats, size_t size);
+static void     credit(alloc_stats_t * p_stats, size_t size);
+static void     move_bytes(alloc_stats_t * p_from,
+                           alloc_stats_t * p_to,
+                           uint64_t        old_size,
+                           uint64_t        size);
+static void     sample(alloc_tracker_t * p_tracker,
+                       const char *      p_site,
+                       size_t            size);
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const allocator_t g_default_allocator = {
+    .alloc_fn   = default_alloc,
+    .realloc_fn = default_realloc,
+    .free_fn    = default_free,
+    .p_ctx      = NULL,
+};
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief The allocator used when a container is given NULL.
+ *
+ * @return malloc/realloc/free allocator
+ */
+const allocator_t *
+allocator_default(void)
+{
+    return &g_default_allocator;
+}
+
+/*!
+ * @brief Allocates through p_alloc, or the default allocator if NULL.
+ *        Size 0 is passed on, and gives whatever malloc(0) would.
+ *
+ * @return Pointer to the memory, or NULL on failure
+ */
+void *
+allocator_alloc(const allocator_t * p_alloc, size_t size, const char * p_site)
+{
+    p_alloc = (NULL == p_alloc) ? &g_default_allocator : p_alloc;
+    return p_alloc->alloc_fn(p_alloc->p_ctx, size, p_site);
+}
+
+/*!
+ * @brief Allocates count * size zeroed bytes, failing on overflow.
+ *
+ * @return Pointer to the memory, or NULL on failure
+ */
+void *
+allocator_calloc(const allocator_t * p_alloc,
+                 size_t              count,
+                 size_t              size,
+                 const char *        p_site)
+{
+    if ((0 != size) && (count > (SIZE_MAX / size)))
+    {
+        return NULL;
+    }
+
+    void * p_memory = allocator_alloc(p_alloc, count * size, p_site);
+    if (NULL != p_memory)
+    {
+        memset(p_memory, 0, count * size);
+    }
+    return p_memory;
+}
+
+/*!
+ * @brief Resizes a block; on failure the old block is left untouched.
+ *
+ * @return Pointer to the resized memory, or NULL on failure
+ */
+void *
+allocator_realloc(const allocator_t * p_alloc,
+                  void *              p_old,
+                  size_t              size,
+                  const char *        p_site)
+{
+    p_alloc = (NULL == p_alloc) ? &g_default_allocator : p_alloc;
+    return p_alloc->realloc_fn(p_alloc->p_ctx, p_old, size, p_site);
+}
+
+/*!
+ * @brief Frees a block from allocator_alloc/calloc/realloc; NULL is ignored.
+ */
+void
+allocator_free(const allocator_t * p_alloc, void * p_ptr)
+{
+    p_alloc = (NULL == p_alloc) ? &g_default_allocator : p_alloc;
+    p_alloc->free_fn(p_alloc->p_ctx, p_ptr);
+}
+
+/*!
+ * @brief Creates a tracker that forwards to p_parent.
+ *
+ * @param[in] p_parent     Allocator that provides the memory; NULL for the
+ *                         default
+ * @param[in] sample_every Record the stack of every Nth allocation; 0 for
+ *                         none
+ *
+ * @return Pointer to the tracker, or NULL on failure
+ */
+alloc_tracker_t *
+alloc_tracker_create(const allocator_t * p_parent, uint32_t sample_every)
+{
+    alloc_tracker_t * p_tracker = calloc(1, sizeof(alloc_tracker_t));
+    if (NULL == p_tracker)
+    {
+        return NULL;
+    }
+
+    p_tracker->allocator.alloc_fn   = tracked_alloc;
+    p_tracker->allocator.realloc_fn = tracked_realloc;
+    p_tracker->allocator.free_fn    = tracked_free;
+    p_tracker->allocator.p_ctx      = p_tracker;
+    p_tracker->p_parent
+        = (NULL == p_parent) ? &g_default_allocator : p_parent;
+    p_tracker->sample_every = sample_every;
+    p_tracker->until_sample = sample_every;
+    p_tracker->sites[OTHER_SITE].p_site = OTHER_NAME;
+
+    return p_tracker;
+}
+
+/*!
+ * @brief The allocator to hand to a container.
+ *
+ * @param[in] p_tracker Tracker
+ *
+ * @return Allocator that counts into this tracker
+ */
+const allocator_t *
+alloc_tracker_allocator(alloc_tracker_t * p_tracker)
+{
+    return (NULL == p_tracker) ? NULL : &p_tracker->allocator;
+}
+
+/*!
+ * @brief Totals over every call site.
+ *
+ * @param[in]  p_tracker Tracker
+ * @param[out] p_stats   Counters (p_site is NULL)
+ */
+void
+alloc_tracker_stats(const alloc_tracker_t * p_tracker, alloc_stats_t * p_stats)
+{
+    if ((NULL != p_tracker) && (NULL != p_stats))
+    {
+        *p_stats = p_tracker->total;
+    }
+}
+
+/*!
+ * @brief Counters per call site, in the order the sites were first seen.
+ *
+ * @return Number of entries written
+ */
+uint32_t
+alloc_tracker_sites(const alloc_tracker_t * p_tracker,
+                    alloc_stats_t *         p_sites,
+                    uint32_t                max_sites)
+{
+    uint32_t count = 0;
+
+    if ((NULL == p_tracker) || (NULL == p_sites))
+    {
+        return 0;
+    }
+
+    for (uint32_t idx = 0; (idx < p_tracker->site_count) && (count < max_sites);
+         idx++)
+    {
+        p_sites[count++] = p_tracker->sites[idx];
+    }
+
+    // "other" only appears once it has been used
+    if ((count < max_sites) && (0 != p_tracker->sites[OTHER_SITE].allocs))
+    {
+        p_sites[count++] = p_tracker->sites[OTHER_SITE];
+    }
+
+    return count;
+}
+
+/*!
+ * @brief The most recent sampled allocations, oldest first.
+ *
+ * @return Number of entries written
+ */
+uint32_t
+alloc_tracker_samples(const alloc_tracker_t * p_tracker,
+                      alloc_sample_t *        p_samples,
+                      uint32_t                max_samples)
+{
+    if ((NULL == p_tracker) || (NULL == p_samples))
+    {
+        return 0;
+    }
+
+    uint32_t count = (p_tracker->sample_count < max_samples)
+                         ? p_tracker->sample_count
+                         : max_samples;
+    uint32_t first = (p_tracker->sample_next + ALLOC_TRACKER_MAX_SAMPLES
+                      - count)
+                     % ALLOC_TRACKER_MAX_SAMPLES;
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        p_samples[idx]
+            = p_tracker->samples[(first + idx) % ALLOC_TRACKER_MAX_SAMPLES];
+    }
+
+    return count;
+}
+
+/*!
+ * @brief Sets every peak back to the current live bytes.
+ *
+ * @param[in,out] p_tracker Tracker
+ */
+void
+alloc_tracker_reset_peak(alloc_tracker_t * p_tracker)
+{
+    if (NULL == p_tracker)
+    {
+        return;
+    }
+
+    p_tracker->total.peak_bytes = p_tracker->total.live_bytes;
+    for (uint32_t idx = 0; idx <= ALLOC_TRACKER_MAX_SITES; idx++)
+    {
+        p_tracker->sites[idx].peak_bytes = p_tracker->sites[idx].live_bytes;
+    }
+}
+
+/*!
+ * @brief Prints totals, per-site counters and sampled stacks.
+ *
+ * @param[in] p_tracker Tracker
+ * @param[in] p_output  Stream
+ */
+void
+alloc_tracker_print(const alloc_tracker_t * p_tracker, FILE * p_output)
+{
+    if ((NULL == p_tracker) || (NULL == p_output))
+    {
+        return;
+    }
+
+    const alloc_stats_t * p_total = &p_tracker->total;
+    fprintf(p_output,
+            "allocs %llu, reallocs %llu, frees %llu, failures %llu, "
+            "live %llu B, peak %llu B, requested %llu B\n",
+            (unsigned long long)p_total->allocs,
+            (unsigned long long)p_total->reallocs,
+            (unsigned long long)p_total->frees,
+            (unsigned long long)p_total->failures,
+            (unsigned long long)p_total->live_bytes,
+            (unsigned long long)p_total->peak_bytes,
+            (unsigned long long)p_total->total_bytes);
+
+    for (uint32_t idx = 0; idx <= ALLOC_TRACKER_MAX_SITES; idx++)
+    {
+        const alloc_stats_t * p_site = &p_tracker->sites[idx];
+        if ((idx >= p_tracker->site_count) && (OTHER_SITE != idx))
+        {
+            continue;
+        }
+        if ((OTHER_SITE == idx) && (0 == p_site->allocs))
+        {
+            break;
+        }
+        fprintf(p_output,
+                "  %-40s allocs %9llu frees %9llu live %10llu B "
+                "peak %10llu B\n",
+                p_site->p_site,
+                (unsigned long long)p_site->allocs,
+                (unsigned long long)p_site->frees,
+                (unsigned long long)p_site->live_bytes,
+                (unsigned long long)p_site->peak_bytes);
+    }
+
+    // Oldest sample first
+    uint32_t count = p_tracker->sample_count;
+    uint32_t first = (p_tracker->sample_next + ALLOC_TRACKER_MAX_SAMPLES
+                      - count)
+                     % ALLOC_TRACKER_MAX_SAMPLES;
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        const alloc_sample_t * p_sample
+            = &p_tracker->samples[(first + idx) % ALLOC_TRACKER_MAX_SAMPLES];
+
+        fprintf(p_output, "sampled %zu B at %s\n", p_sample->size,
+                p_sample->p_site);
+#if ALLOC_HAVE_BACKTRACE
+        fflush(p_output);
+        backtrace_symbols_fd((void * const *)p_sample->frames,
+                             (int)p_sample->frame_count,
+                             fileno(p_output));
+#endif
+    }
+}
+
+/*!
+ * @brief Frees a tracker. Blocks still live are not freed.
+ *
+ * @param[in,out] pp_tracker Pointer to the tracker pointer; set to NULL
+ */
+void
+alloc_tracker_destroy(alloc_tracker_t ** pp_tracker)
+{
+    if ((NULL == pp_tracker) || (NULL == *pp_tracker))
+    {
+        return;
+    }
+
+    free(*pp_tracker);
+    *pp_tracker = NULL;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static void *
+default_alloc(void * p_ctx, size_t size, const char * p_site)
+{
+    (void)p_ctx;
+    (void)p_site;
+    return malloc(size);
+}
+
+static void *
+default_realloc(void * p_ctx, void * p_old, size_t size, const char * p_site)
+{
+    (void)p_ctx;
+    (void)p_site;
+    return realloc(p_old, size);
+}
+
+static void
+default_free(void * p_ctx, void * p_ptr)
+{
+    (void)p_ctx;
+    free(p_ptr);
+}
+
+static void *
+tracked_alloc(void * p_ctx, size_t size, const char * p_site)
+{
+    alloc_tracker_t * p_tracker = p_ctx;
+    const allocator_t * p_parent = p_tracker->p_parent;
+    uint32_t          site      = find_site(p_tracker, p_site);
+    block_header_t *  p_block   = NULL;
+
+    if (size <= (SIZE_MAX - sizeof(block_header_t)))
+    {
+        p_block = p_parent->alloc_fn(p_parent->p_ctx,
+                                     sizeof(block_header_t) + size,
+                                     p_site);
+    }
+    if (NULL == p_block)
+    {
+        p_tracker->total.failures++;
+        p_tracker->sites[site].failures++;
+        return NULL;
+    }
+
+    p_block->size = size;
+    p_block->site = site;
+    charge(&p_tracker->total, size);
+    charge(&p_tracker->sites[site], size);
+    sample(p_tracker, p_site, size);
+
+    return p_block + 1;
+}
+
+/*!
+ * @brief Resizes a tracked block. The bytes move to the site of the
+ *        resize, which is where the block's size was last decided.
+ */
+static void *
+tracked_realloc(void * p_ctx, void * p_old, size_t size, const char * p_site)
+{
+    alloc_tracker_t * p_tracker = p_ctx;
+    const allocator_t * p_parent = p_tracker->p_parent;
+
+    if (NULL == p_old)
+    {
+        return tracked_alloc(p_ctx, size, p_site);
+    }
+
+    block_header_t * p_old_block = (block_header_t *)p_old - 1;
+    uint64_t         old_size    = p_old_block->size;
+    uint32_t         old_site    = p_old_block->site;
+    uint32_t         site        = find_site(p_tracker, p_site);
+    block_header_t * p_block     = NULL;
+
+    if (size <= (SIZE_MAX - sizeof(block_header_t)))
+    {
+        p_block = p_parent->realloc_fn(p_parent->p_ctx,
+                                       p_old_block,
+                                       sizeof(block_header_t) + size,
+                                       p_site);
+    }
+    if (NULL == p_block)
+    {
+        p_tracker->total.failures++;
+        p_tracker->sites[site].failures++;
+        return NULL;
+    }
+
+    p_block->size = size;
+    p_block->site = site;
+
+    move_bytes(&p_tracker->total, &p_tracker->total, old_size, size);
+    move_bytes(&p_tracker->sites[old_site], &p_tracker->sites[site],
+               old_size, size);
+    p_tracker->total.reallocs++;
+    p_tracker->sites[site].reallocs++;
+
+    return p_block + 1;
+}
+
+static void
+tracked_free(void * p_ctx, void * p_ptr)
+{
+    alloc_tracker_t * p_tracker = p_ctx;
+    const allocator_t * p_parent = p_tracker->p_parent;
+
+    if (NULL == p_ptr)
+    {
+        return;
+    }
+
+    block_header_t * p_block = (block_header_t *)p_ptr - 1;
+    credit(&p_tracker->total, p_block->size);
+    credit(&p_tracker->sites[p_block->site], p_block->size);
+    p_parent->free_fn(p_parent->p_ctx, p_block);
+}
+
+/*!
+ * @brief Index of a call site, adding it if there is room.
+ *
+ * @return Site index, or OTHER_SITE when the table is full
+ */
+static uint32_t
+find_site(alloc_tracker_t * p_tracker, const char * p_site)
+{
+    uint64_t hash = ((uint64_t)(uintptr_t)p_site >> 3) * 0x9e3779b97f4a7c15ull;
+    uint32_t slot = (uint32_t)(hash >> 40) & (SITE_SLOTS - 1);
+
+    if (NULL == p_site)
+    {
+        return OTHER_SITE;
+    }
+
+    for (uint32_t probe = 0; probe < SITE_SLOTS; probe++)
+    {
+        uint32_t index = p_tracker->site_slots[slot];
+
+        if (0 == index)
+        {
+            // A new address may still be a known "file:line"; it gets a
+            // slot of its own pointing at the same site
+            for (index = 0; index < p_tracker->site_count; index++)
+            {
+                if (0 == strcmp(p_tracker->sites[index].p_site, p_site))
+                {
+                    break;
+                }
+            }
+            if (index == ALLOC_TRACKER_MAX_SITES)
+            {
+                return OTHER_SITE;
+            }
+            if (index == p_tracker->site_count)
+            {
+                p_tracker->site_count++;
+                p_tracker->sites[index].p_site = p_site;
+            }
+            p_tracker->site_slots[slot] = (uint8_t)(index + 1);
+            return index;
+        }
+
+        const char * p_known = p_tracker->sites[index - 1].p_site;
+        if ((p_known == p_site) || (0 == strcmp(p_known, p_site)))
+        {
+            return index - 1;
+        }
+        slot = (slot + 1) & (SITE_SLOTS - 1);
+    }
+
+    return OTHER_SITE;
+}
+
+static void
+charge(alloc_stats_t * p_stats, size_t size)
+{
+    p_stats->allocs++;
+    p_stats->total_bytes += size;
+    p_stats->live_bytes += size;
+    if (p_stats->live_bytes > p_stats->peak_bytes)
+    {
+        p_stats->peak_bytes = p_stats->live_bytes;
+    }
+}
+
+static void
+credit(alloc_stats_t * p_stats, size_t size)
+{
+    p_stats->frees++;
+    p_stats->live_bytes -= size;
+}
+
+/*!
+ * @brief Accounts for a resize, which is neither an allocation nor a free.
+ */
+static void
+move_bytes(alloc_stats_t * p_from,
+           alloc_stats_t * p_to,
+           uint64_t        old_size,
+           uint64_t        size)
+{
+    p_from->live_bytes -= old_size;
+    p_to->live_bytes += size;
+    p_to->total_bytes += size;
+    if (p_to->live_bytes > p_to->peak_bytes)
+    {
+        p_to->peak_bytes = p_to->live_bytes;
+    }
+}
+
+/*!
+ * @brief Records the stack of every sample_every-th allocation.
+ */
+static void
+sample(alloc_tracker_t * p_tracker, const char * p_site, size_t size)
+{
+    if ((0 == p_tracker->sample_every) || (0 != --p_tracker->until_sample))
+    {
+        return;
+    }
+    p_tracker->until_sample = p_tracker->sample_every;
+
+    alloc_sample_t * p_sample = &p_tracker->samples[p_tracker->sample_next];
+    p_sample->p_site          = p_site;
+    p_sample->size            = size;
+    p_sample->frame_count     = 0;
+#if ALLOC_HAVE_BACKTRACE
+    int frames = backtrace(p_sample->frames, ALLOC_TRACKER_MAX_FRAMES);
+    p_sample->frame_count = (frames > 0) ? (uint32_t)frames : 0;
+#endif
+
+    p_tracker->sample_next = (p_tracker->sample_next + 1)
+                             % ALLOC_TRACKER_MAX_SAMPLES;
+    if (p_tracker->sample_count < ALLOC_TRACKER_MAX_SAMPLES)
+    {
+        p_tracker->sample_count++;
+    }
+}
+
+/*** end of file ***/
@@ -0,0 +1,237 @@
+/** @file allocator.h
+ *
+ * @brief Allocator interface for the containers, and a tracking allocator.
+ *
+ * Every container takes an allocator_t in its *_init_ex / *_create_ex
+ * function and uses it for its own memory (nodes, arrays, buckets). The
+ * plain *_init / *_create functions pass NULL, which selects
+ * allocator_default(): malloc, realloc and free with no bookkeeping.
+ * Memory that belongs to the caller, such as the data freed when
+ * b_free_data is true, is still released with free().
+ *
+ * Each request carries its call site ("file:line", see ALLOC_SITE). An
+ * alloc_tracker_t wraps another allocator and counts allocations, frees,
+ * live and peak bytes, both in total and per call site, and can record the
+ * stack of every Nth allocation. Give each container instance its own
+ * tracker to see what that instance costs. A tracker is not thread-safe,
+ * like the containers themselves.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define ALLOC_STRINGIFY_(x) #x
+#define ALLOC_STRINGIFY(x)  ALLOC_STRINGIFY_(x)
+
+/* Call site passed with every request */
+#define ALLOC_SITE          (__FILE__ ":" ALLOC_STRINGIFY(__LINE__))
+
+/* Shorthands the containers use */
+#define ALLOC_NEW(p_alloc, size) allocator_alloc((p_alloc), (size), ALLOC_SITE)
+#define ALLOC_ZEROED(p_alloc, count, size) \
+    allocator_calloc((p_alloc), (count), (size), ALLOC_SITE)
+#define ALLOC_RESIZE(p_alloc, p_old, size) \
+    allocator_realloc((p_alloc), (p_old), (size), ALLOC_SITE)
+#define ALLOC_FREE(p_alloc, p_ptr) allocator_free((p_alloc), (p_ptr))
+
+#define ALLOC_TRACKER_MAX_SITES   (64u) /* Later sites count as "other" */
+#define ALLOC_TRACKER_MAX_SAMPLES (32u) /* Most recent sampled stacks kept */
+#define ALLOC_TRACKER_MAX_FRAMES  (16u)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct
+{
+    /* Like malloc(); p_site is a string literal */
+    void * (*alloc_fn)(void * p_ctx, size_t size, const char * p_site);
+
+    /* Like realloc(), including p_old == NULL */
+    void * (*realloc_fn)(void *       p_ctx,
+                         void *       p_old,
+                         size_t       size,
+                         const char * p_site);
+
+    /* Like free(), including p_ptr == NULL */
+    void (*free_fn)(void * p_ctx, void * p_ptr);
+
+    void * p_ctx;
+} allocator_t;
+
+/* Counters for a whole tracker or one call site */
+typedef struct
+{
+    const char * p_site;      /* NULL for the tracker total */
+    uint64_t     allocs;      /* Successful allocations, reallocs of NULL
+                                 included */
+    uint64_t     reallocs;    /* Successful resizes of existing blocks */
+    uint64_t     frees;
+    uint64_t     failures;    /* Requests the parent allocator refused */
+    uint64_t     total_bytes; /* Bytes ever requested */
+    uint64_t     live_bytes;
+    uint64_t     peak_bytes;
+} alloc_stats_t;
+
+/* One sampled allocation */
+typedef struct
+{
+    const char * p_site;
+    size_t       size;
+    uint32_t     frame_count; /* 0 where stacks cannot be captured */
+    void *       frames[ALLOC_TRACKER_MAX_FRAMES];
+} alloc_sample_t;
+
+typedef struct alloc_tracker alloc_tracker_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief The allocator used when a container is given NULL.
+ *
+ * @return malloc/realloc/free allocator
+ */
+const allocator_t *
+allocator_default(void);
+
+/*!
+ * @brief Allocates through p_alloc, or the default allocator if NULL.
+ *        Size 0 is passed on, and gives whatever malloc(0) would.
+ *
+ * @return Pointer to the memory, or NULL on failure
+ */
+void *
+allocator_alloc(const allocator_t * p_alloc, size_t size, const char * p_site);
+
+/*!
+ * @brief Allocates count * size zeroed bytes, failing on overflow.
+ *
+ * @return Pointer to the memory, or NULL on failure
+ */
+void *
+allocator_calloc(const allocator_t * p_alloc,
+                 size_t              count,
+                 size_t              size,
+                 const char *        p_site);
+
+/*!
+ * @brief Resizes a block; on failure the old block is left untouched.
+ *
+ * @return Pointer to the resized memory, or NULL on failure
+ */
+void *
+allocator_realloc(const allocator_t * p_alloc,
+                  void *              p_old,
+                  size_t              size,
+                  const char *        p_site);
+
+/*!
+ * @brief Frees a block from allocator_alloc/calloc/realloc; NULL is ignored.
+ */
+void
+allocator_free(const allocator_t * p_alloc, void * p_ptr);
+
+/*!
+ * @brief Creates a tracker that forwards to p_parent.
+ *
+ * @param[in] p_parent     Allocator that provides the memory; NULL for the
+ *                         default
+ * @param[in] sample_every Record the stack of every Nth allocation; 0 for
+ *                         none
+ *
+ * @return Pointer to the tracker, or NULL on failure
+ */
+alloc_tracker_t *
+alloc_tracker_create(const allocator_t * p_parent, uint32_t sample_every);
+
+/*!
+ * @brief The allocator to hand to a container. It stays valid until the
+ *        tracker is destroyed, which must be after the container is.
+ *
+ * @param[in] p_tracker Tracker
+ *
+ * @return Allocator that counts into this tracker
+ */
+const allocator_t *
+alloc_tracker_allocator(alloc_tracker_t * p_tracker);
+
+/*!
+ * @brief Totals over every call site.
+ *
+ * @param[in]  p_tracker Tracker
+ * @param[out] p_stats   Counters (p_site is NULL)
+ */
+void
+alloc_tracker_stats(const alloc_tracker_t * p_tracker, alloc_stats_t * p_stats);
+
+/*!
+ * @brief Counters per call site, in the order the sites were first seen.
+ *
+ * @param[in]  p_tracker Tracker
+ * @param[out] p_sites   Array for up to max_sites entries
+ * @param[in]  max_sites Size of the array
+ *
+ * @return Number of entries written
+ */
+uint32_t
+alloc_tracker_sites(const alloc_tracker_t * p_tracker,
+                    alloc_stats_t *         p_sites,
+                    uint32_t                max_sites);
+
+/*!
+ * @brief The most recent sampled allocations, oldest first.
+ *
+ * @param[in]  p_tracker   Tracker
+ * @param[out] p_samples   Array for up to max_samples entries
+ * @param[in]  max_samples Size of the array
+ *
+ * @return Number of entries written
+ */
+uint32_t
+alloc_tracker_samples(const alloc_tracker_t * p_tracker,
+                      alloc_sample_t *        p_samples,
+                      uint32_t                max_samples);
+
+/*!
+ * @brief Sets every peak back to the current live bytes, so a later peak
+ *        covers only what happens after this call.
+ *
+ * @param[in,out] p_tracker Tracker
+ */
+void
+alloc_tracker_reset_peak(alloc_tracker_t * p_tracker);
+
+/*!
+ * @brief Prints totals, per-site counters and sampled stacks.
+ *
+ * @param[in] p_tracker Tracker
+ * @param[in] p_output  Stream
+ */
+void
+alloc_tracker_print(const alloc_tracker_t * p_tracker, FILE * p_output);
+
+/*!
+ * @brief Frees a tracker. Blocks still live are not freed.
+ *
+ * @param[in,out] pp_tracker Pointer to the tracker pointer; set to NULL
+ */
+void
+alloc_tracker_destroy(alloc_tracker_t ** pp_tracker);
+
+#endif /* ALLOCATOR_H */
+
+/*** end of file ***/
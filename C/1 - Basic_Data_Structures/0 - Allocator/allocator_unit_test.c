@@ -0,0 +1,423 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+
+#define SITE_A        ("site_a.c:1")
+#define SITE_B        ("site_b.c:2")
+#define EXTRA_SITES   (ALLOC_TRACKER_MAX_SITES + 8u)
+#define SITE_NAME_LEN (16u)
+
+// Parent allocator that refuses every request once its budget is spent
+typedef struct
+{
+    int budget;
+    int refused;
+} failing_ctx_t;
+
+static char           g_site_names[EXTRA_SITES][SITE_NAME_LEN];
+static alloc_stats_t  g_sites[EXTRA_SITES + 1];
+static alloc_sample_t g_samples[ALLOC_TRACKER_MAX_SAMPLES];
+
+static void *
+failing_alloc(void * p_ctx, size_t size, const char * p_site)
+{
+    failing_ctx_t * p_failing = p_ctx;
+
+    (void)p_site;
+    if (0 == p_failing->budget)
+    {
+        p_failing->refused++;
+        return NULL;
+    }
+    p_failing->budget--;
+    return malloc(size);
+}
+
+static void *
+failing_realloc(void * p_ctx, void * p_old, size_t size, const char * p_site)
+{
+    failing_ctx_t * p_failing = p_ctx;
+
+    (void)p_site;
+    if (0 == p_failing->budget)
+    {
+        p_failing->refused++;
+        return NULL;
+    }
+    p_failing->budget--;
+    return realloc(p_old, size);
+}
+
+static void
+failing_free(void * p_ctx, void * p_ptr)
+{
+    (void)p_ctx;
+    free(p_ptr);
+}
+
+// Finds a site's counters by name; fails the test if it is missing
+static alloc_stats_t
+site_stats(const alloc_tracker_t * p_tracker, const char * p_site)
+{
+    uint32_t count = alloc_tracker_sites(p_tracker, g_sites, EXTRA_SITES + 1);
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        if (0 == strcmp(g_sites[idx].p_site, p_site))
+        {
+            return g_sites[idx];
+        }
+    }
+
+    ck_abort_msg("site %s not found", p_site);
+    return g_sites[0];
+}
+
+START_TEST(test_default_allocator)
+{
+    ck_assert_ptr_nonnull(allocator_default());
+
+    char * p_memory = allocator_alloc(NULL, 16, ALLOC_SITE);
+    ck_assert_ptr_nonnull(p_memory);
+    memcpy(p_memory, "fifteen chars..", 16);
+
+    p_memory = allocator_realloc(NULL, p_memory, 4096, ALLOC_SITE);
+    ck_assert_ptr_nonnull(p_memory);
+    ck_assert_str_eq(p_memory, "fifteen chars..");
+    allocator_free(NULL, p_memory);
+    allocator_free(NULL, NULL);
+
+    uint8_t * p_zeroed = allocator_calloc(NULL, 64, 4, ALLOC_SITE);
+    ck_assert_ptr_nonnull(p_zeroed);
+    for (int idx = 0; idx < 256; idx++)
+    {
+        ck_assert_uint_eq(p_zeroed[idx], 0);
+    }
+    allocator_free(NULL, p_zeroed);
+
+    // count * size overflows before any memory is asked for
+    ck_assert_ptr_null(allocator_calloc(NULL, SIZE_MAX / 2, 4, ALLOC_SITE));
+}
+END_TEST
+
+START_TEST(test_tracker_counts_live_and_peak)
+{
+    alloc_tracker_t *   p_tracker = alloc_tracker_create(NULL, 0);
+    const allocator_t * p_alloc   = alloc_tracker_allocator(p_tracker);
+    alloc_stats_t       stats;
+
+    ck_assert_ptr_nonnull(p_alloc);
+
+    void * p_first  = allocator_alloc(p_alloc, 100, SITE_A);
+    void * p_second = allocator_alloc(p_alloc, 50, SITE_A);
+    ck_assert_ptr_nonnull(p_first);
+    ck_assert_ptr_nonnull(p_second);
+    allocator_free(p_alloc, p_first);
+    allocator_free(p_alloc, NULL);
+
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_ptr_null(stats.p_site);
+    ck_assert_uint_eq(stats.allocs, 2);
+    ck_assert_uint_eq(stats.frees, 1);
+    ck_assert_uint_eq(stats.reallocs, 0);
+    ck_assert_uint_eq(stats.failures, 0);
+    ck_assert_uint_eq(stats.total_bytes, 150);
+    ck_assert_uint_eq(stats.live_bytes, 50);
+    ck_assert_uint_eq(stats.peak_bytes, 150);
+
+    // A later peak only covers what follows the reset
+    alloc_tracker_reset_peak(p_tracker);
+    p_first = allocator_alloc(p_alloc, 20, SITE_A);
+    allocator_free(p_alloc, p_first);
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.peak_bytes, 70);
+    ck_assert_uint_eq(site_stats(p_tracker, SITE_A).peak_bytes, 70);
+
+    // Zeroed memory is counted like any other allocation
+    uint8_t * p_zeroed = allocator_calloc(p_alloc, 8, 8, SITE_A);
+    ck_assert_ptr_nonnull(p_zeroed);
+    ck_assert_uint_eq(p_zeroed[63], 0);
+    allocator_free(p_alloc, p_zeroed);
+    allocator_free(p_alloc, p_second);
+
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.allocs, 4);
+    ck_assert_uint_eq(stats.frees, 4);
+    ck_assert_uint_eq(stats.live_bytes, 0);
+
+    alloc_tracker_destroy(&p_tracker);
+    ck_assert_ptr_null(p_tracker);
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_tracker_attributes_sites)
+{
+    alloc_tracker_t *   p_tracker = alloc_tracker_create(NULL, 0);
+    const allocator_t * p_alloc   = alloc_tracker_allocator(p_tracker);
+    char                site_copy[] = "site_a.c:1";
+
+    void * p_a1 = allocator_alloc(p_alloc, 10, SITE_A);
+    void * p_b  = allocator_alloc(p_alloc, 30, SITE_B);
+
+    // The same "file:line" at another address is the same site
+    void * p_a2 = allocator_alloc(p_alloc, 5, site_copy);
+    allocator_free(p_alloc, p_a1);
+
+    ck_assert_uint_eq(alloc_tracker_sites(p_tracker, g_sites, 8), 2);
+    ck_assert_str_eq(g_sites[0].p_site, SITE_A);
+    ck_assert_str_eq(g_sites[1].p_site, SITE_B);
+
+    alloc_stats_t site_a = site_stats(p_tracker, SITE_A);
+    ck_assert_uint_eq(site_a.allocs, 2);
+    ck_assert_uint_eq(site_a.frees, 1);
+    ck_assert_uint_eq(site_a.live_bytes, 5);
+    ck_assert_uint_eq(site_a.peak_bytes, 15);
+
+    alloc_stats_t site_b = site_stats(p_tracker, SITE_B);
+    ck_assert_uint_eq(site_b.allocs, 1);
+    ck_assert_uint_eq(site_b.live_bytes, 30);
+
+    // Only as many entries as asked for are written
+    ck_assert_uint_eq(alloc_tracker_sites(p_tracker, g_sites, 1), 1);
+    ck_assert_uint_eq(alloc_tracker_sites(p_tracker, NULL, 8), 0);
+
+    allocator_free(p_alloc, p_a2);
+    allocator_free(p_alloc, p_b);
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_tracker_overflows_into_other)
+{
+    alloc_tracker_t *   p_tracker = alloc_tracker_create(NULL, 0);
+    const allocator_t * p_alloc   = alloc_tracker_allocator(p_tracker);
+    alloc_stats_t       stats;
+
+    for (uint32_t idx = 0; idx < EXTRA_SITES; idx++)
+    {
+        snprintf(g_site_names[idx], SITE_NAME_LEN, "site%u.c:%u", idx, idx);
+        allocator_free(p_alloc,
+                       allocator_alloc(p_alloc, 1, g_site_names[idx]));
+    }
+
+    uint32_t count
+        = alloc_tracker_sites(p_tracker, g_sites, EXTRA_SITES + 1);
+    ck_assert_uint_eq(count, ALLOC_TRACKER_MAX_SITES + 1);
+    ck_assert_str_eq(g_sites[0].p_site, g_site_names[0]);
+    ck_assert_str_eq(g_sites[count - 1].p_site, "other");
+    ck_assert_uint_eq(g_sites[count - 1].allocs,
+                      EXTRA_SITES - ALLOC_TRACKER_MAX_SITES);
+
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.allocs, EXTRA_SITES);
+    ck_assert_uint_eq(stats.live_bytes, 0);
+
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_tracker_realloc_moves_bytes)
+{
+    alloc_tracker_t *   p_tracker = alloc_tracker_create(NULL, 0);
+    const allocator_t * p_alloc   = alloc_tracker_allocator(p_tracker);
+    alloc_stats_t       stats;
+
+    // A resize of NULL is an allocation
+    char * p_block = allocator_realloc(p_alloc, NULL, 10, SITE_A);
+    ck_assert_ptr_nonnull(p_block);
+    memcpy(p_block, "123456789", 10);
+
+    p_block = allocator_realloc(p_alloc, p_block, 1000, SITE_B);
+    ck_assert_ptr_nonnull(p_block);
+    ck_assert_str_eq(p_block, "123456789");
+
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.allocs, 1);
+    ck_assert_uint_eq(stats.reallocs, 1);
+    ck_assert_uint_eq(stats.frees, 0);
+    ck_assert_uint_eq(stats.total_bytes, 1010);
+    ck_assert_uint_eq(stats.live_bytes, 1000);
+    ck_assert_uint_eq(stats.peak_bytes, 1000);
+
+    // The bytes belong to the site that resized the block
+    alloc_stats_t site_a = site_stats(p_tracker, SITE_A);
+    alloc_stats_t site_b = site_stats(p_tracker, SITE_B);
+    ck_assert_uint_eq(site_a.allocs, 1);
+    ck_assert_uint_eq(site_a.live_bytes, 0);
+    ck_assert_uint_eq(site_a.peak_bytes, 10);
+    ck_assert_uint_eq(site_b.allocs, 0);
+    ck_assert_uint_eq(site_b.reallocs, 1);
+    ck_assert_uint_eq(site_b.live_bytes, 1000);
+
+    // Shrinking lowers live bytes but not the peak
+    p_block = allocator_realloc(p_alloc, p_block, 4, SITE_B);
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.live_bytes, 4);
+    ck_assert_uint_eq(stats.peak_bytes, 1000);
+
+    allocator_free(p_alloc, p_block);
+    ck_assert_uint_eq(site_stats(p_tracker, SITE_B).frees, 1);
+    ck_assert_uint_eq(site_stats(p_tracker, SITE_B).live_bytes, 0);
+
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_tracker_counts_parent_failures)
+{
+    failing_ctx_t failing = { .budget = 1, .refused = 0 };
+    allocator_t   parent  = {
+          .alloc_fn   = failing_alloc,
+          .realloc_fn = failing_realloc,
+          .free_fn    = failing_free,
+          .p_ctx      = &failing,
+    };
+    alloc_tracker_t *   p_tracker = alloc_tracker_create(&parent, 0);
+    const allocator_t * p_alloc   = alloc_tracker_allocator(p_tracker);
+    alloc_stats_t       stats;
+
+    char * p_block = allocator_alloc(p_alloc, 8, SITE_A);
+    ck_assert_ptr_nonnull(p_block);
+    memcpy(p_block, "kept", 5);
+
+    // The budget is spent: both requests are refused and counted
+    ck_assert_ptr_null(allocator_alloc(p_alloc, 8, SITE_A));
+    ck_assert_ptr_null(allocator_realloc(p_alloc, p_block, 64, SITE_B));
+    ck_assert_int_eq(failing.refused, 2);
+    ck_assert_str_eq(p_block, "kept");
+
+    // A size the header cannot be added to never reaches the parent
+    ck_assert_ptr_null(allocator_alloc(p_alloc, SIZE_MAX, SITE_A));
+    ck_assert_int_eq(failing.refused, 2);
+
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.allocs, 1);
+    ck_assert_uint_eq(stats.reallocs, 0);
+    ck_assert_uint_eq(stats.failures, 3);
+    ck_assert_uint_eq(stats.live_bytes, 8);
+    ck_assert_uint_eq(site_stats(p_tracker, SITE_A).failures, 2);
+    ck_assert_uint_eq(site_stats(p_tracker, SITE_B).failures, 1);
+
+    allocator_free(p_alloc, p_block);
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.live_bytes, 0);
+
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_tracker_samples_stacks)
+{
+    alloc_tracker_t *   p_tracker = alloc_tracker_create(NULL, 3);
+    const allocator_t * p_alloc   = alloc_tracker_allocator(p_tracker);
+
+    for (size_t size = 1; size <= 10; size++)
+    {
+        allocator_free(p_alloc, allocator_alloc(p_alloc, size, SITE_A));
+    }
+
+    // Every third allocation, oldest first
+    ck_assert_uint_eq(alloc_tracker_samples(p_tracker, g_samples, 8), 3);
+    for (uint32_t idx = 0; idx < 3; idx++)
+    {
+        ck_assert_uint_eq(g_samples[idx].size, 3 * (idx + 1));
+        ck_assert_str_eq(g_samples[idx].p_site, SITE_A);
+        ck_assert_uint_le(g_samples[idx].frame_count,
+                          ALLOC_TRACKER_MAX_FRAMES);
+#if defined(__GLIBC__)
+        ck_assert_uint_gt(g_samples[idx].frame_count, 0);
+#endif
+    }
+
+    // Fewer requested entries give the most recent ones
+    ck_assert_uint_eq(alloc_tracker_samples(p_tracker, g_samples, 1), 1);
+    ck_assert_uint_eq(g_samples[0].size, 9);
+
+    FILE * p_output = tmpfile();
+    ck_assert_ptr_nonnull(p_output);
+    alloc_tracker_print(p_tracker, p_output);
+    ck_assert_int_gt(ftell(p_output), 0);
+    fclose(p_output);
+
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_tracker_keeps_recent_samples)
+{
+    alloc_tracker_t *   p_tracker = alloc_tracker_create(NULL, 1);
+    const allocator_t * p_alloc   = alloc_tracker_allocator(p_tracker);
+    size_t              last      = ALLOC_TRACKER_MAX_SAMPLES + 8u;
+
+    for (size_t size = 1; size <= last; size++)
+    {
+        allocator_free(p_alloc, allocator_alloc(p_alloc, size, SITE_B));
+    }
+
+    uint32_t count = alloc_tracker_samples(p_tracker,
+                                           g_samples,
+                                           ALLOC_TRACKER_MAX_SAMPLES);
+    ck_assert_uint_eq(count, ALLOC_TRACKER_MAX_SAMPLES);
+    ck_assert_uint_eq(g_samples[0].size, last - ALLOC_TRACKER_MAX_SAMPLES + 1);
+    ck_assert_uint_eq(g_samples[count - 1].size, last);
+
+    // No sampling at all without a rate
+    alloc_tracker_destroy(&p_tracker);
+    p_tracker = alloc_tracker_create(NULL, 0);
+    p_alloc   = alloc_tracker_allocator(p_tracker);
+    allocator_free(p_alloc, allocator_alloc(p_alloc, 1, SITE_B));
+    ck_assert_uint_eq(alloc_tracker_samples(p_tracker, g_samples, 8), 0);
+
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+//
+// Define test suite and add test cases
+//
+Suite *
+allocator_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Allocator");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_default_allocator);
+    tcase_add_test(tc_core, test_tracker_counts_live_and_peak);
+    tcase_add_test(tc_core, test_tracker_attributes_sites);
+    tcase_add_test(tc_core, test_tracker_overflows_into_other);
+    tcase_add_test(tc_core, test_tracker_realloc_moves_bytes);
+    tcase_add_test(tc_core, test_tracker_counts_parent_failures);
+    tcase_add_test(tc_core, test_tracker_samples_stacks);
+    tcase_add_test(tc_core, test_tracker_keeps_recent_samples);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = allocator_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -10,6 +10,9 @@
  #include <string.h>
  #include "dynamic_array.h"
  
+ /* Ranges this short are insertion sorted rather than partitioned further */
+ #define DYNAMIC_ARRAY_SELECT_CUTOFF (16u)
+ 
  /*!
   * @brief Resize the dynamic array to the new capacity.
   *
@@ -29,7 +32,7 @@
      }
      
      /* Allocate memory for the new array */
-     void **pp_new_data = (void **)realloc(p_array->pp_data, new_capacity * sizeof(void *));
+     void **pp_new_data = (void **)ALLOC_RESIZE(p_array->p_alloc, p_array->pp_data, new_capacity * sizeof(void *));
      
      if (NULL != pp_new_data)
      {
@@ -42,6 +45,258 @@
      return result;
  }
  
+ /*!
+  * @brief Capacity to grow a full array to.
+  *
+  * @param[in] p_array Pointer to the dynamic array.
+  *
+  * @return The capacity times the growth factor, and at least one more, capped
+  *         at UINT32_MAX; the current capacity if it cannot grow.
+  */
+ static uint32_t
+ grown_capacity(dynamic_array_t const * const p_array)
+ {
+     /* In double: for a huge array the product overflows uint32_t */
+     double grown = (double)p_array->capacity * (double)p_array->growth_factor;
+     
+     if (grown >= (double)UINT32_MAX)
+     {
+         return UINT32_MAX;
+     }
+     
+     uint32_t new_capacity = (uint32_t)grown;
+     
+     /* Ensure we grow by at least 1 */
+     if (new_capacity <= p_array->capacity)
+     {
+         new_capacity = p_array->capacity + 1;
+     }
+     
+     return new_capacity;
+ }
+ 
+ /*!
+  * @brief Swap two elements of an array.
+  *
+  * @param[in,out] pp_data Array of elements.
+  * @param[in] idx1 Index of the first element.
+  * @param[in] idx2 Index of the second element.
+  */
+ static inline void
+ swap_slots(void **pp_data, uint32_t idx1, uint32_t idx2)
+ {
+     void *p_temp = pp_data[idx1];
+     pp_data[idx1] = pp_data[idx2];
+     pp_data[idx2] = p_temp;
+ }
+ 
+ /*!
+  * @brief Sift an element down a max-heap laid out in pp_data[first, first + count).
+  *
+  * @param[in,out] pp_data Array of elements.
+  * @param[in] first Index of the heap's root.
+  * @param[in] count Number of elements in the heap.
+  * @param[in] idx Offset of the element to sift, from the root.
+  * @param[in] compare_fn Function used to compare elements.
+  */
+ static void
+ sift_down_max(void **pp_data, uint32_t first, uint32_t count, uint32_t idx,
+               dynamic_array_compare_func_t compare_fn)
+ {
+     void **pp_heap = pp_data + first;
+     
+     /* Iterative: the heap may hold most of a very large array */
+     while (idx < (count / 2))
+     {
+         uint32_t child = (2 * idx) + 1;
+         
+         if (((child + 1) < count) && (compare_fn(pp_heap[child], pp_heap[child + 1]) < 0))
+         {
+             child++;
+         }
+         
+         if (compare_fn(pp_heap[idx], pp_heap[child]) >= 0)
+         {
+             break;
+         }
+         
+         swap_slots(pp_heap, idx, child);
+         idx = child;
+     }
+ }
+ 
+ /*!
+  * @brief Heap sort pp_data[first, first + count) in ascending order.
+  *
+  * @param[in,out] pp_data Array of elements.
+  * @param[in] first Index of the first element to sort.
+  * @param[in] count Number of elements to sort.
+  * @param[in] compare_fn Function used to compare elements.
+  */
+ static void
+ heap_sort_range(void **pp_data, uint32_t first, uint32_t count, dynamic_array_compare_func_t compare_fn)
+ {
+     for (uint32_t idx = count / 2; idx > 0; idx--)
+     {
+         sift_down_max(pp_data, first, count, idx - 1, compare_fn);
+     }
+     
+     /* Move the greatest to the end and shrink the heap past it */
+     for (uint32_t end = count; end > 1; end--)
+     {
+         swap_slots(pp_data, first, first + end - 1);
+         sift_down_max(pp_data, first, end - 1, 0, compare_fn);
+     }
+ }
+ 
+ /*!
+  * @brief Insertion sort pp_data[lo, hi), for the short ranges quickselect ends on.
+  *
+  * @param[in,out] pp_data Array of elements.
+  * @param[in] lo Index of the first element to sort.
+  * @param[in] hi Index one past the last element to sort.
+  * @param[in] compare_fn Function used to compare elements.
+  */
+ static void
+ insertion_sort_range(void **pp_data, uint32_t lo, uint32_t hi, dynamic_array_compare_func_t compare_fn)
+ {
+     for (uint32_t idx = lo + 1; idx < hi; idx++)
+     {
+         void *p_data = pp_data[idx];
+         uint32_t hole = idx;
+         
+         while ((hole > lo) && (compare_fn(p_data, pp_data[hole - 1]) < 0))
+         {
+             pp_data[hole] = pp_data[hole - 1];
+             hole--;
+         }
+         
+         pp_data[hole] = p_data;
+     }
+ }
+ 
+ /*!
+  * @brief Heap select: the fallback when quickselect keeps partitioning badly.
+  *
+  * Keeps the least (nth - lo + 1) elements of pp_data[lo, hi) in a max-heap at the
+  * front of the range, then moves the greatest of them, the nth element, to nth.
+  *
+  * @param[in,out] pp_data Array of elements.
+  * @param[in] lo Index of the first element of the range.
+  * @param[in] hi Index one past the last element of the range.
+  * @param[in] nth Index of the element to select, in [lo, hi).
+  * @param[in] compare_fn Function used to compare elements.
+  */
+ static void
+ heap_select(void **pp_data, uint32_t lo, uint32_t hi, uint32_t nth, dynamic_array_compare_func_t compare_fn)
+ {
+     uint32_t count = nth - lo + 1;
+     
+     for (uint32_t idx = count / 2; idx > 0; idx--)
+     {
+         sift_down_max(pp_data, lo, count, idx - 1, compare_fn);
+     }
+     
+     for (uint32_t idx = nth + 1; idx < hi; idx++)
+     {
+         if (compare_fn(pp_data[idx], pp_data[lo]) < 0)
+         {
+             swap_slots(pp_data, idx, lo);
+             sift_down_max(pp_data, lo, count, 0, compare_fn);
+         }
+     }
+     
+     swap_slots(pp_data, lo, nth);
+ }
+ 
+ /*!
+  * @brief Introselect over pp_data[0, size).
+  *
+  * @param[in,out] pp_data Array of elements.
+  * @param[in] size Number of elements.
+  * @param[in] nth Index of the element to select.
+  * @param[in] compare_fn Function used to compare elements.
+  */
+ static void
+ introselect(void **pp_data, uint32_t size, uint32_t nth, dynamic_array_compare_func_t compare_fn)
+ {
+     uint32_t lo = 0;
+     uint32_t hi = size;
+     uint32_t depth_limit = 0;
+     
+     /* Allow 2 log2(n) partitions before switching to heap select */
+     for (uint32_t rest = size; rest > 1; rest >>= 1)
+     {
+         depth_limit += 2;
+     }
+     
+     while ((hi - lo) > DYNAMIC_ARRAY_SELECT_CUTOFF)
+     {
+         if (0 == depth_limit)
+         {
+             heap_select(pp_data, lo, hi, nth, compare_fn);
+             return;
+         }
+         
+         depth_limit--;
+         
+         /* Median of three: order lo, mid and hi - 1, which also bounds the scans below */
+         uint32_t mid = lo + ((hi - lo) / 2);
+         
+         if (compare_fn(pp_data[mid], pp_data[lo]) < 0)
+         {
+             swap_slots(pp_data, mid, lo);
+         }
+         
+         if (compare_fn(pp_data[hi - 1], pp_data[mid]) < 0)
+         {
+             swap_slots(pp_data, hi - 1, mid);
+             
+             if (compare_fn(pp_data[mid], pp_data[lo]) < 0)
+             {
+                 swap_slots(pp_data, mid, lo);
+             }
+         }
+         
+         /* Hoare partition around the median; both scans stop on equal elements */
+         void *p_pivot = pp_data[mid];
+         uint32_t left = lo;
+         uint32_t right = hi - 1;
+         
+         for (;;)
+         {
+             do
+             {
+                 left++;
+             } while (compare_fn(pp_data[left], p_pivot) < 0);
+             
+             do
+             {
+                 right--;
+             } while (compare_fn(p_pivot, pp_data[right]) < 0);
+             
+             if (left >= right)
+             {
+                 break;
+             }
+             
+             swap_slots(pp_data, left, right);
+         }
+         
+         /* pp_data[lo, right] <= pivot <= pp_data[right + 1, hi) */
+         if (nth <= right)
+         {
+             hi = right + 1;
+         }
+         else
+         {
+             lo = right + 1;
+         }
+     }
+     
+     insertion_sort_range(pp_data, lo, hi, compare_fn);
+ }
+ 
  /*!
   * @brief Initialize a dynamic array.
   *
@@ -53,6 +308,23 @@
   */
  bool
  dynamic_array_init(dynamic_array_t * const p_array, uint32_t initial_capacity, float growth_factor)
+ {
+     return dynamic_array_init_ex(p_array, initial_capacity, growth_factor, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a dynamic array whose storage comes from an allocator.
+  *
+  * @param[in,out] p_array Pointer to the dynamic array to initialize.
+  * @param[in] initial_capacity Initial capacity of the array.
+  * @param[in] growth_factor Factor by which to grow the array when needed.
+  * @param[in] p_alloc Allocator for the array's storage, NULL for the default.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ dynamic_array_init_ex(dynamic_array_t * const p_array, uint32_t initial_capacity, float growth_factor,
+                       const allocator_t *p_alloc)
  {
      bool result = false;
      
@@ -73,7 +345,8 @@
      }
      
      /* Allocate memory for the data array */
-     p_array->pp_data = (void **)malloc(initial_capacity * sizeof(void *));
+     p_array->p_alloc = p_alloc;
+     p_array->pp_data = (void **)ALLOC_NEW(p_alloc, initial_capacity * sizeof(void *));
      
      if (NULL != p_array->pp_data)
      {
@@ -108,15 +381,9 @@
      /* Check if we need to resize the array */
      if (p_array->size >= p_array->capacity)
      {
-         uint32_t new_capacity = (uint32_t)(p_array->capacity * p_array->growth_factor);
-         
-         /* Ensure we grow by at least 1 */
-         if (new_capacity <= p_array->capacity)
-         {
-             new_capacity = p_array->capacity + 1;
-         }
+         uint32_t new_capacity = grown_capacity(p_array);
          
-         if (!resize_array(p_array, new_capacity))
+         if ((new_capacity == p_array->capacity) || !resize_array(p_array, new_capacity))
          {
              return result;
          }
@@ -164,15 +431,9 @@
      /* Check if we need to resize the array */
      if (p_array->size >= p_array->capacity)
      {
-         uint32_t new_capacity = (uint32_t)(p_array->capacity * p_array->growth_factor);
+         uint32_t new_capacity = grown_capacity(p_array);
          
-         /* Ensure we grow by at least 1 */
-         if (new_capacity <= p_array->capacity)
-         {
-             new_capacity = p_array->capacity + 1;
-         }
-         
-         if (!resize_array(p_array, new_capacity))
+         if ((new_capacity == p_array->capacity) || !resize_array(p_array, new_capacity))
          {
              return result;
          }
@@ -390,7 +651,7 @@
      if (0 == p_array->size)
      {
          /* Special case: empty array, free memory but keep a minimal capacity */
-         void **pp_new_data = (void **)realloc(p_array->pp_data, sizeof(void *));
+         void **pp_new_data = (void **)ALLOC_RESIZE(p_array->p_alloc, p_array->pp_data, sizeof(void *));
          
          if (NULL != pp_new_data)
          {
@@ -412,6 +673,69 @@
      return result;
  }
  
+ /*!
+  * @brief Reorder the array so that the element at position is the one a full sort
+  * would put there.
+  *
+  * @param[in,out] p_array Pointer to the dynamic array.
+  * @param[in] position Position of the element to select (0-based).
+  * @param[in] compare_fn Function used to compare elements.
+  *
+  * @return true if the array was reordered, false if the parameters are invalid.
+  */
+ bool
+ dynamic_array_nth_element(dynamic_array_t * const p_array, uint32_t position,
+                           dynamic_array_compare_func_t compare_fn)
+ {
+     if ((NULL == p_array) || (NULL == p_array->pp_data) || (NULL == compare_fn) ||
+         (position >= p_array->size))
+     {
+         return false;
+     }
+     
+     introselect(p_array->pp_data, p_array->size, position, compare_fn);
+     
+     return true;
+ }
+ 
+ /*!
+  * @brief Sort the count least elements of the array into its first count positions.
+  *
+  * @param[in,out] p_array Pointer to the dynamic array.
+  * @param[in] count Number of elements to sort; at most the size of the array.
+  * @param[in] compare_fn Function used to compare elements.
+  *
+  * @return true if the array was reordered, false if the parameters are invalid.
+  */
+ bool
+ dynamic_array_partial_sort(dynamic_array_t * const p_array, uint32_t count,
+                            dynamic_array_compare_func_t compare_fn)
+ {
+     if ((NULL == p_array) || (NULL == p_array->pp_data) || (NULL == compare_fn) ||
+         (count > p_array->size))
+     {
+         return false;
+     }
+     
+     if (0 == count)
+     {
+         return true;
+     }
+     
+     uint32_t sort_count = count;
+     
+     /* Gather the count least at the front; the greatest of them is then in place */
+     if (count < p_array->size)
+     {
+         introselect(p_array->pp_data, p_array->size, count - 1, compare_fn);
+         sort_count = count - 1;
+     }
+     
+     heap_sort_range(p_array->pp_data, 0, sort_count, compare_fn);
+     
+     return true;
+ }
+ 
  /*!
   * @brief Clear the dynamic array, removing all elements.
   *
@@ -472,7 +796,7 @@
          }
          
          /* Free the array itself */
-         free(p_array->pp_data);
+         ALLOC_FREE(p_array->p_alloc, p_array->pp_data);
          p_array->pp_data = NULL;
      }
      
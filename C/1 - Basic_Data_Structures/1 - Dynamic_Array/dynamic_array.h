@@ -11,6 +11,7 @@
  
  #include <stdint.h>
  #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
  
  /**
   * @brief Structure representing a dynamic array.
@@ -21,8 +22,19 @@
      uint32_t   capacity;      /* Current capacity of the array */
      uint32_t   size;          /* Number of elements in the array */
      float      growth_factor; /* Factor by which to grow the array when needed */
+     const allocator_t *p_alloc; /* Allocator for pp_data (NULL for malloc) */
  } dynamic_array_t;
  
+ /**
+  * @brief Typedef for the comparison function used to order the elements.
+  *
+  * @param[in] p_data1 Pointer to the first data item to compare.
+  * @param[in] p_data2 Pointer to the second data item to compare.
+  *
+  * @return Negative value if p_data1 < p_data2, 0 if equal, positive if p_data1 > p_data2.
+  */
+ typedef int32_t (*dynamic_array_compare_func_t)(const void *p_data1, const void *p_data2);
+ 
  /**
   * @brief Initialize a dynamic array.
   *
@@ -34,6 +46,22 @@
   */
  bool dynamic_array_init(dynamic_array_t * const p_array, uint32_t initial_capacity, float growth_factor);
  
+ /**
+  * @brief Initialize a dynamic array whose storage comes from an allocator.
+  *
+  * @param[in,out] p_array Pointer to the dynamic array to initialize.
+  * @param[in] initial_capacity Initial capacity of the array.
+  * @param[in] growth_factor Factor by which to grow the array when needed.
+  * @param[in] p_alloc Allocator for the array's storage, NULL for the default.
+  *                    Must outlive the array. For arrays of many gigabytes, an
+  *                    alloc_mapped_t (see alloc_mapped.h) grows the storage
+  *                    without copying it.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool dynamic_array_init_ex(dynamic_array_t * const p_array, uint32_t initial_capacity, float growth_factor,
+                            const allocator_t *p_alloc);
+ 
  /**
   * @brief Add a new element to the end of the dynamic array.
   *
@@ -132,6 +160,40 @@
   */
  bool dynamic_array_trim_to_size(dynamic_array_t * const p_array);
  
+ /**
+  * @brief Reorder the array so that the element at position is the one a full sort
+  * would put there, with no element before it greater and no element after it less.
+  *
+  * Uses introselect: quickselect with a median-of-three pivot, switching to a heap
+  * select if partitioning goes badly, so it takes O(n) on average and O(n log n) at
+  * worst. The order within either side is unspecified.
+  *
+  * @param[in,out] p_array Pointer to the dynamic array.
+  * @param[in] position Position of the element to select (0-based).
+  * @param[in] compare_fn Function used to compare elements.
+  *
+  * @return true if the array was reordered, false if the parameters are invalid.
+  */
+ bool dynamic_array_nth_element(dynamic_array_t * const p_array, uint32_t position,
+                                dynamic_array_compare_func_t compare_fn);
+ 
+ /**
+  * @brief Sort the count least elements of the array into its first count positions.
+  *
+  * The rest follow in unspecified order. Selects the count least with
+  * dynamic_array_nth_element() and heap sorts just those, O(n + k log k) on average
+  * for k = count, much less than sorting the whole array when k is small. The sort
+  * is not stable.
+  *
+  * @param[in,out] p_array Pointer to the dynamic array.
+  * @param[in] count Number of elements to sort; at most the size of the array.
+  * @param[in] compare_fn Function used to compare elements.
+  *
+  * @return true if the array was reordered, false if the parameters are invalid.
+  */
+ bool dynamic_array_partial_sort(dynamic_array_t * const p_array, uint32_t count,
+                                 dynamic_array_compare_func_t compare_fn);
+ 
  /**
   * @brief Clear the dynamic array, removing all elements.
   *
@@ -0,0 +1,256 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "dynamic_array.h"
+
+#define ARRAY_SIZE (1000u)
+
+// Small non-zero integers are carried in the data pointer
+#define AS_PTR(n) ((void *)(uintptr_t)(n))
+#define AS_INT(p) ((uint32_t)(uintptr_t)(p))
+
+typedef enum
+{
+    PATTERN_RANDOM,
+    PATTERN_FEW_KEYS,
+    PATTERN_SORTED,
+    PATTERN_REVERSED,
+    PATTERN_ORGAN_PIPE,
+    PATTERN_EQUAL,
+    PATTERN_COUNT
+} pattern_t;
+
+static uint32_t g_sorted[ARRAY_SIZE];
+
+static int32_t
+int_compare(const void * p_data1, const void * p_data2)
+{
+    return (AS_INT(p_data1) > AS_INT(p_data2))
+           - (AS_INT(p_data1) < AS_INT(p_data2));
+}
+
+static int
+qsort_compare(const void * p_data1, const void * p_data2)
+{
+    uint32_t value1 = *(const uint32_t *)p_data1;
+    uint32_t value2 = *(const uint32_t *)p_data2;
+
+    return (value1 > value2) - (value1 < value2);
+}
+
+static uint32_t
+pattern_value(pattern_t pattern, uint32_t idx, uint64_t * p_state)
+{
+    *p_state ^= *p_state << 13;
+    *p_state ^= *p_state >> 7;
+    *p_state ^= *p_state << 17;
+
+    switch (pattern)
+    {
+        case PATTERN_RANDOM:
+            return 1 + (uint32_t)(*p_state % 1000000u);
+        case PATTERN_FEW_KEYS:
+            return 1 + (uint32_t)(*p_state % 4u);
+        case PATTERN_SORTED:
+            return 1 + idx;
+        case PATTERN_REVERSED:
+            return ARRAY_SIZE - idx;
+        case PATTERN_ORGAN_PIPE:
+            return 1 + ((idx < ARRAY_SIZE / 2) ? idx : ARRAY_SIZE - idx);
+        default:
+            return 7;
+    }
+}
+
+// Fills the array with a pattern and keeps a fully sorted copy to check against
+static void
+fill(dynamic_array_t * p_array, pattern_t pattern)
+{
+    uint64_t state = 88172645463325252ull + (uint64_t)pattern;
+
+    dynamic_array_clear(p_array, false);
+
+    for (uint32_t idx = 0; idx < ARRAY_SIZE; idx++)
+    {
+        g_sorted[idx] = pattern_value(pattern, idx, &state);
+        ck_assert(dynamic_array_add(p_array, AS_PTR(g_sorted[idx])));
+    }
+
+    qsort(g_sorted, ARRAY_SIZE, sizeof(g_sorted[0]), qsort_compare);
+}
+
+// Checks the array still holds the same values as the sorted copy
+static void
+assert_same_values(const dynamic_array_t * p_array)
+{
+    uint32_t * p_values = malloc(ARRAY_SIZE * sizeof(uint32_t));
+
+    ck_assert_ptr_nonnull(p_values);
+    ck_assert_uint_eq(dynamic_array_size(p_array), ARRAY_SIZE);
+
+    for (uint32_t idx = 0; idx < ARRAY_SIZE; idx++)
+    {
+        p_values[idx] = AS_INT(dynamic_array_get_at(p_array, idx));
+    }
+
+    qsort(p_values, ARRAY_SIZE, sizeof(p_values[0]), qsort_compare);
+    for (uint32_t idx = 0; idx < ARRAY_SIZE; idx++)
+    {
+        ck_assert_uint_eq(p_values[idx], g_sorted[idx]);
+    }
+
+    free(p_values);
+}
+
+START_TEST(test_nth_element_partitions)
+{
+    dynamic_array_t array;
+    const uint32_t  positions[] = { 0, 1, 250, ARRAY_SIZE / 2, 998,
+                                    ARRAY_SIZE - 1 };
+
+    ck_assert(dynamic_array_init(&array, ARRAY_SIZE, 2.0f));
+
+    for (pattern_t pattern = PATTERN_RANDOM; pattern < PATTERN_COUNT;
+         pattern++)
+    {
+        for (size_t test = 0; test < sizeof(positions) / sizeof(positions[0]);
+             test++)
+        {
+            uint32_t position = positions[test];
+
+            fill(&array, pattern);
+            ck_assert(dynamic_array_nth_element(&array, position,
+                                                int_compare));
+
+            // The selected element is the one a full sort puts there, with
+            // nothing greater before it and nothing less after it
+            uint32_t nth = AS_INT(dynamic_array_get_at(&array, position));
+            ck_assert_uint_eq(nth, g_sorted[position]);
+
+            for (uint32_t idx = 0; idx < ARRAY_SIZE; idx++)
+            {
+                uint32_t value = AS_INT(dynamic_array_get_at(&array, idx));
+
+                if (idx < position)
+                {
+                    ck_assert_uint_le(value, nth);
+                }
+                else if (idx > position)
+                {
+                    ck_assert_uint_ge(value, nth);
+                }
+            }
+
+            assert_same_values(&array);
+        }
+    }
+
+    dynamic_array_destroy(&array, false);
+}
+END_TEST
+
+START_TEST(test_partial_sort_prefix)
+{
+    dynamic_array_t array;
+    const uint32_t  counts[] = { 0, 1, 2, 10, ARRAY_SIZE - 1, ARRAY_SIZE };
+
+    ck_assert(dynamic_array_init(&array, ARRAY_SIZE, 2.0f));
+
+    for (pattern_t pattern = PATTERN_RANDOM; pattern < PATTERN_COUNT;
+         pattern++)
+    {
+        for (size_t test = 0; test < sizeof(counts) / sizeof(counts[0]);
+             test++)
+        {
+            uint32_t count = counts[test];
+
+            fill(&array, pattern);
+            ck_assert(dynamic_array_partial_sort(&array, count, int_compare));
+
+            // The first count positions hold the least values in order and
+            // nothing after them is smaller than the last of them
+            for (uint32_t idx = 0; idx < count; idx++)
+            {
+                ck_assert_uint_eq(AS_INT(dynamic_array_get_at(&array, idx)),
+                                  g_sorted[idx]);
+            }
+            for (uint32_t idx = count; (count > 0) && (idx < ARRAY_SIZE);
+                 idx++)
+            {
+                ck_assert_uint_ge(AS_INT(dynamic_array_get_at(&array, idx)),
+                                  g_sorted[count - 1]);
+            }
+
+            assert_same_values(&array);
+        }
+    }
+
+    dynamic_array_destroy(&array, false);
+}
+END_TEST
+
+START_TEST(test_select_invalid_parameters)
+{
+    dynamic_array_t array;
+
+    ck_assert(dynamic_array_init(&array, 4, 2.0f));
+
+    // Nothing to select from an empty array
+    ck_assert(!dynamic_array_nth_element(&array, 0, int_compare));
+    ck_assert(dynamic_array_partial_sort(&array, 0, int_compare));
+
+    ck_assert(dynamic_array_add(&array, AS_PTR(2)));
+    ck_assert(dynamic_array_add(&array, AS_PTR(1)));
+
+    ck_assert(!dynamic_array_nth_element(&array, 2, int_compare));
+    ck_assert(!dynamic_array_nth_element(&array, 0, NULL));
+    ck_assert(!dynamic_array_partial_sort(&array, 3, int_compare));
+    ck_assert(!dynamic_array_partial_sort(NULL, 1, int_compare));
+
+    // A refused call leaves the array alone
+    ck_assert_uint_eq(AS_INT(dynamic_array_get_at(&array, 0)), 2);
+    ck_assert_uint_eq(AS_INT(dynamic_array_get_at(&array, 1)), 1);
+
+    dynamic_array_destroy(&array, false);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+dynamic_array_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Dynamic_Array");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_nth_element_partitions);
+    tcase_add_test(tc_core, test_partial_sort_prefix);
+    tcase_add_test(tc_core, test_select_invalid_parameters);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = dynamic_array_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
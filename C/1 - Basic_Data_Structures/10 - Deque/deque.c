@@ -0,0 +1,427 @@
+/** @file deque.c
+ *
+ * @brief Implementation of the ring-buffer deque.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+ #include <stdlib.h>
+ #include <string.h>
+ #include "deque.h"
+ 
+ #define DEQUE_MIN_CAPACITY   (8u)           /* Smallest ring */
+ #define DEQUE_MAX_CAPACITY   (1u << 31)     /* Largest ring */
+ 
+ /*!
+  * @brief Slot holding the element at a position counted from the front.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  * @param[in] position Position of the element (0-based).
+  *
+  * @return Index into pp_data.
+  */
+ static inline uint32_t
+ slot_of(const deque_t *p_deque, uint32_t position)
+ {
+     return (p_deque->head + position) & (p_deque->capacity - 1u);
+ }
+ 
+ /*!
+  * @brief Grow the ring to a larger power of two, keeping the elements in order.
+  *
+  * The block is resized first, so it is extended in place where the allocator
+  * can. If the elements wrapped around the end of the old ring, the shorter of
+  * the two parts is then moved: the front part to follow the old end, or the
+  * part from head on to the end of the new ring.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] new_capacity New number of slots, a power of two larger than now.
+  *
+  * @return true if the ring was grown, false otherwise.
+  */
+ static bool
+ grow_ring(deque_t *p_deque, uint32_t new_capacity)
+ {
+     void **pp_new_data = (void **)ALLOC_RESIZE(p_deque->p_alloc, p_deque->pp_data,
+                                                (size_t)new_capacity * sizeof(void *));
+ 
+     if (NULL == pp_new_data)
+     {
+         return false;
+     }
+ 
+     uint32_t old_capacity = p_deque->capacity;
+     uint32_t upper = old_capacity - p_deque->head;      /* Slots from head to the old end */
+ 
+     if (p_deque->size > upper)
+     {
+         uint32_t lower = p_deque->size - upper;         /* Elements wrapped to the start */
+ 
+         if (lower <= upper)
+         {
+             memcpy(pp_new_data + old_capacity, pp_new_data, (size_t)lower * sizeof(void *));
+         }
+         else
+         {
+             uint32_t new_head = new_capacity - upper;
+ 
+             memmove(pp_new_data + new_head, pp_new_data + p_deque->head, (size_t)upper * sizeof(void *));
+             p_deque->head = new_head;
+         }
+     }
+ 
+     p_deque->pp_data = pp_new_data;
+     p_deque->capacity = new_capacity;
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Make room for one more element.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  *
+  * @return true if there is a free slot, false if the ring could not grow.
+  */
+ static bool
+ make_room(deque_t *p_deque)
+ {
+     if (p_deque->size < p_deque->capacity)
+     {
+         return true;
+     }
+ 
+     if (p_deque->capacity >= DEQUE_MAX_CAPACITY)
+     {
+         return false;
+     }
+ 
+     return grow_ring(p_deque, p_deque->capacity * 2u);
+ }
+ 
+ /*!
+  * @brief Initialize a deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ deque_init(deque_t *p_deque, uint32_t initial_capacity)
+ {
+     return deque_init_ex(p_deque, initial_capacity, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a deque whose storage comes from an allocator.
+  *
+  * @param[in,out] p_deque Pointer to the deque to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] p_alloc Allocator for the deque's storage, NULL for the default.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ deque_init_ex(deque_t *p_deque, uint32_t initial_capacity, const allocator_t *p_alloc)
+ {
+     if (NULL == p_deque)
+     {
+         return false;
+     }
+ 
+     uint32_t capacity = DEQUE_MIN_CAPACITY;
+ 
+     while ((capacity < initial_capacity) && (capacity < DEQUE_MAX_CAPACITY))
+     {
+         capacity *= 2u;
+     }
+ 
+     memset(p_deque, 0, sizeof(*p_deque));
+     p_deque->p_alloc = p_alloc;
+     p_deque->pp_data = (void **)ALLOC_NEW(p_alloc, (size_t)capacity * sizeof(void *));
+ 
+     if (NULL == p_deque->pp_data)
+     {
+         return false;
+     }
+ 
+     p_deque->capacity = capacity;
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Add an element at the front of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] p_data Pointer to the data to be stored.
+  *
+  * @return true if the element was added, false otherwise.
+  */
+ bool
+ deque_push_front(deque_t *p_deque, void *p_data)
+ {
+     if ((NULL == p_deque) || (NULL == p_deque->pp_data) || !make_room(p_deque))
+     {
+         return false;
+     }
+ 
+     p_deque->head = (p_deque->head - 1u) & (p_deque->capacity - 1u);
+     p_deque->pp_data[p_deque->head] = p_data;
+     p_deque->size++;
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Add an element at the back of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] p_data Pointer to the data to be stored.
+  *
+  * @return true if the element was added, false otherwise.
+  */
+ bool
+ deque_push_back(deque_t *p_deque, void *p_data)
+ {
+     if ((NULL == p_deque) || (NULL == p_deque->pp_data) || !make_room(p_deque))
+     {
+         return false;
+     }
+ 
+     p_deque->pp_data[slot_of(p_deque, p_deque->size)] = p_data;
+     p_deque->size++;
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Remove the element at the front of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data removed, or NULL if the deque is empty.
+  */
+ void *
+ deque_pop_front(deque_t *p_deque)
+ {
+     if ((NULL == p_deque) || (0 == p_deque->size))
+     {
+         return NULL;
+     }
+ 
+     void *p_data = p_deque->pp_data[p_deque->head];
+ 
+     p_deque->head = (p_deque->head + 1u) & (p_deque->capacity - 1u);
+     p_deque->size--;
+ 
+     return p_data;
+ }
+ 
+ /*!
+  * @brief Remove the element at the back of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data removed, or NULL if the deque is empty.
+  */
+ void *
+ deque_pop_back(deque_t *p_deque)
+ {
+     if ((NULL == p_deque) || (0 == p_deque->size))
+     {
+         return NULL;
+     }
+ 
+     p_deque->size--;
+ 
+     return p_deque->pp_data[slot_of(p_deque, p_deque->size)];
+ }
+ 
+ /*!
+  * @brief Get the element at the front of the deque without removing it.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data at the front, or NULL if the deque is empty.
+  */
+ void *
+ deque_peek_front(const deque_t *p_deque)
+ {
+     return deque_get_at(p_deque, 0);
+ }
+ 
+ /*!
+  * @brief Get the element at the back of the deque without removing it.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data at the back, or NULL if the deque is empty.
+  */
+ void *
+ deque_peek_back(const deque_t *p_deque)
+ {
+     if ((NULL == p_deque) || (0 == p_deque->size))
+     {
+         return NULL;
+     }
+ 
+     return p_deque->pp_data[slot_of(p_deque, p_deque->size - 1u)];
+ }
+ 
+ /*!
+  * @brief Get the element at the specified position, counted from the front.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  * @param[in] position Position of the element to get (0-based).
+  *
+  * @return Pointer to the data at the position, or NULL if the position is invalid.
+  */
+ void *
+ deque_get_at(const deque_t *p_deque, uint32_t position)
+ {
+     if ((NULL == p_deque) || (position >= p_deque->size))
+     {
+         return NULL;
+     }
+ 
+     return p_deque->pp_data[slot_of(p_deque, position)];
+ }
+ 
+ /*!
+  * @brief Set the element at the specified position, counted from the front.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] position Position of the element to set (0-based).
+  * @param[in] p_data Pointer to the new data to be stored.
+  *
+  * @return Pointer to the old data at the position, or NULL if the position is invalid.
+  */
+ void *
+ deque_set_at(deque_t *p_deque, uint32_t position, void *p_data)
+ {
+     if ((NULL == p_deque) || (position >= p_deque->size))
+     {
+         return NULL;
+     }
+ 
+     uint32_t slot = slot_of(p_deque, position);
+     void *p_old_data = p_deque->pp_data[slot];
+ 
+     p_deque->pp_data[slot] = p_data;
+ 
+     return p_old_data;
+ }
+ 
+ /*!
+  * @brief Get the size of the deque.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return Number of elements in the deque.
+  */
+ uint32_t
+ deque_size(const deque_t *p_deque)
+ {
+     return (NULL == p_deque) ? 0 : p_deque->size;
+ }
+ 
+ /*!
+  * @brief Check if the deque is empty.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return true if the deque is empty or NULL, false otherwise.
+  */
+ bool
+ deque_is_empty(const deque_t *p_deque)
+ {
+     return (NULL == p_deque) || (0 == p_deque->size);
+ }
+ 
+ /*!
+  * @brief Ensure the deque has at least the specified capacity.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] min_capacity Minimum number of slots, rounded up to a power of two.
+  *
+  * @return true if the capacity was ensured successfully, false otherwise.
+  */
+ bool
+ deque_reserve(deque_t *p_deque, uint32_t min_capacity)
+ {
+     if ((NULL == p_deque) || (NULL == p_deque->pp_data) || (min_capacity > DEQUE_MAX_CAPACITY))
+     {
+         return false;
+     }
+ 
+     if (p_deque->capacity >= min_capacity)
+     {
+         return true;
+     }
+ 
+     uint32_t capacity = p_deque->capacity;
+ 
+     while (capacity < min_capacity)
+     {
+         capacity *= 2u;
+     }
+ 
+     return grow_ring(p_deque, capacity);
+ }
+ 
+ /*!
+  * @brief Clear the deque, removing all elements.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] b_free_data Flag indicating whether to free the data pointed to by each element.
+  */
+ void
+ deque_clear(deque_t *p_deque, bool b_free_data)
+ {
+     if ((NULL == p_deque) || (NULL == p_deque->pp_data))
+     {
+         return;
+     }
+ 
+     if (b_free_data)
+     {
+         /* Free each element's data if requested */
+         for (uint32_t position = 0; position < p_deque->size; position++)
+         {
+             free(p_deque->pp_data[slot_of(p_deque, position)]);
+         }
+     }
+ 
+     /* Reset the size, but keep the capacity */
+     p_deque->head = 0;
+     p_deque->size = 0;
+ }
+ 
+ /*!
+  * @brief Destroy the deque, freeing all memory associated with it.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] b_free_data Flag indicating whether to free the data pointed to by each element.
+  */
+ void
+ deque_destroy(deque_t *p_deque, bool b_free_data)
+ {
+     if (NULL == p_deque)
+     {
+         return;
+     }
+ 
+     deque_clear(p_deque, b_free_data);
+ 
+     if (NULL != p_deque->pp_data)
+     {
+         ALLOC_FREE(p_deque->p_alloc, p_deque->pp_data);
+         p_deque->pp_data = NULL;
+     }
+ 
+     p_deque->capacity = 0;
+ }
+ /*** end of file ***/
@@ -0,0 +1,181 @@
+/** @file deque.h
+ *
+ * @brief A double-ended queue in a power-of-two ring buffer.
+ *
+ * The elements sit in one contiguous array used as a ring: push and pop at
+ * either end are O(1) and touch a single slot, and the n-th element is
+ * found with an add and a mask. When the ring is full it doubles, in place
+ * where the allocator can extend the block, moving only the shorter of the
+ * two wrapped parts. Nothing is allocated per element, so a deque running
+ * as a stack (push_back/pop_back, LIFO) or a queue (push_back/pop_front,
+ * FIFO) keeps its working set in a few cache lines; see stack_init_ring()
+ * and queue_create_ring() for stack_t and queue_t running on one.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+ #ifndef DEQUE_H
+ #define DEQUE_H
+ 
+ #include <stdint.h>
+ #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
+ 
+ /**
+  * @brief Structure representing a deque.
+  */
+ typedef struct
+ {
+     void               **pp_data;       /* Ring of capacity slots */
+     uint32_t             capacity;      /* Number of slots, a power of two */
+     uint32_t             head;          /* Slot of the front element */
+     uint32_t             size;          /* Number of elements in the deque */
+     const allocator_t   *p_alloc;       /* Allocator for pp_data (NULL for malloc) */
+ } deque_t;
+ 
+ /**
+  * @brief Initialize a deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool deque_init(deque_t *p_deque, uint32_t initial_capacity);
+ 
+ /**
+  * @brief Initialize a deque whose storage comes from an allocator.
+  *
+  * @param[in,out] p_deque Pointer to the deque to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] p_alloc Allocator for the deque's storage, NULL for the default.
+  *                    Must outlive the deque.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool deque_init_ex(deque_t *p_deque, uint32_t initial_capacity, const allocator_t *p_alloc);
+ 
+ /**
+  * @brief Add an element at the front of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] p_data Pointer to the data to be stored.
+  *
+  * @return true if the element was added, false if the deque could not grow.
+  */
+ bool deque_push_front(deque_t *p_deque, void *p_data);
+ 
+ /**
+  * @brief Add an element at the back of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] p_data Pointer to the data to be stored.
+  *
+  * @return true if the element was added, false if the deque could not grow.
+  */
+ bool deque_push_back(deque_t *p_deque, void *p_data);
+ 
+ /**
+  * @brief Remove the element at the front of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data removed, or NULL if the deque is empty.
+  */
+ void *deque_pop_front(deque_t *p_deque);
+ 
+ /**
+  * @brief Remove the element at the back of the deque.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data removed, or NULL if the deque is empty.
+  */
+ void *deque_pop_back(deque_t *p_deque);
+ 
+ /**
+  * @brief Get the element at the front of the deque without removing it.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data at the front, or NULL if the deque is empty.
+  */
+ void *deque_peek_front(const deque_t *p_deque);
+ 
+ /**
+  * @brief Get the element at the back of the deque without removing it.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return Pointer to the data at the back, or NULL if the deque is empty.
+  */
+ void *deque_peek_back(const deque_t *p_deque);
+ 
+ /**
+  * @brief Get the element at the specified position, counted from the front.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  * @param[in] position Position of the element to get (0-based).
+  *
+  * @return Pointer to the data at the position, or NULL if the position is invalid.
+  */
+ void *deque_get_at(const deque_t *p_deque, uint32_t position);
+ 
+ /**
+  * @brief Set the element at the specified position, counted from the front.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] position Position of the element to set (0-based).
+  * @param[in] p_data Pointer to the new data to be stored.
+  *
+  * @return Pointer to the old data at the position, or NULL if the position is invalid.
+  */
+ void *deque_set_at(deque_t *p_deque, uint32_t position, void *p_data);
+ 
+ /**
+  * @brief Get the size of the deque.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return Number of elements in the deque.
+  */
+ uint32_t deque_size(const deque_t *p_deque);
+ 
+ /**
+  * @brief Check if the deque is empty.
+  *
+  * @param[in] p_deque Pointer to the deque.
+  *
+  * @return true if the deque is empty or NULL, false otherwise.
+  */
+ bool deque_is_empty(const deque_t *p_deque);
+ 
+ /**
+  * @brief Ensure the deque has at least the specified capacity.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] min_capacity Minimum number of slots, rounded up to a power of two.
+  *
+  * @return true if the capacity was ensured successfully, false otherwise.
+  */
+ bool deque_reserve(deque_t *p_deque, uint32_t min_capacity);
+ 
+ /**
+  * @brief Clear the deque, removing all elements. The capacity is kept.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] b_free_data Flag indicating whether to free the data pointed to by each element.
+  */
+ void deque_clear(deque_t *p_deque, bool b_free_data);
+ 
+ /**
+  * @brief Destroy the deque, freeing all memory associated with it.
+  *
+  * @param[in,out] p_deque Pointer to the deque.
+  * @param[in] b_free_data Flag indicating whether to free the data pointed to by each element.
+  */
+ void deque_destroy(deque_t *p_deque, bool b_free_data);
+ 
+ #endif /* DEQUE_H */
+ /*** end of file ***/
@@ -0,0 +1,329 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "deque.h"
+#include "../3 - Stack/stack.h"
+#include "../4 - Queue/queue.h"
+
+#define OPERATIONS (20000u)
+#define MODEL_SIZE (2u * OPERATIONS + 1u)
+
+// Small non-zero integers are carried in the data pointer
+#define AS_PTR(n) ((void *)(uintptr_t)(n))
+#define AS_INT(p) ((uint32_t)(uintptr_t)(p))
+
+// A deque that cannot wrap, grown from the middle of a large array
+static uint32_t g_model[MODEL_SIZE];
+
+// Checks every position of the deque against the model
+static void
+assert_matches(const deque_t * p_deque, uint32_t first, uint32_t size)
+{
+    ck_assert_uint_eq(deque_size(p_deque), size);
+    ck_assert(deque_is_empty(p_deque) == (0 == size));
+
+    for (uint32_t idx = 0; idx < size; idx++)
+    {
+        ck_assert_uint_eq(AS_INT(deque_get_at(p_deque, idx)),
+                          g_model[first + idx]);
+    }
+
+    ck_assert_ptr_null(deque_get_at(p_deque, size));
+}
+
+// Returns the number of allocations a tracker has seen
+static uint64_t
+alloc_count(const alloc_tracker_t * p_tracker)
+{
+    alloc_stats_t stats;
+
+    alloc_tracker_stats(p_tracker, &stats);
+    return stats.allocs + stats.reallocs;
+}
+
+START_TEST(test_deque_random_operations)
+{
+    deque_t  deque;
+    uint32_t first = OPERATIONS;
+    uint32_t size  = 0;
+    uint64_t state = 88172645463325252ull;
+
+    ck_assert(deque_init(&deque, 2));
+
+    for (uint32_t op = 0; op < OPERATIONS; op++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        uint32_t value = op + 1;
+
+        switch ((state >> 32) % 5)
+        {
+            case 0:
+                ck_assert(deque_push_front(&deque, AS_PTR(value)));
+                g_model[--first] = value;
+                size++;
+                break;
+            case 1:
+            case 2:
+                ck_assert(deque_push_back(&deque, AS_PTR(value)));
+                g_model[first + size] = value;
+                size++;
+                break;
+            case 3:
+                ck_assert_uint_eq(AS_INT(deque_pop_front(&deque)),
+                                  (0 == size) ? 0 : g_model[first]);
+                first += (0 == size) ? 0 : 1;
+                size  -= (0 == size) ? 0 : 1;
+                break;
+            default:
+                ck_assert_uint_eq(AS_INT(deque_pop_back(&deque)),
+                                  (0 == size) ? 0 : g_model[first + size - 1]);
+                size -= (0 == size) ? 0 : 1;
+                break;
+        }
+
+        ck_assert_uint_eq(AS_INT(deque_peek_front(&deque)),
+                          (0 == size) ? 0 : g_model[first]);
+        ck_assert_uint_eq(AS_INT(deque_peek_back(&deque)),
+                          (0 == size) ? 0 : g_model[first + size - 1]);
+        if (0 == (op % 1000))
+        {
+            assert_matches(&deque, first, size);
+        }
+    }
+
+    assert_matches(&deque, first, size);
+    deque_destroy(&deque, false);
+}
+END_TEST
+
+START_TEST(test_deque_grows_while_wrapped)
+{
+    deque_t deque;
+
+    ck_assert(deque_init(&deque, 1));
+
+    uint32_t capacity = deque.capacity;
+
+    // Move the front to the last slot, so the next elements wrap
+    for (uint32_t value = 1; value < capacity; value++)
+    {
+        ck_assert(deque_push_back(&deque, AS_PTR(value)));
+    }
+    for (uint32_t value = 1; value < capacity; value++)
+    {
+        ck_assert_uint_eq(AS_INT(deque_pop_front(&deque)), value);
+    }
+
+    // Fill the ring from both ends, then grow it while wrapped; the order
+    // from the front survives the move
+    for (uint32_t value = 2; value <= capacity; value++)
+    {
+        ck_assert(deque_push_back(&deque, AS_PTR(value)));
+    }
+    ck_assert(deque_push_front(&deque, AS_PTR(1)));
+    ck_assert_uint_eq(deque.capacity, capacity);
+    ck_assert(deque_push_back(&deque, AS_PTR(capacity + 1)));
+    ck_assert_uint_eq(deque.capacity, 2 * capacity);
+
+    for (uint32_t idx = 0; idx <= capacity; idx++)
+    {
+        g_model[idx] = idx + 1;
+    }
+    assert_matches(&deque, 0, capacity + 1);
+
+    // Reserve rounds up to a power of two and keeps the contents
+    ck_assert(deque_reserve(&deque, 4 * capacity + 1));
+    ck_assert_uint_eq(deque.capacity, 8 * capacity);
+    assert_matches(&deque, 0, capacity + 1);
+
+    // Set replaces in place and returns the old element
+    ck_assert_uint_eq(AS_INT(deque_set_at(&deque, capacity, AS_PTR(1000))),
+                      capacity + 1);
+    ck_assert_uint_eq(AS_INT(deque_peek_back(&deque)), 1000);
+    ck_assert_ptr_null(deque_set_at(&deque, capacity + 1, AS_PTR(7)));
+
+    deque_clear(&deque, false);
+    ck_assert(deque_is_empty(&deque));
+    ck_assert_ptr_null(deque_pop_front(&deque));
+    ck_assert_ptr_null(deque_pop_back(&deque));
+    ck_assert_ptr_null(deque_peek_front(&deque));
+
+    deque_destroy(&deque, false);
+}
+END_TEST
+
+START_TEST(test_deque_steady_state_allocates_nothing)
+{
+    alloc_tracker_t * p_tracker = alloc_tracker_create(NULL, 0);
+    deque_t           deque;
+
+    ck_assert_ptr_nonnull(p_tracker);
+    ck_assert(deque_init_ex(&deque, 16, alloc_tracker_allocator(p_tracker)));
+
+    uint64_t allocs = alloc_count(p_tracker);
+
+    // Cycling through the ring many times over never resizes it
+    for (uint32_t value = 1; value <= 10000; value++)
+    {
+        ck_assert(deque_push_back(&deque, AS_PTR(value)));
+        if (value > 10)
+        {
+            ck_assert_uint_eq(AS_INT(deque_pop_front(&deque)), value - 10);
+        }
+    }
+    ck_assert_uint_eq(alloc_count(p_tracker), allocs);
+    ck_assert_uint_eq(deque.capacity, 16);
+
+    deque_destroy(&deque, false);
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_stack_ring)
+{
+    alloc_tracker_t * p_tracker = alloc_tracker_create(NULL, 0);
+    stack_t           stack;
+
+    ck_assert_ptr_nonnull(p_tracker);
+    ck_assert(stack_init_ring(&stack, 2, alloc_tracker_allocator(p_tracker)));
+    ck_assert(stack_is_empty(&stack));
+    ck_assert_ptr_null(stack_pop(&stack));
+
+    // Grows past the initial ring and pops last in, first out
+    for (uint32_t value = 1; value <= 100; value++)
+    {
+        ck_assert(stack_push(&stack, AS_PTR(value)));
+        ck_assert_uint_eq(AS_INT(stack_peek(&stack)), value);
+    }
+    ck_assert_uint_eq(stack_size(&stack), 100);
+
+    for (uint32_t value = 100; value > 50; value--)
+    {
+        ck_assert_uint_eq(AS_INT(stack_pop(&stack)), value);
+    }
+    ck_assert_uint_eq(stack_size(&stack), 50);
+
+    // Once grown, pushing and popping allocates nothing
+    uint64_t allocs = alloc_count(p_tracker);
+    for (uint32_t round = 0; round < 1000; round++)
+    {
+        ck_assert(stack_push(&stack, AS_PTR(1000 + round)));
+        ck_assert(stack_push(&stack, AS_PTR(2000 + round)));
+        ck_assert_uint_eq(AS_INT(stack_pop(&stack)), 2000 + round);
+        ck_assert_uint_eq(AS_INT(stack_pop(&stack)), 1000 + round);
+    }
+    ck_assert_uint_eq(alloc_count(p_tracker), allocs);
+    ck_assert_uint_eq(AS_INT(stack_peek(&stack)), 50);
+
+    stack_clear(&stack, false);
+    ck_assert(stack_is_empty(&stack));
+    ck_assert(stack_push(&stack, AS_PTR(7)));
+    ck_assert_uint_eq(AS_INT(stack_pop(&stack)), 7);
+
+    stack_destroy(&stack, false);
+
+    alloc_stats_t stats;
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.live_bytes, 0);
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+START_TEST(test_queue_ring)
+{
+    alloc_tracker_t * p_tracker = alloc_tracker_create(NULL, 0);
+    queue_t *         p_queue;
+    void *            p_item;
+
+    ck_assert_ptr_nonnull(p_tracker);
+    p_queue = queue_create_ring(2, alloc_tracker_allocator(p_tracker));
+    ck_assert_ptr_nonnull(p_queue);
+    ck_assert(queue_is_empty(p_queue));
+    ck_assert(!queue_dequeue(p_queue, &p_item));
+
+    // Grows past the initial ring and dequeues first in, first out
+    for (uint32_t value = 1; value <= 100; value++)
+    {
+        ck_assert(queue_enqueue(p_queue, AS_PTR(value)));
+    }
+    ck_assert_int_eq(queue_size(p_queue), 100);
+
+    for (uint32_t value = 1; value <= 60; value++)
+    {
+        ck_assert(queue_dequeue(p_queue, &p_item));
+        ck_assert_uint_eq(AS_INT(p_item), value);
+    }
+
+    // The ring wraps many times over without allocating or losing order
+    uint64_t allocs = alloc_count(p_tracker);
+    uint32_t next   = 61;
+    for (uint32_t value = 101; value <= 10000; value++)
+    {
+        ck_assert(queue_enqueue(p_queue, AS_PTR(value)));
+        ck_assert(queue_dequeue(p_queue, &p_item));
+        ck_assert_uint_eq(AS_INT(p_item), next++);
+    }
+    ck_assert_uint_eq(alloc_count(p_tracker), allocs);
+    ck_assert_int_eq(queue_size(p_queue), 40);
+
+    while (queue_dequeue(p_queue, &p_item))
+    {
+        ck_assert_uint_eq(AS_INT(p_item), next++);
+    }
+    ck_assert_uint_eq(next, 10001);
+    ck_assert(queue_is_empty(p_queue));
+
+    ck_assert(queue_destroy(&p_queue));
+    ck_assert_ptr_null(p_queue);
+
+    alloc_stats_t stats;
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.live_bytes, 0);
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+deque_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Deque");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_deque_random_operations);
+    tcase_add_test(tc_core, test_deque_grows_while_wrapped);
+    tcase_add_test(tc_core, test_deque_steady_state_allocates_nothing);
+    tcase_add_test(tc_core, test_stack_ring);
+    tcase_add_test(tc_core, test_queue_ring);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = deque_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -9,6 +9,9 @@
  #include <stdlib.h>
  #include "linked_list.h"
  
+ /* Sorted runs of 2^i nodes kept while sorting; 32 cover any uint32_t size */
+ #define LIST_SORT_BINS (32u)
+ 
  /*!
   * @brief Initialize a linked list.
   *
@@ -18,6 +21,20 @@
   */
  bool
  linked_list_init(linked_list_t *p_list)
+ {
+     return linked_list_init_ex(p_list, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a linked list whose nodes come from an allocator.
+  *
+  * @param[in,out] p_list Pointer to the linked list to initialize.
+  * @param[in] p_alloc Allocator for the nodes, NULL for the default.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ linked_list_init_ex(linked_list_t *p_list, const allocator_t *p_alloc)
  {
      if (NULL == p_list)
      {
@@ -27,6 +44,7 @@
      p_list->p_head = NULL;
      p_list->p_tail = NULL;
      p_list->size = 0;
+     p_list->p_alloc = p_alloc;
  
      return true;
  }
@@ -34,16 +52,17 @@
  /*!
   * @brief Create a new node with the given data.
   *
+  * @param[in] p_alloc Allocator for the node.
   * @param[in] p_data Pointer to the data to be stored in the new node.
   *
   * @return Pointer to the newly created node, or NULL if memory allocation failed.
   */
  static list_node_t *
- create_node(void *p_data)
+ create_node(const allocator_t *p_alloc, void *p_data)
  {
      /* Cast from void* to list_node_t* is safe as we're allocating exactly 
       * the size needed for the structure */
-     list_node_t *p_node = (list_node_t *)malloc(sizeof(list_node_t));
+     list_node_t *p_node = (list_node_t *)ALLOC_NEW(p_alloc, sizeof(list_node_t));
      
      if (NULL == p_node)
      {
@@ -56,6 +75,66 @@
      return p_node;
  }
  
+ /*!
+  * @brief Merge two sorted runs of nodes into one, stably.
+  *
+  * @param[in] p_first Run whose nodes go first among equal elements.
+  * @param[in] p_second Run whose nodes go after them.
+  * @param[in] compare_fn Function used to compare elements.
+  *
+  * @return Head of the merged run.
+  */
+ static list_node_t *
+ merge_runs(list_node_t *p_first, list_node_t *p_second, list_compare_func_t compare_fn)
+ {
+     list_node_t *p_head = NULL;
+     list_node_t **pp_link = &p_head;
+     
+     while ((NULL != p_first) && (NULL != p_second))
+     {
+         /* Take from the second run only when strictly smaller */
+         if (compare_fn(p_second->p_data, p_first->p_data) < 0)
+         {
+             *pp_link = p_second;
+             p_second = p_second->p_next;
+         }
+         else
+         {
+             *pp_link = p_first;
+             p_first = p_first->p_next;
+         }
+         
+         pp_link = &(*pp_link)->p_next;
+     }
+     
+     *pp_link = (NULL != p_first) ? p_first : p_second;
+     
+     return p_head;
+ }
+ 
+ /*!
+  * @brief Check that nodes may move between two lists.
+  *
+  * @param[in] p_list1 Pointer to one list.
+  * @param[in] p_list2 Pointer to the other list.
+  *
+  * @return true if both lists exist, are distinct and free nodes the same way.
+  */
+ static bool
+ can_move_nodes(const linked_list_t *p_list1, const linked_list_t *p_list2)
+ {
+     if ((NULL == p_list1) || (NULL == p_list2) || (p_list1 == p_list2))
+     {
+         return false;
+     }
+     
+     /* NULL stands for the default allocator */
+     const allocator_t *p_alloc1 = (NULL == p_list1->p_alloc) ? allocator_default() : p_list1->p_alloc;
+     const allocator_t *p_alloc2 = (NULL == p_list2->p_alloc) ? allocator_default() : p_list2->p_alloc;
+     
+     return (p_alloc1 == p_alloc2);
+ }
+ 
  /*!
   * @brief Add a new node to the end of the linked list.
   *
@@ -72,7 +151,7 @@
          return false;
      }
      
-     list_node_t *p_node = create_node(p_data);
+     list_node_t *p_node = create_node(p_list->p_alloc, p_data);
      
      if (NULL == p_node)
      {
@@ -114,7 +193,7 @@
          return false;
      }
      
-     list_node_t *p_node = create_node(p_data);
+     list_node_t *p_node = create_node(p_list->p_alloc, p_data);
      
      if (NULL == p_node)
      {
@@ -174,7 +253,7 @@
          return false;
      }
      
-     list_node_t *p_node = create_node(p_data);
+     list_node_t *p_node = create_node(p_list->p_alloc, p_data);
      
      if (NULL == p_node)
      {
@@ -226,7 +305,7 @@
      }
      
      /* Free the node and update the size */
-     free(p_node);
+     ALLOC_FREE(p_list->p_alloc, p_node);
      p_list->size--;
      
      return p_data;
@@ -269,7 +348,7 @@
      p_list->p_tail = p_current;
      
      /* Free the node and update the size */
-     free(p_node);
+     ALLOC_FREE(p_list->p_alloc, p_node);
      p_list->size--;
      
      return p_data;
@@ -322,7 +401,7 @@
      /* Update the link and free the node */
      p_current->p_next = p_node->p_next;
      
-     free(p_node);
+     ALLOC_FREE(p_list->p_alloc, p_node);
      p_list->size--;
      
      return p_data;
@@ -396,6 +475,208 @@
      return (0 == p_list->size);
  }
  
+ /*!
+  * @brief Sort the linked list in place with a stable bottom-up merge sort.
+  *
+  * Each node in turn is merged into a set of bins, bin i holding a sorted run
+  * of 2^i nodes or nothing, much as a binary counter is incremented. The bins
+  * are then merged, smallest (latest) first. No node is allocated or copied.
+  *
+  * @param[in,out] p_list Pointer to the linked list.
+  * @param[in] compare_fn Function used to compare elements.
+  *
+  * @return true if the list was sorted, false on invalid parameters.
+  */
+ bool
+ linked_list_sort(linked_list_t *p_list, list_compare_func_t compare_fn)
+ {
+     if ((NULL == p_list) || (NULL == compare_fn))
+     {
+         return false;
+     }
+     
+     list_node_t *p_bins[LIST_SORT_BINS] = {NULL};
+     list_node_t *p_current = p_list->p_head;
+     
+     while (NULL != p_current)
+     {
+         list_node_t *p_run = p_current;
+         p_current = p_current->p_next;
+         p_run->p_next = NULL;
+         
+         /* Carry the run up through the full bins; earlier nodes merge first */
+         uint32_t bin = 0;
+         
+         while ((bin < LIST_SORT_BINS - 1) && (NULL != p_bins[bin]))
+         {
+             p_run = merge_runs(p_bins[bin], p_run, compare_fn);
+             p_bins[bin] = NULL;
+             bin++;
+         }
+         
+         p_bins[bin] = merge_runs(p_bins[bin], p_run, compare_fn);
+     }
+     
+     list_node_t *p_sorted = NULL;
+     
+     for (uint32_t bin = 0; bin < LIST_SORT_BINS; bin++)
+     {
+         p_sorted = merge_runs(p_bins[bin], p_sorted, compare_fn);
+     }
+     
+     /* Find the new tail */
+     p_list->p_head = p_sorted;
+     p_list->p_tail = p_sorted;
+     
+     while ((NULL != p_list->p_tail) && (NULL != p_list->p_tail->p_next))
+     {
+         p_list->p_tail = p_list->p_tail->p_next;
+     }
+     
+     return true;
+ }
+ 
+ /*!
+  * @brief Move all nodes of one list to the end of another in O(1).
+  *
+  * @param[in,out] p_dest Pointer to the list that receives the nodes.
+  * @param[in,out] p_src Pointer to the list that gives them up; left empty.
+  *
+  * @return true if the nodes were moved, false on invalid parameters or if the
+  *         allocators differ.
+  */
+ bool
+ linked_list_concat(linked_list_t *p_dest, linked_list_t *p_src)
+ {
+     return (NULL != p_dest) && linked_list_splice(p_dest, p_dest->size, p_src);
+ }
+ 
+ /*!
+  * @brief Move all nodes of one list into another at the specified position.
+  *
+  * @param[in,out] p_dest Pointer to the list that receives the nodes.
+  * @param[in] position Position in p_dest of the first moved node (0-based).
+  * @param[in,out] p_src Pointer to the list that gives them up; left empty.
+  *
+  * @return true if the nodes were moved, false on invalid parameters, if the
+  *         position is past the end or if the allocators differ.
+  */
+ bool
+ linked_list_splice(linked_list_t *p_dest, uint32_t position, linked_list_t *p_src)
+ {
+     if (!can_move_nodes(p_dest, p_src) || (position > p_dest->size) ||
+         (p_src->size > UINT32_MAX - p_dest->size))
+     {
+         return false;
+     }
+     
+     if (NULL == p_src->p_head)
+     {
+         return true;
+     }
+     
+     if (0 == position)
+     {
+         /* Front: the source run goes before the old head */
+         p_src->p_tail->p_next = p_dest->p_head;
+         p_dest->p_head = p_src->p_head;
+         
+         if (NULL == p_dest->p_tail)
+         {
+             p_dest->p_tail = p_src->p_tail;
+         }
+     }
+     else if (position == p_dest->size)
+     {
+         /* End: the source run goes after the old tail */
+         p_dest->p_tail->p_next = p_src->p_head;
+         p_dest->p_tail = p_src->p_tail;
+     }
+     else
+     {
+         /* Find the node before the position */
+         list_node_t *p_before = p_dest->p_head;
+         for (uint32_t idx = 0; idx < position - 1; idx++)
+         {
+             p_before = p_before->p_next;
+         }
+         
+         p_src->p_tail->p_next = p_before->p_next;
+         p_before->p_next = p_src->p_head;
+     }
+     
+     p_dest->size += p_src->size;
+     
+     p_src->p_head = NULL;
+     p_src->p_tail = NULL;
+     p_src->size = 0;
+     
+     return true;
+ }
+ 
+ /*!
+  * @brief Move the nodes from the specified position on to the end of another list.
+  *
+  * @param[in,out] p_list Pointer to the list to split; keeps the first position nodes.
+  * @param[in] position Position of the first node to move (0-based).
+  * @param[in,out] p_rest Pointer to the list that receives the rest.
+  *
+  * @return true if the list was split, false on invalid parameters, if the
+  *         position is past the end or if the allocators differ.
+  */
+ bool
+ linked_list_split_at(linked_list_t *p_list, uint32_t position, linked_list_t *p_rest)
+ {
+     if (!can_move_nodes(p_list, p_rest) || (position > p_list->size) ||
+         (p_list->size - position > UINT32_MAX - p_rest->size))
+     {
+         return false;
+     }
+     
+     if (position == p_list->size)
+     {
+         return true;
+     }
+     
+     /* Detach the run from position to the tail */
+     list_node_t *p_first = p_list->p_head;
+     list_node_t *p_last = p_list->p_tail;
+     
+     if (0 == position)
+     {
+         p_list->p_head = NULL;
+         p_list->p_tail = NULL;
+     }
+     else
+     {
+         list_node_t *p_before = p_list->p_head;
+         for (uint32_t idx = 0; idx < position - 1; idx++)
+         {
+             p_before = p_before->p_next;
+         }
+         
+         p_first = p_before->p_next;
+         p_before->p_next = NULL;
+         p_list->p_tail = p_before;
+     }
+     
+     /* Append it to the other list */
+     if (NULL == p_rest->p_tail)
+     {
+         p_rest->p_head = p_first;
+     }
+     else
+     {
+         p_rest->p_tail->p_next = p_first;
+     }
+     
+     p_rest->p_tail = p_last;
+     p_rest->size += p_list->size - position;
+     p_list->size = position;
+     
+     return true;
+ }
+ 
  /*!
   * @brief Clear the linked list, removing all nodes.
   *
@@ -425,7 +706,7 @@
          }
          
          /* Free the node */
-         free(p_current);
+         ALLOC_FREE(p_list->p_alloc, p_current);
          p_current = p_next;
      }
      
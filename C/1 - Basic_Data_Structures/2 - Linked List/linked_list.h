@@ -11,6 +11,7 @@
  
  #include <stdint.h>
  #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
  
  /**
   * @brief Structure representing a node in the linked list.
@@ -29,8 +30,19 @@
      list_node_t *p_head;         /* Pointer to the first node in the list */
      list_node_t *p_tail;         /* Pointer to the last node in the list */
      uint32_t     size;           /* Number of nodes in the list */
+     const allocator_t *p_alloc;  /* Allocator for the nodes (NULL for malloc) */
  } linked_list_t;
  
+ /**
+  * @brief Function pointer type for comparing data items.
+  *
+  * @param[in] p_data1 Pointer to the first data item to compare.
+  * @param[in] p_data2 Pointer to the second data item to compare.
+  *
+  * @return Negative if p_data1 < p_data2, 0 if equal, positive if p_data1 > p_data2.
+  */
+ typedef int32_t (*list_compare_func_t)(const void *p_data1, const void *p_data2);
+ 
  /**
   * @brief Initialize a linked list.
   *
@@ -40,6 +52,17 @@
   */
  bool linked_list_init(linked_list_t *p_list);
  
+ /**
+  * @brief Initialize a linked list whose nodes come from an allocator.
+  *
+  * @param[in,out] p_list Pointer to the linked list to initialize.
+  * @param[in] p_alloc Allocator for the nodes, NULL for the default.
+  *                    Must outlive the linked list.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool linked_list_init_ex(linked_list_t *p_list, const allocator_t *p_alloc);
+ 
  /**
   * @brief Add a new node to the end of the linked list.
   *
@@ -127,6 +150,61 @@
   */
  bool linked_list_is_empty(const linked_list_t *p_list);
  
+ /**
+  * @brief Sort the linked list in place with a stable bottom-up merge sort.
+  *
+  * Nodes are relinked, never allocated or copied; O(n log n) comparisons.
+  *
+  * @param[in,out] p_list Pointer to the linked list.
+  * @param[in] compare_fn Function used to compare elements.
+  *
+  * @return true if the list was sorted, false on invalid parameters.
+  */
+ bool linked_list_sort(linked_list_t *p_list, list_compare_func_t compare_fn);
+ 
+ /**
+  * @brief Move all nodes of one list to the end of another in O(1).
+  *
+  * The lists must use the same allocator, since each frees its own nodes.
+  *
+  * @param[in,out] p_dest Pointer to the list that receives the nodes.
+  * @param[in,out] p_src Pointer to the list that gives them up; left empty.
+  *
+  * @return true if the nodes were moved, false on invalid parameters or if the
+  *         allocators differ.
+  */
+ bool linked_list_concat(linked_list_t *p_dest, linked_list_t *p_src);
+ 
+ /**
+  * @brief Move all nodes of one list into another at the specified position.
+  *
+  * O(1) at the front or the end, otherwise O(position) to find the place.
+  * The lists must use the same allocator.
+  *
+  * @param[in,out] p_dest Pointer to the list that receives the nodes.
+  * @param[in] position Position in p_dest of the first moved node (0-based).
+  * @param[in,out] p_src Pointer to the list that gives them up; left empty.
+  *
+  * @return true if the nodes were moved, false on invalid parameters, if the
+  *         position is past the end or if the allocators differ.
+  */
+ bool linked_list_splice(linked_list_t *p_dest, uint32_t position, linked_list_t *p_src);
+ 
+ /**
+  * @brief Move the nodes from the specified position on to the end of another list.
+  *
+  * O(position) to find the place; the moved run is relinked as a whole. The
+  * lists must use the same allocator.
+  *
+  * @param[in,out] p_list Pointer to the list to split; keeps the first position nodes.
+  * @param[in] position Position of the first node to move (0-based).
+  * @param[in,out] p_rest Pointer to the list that receives the rest.
+  *
+  * @return true if the list was split, false on invalid parameters, if the
+  *         position is past the end or if the allocators differ.
+  */
+ bool linked_list_split_at(linked_list_t *p_list, uint32_t position, linked_list_t *p_rest);
+ 
  /**
   * @brief Clear the linked list, removing all nodes.
   *
@@ -0,0 +1,308 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "linked_list.h"
+
+#define SORT_COUNT (1000u)
+#define KEY_RANGE  (17u)
+
+// Small non-zero integers are carried in the data pointer
+#define AS_PTR(n) ((void *)(uintptr_t)(n))
+#define AS_INT(p) ((uint32_t)(uintptr_t)(p))
+
+typedef struct
+{
+    uint32_t key;
+    uint32_t seq;
+} record_t;
+
+static record_t g_records[SORT_COUNT];
+
+// Orders records by key alone, so equal keys are ties
+static int32_t
+record_compare(const void * p_data1, const void * p_data2)
+{
+    const record_t * p_rec1 = p_data1;
+    const record_t * p_rec2 = p_data2;
+
+    return (p_rec1->key > p_rec2->key) - (p_rec1->key < p_rec2->key);
+}
+
+static int32_t
+int_compare(const void * p_data1, const void * p_data2)
+{
+    return (AS_INT(p_data1) > AS_INT(p_data2))
+           - (AS_INT(p_data1) < AS_INT(p_data2));
+}
+
+static void
+fill(linked_list_t * p_list, uint32_t first, uint32_t last)
+{
+    for (uint32_t value = first; value <= last; value++)
+    {
+        ck_assert(linked_list_append(p_list, AS_PTR(value)));
+    }
+}
+
+// Checks the values in order, the size and that the tail is the last node
+static void
+assert_list(const linked_list_t * p_list,
+            const uint32_t *      p_expected,
+            uint32_t              count)
+{
+    const list_node_t * p_node = p_list->p_head;
+    const list_node_t * p_last = NULL;
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        ck_assert_ptr_nonnull(p_node);
+        ck_assert_uint_eq(AS_INT(p_node->p_data), p_expected[idx]);
+        p_last = p_node;
+        p_node = p_node->p_next;
+    }
+
+    ck_assert_ptr_null(p_node);
+    ck_assert_ptr_eq(p_list->p_tail, p_last);
+    ck_assert_uint_eq(linked_list_size(p_list), count);
+}
+
+START_TEST(test_sort_is_stable)
+{
+    linked_list_t list;
+    uint64_t      state = 88172645463325252ull;
+
+    ck_assert(linked_list_init(&list));
+
+    for (uint32_t idx = 0; idx < SORT_COUNT; idx++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        g_records[idx].key = (uint32_t)(state % KEY_RANGE);
+        g_records[idx].seq = idx;
+        ck_assert(linked_list_append(&list, &g_records[idx]));
+    }
+
+    ck_assert(linked_list_sort(&list, record_compare));
+    ck_assert_uint_eq(linked_list_size(&list), SORT_COUNT);
+
+    // Keys never decrease and equal keys keep their insertion order
+    const list_node_t * p_node = list.p_head;
+    const record_t *    p_prev = p_node->p_data;
+    uint32_t            count  = 1;
+
+    for (p_node = p_node->p_next; NULL != p_node; p_node = p_node->p_next)
+    {
+        const record_t * p_rec = p_node->p_data;
+
+        ck_assert_uint_le(p_prev->key, p_rec->key);
+        if (p_prev->key == p_rec->key)
+        {
+            ck_assert_uint_lt(p_prev->seq, p_rec->seq);
+        }
+
+        p_prev = p_rec;
+        count++;
+    }
+    ck_assert_uint_eq(count, SORT_COUNT);
+
+    // The tail is the last sorted node, so appending lands after it
+    ck_assert_ptr_eq(list.p_tail->p_data, p_prev);
+    record_t extra = { 0, SORT_COUNT };
+    ck_assert(linked_list_append(&list, &extra));
+    ck_assert_ptr_eq(linked_list_get_at(&list, SORT_COUNT), &extra);
+
+    linked_list_destroy(&list, false);
+}
+END_TEST
+
+START_TEST(test_sort_small_lists)
+{
+    linked_list_t list;
+
+    ck_assert(linked_list_init(&list));
+    ck_assert(linked_list_sort(&list, int_compare));
+    assert_list(&list, NULL, 0);
+
+    ck_assert(linked_list_append(&list, AS_PTR(3)));
+    ck_assert(linked_list_sort(&list, int_compare));
+    assert_list(&list, (const uint32_t[]) { 3 }, 1);
+
+    ck_assert(linked_list_append(&list, AS_PTR(1)));
+    ck_assert(linked_list_append(&list, AS_PTR(2)));
+    ck_assert(linked_list_sort(&list, int_compare));
+    assert_list(&list, (const uint32_t[]) { 1, 2, 3 }, 3);
+
+    ck_assert(!linked_list_sort(&list, NULL));
+
+    linked_list_destroy(&list, false);
+}
+END_TEST
+
+START_TEST(test_splice_positions)
+{
+    linked_list_t dest;
+    linked_list_t src;
+
+    ck_assert(linked_list_init(&dest));
+    ck_assert(linked_list_init(&src));
+
+    // Into an empty list the source tail becomes the tail
+    fill(&src, 1, 2);
+    ck_assert(linked_list_splice(&dest, 0, &src));
+    assert_list(&dest, (const uint32_t[]) { 1, 2 }, 2);
+    assert_list(&src, NULL, 0);
+    ck_assert(linked_list_append(&dest, AS_PTR(3)));
+    assert_list(&dest, (const uint32_t[]) { 1, 2, 3 }, 3);
+
+    // At the front the tail stays put
+    fill(&src, 10, 11);
+    ck_assert(linked_list_splice(&dest, 0, &src));
+    assert_list(&dest, (const uint32_t[]) { 10, 11, 1, 2, 3 }, 5);
+
+    // In the middle the tail stays put
+    fill(&src, 20, 21);
+    ck_assert(linked_list_splice(&dest, 2, &src));
+    assert_list(&dest, (const uint32_t[]) { 10, 11, 20, 21, 1, 2, 3 }, 7);
+
+    // At the end the tail moves to the source tail
+    fill(&src, 30, 31);
+    ck_assert(linked_list_splice(&dest, 7, &src));
+    assert_list(&dest,
+                (const uint32_t[]) { 10, 11, 20, 21, 1, 2, 3, 30, 31 },
+                9);
+    ck_assert(linked_list_append(&dest, AS_PTR(4)));
+    ck_assert_uint_eq(AS_INT(linked_list_remove_last(&dest)), 4);
+
+    // The source is reusable once emptied
+    ck_assert(linked_list_append(&src, AS_PTR(5)));
+    assert_list(&src, (const uint32_t[]) { 5 }, 1);
+
+    // Past the end is refused and leaves both lists alone
+    ck_assert(!linked_list_splice(&dest, 10, &src));
+    ck_assert_uint_eq(linked_list_size(&dest), 9);
+    assert_list(&src, (const uint32_t[]) { 5 }, 1);
+
+    // An empty source is a no-op
+    linked_list_clear(&src, false);
+    ck_assert(linked_list_splice(&dest, 3, &src));
+    ck_assert_uint_eq(linked_list_size(&dest), 9);
+
+    linked_list_destroy(&dest, false);
+    linked_list_destroy(&src, false);
+}
+END_TEST
+
+START_TEST(test_concat)
+{
+    linked_list_t dest;
+    linked_list_t src;
+
+    ck_assert(linked_list_init(&dest));
+    ck_assert(linked_list_init(&src));
+
+    fill(&dest, 1, 2);
+    fill(&src, 3, 4);
+    ck_assert(linked_list_concat(&dest, &src));
+    assert_list(&dest, (const uint32_t[]) { 1, 2, 3, 4 }, 4);
+    assert_list(&src, NULL, 0);
+
+    ck_assert(linked_list_append(&dest, AS_PTR(5)));
+    assert_list(&dest, (const uint32_t[]) { 1, 2, 3, 4, 5 }, 5);
+
+    linked_list_destroy(&dest, false);
+    linked_list_destroy(&src, false);
+}
+END_TEST
+
+START_TEST(test_split_at_positions)
+{
+    linked_list_t list;
+    linked_list_t rest;
+
+    ck_assert(linked_list_init(&list));
+    ck_assert(linked_list_init(&rest));
+    fill(&list, 1, 6);
+
+    // In the middle both lists end on the right node
+    ck_assert(linked_list_split_at(&list, 4, &rest));
+    assert_list(&list, (const uint32_t[]) { 1, 2, 3, 4 }, 4);
+    assert_list(&rest, (const uint32_t[]) { 5, 6 }, 2);
+
+    ck_assert(linked_list_append(&list, AS_PTR(7)));
+    ck_assert(linked_list_append(&rest, AS_PTR(8)));
+    assert_list(&list, (const uint32_t[]) { 1, 2, 3, 4, 7 }, 5);
+    assert_list(&rest, (const uint32_t[]) { 5, 6, 8 }, 3);
+
+    // The moved run goes after what the other list already holds
+    ck_assert(linked_list_split_at(&list, 3, &rest));
+    assert_list(&list, (const uint32_t[]) { 1, 2, 3 }, 3);
+    assert_list(&rest, (const uint32_t[]) { 5, 6, 8, 4, 7 }, 5);
+
+    // At the end nothing moves
+    ck_assert(linked_list_split_at(&list, 3, &rest));
+    assert_list(&list, (const uint32_t[]) { 1, 2, 3 }, 3);
+
+    // Past the end is refused
+    ck_assert(!linked_list_split_at(&list, 4, &rest));
+    assert_list(&list, (const uint32_t[]) { 1, 2, 3 }, 3);
+
+    // At the front the list is left empty and usable
+    ck_assert(linked_list_split_at(&list, 0, &rest));
+    assert_list(&list, NULL, 0);
+    assert_list(&rest, (const uint32_t[]) { 5, 6, 8, 4, 7, 1, 2, 3 }, 8);
+    ck_assert(linked_list_append(&list, AS_PTR(9)));
+    assert_list(&list, (const uint32_t[]) { 9 }, 1);
+
+    // Splitting then splicing back restores the original order
+    ck_assert(linked_list_split_at(&rest, 5, &list));
+    ck_assert(linked_list_splice(&list, 0, &rest));
+    assert_list(&list, (const uint32_t[]) { 5, 6, 8, 4, 7, 9, 1, 2, 3 }, 9);
+
+    linked_list_destroy(&list, false);
+    linked_list_destroy(&rest, false);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+linked_list_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Linked_List");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_sort_is_stable);
+    tcase_add_test(tc_core, test_sort_small_lists);
+    tcase_add_test(tc_core, test_splice_positions);
+    tcase_add_test(tc_core, test_concat);
+    tcase_add_test(tc_core, test_split_at_positions);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = linked_list_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
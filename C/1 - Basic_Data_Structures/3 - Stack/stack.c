@@ -18,6 +18,20 @@
   */
  bool
  stack_init(stack_t *p_stack)
+ {
+     return stack_init_ex(p_stack, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a stack whose elements come from an allocator.
+  *
+  * @param[in,out] p_stack Pointer to the stack to initialize.
+  * @param[in] p_alloc Allocator for the elements, NULL for the default.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ stack_init_ex(stack_t *p_stack, const allocator_t *p_alloc)
  {
      if (NULL == p_stack)
      {
@@ -26,10 +40,34 @@
  
      p_stack->p_top = NULL;
      p_stack->size = 0;
+     p_stack->p_alloc = p_alloc;
+     p_stack->b_ring = false;
  
      return true;
  }
  
+ /*!
+  * @brief Initialize a stack that keeps its elements in a ring-buffer deque.
+  *
+  * @param[in,out] p_stack Pointer to the stack to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] p_alloc Allocator for the storage, NULL for the default.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ stack_init_ring(stack_t *p_stack, uint32_t initial_capacity, const allocator_t *p_alloc)
+ {
+     if (!stack_init_ex(p_stack, p_alloc))
+     {
+         return false;
+     }
+ 
+     p_stack->b_ring = deque_init_ex(&p_stack->ring, initial_capacity, p_alloc);
+ 
+     return p_stack->b_ring;
+ }
+ 
  /*!
   * @brief Push a new element onto the stack.
   *
@@ -46,8 +84,13 @@
          return false;
      }
      
+     if (p_stack->b_ring)
+     {
+         return deque_push_back(&p_stack->ring, p_data);
+     }
+     
      /* Create a new stack element */
-     stack_element_t *p_element = (stack_element_t *)malloc(sizeof(stack_element_t));
+     stack_element_t *p_element = (stack_element_t *)ALLOC_NEW(p_stack->p_alloc, sizeof(stack_element_t));
      
      if (NULL == p_element)
      {
@@ -74,6 +117,11 @@
  void *
  stack_pop(stack_t *p_stack)
  {
+     if ((NULL != p_stack) && (p_stack->b_ring))
+     {
+         return deque_pop_back(&p_stack->ring);
+     }
+     
      if ((NULL == p_stack) || (NULL == p_stack->p_top))
      {
          return NULL;
@@ -88,7 +136,7 @@
      p_stack->size--;
      
      /* Free the popped element */
-     free(p_element);
+     ALLOC_FREE(p_stack->p_alloc, p_element);
      
      return p_data;
  }
@@ -103,6 +151,11 @@
  void *
  stack_peek(const stack_t *p_stack)
  {
+     if ((NULL != p_stack) && (p_stack->b_ring))
+     {
+         return deque_peek_back(&p_stack->ring);
+     }
+     
      if ((NULL == p_stack) || (NULL == p_stack->p_top))
      {
          return NULL;
@@ -127,6 +180,11 @@
          return 0;
      }
      
+     if (p_stack->b_ring)
+     {
+         return deque_size(&p_stack->ring);
+     }
+     
      return p_stack->size;
  }
  
@@ -145,6 +203,11 @@
          return true;
      }
      
+     if (p_stack->b_ring)
+     {
+         return deque_is_empty(&p_stack->ring);
+     }
+     
      return (0 == p_stack->size);
  }
  
@@ -157,6 +220,12 @@
  void
  stack_clear(stack_t *p_stack, bool b_free_data)
  {
+     if ((NULL != p_stack) && (p_stack->b_ring))
+     {
+         deque_clear(&p_stack->ring, b_free_data);
+         return;
+     }
+     
      if ((NULL == p_stack) || (NULL == p_stack->p_top))
      {
          return;
@@ -177,7 +246,7 @@
          }
          
          /* Free the element */
-         free(p_current);
+         ALLOC_FREE(p_stack->p_alloc, p_current);
          p_current = p_next;
      }
      
@@ -202,5 +271,12 @@
      
      /* Clear all elements and their data if requested */
      stack_clear(p_stack, b_free_data);
+     
+     if (p_stack->b_ring)
+     {
+         /* The ring's storage goes too; the stack is back to a linked one */
+         deque_destroy(&p_stack->ring, false);
+         p_stack->b_ring = false;
+     }
  }
  /*** end of file ***/
\ No newline at end of file
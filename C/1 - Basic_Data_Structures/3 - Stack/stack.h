@@ -11,6 +11,8 @@
  
  #include <stdint.h>
  #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
+ #include "../10 - Deque/deque.h"
  
  /**
   * @brief Structure representing a stack element.
@@ -28,6 +30,9 @@
  {
      stack_element_t *p_top;               /* Pointer to the top element of the stack */
      uint32_t         size;                /* Number of elements in the stack */
+     const allocator_t *p_alloc;           /* Allocator for the elements (NULL for malloc) */
+     deque_t          ring;                /* Storage of a stack set up by stack_init_ring() */
+     bool             b_ring;              /* Elements live in ring rather than in linked elements */
  } stack_t;
  
  /**
@@ -39,6 +44,34 @@
   */
  bool stack_init(stack_t *p_stack);
  
+ /**
+  * @brief Initialize a stack whose elements come from an allocator.
+  *
+  * @param[in,out] p_stack Pointer to the stack to initialize.
+  * @param[in] p_alloc Allocator for the elements, NULL for the default.
+  *                    Must outlive the stack.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool stack_init_ex(stack_t *p_stack, const allocator_t *p_alloc);
+ 
+ /**
+  * @brief Initialize a stack that keeps its elements in a ring-buffer deque.
+  *
+  * The stack works through the same functions, but pushes and pops at the back of
+  * a deque_t instead of allocating an element per push, so the top of the stack
+  * stays in cache. The storage doubles as needed and is kept when the stack
+  * shrinks, until stack_destroy().
+  *
+  * @param[in,out] p_stack Pointer to the stack to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] p_alloc Allocator for the storage, NULL for the default.
+  *                    Must outlive the stack.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool stack_init_ring(stack_t *p_stack, uint32_t initial_capacity, const allocator_t *p_alloc);
+ 
  /**
   * @brief Push a new element onto the stack.
   *
@@ -31,6 +31,9 @@
      node_t * p_front;      /* Points to first element */
      node_t * p_rear;       /* Points to last element */
      uint32_t size;         /* Number of elements currently in queue */
+     const allocator_t * p_alloc; /* Source of the queue and its nodes */
+     deque_t ring;          /* Items of a queue from queue_create_ring() */
+     bool b_ring;           /* Items live in ring rather than in nodes */
  };
  
  /*************************************************************************
@@ -49,7 +52,63 @@
  queue_t *
  queue_create(void)
  {
-     return calloc(1, sizeof(queue_t));
+     return queue_create_ex(NULL);
+ }
+ 
+ /*!
+  * @brief Creates a new empty queue whose memory comes from an allocator.
+  *
+  * @param[in] p_alloc Allocator for the queue and its nodes, NULL for the
+  *                    default
+  *
+  * @return Pointer to newly created queue if successful, NULL if memory
+  *         allocation fails
+  */
+ queue_t *
+ queue_create_ex(const allocator_t * p_alloc)
+ {
+     queue_t * p_queue = ALLOC_ZEROED(p_alloc, 1, sizeof(queue_t));
+     if (NULL != p_queue)
+     {
+         p_queue->p_alloc = p_alloc;
+     }
+     return p_queue;
+ }
+ 
+ /*!
+  * @brief Creates a new empty queue that keeps its items in a ring-buffer
+  *        deque.
+  *
+  * @param[in] initial_capacity Initial number of slots in the ring
+  * @param[in] p_alloc Allocator for the queue and its ring, NULL for the
+  *                    default
+  *
+  * @return Pointer to newly created queue if successful, NULL if memory
+  *         allocation fails
+  */
+ queue_t *
+ queue_create_ring(uint32_t initial_capacity, const allocator_t * p_alloc)
+ {
+     queue_t * p_queue = queue_create_ex(p_alloc);
+     if (NULL == p_queue)
+     {
+         return NULL;
+     }
+ 
+     /* No point in more slots than the queue may hold */
+     if (initial_capacity > MAX_QUEUE_SIZE)
+     {
+         initial_capacity = MAX_QUEUE_SIZE;
+     }
+ 
+     if (!deque_init_ex(&p_queue->ring, initial_capacity, p_alloc))
+     {
+         ALLOC_FREE(p_alloc, p_queue);
+         return NULL;
+     }
+ 
+     p_queue->b_ring = true;
+     return p_queue;
  }
  
  /*!
@@ -70,15 +129,21 @@
      }
  
      /* Traversing the linked list, freeing each node */
+     const allocator_t * p_alloc = (*p_queue)->p_alloc;
      node_t * p_current = (*p_queue)->p_front;
      while (NULL != p_current)
      {
          node_t * p_temp = p_current;  /* Save current node */
          p_current = p_current->next;  /* Move to next node */
-         free(p_temp);                 /* Free saved node */
+         ALLOC_FREE(p_alloc, p_temp);  /* Free saved node */
      }
  
-     free(*p_queue);
+     if ((*p_queue)->b_ring)
+     {
+         deque_destroy(&(*p_queue)->ring, false);
+     }
+ 
+     ALLOC_FREE(p_alloc, *p_queue);
      *p_queue = NULL;
      return true;
  }
@@ -102,8 +167,19 @@
          return false;
      }
  
+     if (p_queue->b_ring)
+     {
+         if (!deque_push_back(&p_queue->ring, p_item))
+         {
+             return false;
+         }
+ 
+         p_queue->size++;
+         return true;
+     }
+ 
      /* Allocate and initialize new node */
-     node_t * p_new_node = calloc(1, sizeof(node_t));
+     node_t * p_new_node = ALLOC_ZEROED(p_queue->p_alloc, 1, sizeof(node_t));
      if (NULL == p_new_node)
      {
          return false;
@@ -143,11 +219,18 @@
  bool
  queue_dequeue(queue_t * const p_queue, void ** const pp_item)
  {
-     if ((NULL == p_queue) || (NULL == pp_item) || (NULL == p_queue->p_front))
+     if ((NULL == p_queue) || (NULL == pp_item) || (0u == p_queue->size))
      {
          return false;
      }
  
+     if (p_queue->b_ring)
+     {
+         *pp_item = deque_pop_front(&p_queue->ring);
+         p_queue->size--;
+         return true;
+     }
+ 
      /* Save the front node and its value */
      node_t * p_node_to_remove = p_queue->p_front;
      *pp_item = p_node_to_remove->p_value;
@@ -162,7 +245,7 @@
          p_queue->p_rear = NULL;
      }
  
-     free(p_node_to_remove);
+     ALLOC_FREE(p_queue->p_alloc, p_node_to_remove);
      return true;
  }
  
@@ -13,6 +13,8 @@
  
  #include <stdbool.h>
  #include <stdint.h>
+ #include "../0 - Allocator/allocator.h"
+ #include "../10 - Deque/deque.h"
  
  /*************************************************************************
   * Type Definitions
@@ -33,6 +35,32 @@
  queue_t * 
  queue_create(void);
  
+ /*!
+  * @brief Creates a new empty queue whose memory comes from an allocator.
+  *
+  * @param[in] p_alloc Allocator for the queue and its nodes, NULL for the
+  *                    default. Must outlive the queue.
+  * @return Pointer to newly created queue or NULL if allocation fails
+  */
+ queue_t * 
+ queue_create_ex(const allocator_t * p_alloc);
+ 
+ /*!
+  * @brief Creates a new empty queue that keeps its items in a ring-buffer
+  *        deque rather than in a node per item.
+  *
+  * The queue works through the same functions and holds as many items, but
+  * enqueue and dequeue allocate nothing once the ring has grown to fit.
+  *
+  * @param[in] initial_capacity Initial number of slots in the ring, rounded
+  *                             up to a power of two
+  * @param[in] p_alloc Allocator for the queue and its ring, NULL for the
+  *                    default. Must outlive the queue.
+  * @return Pointer to newly created queue or NULL if allocation fails
+  */
+ queue_t * 
+ queue_create_ring(uint32_t initial_capacity, const allocator_t * p_alloc);
+ 
  /*!
   * @brief Destroys a queue and frees all associated memory.
   *
@@ -0,0 +1,597 @@
+/** @file hash_dict.c
+ *
+ * @brief Implementation of the compact hash dict.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+ #include <stdlib.h>
+ #include <string.h>
+ #include "hash_dict.h"
+ 
+ #define HASH_DICT_MIN_SLOTS   (8u)           /* Smallest index table */
+ #define HASH_DICT_MAX_SLOTS   (1u << 31)     /* Largest index table */
+ #define HASH_DICT_EMPTY       (-1)           /* Index slot never used */
+ #define HASH_DICT_REMOVED     (-2)           /* Index slot of a removed key */
+ #define HASH_DICT_PERTURB     (5u)           /* Probe sequence shift */
+ 
+ /*!
+  * @brief Number of entries an index table of the given size holds,
+  *        two thirds of its slots as in CPython.
+  */
+ static uint32_t
+ usable_for(uint32_t slots)
+ {
+     return (uint32_t)(((uint64_t)slots * 2u) / 3u);
+ }
+ 
+ /*!
+  * @brief Read an index slot.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in] slot Slot number.
+  *
+  * @return Entry number, HASH_DICT_EMPTY or HASH_DICT_REMOVED.
+  */
+ static int32_t
+ index_get(const hash_dict_t *p_dict, uint32_t slot)
+ {
+     if (1u == p_dict->index_width)
+     {
+         return ((const int8_t *)p_dict->p_indices)[slot];
+     }
+     if (2u == p_dict->index_width)
+     {
+         return ((const int16_t *)p_dict->p_indices)[slot];
+     }
+     return ((const int32_t *)p_dict->p_indices)[slot];
+ }
+ 
+ /*!
+  * @brief Write an index slot.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] slot Slot number.
+  * @param[in] value Entry number, HASH_DICT_EMPTY or HASH_DICT_REMOVED.
+  */
+ static void
+ index_set(hash_dict_t *p_dict, uint32_t slot, int32_t value)
+ {
+     if (1u == p_dict->index_width)
+     {
+         ((int8_t *)p_dict->p_indices)[slot] = (int8_t)value;
+     }
+     else if (2u == p_dict->index_width)
+     {
+         ((int16_t *)p_dict->p_indices)[slot] = (int16_t)value;
+     }
+     else
+     {
+         ((int32_t *)p_dict->p_indices)[slot] = value;
+     }
+ }
+ 
+ /*!
+  * @brief Find a key.
+  *
+  * @details Probes in CPython's order: the low bits of the hash pick the
+  *          first slot, and the higher bits are shifted in as the probe
+  *          goes on, so keys that share low bits part ways.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  * @param[in] hash Hash of the key.
+  * @param[out] p_slot Receives the slot of the key, or of the empty slot
+  *                    that ended the search.
+  *
+  * @return Entry number of the key, or HASH_DICT_EMPTY if it is absent.
+  */
+ static int32_t
+ lookup(const hash_dict_t *p_dict, const void *p_key, uint32_t hash, uint32_t *p_slot)
+ {
+     uint32_t mask = p_dict->slots - 1u;
+     uint32_t slot = hash & mask;
+     uint32_t perturb = hash;
+ 
+     for (;;)
+     {
+         int32_t entry = index_get(p_dict, slot);
+ 
+         if (HASH_DICT_EMPTY == entry)
+         {
+             *p_slot = slot;
+             return HASH_DICT_EMPTY;
+         }
+ 
+         if ((entry >= 0) &&
+             (p_dict->p_entries[entry].hash == hash) &&
+             p_dict->key_equals(p_key, p_dict->p_entries[entry].p_key))
+         {
+             *p_slot = slot;
+             return entry;
+         }
+ 
+         perturb >>= HASH_DICT_PERTURB;
+         slot = ((slot * 5u) + perturb + 1u) & mask;
+     }
+ }
+ 
+ /*!
+  * @brief Find the first empty slot for a hash that is known to be absent.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in] hash Hash to place.
+  *
+  * @return Slot number.
+  */
+ static uint32_t
+ find_empty_slot(const hash_dict_t *p_dict, uint32_t hash)
+ {
+     uint32_t mask = p_dict->slots - 1u;
+     uint32_t slot = hash & mask;
+     uint32_t perturb = hash;
+ 
+     while (HASH_DICT_EMPTY != index_get(p_dict, slot))
+     {
+         perturb >>= HASH_DICT_PERTURB;
+         slot = ((slot * 5u) + perturb + 1u) & mask;
+     }
+ 
+     return slot;
+ }
+ 
+ /*!
+  * @brief Move the dict into a new table with room for at least min_size
+  *        keys, packing out removed entries.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] min_size Number of keys the new table must hold.
+  *
+  * @return true if the resize was successful, false otherwise.
+  */
+ static bool
+ resize_dict(hash_dict_t *p_dict, uint32_t min_size)
+ {
+     uint32_t slots = HASH_DICT_MIN_SLOTS;
+ 
+     while ((usable_for(slots) < min_size) && (slots < HASH_DICT_MAX_SLOTS))
+     {
+         slots *= 2u;
+     }
+ 
+     if (usable_for(slots) < min_size)
+     {
+         return false;
+     }
+ 
+     /* Number the entries with the narrowest slot that fits */
+     uint32_t usable = usable_for(slots);
+     uint32_t width = 4u;
+ 
+     if (usable <= (uint32_t)INT8_MAX)
+     {
+         width = 1u;
+     }
+     else if (usable <= (uint32_t)INT16_MAX)
+     {
+         width = 2u;
+     }
+ 
+     /* The index table is a multiple of 8 bytes, so the entries that
+      * follow it in the same block are aligned */
+     size_t index_bytes = (size_t)slots * width;
+     void *p_block = ALLOC_NEW(p_dict->p_alloc,
+                               index_bytes + ((size_t)usable * sizeof(hash_dict_entry_t)));
+ 
+     if (NULL == p_block)
+     {
+         return false;
+     }
+ 
+     hash_dict_t grown = *p_dict;
+ 
+     grown.p_indices = p_block;
+     grown.p_entries = (hash_dict_entry_t *)((uint8_t *)p_block + index_bytes);
+     grown.slots = slots;
+     grown.usable = usable;
+     grown.used = 0;
+     grown.index_width = width;
+ 
+     /* -1 in every slot, whatever the width */
+     memset(grown.p_indices, 0xFF, index_bytes);
+ 
+     for (uint32_t idx = 0; idx < p_dict->used; idx++)
+     {
+         const hash_dict_entry_t *p_entry = &p_dict->p_entries[idx];
+ 
+         if (NULL != p_entry->p_key)
+         {
+             index_set(&grown, find_empty_slot(&grown, p_entry->hash), (int32_t)grown.used);
+             grown.p_entries[grown.used] = *p_entry;
+             grown.used++;
+         }
+     }
+ 
+     if (NULL != p_dict->p_indices)
+     {
+         ALLOC_FREE(p_dict->p_alloc, p_dict->p_indices);
+     }
+     *p_dict = grown;
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Free the key of an entry and mark the entry removed.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in,out] p_entry Pointer to the entry.
+  * @param[in] b_free_value Flag indicating whether to free the value.
+  */
+ static void
+ release_entry(const hash_dict_t *p_dict, hash_dict_entry_t *p_entry, bool b_free_value)
+ {
+     if (NULL != p_dict->key_free)
+     {
+         p_dict->key_free(p_entry->p_key);
+     }
+ 
+     if ((b_free_value) && (NULL != p_entry->p_value))
+     {
+         free(p_entry->p_value);
+     }
+ 
+     p_entry->p_key = NULL;
+     p_entry->p_value = NULL;
+ }
+ 
+ /*!
+  * @brief Initialize a hash dict.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict to initialize.
+  * @param[in] initial_capacity Number of keys to make room for.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ hash_dict_init(hash_dict_t *p_dict,
+               uint32_t initial_capacity,
+               uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+               bool (*key_equals)(const void *p_key1, const void *p_key2),
+               void* (*key_copy)(const void *p_key),
+               void (*key_free)(void *p_key))
+ {
+     return hash_dict_init_ex(p_dict, initial_capacity, hash_function, key_equals,
+                              key_copy, key_free, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a hash dict whose table comes from an allocator.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict to initialize.
+  * @param[in] initial_capacity Number of keys to make room for.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  * @param[in] p_alloc Allocator for the table's memory, NULL for the default.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ hash_dict_init_ex(hash_dict_t *p_dict,
+                  uint32_t initial_capacity,
+                  uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                  bool (*key_equals)(const void *p_key1, const void *p_key2),
+                  void* (*key_copy)(const void *p_key),
+                  void (*key_free)(void *p_key),
+                  const allocator_t *p_alloc)
+ {
+     if ((NULL == p_dict) || (NULL == hash_function) || (NULL == key_equals))
+     {
+         return false;
+     }
+ 
+     memset(p_dict, 0, sizeof(*p_dict));
+     p_dict->hash_function = hash_function;
+     p_dict->key_equals = key_equals;
+     p_dict->key_copy = key_copy;
+     p_dict->key_free = key_free;
+     p_dict->p_alloc = p_alloc;
+ 
+     if (!resize_dict(p_dict, initial_capacity))
+     {
+         memset(p_dict, 0, sizeof(*p_dict));
+         return false;
+     }
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Put a key-value pair in the hash dict.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  * @param[in] p_value Pointer to the value.
+  *
+  * @return Pointer to the old value if key already exists, NULL otherwise.
+  */
+ void *
+ hash_dict_put(hash_dict_t *p_dict, const void *p_key, void *p_value)
+ {
+     if ((NULL == p_dict) || (NULL == p_key) || (NULL == p_dict->p_indices))
+     {
+         return NULL;
+     }
+ 
+     uint32_t hash = p_dict->hash_function(p_key, UINT32_MAX);
+     uint32_t slot = 0;
+     int32_t entry = lookup(p_dict, p_key, hash, &slot);
+ 
+     if (entry >= 0)
+     {
+         /* Key already exists, update the value */
+         void *p_old_value = p_dict->p_entries[entry].p_value;
+         p_dict->p_entries[entry].p_value = p_value;
+         return p_old_value;
+     }
+ 
+     /* Out of entries: make room for twice the keys, which also packs out
+      * removed entries, so a dict that mostly churns does not grow */
+     if (p_dict->used >= p_dict->usable)
+     {
+         uint32_t min_size = (p_dict->size >= (UINT32_MAX / 2u)) ?
+                             UINT32_MAX : (p_dict->size * 2u);
+
+         if (0u == min_size)
+         {
+             min_size = 1u;
+         }
+ 
+         if (!resize_dict(p_dict, min_size))
+         {
+             return NULL;
+         }
+         slot = find_empty_slot(p_dict, hash);
+     }
+ 
+     void *p_stored_key = (void *)p_key;
+ 
+     /* Copy the key if a key copy function is provided */
+     if (NULL != p_dict->key_copy)
+     {
+         p_stored_key = p_dict->key_copy(p_key);
+         if (NULL == p_stored_key)
+         {
+             return NULL;
+         }
+     }
+ 
+     hash_dict_entry_t *p_entry = &p_dict->p_entries[p_dict->used];
+ 
+     p_entry->p_key = p_stored_key;
+     p_entry->p_value = p_value;
+     p_entry->hash = hash;
+     index_set(p_dict, slot, (int32_t)p_dict->used);
+     p_dict->used++;
+     p_dict->size++;
+ 
+     return NULL;
+ }
+ 
+ /*!
+  * @brief Get the value associated with a key from the hash dict.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value associated with the key, or NULL if the key is not found.
+  */
+ void *
+ hash_dict_get(const hash_dict_t *p_dict, const void *p_key)
+ {
+     if ((NULL == p_dict) || (NULL == p_key) || (NULL == p_dict->p_indices))
+     {
+         return NULL;
+     }
+ 
+     uint32_t slot = 0;
+     int32_t entry = lookup(p_dict, p_key, p_dict->hash_function(p_key, UINT32_MAX), &slot);
+ 
+     return (entry >= 0) ? p_dict->p_entries[entry].p_value : NULL;
+ }
+ 
+ /*!
+  * @brief Remove a key-value pair from the hash dict.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value that was removed, or NULL if the key was not found.
+  */
+ void *
+ hash_dict_remove(hash_dict_t *p_dict, const void *p_key)
+ {
+     if ((NULL == p_dict) || (NULL == p_key) || (NULL == p_dict->p_indices))
+     {
+         return NULL;
+     }
+ 
+     uint32_t slot = 0;
+     int32_t entry = lookup(p_dict, p_key, p_dict->hash_function(p_key, UINT32_MAX), &slot);
+ 
+     if (entry < 0)
+     {
+         return NULL;
+     }
+ 
+     /* The slot stays taken so probes for other keys still pass it */
+     void *p_value = p_dict->p_entries[entry].p_value;
+ 
+     index_set(p_dict, slot, HASH_DICT_REMOVED);
+     release_entry(p_dict, &p_dict->p_entries[entry], false);
+     p_dict->size--;
+ 
+     return p_value;
+ }
+ 
+ /*!
+  * @brief Check if the hash dict contains a key.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return true if the hash dict contains the key, false otherwise.
+  */
+ bool
+ hash_dict_contains_key(const hash_dict_t *p_dict, const void *p_key)
+ {
+     if ((NULL == p_dict) || (NULL == p_key) || (NULL == p_dict->p_indices))
+     {
+         return false;
+     }
+ 
+     uint32_t slot = 0;
+ 
+     return lookup(p_dict, p_key, p_dict->hash_function(p_key, UINT32_MAX), &slot) >= 0;
+ }
+ 
+ /*!
+  * @brief Step through the entries in insertion order.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in,out] p_pos Position of the iteration.
+  * @param[out] pp_key Receives the key (may be NULL).
+  * @param[out] pp_value Receives the value (may be NULL).
+  *
+  * @return true if an entry was returned, false at the end.
+  */
+ bool
+ hash_dict_next(const hash_dict_t *p_dict, uint32_t *p_pos,
+                void **pp_key, void **pp_value)
+ {
+     if ((NULL == p_dict) || (NULL == p_pos))
+     {
+         return false;
+     }
+ 
+     /* Removed entries have a NULL key and are skipped */
+     while (*p_pos < p_dict->used)
+     {
+         const hash_dict_entry_t *p_entry = &p_dict->p_entries[*p_pos];
+ 
+         (*p_pos)++;
+         if (NULL != p_entry->p_key)
+         {
+             if (NULL != pp_key)
+             {
+                 *pp_key = p_entry->p_key;
+             }
+             if (NULL != pp_value)
+             {
+                 *pp_value = p_entry->p_value;
+             }
+             return true;
+         }
+     }
+ 
+     return false;
+ }
+ 
+ /*!
+  * @brief Get the size of the hash dict.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  *
+  * @return Number of entries in the hash dict.
+  */
+ uint32_t
+ hash_dict_size(const hash_dict_t *p_dict)
+ {
+     if (NULL == p_dict)
+     {
+         return 0;
+     }
+ 
+     return p_dict->size;
+ }
+ 
+ /*!
+  * @brief Check if the hash dict is empty.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  *
+  * @return true if the hash dict is empty, false otherwise.
+  */
+ bool
+ hash_dict_is_empty(const hash_dict_t *p_dict)
+ {
+     if (NULL == p_dict)
+     {
+         return true;
+     }
+ 
+     return (0 == p_dict->size);
+ }
+ 
+ /*!
+  * @brief Clear the hash dict, removing all entries and keeping its memory.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void
+ hash_dict_clear(hash_dict_t *p_dict, bool b_free_values)
+ {
+     if ((NULL == p_dict) || (NULL == p_dict->p_indices))
+     {
+         return;
+     }
+ 
+     /* Only keys and values that need freeing cost a pass over the entries */
+     if ((NULL != p_dict->key_free) || b_free_values)
+     {
+         for (uint32_t idx = 0; idx < p_dict->used; idx++)
+         {
+             if (NULL != p_dict->p_entries[idx].p_key)
+             {
+                 release_entry(p_dict, &p_dict->p_entries[idx], b_free_values);
+             }
+         }
+     }
+ 
+     memset(p_dict->p_indices, 0xFF, (size_t)p_dict->slots * p_dict->index_width);
+     p_dict->used = 0;
+     p_dict->size = 0;
+ }
+ 
+ /*!
+  * @brief Destroy the hash dict, freeing all memory associated with it.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void
+ hash_dict_destroy(hash_dict_t *p_dict, bool b_free_values)
+ {
+     if (NULL == p_dict)
+     {
+         return;
+     }
+ 
+     hash_dict_clear(p_dict, b_free_values);
+ 
+     if (NULL != p_dict->p_indices)
+     {
+         ALLOC_FREE(p_dict->p_alloc, p_dict->p_indices);
+     }
+ 
+     memset(p_dict, 0, sizeof(*p_dict));
+ }
+ /*** end of file ***/
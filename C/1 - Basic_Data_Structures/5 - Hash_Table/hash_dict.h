@@ -0,0 +1,205 @@
+/** @file hash_dict.h
+ *
+ * @brief A compact, insertion-ordered hash table in the layout of
+ *        CPython's dict.
+ *
+ * The entries sit in one dense array in the order they were added, and a
+ * separate index table of 1, 2 or 4 byte slots, the narrowest that can
+ * number the entries, maps hashes to them. Iteration is a linear scan of
+ * the entries, in insertion order; an entry costs its 24 bytes plus about
+ * two index slots, with no per-entry allocation; clearing resets the index
+ * table and keeps the memory.
+ *
+ * Removing a key leaves a hole in the entries until the table next grows
+ * and packs them. The callbacks are those of hash_table_t, except that
+ * hash_function is called once per key with a capacity of UINT32_MAX and
+ * the result is kept, so it should spread keys over the full 32 bits.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+ #ifndef HASH_DICT_H
+ #define HASH_DICT_H
+ 
+ #include <stdint.h>
+ #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
+ 
+ /**
+  * @brief Structure representing a hash dict entry.
+  */
+ typedef struct
+ {
+     void                *p_key;          /* Pointer to the key, NULL once removed */
+     void                *p_value;        /* Pointer to the value */
+     uint32_t             hash;           /* Full hash of the key */
+ } hash_dict_entry_t;
+ 
+ /**
+  * @brief Structure representing a hash dict.
+  */
+ typedef struct
+ {
+     void               *p_indices;       /* Index table, followed by the entries in one block */
+     hash_dict_entry_t  *p_entries;       /* Entries in insertion order */
+     uint32_t            slots;           /* Slots in the index table, a power of two */
+     uint32_t            usable;          /* Entries that fit before the dict grows */
+     uint32_t            used;            /* Entries appended, including removed ones */
+     uint32_t            size;            /* Number of keys in the dict */
+     uint32_t            index_width;     /* Bytes per index slot: 1, 2 or 4 */
+ 
+     /** @brief Function pointer to hash function */
+     uint32_t        (*hash_function)(const void *p_key, uint32_t capacity);
+ 
+     /** @brief Function pointer to key comparison function */
+     bool            (*key_equals)(const void *p_key1, const void *p_key2);
+ 
+     /** @brief Function pointer to key copy function */
+     void*           (*key_copy)(const void *p_key);
+ 
+     /** @brief Function pointer to key free function */
+     void            (*key_free)(void *p_key);
+ 
+     const allocator_t *p_alloc;          /* Allocator for the table (NULL for malloc) */
+ } hash_dict_t;
+ 
+ /**
+  * @brief Initialize a hash dict.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict to initialize.
+  * @param[in] initial_capacity Number of keys to make room for.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool hash_dict_init(hash_dict_t *p_dict,
+                    uint32_t initial_capacity,
+                    uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                    bool (*key_equals)(const void *p_key1, const void *p_key2),
+                    void* (*key_copy)(const void *p_key),
+                    void (*key_free)(void *p_key));
+ 
+ /**
+  * @brief Initialize a hash dict whose table comes from an allocator.
+  *
+  * @details Same as hash_dict_init(). Keys made by key_copy and values are
+  *          still owned by the caller and are not allocated through p_alloc.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict to initialize.
+  * @param[in] initial_capacity Number of keys to make room for.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  * @param[in] p_alloc Allocator for the table's memory, NULL for the default.
+  *                    Must outlive the dict.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool hash_dict_init_ex(hash_dict_t *p_dict,
+                       uint32_t initial_capacity,
+                       uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                       bool (*key_equals)(const void *p_key1, const void *p_key2),
+                       void* (*key_copy)(const void *p_key),
+                       void (*key_free)(void *p_key),
+                       const allocator_t *p_alloc);
+ 
+ /**
+  * @brief Put a key-value pair in the hash dict. A new key goes after
+  *        every key already present; an existing key keeps its place.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  * @param[in] p_value Pointer to the value.
+  *
+  * @return Pointer to the old value if key already exists, NULL otherwise.
+  */
+ void *hash_dict_put(hash_dict_t *p_dict, const void *p_key, void *p_value);
+ 
+ /**
+  * @brief Get the value associated with a key from the hash dict.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value associated with the key, or NULL if the key is not found.
+  */
+ void *hash_dict_get(const hash_dict_t *p_dict, const void *p_key);
+ 
+ /**
+  * @brief Remove a key-value pair from the hash dict.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value that was removed, or NULL if the key was not found.
+  */
+ void *hash_dict_remove(hash_dict_t *p_dict, const void *p_key);
+ 
+ /**
+  * @brief Check if the hash dict contains a key.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return true if the hash dict contains the key, false otherwise.
+  */
+ bool hash_dict_contains_key(const hash_dict_t *p_dict, const void *p_key);
+ 
+ /**
+  * @brief Step through the entries in insertion order.
+  *
+  * @details Start with *p_pos set to 0 and call until it returns false.
+  *          Between calls, keys may be removed and values replaced, but
+  *          adding a key may pack the entries and invalidate *p_pos.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  * @param[in,out] p_pos Position of the iteration.
+  * @param[out] pp_key Receives the key (may be NULL).
+  * @param[out] pp_value Receives the value (may be NULL).
+  *
+  * @return true if an entry was returned, false at the end.
+  */
+ bool hash_dict_next(const hash_dict_t *p_dict, uint32_t *p_pos,
+                     void **pp_key, void **pp_value);
+ 
+ /**
+  * @brief Get the size of the hash dict.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  *
+  * @return Number of entries in the hash dict.
+  */
+ uint32_t hash_dict_size(const hash_dict_t *p_dict);
+ 
+ /**
+  * @brief Check if the hash dict is empty.
+  *
+  * @param[in] p_dict Pointer to the hash dict.
+  *
+  * @return true if the hash dict is empty, false otherwise.
+  */
+ bool hash_dict_is_empty(const hash_dict_t *p_dict);
+ 
+ /**
+  * @brief Clear the hash dict, removing all entries and keeping its memory.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void hash_dict_clear(hash_dict_t *p_dict, bool b_free_values);
+ 
+ /**
+  * @brief Destroy the hash dict, freeing all memory associated with it.
+  *
+  * @param[in,out] p_dict Pointer to the hash dict.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void hash_dict_destroy(hash_dict_t *p_dict, bool b_free_values);
+ 
+ #endif /* HASH_DICT_H */
+ /*** end of file ***/
@@ -0,0 +1,319 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_dict.h"
+#include "hash_table.h"
+
+#define KEYS       (1000u)
+#define WIDE_KEYS  (70000u)  /* Past 65535 entries, so 4-byte index slots */
+
+// Keys and values are small non-zero integers carried in the pointer
+#define AS_PTR(n) ((void *)(uintptr_t)(n))
+#define AS_INT(p) ((uint32_t)(uintptr_t)(p))
+
+static uint32_t
+int_hash(const void * p_key, uint32_t capacity)
+{
+    uint32_t hash = AS_INT(p_key) * 2654435761u;
+
+    return (hash ^ (hash >> 16)) % capacity;
+}
+
+static bool
+int_equals(const void * p_key1, const void * p_key2)
+{
+    return p_key1 == p_key2;
+}
+
+static uint32_t
+string_hash(const void * p_key, uint32_t capacity)
+{
+    uint32_t hash = 2166136261u;
+
+    for (const char * p_char = p_key; '\0' != *p_char; p_char++)
+    {
+        hash = (hash ^ (uint8_t)*p_char) * 16777619u;
+    }
+
+    return hash % capacity;
+}
+
+static bool
+string_equals(const void * p_key1, const void * p_key2)
+{
+    return 0 == strcmp(p_key1, p_key2);
+}
+
+static void *
+string_copy(const void * p_key)
+{
+    size_t len    = strlen(p_key) + 1;
+    char * p_copy = malloc(len);
+
+    if (NULL != p_copy)
+    {
+        memcpy(p_copy, p_key, len);
+    }
+
+    return p_copy;
+}
+
+// The keys 1 .. KEYS in a scrambled but fixed order
+static uint32_t
+scrambled(uint32_t idx)
+{
+    return 1 + ((idx * 7919u) % KEYS);
+}
+
+// Checks the dict iterates exactly the expected keys, in that order
+static void
+assert_order(const hash_dict_t * p_dict, const uint32_t * p_keys,
+             uint32_t count)
+{
+    uint32_t pos  = 0;
+    uint32_t seen = 0;
+    void *   p_key;
+    void *   p_value;
+
+    while (hash_dict_next(p_dict, &pos, &p_key, &p_value))
+    {
+        ck_assert_uint_lt(seen, count);
+        ck_assert_uint_eq(AS_INT(p_key), p_keys[seen]);
+        ck_assert_ptr_eq(p_value, hash_dict_get(p_dict, p_key));
+        seen++;
+    }
+
+    ck_assert_uint_eq(seen, count);
+    ck_assert_uint_eq(hash_dict_size(p_dict), count);
+}
+
+START_TEST(test_dict_insertion_order)
+{
+    hash_dict_t dict;
+    uint32_t *  p_keys = malloc(KEYS * sizeof(uint32_t));
+
+    ck_assert_ptr_nonnull(p_keys);
+    ck_assert(hash_dict_init(&dict, 4, int_hash, int_equals, NULL, NULL));
+    ck_assert(hash_dict_is_empty(&dict));
+
+    // Grows several times on the way; the order survives every growth
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        p_keys[idx] = scrambled(idx);
+        ck_assert_ptr_null(hash_dict_put(&dict, AS_PTR(p_keys[idx]),
+                                         AS_PTR(p_keys[idx] + 1)));
+    }
+    assert_order(&dict, p_keys, KEYS);
+
+    // Replacing a value keeps the key where it was
+    ck_assert_uint_eq(AS_INT(hash_dict_put(&dict, AS_PTR(p_keys[10]),
+                                           AS_PTR(5))),
+                      p_keys[10] + 1);
+    ck_assert_uint_eq(AS_INT(hash_dict_get(&dict, AS_PTR(p_keys[10]))), 5);
+    assert_order(&dict, p_keys, KEYS);
+
+    free(p_keys);
+    hash_dict_destroy(&dict, false);
+}
+END_TEST
+
+START_TEST(test_dict_remove_and_readd)
+{
+    hash_dict_t dict;
+    uint32_t    keys[8]     = { 8, 3, 5, 1, 7, 2, 6, 4 };
+    uint32_t    expected[8] = { 8, 5, 1, 2, 6, 4, 3, 9 };
+
+    ck_assert(hash_dict_init(&dict, 8, int_hash, int_equals, NULL, NULL));
+    for (uint32_t idx = 0; idx < 8; idx++)
+    {
+        hash_dict_put(&dict, AS_PTR(keys[idx]), AS_PTR(keys[idx]));
+    }
+
+    // Removed keys leave holes the iteration skips; a key added back
+    // goes to the end, like a new one
+    ck_assert_uint_eq(AS_INT(hash_dict_remove(&dict, AS_PTR(3))), 3);
+    ck_assert_uint_eq(AS_INT(hash_dict_remove(&dict, AS_PTR(7))), 7);
+    ck_assert_ptr_null(hash_dict_remove(&dict, AS_PTR(7)));
+    ck_assert(!hash_dict_contains_key(&dict, AS_PTR(3)));
+    hash_dict_put(&dict, AS_PTR(3), AS_PTR(3));
+    hash_dict_put(&dict, AS_PTR(9), AS_PTR(9));
+    assert_order(&dict, expected, 8);
+
+    // Removing the entry just returned does not upset the iteration
+    uint32_t pos  = 0;
+    uint32_t seen = 0;
+    void *   p_key;
+    while (hash_dict_next(&dict, &pos, &p_key, NULL))
+    {
+        ck_assert_uint_eq(AS_INT(p_key), expected[seen++]);
+        hash_dict_remove(&dict, p_key);
+    }
+    ck_assert_uint_eq(seen, 8);
+    ck_assert(hash_dict_is_empty(&dict));
+
+    hash_dict_destroy(&dict, false);
+}
+END_TEST
+
+START_TEST(test_dict_index_widths)
+{
+    hash_dict_t dict;
+
+    ck_assert(hash_dict_init(&dict, 1, int_hash, int_equals, NULL, NULL));
+    ck_assert_uint_eq(dict.index_width, 1);
+
+    for (uint32_t key = 1; key <= WIDE_KEYS; key++)
+    {
+        hash_dict_put(&dict, AS_PTR(key), AS_PTR(key));
+        if (1000 == key)
+        {
+            ck_assert_uint_eq(dict.index_width, 2);
+        }
+    }
+    ck_assert_uint_eq(dict.index_width, 4);
+    ck_assert_uint_eq(hash_dict_size(&dict), WIDE_KEYS);
+
+    for (uint32_t key = 1; key <= WIDE_KEYS; key++)
+    {
+        ck_assert_uint_eq(AS_INT(hash_dict_get(&dict, AS_PTR(key))), key);
+    }
+    ck_assert_ptr_null(hash_dict_get(&dict, AS_PTR(WIDE_KEYS + 1)));
+
+    hash_dict_destroy(&dict, false);
+}
+END_TEST
+
+START_TEST(test_dict_clear_and_string_keys)
+{
+    hash_dict_t dict;
+    char        key[16];
+    int *       p_value = malloc(sizeof(int));
+
+    ck_assert_ptr_nonnull(p_value);
+    ck_assert(hash_dict_init(&dict, 4, string_hash, string_equals,
+                             string_copy, free));
+
+    // The dict owns copies of the keys, so the buffer can be reused
+    for (uint32_t idx = 0; idx < 100; idx++)
+    {
+        snprintf(key, sizeof(key), "key-%u", idx);
+        hash_dict_put(&dict, key, AS_PTR(idx + 1));
+    }
+    snprintf(key, sizeof(key), "key-%u", 42);
+    ck_assert_uint_eq(AS_INT(hash_dict_get(&dict, key)), 43);
+
+    uint32_t pos = 0;
+    void *   p_key;
+    ck_assert(hash_dict_next(&dict, &pos, &p_key, NULL));
+    ck_assert_str_eq(p_key, "key-0");
+
+    // Clearing empties the dict and it can be filled again
+    hash_dict_clear(&dict, false);
+    ck_assert(hash_dict_is_empty(&dict));
+    pos = 0;
+    ck_assert(!hash_dict_next(&dict, &pos, NULL, NULL));
+
+    hash_dict_put(&dict, "owned", p_value);
+    ck_assert_ptr_eq(hash_dict_get(&dict, "owned"), p_value);
+    hash_dict_destroy(&dict, true);
+}
+END_TEST
+
+START_TEST(test_table_next_visits_each_once)
+{
+    hash_table_t      table;
+    hash_table_iter_t iter = { 0 };
+    uint8_t *         p_seen = calloc(KEYS + 1, 1);
+    void *            p_key;
+    void *            p_value;
+    uint32_t          count = 0;
+
+    ck_assert_ptr_nonnull(p_seen);
+    ck_assert(hash_table_init(&table, 16, 0.75f, int_hash, int_equals, NULL,
+                              NULL));
+    ck_assert(!hash_table_next(&table, &iter, &p_key, &p_value));
+
+    for (uint32_t key = 1; key <= KEYS; key++)
+    {
+        hash_table_put(&table, AS_PTR(key), AS_PTR(key + 1));
+    }
+
+    iter = (hash_table_iter_t){ 0 };
+    while (hash_table_next(&table, &iter, &p_key, &p_value))
+    {
+        uint32_t key = AS_INT(p_key);
+
+        ck_assert_uint_ge(key, 1);
+        ck_assert_uint_le(key, KEYS);
+        ck_assert_uint_eq(p_seen[key], 0);
+        ck_assert_uint_eq(AS_INT(p_value), key + 1);
+        p_seen[key] = 1;
+        count++;
+
+        // The entry just returned may be removed
+        if (0 == (key % 2))
+        {
+            hash_table_remove(&table, p_key);
+        }
+    }
+    ck_assert_uint_eq(count, KEYS);
+    ck_assert_uint_eq(hash_table_size(&table), KEYS / 2);
+
+    // The odd keys are all that is left
+    iter  = (hash_table_iter_t){ 0 };
+    count = 0;
+    while (hash_table_next(&table, &iter, &p_key, NULL))
+    {
+        ck_assert_uint_eq(AS_INT(p_key) % 2, 1);
+        count++;
+    }
+    ck_assert_uint_eq(count, KEYS / 2);
+
+    free(p_seen);
+    hash_table_destroy(&table, false);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+hash_dict_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Hash_Dict");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_dict_insertion_order);
+    tcase_add_test(tc_core, test_dict_remove_and_readd);
+    tcase_add_test(tc_core, test_dict_index_widths);
+    tcase_add_test(tc_core, test_dict_clear_and_string_keys);
+    tcase_add_test(tc_core, test_table_next_visits_each_once);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = hash_dict_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
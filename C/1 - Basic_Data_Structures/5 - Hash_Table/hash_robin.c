@@ -0,0 +1,571 @@
+/** @file hash_robin.c
+ *
+ * @brief Implementation of the Robin Hood hash table.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+ #include <stdlib.h>
+ #include <string.h>
+ #include "hash_robin.h"
+ 
+ #define HASH_ROBIN_MIN_CAPACITY   (8u)           /* Smallest slot array */
+ #define HASH_ROBIN_MAX_CAPACITY   (1u << 31)     /* Largest slot array */
+ #define HASH_ROBIN_NOT_FOUND      (UINT32_MAX)   /* find_slot() miss */
+ #define HASH_ROBIN_GOLDEN         (0x9E3779B9u)  /* 2^32 / golden ratio */
+ 
+ /*!
+  * @brief Home slot of a hash: the top bits of its Fibonacci product.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in] hash Hash of the key.
+  *
+  * @return Slot number.
+  */
+ static uint32_t
+ home_slot(const hash_robin_t *p_table, uint32_t hash)
+ {
+     return (uint32_t)(hash * HASH_ROBIN_GOLDEN) >> p_table->shift;
+ }
+ 
+ /*!
+  * @brief Find the slot holding a key.
+  *
+  * @details A key that is present is never further from home than the
+  *          keys it passed, so the search stops at the first slot whose
+  *          key is closer to home than the probe, or that is empty.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  * @param[in] hash Hash of the key.
+  *
+  * @return Slot number, or HASH_ROBIN_NOT_FOUND.
+  */
+ static uint32_t
+ find_slot(const hash_robin_t *p_table, const void *p_key, uint32_t hash)
+ {
+     uint32_t mask = p_table->capacity - 1u;
+     uint32_t slot = home_slot(p_table, hash);
+ 
+     for (uint32_t distance = 1u; ; distance++)
+     {
+         const hash_robin_slot_t *p_slot = &p_table->p_slots[slot];
+ 
+         if (p_slot->distance < distance)
+         {
+             return HASH_ROBIN_NOT_FOUND;
+         }
+ 
+         if ((p_slot->hash == hash) && p_table->key_equals(p_key, p_slot->p_key))
+         {
+             return slot;
+         }
+ 
+         slot = (slot + 1u) & mask;
+     }
+ }
+ 
+ /*!
+  * @brief Place an entry whose key is known to be absent.
+  *
+  * @details Walks from the home slot; wherever the resident key is closer
+  *          to its home than the entry being placed, the two swap and the
+  *          walk goes on with the resident.
+  *
+  * @param[in,out] p_table Pointer to the table, with a free slot.
+  * @param[in] p_key Pointer to the stored key.
+  * @param[in] p_value Pointer to the value.
+  * @param[in] hash Hash of the key.
+  */
+ static void
+ insert_slot(hash_robin_t *p_table, void *p_key, void *p_value, uint32_t hash)
+ {
+     uint32_t mask = p_table->capacity - 1u;
+     uint32_t slot = home_slot(p_table, hash);
+     hash_robin_slot_t entry = { p_key, p_value, hash, 1u };
+ 
+     for (;;)
+     {
+         hash_robin_slot_t *p_slot = &p_table->p_slots[slot];
+ 
+         if (p_slot->distance < entry.distance)
+         {
+             hash_robin_slot_t resident = *p_slot;
+ 
+             *p_slot = entry;
+             if (entry.distance > p_table->max_distance)
+             {
+                 p_table->max_distance = entry.distance;
+             }
+ 
+             if (0u == resident.distance)
+             {
+                 return;
+             }
+             entry = resident;
+         }
+ 
+         slot = (slot + 1u) & mask;
+         entry.distance++;
+     }
+ }
+ 
+ /*!
+  * @brief Resize the table to the new capacity.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] new_capacity New number of slots, a power of two.
+  *
+  * @return true if the resize was successful, false otherwise.
+  */
+ static bool
+ resize_table(hash_robin_t *p_table, uint32_t new_capacity)
+ {
+     hash_robin_slot_t *p_new_slots = (hash_robin_slot_t *)ALLOC_ZEROED(p_table->p_alloc,
+                                                                       new_capacity,
+                                                                       sizeof(hash_robin_slot_t));
+ 
+     if (NULL == p_new_slots)
+     {
+         return false;
+     }
+ 
+     hash_robin_slot_t *p_old_slots = p_table->p_slots;
+     uint32_t old_capacity = p_table->capacity;
+     uint32_t shift = 32u;
+ 
+     for (uint32_t count = new_capacity; count > 1u; count >>= 1)
+     {
+         shift--;
+     }
+ 
+     p_table->p_slots = p_new_slots;
+     p_table->capacity = new_capacity;
+     p_table->shift = shift;
+     p_table->max_distance = 0;
+ 
+     /* Rehash all entries into the new slots */
+     for (uint32_t idx = 0; idx < old_capacity; idx++)
+     {
+         const hash_robin_slot_t *p_slot = &p_old_slots[idx];
+ 
+         if (0u != p_slot->distance)
+         {
+             insert_slot(p_table, p_slot->p_key, p_slot->p_value, p_slot->hash);
+         }
+     }
+ 
+     if (NULL != p_old_slots)
+     {
+         ALLOC_FREE(p_table->p_alloc, p_old_slots);
+     }
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Free the key and optionally the value of an occupied slot.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in] p_slot Pointer to the slot.
+  * @param[in] b_free_value Flag indicating whether to free the value.
+  */
+ static void
+ release_slot(const hash_robin_t *p_table, const hash_robin_slot_t *p_slot, bool b_free_value)
+ {
+     if ((NULL != p_table->key_free) && (NULL != p_slot->p_key))
+     {
+         p_table->key_free(p_slot->p_key);
+     }
+ 
+     if ((b_free_value) && (NULL != p_slot->p_value))
+     {
+         free(p_slot->p_value);
+     }
+ }
+ 
+ /*!
+  * @brief Initialize a hash robin table.
+  *
+  * @param[in,out] p_table Pointer to the table to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] load_factor Maximum ratio of size to capacity before resizing.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ hash_robin_init(hash_robin_t *p_table,
+                uint32_t initial_capacity,
+                float load_factor,
+                uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                bool (*key_equals)(const void *p_key1, const void *p_key2),
+                void* (*key_copy)(const void *p_key),
+                void (*key_free)(void *p_key))
+ {
+     return hash_robin_init_ex(p_table, initial_capacity, load_factor, hash_function,
+                               key_equals, key_copy, key_free, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a hash robin table whose slots come from an allocator.
+  *
+  * @param[in,out] p_table Pointer to the table to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] load_factor Maximum ratio of size to capacity before resizing.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  * @param[in] p_alloc Allocator for the table's memory, NULL for the default.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ hash_robin_init_ex(hash_robin_t *p_table,
+                   uint32_t initial_capacity,
+                   float load_factor,
+                   uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                   bool (*key_equals)(const void *p_key1, const void *p_key2),
+                   void* (*key_copy)(const void *p_key),
+                   void (*key_free)(void *p_key),
+                   const allocator_t *p_alloc)
+ {
+     if ((NULL == p_table) || (NULL == hash_function) || (NULL == key_equals))
+     {
+         return false;
+     }
+ 
+     /* Same defaults as hash_table_init(); a full table would never end a
+      * probe, so the load stays below HASH_ROBIN_MAX_LOAD */
+     if (load_factor <= 0.0f || load_factor > 1.0f)
+     {
+         load_factor = 0.75f;
+     }
+     else if (load_factor > HASH_ROBIN_MAX_LOAD)
+     {
+         load_factor = HASH_ROBIN_MAX_LOAD;
+     }
+ 
+     uint32_t capacity = HASH_ROBIN_MIN_CAPACITY;
+ 
+     while ((capacity < initial_capacity) && (capacity < HASH_ROBIN_MAX_CAPACITY))
+     {
+         capacity *= 2u;
+     }
+ 
+     memset(p_table, 0, sizeof(*p_table));
+     p_table->load_factor = load_factor;
+     p_table->hash_function = hash_function;
+     p_table->key_equals = key_equals;
+     p_table->key_copy = key_copy;
+     p_table->key_free = key_free;
+     p_table->p_alloc = p_alloc;
+ 
+     if (!resize_table(p_table, capacity))
+     {
+         memset(p_table, 0, sizeof(*p_table));
+         return false;
+     }
+ 
+     return true;
+ }
+ 
+ /*!
+  * @brief Put a key-value pair in the table.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  * @param[in] p_value Pointer to the value.
+  *
+  * @return Pointer to the old value if key already exists, NULL otherwise.
+  */
+ void *
+ hash_robin_put(hash_robin_t *p_table, const void *p_key, void *p_value)
+ {
+     if ((NULL == p_table) || (NULL == p_key) || (NULL == p_table->p_slots))
+     {
+         return NULL;
+     }
+ 
+     uint32_t hash = p_table->hash_function(p_key, UINT32_MAX);
+     uint32_t slot = find_slot(p_table, p_key, hash);
+ 
+     if (HASH_ROBIN_NOT_FOUND != slot)
+     {
+         /* Key already exists, update the value */
+         void *p_old_value = p_table->p_slots[slot].p_value;
+         p_table->p_slots[slot].p_value = p_value;
+         return p_old_value;
+     }
+ 
+     /* Check if we need to resize the table */
+     if ((p_table->size + 1u) > (uint32_t)(p_table->capacity * p_table->load_factor))
+     {
+         bool b_grown = (p_table->capacity < HASH_ROBIN_MAX_CAPACITY) &&
+                        resize_table(p_table, p_table->capacity * 2u);
+ 
+         /* Past the load factor is fine, but one slot must stay empty */
+         if (!b_grown && ((p_table->size + 2u) > p_table->capacity))
+         {
+             return NULL;
+         }
+     }
+ 
+     void *p_stored_key = (void *)p_key;
+ 
+     /* Copy the key if a key copy function is provided */
+     if (NULL != p_table->key_copy)
+     {
+         p_stored_key = p_table->key_copy(p_key);
+         if (NULL == p_stored_key)
+         {
+             return NULL;
+         }
+     }
+ 
+     insert_slot(p_table, p_stored_key, p_value, hash);
+     p_table->size++;
+ 
+     return NULL;
+ }
+ 
+ /*!
+  * @brief Get the value associated with a key from the table.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value associated with the key, or NULL if the key is not found.
+  */
+ void *
+ hash_robin_get(const hash_robin_t *p_table, const void *p_key)
+ {
+     if ((NULL == p_table) || (NULL == p_key) || (NULL == p_table->p_slots))
+     {
+         return NULL;
+     }
+ 
+     uint32_t slot = find_slot(p_table, p_key, p_table->hash_function(p_key, UINT32_MAX));
+ 
+     return (HASH_ROBIN_NOT_FOUND != slot) ? p_table->p_slots[slot].p_value : NULL;
+ }
+ 
+ /*!
+  * @brief Remove a key-value pair from the table.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value that was removed, or NULL if the key was not found.
+  */
+ void *
+ hash_robin_remove(hash_robin_t *p_table, const void *p_key)
+ {
+     if ((NULL == p_table) || (NULL == p_key) || (NULL == p_table->p_slots))
+     {
+         return NULL;
+     }
+ 
+     uint32_t slot = find_slot(p_table, p_key, p_table->hash_function(p_key, UINT32_MAX));
+ 
+     if (HASH_ROBIN_NOT_FOUND == slot)
+     {
+         return NULL;
+     }
+ 
+     void *p_value = p_table->p_slots[slot].p_value;
+     uint32_t mask = p_table->capacity - 1u;
+     uint32_t next = (slot + 1u) & mask;
+ 
+     release_slot(p_table, &p_table->p_slots[slot], false);
+ 
+     /* Backward shift: pull each following key that is away from home one
+      * slot closer, up to an empty slot or a key already at home */
+     while (p_table->p_slots[next].distance > 1u)
+     {
+         p_table->p_slots[slot] = p_table->p_slots[next];
+         p_table->p_slots[slot].distance--;
+         slot = next;
+         next = (next + 1u) & mask;
+     }
+ 
+     memset(&p_table->p_slots[slot], 0, sizeof(hash_robin_slot_t));
+     p_table->size--;
+ 
+     return p_value;
+ }
+ 
+ /*!
+  * @brief Check if the table contains a key.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return true if the table contains the key, false otherwise.
+  */
+ bool
+ hash_robin_contains_key(const hash_robin_t *p_table, const void *p_key)
+ {
+     if ((NULL == p_table) || (NULL == p_key) || (NULL == p_table->p_slots))
+     {
+         return false;
+     }
+ 
+     return HASH_ROBIN_NOT_FOUND !=
+            find_slot(p_table, p_key, p_table->hash_function(p_key, UINT32_MAX));
+ }
+ 
+ /*!
+  * @brief Step through the entries, in slot order.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in,out] p_pos Position of the iteration.
+  * @param[out] pp_key Receives the key (may be NULL).
+  * @param[out] pp_value Receives the value (may be NULL).
+  *
+  * @return true if an entry was returned, false at the end.
+  */
+ bool
+ hash_robin_next(const hash_robin_t *p_table, uint32_t *p_pos,
+                 void **pp_key, void **pp_value)
+ {
+     if ((NULL == p_table) || (NULL == p_pos) || (NULL == p_table->p_slots))
+     {
+         return false;
+     }
+ 
+     while (*p_pos < p_table->capacity)
+     {
+         const hash_robin_slot_t *p_slot = &p_table->p_slots[*p_pos];
+ 
+         (*p_pos)++;
+         if (0u != p_slot->distance)
+         {
+             if (NULL != pp_key)
+             {
+                 *pp_key = p_slot->p_key;
+             }
+             if (NULL != pp_value)
+             {
+                 *pp_value = p_slot->p_value;
+             }
+             return true;
+         }
+     }
+ 
+     return false;
+ }
+ 
+ /*!
+  * @brief Longest probe any lookup needs, in slots.
+  *
+  * @param[in] p_table Pointer to the table.
+  *
+  * @return Number of slots.
+  */
+ uint32_t
+ hash_robin_max_probe(const hash_robin_t *p_table)
+ {
+     if (NULL == p_table)
+     {
+         return 0;
+     }
+ 
+     return p_table->max_distance;
+ }
+ 
+ /*!
+  * @brief Get the size of the table.
+  *
+  * @param[in] p_table Pointer to the table.
+  *
+  * @return Number of entries in the table.
+  */
+ uint32_t
+ hash_robin_size(const hash_robin_t *p_table)
+ {
+     if (NULL == p_table)
+     {
+         return 0;
+     }
+ 
+     return p_table->size;
+ }
+ 
+ /*!
+  * @brief Check if the table is empty.
+  *
+  * @param[in] p_table Pointer to the table.
+  *
+  * @return true if the table is empty, false otherwise.
+  */
+ bool
+ hash_robin_is_empty(const hash_robin_t *p_table)
+ {
+     if (NULL == p_table)
+     {
+         return true;
+     }
+ 
+     return (0 == p_table->size);
+ }
+ 
+ /*!
+  * @brief Clear the table, removing all entries and keeping its slots.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void
+ hash_robin_clear(hash_robin_t *p_table, bool b_free_values)
+ {
+     if ((NULL == p_table) || (NULL == p_table->p_slots))
+     {
+         return;
+     }
+ 
+     if ((NULL != p_table->key_free) || b_free_values)
+     {
+         for (uint32_t idx = 0; idx < p_table->capacity; idx++)
+         {
+             if (0u != p_table->p_slots[idx].distance)
+             {
+                 release_slot(p_table, &p_table->p_slots[idx], b_free_values);
+             }
+         }
+     }
+ 
+     memset(p_table->p_slots, 0, (size_t)p_table->capacity * sizeof(hash_robin_slot_t));
+     p_table->size = 0;
+     p_table->max_distance = 0;
+ }
+ 
+ /*!
+  * @brief Destroy the table, freeing all memory associated with it.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void
+ hash_robin_destroy(hash_robin_t *p_table, bool b_free_values)
+ {
+     if (NULL == p_table)
+     {
+         return;
+     }
+ 
+     hash_robin_clear(p_table, b_free_values);
+ 
+     if (NULL != p_table->p_slots)
+     {
+         ALLOC_FREE(p_table->p_alloc, p_table->p_slots);
+     }
+ 
+     memset(p_table, 0, sizeof(*p_table));
+ }
+ /*** end of file ***/
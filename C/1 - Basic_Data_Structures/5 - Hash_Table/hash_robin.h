@@ -0,0 +1,223 @@
+/** @file hash_robin.h
+ *
+ * @brief An open-addressing hash table with Robin Hood probing.
+ *
+ * Every key sits in one flat slot array, at or after the slot its hash
+ * picks. Each slot records how far its key is from that home slot, and an
+ * insert takes the place of any key that is closer to home than the one
+ * being placed, so probe lengths stay short and even. A lookup stops as
+ * soon as it meets a key closer to home than its own probe, so misses are
+ * as cheap as hits. Removal shifts the following keys back instead of
+ * leaving tombstones.
+ *
+ * The API and callbacks are those of hash_table_t, and load_factor keeps
+ * its meaning, the largest ratio of keys to slots before the table grows,
+ * up to HASH_ROBIN_MAX_LOAD. hash_function is called once per key with a
+ * capacity of UINT32_MAX and the result is kept; it is mixed before use,
+ * so weak low bits do not cluster the keys.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+ #ifndef HASH_ROBIN_H
+ #define HASH_ROBIN_H
+ 
+ #include <stdint.h>
+ #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
+ 
+ #define HASH_ROBIN_MAX_LOAD (0.9f)      /* Larger load factors are lowered to this */
+ 
+ /**
+  * @brief Structure representing a hash robin slot.
+  */
+ typedef struct
+ {
+     void                *p_key;          /* Pointer to the key */
+     void                *p_value;        /* Pointer to the value */
+     uint32_t             hash;           /* Full hash of the key */
+     uint32_t             distance;       /* 1 + slots from home, 0 if empty */
+ } hash_robin_slot_t;
+ 
+ /**
+  * @brief Structure representing a hash robin table.
+  */
+ typedef struct
+ {
+     hash_robin_slot_t  *p_slots;         /* Array of slots */
+     uint32_t            size;            /* Number of entries in the table */
+     uint32_t            capacity;        /* Number of slots, a power of two */
+     uint32_t            shift;           /* 32 - log2(capacity), for the home slot */
+     uint32_t            max_distance;    /* Longest probe since the table was built */
+     float               load_factor;     /* Maximum ratio of size to capacity before resizing */
+ 
+     /** @brief Function pointer to hash function */
+     uint32_t        (*hash_function)(const void *p_key, uint32_t capacity);
+ 
+     /** @brief Function pointer to key comparison function */
+     bool            (*key_equals)(const void *p_key1, const void *p_key2);
+ 
+     /** @brief Function pointer to key copy function */
+     void*           (*key_copy)(const void *p_key);
+ 
+     /** @brief Function pointer to key free function */
+     void            (*key_free)(void *p_key);
+ 
+     const allocator_t *p_alloc;          /* Allocator for the slots (NULL for malloc) */
+ } hash_robin_t;
+ 
+ /**
+  * @brief Initialize a hash robin table.
+  *
+  * @param[in,out] p_table Pointer to the table to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] load_factor Maximum ratio of size to capacity before resizing.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool hash_robin_init(hash_robin_t *p_table,
+                     uint32_t initial_capacity,
+                     float load_factor,
+                     uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                     bool (*key_equals)(const void *p_key1, const void *p_key2),
+                     void* (*key_copy)(const void *p_key),
+                     void (*key_free)(void *p_key));
+ 
+ /**
+  * @brief Initialize a hash robin table whose slots come from an allocator.
+  *
+  * @details Same as hash_robin_init(). Keys made by key_copy and values are
+  *          still owned by the caller and are not allocated through p_alloc.
+  *
+  * @param[in,out] p_table Pointer to the table to initialize.
+  * @param[in] initial_capacity Initial number of slots, rounded up to a power of two.
+  * @param[in] load_factor Maximum ratio of size to capacity before resizing.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  * @param[in] p_alloc Allocator for the table's memory, NULL for the default.
+  *                    Must outlive the table.
+  *
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool hash_robin_init_ex(hash_robin_t *p_table,
+                        uint32_t initial_capacity,
+                        float load_factor,
+                        uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                        bool (*key_equals)(const void *p_key1, const void *p_key2),
+                        void* (*key_copy)(const void *p_key),
+                        void (*key_free)(void *p_key),
+                        const allocator_t *p_alloc);
+ 
+ /**
+  * @brief Put a key-value pair in the table.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  * @param[in] p_value Pointer to the value.
+  *
+  * @return Pointer to the old value if key already exists, NULL otherwise.
+  */
+ void *hash_robin_put(hash_robin_t *p_table, const void *p_key, void *p_value);
+ 
+ /**
+  * @brief Get the value associated with a key from the table.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value associated with the key, or NULL if the key is not found.
+  */
+ void *hash_robin_get(const hash_robin_t *p_table, const void *p_key);
+ 
+ /**
+  * @brief Remove a key-value pair from the table.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return Pointer to the value that was removed, or NULL if the key was not found.
+  */
+ void *hash_robin_remove(hash_robin_t *p_table, const void *p_key);
+ 
+ /**
+  * @brief Check if the table contains a key.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in] p_key Pointer to the key.
+  *
+  * @return true if the table contains the key, false otherwise.
+  */
+ bool hash_robin_contains_key(const hash_robin_t *p_table, const void *p_key);
+ 
+ /**
+  * @brief Step through the entries, in slot order.
+  *
+  * @details Start with *p_pos set to 0 and call until it returns false.
+  *          Values may be replaced between calls; adding or removing keys
+  *          moves other keys and invalidates the iteration.
+  *
+  * @param[in] p_table Pointer to the table.
+  * @param[in,out] p_pos Position of the iteration.
+  * @param[out] pp_key Receives the key (may be NULL).
+  * @param[out] pp_value Receives the value (may be NULL).
+  *
+  * @return true if an entry was returned, false at the end.
+  */
+ bool hash_robin_next(const hash_robin_t *p_table, uint32_t *p_pos,
+                      void **pp_key, void **pp_value);
+ 
+ /**
+  * @brief Longest probe any lookup needs, in slots.
+  *
+  * @details An upper bound: it is exact after the table grows and only
+  *          rises with inserts after that.
+  *
+  * @param[in] p_table Pointer to the table.
+  *
+  * @return Number of slots.
+  */
+ uint32_t hash_robin_max_probe(const hash_robin_t *p_table);
+ 
+ /**
+  * @brief Get the size of the table.
+  *
+  * @param[in] p_table Pointer to the table.
+  *
+  * @return Number of entries in the table.
+  */
+ uint32_t hash_robin_size(const hash_robin_t *p_table);
+ 
+ /**
+  * @brief Check if the table is empty.
+  *
+  * @param[in] p_table Pointer to the table.
+  *
+  * @return true if the table is empty, false otherwise.
+  */
+ bool hash_robin_is_empty(const hash_robin_t *p_table);
+ 
+ /**
+  * @brief Clear the table, removing all entries and keeping its slots.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void hash_robin_clear(hash_robin_t *p_table, bool b_free_values);
+ 
+ /**
+  * @brief Destroy the table, freeing all memory associated with it.
+  *
+  * @param[in,out] p_table Pointer to the table.
+  * @param[in] b_free_values Flag indicating whether to free the values pointed to by each entry.
+  */
+ void hash_robin_destroy(hash_robin_t *p_table, bool b_free_values);
+ 
+ #endif /* HASH_ROBIN_H */
+ /*** end of file ***/
@@ -0,0 +1,223 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "hash_robin.h"
+
+#define KEY_RANGE  (2000u)
+#define OPERATIONS (20000u)
+
+// Keys and values are small non-zero integers carried in the pointer
+#define AS_PTR(n) ((void *)(uintptr_t)(n))
+#define AS_INT(p) ((uint32_t)(uintptr_t)(p))
+
+static uint32_t
+int_hash(const void * p_key, uint32_t capacity)
+{
+    return (AS_INT(p_key) * 2654435761u) % capacity;
+}
+
+// Every key has the same home slot, so they form one cluster
+static uint32_t
+same_hash(const void * p_key, uint32_t capacity)
+{
+    (void)p_key;
+    return 12345u % capacity;
+}
+
+static bool
+int_equals(const void * p_key1, const void * p_key2)
+{
+    return p_key1 == p_key2;
+}
+
+// Checks the layout backward-shift deletion keeps: a key away from home
+// is never preceded by an empty slot, a slot is at most one further from
+// home than the one before it, and only live keys take up slots
+static void
+assert_layout(const hash_robin_t * p_table)
+{
+    uint32_t used = 0;
+
+    for (uint32_t slot = 0; slot < p_table->capacity; slot++)
+    {
+        const hash_robin_slot_t * p_slot = &p_table->p_slots[slot];
+        const hash_robin_slot_t * p_prev
+            = &p_table->p_slots[(slot + p_table->capacity - 1)
+                                % p_table->capacity];
+
+        if (0 == p_slot->distance)
+        {
+            continue;
+        }
+
+        used++;
+        ck_assert_uint_le(p_slot->distance, p_prev->distance + 1);
+        if (p_slot->distance > 1)
+        {
+            ck_assert_uint_ne(p_prev->distance, 0);
+        }
+        ck_assert_uint_le(p_slot->distance, hash_robin_max_probe(p_table));
+    }
+
+    ck_assert_uint_eq(used, hash_robin_size(p_table));
+}
+
+START_TEST(test_backward_shift_in_cluster)
+{
+    hash_robin_t table;
+
+    ck_assert(hash_robin_init(&table, 16, 0.9f, same_hash, int_equals, NULL,
+                              NULL));
+
+    for (uint32_t key = 1; key <= 8; key++)
+    {
+        ck_assert_ptr_null(hash_robin_put(&table, AS_PTR(key), AS_PTR(key)));
+    }
+    ck_assert_uint_eq(hash_robin_max_probe(&table), 8);
+    assert_layout(&table);
+
+    // Taking a key out of the middle shifts the rest back one slot each,
+    // leaving no tombstone behind and no key further from home than needed
+    ck_assert_uint_eq(AS_INT(hash_robin_remove(&table, AS_PTR(3))), 3);
+    assert_layout(&table);
+
+    uint32_t distances[8] = { 0 };
+    for (uint32_t slot = 0; slot < table.capacity; slot++)
+    {
+        uint32_t distance = table.p_slots[slot].distance;
+        if (0 != distance)
+        {
+            ck_assert_uint_le(distance, 7);
+            distances[distance]++;
+        }
+    }
+    for (uint32_t distance = 1; distance <= 7; distance++)
+    {
+        ck_assert_uint_eq(distances[distance], 1);
+    }
+
+    for (uint32_t key = 1; key <= 8; key++)
+    {
+        ck_assert_uint_eq(AS_INT(hash_robin_get(&table, AS_PTR(key))),
+                          (3 == key) ? 0 : key);
+    }
+
+    // Removing the last of the cluster and then the first empties it
+    ck_assert_uint_eq(AS_INT(hash_robin_remove(&table, AS_PTR(8))), 8);
+    ck_assert_uint_eq(AS_INT(hash_robin_remove(&table, AS_PTR(1))), 1);
+    assert_layout(&table);
+    ck_assert_uint_eq(hash_robin_size(&table), 5);
+
+    hash_robin_destroy(&table, false);
+}
+END_TEST
+
+START_TEST(test_random_operations)
+{
+    hash_robin_t table;
+    uint32_t *   p_shadow = calloc(KEY_RANGE + 1, sizeof(uint32_t));
+    uint32_t     size     = 0;
+    uint64_t     state    = 88172645463325252ull;
+
+    ck_assert_ptr_nonnull(p_shadow);
+    ck_assert(hash_robin_init(&table, 4, 0.9f, int_hash, int_equals, NULL,
+                              NULL));
+
+    for (uint32_t op = 0; op < OPERATIONS; op++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        uint32_t key = 1 + (uint32_t)(state % KEY_RANGE);
+
+        if (0 == ((state >> 32) % 3))
+        {
+            void * p_old = hash_robin_remove(&table, AS_PTR(key));
+            ck_assert_uint_eq(AS_INT(p_old), p_shadow[key]);
+            size        -= (0 != p_shadow[key]) ? 1 : 0;
+            p_shadow[key] = 0;
+        }
+        else
+        {
+            void * p_old = hash_robin_put(&table, AS_PTR(key), AS_PTR(op + 1));
+            ck_assert_uint_eq(AS_INT(p_old), p_shadow[key]);
+            size         += (0 == p_shadow[key]) ? 1 : 0;
+            p_shadow[key] = op + 1;
+        }
+
+        ck_assert_uint_eq(hash_robin_size(&table), size);
+        if (0 == (op % 500))
+        {
+            assert_layout(&table);
+        }
+    }
+
+    assert_layout(&table);
+    for (uint32_t key = 1; key <= KEY_RANGE; key++)
+    {
+        ck_assert_uint_eq(AS_INT(hash_robin_get(&table, AS_PTR(key))),
+                          p_shadow[key]);
+        ck_assert(hash_robin_contains_key(&table, AS_PTR(key))
+                  == (0 != p_shadow[key]));
+    }
+
+    // Iteration returns each live key once
+    uint32_t pos   = 0;
+    uint32_t count = 0;
+    void *   p_key;
+    void *   p_value;
+    while (hash_robin_next(&table, &pos, &p_key, &p_value))
+    {
+        ck_assert_uint_eq(AS_INT(p_value), p_shadow[AS_INT(p_key)]);
+        count++;
+    }
+    ck_assert_uint_eq(count, size);
+
+    hash_robin_clear(&table, false);
+    ck_assert(hash_robin_is_empty(&table));
+    assert_layout(&table);
+
+    free(p_shadow);
+    hash_robin_destroy(&table, false);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+hash_robin_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Hash_Robin");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_backward_shift_in_cluster);
+    tcase_add_test(tc_core, test_random_operations);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = hash_robin_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -22,7 +22,7 @@
  static hash_entry_t *
  create_entry(const hash_table_t *p_table, const void *p_key, void *p_value)
  {
-     hash_entry_t *p_entry = (hash_entry_t *)malloc(sizeof(hash_entry_t));
+     hash_entry_t *p_entry = (hash_entry_t *)ALLOC_NEW(p_table->p_alloc, sizeof(hash_entry_t));
      
      if (NULL == p_entry)
      {
@@ -35,7 +35,7 @@
          p_entry->p_key = p_table->key_copy(p_key);
          if (NULL == p_entry->p_key)
          {
-             free(p_entry);
+             ALLOC_FREE(p_table->p_alloc, p_entry);
              return NULL;
          }
      }
@@ -78,7 +78,7 @@
          free(p_entry->p_value);
      }
      
-     free(p_entry);
+     ALLOC_FREE(p_table->p_alloc, p_entry);
  }
  
  /*!
@@ -139,7 +139,8 @@
      }
      
      /* Allocate a new array of buckets */
-     hash_entry_t **pp_new_buckets = (hash_entry_t **)calloc(new_capacity, sizeof(hash_entry_t *));
+     hash_entry_t **pp_new_buckets = (hash_entry_t **)ALLOC_ZEROED(p_table->p_alloc, new_capacity,
+                                                                   sizeof(hash_entry_t *));
      
      if (NULL == pp_new_buckets)
      {
@@ -154,7 +155,7 @@
                     p_table->hash_function);
      
      /* Free the old buckets array and update the hash table */
-     free(p_table->pp_buckets);
+     ALLOC_FREE(p_table->p_alloc, p_table->pp_buckets);
      p_table->pp_buckets = pp_new_buckets;
      p_table->capacity = new_capacity;
      result = true;
@@ -199,6 +200,34 @@
                 bool (*key_equals)(const void *p_key1, const void *p_key2),
                 void* (*key_copy)(const void *p_key),
                 void (*key_free)(void *p_key))
+ {
+     return hash_table_init_ex(p_table, initial_capacity, load_factor, hash_function,
+                               key_equals, key_copy, key_free, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a hash table whose buckets and entries come from an allocator.
+  *
+  * @param[in,out] p_table Pointer to the hash table to initialize.
+  * @param[in] initial_capacity Initial capacity of the hash table.
+  * @param[in] load_factor Maximum ratio of size to capacity before resizing.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  * @param[in] p_alloc Allocator for the table's memory, NULL for the default.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ hash_table_init_ex(hash_table_t *p_table, 
+                   uint32_t initial_capacity,
+                   float load_factor,
+                   uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                   bool (*key_equals)(const void *p_key1, const void *p_key2),
+                   void* (*key_copy)(const void *p_key),
+                   void (*key_free)(void *p_key),
+                   const allocator_t *p_alloc)
  {
      bool result = false;
      
@@ -219,7 +248,9 @@
      }
      
      /* Allocate memory for the buckets array */
-     p_table->pp_buckets = (hash_entry_t **)calloc(initial_capacity, sizeof(hash_entry_t *));
+     p_table->p_alloc = p_alloc;
+     p_table->pp_buckets = (hash_entry_t **)ALLOC_ZEROED(p_alloc, initial_capacity,
+                                                         sizeof(hash_entry_t *));
      
      if (NULL != p_table->pp_buckets)
      {
@@ -438,6 +469,54 @@
      return false;
  }
  
+ /*!
+  * @brief Step through the entries, in bucket order.
+  *
+  * @param[in] p_table Pointer to the hash table.
+  * @param[in,out] p_iter Position of the iteration.
+  * @param[out] pp_key Receives the key (may be NULL).
+  * @param[out] pp_value Receives the value (may be NULL).
+  *
+  * @return true if an entry was returned, false at the end.
+  */
+ bool
+ hash_table_next(const hash_table_t *p_table, hash_table_iter_t *p_iter,
+                 void **pp_key, void **pp_value)
+ {
+     if ((NULL == p_table) || (NULL == p_iter) || (NULL == p_table->pp_buckets))
+     {
+         return false;
+     }
+     
+     /* Move on to the next non-empty bucket once the chain runs out */
+     while ((NULL == p_iter->p_entry) && (p_iter->bucket < p_table->capacity))
+     {
+         p_iter->p_entry = p_table->pp_buckets[p_iter->bucket];
+         p_iter->bucket++;
+     }
+     
+     if (NULL == p_iter->p_entry)
+     {
+         return false;
+     }
+     
+     hash_entry_t *p_entry = p_iter->p_entry;
+     
+     /* Step past the entry first, so the caller may remove it */
+     p_iter->p_entry = p_entry->p_next;
+     
+     if (NULL != pp_key)
+     {
+         *pp_key = p_entry->p_key;
+     }
+     if (NULL != pp_value)
+     {
+         *pp_value = p_entry->p_value;
+     }
+     
+     return true;
+ }
+ 
  /*!
   * @brief Get the size of the hash table.
   *
@@ -529,7 +608,7 @@
      /* Free the buckets array */
      if (NULL != p_table->pp_buckets)
      {
-         free(p_table->pp_buckets);
+         ALLOC_FREE(p_table->p_alloc, p_table->pp_buckets);
          p_table->pp_buckets = NULL;
      }
      
@@ -541,5 +620,6 @@
      p_table->key_equals = NULL;
      p_table->key_copy = NULL;
      p_table->key_free = NULL;
+     p_table->p_alloc = NULL;
  }
  /*** end of file ***/
\ No newline at end of file
@@ -11,6 +11,7 @@
  
  #include <stdint.h>
  #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
  
  /**
   * @brief Structure representing a hash table entry.
@@ -43,8 +44,19 @@
      
      /** @brief Function pointer to key free function */
      void            (*key_free)(void *p_key);
+     
+     const allocator_t *p_alloc;         /* Allocator for buckets and entries (NULL for malloc) */
  } hash_table_t;
  
+ /**
+  * @brief Position of an iteration over a hash table; start from { 0 }.
+  */
+ typedef struct
+ {
+     uint32_t          bucket;           /* Next bucket to visit */
+     hash_entry_t     *p_entry;          /* Next entry in the current chain */
+ } hash_table_iter_t;
+ 
  /**
   * @brief Initialize a hash table.
   *
@@ -77,6 +89,33 @@
                      void* (*key_copy)(const void *p_key),
                      void (*key_free)(void *p_key));
  
+ /**
+  * @brief Initialize a hash table whose buckets and entries come from an allocator.
+  *
+  * @details Same as hash_table_init(). Keys made by key_copy and values are
+  *          still owned by the caller and are not allocated through p_alloc.
+  *
+  * @param[in,out] p_table Pointer to the hash table to initialize.
+  * @param[in] initial_capacity Initial capacity of the hash table.
+  * @param[in] load_factor Maximum ratio of size to capacity before resizing.
+  * @param[in] hash_function Function to calculate hash code for a key.
+  * @param[in] key_equals Function to check if two keys are equal.
+  * @param[in] key_copy Function to create a copy of a key (can be NULL for simple keys).
+  * @param[in] key_free Function to free a key (can be NULL for simple keys).
+  * @param[in] p_alloc Allocator for the table's memory, NULL for the default.
+  *                    Must outlive the table.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool hash_table_init_ex(hash_table_t *p_table, 
+                        uint32_t initial_capacity,
+                        float load_factor,
+                        uint32_t (*hash_function)(const void *p_key, uint32_t capacity),
+                        bool (*key_equals)(const void *p_key1, const void *p_key2),
+                        void* (*key_copy)(const void *p_key),
+                        void (*key_free)(void *p_key),
+                        const allocator_t *p_alloc);
+ 
  /**
   * @brief Put a key-value pair in the hash table.
   *
@@ -118,6 +157,25 @@
   */
  bool hash_table_contains_key(const hash_table_t *p_table, const void *p_key);
  
+ /**
+  * @brief Step through the entries, in bucket order.
+  *
+  * @details Visits every bucket, empty or not, so a pass costs the
+  *          capacity as well as the size; hash_dict_t iterates in
+  *          insertion order over its entries alone. Between calls, the
+  *          entry just returned may be removed and values replaced, but
+  *          adding a key may resize the table and invalidate the iteration.
+  *
+  * @param[in] p_table Pointer to the hash table.
+  * @param[in,out] p_iter Position of the iteration.
+  * @param[out] pp_key Receives the key (may be NULL).
+  * @param[out] pp_value Receives the value (may be NULL).
+  *
+  * @return true if an entry was returned, false at the end.
+  */
+ bool hash_table_next(const hash_table_t *p_table, hash_table_iter_t *p_iter,
+                      void **pp_key, void **pp_value);
+ 
  /**
   * @brief Get the size of the hash table.
   *
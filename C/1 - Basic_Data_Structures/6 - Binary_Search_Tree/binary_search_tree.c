@@ -12,14 +12,15 @@
  /*!
   * @brief Create a new node for the binary search tree.
   *
+  * @param[in] p_alloc Allocator for the node.
   * @param[in] p_data Pointer to the data to be stored in the new node.
   *
   * @return Pointer to the newly created node, or NULL if memory allocation failed.
   */
  static bst_node_t *
- create_node(void *p_data)
+ create_node(const allocator_t *p_alloc, void *p_data)
  {
-     bst_node_t *p_node = (bst_node_t *)malloc(sizeof(bst_node_t));
+     bst_node_t *p_node = (bst_node_t *)ALLOC_NEW(p_alloc, sizeof(bst_node_t));
      
      if (NULL == p_node)
      {
@@ -208,11 +209,12 @@
  /*!
   * @brief Recursively free all nodes in a subtree.
   *
+  * @param[in] p_alloc Allocator the nodes came from.
   * @param[in] p_node Root of the subtree to free.
   * @param[in] b_free_data Flag indicating whether to free the data pointed to by each node.
   */
  static void
- free_subtree(bst_node_t *p_node, bool b_free_data)
+ free_subtree(const allocator_t *p_alloc, bst_node_t *p_node, bool b_free_data)
  {
      if (NULL == p_node)
      {
@@ -220,8 +222,8 @@
      }
      
      /* Recursively free left and right subtrees */
-     free_subtree(p_node->p_left, b_free_data);
-     free_subtree(p_node->p_right, b_free_data);
+     free_subtree(p_alloc, p_node->p_left, b_free_data);
+     free_subtree(p_alloc, p_node->p_right, b_free_data);
      
      /* Free the data if requested and it exists */
      if ((b_free_data) && (NULL != p_node->p_data))
@@ -230,7 +232,7 @@
      }
      
      /* Free the node */
-     free(p_node);
+     ALLOC_FREE(p_alloc, p_node);
  }
  
  /*!
@@ -260,7 +262,7 @@
          }
      }
      
-     free(p_node);
+     ALLOC_FREE(p_tree->p_alloc, p_node);
  }
  
  /*!
@@ -293,7 +295,7 @@
      /* Update child's parent pointer */
      p_node->p_right->p_parent = p_node->p_parent;
      
-     free(p_node);
+     ALLOC_FREE(p_tree->p_alloc, p_node);
  }
  
  /*!
@@ -326,7 +328,7 @@
      /* Update child's parent pointer */
      p_node->p_left->p_parent = p_node->p_parent;
      
-     free(p_node);
+     ALLOC_FREE(p_tree->p_alloc, p_node);
  }
  
  /*!
@@ -339,6 +341,21 @@
   */
  bool
  bst_init(bst_t *p_tree, bst_compare_func_t compare_fn)
+ {
+     return (bst_init_ex(p_tree, compare_fn, NULL));
+ }
+ 
+ /*!
+  * @brief Initialize a binary search tree whose nodes come from an allocator.
+  *
+  * @param[in,out] p_tree Pointer to the binary search tree to initialize.
+  * @param[in] compare_fn Function used to compare nodes.
+  * @param[in] p_alloc Allocator for the nodes, NULL for the default.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ bst_init_ex(bst_t *p_tree, bst_compare_func_t compare_fn, const allocator_t *p_alloc)
  {
      if ((NULL == p_tree) || (NULL == compare_fn))
      {
@@ -348,6 +365,7 @@
      p_tree->p_root = NULL;
      p_tree->size = 0;
      p_tree->compare_fn = compare_fn;
+     p_tree->p_alloc = p_alloc;
      
      return (true);
  }
@@ -369,7 +387,7 @@
      }
      
      /* Create a new node */
-     bst_node_t *p_new_node = create_node(p_data);
+     bst_node_t *p_new_node = create_node(p_tree->p_alloc, p_data);
      
      if (NULL == p_new_node)
      {
@@ -398,7 +416,7 @@
          if (0 == compare_result)
          {
              /* Duplicate data, free the new node and fail */
-             free(p_new_node);
+             ALLOC_FREE(p_tree->p_alloc, p_new_node);
              return (false);
          }
          else if (compare_result < 0)
@@ -662,7 +680,7 @@
      }
      
      /* Free all nodes in the tree */
-     free_subtree(p_tree->p_root, b_free_data);
+     free_subtree(p_tree->p_alloc, p_tree->p_root, b_free_data);
      
      /* Reset the tree structure */
      p_tree->p_root = NULL;
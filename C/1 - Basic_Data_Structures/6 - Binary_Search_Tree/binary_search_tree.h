@@ -11,6 +11,7 @@
  
  #include <stdint.h>
  #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
  
  /**
   * @brief Typedef for the comparison function used by the binary search tree.
@@ -41,6 +42,7 @@
      bst_node_t         *p_root;      /* Pointer to the root node of the tree */
      uint32_t            size;        /* Number of nodes in the tree */
      bst_compare_func_t  compare_fn;  /* Function used to compare nodes */
+     const allocator_t  *p_alloc;     /* Allocator for nodes (NULL for malloc) */
  } bst_t;
  
  /**
@@ -54,6 +56,19 @@
  bool
  bst_init(bst_t *p_tree, bst_compare_func_t compare_fn);
  
+ /**
+  * @brief Initialize a binary search tree whose nodes come from an allocator.
+  *
+  * @param[in,out] p_tree Pointer to the binary search tree to initialize.
+  * @param[in] compare_fn Function used to compare nodes.
+  * @param[in] p_alloc Allocator for the nodes, NULL for the default.
+  *                    Must outlive the tree.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool
+ bst_init_ex(bst_t *p_tree, bst_compare_func_t compare_fn, const allocator_t *p_alloc);
+ 
  /**
   * @brief Insert a new node into the binary search tree.
   *
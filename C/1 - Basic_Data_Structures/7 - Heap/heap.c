@@ -136,7 +136,7 @@
      }
      
      /* Allocate memory for the new array */
-     void **pp_new_data = (void **)realloc(p_heap->pp_data, new_capacity * sizeof(void *));
+     void **pp_new_data = (void **)ALLOC_RESIZE(p_heap->p_alloc, p_heap->pp_data, new_capacity * sizeof(void *));
      
      if (NULL != pp_new_data)
      {
@@ -160,6 +160,23 @@
   * @return true if initialization was successful, false otherwise.
   */
  bool heap_init(heap_t *p_heap, uint32_t initial_capacity, float growth_factor, heap_compare_func_t compare_fn)
+ {
+     return heap_init_ex(p_heap, initial_capacity, growth_factor, compare_fn, NULL);
+ }
+ 
+ /*!
+  * @brief Initialize a heap whose storage comes from an allocator.
+  *
+  * @param[in,out] p_heap Pointer to the heap to initialize.
+  * @param[in] initial_capacity Initial capacity of the heap.
+  * @param[in] growth_factor Factor by which to grow the heap when needed.
+  * @param[in] compare_fn Function used to compare elements.
+  * @param[in] p_alloc Allocator for the heap's storage, NULL for the default.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool heap_init_ex(heap_t *p_heap, uint32_t initial_capacity, float growth_factor, heap_compare_func_t compare_fn,
+                   const allocator_t *p_alloc)
  {
      bool result = false;
      
@@ -180,7 +197,8 @@
      }
      
      /* Allocate memory for the data array */
-     p_heap->pp_data = (void **)malloc(initial_capacity * sizeof(void *));
+     p_heap->p_alloc = p_alloc;
+     p_heap->pp_data = (void **)ALLOC_NEW(p_alloc, initial_capacity * sizeof(void *));
      
      if (NULL != p_heap->pp_data)
      {
@@ -459,6 +477,89 @@
      return p_removed_data;
  }
  
+ /*!
+  * @brief Offer an element to a heap used as a bounded top-k selector.
+  *
+  * @param[in,out] p_heap Pointer to the heap, holding at most k elements.
+  * @param[in] k Number of elements to keep, at least 1.
+  * @param[in] p_data Pointer to the data to offer.
+  * @param[out] pp_dropped Receives the element that left the selection, or NULL.
+  *
+  * @return true if the element was offered, false otherwise.
+  */
+ bool heap_topk_stream(heap_t *p_heap, uint32_t k, void *p_data, void **pp_dropped)
+ {
+     if (NULL != pp_dropped)
+     {
+         *pp_dropped = NULL;
+     }
+     
+     if ((NULL == p_heap) || (NULL == p_heap->pp_data) || (NULL == p_data) || 
+         (0 == k) || (p_heap->size > k))
+     {
+         return false;
+     }
+     
+     /* Still filling up: every element is kept for now */
+     if (p_heap->size < k)
+     {
+         return heap_insert(p_heap, p_data);
+     }
+     
+     /* Fast path: an element that does not beat the top is dropped at once */
+     if (p_heap->compare_fn(p_heap->pp_data[0], p_data) >= 0)
+     {
+         if (NULL != pp_dropped)
+         {
+             *pp_dropped = p_data;
+         }
+         
+         return true;
+     }
+     
+     /* Replace the top in place and sift the new element down */
+     if (NULL != pp_dropped)
+     {
+         *pp_dropped = p_heap->pp_data[0];
+     }
+     
+     p_heap->pp_data[0] = p_data;
+     heapify_down(p_heap, 0);
+     
+     return true;
+ }
+ 
+ /*!
+  * @brief Merge one top-k heap into another.
+  *
+  * @param[in,out] p_dest Pointer to the heap to merge into, holding at most k elements.
+  * @param[in] k Number of elements to keep, at least 1.
+  * @param[in,out] p_src Pointer to the heap to merge from.
+  *
+  * @return true if the heaps were merged, false otherwise.
+  */
+ bool heap_topk_merge(heap_t *p_dest, uint32_t k, heap_t *p_src)
+ {
+     if ((NULL == p_dest) || (NULL == p_src) || (p_dest == p_src) || 
+         (NULL == p_src->pp_data))
+     {
+         return false;
+     }
+     
+     /* Take elements from the end, which leaves the rest of p_src a valid heap */
+     while (p_src->size > 0)
+     {
+         if (!heap_topk_stream(p_dest, k, p_src->pp_data[p_src->size - 1], NULL))
+         {
+             return false;
+         }
+         
+         p_src->size--;
+     }
+     
+     return true;
+ }
+ 
  /*!
   * @brief Clear the heap, removing all elements.
   *
@@ -519,7 +620,7 @@
          }
          
          /* Free the array itself */
-         free(p_heap->pp_data);
+         ALLOC_FREE(p_heap->p_alloc, p_heap->pp_data);
          p_heap->pp_data = NULL;
      }
      
@@ -11,6 +11,7 @@
  
  #include <stdint.h>
  #include <stdbool.h>
+ #include "../0 - Allocator/allocator.h"
  
  /**
   * @brief Typedef for the comparison function used by the heap.
@@ -34,6 +35,7 @@
      uint32_t             size;          /* Number of elements in the array */
      float                growth_factor; /* Factor by which to grow the array when needed */
      heap_compare_func_t  compare_fn;    /* Function used to compare elements */
+     const allocator_t   *p_alloc;       /* Allocator for pp_data (NULL for malloc) */
  } heap_t;
  
  /**
@@ -48,6 +50,21 @@
   */
  bool heap_init(heap_t *p_heap, uint32_t initial_capacity, float growth_factor, heap_compare_func_t compare_fn);
  
+ /**
+  * @brief Initialize a heap whose storage comes from an allocator.
+  *
+  * @param[in,out] p_heap Pointer to the heap to initialize.
+  * @param[in] initial_capacity Initial capacity of the heap.
+  * @param[in] growth_factor Factor by which to grow the heap when needed (1.5f or 2.0f recommended).
+  * @param[in] compare_fn Function used to compare elements.
+  * @param[in] p_alloc Allocator for the heap's storage, NULL for the default.
+  *                    Must outlive the heap.
+  * 
+  * @return true if initialization was successful, false otherwise.
+  */
+ bool heap_init_ex(heap_t *p_heap, uint32_t initial_capacity, float growth_factor, heap_compare_func_t compare_fn,
+                   const allocator_t *p_alloc);
+ 
  /**
   * @brief Insert a new element into the heap.
   *
@@ -135,6 +152,47 @@
   */
  void *heap_remove_at(heap_t *p_heap, uint32_t idx);
  
+ /**
+  * @brief Offer an element to a heap used as a bounded top-k selector.
+  *
+  * The heap keeps the k elements that rank lowest in its order, i.e. the k largest
+  * for a min-heap, with the least of them on top as the bar a new element must beat.
+  * Until the heap holds k elements the element is inserted; after that it is
+  * compared with the top only, and most elements of a long stream stop there.
+  * One that beats the top replaces it in place, without a separate extract and
+  * insert. Reading a stream of n elements costs O(n log k) at worst and O(n)
+  * comparisons when few of them make the cut; initialize the heap with capacity k.
+  * An element equal to the top is dropped, so among equals the earliest are kept.
+  *
+  * @param[in,out] p_heap Pointer to the heap, holding at most k elements.
+  * @param[in] k Number of elements to keep, at least 1.
+  * @param[in] p_data Pointer to the data to offer.
+  * @param[out] pp_dropped Receives the element that left the selection: p_data if
+  *                        it did not make the cut, the former top if p_data
+  *                        replaced it, or NULL. May be NULL.
+  *
+  * @return true if the element was offered, false on invalid parameters or if
+  *         inserting it failed.
+  */
+ bool heap_topk_stream(heap_t *p_heap, uint32_t k, void *p_data, void **pp_dropped);
+ 
+ /**
+  * @brief Merge one top-k heap into another, as when per-thread selections over
+  * parts of the data are combined into the top k of the whole.
+  *
+  * Every element of p_src is offered to p_dest with heap_topk_stream(), and p_src
+  * is left empty. Both heaps must use the same comparison function. Elements that
+  * do not make the cut are dropped; ownership of them stays with the caller.
+  *
+  * @param[in,out] p_dest Pointer to the heap to merge into, holding at most k elements.
+  * @param[in] k Number of elements to keep, at least 1.
+  * @param[in,out] p_src Pointer to the heap to merge from.
+  *
+  * @return true if the heaps were merged, false otherwise. On failure the elements
+  *         not yet merged remain in p_src.
+  */
+ bool heap_topk_merge(heap_t *p_dest, uint32_t k, heap_t *p_src);
+ 
  /**
   * @brief Clear the heap, removing all elements.
   *
@@ -0,0 +1,277 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "heap.h"
+
+#define STREAM_COUNT (2000u)
+#define TOP_K        (25u)
+
+typedef struct
+{
+    uint32_t value;
+    uint32_t seq;
+} record_t;
+
+static record_t g_records[STREAM_COUNT];
+
+// Min-heap order on value alone, so the heap keeps the largest values and
+// records with equal values are ties
+static int32_t
+record_compare(const void * p_data1, const void * p_data2)
+{
+    const record_t * p_rec1 = p_data1;
+    const record_t * p_rec2 = p_data2;
+
+    return (p_rec1->value > p_rec2->value) - (p_rec1->value < p_rec2->value);
+}
+
+// Largest value first, then earliest first among ties
+static int
+qsort_rank(const void * p_data1, const void * p_data2)
+{
+    const record_t * p_rec1 = p_data1;
+    const record_t * p_rec2 = p_data2;
+
+    if (p_rec1->value != p_rec2->value)
+    {
+        return (p_rec1->value < p_rec2->value) ? 1 : -1;
+    }
+
+    return (p_rec1->seq > p_rec2->seq) - (p_rec1->seq < p_rec2->seq);
+}
+
+// Values repeat often so that the cut falls among ties
+static void
+fill_records(void)
+{
+    uint64_t state = 88172645463325252ull;
+
+    for (uint32_t idx = 0; idx < STREAM_COUNT; idx++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        g_records[idx].value = (uint32_t)(state % 50u);
+        g_records[idx].seq   = idx;
+    }
+}
+
+// Checks the heap holds exactly the expected records, in any order
+static void
+assert_holds(const heap_t * p_heap, const record_t * p_expected, uint32_t count)
+{
+    ck_assert_uint_eq(heap_size(p_heap), count);
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        bool b_found = false;
+
+        for (uint32_t pos = 0; pos < p_heap->size; pos++)
+        {
+            const record_t * p_rec = p_heap->pp_data[pos];
+            if ((p_rec->value == p_expected[idx].value)
+                && (p_rec->seq == p_expected[idx].seq))
+            {
+                b_found = true;
+            }
+        }
+
+        ck_assert(b_found);
+    }
+}
+
+START_TEST(test_topk_keeps_earliest_ties)
+{
+    heap_t   heap;
+    record_t equal[5] = { { 5, 0 }, { 5, 1 }, { 5, 2 }, { 5, 3 }, { 5, 4 } };
+    record_t big      = { 9, 5 };
+    void *   p_dropped;
+
+    ck_assert(heap_init(&heap, 3, 2.0f, record_compare));
+
+    for (uint32_t idx = 0; idx < 3; idx++)
+    {
+        ck_assert(heap_topk_stream(&heap, 3, &equal[idx], &p_dropped));
+        ck_assert_ptr_null(p_dropped);
+    }
+
+    // An element equal to the top is dropped, so the earliest equals stay
+    ck_assert(heap_topk_stream(&heap, 3, &equal[3], &p_dropped));
+    ck_assert_ptr_eq(p_dropped, &equal[3]);
+    assert_holds(&heap, equal, 3);
+
+    // One that beats the top pushes out a single former top
+    ck_assert(heap_topk_stream(&heap, 3, &big, &p_dropped));
+    ck_assert_ptr_nonnull(p_dropped);
+    ck_assert_uint_eq(((record_t *)p_dropped)->value, 5);
+    ck_assert_uint_eq(heap_size(&heap), 3);
+    ck_assert_uint_eq(((record_t *)heap_peek_top(&heap))->value, 5);
+
+    ck_assert(heap_topk_stream(&heap, 3, &equal[4], &p_dropped));
+    ck_assert_ptr_eq(p_dropped, &equal[4]);
+
+    // Invalid parameters are refused
+    ck_assert(!heap_topk_stream(&heap, 0, &big, NULL));
+    ck_assert(!heap_topk_stream(&heap, 3, NULL, NULL));
+    ck_assert(!heap_topk_stream(&heap, 2, &big, NULL));
+
+    heap_destroy(&heap, false);
+}
+END_TEST
+
+START_TEST(test_topk_stream_matches_sort)
+{
+    heap_t    heap;
+    record_t * p_ranked = malloc(STREAM_COUNT * sizeof(record_t));
+
+    ck_assert_ptr_nonnull(p_ranked);
+    ck_assert(heap_init(&heap, TOP_K, 2.0f, record_compare));
+    fill_records();
+
+    for (uint32_t idx = 0; idx < STREAM_COUNT; idx++)
+    {
+        ck_assert(heap_topk_stream(&heap, TOP_K, &g_records[idx], NULL));
+        ck_assert_uint_le(heap_size(&heap), TOP_K);
+    }
+
+    // The heap holds the top k with ties at the cut going to the earliest
+    memcpy(p_ranked, g_records, STREAM_COUNT * sizeof(record_t));
+    qsort(p_ranked, STREAM_COUNT, sizeof(record_t), qsort_rank);
+    ck_assert_uint_eq(p_ranked[TOP_K - 1].value, p_ranked[TOP_K].value);
+    assert_holds(&heap, p_ranked, TOP_K);
+
+    // Extracting yields them least first
+    uint32_t last = 0;
+    while (!heap_is_empty(&heap))
+    {
+        const record_t * p_rec = heap_extract_top(&heap);
+        ck_assert_uint_ge(p_rec->value, last);
+        last = p_rec->value;
+    }
+
+    free(p_ranked);
+    heap_destroy(&heap, false);
+}
+END_TEST
+
+START_TEST(test_topk_merge_matches_whole)
+{
+    heap_t    parts[4];
+    record_t * p_ranked = malloc(STREAM_COUNT * sizeof(record_t));
+
+    ck_assert_ptr_nonnull(p_ranked);
+    fill_records();
+
+    // Each part selects over an interleaved quarter of the stream
+    for (uint32_t part = 0; part < 4; part++)
+    {
+        ck_assert(heap_init(&parts[part], TOP_K, 2.0f, record_compare));
+    }
+    for (uint32_t idx = 0; idx < STREAM_COUNT; idx++)
+    {
+        ck_assert(heap_topk_stream(&parts[idx % 4], TOP_K, &g_records[idx],
+                                   NULL));
+    }
+
+    for (uint32_t part = 1; part < 4; part++)
+    {
+        ck_assert(heap_topk_merge(&parts[0], TOP_K, &parts[part]));
+        ck_assert(heap_is_empty(&parts[part]));
+        ck_assert_uint_le(heap_size(&parts[0]), TOP_K);
+    }
+
+    // The values match the top k of the whole stream; which of the tied
+    // records at the cut survive depends on the merge order
+    memcpy(p_ranked, g_records, STREAM_COUNT * sizeof(record_t));
+    qsort(p_ranked, STREAM_COUNT, sizeof(record_t), qsort_rank);
+
+    uint32_t expected[50] = { 0 };
+    uint32_t actual[50]   = { 0 };
+    for (uint32_t idx = 0; idx < TOP_K; idx++)
+    {
+        expected[p_ranked[idx].value]++;
+        actual[((const record_t *)parts[0].pp_data[idx])->value]++;
+    }
+    for (uint32_t value = 0; value < 50; value++)
+    {
+        ck_assert_uint_eq(actual[value], expected[value]);
+    }
+
+    // A merge into itself is refused
+    ck_assert(!heap_topk_merge(&parts[0], TOP_K, &parts[0]));
+
+    free(p_ranked);
+    for (uint32_t part = 0; part < 4; part++)
+    {
+        heap_destroy(&parts[part], false);
+    }
+}
+END_TEST
+
+START_TEST(test_topk_merge_keeps_destination_ties)
+{
+    heap_t   dest;
+    heap_t   src;
+    record_t kept[2]  = { { 4, 0 }, { 4, 1 } };
+    record_t other[2] = { { 4, 2 }, { 3, 3 } };
+
+    ck_assert(heap_init(&dest, 2, 2.0f, record_compare));
+    ck_assert(heap_init(&src, 2, 2.0f, record_compare));
+
+    ck_assert(heap_topk_stream(&dest, 2, &kept[0], NULL));
+    ck_assert(heap_topk_stream(&dest, 2, &kept[1], NULL));
+    ck_assert(heap_topk_stream(&src, 2, &other[0], NULL));
+    ck_assert(heap_topk_stream(&src, 2, &other[1], NULL));
+
+    // Source elements only tie the destination top, so none get in
+    ck_assert(heap_topk_merge(&dest, 2, &src));
+    ck_assert(heap_is_empty(&src));
+    assert_holds(&dest, kept, 2);
+
+    heap_destroy(&dest, false);
+    heap_destroy(&src, false);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+heap_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Heap");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_topk_keeps_earliest_ties);
+    tcase_add_test(tc_core, test_topk_stream_matches_sort);
+    tcase_add_test(tc_core, test_topk_merge_matches_whole);
+    tcase_add_test(tc_core, test_topk_merge_keeps_destination_ties);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = heap_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
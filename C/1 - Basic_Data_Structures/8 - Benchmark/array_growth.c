@@ -0,0 +1,285 @@
+/** @file array_growth.c
+ *
+ * @brief Growing a huge dynamic_array_t: realloc() against the mapped
+ *        allocator.
+ *
+ * For each target size the array is grown one dynamic_array_add() at a
+ * time from 1024 elements until its storage reaches the target, once per
+ * allocator:
+ *
+ * - realloc:  the default allocator;
+ * - mremap:   alloc_mapped_t, each growth remapping the block;
+ * - reserved: alloc_mapped_t reserving the array's final capacity up
+ *             front, so the block is never remapped;
+ * - thp:      as reserved, with transparent huge pages advised;
+ * - file:     as mremap, backed by a file in the backing directory.
+ *
+ * Each run happens in a child process of its own, so that its peak
+ * resident set (VmHWM) is its own. Reported are the total time, the
+ * longest single add (which is always one that grew the array), the peak
+ * resident set, and for the mapped allocator how the growths were done.
+ * glibc's realloc() itself uses mremap() for blocks it got from mmap(),
+ * so on glibc the realloc column shows what the remaps cost rather than
+ * copies. dynamic_array_t holds at most UINT32_MAX elements, 32 GiB of
+ * pointers on a 64-bit machine; larger targets are skipped.
+ *
+ * Build: make growth (see Makefile)
+ *
+ * Usage: array_growth [backing directory] [GiB ...]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "alloc_mapped.h"
+#include "dynamic_array.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_DIR        ("/tmp")
+#define INITIAL_CAPACITY   (1024u)
+#define GROWTH_FACTOR      (1.5f)
+#define GIB                (1024.0 * 1024.0 * 1024.0)
+#define NSEC_PER_SEC       (1000000000ull)
+#define STATUS_LINE        (256u)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef enum
+{
+    MODE_REALLOC,
+    MODE_MREMAP,
+    MODE_RESERVED,
+    MODE_THP,
+    MODE_FILE,
+    MODE_COUNT
+} growth_mode_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const char * const g_mode_names[MODE_COUNT] = {
+    "realloc", "mremap", "reserved", "thp", "file"
+};
+
+/* Sizes in GiB when none are given */
+static const double g_default_gib[] = { 1.0, 2.0, 4.0 };
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static int      grow(growth_mode_t mode, uint64_t elements, const char * p_dir);
+static uint64_t now_ns(void);
+static uint64_t peak_rss_kib(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    const char * p_dir = (argc > 1) ? argv[1] : DEFAULT_DIR;
+    int          first = 2;
+    int          last  = argc;
+
+    printf("%8s  %-8s %9s %11s %10s  %s\n", "GiB", "mode", "total s",
+           "worst ms", "peak MiB", "growths");
+
+    if (argc <= 2)
+    {
+        first = 0;
+        last  = (int)(sizeof(g_default_gib) / sizeof(g_default_gib[0]));
+    }
+
+    for (int arg = first; arg < last; arg++)
+    {
+        double   gib      = (argc <= 2) ? g_default_gib[arg]
+                                        : strtod(argv[arg], NULL);
+        uint64_t elements = (uint64_t)(gib * GIB) / sizeof(void *);
+
+        if ((elements <= INITIAL_CAPACITY) || (elements > UINT32_MAX))
+        {
+            printf("%8.2f  skipped: outside 8 KiB to 32 GiB of pointers\n",
+                   gib);
+            continue;
+        }
+
+        for (int mode = 0; mode < (int)MODE_COUNT; mode++)
+        {
+            fflush(stdout);
+            pid_t child = fork();
+
+            if (0 == child)
+            {
+                exit(grow((growth_mode_t)mode, elements, p_dir));
+            }
+
+            int status = 0;
+
+            if ((child < 0) || (waitpid(child, &status, 0) != child)
+                || !WIFEXITED(status) || (EXIT_SUCCESS != WEXITSTATUS(status)))
+            {
+                printf("%8.2f  %-8s failed\n", gib, g_mode_names[mode]);
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Grows one array to elements and prints its line; run in a child.
+ *
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the array could not be grown
+ *         or lost its contents
+ */
+static int
+grow(growth_mode_t mode, uint64_t elements, const char * p_dir)
+{
+    alloc_mapped_config_t config   = { 0u, NULL, false, false };
+    alloc_mapped_t *      p_mapped = NULL;
+    dynamic_array_t       array;
+
+    // The capacity the array ends at, past elements by the last growth
+    uint64_t capacity = INITIAL_CAPACITY;
+
+    while (capacity < elements)
+    {
+        capacity = (uint64_t)((double)capacity * GROWTH_FACTOR);
+    }
+
+    if (MODE_REALLOC != mode)
+    {
+        config.reserve_bytes = ((MODE_RESERVED == mode) || (MODE_THP == mode))
+                                   ? (size_t)capacity * sizeof(void *)
+                                   : 0u;
+        config.p_backing_dir = (MODE_FILE == mode) ? p_dir : NULL;
+        config.b_huge_pages  = (MODE_THP == mode);
+        p_mapped             = alloc_mapped_create(&config);
+
+        if (NULL == p_mapped)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!dynamic_array_init_ex(&array, INITIAL_CAPACITY, GROWTH_FACTOR,
+                               alloc_mapped_allocator(p_mapped)))
+    {
+        alloc_mapped_destroy(&p_mapped);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t worst_ns = 0u;
+    uint64_t start_ns = now_ns();
+
+    for (uint64_t idx = 0; idx < elements; idx++)
+    {
+        // Only an add that grows the array can stall; time just those
+        bool     b_grows = (array.size == array.capacity);
+        uint64_t add_ns  = b_grows ? now_ns() : 0u;
+
+        if (!dynamic_array_add(&array, (void *)(uintptr_t)(idx + 1u)))
+        {
+            return EXIT_FAILURE;
+        }
+
+        if (b_grows)
+        {
+            add_ns   = now_ns() - add_ns;
+            worst_ns = (add_ns > worst_ns) ? add_ns : worst_ns;
+        }
+    }
+
+    uint64_t total_ns = now_ns() - start_ns;
+
+    // Every growth must have kept the contents
+    for (uint64_t idx = 0; idx < elements; idx++)
+    {
+        if (array.pp_data[idx] != (void *)(uintptr_t)(idx + 1u))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    alloc_mapped_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    alloc_mapped_stats(p_mapped, &stats);
+
+    printf("%8.2f  %-8s %9.2f %11.2f %10.0f  ",
+           (double)elements * sizeof(void *) / GIB, g_mode_names[mode],
+           (double)total_ns / NSEC_PER_SEC, (double)worst_ns / 1e6,
+           (double)peak_rss_kib() / 1024.0);
+
+    if (NULL == p_mapped)
+    {
+        printf("-\n");
+    }
+    else
+    {
+        printf("%llu in place, %llu remapped, %llu copied\n",
+               (unsigned long long)stats.grows_reserved,
+               (unsigned long long)stats.grows_remapped,
+               (unsigned long long)stats.grows_copied);
+    }
+
+    dynamic_array_destroy(&array, false);
+    alloc_mapped_destroy(&p_mapped);
+
+    return EXIT_SUCCESS;
+}
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+/* The process's peak resident set; 0 where /proc is not available */
+static uint64_t
+peak_rss_kib(void)
+{
+    char     line[STATUS_LINE];
+    uint64_t peak     = 0u;
+    FILE *   p_status = fopen("/proc/self/status", "r");
+
+    if (NULL == p_status)
+    {
+        return 0u;
+    }
+
+    while (NULL != fgets(line, sizeof(line), p_status))
+    {
+        if (0 == strncmp(line, "VmHWM:", 6))
+        {
+            peak = strtoull(line + 6, NULL, 10);
+            break;
+        }
+    }
+
+    fclose(p_status);
+    return peak;
+}
+
+/*** end of file ***/
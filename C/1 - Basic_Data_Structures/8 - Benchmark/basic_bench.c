@@ -0,0 +1,2245 @@
+/** @file basic_bench.c
+ *
+ * @brief Standard workloads for every container in Basic_Data_Structures.
+ *
+ * Each container is measured with three workloads, each at n = min_n,
+ * 10 * min_n, ... up to max_n, so the report shows how the cost of an
+ * operation scales with the container's size:
+ *
+ * - sequential: fill in key order, then read or drain in the same order;
+ * - random:     operations on random positions or keys of a filled
+ *               container (for a stack or queue, a random interleaving of
+ *               pushes and pops);
+ * - mixed:      a random stream of reads, writes, inserts and removals on
+ *               a half-full container.
+ *
+ * Containers hold pointers to a 2n-entry key array where keys[i] == i, so
+ * nothing is allocated for values inside a timed run. Only the containers
+ * allocate through the allocator the harness passes to setup, so the
+ * memory figures leave out the key arrays. A few workloads are
+ * quadratic by design (sequential inserts into the unbalanced BST, random
+ * access into the linked list) and stop at a smaller n. The queue refuses
+ * more than 100 items, so its workloads keep at most that many queued and
+ * n counts operations rather than occupancy.
+ *
+ * linked_list also runs a sort workload, sorting a shuffled list in place,
+ * and a batch workload, moving a filled list to another LIST_BATCH nodes
+ * at a time with split_at and concat; batch_copy does the same move
+ * element by element with remove_first and append, as callers had to
+ * before.
+ *
+ * hash_table and hash_dict, the chained and the compact layouts, also run
+ * an iterate workload, a full pass over a filled table, and a clear
+ * workload, emptying one.
+ *
+ * The ring_stack and ring_queue cases run the stack and queue workloads
+ * on stack_t and queue_t set up over a ring-buffer deque_t, allocating
+ * nothing per element; deque runs workloads of its own, using both ends.
+ *
+ * The intrusive_* cases run the stack, queue, tree and heap workloads on
+ * the containers in 9 - Intrusive, with the links embedded in the items,
+ * for a direct comparison with the node-allocating versions.
+ *
+ * Build: make bench (see Makefile)
+ *
+ * Usage: basic_bench [-f json|csv] [-o file] [-r reps] [-w warmup]
+ *                    [-c cpu] [-s seed] [-m min_n] [-n max_n] [-k filter]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "binary_search_tree.h"
+#include "deque.h"
+#include "dynamic_array.h"
+#include "hash_dict.h"
+#include "hash_table.h"
+#include "heap.h"
+#include "intrusive.h"
+#include "linked_list.h"
+#include "queue.h"
+#include "stack.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_MIN_N      (1000u)
+#define DEFAULT_MAX_N      (1000000u)
+#define SIZE_STEP          (10u)
+
+#define QUEUE_WINDOW       (100u)    /* queue.c's MAX_QUEUE_SIZE */
+#define LIST_RANDOM_OPS    (1000u)   /* get_at() calls per random list run */
+#define LIST_RANDOM_MAX_N  (100000u)
+#define LIST_BATCH         (1000u)   /* Nodes per batch moved */
+#define BST_SORTED_MAX_N   (10000u)  /* Sorted inserts build a linked chain */
+
+#define PERCENT            (100u)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Element of the intrusive containers, one hook per container */
+typedef struct
+{
+    uint32_t    key;
+    list_hook_t link;
+    bst_hook_t  node;
+    heap_hook_t slot;
+} item_t;
+
+/* State for one run of any workload */
+typedef struct
+{
+    uint32_t   n;
+    uint32_t * p_keys;  /* 2n keys, keys[i] == i */
+    uint32_t * p_order; /* n entries: a permutation or random values */
+    item_t *   p_items; /* 2n items for the intrusive containers, or NULL */
+    uint64_t   seed;
+    uint64_t   sink;    /* Folds in what the run read */
+    union
+    {
+        dynamic_array_t array;
+        linked_list_t   list;
+        stack_t         stack;
+        queue_t *       p_queue;
+        deque_t         deque;
+        hash_table_t    table;
+        hash_dict_t     dict;
+        bst_t           tree;
+        heap_t          heap;
+        ilist_t         ilist;
+        ibst_t          itree;
+        iheap_t         iheap;
+    } box;
+} state_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+/* Keeps the results of reads alive */
+static volatile uint64_t g_sink;
+
+/*************************************************************************
+ * Static Functions: shared state
+ *************************************************************************/
+
+/*!
+ * @brief Allocates the keys and a shuffled permutation of 0 .. n-1.
+ *
+ * @return State, or NULL on failure
+ */
+static state_t *
+state_create(uint32_t n, uint64_t seed)
+{
+    state_t * p_state = calloc(1, sizeof(state_t));
+    size_t    count   = (0 == n) ? 1 : n;
+
+    if (NULL == p_state)
+    {
+        return NULL;
+    }
+
+    p_state->n       = n;
+    p_state->seed    = seed;
+    p_state->p_keys  = malloc(2 * count * sizeof(uint32_t));
+    p_state->p_order = malloc(count * sizeof(uint32_t));
+    if ((NULL == p_state->p_keys) || (NULL == p_state->p_order))
+    {
+        free(p_state->p_keys);
+        free(p_state->p_order);
+        free(p_state);
+        return NULL;
+    }
+
+    for (uint32_t idx = 0; idx < (2 * count); idx++)
+    {
+        p_state->p_keys[idx] = idx;
+    }
+    for (uint32_t idx = 0; idx < n; idx++)
+    {
+        p_state->p_order[idx] = idx;
+    }
+    for (uint32_t idx = n; idx > 1; idx--)
+    {
+        uint32_t pick = (uint32_t)(bench_random(&p_state->seed) % idx);
+        uint32_t temp = p_state->p_order[idx - 1];
+
+        p_state->p_order[idx - 1] = p_state->p_order[pick];
+        p_state->p_order[pick]    = temp;
+    }
+
+    return p_state;
+}
+
+/*!
+ * @brief Replaces the permutation with n random 32-bit values.
+ */
+static void
+state_randomise(state_t * p_state)
+{
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->p_order[idx] = (uint32_t)bench_random(&p_state->seed);
+    }
+}
+
+static void
+state_destroy(state_t * p_state)
+{
+    g_sink += p_state->sink;
+    free(p_state->p_items);
+    free(p_state->p_keys);
+    free(p_state->p_order);
+    free(p_state);
+}
+
+static uint32_t
+key_of(const void * p_data)
+{
+    return (NULL == p_data) ? 0 : *(const uint32_t *)p_data;
+}
+
+static int32_t
+compare_keys(const void * p_lhs, const void * p_rhs)
+{
+    uint32_t lhs = key_of(p_lhs);
+    uint32_t rhs = key_of(p_rhs);
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/*************************************************************************
+ * Static Functions: dynamic_array
+ *************************************************************************/
+
+static void *
+array_setup(uint32_t            n,
+            uint64_t            seed,
+            uint32_t            fill,
+            const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if ((NULL != p_state)
+        && !dynamic_array_init_ex(&p_state->box.array, 0, 0.0f, p_alloc))
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        dynamic_array_add(&p_state->box.array,
+                          &p_state->p_keys[p_state->p_order[idx]]);
+    }
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+
+    return p_state;
+}
+
+static void *
+array_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return array_setup(n, seed, 0, p_alloc);
+}
+
+static void *
+array_setup_full(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return array_setup(n, seed, n, p_alloc);
+}
+
+static void *
+array_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return array_setup(n, seed, n / 2, p_alloc);
+}
+
+static void
+array_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    dynamic_array_destroy(&p_state->box.array, false);
+    state_destroy(p_state);
+}
+
+static uint64_t
+array_sequential(void * p_arg)
+{
+    state_t *         p_state = p_arg;
+    dynamic_array_t * p_array = &p_state->box.array;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        dynamic_array_add(p_array, &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(dynamic_array_get_at(p_array, idx));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+static uint64_t
+array_random(void * p_arg)
+{
+    state_t *         p_state = p_arg;
+    dynamic_array_t * p_array = &p_state->box.array;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t position = p_state->p_order[idx] % p_state->n;
+        p_state->sink += key_of(dynamic_array_get_at(p_array, position));
+    }
+
+    return p_state->n;
+}
+
+/* 50% get, 20% set, 15% add, 15% remove the last element */
+static uint64_t
+array_mixed(void * p_arg)
+{
+    state_t *         p_state = p_arg;
+    dynamic_array_t * p_array = &p_state->box.array;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t value    = p_state->p_order[idx];
+        uint32_t op       = value % PERCENT;
+        uint32_t size     = dynamic_array_size(p_array);
+        uint32_t position = (0 == size) ? 0 : ((value / PERCENT) % size);
+        void *   p_key    = &p_state->p_keys[position];
+
+        if ((op >= 85) && (size > 0))
+        {
+            p_state->sink += key_of(
+                dynamic_array_remove_at(p_array, size - 1));
+        }
+        else if ((op >= 70) || (0 == size))
+        {
+            dynamic_array_add(p_array, p_key);
+        }
+        else if (op >= 50)
+        {
+            p_state->sink += key_of(
+                dynamic_array_set_at(p_array, position, p_key));
+        }
+        else
+        {
+            p_state->sink += key_of(dynamic_array_get_at(p_array, position));
+        }
+    }
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: linked_list
+ *************************************************************************/
+
+static void *
+list_setup(uint32_t            n,
+           uint64_t            seed,
+           uint32_t            fill,
+           const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if ((NULL != p_state) && !linked_list_init_ex(&p_state->box.list, p_alloc))
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        linked_list_append(&p_state->box.list,
+                           &p_state->p_keys[p_state->p_order[idx]]);
+    }
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+
+    return p_state;
+}
+
+static void *
+list_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return list_setup(n, seed, 0, p_alloc);
+}
+
+static void *
+list_setup_full(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return list_setup(n, seed, n, p_alloc);
+}
+
+static void *
+list_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return list_setup(n, seed, n / 2, p_alloc);
+}
+
+static void
+list_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    linked_list_destroy(&p_state->box.list, false);
+    state_destroy(p_state);
+}
+
+static uint64_t
+list_sequential(void * p_arg)
+{
+    state_t *       p_state = p_arg;
+    linked_list_t * p_list  = &p_state->box.list;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        linked_list_append(p_list, &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(linked_list_remove_first(p_list));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* get_at() walks from the head, so each call costs O(n) */
+static uint64_t
+list_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    uint32_t  ops     = (p_state->n < LIST_RANDOM_OPS) ? p_state->n
+                                                       : LIST_RANDOM_OPS;
+
+    for (uint32_t idx = 0; idx < ops; idx++)
+    {
+        uint32_t position = p_state->p_order[idx] % p_state->n;
+        p_state->sink
+            += key_of(linked_list_get_at(&p_state->box.list, position));
+    }
+
+    return ops;
+}
+
+/* 40% append, 15% prepend, 45% remove the first element */
+static uint64_t
+list_mixed(void * p_arg)
+{
+    state_t *       p_state = p_arg;
+    linked_list_t * p_list  = &p_state->box.list;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t value = p_state->p_order[idx];
+        uint32_t op    = value % PERCENT;
+        void *   p_key = &p_state->p_keys[(value / PERCENT) % p_state->n];
+
+        if ((op >= 55) && !linked_list_is_empty(p_list))
+        {
+            p_state->sink += key_of(linked_list_remove_first(p_list));
+        }
+        else if (op >= 40)
+        {
+            linked_list_prepend(p_list, p_key);
+        }
+        else
+        {
+            linked_list_append(p_list, p_key);
+        }
+    }
+
+    return p_state->n;
+}
+
+static uint64_t
+list_sort(void * p_arg)
+{
+    state_t * p_state = p_arg;
+
+    linked_list_sort(&p_state->box.list, compare_keys);
+    p_state->sink += key_of(linked_list_get_at(&p_state->box.list, 0));
+
+    return p_state->n;
+}
+
+/* Relinks each batch as a whole; nothing is allocated or freed */
+static uint64_t
+list_batch(void * p_arg)
+{
+    state_t *       p_state = p_arg;
+    linked_list_t * p_list  = &p_state->box.list;
+    linked_list_t   rest;
+    linked_list_t   moved;
+
+    linked_list_init_ex(&rest, p_list->p_alloc);
+    linked_list_init_ex(&moved, p_list->p_alloc);
+
+    while (!linked_list_is_empty(p_list))
+    {
+        uint32_t batch = (p_list->size < LIST_BATCH) ? p_list->size
+                                                     : LIST_BATCH;
+
+        linked_list_split_at(p_list, batch, &rest);
+        linked_list_concat(&moved, p_list);
+        linked_list_concat(p_list, &rest);
+    }
+
+    linked_list_concat(p_list, &moved);
+    p_state->sink += key_of(linked_list_get_at(p_list, 0));
+
+    return p_state->n;
+}
+
+/* The same move one element at a time, freeing and allocating every node */
+static uint64_t
+list_batch_copy(void * p_arg)
+{
+    state_t *       p_state = p_arg;
+    linked_list_t * p_list  = &p_state->box.list;
+    linked_list_t   moved;
+
+    linked_list_init_ex(&moved, p_list->p_alloc);
+
+    while (!linked_list_is_empty(p_list))
+    {
+        linked_list_append(&moved, linked_list_remove_first(p_list));
+    }
+
+    linked_list_concat(p_list, &moved);
+    p_state->sink += key_of(linked_list_get_at(p_list, 0));
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: stack
+ *************************************************************************/
+
+static void *
+stack_setup(uint32_t            n,
+            uint64_t            seed,
+            uint32_t            fill,
+            bool                b_ring,
+            const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+    bool      b_init  = false;
+
+    if (NULL != p_state)
+    {
+        b_init = b_ring ? stack_init_ring(&p_state->box.stack, 0, p_alloc)
+                        : stack_init_ex(&p_state->box.stack, p_alloc);
+    }
+    if ((NULL != p_state) && !b_init)
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        stack_push(&p_state->box.stack, &p_state->p_keys[idx]);
+    }
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+
+    return p_state;
+}
+
+static void *
+stack_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return stack_setup(n, seed, 0, false, p_alloc);
+}
+
+static void *
+stack_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return stack_setup(n, seed, n / 2, false, p_alloc);
+}
+
+static void *
+ring_stack_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return stack_setup(n, seed, 0, true, p_alloc);
+}
+
+static void *
+ring_stack_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return stack_setup(n, seed, n / 2, true, p_alloc);
+}
+
+static void
+stack_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    stack_destroy(&p_state->box.stack, false);
+    state_destroy(p_state);
+}
+
+static uint64_t
+stack_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    stack_t * p_stack = &p_state->box.stack;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        stack_push(p_stack, &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(stack_pop(p_stack));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Push or pop on a coin flip */
+static uint64_t
+stack_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    stack_t * p_stack = &p_state->box.stack;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        if ((0 != (p_state->p_order[idx] & 1u)) || stack_is_empty(p_stack))
+        {
+            stack_push(p_stack, &p_state->p_keys[idx]);
+        }
+        else
+        {
+            p_state->sink += key_of(stack_pop(p_stack));
+        }
+    }
+
+    return p_state->n;
+}
+
+/* 45% push, 40% pop, 15% peek */
+static uint64_t
+stack_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    stack_t * p_stack = &p_state->box.stack;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t op = p_state->p_order[idx] % PERCENT;
+
+        if ((op < 45) || stack_is_empty(p_stack))
+        {
+            stack_push(p_stack, &p_state->p_keys[idx]);
+        }
+        else if (op < 85)
+        {
+            p_state->sink += key_of(stack_pop(p_stack));
+        }
+        else
+        {
+            p_state->sink += key_of(stack_peek(p_stack));
+        }
+    }
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: queue
+ *************************************************************************/
+
+static void *
+queue_setup(uint32_t            n,
+            uint64_t            seed,
+            uint32_t            fill,
+            bool                b_ring,
+            const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if (NULL == p_state)
+    {
+        return NULL;
+    }
+
+    p_state->box.p_queue = b_ring ? queue_create_ring(0, p_alloc)
+                                  : queue_create_ex(p_alloc);
+    if (NULL == p_state->box.p_queue)
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; idx < fill; idx++)
+    {
+        queue_enqueue(p_state->box.p_queue, &p_state->p_keys[idx]);
+    }
+    state_randomise(p_state);
+
+    return p_state;
+}
+
+static void *
+queue_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return queue_setup(n, seed, 0, false, p_alloc);
+}
+
+static void *
+queue_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return queue_setup(n, seed, QUEUE_WINDOW / 2, false, p_alloc);
+}
+
+static void *
+ring_queue_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return queue_setup(n, seed, 0, true, p_alloc);
+}
+
+static void *
+ring_queue_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return queue_setup(n, seed, QUEUE_WINDOW / 2, true, p_alloc);
+}
+
+static void
+queue_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    queue_destroy(&p_state->box.p_queue);
+    state_destroy(p_state);
+}
+
+/* Fill the window, drain it, repeat until n items have passed through */
+static uint64_t
+queue_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    queue_t * p_queue = p_state->box.p_queue;
+    void *    p_item  = NULL;
+
+    for (uint32_t done = 0; done < p_state->n; done += QUEUE_WINDOW)
+    {
+        uint32_t batch = p_state->n - done;
+        batch          = (batch < QUEUE_WINDOW) ? batch : QUEUE_WINDOW;
+
+        for (uint32_t idx = 0; idx < batch; idx++)
+        {
+            queue_enqueue(p_queue, &p_state->p_keys[done + idx]);
+        }
+        for (uint32_t idx = 0; idx < batch; idx++)
+        {
+            queue_dequeue(p_queue, &p_item);
+            p_state->sink += key_of(p_item);
+        }
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Enqueue or dequeue on a coin flip, within the window */
+static uint64_t
+queue_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    queue_t * p_queue = p_state->box.p_queue;
+    uint32_t  queued  = 0;
+    void *    p_item  = NULL;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        bool b_enqueue = (0 != (p_state->p_order[idx] & 1u));
+
+        if ((0 == queued) || (b_enqueue && (queued < QUEUE_WINDOW)))
+        {
+            queue_enqueue(p_queue, &p_state->p_keys[idx]);
+            queued++;
+        }
+        else
+        {
+            queue_dequeue(p_queue, &p_item);
+            p_state->sink += key_of(p_item);
+            queued--;
+        }
+    }
+
+    return p_state->n;
+}
+
+/* 45% enqueue, 45% dequeue, 10% size queries */
+static uint64_t
+queue_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    queue_t * p_queue = p_state->box.p_queue;
+    void *    p_item  = NULL;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t op = p_state->p_order[idx] % PERCENT;
+
+        if (op >= 90)
+        {
+            p_state->sink += (uint64_t)queue_size(p_queue)
+                             + (queue_is_empty(p_queue) ? 1u : 0u);
+        }
+        else if ((op < 45) && queue_enqueue(p_queue, &p_state->p_keys[idx]))
+        {
+            continue;
+        }
+        else if (queue_dequeue(p_queue, &p_item))
+        {
+            p_state->sink += key_of(p_item);
+        }
+        else
+        {
+            queue_enqueue(p_queue, &p_state->p_keys[idx]);
+        }
+    }
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: deque
+ *************************************************************************/
+
+static void *
+deque_setup(uint32_t            n,
+            uint64_t            seed,
+            uint32_t            fill,
+            const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if ((NULL != p_state) && !deque_init_ex(&p_state->box.deque, 0, p_alloc))
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        deque_push_back(&p_state->box.deque, &p_state->p_keys[idx]);
+    }
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+
+    return p_state;
+}
+
+static void *
+deque_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return deque_setup(n, seed, 0, p_alloc);
+}
+
+static void *
+deque_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return deque_setup(n, seed, n / 2, p_alloc);
+}
+
+static void
+deque_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    deque_destroy(&p_state->box.deque, false);
+    state_destroy(p_state);
+}
+
+/* Fill at the back and drain from the front: a FIFO of all n, unbounded */
+static uint64_t
+deque_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    deque_t * p_deque = &p_state->box.deque;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        deque_push_back(p_deque, &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(deque_pop_front(p_deque));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* A work queue: push at the back, and pop at the back (LIFO, the owner)
+   or at the front (FIFO, a thief) on coin flips */
+static uint64_t
+deque_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    deque_t * p_deque = &p_state->box.deque;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t bits = p_state->p_order[idx];
+
+        if ((0 != (bits & 1u)) || deque_is_empty(p_deque))
+        {
+            deque_push_back(p_deque, &p_state->p_keys[idx]);
+        }
+        else if (0 != (bits & 2u))
+        {
+            p_state->sink += key_of(deque_pop_back(p_deque));
+        }
+        else
+        {
+            p_state->sink += key_of(deque_pop_front(p_deque));
+        }
+    }
+
+    return p_state->n;
+}
+
+/* 20% push at either end, 20% pop at either end, 60% indexed reads */
+static uint64_t
+deque_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    deque_t * p_deque = &p_state->box.deque;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t op = p_state->p_order[idx] % PERCENT;
+
+        if ((op < 10) || deque_is_empty(p_deque))
+        {
+            deque_push_front(p_deque, &p_state->p_keys[idx]);
+        }
+        else if (op < 20)
+        {
+            deque_push_back(p_deque, &p_state->p_keys[idx]);
+        }
+        else if (op < 30)
+        {
+            p_state->sink += key_of(deque_pop_front(p_deque));
+        }
+        else if (op < 40)
+        {
+            p_state->sink += key_of(deque_pop_back(p_deque));
+        }
+        else
+        {
+            uint32_t position = (p_state->p_order[idx] / PERCENT)
+                                % deque_size(p_deque);
+
+            p_state->sink += key_of(deque_get_at(p_deque, position));
+        }
+    }
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: hash_table
+ *************************************************************************/
+
+static uint32_t
+hash_key(const void * p_key, uint32_t capacity)
+{
+    uint32_t hash = key_of(p_key) * 0x9e3779b1u;
+    return (hash ^ (hash >> 16)) % capacity;
+}
+
+static bool
+keys_equal(const void * p_lhs, const void * p_rhs)
+{
+    return key_of(p_lhs) == key_of(p_rhs);
+}
+
+static void *
+table_setup(uint32_t            n,
+            uint64_t            seed,
+            uint32_t            fill,
+            const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if ((NULL != p_state)
+        && !hash_table_init_ex(&p_state->box.table, 0, 0.75f, hash_key,
+                               keys_equal, NULL, NULL, p_alloc))
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        uint32_t * p_key = &p_state->p_keys[p_state->p_order[idx]];
+        hash_table_put(&p_state->box.table, p_key, p_key);
+    }
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+
+    return p_state;
+}
+
+static void *
+table_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return table_setup(n, seed, 0, p_alloc);
+}
+
+static void *
+table_setup_full(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return table_setup(n, seed, n, p_alloc);
+}
+
+static void *
+table_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return table_setup(n, seed, n / 2, p_alloc);
+}
+
+static void
+table_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    hash_table_destroy(&p_state->box.table, false);
+    state_destroy(p_state);
+}
+
+/* Put keys 0 .. n-1 in order (growing from the default capacity), then
+ * look each one up */
+static uint64_t
+table_sequential(void * p_arg)
+{
+    state_t *      p_state = p_arg;
+    hash_table_t * p_table = &p_state->box.table;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        hash_table_put(p_table, &p_state->p_keys[idx], &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(hash_table_get(p_table, &p_state->p_keys[idx]));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Random lookups, half of them for keys that are not present */
+static uint64_t
+table_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    uint32_t  range   = 2 * p_state->n;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t key = p_state->p_order[idx] % range;
+        p_state->sink += key_of(
+            hash_table_get(&p_state->box.table, &p_state->p_keys[key]));
+    }
+
+    return p_state->n;
+}
+
+/* 50% get, 25% put, 25% remove on random keys from 0 .. n-1 */
+static uint64_t
+table_mixed(void * p_arg)
+{
+    state_t *      p_state = p_arg;
+    hash_table_t * p_table = &p_state->box.table;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t   value = p_state->p_order[idx];
+        uint32_t   op    = value % PERCENT;
+        uint32_t * p_key = &p_state->p_keys[(value / PERCENT) % p_state->n];
+
+        if (op < 50)
+        {
+            p_state->sink += key_of(hash_table_get(p_table, p_key));
+        }
+        else if (op < 75)
+        {
+            p_state->sink += key_of(hash_table_put(p_table, p_key, p_key));
+        }
+        else
+        {
+            p_state->sink += key_of(hash_table_remove(p_table, p_key));
+        }
+    }
+
+    return p_state->n;
+}
+
+/* One pass over every entry */
+static uint64_t
+table_iterate(void * p_arg)
+{
+    state_t *         p_state = p_arg;
+    hash_table_iter_t iter    = { 0 };
+    void *            p_key   = NULL;
+
+    while (hash_table_next(&p_state->box.table, &iter, &p_key, NULL))
+    {
+        p_state->sink += key_of(p_key);
+    }
+
+    return p_state->n;
+}
+
+/* Empty a filled table */
+static uint64_t
+table_clear(void * p_arg)
+{
+    state_t * p_state = p_arg;
+
+    hash_table_clear(&p_state->box.table, false);
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: hash_dict
+ *************************************************************************/
+
+static void *
+dict_setup(uint32_t            n,
+           uint64_t            seed,
+           uint32_t            fill,
+           const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if ((NULL != p_state)
+        && !hash_dict_init_ex(&p_state->box.dict, 0, hash_key, keys_equal,
+                              NULL, NULL, p_alloc))
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        uint32_t * p_key = &p_state->p_keys[p_state->p_order[idx]];
+        hash_dict_put(&p_state->box.dict, p_key, p_key);
+    }
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+
+    return p_state;
+}
+
+static void *
+dict_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return dict_setup(n, seed, 0, p_alloc);
+}
+
+static void *
+dict_setup_full(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return dict_setup(n, seed, n, p_alloc);
+}
+
+static void *
+dict_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return dict_setup(n, seed, n / 2, p_alloc);
+}
+
+static void
+dict_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    hash_dict_destroy(&p_state->box.dict, false);
+    state_destroy(p_state);
+}
+
+/* Same workloads as hash_table's */
+static uint64_t
+dict_sequential(void * p_arg)
+{
+    state_t *     p_state = p_arg;
+    hash_dict_t * p_dict  = &p_state->box.dict;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        hash_dict_put(p_dict, &p_state->p_keys[idx], &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(hash_dict_get(p_dict, &p_state->p_keys[idx]));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+static uint64_t
+dict_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    uint32_t  range   = 2 * p_state->n;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t key = p_state->p_order[idx] % range;
+        p_state->sink += key_of(
+            hash_dict_get(&p_state->box.dict, &p_state->p_keys[key]));
+    }
+
+    return p_state->n;
+}
+
+static uint64_t
+dict_mixed(void * p_arg)
+{
+    state_t *     p_state = p_arg;
+    hash_dict_t * p_dict  = &p_state->box.dict;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t   value = p_state->p_order[idx];
+        uint32_t   op    = value % PERCENT;
+        uint32_t * p_key = &p_state->p_keys[(value / PERCENT) % p_state->n];
+
+        if (op < 50)
+        {
+            p_state->sink += key_of(hash_dict_get(p_dict, p_key));
+        }
+        else if (op < 75)
+        {
+            p_state->sink += key_of(hash_dict_put(p_dict, p_key, p_key));
+        }
+        else
+        {
+            p_state->sink += key_of(hash_dict_remove(p_dict, p_key));
+        }
+    }
+
+    return p_state->n;
+}
+
+/* One pass over every entry, in insertion order */
+static uint64_t
+dict_iterate(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    uint32_t  pos     = 0;
+    void *    p_key   = NULL;
+
+    while (hash_dict_next(&p_state->box.dict, &pos, &p_key, NULL))
+    {
+        p_state->sink += key_of(p_key);
+    }
+
+    return p_state->n;
+}
+
+/* Empty a filled dict */
+static uint64_t
+dict_clear(void * p_arg)
+{
+    state_t * p_state = p_arg;
+
+    hash_dict_clear(&p_state->box.dict, false);
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: binary_search_tree
+ *************************************************************************/
+
+static void *
+tree_setup(uint32_t            n,
+           uint64_t            seed,
+           uint32_t            fill,
+           const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if ((NULL != p_state)
+        && !bst_init_ex(&p_state->box.tree, compare_keys, p_alloc))
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        bst_insert(&p_state->box.tree,
+                   &p_state->p_keys[p_state->p_order[idx]]);
+    }
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+
+    return p_state;
+}
+
+static void *
+tree_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return tree_setup(n, seed, 0, p_alloc);
+}
+
+static void *
+tree_setup_full(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return tree_setup(n, seed, n, p_alloc);
+}
+
+static void *
+tree_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return tree_setup(n, seed, n / 2, p_alloc);
+}
+
+static void
+tree_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    bst_destroy(&p_state->box.tree, false);
+    state_destroy(p_state);
+}
+
+/* Sorted inserts: the tree is unbalanced, so this builds a chain */
+static uint64_t
+tree_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    bst_t *   p_tree  = &p_state->box.tree;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        bst_insert(p_tree, &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(bst_search(p_tree, &p_state->p_keys[idx]));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Random searches in a tree built from shuffled keys, half of them misses */
+static uint64_t
+tree_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    uint32_t  range   = 2 * p_state->n;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t key = p_state->p_order[idx] % range;
+        p_state->sink += key_of(
+            bst_search(&p_state->box.tree, &p_state->p_keys[key]));
+    }
+
+    return p_state->n;
+}
+
+/* 50% search, 25% insert, 25% remove on random keys from 0 .. n-1 */
+static uint64_t
+tree_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    bst_t *   p_tree  = &p_state->box.tree;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t   value = p_state->p_order[idx];
+        uint32_t   op    = value % PERCENT;
+        uint32_t * p_key = &p_state->p_keys[(value / PERCENT) % p_state->n];
+
+        if (op < 50)
+        {
+            p_state->sink += key_of(bst_search(p_tree, p_key));
+        }
+        else if (op < 75)
+        {
+            p_state->sink += bst_insert(p_tree, p_key) ? 1u : 0u;
+        }
+        else
+        {
+            p_state->sink += key_of(bst_remove(p_tree, p_key));
+        }
+    }
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: heap
+ *************************************************************************/
+
+static void *
+heap_setup(uint32_t            n,
+           uint64_t            seed,
+           uint32_t            fill,
+           const allocator_t * p_alloc)
+{
+    state_t * p_state = state_create(n, seed);
+
+    if ((NULL != p_state)
+        && !heap_init_ex(&p_state->box.heap, 0, 0.0f, compare_keys, p_alloc))
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (uint32_t idx = 0; (NULL != p_state) && (idx < fill); idx++)
+    {
+        heap_insert(&p_state->box.heap,
+                    &p_state->p_keys[p_state->p_order[idx]]);
+    }
+
+    return p_state;
+}
+
+static void *
+heap_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    return heap_setup(n, seed, 0, p_alloc);
+}
+
+static void *
+heap_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    state_t * p_state = heap_setup(n, seed, n / 2, p_alloc);
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+    return p_state;
+}
+
+static void
+heap_teardown(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    heap_destroy(&p_state->box.heap, false);
+    state_destroy(p_state);
+}
+
+/* Insert keys in ascending order, then extract them all */
+static uint64_t
+heap_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    heap_t *  p_heap  = &p_state->box.heap;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        heap_insert(p_heap, &p_state->p_keys[idx]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(heap_extract_top(p_heap));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Insert keys in shuffled order, then extract them all (a heap sort) */
+static uint64_t
+heap_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    heap_t *  p_heap  = &p_state->box.heap;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        heap_insert(p_heap, &p_state->p_keys[p_state->p_order[idx]]);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += key_of(heap_extract_top(p_heap));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* 50% insert, 40% extract, 10% peek with random keys */
+static uint64_t
+heap_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    heap_t *  p_heap  = &p_state->box.heap;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t value = p_state->p_order[idx];
+        uint32_t op    = value % PERCENT;
+
+        if ((op < 50) || heap_is_empty(p_heap))
+        {
+            heap_insert(p_heap,
+                        &p_state->p_keys[(value / PERCENT) % p_state->n]);
+        }
+        else if (op < 90)
+        {
+            p_state->sink += key_of(heap_extract_top(p_heap));
+        }
+        else
+        {
+            p_state->sink += key_of(heap_peek_top(p_heap));
+        }
+    }
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Static Functions: intrusive containers
+ *
+ * The same workloads as for stack, queue, binary_search_tree and heap,
+ * with the element's links embedded in item_t instead of in a node the
+ * container allocates. Items are allocated in setup, like the keys, so a
+ * timed run allocates nothing at all. A hook can only be linked once, so
+ * setups that pre-fill use items n .. 2n-1 where the pointer versions
+ * reuse keys the run pushes again.
+ *************************************************************************/
+
+static int32_t
+compare_tree_items(const bst_hook_t * p_lhs, const bst_hook_t * p_rhs)
+{
+    uint32_t lhs = CONTAINER_OF(p_lhs, item_t, node)->key;
+    uint32_t rhs = CONTAINER_OF(p_rhs, item_t, node)->key;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static int32_t
+compare_heap_items(const heap_hook_t * p_lhs, const heap_hook_t * p_rhs)
+{
+    uint32_t lhs = CONTAINER_OF(p_lhs, item_t, slot)->key;
+    uint32_t rhs = CONTAINER_OF(p_rhs, item_t, slot)->key;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static uint32_t
+list_hook_key(const list_hook_t * p_hook)
+{
+    return (NULL == p_hook) ? 0 : CONTAINER_OF(p_hook, item_t, link)->key;
+}
+
+static uint32_t
+tree_hook_key(const bst_hook_t * p_hook)
+{
+    return (NULL == p_hook) ? 0 : CONTAINER_OF(p_hook, item_t, node)->key;
+}
+
+static uint32_t
+heap_hook_key(const heap_hook_t * p_hook)
+{
+    return (NULL == p_hook) ? 0 : CONTAINER_OF(p_hook, item_t, slot)->key;
+}
+
+/*!
+ * @brief State with 2n zeroed items, items[i].key == i.
+ */
+static state_t *
+items_state_create(uint32_t n, uint64_t seed)
+{
+    state_t * p_state = state_create(n, seed);
+    size_t    count   = 2 * (size_t)((0 == n) ? 1 : n);
+
+    if (NULL == p_state)
+    {
+        return NULL;
+    }
+    p_state->p_items = calloc(count, sizeof(item_t));
+    if (NULL == p_state->p_items)
+    {
+        state_destroy(p_state);
+        return NULL;
+    }
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        p_state->p_items[idx].key = (uint32_t)idx;
+    }
+
+    return p_state;
+}
+
+/* Containers and items own no memory of their own, so p_alloc is unused */
+static void *
+ilist_setup(uint32_t n, uint64_t seed, uint32_t fill)
+{
+    state_t * p_state = items_state_create(n, seed);
+
+    if (NULL == p_state)
+    {
+        return NULL;
+    }
+    ilist_init(&p_state->box.ilist);
+    for (uint32_t idx = 0; idx < fill; idx++)
+    {
+        ilist_push_back(&p_state->box.ilist, &p_state->p_items[n + idx].link);
+    }
+    state_randomise(p_state);
+
+    return p_state;
+}
+
+static void *
+ilist_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+    return ilist_setup(n, seed, 0);
+}
+
+static void *
+istack_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+    return ilist_setup(n, seed, n / 2);
+}
+
+static void *
+iqueue_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+    return ilist_setup(n, seed, QUEUE_WINDOW / 2);
+}
+
+static void
+items_teardown(void * p_arg)
+{
+    state_destroy(p_arg);
+}
+
+static uint64_t
+istack_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ilist_t * p_list  = &p_state->box.ilist;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        ilist_push_front(p_list, &p_state->p_items[idx].link);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += list_hook_key(ilist_pop_front(p_list));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Push or pop on a coin flip */
+static uint64_t
+istack_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ilist_t * p_list  = &p_state->box.ilist;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        if ((0 != (p_state->p_order[idx] & 1u)) || ilist_is_empty(p_list))
+        {
+            ilist_push_front(p_list, &p_state->p_items[idx].link);
+        }
+        else
+        {
+            p_state->sink += list_hook_key(ilist_pop_front(p_list));
+        }
+    }
+
+    return p_state->n;
+}
+
+/* 45% push, 40% pop, 15% peek */
+static uint64_t
+istack_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ilist_t * p_list  = &p_state->box.ilist;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t op = p_state->p_order[idx] % PERCENT;
+
+        if ((op < 45) || ilist_is_empty(p_list))
+        {
+            ilist_push_front(p_list, &p_state->p_items[idx].link);
+        }
+        else if (op < 85)
+        {
+            p_state->sink += list_hook_key(ilist_pop_front(p_list));
+        }
+        else
+        {
+            p_state->sink += list_hook_key(ilist_front(p_list));
+        }
+    }
+
+    return p_state->n;
+}
+
+/* Fill the window, drain it, repeat until n items have passed through */
+static uint64_t
+iqueue_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ilist_t * p_list  = &p_state->box.ilist;
+
+    for (uint32_t done = 0; done < p_state->n; done += QUEUE_WINDOW)
+    {
+        uint32_t batch = p_state->n - done;
+        batch          = (batch < QUEUE_WINDOW) ? batch : QUEUE_WINDOW;
+
+        for (uint32_t idx = 0; idx < batch; idx++)
+        {
+            ilist_push_back(p_list, &p_state->p_items[done + idx].link);
+        }
+        for (uint32_t idx = 0; idx < batch; idx++)
+        {
+            p_state->sink += list_hook_key(ilist_pop_front(p_list));
+        }
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Enqueue or dequeue on a coin flip, within the window */
+static uint64_t
+iqueue_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ilist_t * p_list  = &p_state->box.ilist;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        bool     b_enqueue = (0 != (p_state->p_order[idx] & 1u));
+        uint32_t queued    = ilist_size(p_list);
+
+        if ((0 == queued) || (b_enqueue && (queued < QUEUE_WINDOW)))
+        {
+            ilist_push_back(p_list, &p_state->p_items[idx].link);
+        }
+        else
+        {
+            p_state->sink += list_hook_key(ilist_pop_front(p_list));
+        }
+    }
+
+    return p_state->n;
+}
+
+/* 45% enqueue, 45% dequeue, 10% size queries, within the window */
+static uint64_t
+iqueue_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ilist_t * p_list  = &p_state->box.ilist;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t op = p_state->p_order[idx] % PERCENT;
+
+        if (op >= 90)
+        {
+            p_state->sink += (uint64_t)ilist_size(p_list)
+                             + (ilist_is_empty(p_list) ? 1u : 0u);
+        }
+        else if (((op < 45) && (ilist_size(p_list) < QUEUE_WINDOW))
+                 || ilist_is_empty(p_list))
+        {
+            ilist_push_back(p_list, &p_state->p_items[idx].link);
+        }
+        else
+        {
+            p_state->sink += list_hook_key(ilist_pop_front(p_list));
+        }
+    }
+
+    return p_state->n;
+}
+
+static void *
+itree_setup(uint32_t n, uint64_t seed, uint32_t fill)
+{
+    state_t * p_state = items_state_create(n, seed);
+
+    if (NULL == p_state)
+    {
+        return NULL;
+    }
+    ibst_init(&p_state->box.itree, compare_tree_items);
+    for (uint32_t idx = 0; idx < fill; idx++)
+    {
+        ibst_insert(&p_state->box.itree,
+                    &p_state->p_items[p_state->p_order[idx]].node);
+    }
+    state_randomise(p_state);
+
+    return p_state;
+}
+
+static void *
+itree_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+    return itree_setup(n, seed, 0);
+}
+
+static void *
+itree_setup_full(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+    return itree_setup(n, seed, n);
+}
+
+static void *
+itree_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+    return itree_setup(n, seed, n / 2);
+}
+
+/* Sorted inserts: the tree is unbalanced, so this builds a chain */
+static uint64_t
+itree_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ibst_t *  p_tree  = &p_state->box.itree;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        ibst_insert(p_tree, &p_state->p_items[idx].node);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += tree_hook_key(
+            ibst_search(p_tree, &p_state->p_items[idx].node));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Random searches in a tree built from shuffled keys, half of them misses;
+   an item serves as its own probe */
+static uint64_t
+itree_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    uint32_t  range   = 2 * p_state->n;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t key = p_state->p_order[idx] % range;
+        p_state->sink += tree_hook_key(ibst_search(
+            &p_state->box.itree, &p_state->p_items[key].node));
+    }
+
+    return p_state->n;
+}
+
+/* 50% search, 25% insert, 25% remove on random keys from 0 .. n-1 */
+static uint64_t
+itree_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    ibst_t *  p_tree  = &p_state->box.itree;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t     value  = p_state->p_order[idx];
+        uint32_t     op     = value % PERCENT;
+        bst_hook_t * p_node = &p_state->p_items[(value / PERCENT)
+                                                % p_state->n].node;
+
+        if (op < 50)
+        {
+            p_state->sink += tree_hook_key(ibst_search(p_tree, p_node));
+        }
+        else if (op < 75)
+        {
+            // An item already linked compares equal to itself and is
+            // turned away, as bst_insert turns away a duplicate key
+            p_state->sink += ibst_insert(p_tree, p_node) ? 1u : 0u;
+        }
+        else
+        {
+            bst_hook_t * p_found = ibst_search(p_tree, p_node);
+            if (NULL != p_found)
+            {
+                ibst_remove(p_tree, p_found);
+                p_state->sink += tree_hook_key(p_found);
+            }
+        }
+    }
+
+    return p_state->n;
+}
+
+static void *
+iheap_setup(uint32_t n, uint64_t seed, uint32_t fill)
+{
+    state_t * p_state = items_state_create(n, seed);
+
+    if (NULL == p_state)
+    {
+        return NULL;
+    }
+    iheap_init(&p_state->box.iheap, compare_heap_items);
+    for (uint32_t idx = 0; idx < fill; idx++)
+    {
+        iheap_insert(&p_state->box.iheap,
+                     &p_state->p_items[p_state->p_order[idx]].slot);
+    }
+
+    return p_state;
+}
+
+static void *
+iheap_setup_empty(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+    return iheap_setup(n, seed, 0);
+}
+
+static void *
+iheap_setup_half(uint32_t n, uint64_t seed, const allocator_t * p_alloc)
+{
+    (void)p_alloc;
+
+    state_t * p_state = iheap_setup(n, seed, n / 2);
+    if (NULL != p_state)
+    {
+        state_randomise(p_state);
+    }
+    return p_state;
+}
+
+/* Insert keys in ascending order, then extract them all */
+static uint64_t
+iheap_sequential(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    iheap_t * p_heap  = &p_state->box.iheap;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        iheap_insert(p_heap, &p_state->p_items[idx].slot);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += heap_hook_key(iheap_extract_top(p_heap));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* Insert keys in shuffled order, then extract them all (a heap sort) */
+static uint64_t
+iheap_random(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    iheap_t * p_heap  = &p_state->box.iheap;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        iheap_insert(p_heap, &p_state->p_items[p_state->p_order[idx]].slot);
+    }
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        p_state->sink += heap_hook_key(iheap_extract_top(p_heap));
+    }
+
+    return 2 * (uint64_t)p_state->n;
+}
+
+/* 50% insert, 40% extract, 10% peek with random keys. Inserting an item
+   that is already in the heap is turned away, where heap_insert would
+   store the key twice. */
+static uint64_t
+iheap_mixed(void * p_arg)
+{
+    state_t * p_state = p_arg;
+    iheap_t * p_heap  = &p_state->box.iheap;
+
+    for (uint32_t idx = 0; idx < p_state->n; idx++)
+    {
+        uint32_t value = p_state->p_order[idx];
+        uint32_t op    = value % PERCENT;
+
+        if ((op < 50) || iheap_is_empty(p_heap))
+        {
+            iheap_insert(p_heap,
+                         &p_state->p_items[(value / PERCENT) % p_state->n]
+                              .slot);
+        }
+        else if (op < 90)
+        {
+            p_state->sink += heap_hook_key(iheap_extract_top(p_heap));
+        }
+        else
+        {
+            p_state->sink += heap_hook_key(iheap_peek_top(p_heap));
+        }
+    }
+
+    return p_state->n;
+}
+
+/*************************************************************************
+ * Private Data: cases
+ *************************************************************************/
+
+static const bench_case_t g_cases[] = {
+    { "dynamic_array", "sequential", 0,
+      array_setup_empty, array_sequential, array_teardown },
+    { "dynamic_array", "random", 0,
+      array_setup_full, array_random, array_teardown },
+    { "dynamic_array", "mixed", 0,
+      array_setup_half, array_mixed, array_teardown },
+
+    { "linked_list", "sequential", 0,
+      list_setup_empty, list_sequential, list_teardown },
+    { "linked_list", "random", LIST_RANDOM_MAX_N,
+      list_setup_full, list_random, list_teardown },
+    { "linked_list", "mixed", 0,
+      list_setup_half, list_mixed, list_teardown },
+    { "linked_list", "sort", 0,
+      list_setup_full, list_sort, list_teardown },
+    { "linked_list", "batch", 0,
+      list_setup_full, list_batch, list_teardown },
+    { "linked_list", "batch_copy", 0,
+      list_setup_full, list_batch_copy, list_teardown },
+
+    { "stack", "sequential", 0,
+      stack_setup_empty, stack_sequential, stack_teardown },
+    { "stack", "random", 0,
+      stack_setup_empty, stack_random, stack_teardown },
+    { "stack", "mixed", 0,
+      stack_setup_half, stack_mixed, stack_teardown },
+
+    { "queue", "sequential", 0,
+      queue_setup_empty, queue_sequential, queue_teardown },
+    { "queue", "random", 0,
+      queue_setup_empty, queue_random, queue_teardown },
+    { "queue", "mixed", 0,
+      queue_setup_half, queue_mixed, queue_teardown },
+
+    { "ring_stack", "sequential", 0,
+      ring_stack_setup_empty, stack_sequential, stack_teardown },
+    { "ring_stack", "random", 0,
+      ring_stack_setup_empty, stack_random, stack_teardown },
+    { "ring_stack", "mixed", 0,
+      ring_stack_setup_half, stack_mixed, stack_teardown },
+
+    { "ring_queue", "sequential", 0,
+      ring_queue_setup_empty, queue_sequential, queue_teardown },
+    { "ring_queue", "random", 0,
+      ring_queue_setup_empty, queue_random, queue_teardown },
+    { "ring_queue", "mixed", 0,
+      ring_queue_setup_half, queue_mixed, queue_teardown },
+
+    { "deque", "sequential", 0,
+      deque_setup_empty, deque_sequential, deque_teardown },
+    { "deque", "random", 0,
+      deque_setup_empty, deque_random, deque_teardown },
+    { "deque", "mixed", 0,
+      deque_setup_half, deque_mixed, deque_teardown },
+
+    { "hash_table", "sequential", 0,
+      table_setup_empty, table_sequential, table_teardown },
+    { "hash_table", "random", 0,
+      table_setup_full, table_random, table_teardown },
+    { "hash_table", "mixed", 0,
+      table_setup_half, table_mixed, table_teardown },
+    { "hash_table", "iterate", 0,
+      table_setup_full, table_iterate, table_teardown },
+    { "hash_table", "clear", 0,
+      table_setup_full, table_clear, table_teardown },
+
+    { "hash_dict", "sequential", 0,
+      dict_setup_empty, dict_sequential, dict_teardown },
+    { "hash_dict", "random", 0,
+      dict_setup_full, dict_random, dict_teardown },
+    { "hash_dict", "mixed", 0,
+      dict_setup_half, dict_mixed, dict_teardown },
+    { "hash_dict", "iterate", 0,
+      dict_setup_full, dict_iterate, dict_teardown },
+    { "hash_dict", "clear", 0,
+      dict_setup_full, dict_clear, dict_teardown },
+
+    { "binary_search_tree", "sequential", BST_SORTED_MAX_N,
+      tree_setup_empty, tree_sequential, tree_teardown },
+    { "binary_search_tree", "random", 0,
+      tree_setup_full, tree_random, tree_teardown },
+    { "binary_search_tree", "mixed", 0,
+      tree_setup_half, tree_mixed, tree_teardown },
+
+    { "heap", "sequential", 0,
+      heap_setup_empty, heap_sequential, heap_teardown },
+    { "heap", "random", 0,
+      heap_setup_empty, heap_random, heap_teardown },
+    { "heap", "mixed", 0,
+      heap_setup_half, heap_mixed, heap_teardown },
+
+    { "intrusive_stack", "sequential", 0,
+      ilist_setup_empty, istack_sequential, items_teardown },
+    { "intrusive_stack", "random", 0,
+      ilist_setup_empty, istack_random, items_teardown },
+    { "intrusive_stack", "mixed", 0,
+      istack_setup_half, istack_mixed, items_teardown },
+
+    { "intrusive_queue", "sequential", 0,
+      ilist_setup_empty, iqueue_sequential, items_teardown },
+    { "intrusive_queue", "random", 0,
+      ilist_setup_empty, iqueue_random, items_teardown },
+    { "intrusive_queue", "mixed", 0,
+      iqueue_setup_half, iqueue_mixed, items_teardown },
+
+    { "intrusive_bst", "sequential", BST_SORTED_MAX_N,
+      itree_setup_empty, itree_sequential, items_teardown },
+    { "intrusive_bst", "random", 0,
+      itree_setup_full, itree_random, items_teardown },
+    { "intrusive_bst", "mixed", 0,
+      itree_setup_half, itree_mixed, items_teardown },
+
+    { "intrusive_heap", "sequential", 0,
+      iheap_setup_empty, iheap_sequential, items_teardown },
+    { "intrusive_heap", "random", 0,
+      iheap_setup_empty, iheap_random, items_teardown },
+    { "intrusive_heap", "mixed", 0,
+      iheap_setup_half, iheap_mixed, items_teardown },
+};
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+static void
+usage(void)
+{
+    fprintf(stderr,
+            "usage: basic_bench [-f json|csv] [-o file] [-r reps] "
+            "[-w warmup]\n"
+            "                   [-c cpu] [-s seed] [-m min_n] [-n max_n] "
+            "[-k filter]\n");
+}
+
+int
+main(int argc, char ** argv)
+{
+    bench_options_t options = bench_options_default();
+    const char *    p_path  = NULL;
+    uint32_t        min_n   = DEFAULT_MIN_N;
+    uint32_t        max_n   = DEFAULT_MAX_N;
+    int             option  = 0;
+
+    while (-1 != (option = getopt(argc, argv, "f:o:r:w:c:s:m:n:k:")))
+    {
+        switch (option)
+        {
+            case 'f':
+                options.format = (0 == strcmp(optarg, "csv"))
+                                     ? BENCH_FORMAT_CSV
+                                     : BENCH_FORMAT_JSON;
+                break;
+            case 'o':
+                p_path = optarg;
+                break;
+            case 'r':
+                options.reps = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                options.warmup = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                options.cpu = atoi(optarg);
+                break;
+            case 's':
+                options.seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'm':
+                min_n = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                max_n = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'k':
+                options.p_filter = optarg;
+                break;
+            default:
+                usage();
+                return EXIT_FAILURE;
+        }
+    }
+
+    if ((0 == min_n) || (min_n > max_n))
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    FILE * p_output = (NULL == p_path) ? stdout : fopen(p_path, "w");
+    if (NULL == p_output)
+    {
+        perror(p_path);
+        return EXIT_FAILURE;
+    }
+
+    bench_t * p_bench = bench_create(&options, p_output);
+    if (NULL == p_bench)
+    {
+        fprintf(stderr, "bad options (reps must be 1 .. %u)\n",
+                BENCH_MAX_REPS);
+        return EXIT_FAILURE;
+    }
+
+    int status = BENCH_SUCCESS;
+    for (size_t idx = 0; idx < (sizeof(g_cases) / sizeof(g_cases[0])); idx++)
+    {
+        // Sizes grow by SIZE_STEP; stop before the multiply could wrap
+        for (uint32_t n = min_n; (n <= max_n) && (status >= 0);
+             n = (n > (UINT32_MAX / SIZE_STEP)) ? UINT32_MAX : n * SIZE_STEP)
+        {
+            status = bench_run(p_bench, &g_cases[idx], n);
+            if (UINT32_MAX == n)
+            {
+                break;
+            }
+        }
+    }
+    if (status < 0)
+    {
+        fprintf(stderr, "benchmark failed (%d)\n", status);
+    }
+
+    if ((BENCH_SUCCESS != bench_finish(&p_bench)) || (status < 0))
+    {
+        status = BENCH_ERROR_IO;
+    }
+    if (stdout != p_output)
+    {
+        fclose(p_output);
+    }
+
+    return (status < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*** end of file ***/
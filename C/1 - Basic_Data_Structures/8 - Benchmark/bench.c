@@ -0,0 +1,859 @@
+/** @file bench.c
+ *
+ * @brief Microbenchmark harness: pinning, timers, counters and reports.
+ *
+ * Hardware counters are opened once as a group on the calling thread, so
+ * all three count exactly the same instructions. They are reset, enabled
+ * and read around every timed run. Every per-run figure is divided by the
+ * operation count the run returned; the report gives the minimum, median,
+ * mean and standard deviation of nanoseconds per operation and the median
+ * of the other figures.
+ *
+ * The timed runs use the default allocator, so tracking costs nothing
+ * there; memory figures come from one separate run through a tracker.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#define _GNU_SOURCE
+
+#include <linux/perf_event.h>
+#include <math.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC (1)
+#else
+#define BENCH_HAVE_TSC (0)
+#endif
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define COUNTER_COUNT      (3u)
+#define MEMORY_COUNT       (4u)
+#define INITIAL_RESULTS    (64u)
+#define NAME_BUFFER        (128u)
+#define CPU_MODEL_BUFFER   (128u)
+#define NSEC_PER_SEC       (1000000000.0)
+#define UNAVAILABLE        (-1.0)  /* Figure that was not measured */
+
+#define DEFAULT_WARMUP     (1u)
+#define DEFAULT_REPS       (5u)
+#define DEFAULT_SEED       (0x5eed2025u)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct
+{
+    double min;
+    double median;
+    double mean;
+    double stddev;
+} bench_stats_t;
+
+/* One case at one size */
+typedef struct
+{
+    const char *  p_container;
+    const char *  p_workload;
+    uint32_t      n;
+    uint64_t      ops;
+    bench_stats_t ns_per_op;
+    double        tsc_per_op;                    /* Median */
+    double        counter_per_op[COUNTER_COUNT]; /* Medians */
+    double        memory[MEMORY_COUNT];          /* From the tracked run */
+} bench_result_t;
+
+struct bench
+{
+    bench_options_t  options;
+    FILE *           p_output;
+    int              pinned_cpu;                /* -1 if not pinned */
+    int              counter_fds[COUNTER_COUNT]; /* -1 if not opened */
+    int              group_slot[COUNTER_COUNT];  /* Position in a group read */
+    int              leader_fd;                  /* -1 without counters */
+    double *         p_samples;  /* reps * (2 + COUNTER_COUNT) per-run values */
+    bench_result_t * p_results;
+    size_t           result_count;
+    size_t           result_capacity;
+    char             timestamp[32];
+};
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const uint64_t g_counter_configs[COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static const char * const g_counter_names[COUNTER_COUNT] = {
+    "cycles_per_op",
+    "cache_misses_per_op",
+    "branch_misses_per_op",
+};
+
+static const char * const g_memory_names[MEMORY_COUNT] = {
+    "live_bytes",    /* Live after setup: the container's footprint */
+    "peak_bytes",    /* Highest live bytes over setup and run */
+    "allocs_per_op", /* Allocations and resizes in the run, per op */
+    "leaked_bytes",  /* Still live after teardown */
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static int      pin_cpu(int cpu);
+static void     open_counters(bench_t * p_bench);
+static int      measure(bench_t *            p_bench,
+                        const bench_case_t * p_case,
+                        uint32_t             n,
+                        uint64_t             seed,
+                        uint32_t             rep,
+                        uint64_t *           p_ops);
+static void     measure_memory(const bench_case_t * p_case,
+                               uint32_t             n,
+                               uint64_t             seed,
+                               double *             p_memory);
+static uint64_t case_seed(uint64_t     seed,
+                          const char * p_name,
+                          uint32_t     n);
+static int      compare_doubles(const void * p_lhs, const void * p_rhs);
+static double   median(double * p_values, uint32_t count);
+static void     summarise(double *        p_values,
+                          uint32_t        count,
+                          bench_stats_t * p_stats);
+static int      append_result(bench_t *              p_bench,
+                              const bench_result_t * p_result);
+static void     read_cpu_model(char * p_model, size_t size);
+static void     write_json_string(FILE * p_output, const char * p_text);
+static void     write_json_number(FILE * p_output, double value);
+static void     write_json(bench_t * p_bench);
+static void     write_csv(bench_t * p_bench);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Default options: 1 warmup, 5 reps, first allowed CPU, JSON.
+ *
+ * @return Options
+ */
+bench_options_t
+bench_options_default(void)
+{
+    bench_options_t options = {
+        .warmup   = DEFAULT_WARMUP,
+        .reps     = DEFAULT_REPS,
+        .cpu      = -1,
+        .seed     = DEFAULT_SEED,
+        .format   = BENCH_FORMAT_JSON,
+        .p_filter = NULL,
+    };
+    return options;
+}
+
+/*!
+ * @brief Pins the process, opens the hardware counters and starts a report.
+ *
+ * @param[in] p_options Options (copied)
+ * @param[in] p_output  Stream the report is written to by bench_finish()
+ *
+ * @return Pointer to the harness, or NULL on failure
+ */
+bench_t *
+bench_create(const bench_options_t * p_options, FILE * p_output)
+{
+    if ((NULL == p_options) || (NULL == p_output) || (0 == p_options->reps)
+        || (p_options->reps > BENCH_MAX_REPS))
+    {
+        return NULL;
+    }
+
+    bench_t * p_bench = calloc(1, sizeof(bench_t));
+    if (NULL == p_bench)
+    {
+        return NULL;
+    }
+
+    p_bench->options         = *p_options;
+    p_bench->p_output        = p_output;
+    p_bench->result_capacity = INITIAL_RESULTS;
+    p_bench->p_results = calloc(INITIAL_RESULTS, sizeof(bench_result_t));
+    p_bench->p_samples = calloc((size_t)p_options->reps * (2 + COUNTER_COUNT),
+                                sizeof(double));
+    if ((NULL == p_bench->p_results) || (NULL == p_bench->p_samples))
+    {
+        free(p_bench->p_results);
+        free(p_bench->p_samples);
+        free(p_bench);
+        return NULL;
+    }
+
+    time_t    now = time(NULL);
+    struct tm utc;
+    gmtime_r(&now, &utc);
+    strftime(p_bench->timestamp,
+             sizeof(p_bench->timestamp),
+             "%Y-%m-%dT%H:%M:%SZ",
+             &utc);
+
+    // Pin before opening the counters so they follow the pinned thread
+    p_bench->pinned_cpu = pin_cpu(p_options->cpu);
+    open_counters(p_bench);
+
+    return p_bench;
+}
+
+/*!
+ * @brief Measures one case at size n and records the result.
+ *
+ * @param[in,out] p_bench Harness
+ * @param[in]     p_case  Case
+ * @param[in]     n       Size passed to the case's setup
+ *
+ * @return BENCH_SUCCESS, BENCH_SKIPPED or a negative error code
+ */
+int
+bench_run(bench_t * p_bench, const bench_case_t * p_case, uint32_t n)
+{
+    if ((NULL == p_bench) || (NULL == p_case) || (NULL == p_case->setup_fn)
+        || (NULL == p_case->run_fn) || (NULL == p_case->teardown_fn))
+    {
+        return BENCH_ERROR_PARAM;
+    }
+
+    char name[NAME_BUFFER];
+    snprintf(name, sizeof(name), "%s/%s", p_case->p_container,
+             p_case->p_workload);
+
+    if (((0 != p_case->max_n) && (n > p_case->max_n))
+        || ((NULL != p_bench->options.p_filter)
+            && (NULL == strstr(name, p_bench->options.p_filter))))
+    {
+        return BENCH_SKIPPED;
+    }
+
+    uint64_t       seed   = case_seed(p_bench->options.seed, name, n);
+    uint32_t       reps   = p_bench->options.reps;
+    bench_result_t result = { .p_container = p_case->p_container,
+                              .p_workload  = p_case->p_workload,
+                              .n           = n };
+
+    for (uint32_t idx = 0; idx < p_bench->options.warmup; idx++)
+    {
+        void * p_state = p_case->setup_fn(n, seed, NULL);
+        if (NULL == p_state)
+        {
+            return BENCH_ERROR_SETUP;
+        }
+        (void)p_case->run_fn(p_state);
+        p_case->teardown_fn(p_state);
+    }
+
+    for (uint32_t rep = 0; rep < reps; rep++)
+    {
+        int status = measure(p_bench, p_case, n, seed, rep, &result.ops);
+        if (BENCH_SUCCESS != status)
+        {
+            return status;
+        }
+    }
+
+    // Per-run values are laid out as reps ns, reps tsc, reps per counter
+    double * p_ns = p_bench->p_samples;
+    summarise(p_ns, reps, &result.ns_per_op);
+    result.tsc_per_op = BENCH_HAVE_TSC ? median(p_ns + reps, reps)
+                                       : UNAVAILABLE;
+    for (uint32_t idx = 0; idx < COUNTER_COUNT; idx++)
+    {
+        result.counter_per_op[idx]
+            = (p_bench->counter_fds[idx] >= 0)
+                  ? median(p_ns + ((2 + idx) * reps), reps)
+                  : UNAVAILABLE;
+    }
+    measure_memory(p_case, n, seed, result.memory);
+
+    fprintf(stderr, "%-32s n=%-9u %10.2f ns/op %12.0f peak bytes\n", name,
+            n, result.ns_per_op.median, result.memory[1]);
+    if (result.memory[3] > 0.0)
+    {
+        fprintf(stderr, "%-32s n=%-9u leaked %.0f bytes\n", name, n,
+                result.memory[3]);
+    }
+
+    return append_result(p_bench, &result);
+}
+
+/*!
+ * @brief Writes the report and frees the harness.
+ *
+ * @param[in,out] pp_bench Pointer to the harness pointer; set to NULL
+ *
+ * @return BENCH_SUCCESS or BENCH_ERROR_IO
+ */
+int
+bench_finish(bench_t ** pp_bench)
+{
+    if ((NULL == pp_bench) || (NULL == *pp_bench))
+    {
+        return BENCH_ERROR_PARAM;
+    }
+
+    bench_t * p_bench = *pp_bench;
+
+    if (BENCH_FORMAT_CSV == p_bench->options.format)
+    {
+        write_csv(p_bench);
+    }
+    else
+    {
+        write_json(p_bench);
+    }
+    int status = (0 == fflush(p_bench->p_output)) ? BENCH_SUCCESS
+                                                  : BENCH_ERROR_IO;
+
+    for (uint32_t idx = 0; idx < COUNTER_COUNT; idx++)
+    {
+        if (p_bench->counter_fds[idx] >= 0)
+        {
+            close(p_bench->counter_fds[idx]);
+        }
+    }
+    free(p_bench->p_results);
+    free(p_bench->p_samples);
+    free(p_bench);
+    *pp_bench = NULL;
+
+    return status;
+}
+
+/*!
+ * @brief Deterministic 64-bit generator (splitmix64) for case inputs.
+ *
+ * @param[in,out] p_state Generator state, seeded by the caller
+ *
+ * @return Next value
+ */
+uint64_t
+bench_random(uint64_t * p_state)
+{
+    uint64_t value = (*p_state += 0x9e3779b97f4a7c15ull);
+    value          = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value          = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Pins the process to a CPU.
+ *
+ * @param[in] cpu CPU number, or -1 for the first CPU the process may use
+ *
+ * @return The CPU pinned to, or -1 if pinning failed
+ */
+static int
+pin_cpu(int cpu)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+
+    if ((cpu < 0) && (0 == sched_getaffinity(0, sizeof(allowed), &allowed)))
+    {
+        for (int idx = 0; idx < CPU_SETSIZE; idx++)
+        {
+            if (CPU_ISSET(idx, &allowed))
+            {
+                cpu = idx;
+                break;
+            }
+        }
+    }
+    if ((cpu < 0) || (cpu >= CPU_SETSIZE))
+    {
+        return -1;
+    }
+
+    cpu_set_t target;
+    CPU_ZERO(&target);
+    CPU_SET(cpu, &target);
+
+    return (0 == sched_setaffinity(0, sizeof(target), &target)) ? cpu : -1;
+}
+
+/*!
+ * @brief Opens cycles, cache misses and branch misses as one group.
+ *
+ * Counters the kernel refuses (no PMU, perf_event_paranoid, containers)
+ * are left at -1 and reported as unavailable.
+ *
+ * @param[in,out] p_bench Harness
+ */
+static void
+open_counters(bench_t * p_bench)
+{
+    int slot = 0;
+
+    p_bench->leader_fd = -1;
+
+    for (uint32_t idx = 0; idx < COUNTER_COUNT; idx++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = g_counter_configs[idx];
+        attr.disabled       = (p_bench->leader_fd < 0) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP;
+
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+                              p_bench->leader_fd, 0);
+
+        p_bench->counter_fds[idx] = fd;
+        p_bench->group_slot[idx]  = (fd >= 0) ? slot++ : -1;
+        if ((fd >= 0) && (p_bench->leader_fd < 0))
+        {
+            p_bench->leader_fd = fd;
+        }
+    }
+}
+
+/*!
+ * @brief Sets up, times and tears down one run, storing its per-op values.
+ *
+ * @param[out] p_ops Operations done by the run
+ *
+ * @return BENCH_SUCCESS or BENCH_ERROR_SETUP
+ */
+static int
+measure(bench_t *            p_bench,
+        const bench_case_t * p_case,
+        uint32_t             n,
+        uint64_t             seed,
+        uint32_t             rep,
+        uint64_t *           p_ops)
+{
+    uint32_t reps    = p_bench->options.reps;
+    int      leader  = p_bench->leader_fd;
+    void *   p_state = p_case->setup_fn(n, seed, NULL);
+
+    if (NULL == p_state)
+    {
+        return BENCH_ERROR_SETUP;
+    }
+
+    struct timespec start;
+    struct timespec end;
+    uint64_t        tsc_start = 0;
+    uint64_t        tsc_end   = 0;
+
+    if (leader >= 0)
+    {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+#if BENCH_HAVE_TSC
+    tsc_start = __rdtsc();
+#endif
+
+    uint64_t ops = p_case->run_fn(p_state);
+
+#if BENCH_HAVE_TSC
+    tsc_end = __rdtsc();
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    uint64_t counts[1 + COUNTER_COUNT] = { 0 };
+    if (leader >= 0)
+    {
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(leader, counts, sizeof(counts)) <= 0)
+        {
+            memset(counts, 0, sizeof(counts));
+        }
+    }
+
+    p_case->teardown_fn(p_state);
+
+    double per_op  = 1.0 / (double)((0 == ops) ? 1 : ops);
+    double elapsed = ((double)(end.tv_sec - start.tv_sec) * NSEC_PER_SEC)
+                     + (double)(end.tv_nsec - start.tv_nsec);
+
+    p_bench->p_samples[rep]        = elapsed * per_op;
+    p_bench->p_samples[reps + rep] = (double)(tsc_end - tsc_start) * per_op;
+
+    // A group read is { nr, value[nr] } in the order the events were opened
+    for (uint32_t idx = 0; idx < COUNTER_COUNT; idx++)
+    {
+        int slot = p_bench->group_slot[idx];
+        p_bench->p_samples[((2 + idx) * reps) + rep]
+            = ((slot >= 0) && ((uint64_t)slot < counts[0]))
+                  ? (double)counts[1 + slot] * per_op
+                  : 0.0;
+    }
+
+    *p_ops = ops;
+    return BENCH_SUCCESS;
+}
+
+/*!
+ * @brief Runs the case once through an allocation tracker.
+ *
+ * @param[out] p_memory MEMORY_COUNT figures, in g_memory_names order; all
+ *                      UNAVAILABLE if the run could not be made
+ */
+static void
+measure_memory(const bench_case_t * p_case,
+               uint32_t             n,
+               uint64_t             seed,
+               double *             p_memory)
+{
+    alloc_tracker_t * p_tracker = alloc_tracker_create(NULL, 0);
+    void *            p_state   = NULL;
+
+    for (uint32_t idx = 0; idx < MEMORY_COUNT; idx++)
+    {
+        p_memory[idx] = UNAVAILABLE;
+    }
+    if (NULL != p_tracker)
+    {
+        p_state = p_case->setup_fn(n, seed,
+                                   alloc_tracker_allocator(p_tracker));
+    }
+    if (NULL == p_state)
+    {
+        alloc_tracker_destroy(&p_tracker);
+        return;
+    }
+
+    alloc_stats_t before;
+    alloc_stats_t after;
+    alloc_stats_t end;
+
+    alloc_tracker_stats(p_tracker, &before);
+    uint64_t ops = p_case->run_fn(p_state);
+    alloc_tracker_stats(p_tracker, &after);
+    p_case->teardown_fn(p_state);
+    alloc_tracker_stats(p_tracker, &end);
+    alloc_tracker_destroy(&p_tracker);
+
+    uint64_t allocs = (after.allocs + after.reallocs)
+                      - (before.allocs + before.reallocs);
+
+    p_memory[0] = (double)before.live_bytes;
+    p_memory[1] = (double)after.peak_bytes;
+    p_memory[2] = (double)allocs / (double)((0 == ops) ? 1 : ops);
+    p_memory[3] = (double)end.live_bytes;
+}
+
+/*!
+ * @brief Mixes the base seed with a case name and size (FNV-1a).
+ */
+static uint64_t
+case_seed(uint64_t seed, const char * p_name, uint32_t n)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (; '\0' != *p_name; p_name++)
+    {
+        hash = (hash ^ (uint8_t)*p_name) * 0x100000001b3ull;
+    }
+    hash ^= ((uint64_t)n << 32) ^ seed;
+
+    return bench_random(&hash);
+}
+
+static int
+compare_doubles(const void * p_lhs, const void * p_rhs)
+{
+    double lhs = *(const double *)p_lhs;
+    double rhs = *(const double *)p_rhs;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/*!
+ * @brief Median of count values; sorts them in place.
+ */
+static double
+median(double * p_values, uint32_t count)
+{
+    qsort(p_values, count, sizeof(double), compare_doubles);
+    return (0 != (count % 2))
+               ? p_values[count / 2]
+               : (p_values[(count / 2) - 1] + p_values[count / 2]) / 2.0;
+}
+
+/*!
+ * @brief Minimum, median, mean and sample standard deviation; sorts the
+ *        values in place.
+ */
+static void
+summarise(double * p_values, uint32_t count, bench_stats_t * p_stats)
+{
+    double sum     = 0.0;
+    double squares = 0.0;
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        sum += p_values[idx];
+    }
+    p_stats->mean = sum / count;
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        double diff = p_values[idx] - p_stats->mean;
+        squares += diff * diff;
+    }
+    p_stats->stddev = (count > 1) ? sqrt(squares / (count - 1)) : 0.0;
+
+    // median() sorts, so it comes after the sums
+    p_stats->median = median(p_values, count);
+    p_stats->min    = p_values[0];
+}
+
+static int
+append_result(bench_t * p_bench, const bench_result_t * p_result)
+{
+    if (p_bench->result_count == p_bench->result_capacity)
+    {
+        size_t           capacity  = p_bench->result_capacity * 2;
+        bench_result_t * p_results = realloc(p_bench->p_results,
+                                             capacity * sizeof(bench_result_t));
+        if (NULL == p_results)
+        {
+            return BENCH_ERROR_MEMORY;
+        }
+        p_bench->p_results       = p_results;
+        p_bench->result_capacity = capacity;
+    }
+
+    p_bench->p_results[p_bench->result_count++] = *p_result;
+    return BENCH_SUCCESS;
+}
+
+/*!
+ * @brief Copies the first "model name" from /proc/cpuinfo, or "unknown".
+ */
+static void
+read_cpu_model(char * p_model, size_t size)
+{
+    FILE * p_file = fopen("/proc/cpuinfo", "r");
+    char   line[256];
+
+    snprintf(p_model, size, "unknown");
+    if (NULL == p_file)
+    {
+        return;
+    }
+
+    while (NULL != fgets(line, sizeof(line), p_file))
+    {
+        char * p_colon = strchr(line, ':');
+        if ((0 == strncmp(line, "model name", 10)) && (NULL != p_colon))
+        {
+            p_colon += strspn(p_colon, ": \t");
+            p_colon[strcspn(p_colon, "\n")] = '\0';
+            snprintf(p_model, size, "%s", p_colon);
+            break;
+        }
+    }
+    fclose(p_file);
+}
+
+static void
+write_json_string(FILE * p_output, const char * p_text)
+{
+    fputc('"', p_output);
+    for (; '\0' != *p_text; p_text++)
+    {
+        unsigned char byte = (unsigned char)*p_text;
+        if (('"' == byte) || ('\\' == byte))
+        {
+            fprintf(p_output, "\\%c", byte);
+        }
+        else if (byte < 0x20)
+        {
+            fprintf(p_output, "\\u%04x", byte);
+        }
+        else
+        {
+            fputc(byte, p_output);
+        }
+    }
+    fputc('"', p_output);
+}
+
+static void
+write_json_number(FILE * p_output, double value)
+{
+    if (value < 0.0)
+    {
+        fputs("null", p_output);
+    }
+    else
+    {
+        fprintf(p_output, "%.4f", value);
+    }
+}
+
+/*!
+ * @brief Writes metadata and results as one JSON object, keys in a fixed
+ *        order, one result per line.
+ */
+static void
+write_json(bench_t * p_bench)
+{
+    FILE *         p_out = p_bench->p_output;
+    struct utsname host;
+    char           cpu_model[CPU_MODEL_BUFFER];
+
+    if (0 != uname(&host))
+    {
+        memset(&host, 0, sizeof(host));
+    }
+    read_cpu_model(cpu_model, sizeof(cpu_model));
+
+    fprintf(p_out, "{\n  \"schema\": %d,\n  \"meta\": {\n",
+            BENCH_SCHEMA_VERSION);
+    fprintf(p_out, "    \"timestamp\": \"%s\",\n", p_bench->timestamp);
+    fputs("    \"host\": ", p_out);
+    write_json_string(p_out, host.nodename);
+    fputs(",\n    \"kernel\": ", p_out);
+    write_json_string(p_out, host.release);
+    fputs(",\n    \"cpu_model\": ", p_out);
+    write_json_string(p_out, cpu_model);
+#ifdef __VERSION__
+    fputs(",\n    \"compiler\": ", p_out);
+    write_json_string(p_out, __VERSION__);
+#endif
+    fprintf(p_out, ",\n    \"timer\": \"CLOCK_MONOTONIC\",\n");
+    fprintf(p_out, "    \"tsc\": %s,\n", BENCH_HAVE_TSC ? "true" : "false");
+    fprintf(p_out, "    \"counters\": [");
+    for (uint32_t idx = 0, count = 0; idx < COUNTER_COUNT; idx++)
+    {
+        if (p_bench->counter_fds[idx] >= 0)
+        {
+            fprintf(p_out, "%s\"%s\"", (count++ > 0) ? ", " : "",
+                    g_counter_names[idx]);
+        }
+    }
+    fprintf(p_out, "],\n    \"pinned_cpu\": %d,\n", p_bench->pinned_cpu);
+    fprintf(p_out, "    \"warmup\": %u,\n    \"reps\": %u,\n",
+            p_bench->options.warmup, p_bench->options.reps);
+    fprintf(p_out, "    \"seed\": %llu\n  },\n  \"results\": [\n",
+            (unsigned long long)p_bench->options.seed);
+
+    for (size_t idx = 0; idx < p_bench->result_count; idx++)
+    {
+        const bench_result_t * p_result = &p_bench->p_results[idx];
+
+        fputs("    {\"container\": ", p_out);
+        write_json_string(p_out, p_result->p_container);
+        fputs(", \"workload\": ", p_out);
+        write_json_string(p_out, p_result->p_workload);
+        fprintf(p_out, ", \"n\": %u, \"ops\": %llu, \"ns_per_op\": "
+                "{\"min\": %.4f, \"median\": %.4f, \"mean\": %.4f, "
+                "\"stddev\": %.4f}, \"tsc_per_op\": ",
+                p_result->n, (unsigned long long)p_result->ops,
+                p_result->ns_per_op.min, p_result->ns_per_op.median,
+                p_result->ns_per_op.mean, p_result->ns_per_op.stddev);
+        write_json_number(p_out, p_result->tsc_per_op);
+        for (uint32_t counter = 0; counter < COUNTER_COUNT; counter++)
+        {
+            fprintf(p_out, ", \"%s\": ", g_counter_names[counter]);
+            write_json_number(p_out, p_result->counter_per_op[counter]);
+        }
+        for (uint32_t figure = 0; figure < MEMORY_COUNT; figure++)
+        {
+            fprintf(p_out, ", \"%s\": ", g_memory_names[figure]);
+            write_json_number(p_out, p_result->memory[figure]);
+        }
+        fprintf(p_out, "}%s\n",
+                ((idx + 1) < p_bench->result_count) ? "," : "");
+    }
+
+    fputs("  ]\n}\n", p_out);
+}
+
+/*!
+ * @brief Writes one header line and one line per result. Metadata goes in
+ *        leading "# " comment lines; unavailable figures are empty.
+ */
+static void
+write_csv(bench_t * p_bench)
+{
+    FILE * p_out = p_bench->p_output;
+
+    fprintf(p_out, "# schema=%d timestamp=%s pinned_cpu=%d warmup=%u "
+            "reps=%u seed=%llu\n", BENCH_SCHEMA_VERSION, p_bench->timestamp,
+            p_bench->pinned_cpu, p_bench->options.warmup,
+            p_bench->options.reps, (unsigned long long)p_bench->options.seed);
+    fputs("container,workload,n,ops,ns_min,ns_median,ns_mean,ns_stddev,"
+          "tsc_per_op", p_out);
+    for (uint32_t idx = 0; idx < COUNTER_COUNT; idx++)
+    {
+        fprintf(p_out, ",%s", g_counter_names[idx]);
+    }
+    for (uint32_t idx = 0; idx < MEMORY_COUNT; idx++)
+    {
+        fprintf(p_out, ",%s", g_memory_names[idx]);
+    }
+    fputc('\n', p_out);
+
+    for (size_t idx = 0; idx < p_bench->result_count; idx++)
+    {
+        const bench_result_t * p_result = &p_bench->p_results[idx];
+        double figures[1 + COUNTER_COUNT + MEMORY_COUNT]
+            = { p_result->tsc_per_op };
+
+        memcpy(figures + 1, p_result->counter_per_op,
+               sizeof(p_result->counter_per_op));
+        memcpy(figures + 1 + COUNTER_COUNT, p_result->memory,
+               sizeof(p_result->memory));
+
+        fprintf(p_out, "%s,%s,%u,%llu,%.4f,%.4f,%.4f,%.4f",
+                p_result->p_container, p_result->p_workload, p_result->n,
+                (unsigned long long)p_result->ops, p_result->ns_per_op.min,
+                p_result->ns_per_op.median, p_result->ns_per_op.mean,
+                p_result->ns_per_op.stddev);
+        for (uint32_t figure = 0; figure < (1 + COUNTER_COUNT + MEMORY_COUNT);
+             figure++)
+        {
+            if (figures[figure] < 0.0)
+            {
+                fputc(',', p_out);
+            }
+            else
+            {
+                fprintf(p_out, ",%.4f", figures[figure]);
+            }
+        }
+        fputc('\n', p_out);
+    }
+}
+
+/*** end of file ***/
@@ -0,0 +1,151 @@
+/** @file bench.h
+ *
+ * @brief Microbenchmark harness with repeatable, machine-readable results.
+ *
+ * A benchmark case is a setup, a timed run and a teardown. For each case
+ * and size n the harness performs the warmup runs, then the timed runs,
+ * with fresh state from setup every time. Each run is timed with
+ * clock_gettime(CLOCK_MONOTONIC), with the time-stamp counter on x86, and
+ * with cycles, cache misses and branch misses from perf_event_open() when
+ * the kernel allows it. The process is pinned to one CPU first.
+ *
+ * After the timed runs, one more untimed run gives the case an
+ * alloc_tracker_t allocator (see allocator.h) and records the bytes live
+ * after setup, the peak bytes, the allocations per operation and the bytes
+ * teardown failed to free. Those figures do not depend on timing, so a
+ * change in them is a real change in the container's memory behaviour.
+ *
+ * Inputs are generated from the options' seed mixed with the case name
+ * and n, so a case always sees the same data no matter which other cases
+ * are run. Results are written as JSON or CSV when the harness finishes;
+ * bench_compare.py compares two such files.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "allocator.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define BENCH_SUCCESS        (0)
+#define BENCH_SKIPPED        (1)  /* Filtered out or n above the case's max */
+#define BENCH_ERROR_PARAM    (-1)
+#define BENCH_ERROR_MEMORY   (-2)
+#define BENCH_ERROR_IO       (-3)
+#define BENCH_ERROR_SETUP    (-4)  /* The case's setup returned NULL */
+
+#define BENCH_MAX_REPS       (1000u)
+#define BENCH_SCHEMA_VERSION (2)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef enum
+{
+    BENCH_FORMAT_JSON,
+    BENCH_FORMAT_CSV
+} bench_format_t;
+
+typedef struct
+{
+    uint32_t       warmup;   /* Untimed runs before the timed ones */
+    uint32_t       reps;     /* Timed runs per case and size */
+    int            cpu;      /* CPU to pin to; -1 for the first allowed */
+    uint64_t       seed;     /* Base seed for every case's input */
+    bench_format_t format;
+    const char *   p_filter; /* Only "container/workload" names containing
+                                this; NULL for all */
+} bench_options_t;
+
+/* One workload on one container */
+typedef struct
+{
+    const char * p_container;
+    const char * p_workload;
+    uint32_t     max_n; /* Largest n worth running; 0 for no limit */
+
+    /* Untimed: builds the state for one run of size n; the containers'
+       own memory must come from p_alloc */
+    void * (*setup_fn)(uint32_t n, uint64_t seed, const allocator_t * p_alloc);
+
+    /* Timed: runs the workload and returns the number of operations */
+    uint64_t (*run_fn)(void * p_state);
+
+    /* Untimed: frees the state */
+    void (*teardown_fn)(void * p_state);
+} bench_case_t;
+
+/* Harness state and collected results */
+typedef struct bench bench_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Default options: 1 warmup, 5 reps, first allowed CPU, JSON.
+ *
+ * @return Options
+ */
+bench_options_t
+bench_options_default(void);
+
+/*!
+ * @brief Pins the process, opens the hardware counters and starts a report.
+ *
+ * Pinning or counters that are not available are recorded in the report's
+ * metadata rather than treated as errors.
+ *
+ * @param[in] p_options Options (copied)
+ * @param[in] p_output  Stream the report is written to by bench_finish()
+ *
+ * @return Pointer to the harness, or NULL on failure
+ */
+bench_t *
+bench_create(const bench_options_t * p_options, FILE * p_output);
+
+/*!
+ * @brief Measures one case at size n and records the result.
+ *
+ * @param[in,out] p_bench Harness
+ * @param[in]     p_case  Case
+ * @param[in]     n       Size passed to the case's setup
+ *
+ * @return BENCH_SUCCESS, BENCH_SKIPPED or a negative error code
+ */
+int
+bench_run(bench_t * p_bench, const bench_case_t * p_case, uint32_t n);
+
+/*!
+ * @brief Writes the report and frees the harness.
+ *
+ * @param[in,out] pp_bench Pointer to the harness pointer; set to NULL
+ *
+ * @return BENCH_SUCCESS or BENCH_ERROR_IO
+ */
+int
+bench_finish(bench_t ** pp_bench);
+
+/*!
+ * @brief Deterministic 64-bit generator (splitmix64) for case inputs.
+ *
+ * @param[in,out] p_state Generator state, seeded by the caller
+ *
+ * @return Next value
+ */
+uint64_t
+bench_random(uint64_t * p_state);
+
+#endif /* BENCH_H */
+
+/*** end of file ***/
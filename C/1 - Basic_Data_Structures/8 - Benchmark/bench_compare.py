@@ -0,0 +1,160 @@
+import argparse
+import csv
+import json
+import sys
+
+# Compares two basic_bench reports (JSON or CSV) case by case and flags
+# regressions. A case is (container, workload, n). With the default
+# metric, median ns/op, a case only counts as a regression when the new
+# median is more than --threshold percent above the baseline's AND even
+# the new run's fastest repetition is slower than the baseline median, so
+# one noisy repetition does not fail the comparison.
+#
+# The memory figures (schema 2 and later) are checked as well, whatever
+# --metric is: peak bytes and allocations per operation regress when they
+# grow by more than --memory-threshold percent, and any leaked bytes in the
+# new report count as a regression. They come from one deterministic run,
+# so no noise guard applies.
+#
+# Usage: python3 bench_compare.py base.json new.json [--threshold 5]
+#                                 [--metric ns_median]
+#                                 [--memory-threshold 1]
+# Exits with status 1 when anything regressed.
+
+METRICS = ("ns_median", "ns_mean", "tsc_per_op", "cycles_per_op",
+           "cache_misses_per_op", "branch_misses_per_op")
+
+MEMORY_METRICS = ("live_bytes", "peak_bytes", "allocs_per_op",
+                  "leaked_bytes")
+
+# Memory figures compared between the reports; leaked_bytes is checked on
+# its own
+MEMORY_CHECKED = ("peak_bytes", "allocs_per_op")
+
+# Metadata that should match for the numbers to be comparable
+SAME_META = ("cpu_model", "compiler", "reps", "seed")
+
+
+def from_json(handle):
+    report = json.load(handle)
+    cases = {}
+    for row in report["results"]:
+        key = (row["container"], row["workload"], row["n"])
+        figures = {name: row.get(name)
+                   for name in METRICS[2:] + MEMORY_METRICS}
+        figures["ns_min"] = row["ns_per_op"]["min"]
+        figures["ns_median"] = row["ns_per_op"]["median"]
+        figures["ns_mean"] = row["ns_per_op"]["mean"]
+        cases[key] = figures
+    return report.get("meta", {}), cases
+
+
+def from_csv(handle):
+    meta = {}
+    lines = []
+    for line in handle:
+        if line.startswith("#"):
+            for pair in line[1:].split():
+                name, _, value = pair.partition("=")
+                meta[name] = value
+        else:
+            lines.append(line)
+
+    cases = {}
+    for row in csv.DictReader(lines):
+        key = (row["container"], row["workload"], int(row["n"]))
+        cases[key] = {name: float(value) if value else None
+                      for name, value in row.items()
+                      if name.startswith(("ns_", "tsc", "cycles",
+                                          "cache", "branch"))
+                      or name in MEMORY_METRICS}
+    return meta, cases
+
+
+def load(path):
+    with open(path) as handle:
+        if path.endswith(".csv"):
+            return from_csv(handle)
+        return from_json(handle)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare two basic_bench reports")
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percent slowdown that counts (default 5)")
+    parser.add_argument("--metric", choices=METRICS, default="ns_median")
+    parser.add_argument("--memory-threshold", type=float, default=1.0,
+                        help="percent growth in peak bytes or allocations "
+                             "per op that counts (default 1)")
+    args = parser.parse_args()
+
+    base_meta, base = load(args.base)
+    new_meta, new = load(args.new)
+
+    for name in SAME_META:
+        if str(base_meta.get(name)) != str(new_meta.get(name)):
+            print(f"warning: {name} differs: {base_meta.get(name)!r} vs "
+                  f"{new_meta.get(name)!r}")
+
+    limit = 1.0 + args.threshold / 100.0
+    regressions = 0
+    print(f"{'case':<40} {'base':>12} {'new':>12} {'change':>9}")
+
+    for key in sorted(base.keys() & new.keys()):
+        old_value = base[key][args.metric]
+        new_value = new[key][args.metric]
+        if old_value is None or new_value is None or old_value <= 0.0:
+            continue
+
+        ratio = new_value / old_value
+        verdict = ""
+        if ratio > limit:
+            noisy = (args.metric == "ns_median"
+                     and new[key]["ns_min"] <= old_value)
+            verdict = "  noise?" if noisy else "  REGRESSION"
+            regressions += 0 if noisy else 1
+        elif ratio < 1.0 / limit:
+            verdict = "  faster"
+
+        label = f"{key[0]}/{key[1]} n={key[2]}"
+        print(f"{label:<40} {old_value:>12.2f} {new_value:>12.2f} "
+              f"{(ratio - 1.0) * 100.0:>+8.1f}%{verdict}")
+
+    memory_limit = 1.0 + args.memory_threshold / 100.0
+    memory_regressions = 0
+    for key in sorted(base.keys() & new.keys()):
+        label = f"{key[0]}/{key[1]} n={key[2]}"
+        leaked = new[key].get("leaked_bytes")
+        if leaked:
+            print(f"{label:<40} leaked {leaked:.0f} bytes  REGRESSION")
+            memory_regressions += 1
+
+        for name in MEMORY_CHECKED:
+            old_value = base[key].get(name)
+            new_value = new[key].get(name)
+            if old_value is None or new_value is None:
+                continue
+            if new_value > old_value * memory_limit and new_value > 0.0:
+                change = (f"{(new_value / old_value - 1.0) * 100.0:+.1f}%"
+                          if old_value > 0.0 else "new")
+                print(f"{label:<40} {name} {old_value:.4g} -> "
+                      f"{new_value:.4g} ({change})  REGRESSION")
+                memory_regressions += 1
+
+    for key in sorted(base.keys() - new.keys()):
+        print(f"only in {args.base}: {key[0]}/{key[1]} n={key[2]}")
+    for key in sorted(new.keys() - base.keys()):
+        print(f"only in {args.new}: {key[0]}/{key[1]} n={key[2]}")
+
+    print(f"\n{regressions} regression(s) above {args.threshold:g}% "
+          f"in {args.metric}")
+    print(f"{memory_regressions} memory regression(s) above "
+          f"{args.memory_threshold:g}% or leaks")
+    return 1 if regressions or memory_regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
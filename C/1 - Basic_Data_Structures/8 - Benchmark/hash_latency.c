@@ -0,0 +1,388 @@
+/** @file hash_latency.c
+ *
+ * @brief Lookup latency distribution: chained hash_table_t against the
+ *        Robin Hood hash_robin_t.
+ *
+ * Each table holds n keys and serves random lookups, half of them for
+ * keys that are not present. Every lookup is timed on its own, and the
+ * report gives the median, the 99th and 99.9th percentiles and the
+ * maximum, in nanoseconds, less the cost of reading the clock. The longest
+ * chain, or the longest Robin Hood probe, is given alongside.
+ *
+ * Two hash functions are used: a well-mixed one, and a weak one whose low
+ * WEAK_SHIFT bits are always zero, as an unlucky user hash might be. The
+ * chained table takes bucket numbers straight from the hash, so the weak
+ * hash leaves all but one bucket in 2^WEAK_SHIFT empty; hash_robin_t
+ * mixes the full hash before use.
+ *
+ * Build: make latency (see Makefile)
+ *
+ * Usage: hash_latency [n] [lookups]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench.h"
+#include "hash_robin.h"
+#include "hash_table.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LATENCY_HAVE_TSC (1)
+#else
+#define LATENCY_HAVE_TSC (0)
+#endif
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_N          (900000u)   /* 0.86 of 2^20 slots at load 0.9 */
+#define DEFAULT_LOOKUPS    (2000000u)
+#define WARMUP_LOOKUPS     (100000u)
+#define TIMER_SAMPLES      (100000u)
+#define CALIBRATE_NS       (100000000ull)
+#define NSEC_PER_SEC       (1000000000ull)
+#define WEAK_SHIFT         (4u)
+#define CHAINED_LOAD       (0.75f)
+#define SEED               (0x5eed2025u)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct
+{
+    const char * p_name;
+    uint32_t (*hash_function)(const void * p_key, uint32_t capacity);
+} hash_case_t;
+
+typedef struct
+{
+    const char * p_table;
+    float        load_factor; /* 0 for the chained table */
+} table_case_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static double            g_ticks_per_ns = 1.0;
+static volatile uint64_t g_sink;
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint64_t now_ns(void);
+static uint64_t ticks(void);
+static void     calibrate(void);
+static uint32_t mixed_hash(const void * p_key, uint32_t capacity);
+static uint32_t weak_hash(const void * p_key, uint32_t capacity);
+static bool     keys_equal(const void * p_lhs, const void * p_rhs);
+static int      compare_u64(const void * p_lhs, const void * p_rhs);
+static uint64_t timer_overhead(uint64_t * p_samples);
+static uint32_t longest_chain(const hash_table_t * p_table);
+static bool     run_case(const hash_case_t *  p_hash,
+                         const table_case_t * p_table,
+                         uint32_t *           p_keys,
+                         const uint32_t *     p_lookups,
+                         uint32_t             n,
+                         uint32_t             lookups,
+                         uint64_t *           p_samples);
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    static const hash_case_t hashes[] = {
+        { "mixed", mixed_hash },
+        { "weak",  weak_hash  },
+    };
+    static const table_case_t tables[] = {
+        { "hash_table", 0.0f  },
+        { "hash_robin", 0.75f },
+        { "hash_robin", 0.9f  },
+    };
+
+    uint32_t n       = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10)
+                                  : DEFAULT_N;
+    uint32_t lookups = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10)
+                                  : DEFAULT_LOOKUPS;
+    uint64_t seed    = SEED;
+
+    if ((0 == n) || (0 == lookups) || (n > (UINT32_MAX / 2u)))
+    {
+        fprintf(stderr, "usage: hash_latency [n] [lookups]\n");
+        return EXIT_FAILURE;
+    }
+
+    uint32_t * p_keys    = malloc(2u * (size_t)n * sizeof(uint32_t));
+    uint32_t * p_lookups = malloc((size_t)lookups * sizeof(uint32_t));
+    uint64_t * p_samples = malloc((size_t)((lookups > TIMER_SAMPLES)
+                                               ? lookups : TIMER_SAMPLES)
+                                  * sizeof(uint64_t));
+
+    if ((NULL == p_keys) || (NULL == p_lookups) || (NULL == p_samples))
+    {
+        fprintf(stderr, "out of memory\n");
+        free(p_keys);
+        free(p_lookups);
+        free(p_samples);
+        return EXIT_FAILURE;
+    }
+
+    // Keys 0 .. n-1 are stored; lookups draw from 0 .. 2n-1
+    for (uint32_t idx = 0; idx < (2u * n); idx++)
+    {
+        p_keys[idx] = idx;
+    }
+    for (uint32_t idx = 0; idx < lookups; idx++)
+    {
+        p_lookups[idx] = (uint32_t)(bench_random(&seed) % (2u * (uint64_t)n));
+    }
+
+    calibrate();
+    printf("%u keys, %u lookups (half misses), timer overhead %.1f ns\n\n",
+           n, lookups,
+           (double)timer_overhead(p_samples) / g_ticks_per_ns);
+    printf("%-6s %-11s %5s %9s %9s %9s %9s %8s\n", "hash", "table", "load",
+           "p50 ns", "p99 ns", "p99.9 ns", "max ns", "longest");
+
+    int status = EXIT_SUCCESS;
+
+    for (size_t hash = 0; hash < (sizeof(hashes) / sizeof(hashes[0])); hash++)
+    {
+        for (size_t table = 0; table < (sizeof(tables) / sizeof(tables[0]));
+             table++)
+        {
+            if (!run_case(&hashes[hash], &tables[table], p_keys, p_lookups,
+                          n, lookups, p_samples))
+            {
+                fprintf(stderr, "out of memory\n");
+                status = EXIT_FAILURE;
+            }
+        }
+    }
+
+    free(p_keys);
+    free(p_lookups);
+    free(p_samples);
+
+    return status;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+/*!
+ * @brief Reads the fastest clock there is: the TSC on x86, else the
+ *        monotonic clock in nanoseconds.
+ */
+static uint64_t
+ticks(void)
+{
+#if LATENCY_HAVE_TSC
+    return __rdtsc();
+#else
+    return now_ns();
+#endif
+}
+
+/*!
+ * @brief Measures ticks per nanosecond against the monotonic clock.
+ */
+static void
+calibrate(void)
+{
+    uint64_t start_ns    = now_ns();
+    uint64_t start_ticks = ticks();
+
+    while ((now_ns() - start_ns) < CALIBRATE_NS)
+    {
+        // Spin
+    }
+
+    g_ticks_per_ns = (double)(ticks() - start_ticks)
+                     / (double)(now_ns() - start_ns);
+}
+
+static uint32_t
+mixed_hash(const void * p_key, uint32_t capacity)
+{
+    uint32_t hash = *(const uint32_t *)p_key * 0x9e3779b1u;
+    return (hash ^ (hash >> 16)) % capacity;
+}
+
+/* Distinct hashes, but the low WEAK_SHIFT bits are always zero */
+static uint32_t
+weak_hash(const void * p_key, uint32_t capacity)
+{
+    return (*(const uint32_t *)p_key << WEAK_SHIFT) % capacity;
+}
+
+static bool
+keys_equal(const void * p_lhs, const void * p_rhs)
+{
+    return *(const uint32_t *)p_lhs == *(const uint32_t *)p_rhs;
+}
+
+static int
+compare_u64(const void * p_lhs, const void * p_rhs)
+{
+    uint64_t lhs = *(const uint64_t *)p_lhs;
+    uint64_t rhs = *(const uint64_t *)p_rhs;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/*!
+ * @brief Median ticks between two back-to-back clock reads.
+ */
+static uint64_t
+timer_overhead(uint64_t * p_samples)
+{
+    for (uint32_t idx = 0; idx < TIMER_SAMPLES; idx++)
+    {
+        uint64_t start = ticks();
+        p_samples[idx] = ticks() - start;
+    }
+    qsort(p_samples, TIMER_SAMPLES, sizeof(uint64_t), compare_u64);
+
+    return p_samples[TIMER_SAMPLES / 2u];
+}
+
+static uint32_t
+longest_chain(const hash_table_t * p_table)
+{
+    uint32_t longest = 0;
+
+    for (uint32_t bucket = 0; bucket < p_table->capacity; bucket++)
+    {
+        uint32_t length = 0;
+
+        for (const hash_entry_t * p_entry = p_table->pp_buckets[bucket];
+             NULL != p_entry;
+             p_entry = p_entry->p_next)
+        {
+            length++;
+        }
+        if (length > longest)
+        {
+            longest = length;
+        }
+    }
+
+    return longest;
+}
+
+/*!
+ * @brief Fills one table, times every lookup and prints a report line.
+ *
+ * @return false if the table could not be built
+ */
+static bool
+run_case(const hash_case_t *  p_hash,
+         const table_case_t * p_table,
+         uint32_t *           p_keys,
+         const uint32_t *     p_lookups,
+         uint32_t             n,
+         uint32_t             lookups,
+         uint64_t *           p_samples)
+{
+    bool         b_chained = (0.0f >= p_table->load_factor);
+    hash_table_t chained;
+    hash_robin_t robin;
+    uint32_t     longest = 0;
+    uint64_t     overhead = timer_overhead(p_samples);
+
+    if (b_chained
+            ? !hash_table_init(&chained, 0, CHAINED_LOAD, p_hash->hash_function,
+                               keys_equal, NULL, NULL)
+            : !hash_robin_init(&robin, 0, p_table->load_factor,
+                               p_hash->hash_function, keys_equal, NULL, NULL))
+    {
+        return false;
+    }
+
+    for (uint32_t idx = 0; idx < n; idx++)
+    {
+        if (b_chained)
+        {
+            hash_table_put(&chained, &p_keys[idx], &p_keys[idx]);
+        }
+        else
+        {
+            hash_robin_put(&robin, &p_keys[idx], &p_keys[idx]);
+        }
+    }
+
+    // Untimed pass to fault in the table and train the branch predictors
+    for (uint32_t idx = 0; (idx < lookups) && (idx < WARMUP_LOOKUPS); idx++)
+    {
+        uint32_t * p_key = &p_keys[p_lookups[idx]];
+        void *     p_hit = b_chained ? hash_table_get(&chained, p_key)
+                                     : hash_robin_get(&robin, p_key);
+        g_sink += (NULL != p_hit);
+    }
+
+    for (uint32_t idx = 0; idx < lookups; idx++)
+    {
+        uint32_t * p_key = &p_keys[p_lookups[idx]];
+        uint64_t   start = ticks();
+        void *     p_hit = b_chained ? hash_table_get(&chained, p_key)
+                                     : hash_robin_get(&robin, p_key);
+        p_samples[idx]   = ticks() - start;
+        g_sink += (NULL != p_hit);
+    }
+
+    qsort(p_samples, lookups, sizeof(uint64_t), compare_u64);
+
+    if (b_chained)
+    {
+        longest = longest_chain(&chained);
+        hash_table_destroy(&chained, false);
+    }
+    else
+    {
+        longest = hash_robin_max_probe(&robin);
+        hash_robin_destroy(&robin, false);
+    }
+
+    double percentile[4];
+    size_t rank[4] = { lookups / 2u,
+                       (size_t)((uint64_t)lookups * 990u / 1000u),
+                       (size_t)((uint64_t)lookups * 999u / 1000u),
+                       lookups - 1u };
+
+    for (size_t idx = 0; idx < 4u; idx++)
+    {
+        uint64_t value = p_samples[rank[idx]];
+        value          = (value > overhead) ? (value - overhead) : 0;
+        percentile[idx] = (double)value / g_ticks_per_ns;
+    }
+
+    printf("%-6s %-11s %5.2f %9.1f %9.1f %9.1f %9.1f %8u\n", p_hash->p_name,
+           p_table->p_table, b_chained ? CHAINED_LOAD : p_table->load_factor,
+           percentile[0], percentile[1], percentile[2], percentile[3],
+           longest);
+
+    return true;
+}
+
+/*** end of file ***/
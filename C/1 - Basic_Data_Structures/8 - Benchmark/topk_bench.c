@@ -0,0 +1,421 @@
+/** @file topk_bench.c
+ *
+ * @brief Finding the k largest of n keys: full sort, unbounded heap,
+ *        bounded top-k heap, selection and partial sort.
+ *
+ * n random 32-bit keys are held as an array of pointers, as the
+ * containers hold them. For each k the k largest are found by:
+ *
+ * - sort:     qsort() of the whole array, the k at its end taken;
+ * - heap:     all n inserted into an unbounded max-heap_t, k extracted;
+ * - topk:     each key offered to a k-element heap_t with
+ *             heap_topk_stream(), which drops most at the root compare;
+ * - parallel: topk over THREADS slices at once, one heap per thread,
+ *             combined with heap_topk_merge();
+ * - nth:      dynamic_array_nth_element(), the k unordered;
+ * - partial:  dynamic_array_partial_sort(), the k in order.
+ *
+ * Each method runs REPEATS times on the same keys and the fastest run is
+ * reported, with its speed-up over sort. sort, nth and partial reorder
+ * the array, which is refilled outside the timing. Every result is
+ * checked against sort's: the same k-th largest key and the same sum.
+ *
+ * Build: make topk (see Makefile)
+ *
+ * Usage: topk_bench [n] [threads] [k ...]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dynamic_array.h"
+#include "heap.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_N        (10000000u)
+#define DEFAULT_THREADS  (4u)
+#define MAX_THREADS      (64u)
+#define REPEATS          (3u)
+#define NSEC_PER_SEC     (1000000000ull)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef enum
+{
+    METHOD_SORT,
+    METHOD_HEAP,
+    METHOD_TOPK,
+    METHOD_PARALLEL,
+    METHOD_NTH,
+    METHOD_PARTIAL,
+    METHOD_COUNT
+} method_t;
+
+/* What a method found: enough to tell a wrong answer */
+typedef struct
+{
+    uint32_t kth;  /* The k-th largest key */
+    uint64_t sum;  /* Sum of the k largest */
+} result_t;
+
+typedef struct
+{
+    uint32_t first;
+    uint32_t count;
+    uint32_t k;
+    heap_t   heap;
+    bool     b_ok;
+} slice_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const char * const g_method_names[METHOD_COUNT] = {
+    "sort", "heap", "topk", "parallel", "nth", "partial"
+};
+
+/* Values of k when none are given */
+static const uint32_t g_default_k[] = { 10u, 100u, 1000u, 10000u };
+
+static uint32_t *      g_p_keys;
+static void **         g_pp_order; /* Pointers into g_p_keys, as generated */
+static uint32_t        g_n;
+static uint32_t        g_threads;
+static dynamic_array_t g_array;
+
+static slice_t         g_slices[MAX_THREADS];
+static pthread_t       g_workers[MAX_THREADS];
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static int32_t  compare_ascending(const void * p_data1, const void * p_data2);
+static int32_t  compare_descending(const void * p_data1, const void * p_data2);
+static int      compare_qsort(const void * p_data1, const void * p_data2);
+static bool     run(method_t method, uint32_t k, result_t * p_result);
+static void *   topk_slice(void * p_arg);
+static result_t sum_range(void * const * pp_data, uint32_t count);
+static uint64_t now_ns(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    g_n       = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_N;
+    g_threads = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10)
+                           : DEFAULT_THREADS;
+
+    if ((0u == g_n) || (0u == g_threads) || (g_threads > MAX_THREADS))
+    {
+        fprintf(stderr, "usage: topk_bench [n] [threads 1-%u] [k ...]\n",
+                MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    g_p_keys   = malloc((size_t)g_n * sizeof(uint32_t));
+    g_pp_order = malloc((size_t)g_n * sizeof(void *));
+
+    if ((NULL == g_p_keys) || (NULL == g_pp_order)
+        || !dynamic_array_init(&g_array, g_n, 2.0f))
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // xorshift keys: the same on every run
+    uint32_t state = 2463534242u;
+
+    for (uint32_t idx = 0; idx < g_n; idx++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        g_p_keys[idx]   = state;
+        g_pp_order[idx] = &g_p_keys[idx];
+    }
+
+    g_array.size = g_n;
+
+    printf("n = %u, %u threads for parallel\n\n", g_n, g_threads);
+    printf("%8s  %-9s %10s %9s\n", "k", "method", "ms", "vs sort");
+
+    int first  = 3;
+    int last   = argc;
+    int status = EXIT_SUCCESS;
+
+    if (argc <= 3)
+    {
+        first = 0;
+        last  = (int)(sizeof(g_default_k) / sizeof(g_default_k[0]));
+    }
+
+    for (int arg = first; arg < last; arg++)
+    {
+        uint32_t k = (argc <= 3) ? g_default_k[arg]
+                                 : (uint32_t)strtoul(argv[arg], NULL, 10);
+
+        if ((0u == k) || (k > g_n))
+        {
+            printf("%8u  skipped: k must be 1 to n\n", k);
+            continue;
+        }
+
+        result_t expected = { 0u, 0u };
+        double   sort_ms  = 0.0;
+
+        for (int method = 0; method < (int)METHOD_COUNT; method++)
+        {
+            uint64_t best_ns = UINT64_MAX;
+            result_t result  = { 0u, 0u };
+            bool     b_ok    = true;
+
+            for (uint32_t rep = 0; b_ok && (rep < REPEATS); rep++)
+            {
+                // Methods that reorder the array start from the keys as made
+                memcpy(g_array.pp_data, g_pp_order,
+                       (size_t)g_n * sizeof(void *));
+
+                uint64_t start_ns = now_ns();
+                b_ok              = run((method_t)method, k, &result);
+                uint64_t run_ns   = now_ns() - start_ns;
+
+                best_ns = (run_ns < best_ns) ? run_ns : best_ns;
+            }
+
+            if (METHOD_SORT == method)
+            {
+                expected = result;
+                sort_ms  = (double)best_ns / 1e6;
+            }
+
+            b_ok = b_ok && (result.kth == expected.kth)
+                   && (result.sum == expected.sum);
+
+            printf("%8u  %-9s %10.2f %8.1fx%s\n", k, g_method_names[method],
+                   (double)best_ns / 1e6, sort_ms / ((double)best_ns / 1e6),
+                   b_ok ? "" : "  WRONG");
+            status = b_ok ? status : EXIT_FAILURE;
+        }
+    }
+
+    dynamic_array_destroy(&g_array, false);
+    free(g_pp_order);
+    free(g_p_keys);
+
+    return status;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static int32_t
+compare_ascending(const void * p_data1, const void * p_data2)
+{
+    uint32_t key1 = *(const uint32_t *)p_data1;
+    uint32_t key2 = *(const uint32_t *)p_data2;
+
+    return (key1 > key2) - (key1 < key2);
+}
+
+static int32_t
+compare_descending(const void * p_data1, const void * p_data2)
+{
+    return compare_ascending(p_data2, p_data1);
+}
+
+/* qsort() hands over pointers to the array's elements */
+static int
+compare_qsort(const void * p_data1, const void * p_data2)
+{
+    return compare_ascending(*(void * const *)p_data1,
+                             *(void * const *)p_data2);
+}
+
+/*!
+ * @brief Finds the k largest keys one way.
+ *
+ * @param[in]  method   How to find them
+ * @param[in]  k        How many to find
+ * @param[out] p_result The k-th largest and the sum of the k
+ *
+ * @return true on success, false if memory ran out
+ */
+static bool
+run(method_t method, uint32_t k, result_t * p_result)
+{
+    void ** pp_data = g_array.pp_data;
+    heap_t  heap;
+    bool    b_ok    = true;
+
+    switch (method)
+    {
+        case METHOD_SORT:
+            qsort(pp_data, g_n, sizeof(void *), compare_qsort);
+            *p_result = sum_range(pp_data + (g_n - k), k);
+            break;
+
+        case METHOD_HEAP:
+            // Grows as the keys go in, as an unbounded heap does
+            if (!heap_init(&heap, 16u, 2.0f, compare_descending))
+            {
+                return false;
+            }
+
+            for (uint32_t idx = 0; b_ok && (idx < g_n); idx++)
+            {
+                b_ok = heap_insert(&heap, g_pp_order[idx]);
+            }
+
+            // The k extracted overwrite the front of the array
+            for (uint32_t idx = 0; b_ok && (idx < k); idx++)
+            {
+                pp_data[idx] = heap_extract_top(&heap);
+            }
+
+            *p_result = sum_range(pp_data, k);
+            heap_destroy(&heap, false);
+            break;
+
+        case METHOD_TOPK:
+        case METHOD_PARALLEL:
+        {
+            uint32_t threads = (METHOD_TOPK == method) ? 1u : g_threads;
+            uint32_t share   = g_n / threads;
+
+            for (uint32_t id = 0; id < threads; id++)
+            {
+                g_slices[id].first = id * share;
+                g_slices[id].count = (id + 1u == threads) ? g_n - (id * share)
+                                                          : share;
+                g_slices[id].k     = k;
+            }
+
+            if (1u == threads)
+            {
+                (void)topk_slice(&g_slices[0]);
+            }
+            else
+            {
+                for (uint32_t id = 0; id < threads; id++)
+                {
+                    (void)pthread_create(&g_workers[id], NULL, topk_slice,
+                                         &g_slices[id]);
+                }
+
+                for (uint32_t id = 0; id < threads; id++)
+                {
+                    (void)pthread_join(g_workers[id], NULL);
+                }
+            }
+
+            for (uint32_t id = 0; id < threads; id++)
+            {
+                b_ok = b_ok && g_slices[id].b_ok;
+            }
+
+            // The heaps are combined on this thread, after the scan
+            for (uint32_t id = 1u; b_ok && (id < threads); id++)
+            {
+                b_ok = heap_topk_merge(&g_slices[0].heap, k,
+                                       &g_slices[id].heap);
+            }
+
+            if (b_ok)
+            {
+                memcpy(pp_data, g_slices[0].heap.pp_data, k * sizeof(void *));
+                *p_result = sum_range(pp_data, k);
+            }
+
+            for (uint32_t id = 0; id < threads; id++)
+            {
+                if (g_slices[id].b_ok)
+                {
+                    heap_destroy(&g_slices[id].heap, false);
+                }
+            }
+
+            break;
+        }
+
+        case METHOD_NTH:
+            b_ok      = dynamic_array_nth_element(&g_array, k - 1u,
+                                                  compare_descending);
+            *p_result = sum_range(pp_data, k);
+            break;
+
+        case METHOD_PARTIAL:
+            b_ok      = dynamic_array_partial_sort(&g_array, k,
+                                                   compare_descending);
+            *p_result = sum_range(pp_data, k);
+            break;
+
+        default:
+            b_ok = false;
+            break;
+    }
+
+    return b_ok;
+}
+
+/* One thread's share of a top-k scan, into a heap of its own */
+static void *
+topk_slice(void * p_arg)
+{
+    slice_t * p_slice = p_arg;
+    uint32_t  last    = p_slice->first + p_slice->count;
+
+    p_slice->b_ok = heap_init(&p_slice->heap, p_slice->k, 2.0f,
+                              compare_ascending);
+
+    for (uint32_t idx = p_slice->first; p_slice->b_ok && (idx < last); idx++)
+    {
+        p_slice->b_ok = heap_topk_stream(&p_slice->heap, p_slice->k,
+                                         g_pp_order[idx], NULL);
+    }
+
+    return NULL;
+}
+
+/* The least key of a range and the sum of its keys */
+static result_t
+sum_range(void * const * pp_data, uint32_t count)
+{
+    result_t result = { UINT32_MAX, 0u };
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        uint32_t key = *(const uint32_t *)pp_data[idx];
+
+        result.kth = (key < result.kth) ? key : result.kth;
+        result.sum += key;
+    }
+
+    return result;
+}
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+/*** end of file ***/
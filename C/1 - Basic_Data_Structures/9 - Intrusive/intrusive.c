@@ -0,0 +1,647 @@
+/** @file intrusive.c
+ *
+ * @brief Intrusive list, binary search tree and pairing heap.
+ *
+ * The heap keeps the root's children as a sibling list. Extracting the top
+ * melds those children pairwise left to right, then melds the pairs into
+ * one tree right to left (the two-pass pairing), which is what keeps the
+ * amortised cost logarithmic. Both passes are loops, so deep heaps use no
+ * stack.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <string.h>
+#include "intrusive.h"
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void          link_between(ilist_t *     p_list,
+                                  list_hook_t * p_prev,
+                                  list_hook_t * p_hook,
+                                  list_hook_t * p_next);
+static void          unlink_hook(ilist_t * p_list, list_hook_t * p_hook);
+static bst_hook_t *  subtree_min(bst_hook_t * p_hook);
+static bst_hook_t *  subtree_max(bst_hook_t * p_hook);
+static void          transplant(ibst_t *     p_tree,
+                                bst_hook_t * p_old,
+                                bst_hook_t * p_new);
+static heap_hook_t * meld(const iheap_t * p_heap,
+                          heap_hook_t *   p_lhs,
+                          heap_hook_t *   p_rhs);
+static heap_hook_t * merge_pairs(const iheap_t * p_heap,
+                                 heap_hook_t *   p_first);
+static void          cut(heap_hook_t * p_hook);
+
+/*************************************************************************
+ * Public Functions: list
+ *************************************************************************/
+
+void
+list_hook_init(list_hook_t * p_hook)
+{
+    if (NULL != p_hook)
+    {
+        memset(p_hook, 0, sizeof(*p_hook));
+    }
+}
+
+bool
+ilist_init(ilist_t * p_list)
+{
+    if (NULL == p_list)
+    {
+        return false;
+    }
+
+    p_list->head.p_next = &p_list->head;
+    p_list->head.p_prev = &p_list->head;
+    p_list->size        = 0;
+
+    return true;
+}
+
+bool
+ilist_push_front(ilist_t * p_list, list_hook_t * p_hook)
+{
+    if ((NULL == p_list) || (NULL == p_hook) || ilist_is_linked(p_hook))
+    {
+        return false;
+    }
+
+    link_between(p_list, &p_list->head, p_hook, p_list->head.p_next);
+    return true;
+}
+
+bool
+ilist_push_back(ilist_t * p_list, list_hook_t * p_hook)
+{
+    if ((NULL == p_list) || (NULL == p_hook) || ilist_is_linked(p_hook))
+    {
+        return false;
+    }
+
+    link_between(p_list, p_list->head.p_prev, p_hook, &p_list->head);
+    return true;
+}
+
+list_hook_t *
+ilist_pop_front(ilist_t * p_list)
+{
+    list_hook_t * p_hook = ilist_front(p_list);
+
+    if (NULL != p_hook)
+    {
+        unlink_hook(p_list, p_hook);
+    }
+    return p_hook;
+}
+
+list_hook_t *
+ilist_pop_back(ilist_t * p_list)
+{
+    list_hook_t * p_hook = ilist_back(p_list);
+
+    if (NULL != p_hook)
+    {
+        unlink_hook(p_list, p_hook);
+    }
+    return p_hook;
+}
+
+bool
+ilist_remove(ilist_t * p_list, list_hook_t * p_hook)
+{
+    if ((NULL == p_list) || (NULL == p_hook) || !ilist_is_linked(p_hook))
+    {
+        return false;
+    }
+
+    unlink_hook(p_list, p_hook);
+    return true;
+}
+
+list_hook_t *
+ilist_front(const ilist_t * p_list)
+{
+    if ((NULL == p_list) || (0 == p_list->size))
+    {
+        return NULL;
+    }
+    return p_list->head.p_next;
+}
+
+list_hook_t *
+ilist_back(const ilist_t * p_list)
+{
+    if ((NULL == p_list) || (0 == p_list->size))
+    {
+        return NULL;
+    }
+    return p_list->head.p_prev;
+}
+
+list_hook_t *
+ilist_next(const ilist_t * p_list, const list_hook_t * p_hook)
+{
+    if ((NULL == p_list) || (NULL == p_hook)
+        || (p_hook->p_next == &p_list->head))
+    {
+        return NULL;
+    }
+    return p_hook->p_next;
+}
+
+uint32_t
+ilist_size(const ilist_t * p_list)
+{
+    return (NULL == p_list) ? 0 : p_list->size;
+}
+
+bool
+ilist_is_empty(const ilist_t * p_list)
+{
+    return (0 == ilist_size(p_list));
+}
+
+bool
+ilist_is_linked(const list_hook_t * p_hook)
+{
+    return (NULL != p_hook) && (NULL != p_hook->p_next);
+}
+
+/*************************************************************************
+ * Public Functions: binary search tree
+ *************************************************************************/
+
+void
+bst_hook_init(bst_hook_t * p_hook)
+{
+    if (NULL != p_hook)
+    {
+        memset(p_hook, 0, sizeof(*p_hook));
+    }
+}
+
+bool
+ibst_init(ibst_t * p_tree, ibst_compare_func_t compare_fn)
+{
+    if ((NULL == p_tree) || (NULL == compare_fn))
+    {
+        return false;
+    }
+
+    p_tree->p_root     = NULL;
+    p_tree->size       = 0;
+    p_tree->compare_fn = compare_fn;
+
+    return true;
+}
+
+bool
+ibst_insert(ibst_t * p_tree, bst_hook_t * p_hook)
+{
+    if ((NULL == p_tree) || (NULL == p_hook))
+    {
+        return false;
+    }
+
+    bst_hook_t *  p_parent = NULL;
+    bst_hook_t ** pp_link  = &p_tree->p_root;
+
+    while (NULL != *pp_link)
+    {
+        int32_t order = p_tree->compare_fn(p_hook, *pp_link);
+
+        if (0 == order)
+        {
+            return false;
+        }
+        p_parent = *pp_link;
+        pp_link  = (order < 0) ? &p_parent->p_left : &p_parent->p_right;
+    }
+
+    p_hook->p_left   = NULL;
+    p_hook->p_right  = NULL;
+    p_hook->p_parent = p_parent;
+    *pp_link         = p_hook;
+    p_tree->size++;
+
+    return true;
+}
+
+bst_hook_t *
+ibst_search(const ibst_t * p_tree, const bst_hook_t * p_probe)
+{
+    if ((NULL == p_tree) || (NULL == p_probe))
+    {
+        return NULL;
+    }
+
+    bst_hook_t * p_current = p_tree->p_root;
+
+    while (NULL != p_current)
+    {
+        int32_t order = p_tree->compare_fn(p_probe, p_current);
+
+        if (0 == order)
+        {
+            break;
+        }
+        p_current = (order < 0) ? p_current->p_left : p_current->p_right;
+    }
+
+    return p_current;
+}
+
+bool
+ibst_remove(ibst_t * p_tree, bst_hook_t * p_hook)
+{
+    if ((NULL == p_tree) || (NULL == p_hook) || (0 == p_tree->size))
+    {
+        return false;
+    }
+
+    if (NULL == p_hook->p_left)
+    {
+        transplant(p_tree, p_hook, p_hook->p_right);
+    }
+    else if (NULL == p_hook->p_right)
+    {
+        transplant(p_tree, p_hook, p_hook->p_left);
+    }
+    else
+    {
+        // Two children: the successor takes the element's place
+        bst_hook_t * p_next = subtree_min(p_hook->p_right);
+
+        if (p_next->p_parent != p_hook)
+        {
+            transplant(p_tree, p_next, p_next->p_right);
+            p_next->p_right           = p_hook->p_right;
+            p_next->p_right->p_parent = p_next;
+        }
+        transplant(p_tree, p_hook, p_next);
+        p_next->p_left           = p_hook->p_left;
+        p_next->p_left->p_parent = p_next;
+    }
+
+    bst_hook_init(p_hook);
+    p_tree->size--;
+
+    return true;
+}
+
+bst_hook_t *
+ibst_first(const ibst_t * p_tree)
+{
+    return (NULL == p_tree) ? NULL : subtree_min(p_tree->p_root);
+}
+
+bst_hook_t *
+ibst_last(const ibst_t * p_tree)
+{
+    return (NULL == p_tree) ? NULL : subtree_max(p_tree->p_root);
+}
+
+bst_hook_t *
+ibst_next(const bst_hook_t * p_hook)
+{
+    if (NULL == p_hook)
+    {
+        return NULL;
+    }
+    if (NULL != p_hook->p_right)
+    {
+        return subtree_min(p_hook->p_right);
+    }
+
+    // Climb until we come up from a left child
+    bst_hook_t * p_parent = p_hook->p_parent;
+    while ((NULL != p_parent) && (p_hook == p_parent->p_right))
+    {
+        p_hook   = p_parent;
+        p_parent = p_parent->p_parent;
+    }
+
+    return p_parent;
+}
+
+uint32_t
+ibst_size(const ibst_t * p_tree)
+{
+    return (NULL == p_tree) ? 0 : p_tree->size;
+}
+
+bool
+ibst_is_empty(const ibst_t * p_tree)
+{
+    return (0 == ibst_size(p_tree));
+}
+
+/*************************************************************************
+ * Public Functions: heap
+ *************************************************************************/
+
+void
+heap_hook_init(heap_hook_t * p_hook)
+{
+    if (NULL != p_hook)
+    {
+        memset(p_hook, 0, sizeof(*p_hook));
+    }
+}
+
+bool
+iheap_init(iheap_t * p_heap, iheap_compare_func_t compare_fn)
+{
+    if ((NULL == p_heap) || (NULL == compare_fn))
+    {
+        return false;
+    }
+
+    p_heap->p_root     = NULL;
+    p_heap->size       = 0;
+    p_heap->compare_fn = compare_fn;
+
+    return true;
+}
+
+bool
+iheap_insert(iheap_t * p_heap, heap_hook_t * p_hook)
+{
+    if ((NULL == p_heap) || (NULL == p_hook) || iheap_contains(p_heap, p_hook))
+    {
+        return false;
+    }
+
+    heap_hook_init(p_hook);
+    p_heap->p_root = (NULL == p_heap->p_root)
+                         ? p_hook
+                         : meld(p_heap, p_heap->p_root, p_hook);
+    p_heap->size++;
+
+    return true;
+}
+
+heap_hook_t *
+iheap_peek_top(const iheap_t * p_heap)
+{
+    return (NULL == p_heap) ? NULL : p_heap->p_root;
+}
+
+heap_hook_t *
+iheap_extract_top(iheap_t * p_heap)
+{
+    if ((NULL == p_heap) || (NULL == p_heap->p_root))
+    {
+        return NULL;
+    }
+
+    heap_hook_t * p_top = p_heap->p_root;
+
+    p_heap->p_root = merge_pairs(p_heap, p_top->p_child);
+    p_heap->size--;
+    heap_hook_init(p_top);
+
+    return p_top;
+}
+
+bool
+iheap_decrease_key(iheap_t * p_heap, heap_hook_t * p_hook)
+{
+    if (!iheap_contains(p_heap, p_hook))
+    {
+        return false;
+    }
+
+    // The subtree under the element still satisfies the heap order, so it
+    // only has to be cut from its parent and melded back at the root
+    if (p_hook != p_heap->p_root)
+    {
+        cut(p_hook);
+        p_heap->p_root = meld(p_heap, p_heap->p_root, p_hook);
+    }
+
+    return true;
+}
+
+bool
+iheap_remove(iheap_t * p_heap, heap_hook_t * p_hook)
+{
+    if (!iheap_contains(p_heap, p_hook))
+    {
+        return false;
+    }
+    if (p_hook == p_heap->p_root)
+    {
+        (void)iheap_extract_top(p_heap);
+        return true;
+    }
+
+    cut(p_hook);
+
+    heap_hook_t * p_children = merge_pairs(p_heap, p_hook->p_child);
+    if (NULL != p_children)
+    {
+        p_heap->p_root = meld(p_heap, p_heap->p_root, p_children);
+    }
+    p_heap->size--;
+    heap_hook_init(p_hook);
+
+    return true;
+}
+
+bool
+iheap_contains(const iheap_t * p_heap, const heap_hook_t * p_hook)
+{
+    return (NULL != p_heap) && (NULL != p_hook)
+           && ((p_hook == p_heap->p_root) || (NULL != p_hook->p_prev));
+}
+
+uint32_t
+iheap_size(const iheap_t * p_heap)
+{
+    return (NULL == p_heap) ? 0 : p_heap->size;
+}
+
+bool
+iheap_is_empty(const iheap_t * p_heap)
+{
+    return (0 == iheap_size(p_heap));
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static void
+link_between(ilist_t *     p_list,
+             list_hook_t * p_prev,
+             list_hook_t * p_hook,
+             list_hook_t * p_next)
+{
+    p_hook->p_prev = p_prev;
+    p_hook->p_next = p_next;
+    p_prev->p_next = p_hook;
+    p_next->p_prev = p_hook;
+    p_list->size++;
+}
+
+static void
+unlink_hook(ilist_t * p_list, list_hook_t * p_hook)
+{
+    p_hook->p_prev->p_next = p_hook->p_next;
+    p_hook->p_next->p_prev = p_hook->p_prev;
+    list_hook_init(p_hook);
+    p_list->size--;
+}
+
+static bst_hook_t *
+subtree_min(bst_hook_t * p_hook)
+{
+    while ((NULL != p_hook) && (NULL != p_hook->p_left))
+    {
+        p_hook = p_hook->p_left;
+    }
+    return p_hook;
+}
+
+static bst_hook_t *
+subtree_max(bst_hook_t * p_hook)
+{
+    while ((NULL != p_hook) && (NULL != p_hook->p_right))
+    {
+        p_hook = p_hook->p_right;
+    }
+    return p_hook;
+}
+
+/*!
+ * @brief Puts p_new (possibly NULL) where p_old hangs from its parent.
+ */
+static void
+transplant(ibst_t * p_tree, bst_hook_t * p_old, bst_hook_t * p_new)
+{
+    bst_hook_t * p_parent = p_old->p_parent;
+
+    if (NULL == p_parent)
+    {
+        p_tree->p_root = p_new;
+    }
+    else if (p_old == p_parent->p_left)
+    {
+        p_parent->p_left = p_new;
+    }
+    else
+    {
+        p_parent->p_right = p_new;
+    }
+    if (NULL != p_new)
+    {
+        p_new->p_parent = p_parent;
+    }
+}
+
+/*!
+ * @brief Melds two heap-ordered trees with unlinked roots; the loser
+ *        becomes the winner's leftmost child.
+ *
+ * @return The winner, with no parent or siblings
+ */
+static heap_hook_t *
+meld(const iheap_t * p_heap, heap_hook_t * p_lhs, heap_hook_t * p_rhs)
+{
+    if (p_heap->compare_fn(p_rhs, p_lhs) < 0)
+    {
+        heap_hook_t * p_swap = p_lhs;
+        p_lhs                = p_rhs;
+        p_rhs                = p_swap;
+    }
+
+    p_rhs->p_prev    = p_lhs;
+    p_rhs->p_sibling = p_lhs->p_child;
+    if (NULL != p_lhs->p_child)
+    {
+        p_lhs->p_child->p_prev = p_rhs;
+    }
+    p_lhs->p_child   = p_rhs;
+    p_lhs->p_prev    = NULL;
+    p_lhs->p_sibling = NULL;
+
+    return p_lhs;
+}
+
+/*!
+ * @brief Melds a sibling list into one tree by two-pass pairing.
+ *
+ * @return Root of the tree, or NULL for an empty list
+ */
+static heap_hook_t *
+merge_pairs(const iheap_t * p_heap, heap_hook_t * p_first)
+{
+    heap_hook_t * p_pairs = NULL; // Melded pairs, last first, via p_sibling
+
+    while (NULL != p_first)
+    {
+        heap_hook_t * p_lhs = p_first;
+        heap_hook_t * p_rhs = p_lhs->p_sibling;
+
+        if (NULL == p_rhs)
+        {
+            p_lhs->p_prev    = NULL;
+            p_lhs->p_sibling = p_pairs;
+            p_pairs          = p_lhs;
+            break;
+        }
+
+        p_first = p_rhs->p_sibling;
+
+        heap_hook_t * p_pair = meld(p_heap, p_lhs, p_rhs);
+        p_pair->p_sibling    = p_pairs;
+        p_pairs              = p_pair;
+    }
+
+    heap_hook_t * p_root = NULL;
+    while (NULL != p_pairs)
+    {
+        heap_hook_t * p_next = p_pairs->p_sibling;
+
+        p_pairs->p_sibling = NULL;
+        p_root = (NULL == p_root) ? p_pairs : meld(p_heap, p_root, p_pairs);
+        p_pairs = p_next;
+    }
+    if (NULL != p_root)
+    {
+        p_root->p_prev = NULL;
+    }
+
+    return p_root;
+}
+
+/*!
+ * @brief Detaches a non-root element, with its subtree, from its parent.
+ */
+static void
+cut(heap_hook_t * p_hook)
+{
+    if (p_hook->p_prev->p_child == p_hook)
+    {
+        p_hook->p_prev->p_child = p_hook->p_sibling;
+    }
+    else
+    {
+        p_hook->p_prev->p_sibling = p_hook->p_sibling;
+    }
+    if (NULL != p_hook->p_sibling)
+    {
+        p_hook->p_sibling->p_prev = p_hook->p_prev;
+    }
+    p_hook->p_prev    = NULL;
+    p_hook->p_sibling = NULL;
+}
+
+/*** end of file ***/
@@ -0,0 +1,408 @@
+/** @file intrusive.h
+ *
+ * @brief Intrusive list, binary search tree and heap.
+ *
+ * The containers in 2 - 7 store a void * in a node they allocate, so each
+ * element costs an allocation and an extra pointer chase. Here the links
+ * live inside the element instead: the user struct embeds a list_hook_t,
+ * bst_hook_t or heap_hook_t, the container links those hooks together and
+ * CONTAINER_OF() gets back from a hook to the struct around it.
+ *
+ *     typedef struct
+ *     {
+ *         uint32_t    key;
+ *         list_hook_t link;
+ *     } job_t;
+ *
+ *     list_hook_t * p_hook = ilist_pop_front(&jobs);
+ *     job_t *       p_job  = CONTAINER_OF(p_hook, job_t, link);
+ *
+ * No function here allocates or frees, so they can be used where malloc()
+ * cannot, and they cannot fail for lack of memory. The containers never
+ * own their elements: the caller keeps each element alive while it is
+ * linked and frees it after removing it. An element may carry several
+ * hooks and sit in several containers at once, but each hook can be in
+ * only one container at a time.
+ *
+ * - ilist_t is a circular doubly linked list. Push and pop at either end
+ *   and removal of any linked element are O(1), so it also serves as an
+ *   intrusive stack (push_front/pop_front) and queue (push_back/pop_front).
+ * - ibst_t is an unbalanced binary search tree like bst_t. Searches take a
+ *   probe: a hook embedded in a stack struct holding just the key.
+ *   Removing a linked element needs no search.
+ * - iheap_t is a pairing heap. Insert is O(1); extract, remove and
+ *   decrease-key are O(log n) amortised. Unlike heap_t it can find an
+ *   element's position from the element itself, so decrease-key and
+ *   removal take the element rather than an index.
+ *
+ * Hooks must be zeroed, or set up with the *_hook_init() functions, before
+ * their first use. The containers leave removed hooks zeroed again, which
+ * is how ilist_is_linked() and iheap_contains() can tell.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef INTRUSIVE_H
+#define INTRUSIVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+/* Pointer to the struct of the given type whose member p_member points
+   to. p_member must not be NULL. */
+#define CONTAINER_OF(p_member, type, member) \
+    ((type *)(void *)((char *)(p_member) - offsetof(type, member)))
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct list_hook
+{
+    struct list_hook * p_next;
+    struct list_hook * p_prev;
+} list_hook_t;
+
+typedef struct
+{
+    list_hook_t head; /* Sentinel; head.p_next is the front */
+    uint32_t    size;
+} ilist_t;
+
+typedef struct bst_hook
+{
+    struct bst_hook * p_left;
+    struct bst_hook * p_right;
+    struct bst_hook * p_parent;
+} bst_hook_t;
+
+/* Negative if p_lhs sorts before p_rhs, 0 if equal, positive if after */
+typedef int32_t (*ibst_compare_func_t)(const bst_hook_t * p_lhs,
+                                       const bst_hook_t * p_rhs);
+
+typedef struct
+{
+    bst_hook_t *        p_root;
+    uint32_t            size;
+    ibst_compare_func_t compare_fn;
+} ibst_t;
+
+typedef struct heap_hook
+{
+    struct heap_hook * p_child;   /* Leftmost child */
+    struct heap_hook * p_sibling; /* Next sibling to the right */
+    struct heap_hook * p_prev;    /* Left sibling, or parent if leftmost */
+} heap_hook_t;
+
+/* Negative if p_lhs belongs nearer the top than p_rhs, as for heap_t */
+typedef int32_t (*iheap_compare_func_t)(const heap_hook_t * p_lhs,
+                                        const heap_hook_t * p_rhs);
+
+typedef struct
+{
+    heap_hook_t *        p_root;
+    uint32_t             size;
+    iheap_compare_func_t compare_fn;
+} iheap_t;
+
+/*************************************************************************
+ * Function Declarations: list
+ *************************************************************************/
+
+/*!
+ * @brief Marks a hook as not in any list.
+ *
+ * @param[out] p_hook Hook
+ */
+void
+list_hook_init(list_hook_t * p_hook);
+
+/*!
+ * @brief Initializes an empty list.
+ *
+ * @param[out] p_list List
+ *
+ * @return true on success, false if p_list is NULL
+ */
+bool
+ilist_init(ilist_t * p_list);
+
+/*!
+ * @brief Links an element at the front of the list.
+ *
+ * @param[in,out] p_list List
+ * @param[in,out] p_hook Hook of the element; must not be linked
+ *
+ * @return true on success, false on NULL or an already linked hook
+ */
+bool
+ilist_push_front(ilist_t * p_list, list_hook_t * p_hook);
+
+/*!
+ * @brief Links an element at the back of the list.
+ *
+ * @param[in,out] p_list List
+ * @param[in,out] p_hook Hook of the element; must not be linked
+ *
+ * @return true on success, false on NULL or an already linked hook
+ */
+bool
+ilist_push_back(ilist_t * p_list, list_hook_t * p_hook);
+
+/*!
+ * @brief Unlinks the front element.
+ *
+ * @param[in,out] p_list List
+ *
+ * @return Hook of the element, or NULL if the list is empty
+ */
+list_hook_t *
+ilist_pop_front(ilist_t * p_list);
+
+/*!
+ * @brief Unlinks the back element.
+ *
+ * @param[in,out] p_list List
+ *
+ * @return Hook of the element, or NULL if the list is empty
+ */
+list_hook_t *
+ilist_pop_back(ilist_t * p_list);
+
+/*!
+ * @brief Unlinks an element from anywhere in the list.
+ *
+ * @param[in,out] p_list List the element is in
+ * @param[in,out] p_hook Hook of the element
+ *
+ * @return true on success, false on NULL or a hook that is not linked
+ */
+bool
+ilist_remove(ilist_t * p_list, list_hook_t * p_hook);
+
+/*!
+ * @brief The front element, left in place.
+ *
+ * @return Hook of the element, or NULL if the list is empty
+ */
+list_hook_t *
+ilist_front(const ilist_t * p_list);
+
+/*!
+ * @brief The back element, left in place.
+ *
+ * @return Hook of the element, or NULL if the list is empty
+ */
+list_hook_t *
+ilist_back(const ilist_t * p_list);
+
+/*!
+ * @brief The element after p_hook, for walking front to back.
+ *
+ * @param[in] p_list List the element is in
+ * @param[in] p_hook Hook of a linked element
+ *
+ * @return Hook of the next element, or NULL at the back
+ */
+list_hook_t *
+ilist_next(const ilist_t * p_list, const list_hook_t * p_hook);
+
+uint32_t
+ilist_size(const ilist_t * p_list);
+
+bool
+ilist_is_empty(const ilist_t * p_list);
+
+/*!
+ * @brief Whether a hook is currently in a list.
+ */
+bool
+ilist_is_linked(const list_hook_t * p_hook);
+
+/*************************************************************************
+ * Function Declarations: binary search tree
+ *************************************************************************/
+
+/*!
+ * @brief Marks a hook as not in any tree.
+ *
+ * @param[out] p_hook Hook
+ */
+void
+bst_hook_init(bst_hook_t * p_hook);
+
+/*!
+ * @brief Initializes an empty tree.
+ *
+ * @param[out] p_tree     Tree
+ * @param[in]  compare_fn Orders two elements by their hooks
+ *
+ * @return true on success, false on NULL
+ */
+bool
+ibst_init(ibst_t * p_tree, ibst_compare_func_t compare_fn);
+
+/*!
+ * @brief Links an element into the tree.
+ *
+ * @param[in,out] p_tree Tree
+ * @param[in,out] p_hook Hook of the element; must not be linked
+ *
+ * @return true on success, false on NULL or if an equal element is linked
+ */
+bool
+ibst_insert(ibst_t * p_tree, bst_hook_t * p_hook);
+
+/*!
+ * @brief Finds the element equal to a probe.
+ *
+ * @param[in] p_tree  Tree
+ * @param[in] p_probe Hook inside a struct that holds only the key; it is
+ *                    passed to compare_fn and never linked
+ *
+ * @return Hook of the element, or NULL if there is none
+ */
+bst_hook_t *
+ibst_search(const ibst_t * p_tree, const bst_hook_t * p_probe);
+
+/*!
+ * @brief Unlinks a linked element; no search is needed.
+ *
+ * @param[in,out] p_tree Tree the element is in
+ * @param[in,out] p_hook Hook of the element
+ *
+ * @return true on success, false on NULL
+ */
+bool
+ibst_remove(ibst_t * p_tree, bst_hook_t * p_hook);
+
+/*!
+ * @brief The smallest element.
+ *
+ * @return Hook of the element, or NULL if the tree is empty
+ */
+bst_hook_t *
+ibst_first(const ibst_t * p_tree);
+
+/*!
+ * @brief The largest element.
+ *
+ * @return Hook of the element, or NULL if the tree is empty
+ */
+bst_hook_t *
+ibst_last(const ibst_t * p_tree);
+
+/*!
+ * @brief The next larger element, for an in-order walk.
+ *
+ * @param[in] p_hook Hook of a linked element
+ *
+ * @return Hook of the element, or NULL after the largest
+ */
+bst_hook_t *
+ibst_next(const bst_hook_t * p_hook);
+
+uint32_t
+ibst_size(const ibst_t * p_tree);
+
+bool
+ibst_is_empty(const ibst_t * p_tree);
+
+/*************************************************************************
+ * Function Declarations: heap
+ *************************************************************************/
+
+/*!
+ * @brief Marks a hook as not in any heap.
+ *
+ * @param[out] p_hook Hook
+ */
+void
+heap_hook_init(heap_hook_t * p_hook);
+
+/*!
+ * @brief Initializes an empty heap.
+ *
+ * @param[out] p_heap     Heap
+ * @param[in]  compare_fn Orders two elements by their hooks
+ *
+ * @return true on success, false on NULL
+ */
+bool
+iheap_init(iheap_t * p_heap, iheap_compare_func_t compare_fn);
+
+/*!
+ * @brief Links an element into the heap.
+ *
+ * @param[in,out] p_heap Heap
+ * @param[in,out] p_hook Hook of the element; must not be linked
+ *
+ * @return true on success, false on NULL or an already linked hook
+ */
+bool
+iheap_insert(iheap_t * p_heap, heap_hook_t * p_hook);
+
+/*!
+ * @brief The top element, left in place.
+ *
+ * @return Hook of the element, or NULL if the heap is empty
+ */
+heap_hook_t *
+iheap_peek_top(const iheap_t * p_heap);
+
+/*!
+ * @brief Unlinks the top element.
+ *
+ * @param[in,out] p_heap Heap
+ *
+ * @return Hook of the element, or NULL if the heap is empty
+ */
+heap_hook_t *
+iheap_extract_top(iheap_t * p_heap);
+
+/*!
+ * @brief Restores the heap after a linked element's key moved towards the
+ *        top. Moving a key away from the top needs remove and insert.
+ *
+ * @param[in,out] p_heap Heap the element is in
+ * @param[in,out] p_hook Hook of the element
+ *
+ * @return true on success, false on NULL or a hook that is not linked
+ */
+bool
+iheap_decrease_key(iheap_t * p_heap, heap_hook_t * p_hook);
+
+/*!
+ * @brief Unlinks a linked element from anywhere in the heap.
+ *
+ * @param[in,out] p_heap Heap the element is in
+ * @param[in,out] p_hook Hook of the element
+ *
+ * @return true on success, false on NULL or a hook that is not linked
+ */
+bool
+iheap_remove(iheap_t * p_heap, heap_hook_t * p_hook);
+
+/*!
+ * @brief Whether a hook is linked into p_heap. Hooks are only ever linked
+ *        into one heap, so any linked hook other than another heap's root
+ *        also counts.
+ */
+bool
+iheap_contains(const iheap_t * p_heap, const heap_hook_t * p_hook);
+
+uint32_t
+iheap_size(const iheap_t * p_heap);
+
+bool
+iheap_is_empty(const iheap_t * p_heap);
+
+#endif /* INTRUSIVE_H */
+
+/*** end of file ***/
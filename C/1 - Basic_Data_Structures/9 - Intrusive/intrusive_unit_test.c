@@ -0,0 +1,317 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intrusive.h"
+
+#define ELEMENT_COUNT (1000u)
+#define KEY_RANGE     (1000000u)
+
+// One element in all three containers at once, hooks at different offsets
+typedef struct
+{
+    list_hook_t by_arrival;
+    uint32_t    key;
+    bst_hook_t  by_key;
+    uint32_t    id;
+    heap_hook_t by_priority;
+} element_t;
+
+static element_t g_elements[ELEMENT_COUNT];
+
+static int32_t
+bst_key_compare(const bst_hook_t * p_lhs, const bst_hook_t * p_rhs)
+{
+    uint32_t lhs = CONTAINER_OF(p_lhs, element_t, by_key)->key;
+    uint32_t rhs = CONTAINER_OF(p_rhs, element_t, by_key)->key;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static int32_t
+heap_key_compare(const heap_hook_t * p_lhs, const heap_hook_t * p_rhs)
+{
+    uint32_t lhs = CONTAINER_OF(p_lhs, element_t, by_priority)->key;
+    uint32_t rhs = CONTAINER_OF(p_rhs, element_t, by_priority)->key;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+// Distinct keys in shuffled order, so the tree is not a list
+static void
+elements_setup(void)
+{
+    uint64_t state = 88172645463325252ull;
+
+    memset(g_elements, 0, sizeof(g_elements));
+    for (uint32_t idx = 0; idx < ELEMENT_COUNT; idx++)
+    {
+        g_elements[idx].id  = idx;
+        g_elements[idx].key = idx * (KEY_RANGE / ELEMENT_COUNT);
+    }
+
+    for (uint32_t idx = ELEMENT_COUNT - 1; idx > 0; idx--)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        uint32_t other         = (uint32_t)(state % (idx + 1));
+        uint32_t key           = g_elements[idx].key;
+        g_elements[idx].key    = g_elements[other].key;
+        g_elements[other].key  = key;
+    }
+}
+
+START_TEST(test_container_of_round_trips)
+{
+    element_t * p_element = &g_elements[7];
+
+    ck_assert_ptr_eq(CONTAINER_OF(&p_element->by_arrival, element_t,
+                                  by_arrival),
+                     p_element);
+    ck_assert_ptr_eq(CONTAINER_OF(&p_element->by_key, element_t, by_key),
+                     p_element);
+    ck_assert_ptr_eq(CONTAINER_OF(&p_element->by_priority, element_t,
+                                  by_priority),
+                     p_element);
+
+    // Through the containers and back
+    ilist_t list;
+    ibst_t  tree;
+    iheap_t heap;
+    ck_assert(ilist_init(&list));
+    ck_assert(ibst_init(&tree, bst_key_compare));
+    ck_assert(iheap_init(&heap, heap_key_compare));
+
+    ck_assert(ilist_push_back(&list, &p_element->by_arrival));
+    ck_assert(ibst_insert(&tree, &p_element->by_key));
+    ck_assert(iheap_insert(&heap, &p_element->by_priority));
+
+    ck_assert_uint_eq(CONTAINER_OF(ilist_pop_front(&list), element_t,
+                                   by_arrival)->id,
+                      7);
+    ck_assert_uint_eq(CONTAINER_OF(ibst_first(&tree), element_t,
+                                   by_key)->id,
+                      7);
+    ck_assert_uint_eq(CONTAINER_OF(iheap_extract_top(&heap), element_t,
+                                   by_priority)->id,
+                      7);
+}
+END_TEST
+
+START_TEST(test_list_order_after_removals)
+{
+    ilist_t list;
+    ck_assert(ilist_init(&list));
+
+    for (uint32_t idx = 1; idx < ELEMENT_COUNT; idx++)
+    {
+        ck_assert(ilist_push_back(&list, &g_elements[idx].by_arrival));
+    }
+    ck_assert(ilist_push_front(&list, &g_elements[0].by_arrival));
+
+    // A linked hook cannot be linked again
+    ck_assert(!ilist_push_back(&list, &g_elements[5].by_arrival));
+
+    // Unlink every third element from the middle of the list
+    for (uint32_t idx = 0; idx < ELEMENT_COUNT; idx += 3)
+    {
+        ck_assert(ilist_remove(&list, &g_elements[idx].by_arrival));
+        ck_assert(!ilist_is_linked(&g_elements[idx].by_arrival));
+    }
+    ck_assert(!ilist_remove(&list, &g_elements[0].by_arrival));
+
+    uint32_t expected = 1;
+    uint32_t count    = 0;
+    for (list_hook_t * p_hook = ilist_front(&list); NULL != p_hook;
+         p_hook               = ilist_next(&list, p_hook))
+    {
+        ck_assert_uint_eq(CONTAINER_OF(p_hook, element_t, by_arrival)->id,
+                          expected);
+        expected += (0 == ((expected + 1) % 3)) ? 2 : 1;
+        count++;
+    }
+    ck_assert_uint_eq(count, ilist_size(&list));
+
+    // Both ends still work after the removals (999 was a multiple of 3)
+    ck_assert_uint_eq(CONTAINER_OF(ilist_back(&list), element_t,
+                                   by_arrival)->id,
+                      ELEMENT_COUNT - 2);
+    while (!ilist_is_empty(&list))
+    {
+        ck_assert_ptr_nonnull(ilist_pop_back(&list));
+    }
+    ck_assert_ptr_null(ilist_pop_front(&list));
+}
+END_TEST
+
+START_TEST(test_bst_order_after_removals)
+{
+    ibst_t tree;
+    ck_assert(ibst_init(&tree, bst_key_compare));
+
+    for (uint32_t idx = 0; idx < ELEMENT_COUNT; idx++)
+    {
+        ck_assert(ibst_insert(&tree, &g_elements[idx].by_key));
+    }
+    ck_assert_uint_eq(ibst_size(&tree), ELEMENT_COUNT);
+
+    // An equal key is refused
+    element_t duplicate = { .key = g_elements[3].key };
+    ck_assert(!ibst_insert(&tree, &duplicate.by_key));
+
+    // Remove linked elements directly, leaves and inner nodes alike
+    uint32_t removed = 0;
+    for (uint32_t idx = 0; idx < ELEMENT_COUNT; idx += 3)
+    {
+        ck_assert(ibst_remove(&tree, &g_elements[idx].by_key));
+        removed++;
+    }
+    ck_assert_uint_eq(ibst_size(&tree), ELEMENT_COUNT - removed);
+
+    // The in-order walk is still sorted, with parents kept consistent
+    uint32_t     count  = 0;
+    bst_hook_t * p_prev = NULL;
+    for (bst_hook_t * p_hook = ibst_first(&tree); NULL != p_hook;
+         p_hook              = ibst_next(p_hook))
+    {
+        if (NULL != p_prev)
+        {
+            ck_assert_int_lt(bst_key_compare(p_prev, p_hook), 0);
+        }
+        if (NULL != p_hook->p_left)
+        {
+            ck_assert_ptr_eq(p_hook->p_left->p_parent, p_hook);
+        }
+        if (NULL != p_hook->p_right)
+        {
+            ck_assert_ptr_eq(p_hook->p_right->p_parent, p_hook);
+        }
+        p_prev = p_hook;
+        count++;
+    }
+    ck_assert_uint_eq(count, ELEMENT_COUNT - removed);
+    ck_assert_ptr_eq(ibst_last(&tree), p_prev);
+
+    // Searches find the survivors and none of the removed
+    for (uint32_t idx = 0; idx < ELEMENT_COUNT; idx++)
+    {
+        element_t    probe   = { .key = g_elements[idx].key };
+        bst_hook_t * p_found = ibst_search(&tree, &probe.by_key);
+
+        if (0 == (idx % 3))
+        {
+            ck_assert_ptr_null(p_found);
+        }
+        else
+        {
+            ck_assert_ptr_eq(p_found, &g_elements[idx].by_key);
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_heap_order_after_decrease_and_remove)
+{
+    iheap_t heap;
+    ck_assert(iheap_init(&heap, heap_key_compare));
+
+    for (uint32_t idx = 0; idx < ELEMENT_COUNT; idx++)
+    {
+        ck_assert(iheap_insert(&heap, &g_elements[idx].by_priority));
+    }
+    ck_assert(!iheap_insert(&heap, &g_elements[0].by_priority));
+
+    // Pull a few to the top after the first extraction built a real tree
+    heap_hook_t * p_top = iheap_extract_top(&heap);
+    ck_assert_uint_eq(CONTAINER_OF(p_top, element_t, by_priority)->key, 0);
+    ck_assert(!iheap_contains(&heap, p_top));
+
+    uint32_t removed = 1;
+    for (uint32_t idx = 0; idx < ELEMENT_COUNT; idx++)
+    {
+        heap_hook_t * p_hook = &g_elements[idx].by_priority;
+
+        if (!iheap_contains(&heap, p_hook))
+        {
+            continue;
+        }
+
+        if (0 == (idx % 7))
+        {
+            g_elements[idx].key /= 2;
+            ck_assert(iheap_decrease_key(&heap, p_hook));
+        }
+        else if (0 == (idx % 5))
+        {
+            ck_assert(iheap_remove(&heap, p_hook));
+            ck_assert(!iheap_contains(&heap, p_hook));
+            ck_assert(!iheap_remove(&heap, p_hook));
+            removed++;
+        }
+    }
+    ck_assert_uint_eq(iheap_size(&heap), ELEMENT_COUNT - removed);
+
+    // Extraction yields every survivor, smallest key first
+    uint32_t count    = 0;
+    uint32_t last_key = 0;
+    while (!iheap_is_empty(&heap))
+    {
+        ck_assert_ptr_eq(iheap_peek_top(&heap), heap.p_root);
+
+        element_t * p_element = CONTAINER_OF(iheap_extract_top(&heap),
+                                             element_t,
+                                             by_priority);
+        ck_assert_uint_ge(p_element->key, last_key);
+        ck_assert(0 != (p_element->id % 5) || 0 == (p_element->id % 7));
+        last_key = p_element->key;
+        count++;
+    }
+    ck_assert_uint_eq(count, ELEMENT_COUNT - removed);
+    ck_assert_ptr_null(iheap_extract_top(&heap));
+}
+END_TEST
+
+//
+// Define test suite and add test cases
+//
+Suite *
+intrusive_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Intrusive");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_checked_fixture(tc_core, elements_setup, NULL);
+    tcase_add_test(tc_core, test_container_of_round_trips);
+    tcase_add_test(tc_core, test_list_order_after_removals);
+    tcase_add_test(tc_core, test_bst_order_after_removals);
+    tcase_add_test(tc_core, test_heap_order_after_decrease_and_remove);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = intrusive_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -8,12 +8,20 @@
 node_t *
 create_node (void * value)
 {
-    node_t * node = malloc (sizeof (node_t));
+    return create_node_ex (value, NULL);
+}
+
+// Node whose children, added by insert_left/right, share its allocator
+node_t *
+create_node_ex (void * value, const allocator_t * p_alloc)
+{
+    node_t * node = ALLOC_NEW (p_alloc, sizeof (node_t));
     if (node)
     {
-        node->value = value;
-        node->left  = NULL;
-        node->right = NULL;
+        node->value   = value;
+        node->left    = NULL;
+        node->right   = NULL;
+        node->p_alloc = p_alloc;
     }
     return node;
 }
@@ -21,10 +29,18 @@ create_node (void * value)
 bt_t *
 create_new_tree (void)
 {
-    bt_t * tree = malloc (sizeof (bt_t));
+    return create_new_tree_ex (NULL);
+}
+
+// Tree whose root should come from create_node_ex (value, tree->p_alloc)
+bt_t *
+create_new_tree_ex (const allocator_t * p_alloc)
+{
+    bt_t * tree = ALLOC_NEW (p_alloc, sizeof (bt_t));
     if (tree)
     {
-        tree->root = NULL;
+        tree->root    = NULL;
+        tree->p_alloc = p_alloc;
     }
     return tree;
 }
@@ -37,7 +53,7 @@ destroy_node (node_t * node)
     {
         destroy_node (node->left);
         destroy_node (node->right);
-        free (node);
+        ALLOC_FREE (node->p_alloc, node);
     }
 }
 
@@ -47,7 +63,7 @@ destroy_tree (bt_t ** tree)
     if (tree && *tree)
     {
         destroy_node ((*tree)->root);
-        free (*tree);
+        ALLOC_FREE ((*tree)->p_alloc, *tree);
         *tree = NULL;
     }
 }
@@ -59,7 +75,7 @@ insert_left (node_t * parent, void * value)
         return -1;
     if (parent->left)
         return -1; // Left child already exists
-    parent->left = create_node (value);
+    parent->left = create_node_ex (value, parent->p_alloc);
     return parent->left ? 0 : -1;
 }
 
@@ -70,7 +86,7 @@ insert_right (node_t * parent, void * value)
         return -1;
     if (parent->right)
         return -1; // Right child already exists
-    parent->right = create_node (value);
+    parent->right = create_node_ex (value, parent->p_alloc);
     return parent->right ? 0 : -1;
 }
 
@@ -239,19 +255,19 @@ delete_node_recursive (node_t * node,
     {
         if (!node->left && !node->right)
         {
-            free (node);
+            ALLOC_FREE (node->p_alloc, node);
             return NULL;
         }
         if (!node->left)
         {
             node_t * temp = node->right;
-            free (node);
+            ALLOC_FREE (node->p_alloc, node);
             return temp;
         }
         if (!node->right)
         {
             node_t * temp = node->left;
-            free (node);
+            ALLOC_FREE (node->p_alloc, node);
             return temp;
         }
         // Node has two children, replace with in-order successor
@@ -286,7 +302,7 @@ copy_node_recursive (node_t * node)
 {
     if (!node)
         return NULL;
-    node_t * new_node = create_node (node->value);
+    node_t * new_node = create_node_ex (node->value, node->p_alloc);
     if (new_node)
     {
         new_node->left  = copy_node_recursive (node->left);
@@ -300,7 +316,7 @@ copy_tree (bt_t * tree)
 {
     if (!tree)
         return NULL;
-    bt_t * new_tree = create_new_tree();
+    bt_t * new_tree = create_new_tree_ex (tree->p_alloc);
     if (new_tree)
     {
         new_tree->root = copy_node_recursive (tree->root);
@@ -315,56 +331,26 @@ is_balanced_recursive (node_t * node, int * height)
     if (!node)
     {
         *height = 0;
-        printf("Null node, height = 0\n");
         return 1;
     }
 
-    printf("Checking node with value: %d\n", node->data);
-
     int left_height, right_height;
-    printf("Checking left child of %d\n", node->data);
-    int left_balanced = is_balanced_recursive(node->left, &left_height);
-    printf("Left subtree of %d: height = %d, balanced = %d\n", node->data, left_height, left_balanced);
-
-    if (!left_balanced)
+    if (!is_balanced_recursive (node->left, &left_height))
         return 0;
-
-    printf("Checking right child of %d\n", node->data);
-    int right_balanced = is_balanced_recursive(node->right, &right_height);
-    printf("Right subtree of %d: height = %d, balanced = %d\n", node->data, right_height, right_balanced);
-
-    if (!right_balanced)
+    if (!is_balanced_recursive (node->right, &right_height))
         return 0;
 
     *height = 1 + (left_height > right_height ? left_height : right_height);
-
-    int balance_factor = abs(left_height - right_height);
-    printf("Node %d: left_height = %d, right_height = %d, balance_factor = %d\n", 
-           node->data, left_height, right_height, balance_factor);
-
-    if (balance_factor > 1)
-    {
-        printf("Node %d is unbalanced\n", node->data);
-        return 0;
-    }
-
-    printf("Node %d is balanced\n", node->data);
-    return 1;
+    return abs (left_height - right_height) <= 1;
 }
 
 bool
 is_balanced (bt_t * tree)
 {
     if (!tree || !tree->root)
-    {
-        printf("Tree is empty, considered balanced\n");
         return true;
-    }
-    printf("Checking balance for tree with root value: %d\n", tree->root->data);
     int height;
-    bool result = is_balanced_recursive (tree->root, &height);
-    printf("Tree balance check result: %s\n", result ? "Balanced" : "Unbalanced");
-    return result;
+    return is_balanced_recursive (tree->root, &height);
 }
 
 // Helper function for lowest_common_ancestor
@@ -3,23 +3,30 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "../../1 - Basic_Data_Structures/0 - Allocator/allocator.h"
 
 typedef struct node {
     void * value;
     struct node * left;
     struct node * right;
+    const allocator_t * p_alloc; // Children and copies come from it too
 } node_t;
 
 typedef struct bt {
     node_t * root;
+    const allocator_t * p_alloc; // Allocator for the tree (NULL for malloc)
 } bt_t;
 
 node_t * create_node (void * value);
 
+node_t * create_node_ex (void * value, const allocator_t * p_alloc);
+
 void destroy_node (node_t * node);
 
 bt_t * create_new_tree (void);
 
+bt_t * create_new_tree_ex (const allocator_t * p_alloc);
+
 void destroy_tree (bt_t ** tree);
 
 int insert_left (node_t * parent, void * value);
@@ -273,7 +273,7 @@ END_TEST
 START_TEST (test_is_balanced)
 {
     bt_t * tree     = create_new_tree();
-    int    values[] = {10, 5, 15, 3};
+    int    values[] = {10, 5, 15, 3, 1};
     tree->root      = create_node (&values[0]);
     insert_left (tree->root, &values[1]);
     insert_right (tree->root, &values[2]);
@@ -281,6 +281,10 @@ START_TEST (test_is_balanced)
     ck_assert (is_balanced (tree));
 
     insert_left (tree->root->left, &values[3]);
+    ck_assert (is_balanced (tree));
+
+    // Subtrees now differ in height by two
+    insert_left (tree->root->left->left, &values[4]);
     ck_assert (!is_balanced (tree));
 
     destroy_tree (&tree);
@@ -306,6 +310,38 @@ START_TEST (test_lowest_common_ancestor)
 }
 END_TEST
 
+START_TEST (test_tree_allocator)
+{
+    alloc_tracker_t *   tracker = alloc_tracker_create (NULL, 0);
+    const allocator_t * alloc   = alloc_tracker_allocator (tracker);
+    alloc_stats_t       stats;
+    int                 values[] = {10, 5, 15};
+
+    bt_t * tree = create_new_tree_ex (alloc);
+    tree->root  = create_node_ex (&values[0], tree->p_alloc);
+    insert_left (tree->root, &values[1]);
+    insert_right (tree->root, &values[2]);
+
+    // Children and copies come from the same allocator as their parent
+    bt_t * copy = copy_tree (tree);
+    ck_assert_ptr_eq (copy->root->left->p_alloc, alloc);
+    alloc_tracker_stats (tracker, &stats);
+    ck_assert_uint_eq (stats.allocs, 8);
+
+    delete_node (tree, &values[1], int_compare);
+    alloc_tracker_stats (tracker, &stats);
+    ck_assert_uint_eq (stats.frees, 1);
+
+    destroy_tree (&tree);
+    destroy_tree (&copy);
+    alloc_tracker_stats (tracker, &stats);
+    ck_assert_uint_eq (stats.frees, stats.allocs);
+    ck_assert_uint_eq (stats.live_bytes, 0);
+
+    alloc_tracker_destroy (&tracker);
+}
+END_TEST
+
 Suite *
 binary_tree_suite (void)
 {
@@ -334,6 +370,7 @@ binary_tree_suite (void)
     tcase_add_test (tc_core, test_copy_tree);
     tcase_add_test (tc_core, test_is_balanced);
     tcase_add_test (tc_core, test_lowest_common_ancestor);
+    tcase_add_test (tc_core, test_tree_allocator);
 
     suite_add_tcase (s, tc_core);
 
@@ -0,0 +1,845 @@
+/** @file filter.c
+ *
+ * @brief Implementation of the blocked Bloom filter and the cuckoo filter.
+ *
+ * Bloom: the hash's high half picks a block, by multiply-shift rather
+ * than modulo, and the low half times eight odd salts picks one bit in
+ * each of the block's words. A block holds a Poisson-distributed number
+ * of keys, so the false-positive rate for a given number of bits per key
+ * is the Poisson-weighted average of the per-block rates; create searches
+ * for the smallest size that meets the target.
+ *
+ * Cuckoo: a key's fingerprint is the hash's low bits, never zero since
+ * zero marks an empty slot. Its first bucket i comes from the hash's high
+ * half, and its second is (h - i) mod n for h a hash of the fingerprint,
+ * so either bucket can be reached from the other knowing only the stored
+ * fingerprint. Unlike the usual i XOR h, this works for any bucket count
+ * n, so the table is not rounded up to a power of two.
+ *
+ * An insert finding both buckets full moves a random resident to its
+ * other bucket, up to MAX_KICKS times. The fingerprint still homeless
+ * then waits in a one-entry stash, so no key is ever lost, and further
+ * inserts fail until a remove makes room.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "filter.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define CACHE_LINE        (64u)
+
+#define BLOOM_WORDS       (8u)   /* Words per block */
+#define BLOOM_BLOCK_BITS  (BLOOM_WORDS * 32u)
+#define BLOOM_MIN_BITS    (2.0)  /* Bits per key searched */
+#define BLOOM_MAX_BITS    (64.0)
+#define BLOOM_BITS_STEP   (0.25)
+
+#define CUCKOO_SLOTS      (4u)   /* Fingerprints per bucket */
+#define CUCKOO_LOAD       (0.95) /* Fill the table is sized for */
+#define MAX_KICKS         (500u)
+#define MAX_UNITS         (1ull << 32)  /* Blocks or buckets */
+
+#define IMAGE_VERSION     (1u)
+#define BLOOM_MAGIC       (0x464D4C42u) /* "BLMF" */
+#define CUCKOO_MAGIC      (0x464B4355u) /* "UCKF" */
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+struct bloom_filter
+{
+    const uint32_t * p_words;  /* Table read by lookups */
+    uint32_t *       p_owned;  /* Same table if writable, else NULL */
+    uint64_t         block_count;
+};
+
+typedef struct
+{
+    uint64_t index;
+    uint32_t fingerprint;      /* 0 when the stash is empty */
+} cuckoo_victim_t;
+
+struct cuckoo_filter
+{
+    const uint8_t * p_table;   /* Table read by lookups */
+    uint8_t *       p_owned;   /* Same table if writable, else NULL */
+    uint64_t        bucket_count;
+    uint64_t        count;
+    uint64_t        rng;       /* Picks which resident to kick out */
+    uint32_t        bits;      /* Fingerprint and lane width, 8 or 16 */
+    cuckoo_victim_t victim;
+};
+
+/* Saved in front of the table; 64 bytes so the table stays aligned */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t bits;             /* Cuckoo lane width, 0 for Bloom */
+    uint32_t victim_fp;
+    uint64_t units;            /* Blocks or buckets */
+    uint64_t count;
+    uint64_t victim_index;
+    uint64_t table_bytes;
+    uint64_t reserved[2];
+} image_header_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+/* Odd multipliers, one per block word, as in Parquet's split-block filter */
+static const uint32_t g_salts[BLOOM_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint64_t mix64(uint64_t value);
+static double   bloom_rate(double bits_per_key);
+static void     bloom_masks(uint32_t key, uint32_t * p_masks);
+static uint64_t scale(uint64_t value, uint64_t count);
+static uint64_t bloom_block(const bloom_filter_t * p_filter, uint64_t hash);
+static uint64_t load_bucket(const cuckoo_filter_t * p_filter, uint64_t index);
+static void     store_bucket(cuckoo_filter_t * p_filter,
+                             uint64_t          index,
+                             uint64_t          bucket);
+static bool     bucket_has(uint64_t bucket, uint32_t fp, uint32_t bits);
+static uint32_t fingerprint(const cuckoo_filter_t * p_filter, uint64_t hash);
+static uint64_t first_index(const cuckoo_filter_t * p_filter, uint64_t hash);
+static uint64_t alt_index(const cuckoo_filter_t * p_filter,
+                          uint64_t                index,
+                          uint32_t                fp);
+static bool     try_place(cuckoo_filter_t * p_filter,
+                          uint64_t          index,
+                          uint32_t          fp);
+static bool     try_take(cuckoo_filter_t * p_filter,
+                         uint64_t          index,
+                         uint32_t          fp);
+static bool     check_header(const image_header_t * p_header,
+                             size_t                 size,
+                             uint32_t               magic);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+uint64_t
+filter_hash(const void * p_key, size_t len)
+{
+    const uint8_t * p_bytes = p_key;
+    uint64_t        hash    = 0x9E3779B97F4A7C15ull ^ (uint64_t)len;
+
+    if (NULL == p_key)
+    {
+        return mix64(hash);
+    }
+
+    while (len >= 8u)
+    {
+        uint64_t word;
+
+        memcpy(&word, p_bytes, sizeof(word));
+        hash     = (hash ^ mix64(word)) * 0xFF51AFD7ED558CCDull;
+        p_bytes += 8u;
+        len     -= 8u;
+    }
+
+    if (len > 0u)
+    {
+        uint64_t word = 0u;
+
+        memcpy(&word, p_bytes, len);
+        hash = (hash ^ mix64(word)) * 0xFF51AFD7ED558CCDull;
+    }
+
+    return mix64(hash);
+}
+
+bloom_filter_t *
+bloom_filter_create(uint64_t capacity, double fpr)
+{
+    bloom_filter_t * p_filter     = NULL;
+    double           bits_per_key = BLOOM_MIN_BITS;
+
+    if ((0u == capacity) || !(fpr > 0.0) || !(fpr < 1.0))
+    {
+        return NULL;
+    }
+
+    while ((bits_per_key < BLOOM_MAX_BITS) && (bloom_rate(bits_per_key) > fpr))
+    {
+        bits_per_key += BLOOM_BITS_STEP;
+    }
+
+    double   bits   = (double)capacity * bits_per_key;
+    uint64_t blocks = (uint64_t)(bits / BLOOM_BLOCK_BITS) + 1u;
+
+    if ((bits / BLOOM_BLOCK_BITS >= (double)MAX_UNITS)
+        || (blocks > (SIZE_MAX / (BLOOM_WORDS * sizeof(uint32_t)))))
+    {
+        return NULL;
+    }
+
+    p_filter = calloc(1u, sizeof(*p_filter));
+
+    if (NULL == p_filter)
+    {
+        return NULL;
+    }
+
+    size_t bytes = (size_t)blocks * BLOOM_WORDS * sizeof(uint32_t);
+
+    if (0 != posix_memalign((void **)&p_filter->p_owned, CACHE_LINE, bytes))
+    {
+        free(p_filter);
+        return NULL;
+    }
+
+    memset(p_filter->p_owned, 0, bytes);
+    p_filter->p_words     = p_filter->p_owned;
+    p_filter->block_count = blocks;
+    return p_filter;
+}
+
+void
+bloom_filter_destroy(bloom_filter_t ** pp_filter)
+{
+    if ((NULL == pp_filter) || (NULL == *pp_filter))
+    {
+        return;
+    }
+
+    free((*pp_filter)->p_owned);
+    free(*pp_filter);
+    *pp_filter = NULL;
+}
+
+int
+bloom_filter_add(bloom_filter_t * p_filter, uint64_t hash)
+{
+    uint32_t masks[BLOOM_WORDS];
+
+    if (NULL == p_filter)
+    {
+        return FILTER_ERROR_PARAM;
+    }
+
+    if (NULL == p_filter->p_owned)
+    {
+        return FILTER_ERROR_READ_ONLY;
+    }
+
+    uint32_t * p_block = p_filter->p_owned
+                         + (bloom_block(p_filter, hash) * BLOOM_WORDS);
+
+    bloom_masks((uint32_t)hash, masks);
+
+    for (uint32_t word = 0u; word < BLOOM_WORDS; word++)
+    {
+        p_block[word] |= masks[word];
+    }
+
+    return FILTER_SUCCESS;
+}
+
+bool
+bloom_filter_may_contain(const bloom_filter_t * p_filter, uint64_t hash)
+{
+    uint32_t masks[BLOOM_WORDS];
+    uint32_t missing = 0u;
+
+    if (NULL == p_filter)
+    {
+        return false;
+    }
+
+    const uint32_t * p_block = p_filter->p_words
+                               + (bloom_block(p_filter, hash) * BLOOM_WORDS);
+
+    bloom_masks((uint32_t)hash, masks);
+
+    // No early exit, so the eight tests stay one straight vector sequence
+    for (uint32_t word = 0u; word < BLOOM_WORDS; word++)
+    {
+        missing |= masks[word] & ~p_block[word];
+    }
+
+    return 0u == missing;
+}
+
+size_t
+bloom_filter_image_size(const bloom_filter_t * p_filter)
+{
+    if (NULL == p_filter)
+    {
+        return 0u;
+    }
+
+    return FILTER_IMAGE_HEADER
+           + ((size_t)p_filter->block_count * BLOOM_WORDS * sizeof(uint32_t));
+}
+
+int
+bloom_filter_save(const bloom_filter_t * p_filter, void * p_image, size_t size)
+{
+    image_header_t header;
+    size_t         table_bytes = 0u;
+
+    if ((NULL == p_filter) || (NULL == p_image)
+        || (size < bloom_filter_image_size(p_filter)))
+    {
+        return FILTER_ERROR_PARAM;
+    }
+
+    table_bytes = bloom_filter_image_size(p_filter) - FILTER_IMAGE_HEADER;
+
+    memset(&header, 0, sizeof(header));
+    header.magic       = BLOOM_MAGIC;
+    header.version     = IMAGE_VERSION;
+    header.units       = p_filter->block_count;
+    header.table_bytes = table_bytes;
+
+    memcpy(p_image, &header, sizeof(header));
+    memcpy((uint8_t *)p_image + FILTER_IMAGE_HEADER,
+           p_filter->p_words,
+           table_bytes);
+    return FILTER_SUCCESS;
+}
+
+bloom_filter_t *
+bloom_filter_open(const void * p_image, size_t size)
+{
+    const image_header_t * p_header = p_image;
+    bloom_filter_t *       p_filter = NULL;
+
+    if (!check_header(p_header, size, BLOOM_MAGIC) || (0u == p_header->units)
+        || (p_header->units > MAX_UNITS)
+        || (p_header->table_bytes / (BLOOM_WORDS * sizeof(uint32_t))
+            != p_header->units)
+        || (0u != p_header->table_bytes % (BLOOM_WORDS * sizeof(uint32_t))))
+    {
+        return NULL;
+    }
+
+    p_filter = calloc(1u, sizeof(*p_filter));
+
+    if (NULL == p_filter)
+    {
+        return NULL;
+    }
+
+    p_filter->p_words = (const uint32_t *)(const void *)(
+        (const uint8_t *)p_image + FILTER_IMAGE_HEADER);
+    p_filter->block_count = p_header->units;
+    return p_filter;
+}
+
+cuckoo_filter_t *
+cuckoo_filter_create(uint64_t capacity, double fpr)
+{
+    cuckoo_filter_t * p_filter = NULL;
+    uint64_t          buckets  = 0u;
+
+    if ((0u == capacity) || !(fpr > 0.0) || !(fpr < 1.0))
+    {
+        return NULL;
+    }
+
+    // A lookup checks two buckets of four, so it fails about 8 / 2^bits
+    // of the time
+    uint32_t bits = ((8.0 / 255.0) <= fpr) ? 8u : 16u;
+
+    double slots_needed = (double)capacity / CUCKOO_LOAD;
+
+    buckets = (uint64_t)(slots_needed / CUCKOO_SLOTS) + 1u;
+
+    if ((slots_needed / CUCKOO_SLOTS >= (double)MAX_UNITS)
+        || (buckets > SIZE_MAX / (CUCKOO_SLOTS * 2u)))
+    {
+        return NULL;
+    }
+
+    p_filter = calloc(1u, sizeof(*p_filter));
+
+    if (NULL == p_filter)
+    {
+        return NULL;
+    }
+
+    size_t bytes = (size_t)buckets * CUCKOO_SLOTS * (bits / 8u);
+
+    if (0 != posix_memalign((void **)&p_filter->p_owned, CACHE_LINE, bytes))
+    {
+        free(p_filter);
+        return NULL;
+    }
+
+    memset(p_filter->p_owned, 0, bytes);
+    p_filter->p_table     = p_filter->p_owned;
+    p_filter->bucket_count = buckets;
+    p_filter->bits         = bits;
+    p_filter->rng          = 0x2545F4914F6CDD1Dull;
+    return p_filter;
+}
+
+void
+cuckoo_filter_destroy(cuckoo_filter_t ** pp_filter)
+{
+    if ((NULL == pp_filter) || (NULL == *pp_filter))
+    {
+        return;
+    }
+
+    free((*pp_filter)->p_owned);
+    free(*pp_filter);
+    *pp_filter = NULL;
+}
+
+int
+cuckoo_filter_add(cuckoo_filter_t * p_filter, uint64_t hash)
+{
+    if (NULL == p_filter)
+    {
+        return FILTER_ERROR_PARAM;
+    }
+
+    if (NULL == p_filter->p_owned)
+    {
+        return FILTER_ERROR_READ_ONLY;
+    }
+
+    if (0u != p_filter->victim.fingerprint)
+    {
+        return FILTER_ERROR_FULL;
+    }
+
+    uint32_t fp    = fingerprint(p_filter, hash);
+    uint64_t index = first_index(p_filter, hash);
+
+    p_filter->count++;
+
+    if (try_place(p_filter, index, fp)
+        || try_place(p_filter, alt_index(p_filter, index, fp), fp))
+    {
+        return FILTER_SUCCESS;
+    }
+
+    if (0u != (p_filter->rng & 4u))
+    {
+        index = alt_index(p_filter, index, fp);
+    }
+
+    for (uint32_t kick = 0u; kick < MAX_KICKS; kick++)
+    {
+        p_filter->rng ^= p_filter->rng << 13;
+        p_filter->rng ^= p_filter->rng >> 7;
+        p_filter->rng ^= p_filter->rng << 17;
+
+        // Swap with a random resident, then re-home the resident
+        uint32_t shift  = (uint32_t)(p_filter->rng & 3u) * p_filter->bits;
+        uint64_t lane   = (1ull << p_filter->bits) - 1u;
+        uint64_t bucket = load_bucket(p_filter, index);
+        uint32_t kicked = (uint32_t)((bucket >> shift) & lane);
+
+        bucket = (bucket & ~(lane << shift)) | ((uint64_t)fp << shift);
+        store_bucket(p_filter, index, bucket);
+
+        fp    = kicked;
+        index = alt_index(p_filter, index, fp);
+
+        if (try_place(p_filter, index, fp))
+        {
+            return FILTER_SUCCESS;
+        }
+    }
+
+    p_filter->victim.index       = index;
+    p_filter->victim.fingerprint = fp;
+    return FILTER_SUCCESS;
+}
+
+bool
+cuckoo_filter_remove(cuckoo_filter_t * p_filter, uint64_t hash)
+{
+    if ((NULL == p_filter) || (NULL == p_filter->p_owned))
+    {
+        return false;
+    }
+
+    uint32_t        fp     = fingerprint(p_filter, hash);
+    uint64_t        index  = first_index(p_filter, hash);
+    uint64_t        other  = alt_index(p_filter, index, fp);
+    cuckoo_victim_t victim = p_filter->victim;
+
+    if ((fp == victim.fingerprint)
+        && ((index == victim.index) || (other == victim.index)))
+    {
+        p_filter->victim.fingerprint = 0u;
+        p_filter->count--;
+        return true;
+    }
+
+    if (!try_take(p_filter, index, fp) && !try_take(p_filter, other, fp))
+    {
+        return false;
+    }
+
+    p_filter->count--;
+
+    // The slot just freed may be one the stashed fingerprint can use
+    if (0u != victim.fingerprint)
+    {
+        if (try_place(p_filter, victim.index, victim.fingerprint)
+            || try_place(p_filter,
+                         alt_index(p_filter, victim.index, victim.fingerprint),
+                         victim.fingerprint))
+        {
+            p_filter->victim.fingerprint = 0u;
+        }
+    }
+
+    return true;
+}
+
+bool
+cuckoo_filter_may_contain(const cuckoo_filter_t * p_filter, uint64_t hash)
+{
+    if (NULL == p_filter)
+    {
+        return false;
+    }
+
+    uint32_t fp    = fingerprint(p_filter, hash);
+    uint64_t index = first_index(p_filter, hash);
+    uint64_t other = alt_index(p_filter, index, fp);
+
+    if (bucket_has(load_bucket(p_filter, index), fp, p_filter->bits)
+        || bucket_has(load_bucket(p_filter, other), fp, p_filter->bits))
+    {
+        return true;
+    }
+
+    return (fp == p_filter->victim.fingerprint)
+           && ((index == p_filter->victim.index)
+               || (other == p_filter->victim.index));
+}
+
+uint64_t
+cuckoo_filter_count(const cuckoo_filter_t * p_filter)
+{
+    return (NULL == p_filter) ? 0u : p_filter->count;
+}
+
+size_t
+cuckoo_filter_image_size(const cuckoo_filter_t * p_filter)
+{
+    if (NULL == p_filter)
+    {
+        return 0u;
+    }
+
+    return FILTER_IMAGE_HEADER
+           + ((size_t)p_filter->bucket_count * CUCKOO_SLOTS
+              * (p_filter->bits / 8u));
+}
+
+int
+cuckoo_filter_save(const cuckoo_filter_t * p_filter,
+                   void *                  p_image,
+                   size_t                  size)
+{
+    image_header_t header;
+    size_t         table_bytes = 0u;
+
+    if ((NULL == p_filter) || (NULL == p_image)
+        || (size < cuckoo_filter_image_size(p_filter)))
+    {
+        return FILTER_ERROR_PARAM;
+    }
+
+    table_bytes = cuckoo_filter_image_size(p_filter) - FILTER_IMAGE_HEADER;
+
+    memset(&header, 0, sizeof(header));
+    header.magic        = CUCKOO_MAGIC;
+    header.version      = IMAGE_VERSION;
+    header.bits         = p_filter->bits;
+    header.victim_fp    = p_filter->victim.fingerprint;
+    header.units        = p_filter->bucket_count;
+    header.count        = p_filter->count;
+    header.victim_index = p_filter->victim.index;
+    header.table_bytes  = table_bytes;
+
+    memcpy(p_image, &header, sizeof(header));
+    memcpy((uint8_t *)p_image + FILTER_IMAGE_HEADER,
+           p_filter->p_table,
+           table_bytes);
+    return FILTER_SUCCESS;
+}
+
+cuckoo_filter_t *
+cuckoo_filter_open(const void * p_image, size_t size)
+{
+    const image_header_t * p_header = p_image;
+    cuckoo_filter_t *      p_filter = NULL;
+
+    if (!check_header(p_header, size, CUCKOO_MAGIC)
+        || ((8u != p_header->bits) && (16u != p_header->bits))
+        || (0u == p_header->units) || (p_header->units > MAX_UNITS)
+        || (p_header->table_bytes / (CUCKOO_SLOTS * (p_header->bits / 8u))
+            != p_header->units)
+        || (p_header->victim_index >= p_header->units)
+        || (p_header->victim_fp >> p_header->bits != 0u))
+    {
+        return NULL;
+    }
+
+    p_filter = calloc(1u, sizeof(*p_filter));
+
+    if (NULL == p_filter)
+    {
+        return NULL;
+    }
+
+    p_filter->p_table            = (const uint8_t *)p_image
+                                   + FILTER_IMAGE_HEADER;
+    p_filter->bucket_count       = p_header->units;
+    p_filter->count              = p_header->count;
+    p_filter->bits               = p_header->bits;
+    p_filter->victim.index       = p_header->victim_index;
+    p_filter->victim.fingerprint = p_header->victim_fp;
+    return p_filter;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Finalizer from MurmurHash3: every input bit affects every output
+ *        bit.
+ */
+static uint64_t
+mix64(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+/*!
+ * @brief Expected false-positive rate of a split-block filter with the
+ *        given bits per key, when full.
+ *
+ * With lambda keys per block on average, a block holds j keys with
+ * Poisson probability, and then each of its words has each bit set with
+ * probability 1 - (31/32)^j. The Poisson weights are built up as ratios
+ * and normalized at the end, which avoids exp() and libm.
+ */
+static double
+bloom_rate(double bits_per_key)
+{
+    double lambda = BLOOM_BLOCK_BITS / bits_per_key;
+    double weight = 1.0;
+    double clear  = 1.0;   /* (31/32)^j */
+    double total  = 0.0;
+    double rate   = 0.0;
+
+    for (uint32_t keys = 0u; keys < (uint32_t)(lambda * 4.0) + 64u; keys++)
+    {
+        double word_rate = 1.0 - clear;
+        double all_words = 1.0;
+
+        for (uint32_t word = 0u; word < BLOOM_WORDS; word++)
+        {
+            all_words *= word_rate;
+        }
+
+        total  += weight;
+        rate   += weight * all_words;
+        weight *= lambda / (double)(keys + 1u);
+        clear  *= 31.0 / 32.0;
+    }
+
+    return rate / total;
+}
+
+/*!
+ * @brief One bit per block word for a key: the top five bits of key times
+ *        the word's salt.
+ */
+static void
+bloom_masks(uint32_t key, uint32_t * p_masks)
+{
+    for (uint32_t word = 0u; word < BLOOM_WORDS; word++)
+    {
+        p_masks[word] = 1u << ((key * g_salts[word]) >> 27);
+    }
+}
+
+/*!
+ * @brief Maps a 32-bit value onto 0 .. count - 1 without a division.
+ */
+static uint64_t
+scale(uint64_t value, uint64_t count)
+{
+    return (value * count) >> 32;
+}
+
+static uint64_t
+bloom_block(const bloom_filter_t * p_filter, uint64_t hash)
+{
+    return scale(hash >> 32, p_filter->block_count);
+}
+
+static uint64_t
+load_bucket(const cuckoo_filter_t * p_filter, uint64_t index)
+{
+    if (8u == p_filter->bits)
+    {
+        uint32_t bucket;
+
+        memcpy(&bucket, p_filter->p_table + (index * 4u), sizeof(bucket));
+        return bucket;
+    }
+
+    uint64_t bucket;
+
+    memcpy(&bucket, p_filter->p_table + (index * 8u), sizeof(bucket));
+    return bucket;
+}
+
+static void
+store_bucket(cuckoo_filter_t * p_filter, uint64_t index, uint64_t bucket)
+{
+    if (8u == p_filter->bits)
+    {
+        uint32_t narrow = (uint32_t)bucket;
+
+        memcpy(p_filter->p_owned + (index * 4u), &narrow, sizeof(narrow));
+        return;
+    }
+
+    memcpy(p_filter->p_owned + (index * 8u), &bucket, sizeof(bucket));
+}
+
+/*!
+ * @brief Whether any lane of the bucket holds fp, testing all four at
+ *        once: XOR turns matching lanes to zero, and (v - ones) & ~v has a
+ *        lane's top bit set only if some lane of v is zero.
+ */
+static bool
+bucket_has(uint64_t bucket, uint32_t fp, uint32_t bits)
+{
+    uint64_t ones  = (8u == bits) ? 0x01010101ull : 0x0001000100010001ull;
+    uint64_t highs = ones << (bits - 1u);
+    uint64_t value = bucket ^ (ones * fp);
+
+    return 0u != ((value - ones) & ~value & highs);
+}
+
+static uint32_t
+fingerprint(const cuckoo_filter_t * p_filter, uint64_t hash)
+{
+    uint32_t fp = (uint32_t)hash & ((1u << p_filter->bits) - 1u);
+
+    return (0u == fp) ? 1u : fp;
+}
+
+static uint64_t
+first_index(const cuckoo_filter_t * p_filter, uint64_t hash)
+{
+    return scale(hash >> 32, p_filter->bucket_count);
+}
+
+/*!
+ * @brief The other bucket for fp: (h - index) mod n, which maps each of
+ *        the two buckets to the other.
+ */
+static uint64_t
+alt_index(const cuckoo_filter_t * p_filter, uint64_t index, uint32_t fp)
+{
+    uint64_t other = scale(mix64(fp) >> 32, p_filter->bucket_count);
+
+    return (other >= index) ? (other - index)
+                            : (other + p_filter->bucket_count - index);
+}
+
+/*!
+ * @brief Puts fp in a free lane of the bucket, if it has one.
+ */
+static bool
+try_place(cuckoo_filter_t * p_filter, uint64_t index, uint32_t fp)
+{
+    uint64_t bucket = load_bucket(p_filter, index);
+    uint64_t lane   = (1ull << p_filter->bits) - 1u;
+
+    for (uint32_t slot = 0u; slot < CUCKOO_SLOTS; slot++)
+    {
+        uint32_t shift = slot * p_filter->bits;
+
+        if (0u == ((bucket >> shift) & lane))
+        {
+            store_bucket(p_filter, index, bucket | ((uint64_t)fp << shift));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * @brief Clears one lane of the bucket holding fp, if there is one.
+ */
+static bool
+try_take(cuckoo_filter_t * p_filter, uint64_t index, uint32_t fp)
+{
+    uint64_t bucket = load_bucket(p_filter, index);
+    uint64_t lane   = (1ull << p_filter->bits) - 1u;
+
+    for (uint32_t slot = 0u; slot < CUCKOO_SLOTS; slot++)
+    {
+        uint32_t shift = slot * p_filter->bits;
+
+        if (fp == ((bucket >> shift) & lane))
+        {
+            store_bucket(p_filter, index, bucket & ~(lane << shift));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * @brief Checks what every image shares: alignment, size, magic and
+ *        version, and a table that fits in the bytes given.
+ */
+static bool
+check_header(const image_header_t * p_header, size_t size, uint32_t magic)
+{
+    if ((NULL == p_header) || (size < FILTER_IMAGE_HEADER)
+        || (0u != ((uintptr_t)p_header & 7u)))
+    {
+        return false;
+    }
+
+    return (magic == p_header->magic) && (IMAGE_VERSION == p_header->version)
+           && (p_header->table_bytes <= size - FILTER_IMAGE_HEADER);
+}
+
+/*** end of file ***/
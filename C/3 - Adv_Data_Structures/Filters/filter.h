@@ -0,0 +1,252 @@
+/** @file filter.h
+ *
+ * @brief Blocked Bloom filter and cuckoo filter for fast negative lookups.
+ *
+ * Both answer "may this key be in the set?" with no false negatives and a
+ * false-positive rate chosen at creation. Put one in front of a slower
+ * lookup (a hash table, a linear scan, an index on disk) and most misses
+ * never reach it.
+ *
+ * - bloom_filter_t is a split-block Bloom filter. A key maps to one
+ *   32-byte block of eight 32-bit words and sets one bit in each word, so
+ *   a lookup reads half a cache line, and its eight word tests are a
+ *   fixed-length loop the compiler can vectorize. Keys cannot be removed.
+ * - cuckoo_filter_t keeps an 8- or 16-bit fingerprint of each key in one
+ *   of two buckets of four slots. A bucket is one 32- or 64-bit word, so a
+ *   lookup compares all four slots at once with word arithmetic and reads
+ *   at most two words. Keys can be removed. Inserts fail once the table is
+ *   about 95% full.
+ *
+ * The filters take a 64-bit hash of the key rather than the key, so they
+ * work with any key type. filter_hash() is provided for byte strings.
+ * Filters built with one hash function must only be queried with it.
+ *
+ * A filter can be saved as an image: a 64-byte header followed by its
+ * table. The image can be written next to an index file and later opened
+ * in place, e.g. from mmap(). An opened image is a read-only view and is
+ * never copied, so it must stay mapped until the filter is destroyed, and
+ * be 8-byte aligned. Images use the host's byte order.
+ *
+ * The filters are not thread-safe; concurrent lookups with no writer are.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define FILTER_SUCCESS          (0)
+#define FILTER_ERROR_PARAM      (-1)
+#define FILTER_ERROR_MEMORY     (-2)
+#define FILTER_ERROR_FULL       (-3)  /* Cuckoo filter cannot place a key */
+#define FILTER_ERROR_READ_ONLY  (-4)  /* Filter is an opened image */
+#define FILTER_ERROR_FORMAT     (-5)  /* Image is damaged or foreign */
+
+#define FILTER_IMAGE_HEADER     (64u) /* Bytes before the table */
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct bloom_filter bloom_filter_t;
+typedef struct cuckoo_filter cuckoo_filter_t;
+
+/*************************************************************************
+ * Function Declarations: hashing
+ *************************************************************************/
+
+/*!
+ * @brief 64-bit hash of a byte string, suitable for both filters.
+ *
+ * @param[in] p_key Key bytes
+ * @param[in] len   Number of bytes
+ *
+ * @return Hash
+ */
+uint64_t
+filter_hash(const void * p_key, size_t len);
+
+/*************************************************************************
+ * Function Declarations: Bloom filter
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty Bloom filter.
+ *
+ * @param[in] capacity Keys it is sized for; more keys raise the rate
+ * @param[in] fpr      Target false-positive rate at capacity, e.g. 0.01
+ *
+ * @return Pointer to the filter, or NULL on failure
+ */
+bloom_filter_t *
+bloom_filter_create(uint64_t capacity, double fpr);
+
+/*!
+ * @brief Frees a filter, created or opened.
+ *
+ * @param[in,out] pp_filter Pointer to the filter pointer; set to NULL
+ */
+void
+bloom_filter_destroy(bloom_filter_t ** pp_filter);
+
+/*!
+ * @brief Adds a key.
+ *
+ * @param[in,out] p_filter Filter
+ * @param[in]     hash     Hash of the key
+ *
+ * @return FILTER_SUCCESS or a negative error code
+ */
+int
+bloom_filter_add(bloom_filter_t * p_filter, uint64_t hash);
+
+/*!
+ * @brief Whether a key may have been added.
+ *
+ * @param[in] p_filter Filter
+ * @param[in] hash     Hash of the key
+ *
+ * @return false if the key was certainly never added
+ */
+bool
+bloom_filter_may_contain(const bloom_filter_t * p_filter, uint64_t hash);
+
+/*!
+ * @brief Number of bytes bloom_filter_save() writes.
+ */
+size_t
+bloom_filter_image_size(const bloom_filter_t * p_filter);
+
+/*!
+ * @brief Writes the filter as an image.
+ *
+ * @param[in]  p_filter Filter
+ * @param[out] p_image  Buffer of at least bloom_filter_image_size() bytes
+ * @param[in]  size     Size of the buffer
+ *
+ * @return FILTER_SUCCESS or FILTER_ERROR_PARAM
+ */
+int
+bloom_filter_save(const bloom_filter_t * p_filter, void * p_image, size_t size);
+
+/*!
+ * @brief Opens a saved image in place, as a read-only filter.
+ *
+ * @param[in] p_image Image, 8-byte aligned, kept valid until destroy
+ * @param[in] size    Bytes available at p_image
+ *
+ * @return Pointer to the filter, or NULL for a bad image or no memory
+ */
+bloom_filter_t *
+bloom_filter_open(const void * p_image, size_t size);
+
+/*************************************************************************
+ * Function Declarations: cuckoo filter
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty cuckoo filter.
+ *
+ * @param[in] capacity Keys it must hold
+ * @param[in] fpr      Target false-positive rate; 8-bit fingerprints
+ *                     give about 3%, 16-bit ones about 1.2e-4, and
+ *                     lower targets get 16 bits
+ *
+ * @return Pointer to the filter, or NULL on failure
+ */
+cuckoo_filter_t *
+cuckoo_filter_create(uint64_t capacity, double fpr);
+
+/*!
+ * @brief Frees a filter, created or opened.
+ *
+ * @param[in,out] pp_filter Pointer to the filter pointer; set to NULL
+ */
+void
+cuckoo_filter_destroy(cuckoo_filter_t ** pp_filter);
+
+/*!
+ * @brief Adds a key. Adding a key twice stores it twice; up to eight
+ *        copies fit.
+ *
+ * @param[in,out] p_filter Filter
+ * @param[in]     hash     Hash of the key
+ *
+ * @return FILTER_SUCCESS or a negative error code; FILTER_ERROR_FULL
+ *         leaves every key already added in place
+ */
+int
+cuckoo_filter_add(cuckoo_filter_t * p_filter, uint64_t hash);
+
+/*!
+ * @brief Removes one copy of a key. Only remove keys that were added, or
+ *        another key sharing the fingerprint may be removed instead.
+ *
+ * @param[in,out] p_filter Filter
+ * @param[in]     hash     Hash of the key
+ *
+ * @return true if a copy was removed
+ */
+bool
+cuckoo_filter_remove(cuckoo_filter_t * p_filter, uint64_t hash);
+
+/*!
+ * @brief Whether a key may be in the filter.
+ *
+ * @param[in] p_filter Filter
+ * @param[in] hash     Hash of the key
+ *
+ * @return false if the key is certainly not in the filter
+ */
+bool
+cuckoo_filter_may_contain(const cuckoo_filter_t * p_filter, uint64_t hash);
+
+/*!
+ * @brief Number of keys in the filter.
+ */
+uint64_t
+cuckoo_filter_count(const cuckoo_filter_t * p_filter);
+
+/*!
+ * @brief Number of bytes cuckoo_filter_save() writes.
+ */
+size_t
+cuckoo_filter_image_size(const cuckoo_filter_t * p_filter);
+
+/*!
+ * @brief Writes the filter as an image.
+ *
+ * @param[in]  p_filter Filter
+ * @param[out] p_image  Buffer of at least cuckoo_filter_image_size() bytes
+ * @param[in]  size     Size of the buffer
+ *
+ * @return FILTER_SUCCESS or FILTER_ERROR_PARAM
+ */
+int
+cuckoo_filter_save(const cuckoo_filter_t * p_filter,
+                   void *                  p_image,
+                   size_t                  size);
+
+/*!
+ * @brief Opens a saved image in place, as a read-only filter.
+ *
+ * @param[in] p_image Image, 8-byte aligned, kept valid until destroy
+ * @param[in] size    Bytes available at p_image
+ *
+ * @return Pointer to the filter, or NULL for a bad image or no memory
+ */
+cuckoo_filter_t *
+cuckoo_filter_open(const void * p_image, size_t size);
+
+#endif /* FILTER_H */
+
+/*** end of file ***/
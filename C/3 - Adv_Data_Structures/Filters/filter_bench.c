@@ -0,0 +1,472 @@
+/** @file filter_bench.c
+ *
+ * @brief Lookups that mostly miss, with and without a filter in front.
+ *
+ * KEYS usernames are loaded into two lookup structures:
+ *
+ * - a hash_table_t keyed by the name;
+ * - a sorted array of names searched by bisection, standing in for an
+ *   index file, where a miss costs about log2(KEYS) string compares on
+ *   cold pages.
+ *
+ * Each is queried with names of which only one in ten was loaded, first
+ * directly, then behind a Bloom filter and behind a cuckoo filter built
+ * for FPR. Every configuration must find the same names. The filters'
+ * measured false-positive rates are printed, and both are saved to a file,
+ * mapped back with mmap() and queried again, to check that an opened image
+ * answers exactly as the filter it was saved from.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L filter_bench.c
+ *        filter.c "../../1 - Basic_Data_Structures/5 - Hash_Table/hash_table.c"
+ *        "../../1 - Basic_Data_Structures/0 - Allocator/allocator.c"
+ *
+ * Usage: filter_bench [keys] [queries] [fpr]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "filter.h"
+#include "../../1 - Basic_Data_Structures/5 - Hash_Table/hash_table.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_KEYS    (1000000u)
+#define DEFAULT_QUERIES (10000000u)
+#define DEFAULT_FPR     (0.01)
+#define HIT_PERCENT     (10u)
+#define NAME_LEN        (16u)
+#define IMAGE_PATH      "filter_bench.img"
+#define SEED            (0x9E3779B97F4A7C15ull)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+typedef struct
+{
+    char text[NAME_LEN];
+} name_t;
+
+typedef enum
+{
+    FRONT_NONE = 0,
+    FRONT_BLOOM,
+    FRONT_CUCKOO,
+    FRONT_COUNT
+} front_t;
+
+typedef enum
+{
+    STORE_HASH = 0,
+    STORE_SORTED,
+    STORE_COUNT
+} store_t;
+
+typedef struct
+{
+    hash_table_t            table;
+    name_t *                p_sorted;
+    uint32_t                key_count;
+    const name_t *          p_queries;
+    uint32_t                query_count;
+    const bloom_filter_t *  p_bloom;
+    const cuckoo_filter_t * p_cuckoo;
+} bench_state_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const char * const g_front_names[FRONT_COUNT] = {
+    "plain", "+bloom", "+cuckoo"
+};
+
+static const char * const g_store_names[STORE_COUNT] = {
+    "hash_table_t", "sorted index"
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void     make_name(uint32_t id, name_t * p_name);
+static uint32_t hash_name(const void * p_key, uint32_t capacity);
+static bool     names_equal(const void * p_lhs, const void * p_rhs);
+static int      compare_names(const void * p_lhs, const void * p_rhs);
+static bool     sorted_contains(const bench_state_t * p_state,
+                                const char *          p_name);
+static uint64_t run_queries(const bench_state_t * p_state,
+                            store_t               store,
+                            front_t               front,
+                            double *              p_ns);
+static double   false_positive_rate(const bench_state_t * p_state,
+                                    front_t               front);
+static bool     check_images(bench_state_t * p_state);
+static double   now_seconds(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    bench_state_t     state    = { 0 };
+    uint32_t          queries  = DEFAULT_QUERIES;
+    double            fpr      = DEFAULT_FPR;
+    bloom_filter_t *  p_bloom  = NULL;
+    cuckoo_filter_t * p_cuckoo = NULL;
+    name_t *          p_asked  = NULL;
+    int               status   = EXIT_SUCCESS;
+
+    state.key_count = DEFAULT_KEYS;
+
+    if (argc > 1)
+    {
+        state.key_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        queries = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        fpr = strtod(argv[3], NULL);
+    }
+
+    if ((0u == state.key_count) || (0u == queries) || !(fpr > 0.0)
+        || !(fpr < 1.0))
+    {
+        fprintf(stderr, "usage: %s [keys] [queries] [fpr 0-1]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    state.p_sorted = calloc(state.key_count, sizeof(name_t));
+    p_asked        = calloc(queries, sizeof(name_t));
+    p_bloom        = bloom_filter_create(state.key_count, fpr);
+    p_cuckoo       = cuckoo_filter_create(state.key_count, fpr);
+
+    if ((NULL == state.p_sorted) || (NULL == p_asked) || (NULL == p_bloom)
+        || (NULL == p_cuckoo)
+        || !hash_table_init(&state.table, state.key_count, 0.75f, hash_name,
+                            names_equal, NULL, NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // Loaded names have even ids; a query is a loaded name HIT_PERCENT of
+    // the time and an odd id otherwise
+    for (uint32_t idx = 0u; idx < state.key_count; idx++)
+    {
+        name_t * p_name = &state.p_sorted[idx];
+
+        make_name(idx * 2u, p_name);
+        (void)bloom_filter_add(p_bloom,
+                               filter_hash(p_name->text, strlen(p_name->text)));
+        (void)cuckoo_filter_add(p_cuckoo,
+                                filter_hash(p_name->text,
+                                            strlen(p_name->text)));
+    }
+
+    // The table keeps pointers to the names, so it is filled after the sort
+    qsort(state.p_sorted, state.key_count, sizeof(name_t), compare_names);
+
+    for (uint32_t idx = 0u; idx < state.key_count; idx++)
+    {
+        (void)hash_table_put(&state.table, &state.p_sorted[idx],
+                             &state.p_sorted[idx]);
+    }
+
+    uint64_t rng = SEED;
+
+    for (uint32_t idx = 0u; idx < queries; idx++)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+
+        uint32_t id = (uint32_t)((rng >> 8) % state.key_count) * 2u;
+
+        make_name(((rng % 100u) < HIT_PERCENT) ? id : (id + 1u), &p_asked[idx]);
+    }
+
+    state.p_queries   = p_asked;
+    state.query_count = queries;
+    state.p_bloom     = p_bloom;
+    state.p_cuckoo    = p_cuckoo;
+
+    printf("%u keys, %u queries, %u%% hits, target fpr %g\n",
+           state.key_count, queries, HIT_PERCENT, fpr);
+    printf("bloom  %8.2f MB  measured fpr %.4f\n",
+           (double)bloom_filter_image_size(p_bloom) / 1e6,
+           false_positive_rate(&state, FRONT_BLOOM));
+    printf("cuckoo %8.2f MB  measured fpr %.4f\n",
+           (double)cuckoo_filter_image_size(p_cuckoo) / 1e6,
+           false_positive_rate(&state, FRONT_CUCKOO));
+
+    for (int store = 0; store < STORE_COUNT; store++)
+    {
+        uint64_t expected = 0u;
+
+        for (int front = 0; front < FRONT_COUNT; front++)
+        {
+            double   ns   = 0.0;
+            uint64_t hits = run_queries(&state, (store_t)store,
+                                        (front_t)front, &ns);
+
+            if (FRONT_NONE == front)
+            {
+                expected = hits;
+            }
+
+            printf("%-13s %-8s %7.1f ns/query  hits %llu%s\n",
+                   g_store_names[store], g_front_names[front], ns,
+                   (unsigned long long)hits,
+                   (hits == expected) ? "" : "  WRONG");
+
+            if (hits != expected)
+            {
+                status = EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (!check_images(&state))
+    {
+        status = EXIT_FAILURE;
+    }
+
+    hash_table_destroy(&state.table, false);
+    bloom_filter_destroy(&p_bloom);
+    cuckoo_filter_destroy(&p_cuckoo);
+    free(state.p_sorted);
+    free(p_asked);
+    return status;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief The username for an id, scrambled so neighbours are not adjacent
+ *        in sorted order.
+ */
+static void
+make_name(uint32_t id, name_t * p_name)
+{
+    uint32_t mixed = id * 0x9E3779B1u;
+
+    (void)snprintf(p_name->text, NAME_LEN, "u%08x%05u", mixed, id % 100000u);
+}
+
+static uint32_t
+hash_name(const void * p_key, uint32_t capacity)
+{
+    const name_t * p_name = p_key;
+
+    return (uint32_t)(filter_hash(p_name->text, strlen(p_name->text))
+                      % capacity);
+}
+
+static bool
+names_equal(const void * p_lhs, const void * p_rhs)
+{
+    return 0 == compare_names(p_lhs, p_rhs);
+}
+
+static int
+compare_names(const void * p_lhs, const void * p_rhs)
+{
+    const name_t * p_left  = p_lhs;
+    const name_t * p_right = p_rhs;
+
+    return strcmp(p_left->text, p_right->text);
+}
+
+static bool
+sorted_contains(const bench_state_t * p_state, const char * p_name)
+{
+    uint32_t low  = 0u;
+    uint32_t high = p_state->key_count;
+
+    while (low < high)
+    {
+        uint32_t mid   = low + ((high - low) / 2u);
+        int      order = strcmp(p_state->p_sorted[mid].text, p_name);
+
+        if (0 == order)
+        {
+            return true;
+        }
+
+        if (order < 0)
+        {
+            low = mid + 1u;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * @brief Runs every query against one configuration.
+ *
+ * @return Number of queries found
+ */
+static uint64_t
+run_queries(const bench_state_t * p_state,
+            store_t               store,
+            front_t               front,
+            double *              p_ns)
+{
+    uint64_t hits  = 0u;
+    double   start = now_seconds();
+
+    for (uint32_t idx = 0u; idx < p_state->query_count; idx++)
+    {
+        const name_t * p_name = &p_state->p_queries[idx];
+
+        if (FRONT_NONE != front)
+        {
+            uint64_t hash = filter_hash(p_name->text, strlen(p_name->text));
+            bool     b_may
+                = (FRONT_BLOOM == front)
+                      ? bloom_filter_may_contain(p_state->p_bloom, hash)
+                      : cuckoo_filter_may_contain(p_state->p_cuckoo, hash);
+
+            if (!b_may)
+            {
+                continue;
+            }
+        }
+
+        bool b_found = (STORE_HASH == store)
+                           ? hash_table_contains_key(&p_state->table, p_name)
+                           : sorted_contains(p_state, p_name->text);
+
+        hits += b_found ? 1u : 0u;
+    }
+
+    *p_ns = (now_seconds() - start) * 1e9 / (double)p_state->query_count;
+    return hits;
+}
+
+/*!
+ * @brief Fraction of names never loaded that the filter lets through.
+ */
+static double
+false_positive_rate(const bench_state_t * p_state, front_t front)
+{
+    uint64_t passed = 0u;
+    name_t   name;
+
+    for (uint32_t idx = 0u; idx < p_state->key_count; idx++)
+    {
+        make_name((idx * 2u) + 1u, &name);
+
+        uint64_t hash = filter_hash(name.text, strlen(name.text));
+
+        if ((FRONT_BLOOM == front)
+                ? bloom_filter_may_contain(p_state->p_bloom, hash)
+                : cuckoo_filter_may_contain(p_state->p_cuckoo, hash))
+        {
+            passed++;
+        }
+    }
+
+    return (double)passed / (double)p_state->key_count;
+}
+
+/*!
+ * @brief Saves both filters to one file, maps it, opens the images in
+ *        place and checks they answer every query as the originals do.
+ */
+static bool
+check_images(bench_state_t * p_state)
+{
+    size_t bloom_size  = bloom_filter_image_size(p_state->p_bloom);
+    size_t cuckoo_size = cuckoo_filter_image_size(p_state->p_cuckoo);
+    size_t total       = bloom_size + cuckoo_size;
+    int    fd          = open(IMAGE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    bool   b_ok        = false;
+
+    if ((fd < 0) || (0 != ftruncate(fd, (off_t)total)))
+    {
+        perror(IMAGE_PATH);
+        return false;
+    }
+
+    uint8_t * p_map = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fd, 0);
+
+    (void)close(fd);
+    (void)unlink(IMAGE_PATH);
+
+    if (MAP_FAILED == p_map)
+    {
+        perror("mmap");
+        return false;
+    }
+
+    // Both sizes are multiples of 32, so the second image stays aligned
+    (void)bloom_filter_save(p_state->p_bloom, p_map, bloom_size);
+    (void)cuckoo_filter_save(p_state->p_cuckoo, p_map + bloom_size,
+                             cuckoo_size);
+
+    bloom_filter_t *  p_bloom  = bloom_filter_open(p_map, bloom_size);
+    cuckoo_filter_t * p_cuckoo = cuckoo_filter_open(p_map + bloom_size,
+                                                    cuckoo_size);
+
+    if ((NULL != p_bloom) && (NULL != p_cuckoo))
+    {
+        b_ok = (FILTER_ERROR_READ_ONLY == cuckoo_filter_add(p_cuckoo, 0u));
+
+        for (uint32_t idx = 0u; b_ok && (idx < p_state->query_count); idx++)
+        {
+            const char * p_text = p_state->p_queries[idx].text;
+            uint64_t     hash   = filter_hash(p_text, strlen(p_text));
+
+            b_ok = (bloom_filter_may_contain(p_bloom, hash)
+                    == bloom_filter_may_contain(p_state->p_bloom, hash))
+                   && (cuckoo_filter_may_contain(p_cuckoo, hash)
+                       == cuckoo_filter_may_contain(p_state->p_cuckoo, hash));
+        }
+    }
+
+    printf("mmapped images (%.2f MB) %s\n", (double)total / 1e6,
+           b_ok ? "answer as the originals" : "DIFFER FROM THE ORIGINALS");
+
+    bloom_filter_destroy(&p_bloom);
+    cuckoo_filter_destroy(&p_cuckoo);
+    (void)munmap(p_map, total);
+    return b_ok;
+}
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/*** end of file ***/
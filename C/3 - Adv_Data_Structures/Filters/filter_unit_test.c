@@ -0,0 +1,268 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter.h"
+
+#define KEYS (100000u)
+
+// Hash of key number idx; keys below KEYS are added, the rest are not
+static uint64_t
+key_hash(uint32_t idx)
+{
+    char key[32];
+    int  len = snprintf(key, sizeof(key), "key-%u", idx);
+
+    return filter_hash(key, (size_t)len);
+}
+
+// Fraction of KEYS keys never added that the Bloom filter still reports
+static double
+bloom_fpr(const bloom_filter_t * p_filter)
+{
+    uint32_t hits = 0;
+
+    for (uint32_t idx = KEYS; idx < 2 * KEYS; idx++)
+    {
+        hits += bloom_filter_may_contain(p_filter, key_hash(idx)) ? 1 : 0;
+    }
+
+    return (double)hits / KEYS;
+}
+
+// Same for the cuckoo filter
+static double
+cuckoo_fpr(const cuckoo_filter_t * p_filter)
+{
+    uint32_t hits = 0;
+
+    for (uint32_t idx = KEYS; idx < 2 * KEYS; idx++)
+    {
+        hits += cuckoo_filter_may_contain(p_filter, key_hash(idx)) ? 1 : 0;
+    }
+
+    return (double)hits / KEYS;
+}
+
+START_TEST(test_bloom_no_false_negatives)
+{
+    bloom_filter_t * p_filter = bloom_filter_create(KEYS, 0.01);
+
+    ck_assert_ptr_nonnull(p_filter);
+
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        ck_assert_int_eq(bloom_filter_add(p_filter, key_hash(idx)),
+                         FILTER_SUCCESS);
+    }
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        ck_assert(bloom_filter_may_contain(p_filter, key_hash(idx)));
+    }
+
+    // At capacity the rate stays near the target
+    ck_assert_double_lt(bloom_fpr(p_filter), 0.02);
+
+    bloom_filter_destroy(&p_filter);
+    ck_assert_ptr_null(p_filter);
+}
+END_TEST
+
+START_TEST(test_bloom_image)
+{
+    bloom_filter_t * p_filter = bloom_filter_create(KEYS, 0.01);
+
+    ck_assert_ptr_nonnull(p_filter);
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        bloom_filter_add(p_filter, key_hash(idx));
+    }
+
+    size_t     size    = bloom_filter_image_size(p_filter);
+    uint64_t * p_image = malloc(size);
+    ck_assert_ptr_nonnull(p_image);
+    ck_assert_int_eq(bloom_filter_save(p_filter, p_image, size - 1),
+                     FILTER_ERROR_PARAM);
+    ck_assert_int_eq(bloom_filter_save(p_filter, p_image, size),
+                     FILTER_SUCCESS);
+
+    bloom_filter_t * p_opened = bloom_filter_open(p_image, size);
+    ck_assert_ptr_nonnull(p_opened);
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        ck_assert(bloom_filter_may_contain(p_opened, key_hash(idx)));
+    }
+    ck_assert_int_eq(bloom_filter_add(p_opened, key_hash(0)),
+                     FILTER_ERROR_READ_ONLY);
+    bloom_filter_destroy(&p_opened);
+
+    // A truncated or damaged image is refused
+    ck_assert_ptr_null(bloom_filter_open(p_image, size - 1));
+    p_image[0] ^= 1;
+    ck_assert_ptr_null(bloom_filter_open(p_image, size));
+
+    free(p_image);
+    bloom_filter_destroy(&p_filter);
+}
+END_TEST
+
+START_TEST(test_cuckoo_no_false_negatives)
+{
+    cuckoo_filter_t * p_filter = cuckoo_filter_create(KEYS, 0.001);
+
+    ck_assert_ptr_nonnull(p_filter);
+
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        ck_assert_int_eq(cuckoo_filter_add(p_filter, key_hash(idx)),
+                         FILTER_SUCCESS);
+    }
+    ck_assert_uint_eq(cuckoo_filter_count(p_filter), KEYS);
+
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        ck_assert(cuckoo_filter_may_contain(p_filter, key_hash(idx)));
+    }
+    ck_assert_double_lt(cuckoo_fpr(p_filter), 0.001);
+
+    // Removing half leaves the other half all present
+    for (uint32_t idx = 0; idx < KEYS; idx += 2)
+    {
+        ck_assert(cuckoo_filter_remove(p_filter, key_hash(idx)));
+    }
+    ck_assert_uint_eq(cuckoo_filter_count(p_filter), KEYS / 2);
+    for (uint32_t idx = 1; idx < KEYS; idx += 2)
+    {
+        ck_assert(cuckoo_filter_may_contain(p_filter, key_hash(idx)));
+    }
+
+    cuckoo_filter_destroy(&p_filter);
+    ck_assert_ptr_null(p_filter);
+}
+END_TEST
+
+START_TEST(test_cuckoo_full_keeps_keys)
+{
+    cuckoo_filter_t * p_filter = cuckoo_filter_create(1000, 0.03);
+    uint32_t          added    = 0;
+
+    ck_assert_ptr_nonnull(p_filter);
+
+    // Add until the table refuses; nothing added before may be lost
+    while (FILTER_SUCCESS == cuckoo_filter_add(p_filter, key_hash(added)))
+    {
+        added++;
+        ck_assert_uint_lt(added, KEYS);
+    }
+    ck_assert_uint_ge(added, 1000);
+    ck_assert_uint_eq(cuckoo_filter_count(p_filter), added);
+
+    for (uint32_t idx = 0; idx < added; idx++)
+    {
+        ck_assert(cuckoo_filter_may_contain(p_filter, key_hash(idx)));
+    }
+
+    cuckoo_filter_destroy(&p_filter);
+}
+END_TEST
+
+START_TEST(test_cuckoo_duplicates)
+{
+    cuckoo_filter_t * p_filter = cuckoo_filter_create(1000, 0.001);
+    uint64_t          hash     = key_hash(7);
+
+    ck_assert_ptr_nonnull(p_filter);
+
+    for (uint32_t copy = 0; copy < 8; copy++)
+    {
+        ck_assert_int_eq(cuckoo_filter_add(p_filter, hash), FILTER_SUCCESS);
+    }
+    for (uint32_t copy = 0; copy < 8; copy++)
+    {
+        ck_assert(cuckoo_filter_may_contain(p_filter, hash));
+        ck_assert(cuckoo_filter_remove(p_filter, hash));
+    }
+    ck_assert(!cuckoo_filter_may_contain(p_filter, hash));
+    ck_assert(!cuckoo_filter_remove(p_filter, hash));
+    ck_assert_uint_eq(cuckoo_filter_count(p_filter), 0);
+
+    cuckoo_filter_destroy(&p_filter);
+}
+END_TEST
+
+START_TEST(test_cuckoo_image)
+{
+    cuckoo_filter_t * p_filter = cuckoo_filter_create(KEYS, 0.03);
+
+    ck_assert_ptr_nonnull(p_filter);
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        ck_assert_int_eq(cuckoo_filter_add(p_filter, key_hash(idx)),
+                         FILTER_SUCCESS);
+    }
+
+    size_t     size    = cuckoo_filter_image_size(p_filter);
+    uint64_t * p_image = malloc(size);
+    ck_assert_ptr_nonnull(p_image);
+    ck_assert_int_eq(cuckoo_filter_save(p_filter, p_image, size),
+                     FILTER_SUCCESS);
+
+    cuckoo_filter_t * p_opened = cuckoo_filter_open(p_image, size);
+    ck_assert_ptr_nonnull(p_opened);
+    ck_assert_uint_eq(cuckoo_filter_count(p_opened), KEYS);
+    for (uint32_t idx = 0; idx < KEYS; idx++)
+    {
+        ck_assert(cuckoo_filter_may_contain(p_opened, key_hash(idx)));
+    }
+    ck_assert_int_eq(cuckoo_filter_add(p_opened, key_hash(0)),
+                     FILTER_ERROR_READ_ONLY);
+    ck_assert(!cuckoo_filter_remove(p_opened, key_hash(0)));
+
+    cuckoo_filter_destroy(&p_opened);
+    free(p_image);
+    cuckoo_filter_destroy(&p_filter);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+filter_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Filters");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_bloom_no_false_negatives);
+    tcase_add_test(tc_core, test_bloom_image);
+    tcase_add_test(tc_core, test_cuckoo_no_false_negatives);
+    tcase_add_test(tc_core, test_cuckoo_full_keeps_keys);
+    tcase_add_test(tc_core, test_cuckoo_duplicates);
+    tcase_add_test(tc_core, test_cuckoo_image);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = filter_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -0,0 +1,211 @@
+/** @file ch_bench.c
+ *
+ * @brief Preprocessing time, index size and query latency of graph_ch on
+ *        a road-like grid.
+ *
+ * Builds a width x height graph_generate_road() network (1024 x 1024 by
+ * default, just over a million vertices), contracts it, saves and maps
+ * the index, then times random point-to-point queries against the built
+ * and the mapped index. A handful of the same queries are also answered
+ * with a full single-source search as a baseline and to check the
+ * distances.
+ *
+ * Usage: ch_bench [width] [height] [queries] [index_path]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "graph.h"
+#include "graph_ch.h"
+#include "graph_search.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_SIDE      (1024u)
+#define DEFAULT_QUERIES   (20000u)
+#define BASELINE_QUERIES  (5u)
+#define MAX_WEIGHT        (100u)
+#define BASELINE_DELTA    (64u)
+
+/*************************************************************************
+ * Static Functions
+ *************************************************************************/
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+static uint32_t
+arg_or_default(int argc, char ** argv, int idx, uint32_t fallback)
+{
+    return (argc > idx) ? (uint32_t)strtoul(argv[idx], NULL, 10) : fallback;
+}
+
+static uint32_t
+next_vertex(uint64_t * p_state, uint32_t num_vertices)
+{
+    *p_state = (*p_state * 6364136223846793005ull) + 1442695040888963407ull;
+    return (uint32_t)((*p_state >> 33) % num_vertices);
+}
+
+static double
+time_queries(const graph_ch_t * p_ch, uint32_t count, uint64_t * p_checksum)
+{
+    graph_ch_query_t * p_query = graph_ch_query_create(p_ch);
+    uint32_t           num     = graph_ch_vertices(p_ch);
+    uint64_t           state   = 99;
+    uint64_t           sum     = 0;
+
+    if (NULL == p_query)
+    {
+        return 0.0;
+    }
+
+    double start = now_seconds();
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        uint32_t source = next_vertex(&state, num);
+        uint32_t target = next_vertex(&state, num);
+        sum += graph_ch_distance(p_ch, p_query, source, target);
+    }
+    double elapsed = now_seconds() - start;
+
+    graph_ch_query_destroy(&p_query);
+    *p_checksum = sum;
+    return (elapsed / count) * 1e6;
+}
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t     width   = arg_or_default(argc, argv, 1, DEFAULT_SIDE);
+    uint32_t     height  = arg_or_default(argc, argv, 2, DEFAULT_SIDE);
+    uint32_t     queries = arg_or_default(argc, argv, 3, DEFAULT_QUERIES);
+    const char * p_path  = (argc > 4) ? argv[4] : "/tmp/graph_ch_bench.ch";
+
+    if (0 == queries)
+    {
+        queries = 1;
+    }
+
+    double    start   = now_seconds();
+    graph_t * p_graph = graph_generate_road(width, height, MAX_WEIGHT, 1);
+    if (NULL == p_graph)
+    {
+        fprintf(stderr, "graph generation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("road grid %ux%u: %u vertices, %llu arcs (%.2f s)\n",
+           width,
+           height,
+           p_graph->num_vertices,
+           (unsigned long long)p_graph->num_edges,
+           now_seconds() - start);
+
+    graph_ch_stats_t stats = { 0 };
+    start                  = now_seconds();
+    graph_ch_t * p_ch      = graph_ch_build(p_graph, &stats);
+    double       build     = now_seconds() - start;
+    if (NULL == p_ch)
+    {
+        fprintf(stderr, "contraction failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("preprocessing:   %.2f s, %llu shortcuts, %llu upward arcs, "
+           "%u lazy updates, %llu witness searches\n",
+           build,
+           (unsigned long long)stats.shortcuts,
+           (unsigned long long)stats.upward_arcs,
+           stats.lazy_updates,
+           (unsigned long long)stats.witness_runs);
+    printf("index size:      %.1f MiB (%.1f bytes/vertex)\n",
+           (double)graph_ch_size(p_ch) / (1024.0 * 1024.0),
+           (double)graph_ch_size(p_ch) / p_graph->num_vertices);
+
+    start = now_seconds();
+    if (GRAPH_CH_SUCCESS != graph_ch_save(p_ch, p_path))
+    {
+        fprintf(stderr, "cannot write %s\n", p_path);
+        return EXIT_FAILURE;
+    }
+    double saved = now_seconds() - start;
+
+    start                 = now_seconds();
+    graph_ch_t * p_mapped = graph_ch_open(p_path);
+    double       opened   = now_seconds() - start;
+    if (NULL == p_mapped)
+    {
+        fprintf(stderr, "cannot map %s\n", p_path);
+        return EXIT_FAILURE;
+    }
+    printf("save / mmap:     %.1f ms / %.3f ms\n", saved * 1e3, opened * 1e3);
+
+    uint64_t built_sum  = 0;
+    uint64_t mapped_sum = 0;
+    double   built_us   = time_queries(p_ch, queries, &built_sum);
+    double   mapped_us  = time_queries(p_mapped, queries, &mapped_sum);
+
+    printf("ch query:        %.2f us (built), %.2f us (mapped), %u queries\n",
+           built_us,
+           mapped_us,
+           queries);
+
+    // Full single-source search baseline, which also checks the answers
+    uint64_t * p_dist   = malloc(p_graph->num_vertices * sizeof(uint64_t));
+    uint64_t   state    = 7;
+    double     total    = 0.0;
+    uint32_t   mismatch = (built_sum == mapped_sum) ? 0 : 1;
+    graph_ch_query_t * p_query = graph_ch_query_create(p_ch);
+
+    for (uint32_t idx = 0; (NULL != p_dist) && (idx < BASELINE_QUERIES); idx++)
+    {
+        uint32_t source = next_vertex(&state, p_graph->num_vertices);
+        uint32_t target = next_vertex(&state, p_graph->num_vertices);
+
+        start = now_seconds();
+        graph_sssp_delta(p_graph, source, BASELINE_DELTA, NULL, 1, p_dist);
+        total += now_seconds() - start;
+
+        uint64_t expect = (GRAPH_DIST_INFINITY == p_dist[target])
+                              ? GRAPH_CH_INFINITY
+                              : p_dist[target];
+        if (expect != graph_ch_distance(p_ch, p_query, source, target))
+        {
+            mismatch++;
+        }
+    }
+
+    printf("full search:     %.2f ms per query (delta-stepping, 1 worker)\n",
+           (total / BASELINE_QUERIES) * 1e3);
+    printf("speedup:         %.0fx, %u mismatches\n",
+           ((total / BASELINE_QUERIES) * 1e6) / built_us,
+           mismatch);
+
+    graph_ch_query_destroy(&p_query);
+    free(p_dist);
+    graph_ch_destroy(&p_mapped);
+    graph_ch_destroy(&p_ch);
+    graph_destroy(&p_graph);
+    unlink(p_path);
+
+    return (0 == mismatch) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*** end of file ***/
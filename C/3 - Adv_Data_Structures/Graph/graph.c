@@ -0,0 +1,453 @@
+/** @file graph.c
+ *
+ * @brief Implementation of the CSR graph and the R-MAT generator.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define RMAT_MAX_SCALE (31)
+
+/* Graph500 quadrant probabilities scaled to 1 << 16 */
+#define RMAT_A         (37355u) /* 0.57 */
+#define RMAT_AB        (49807u) /* 0.57 + 0.19 */
+#define RMAT_ABC       (62259u) /* 0.57 + 0.19 + 0.19 */
+
+#define ROAD_ARTERIAL  (8u)  /* Every n-th row and column is an arterial */
+#define ROAD_GAP_ODDS  (16u) /* About 1 in n local streets is missing */
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint64_t rng_next(uint64_t * p_state);
+static bool     build_csr(uint32_t             num_vertices,
+                          const graph_edge_t * p_edges,
+                          uint64_t             num_edges,
+                          bool                 b_reverse,
+                          bool                 b_both,
+                          uint64_t **          pp_offsets,
+                          uint32_t **          pp_targets,
+                          uint32_t **          pp_weights);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Builds a CSR graph from an edge list.
+ *
+ * @param[in] num_vertices Number of vertices
+ * @param[in] p_edges      Edge list
+ * @param[in] num_edges    Number of entries in p_edges
+ * @param[in] b_undirected Store every edge in both directions
+ *
+ * @return Pointer to the new graph, or NULL on invalid input or allocation
+ *         failure
+ */
+graph_t *
+graph_create(uint32_t             num_vertices,
+             const graph_edge_t * p_edges,
+             uint64_t             num_edges,
+             bool                 b_undirected)
+{
+    if ((0 == num_vertices) || ((NULL == p_edges) && (0 != num_edges)))
+    {
+        return NULL;
+    }
+
+    for (uint64_t idx = 0; idx < num_edges; idx++)
+    {
+        if ((p_edges[idx].src >= num_vertices)
+            || (p_edges[idx].dst >= num_vertices))
+        {
+            return NULL;
+        }
+    }
+
+    graph_t * p_graph = calloc(1, sizeof(graph_t));
+    if (NULL == p_graph)
+    {
+        return NULL;
+    }
+
+    p_graph->num_vertices = num_vertices;
+    p_graph->b_undirected = b_undirected;
+
+    if (!build_csr(num_vertices,
+                   p_edges,
+                   num_edges,
+                   false,
+                   b_undirected,
+                   &p_graph->p_offsets,
+                   &p_graph->p_targets,
+                   &p_graph->p_weights))
+    {
+        graph_destroy(&p_graph);
+        return NULL;
+    }
+
+    p_graph->num_edges = p_graph->p_offsets[num_vertices];
+
+    if (b_undirected)
+    {
+        // The reverse view of an undirected graph is the graph itself
+        p_graph->p_in_offsets = p_graph->p_offsets;
+        p_graph->p_in_sources = p_graph->p_targets;
+        p_graph->p_in_weights = p_graph->p_weights;
+    }
+    else if (!build_csr(num_vertices,
+                        p_edges,
+                        num_edges,
+                        true,
+                        false,
+                        &p_graph->p_in_offsets,
+                        &p_graph->p_in_sources,
+                        &p_graph->p_in_weights))
+    {
+        graph_destroy(&p_graph);
+        return NULL;
+    }
+
+    return p_graph;
+}
+
+/*!
+ * @brief Generates a power-law graph with the R-MAT recursive model.
+ *
+ * @param[in] scale        log2 of the vertex count (1..31)
+ * @param[in] edge_factor  Generated edges per vertex
+ * @param[in] max_weight   Largest edge weight (0 gives unit weights)
+ * @param[in] seed         Random seed
+ * @param[in] b_undirected Store every edge in both directions
+ *
+ * @return Pointer to the new graph, or NULL on failure
+ */
+graph_t *
+graph_generate_rmat(uint32_t scale,
+                    uint32_t edge_factor,
+                    uint32_t max_weight,
+                    uint64_t seed,
+                    bool     b_undirected)
+{
+    if ((0 == scale) || (scale > RMAT_MAX_SCALE) || (0 == edge_factor))
+    {
+        return NULL;
+    }
+
+    uint32_t num_vertices = 1u << scale;
+    uint64_t target_edges = (uint64_t)num_vertices * edge_factor;
+    uint64_t state        = seed ^ 0x9E3779B97F4A7C15ull;
+
+    graph_edge_t * p_edges    = malloc(target_edges * sizeof(graph_edge_t));
+    uint32_t *     p_permute  = malloc(num_vertices * sizeof(uint32_t));
+    if ((NULL == p_edges) || (NULL == p_permute))
+    {
+        free(p_edges);
+        free(p_permute);
+        return NULL;
+    }
+
+    // Random relabelling so vertex id does not predict degree
+    for (uint32_t idx = 0; idx < num_vertices; idx++)
+    {
+        p_permute[idx] = idx;
+    }
+    for (uint32_t idx = num_vertices - 1; idx > 0; idx--)
+    {
+        uint32_t swap    = (uint32_t)(rng_next(&state) % ((uint64_t)idx + 1));
+        uint32_t temp    = p_permute[idx];
+        p_permute[idx]   = p_permute[swap];
+        p_permute[swap]  = temp;
+    }
+
+    uint64_t count = 0;
+    for (uint64_t idx = 0; idx < target_edges; idx++)
+    {
+        uint32_t src = 0;
+        uint32_t dst = 0;
+
+        for (uint32_t level = 0; level < scale; level++)
+        {
+            uint32_t pick = (uint32_t)(rng_next(&state) & 0xFFFFu);
+
+            src <<= 1;
+            dst <<= 1;
+
+            if (pick >= RMAT_ABC)
+            {
+                src |= 1u;
+                dst |= 1u;
+            }
+            else if (pick >= RMAT_AB)
+            {
+                src |= 1u;
+            }
+            else if (pick >= RMAT_A)
+            {
+                dst |= 1u;
+            }
+        }
+
+        if (src == dst)
+        {
+            continue;
+        }
+
+        p_edges[count].src = p_permute[src];
+        p_edges[count].dst = p_permute[dst];
+        p_edges[count].weight
+            = (0 == max_weight)
+                  ? 1u
+                  : (uint32_t)(1 + (rng_next(&state) % max_weight));
+        count++;
+    }
+
+    free(p_permute);
+
+    graph_t * p_graph = graph_create(num_vertices, p_edges, count, b_undirected);
+    free(p_edges);
+
+    return p_graph;
+}
+
+/*!
+ * @brief Generates a road-like grid graph.
+ *
+ * @param[in] width      Columns (> 0)
+ * @param[in] height     Rows (> 0); width * height must fit in 32 bits
+ * @param[in] max_weight Largest local street weight (>= 8)
+ * @param[in] seed       Random seed
+ *
+ * @return Pointer to the new undirected graph, or NULL on failure
+ */
+graph_t *
+graph_generate_road(uint32_t width,
+                    uint32_t height,
+                    uint32_t max_weight,
+                    uint64_t seed)
+{
+    uint64_t num_vertices = (uint64_t)width * height;
+
+    if ((0 == width) || (0 == height) || (max_weight < 8)
+        || (num_vertices >= GRAPH_NO_VERTEX))
+    {
+        return NULL;
+    }
+
+    graph_edge_t * p_edges = malloc(2 * num_vertices * sizeof(graph_edge_t));
+    if (NULL == p_edges)
+    {
+        return NULL;
+    }
+
+    uint64_t state = seed ^ 0x9E3779B97F4A7C15ull;
+    uint64_t count = 0;
+
+    for (uint32_t row = 0; row < height; row++)
+    {
+        for (uint32_t col = 0; col < width; col++)
+        {
+            uint32_t vertex = (row * width) + col;
+
+            for (uint32_t dir = 0; dir < 2; dir++)
+            {
+                bool b_right = (0 == dir);
+                if ((b_right && ((col + 1) == width))
+                    || (!b_right && ((row + 1) == height)))
+                {
+                    continue;
+                }
+
+                // A horizontal street on an arterial row is part of it
+                bool     b_arterial = b_right ? (0 == (row % ROAD_ARTERIAL))
+                                              : (0 == (col % ROAD_ARTERIAL));
+                uint64_t random     = rng_next(&state);
+                uint32_t weight     = (max_weight / 2)
+                                  + (uint32_t)(random % ((max_weight / 2) + 1));
+
+                if (!b_arterial && (0 == ((random >> 32) % ROAD_GAP_ODDS)))
+                {
+                    continue;
+                }
+
+                p_edges[count].src    = vertex;
+                p_edges[count].dst    = b_right ? (vertex + 1)
+                                                : (vertex + width);
+                p_edges[count].weight = b_arterial ? (weight / 4) : weight;
+                count++;
+            }
+        }
+    }
+
+    graph_t * p_graph
+        = graph_create((uint32_t)num_vertices, p_edges, count, true);
+    free(p_edges);
+
+    return p_graph;
+}
+
+/*!
+ * @brief Gets the out-degree of a vertex.
+ *
+ * @param[in] p_graph Graph
+ * @param[in] vertex  Vertex id
+ *
+ * @return Number of outgoing arcs, or 0 for an invalid vertex
+ */
+uint64_t
+graph_out_degree(const graph_t * p_graph, uint32_t vertex)
+{
+    if ((NULL == p_graph) || (vertex >= p_graph->num_vertices))
+    {
+        return 0;
+    }
+
+    return p_graph->p_offsets[vertex + 1] - p_graph->p_offsets[vertex];
+}
+
+/*!
+ * @brief Frees a graph and all of its arrays.
+ *
+ * @param[in,out] pp_graph Pointer to the graph pointer; set to NULL
+ */
+void
+graph_destroy(graph_t ** pp_graph)
+{
+    if ((NULL == pp_graph) || (NULL == *pp_graph))
+    {
+        return;
+    }
+
+    graph_t * p_graph = *pp_graph;
+
+    if (p_graph->p_in_offsets != p_graph->p_offsets)
+    {
+        free(p_graph->p_in_offsets);
+        free(p_graph->p_in_sources);
+        free(p_graph->p_in_weights);
+    }
+
+    free(p_graph->p_offsets);
+    free(p_graph->p_targets);
+    free(p_graph->p_weights);
+    free(p_graph);
+    *pp_graph = NULL;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief xorshift64* pseudo random generator.
+ *
+ * @param[in,out] p_state Generator state (must not be zero)
+ *
+ * @return Next 64-bit pseudo random value
+ */
+static uint64_t
+rng_next(uint64_t * p_state)
+{
+    uint64_t x = *p_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *p_state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+/*!
+ * @brief Counting-sort an edge list into CSR arrays.
+ *
+ * @param[in]  num_vertices Number of vertices
+ * @param[in]  p_edges      Edge list
+ * @param[in]  num_edges    Number of entries in p_edges
+ * @param[in]  b_reverse    Key edges by destination instead of source
+ * @param[in]  b_both       Also store every edge in the opposite direction
+ * @param[out] pp_offsets   Receives num_vertices + 1 offsets
+ * @param[out] pp_targets   Receives the adjacent vertex of each arc
+ * @param[out] pp_weights   Receives the weight of each arc
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+build_csr(uint32_t             num_vertices,
+          const graph_edge_t * p_edges,
+          uint64_t             num_edges,
+          bool                 b_reverse,
+          bool                 b_both,
+          uint64_t **          pp_offsets,
+          uint32_t **          pp_targets,
+          uint32_t **          pp_weights)
+{
+    uint64_t   num_arcs  = b_both ? (2 * num_edges) : num_edges;
+    uint64_t * p_offsets = calloc((size_t)num_vertices + 1, sizeof(uint64_t));
+    uint64_t * p_cursor  = malloc(((size_t)num_vertices + 1) * sizeof(uint64_t));
+    uint32_t * p_targets = malloc((num_arcs + 1) * sizeof(uint32_t));
+    uint32_t * p_weights = malloc((num_arcs + 1) * sizeof(uint32_t));
+
+    if ((NULL == p_offsets) || (NULL == p_cursor) || (NULL == p_targets)
+        || (NULL == p_weights))
+    {
+        free(p_offsets);
+        free(p_cursor);
+        free(p_targets);
+        free(p_weights);
+        return false;
+    }
+
+    // Count arcs per key vertex, shifted by one for the prefix sum
+    for (uint64_t idx = 0; idx < num_edges; idx++)
+    {
+        uint32_t key = b_reverse ? p_edges[idx].dst : p_edges[idx].src;
+        p_offsets[key + 1]++;
+
+        if (b_both)
+        {
+            p_offsets[p_edges[idx].dst + 1]++;
+        }
+    }
+
+    for (uint32_t vertex = 0; vertex < num_vertices; vertex++)
+    {
+        p_offsets[vertex + 1] += p_offsets[vertex];
+    }
+
+    memcpy(p_cursor, p_offsets, ((size_t)num_vertices + 1) * sizeof(uint64_t));
+
+    for (uint64_t idx = 0; idx < num_edges; idx++)
+    {
+        uint32_t key   = b_reverse ? p_edges[idx].dst : p_edges[idx].src;
+        uint32_t other = b_reverse ? p_edges[idx].src : p_edges[idx].dst;
+        uint64_t slot  = p_cursor[key]++;
+
+        p_targets[slot] = other;
+        p_weights[slot] = p_edges[idx].weight;
+
+        if (b_both)
+        {
+            slot            = p_cursor[other]++;
+            p_targets[slot] = key;
+            p_weights[slot] = p_edges[idx].weight;
+        }
+    }
+
+    free(p_cursor);
+
+    *pp_offsets = p_offsets;
+    *pp_targets = p_targets;
+    *pp_weights = p_weights;
+
+    return true;
+}
+
+/*** end of file ***/
@@ -0,0 +1,142 @@
+/** @file graph.h
+ *
+ * @brief Compressed sparse row (CSR) graph for large route networks.
+ *
+ * Vertices are numbered 0..num_vertices-1. Outgoing edges of vertex v are
+ * p_targets[p_offsets[v] .. p_offsets[v + 1]) with matching p_weights.
+ * Incoming edges are kept in the same layout so searches can also walk the
+ * graph backwards; for undirected graphs both views share the same arrays.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define GRAPH_NO_VERTEX (UINT32_MAX)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* One weighted edge used to build a graph */
+typedef struct
+{
+    uint32_t src;    /* Source vertex */
+    uint32_t dst;    /* Destination vertex */
+    uint32_t weight; /* Non-negative edge weight */
+} graph_edge_t;
+
+/* CSR graph with forward and reverse adjacency */
+typedef struct
+{
+    uint32_t   num_vertices;  /* Number of vertices */
+    uint64_t   num_edges;     /* Number of stored (directed) arcs */
+    bool       b_undirected;  /* Every edge was stored in both directions */
+    uint64_t * p_offsets;     /* num_vertices + 1 out-edge offsets */
+    uint32_t * p_targets;     /* Out-edge targets */
+    uint32_t * p_weights;     /* Out-edge weights */
+    uint64_t * p_in_offsets;  /* num_vertices + 1 in-edge offsets */
+    uint32_t * p_in_sources;  /* In-edge sources */
+    uint32_t * p_in_weights;  /* In-edge weights */
+} graph_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Builds a CSR graph from an edge list.
+ *
+ * Edges with an endpoint outside 0..num_vertices-1 are rejected. Self loops
+ * and parallel edges are kept as given.
+ *
+ * @param[in] num_vertices Number of vertices
+ * @param[in] p_edges      Edge list
+ * @param[in] num_edges    Number of entries in p_edges
+ * @param[in] b_undirected Store every edge in both directions
+ *
+ * @return Pointer to the new graph, or NULL on invalid input or allocation
+ *         failure
+ */
+graph_t *
+graph_create(uint32_t             num_vertices,
+             const graph_edge_t * p_edges,
+             uint64_t             num_edges,
+             bool                 b_undirected);
+
+/*!
+ * @brief Generates a power-law graph with the R-MAT recursive model.
+ *
+ * Uses the Graph500 quadrant probabilities (0.57, 0.19, 0.19, 0.05) and
+ * scrambles vertex ids so high degree vertices are not clustered at low
+ * ids. Self loops are dropped. Weights are uniform in 1..max_weight.
+ *
+ * @param[in] scale        log2 of the vertex count (1..31)
+ * @param[in] edge_factor  Generated edges per vertex
+ * @param[in] max_weight   Largest edge weight (0 gives unit weights)
+ * @param[in] seed         Random seed
+ * @param[in] b_undirected Store every edge in both directions
+ *
+ * @return Pointer to the new graph, or NULL on failure
+ */
+graph_t *
+graph_generate_rmat(uint32_t scale,
+                    uint32_t edge_factor,
+                    uint32_t max_weight,
+                    uint64_t seed,
+                    bool     b_undirected);
+
+/*!
+ * @brief Generates a road-like grid graph.
+ *
+ * Vertex (row, col) has id row * width + col and is joined to its right
+ * and lower neighbours in both directions. Local streets weigh
+ * max_weight/2..max_weight and about 1 in 16 of them is left out; every
+ * eighth row and column is an arterial that is never cut and costs a
+ * quarter as much, which gives the graph the hierarchy of a real road
+ * network.
+ *
+ * @param[in] width      Columns (> 0)
+ * @param[in] height     Rows (> 0); width * height must fit in 32 bits
+ * @param[in] max_weight Largest local street weight (>= 8)
+ * @param[in] seed       Random seed
+ *
+ * @return Pointer to the new undirected graph, or NULL on failure
+ */
+graph_t *
+graph_generate_road(uint32_t width,
+                    uint32_t height,
+                    uint32_t max_weight,
+                    uint64_t seed);
+
+/*!
+ * @brief Gets the out-degree of a vertex.
+ *
+ * @param[in] p_graph Graph
+ * @param[in] vertex  Vertex id
+ *
+ * @return Number of outgoing arcs, or 0 for an invalid vertex
+ */
+uint64_t
+graph_out_degree(const graph_t * p_graph, uint32_t vertex);
+
+/*!
+ * @brief Frees a graph and all of its arrays.
+ *
+ * @param[in,out] pp_graph Pointer to the graph pointer; set to NULL
+ */
+void
+graph_destroy(graph_t ** pp_graph);
+
+#endif /* GRAPH_H */
+
+/*** end of file ***/
@@ -0,0 +1,181 @@
+/** @file graph_bench.c
+ *
+ * @brief Strong-scaling benchmark for graph_bfs and graph_sssp_delta.
+ *
+ * Generates one R-MAT power-law graph and searches it from the same set of
+ * random sources with 1, 2, 4, ... workers, so every row does identical
+ * work. Reports the mean time per search, millions of traversed edges per
+ * second (MTEPS) and the speedup over one worker.
+ *
+ * Usage: graph_bench [scale] [edge_factor] [sources] [max_workers] [delta]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "graph.h"
+#include "graph_search.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_SCALE       (20u)
+#define DEFAULT_EDGE_FACTOR (16u)
+#define DEFAULT_SOURCES     (8u)
+#define DEFAULT_DELTA       (32u)
+#define MAX_WEIGHT          (255u)
+#define MAX_SOURCES         (64u)
+
+/*************************************************************************
+ * Static Functions
+ *************************************************************************/
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+static uint32_t
+arg_or_default(int argc, char ** argv, int idx, uint32_t fallback)
+{
+    return (argc > idx) ? (uint32_t)strtoul(argv[idx], NULL, 10) : fallback;
+}
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    long     online      = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t scale       = arg_or_default(argc, argv, 1, DEFAULT_SCALE);
+    uint32_t edge_factor = arg_or_default(argc, argv, 2, DEFAULT_EDGE_FACTOR);
+    uint32_t num_sources = arg_or_default(argc, argv, 3, DEFAULT_SOURCES);
+    uint32_t max_workers
+        = arg_or_default(argc, argv, 4, (online > 0) ? (uint32_t)online : 1);
+    uint32_t delta = arg_or_default(argc, argv, 5, DEFAULT_DELTA);
+
+    if (num_sources > MAX_SOURCES)
+    {
+        num_sources = MAX_SOURCES;
+    }
+    if (max_workers > GRAPH_SEARCH_MAX_WORKERS)
+    {
+        max_workers = GRAPH_SEARCH_MAX_WORKERS;
+    }
+
+    double    start   = now_seconds();
+    graph_t * p_graph = graph_generate_rmat(scale, edge_factor, MAX_WEIGHT,
+                                            1, true);
+    if (NULL == p_graph)
+    {
+        fprintf(stderr, "graph generation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("R-MAT scale %u, %u vertices, %llu arcs, built in %.2f s\n",
+           scale,
+           p_graph->num_vertices,
+           (unsigned long long)p_graph->num_edges,
+           now_seconds() - start);
+
+    // Sources with at least one edge, identical for every worker count
+    uint32_t sources[MAX_SOURCES];
+    uint64_t state = 12345;
+    for (uint32_t idx = 0; idx < num_sources;)
+    {
+        state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+        uint32_t vertex = (uint32_t)((state >> 33) % p_graph->num_vertices);
+        if (graph_out_degree(p_graph, vertex) > 0)
+        {
+            sources[idx++] = vertex;
+        }
+    }
+
+    thread_pool_t * p_pool   = thread_pool_initialize((int)max_workers);
+    uint32_t *      p_parent = malloc(p_graph->num_vertices * sizeof(uint32_t));
+    uint64_t *      p_dist   = malloc(p_graph->num_vertices * sizeof(uint64_t));
+    if ((NULL == p_pool) || (NULL == p_parent) || (NULL == p_dist))
+    {
+        fprintf(stderr, "setup failed\n");
+        return EXIT_FAILURE;
+    }
+
+    const char *     names[] = { "bfs-auto", "bfs-top-down", "sssp-delta" };
+    graph_bfs_mode_t modes[] = { GRAPH_BFS_AUTO, GRAPH_BFS_TOP_DOWN,
+                                 GRAPH_BFS_AUTO };
+    double           base[3] = { 0.0, 0.0, 0.0 };
+
+    printf("%-14s %8s %12s %10s %9s\n",
+           "algorithm", "workers", "ms/search", "MTEPS", "speedup");
+
+    for (uint32_t workers = 1; workers <= max_workers; workers *= 2)
+    {
+        for (uint32_t algo = 0; algo < 3; algo++)
+        {
+            double   total     = 0.0;
+            uint64_t traversed = 0;
+
+            for (uint32_t idx = 0; idx < num_sources; idx++)
+            {
+                start = now_seconds();
+                if (2 == algo)
+                {
+                    graph_sssp_delta(p_graph, sources[idx], delta, p_pool,
+                                     workers, p_dist);
+                }
+                else
+                {
+                    graph_bfs(p_graph, sources[idx], modes[algo], p_pool,
+                              workers, p_parent, NULL, NULL);
+                }
+                total += now_seconds() - start;
+
+                // TEPS counts the arcs of the reached component
+                for (uint32_t vertex = 0; vertex < p_graph->num_vertices;
+                     vertex++)
+                {
+                    bool b_reached = (2 == algo)
+                                         ? (GRAPH_DIST_INFINITY != p_dist[vertex])
+                                         : (GRAPH_NO_VERTEX != p_parent[vertex]);
+                    if (b_reached)
+                    {
+                        traversed += graph_out_degree(p_graph, vertex);
+                    }
+                }
+            }
+
+            double mean = total / num_sources;
+            if (1 == workers)
+            {
+                base[algo] = mean;
+            }
+
+            printf("%-14s %8u %12.2f %10.1f %8.2fx\n",
+                   names[algo],
+                   workers,
+                   mean * 1e3,
+                   ((double)traversed / total) / 1e6,
+                   base[algo] / mean);
+        }
+    }
+
+    free(p_dist);
+    free(p_parent);
+    thread_pool_shutdown(p_pool);
+    thread_pool_destroy(p_pool);
+    graph_destroy(&p_graph);
+
+    return EXIT_SUCCESS;
+}
+
+/*** end of file ***/
@@ -0,0 +1,1308 @@
+/** @file graph_ch.c
+ *
+ * @brief Implementation of the contraction hierarchy builder, its on-disk
+ *        format and the bidirectional upward query.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "graph_ch.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define CH_MAGIC            (0x31484347u) /* "GCH1" little endian */
+#define CH_VERSION          (1u)
+
+/* Witness searches give up after settling this many vertices */
+#define CH_SETTLE_SIMULATE  (64u)
+#define CH_SETTLE_CONTRACT  (512u)
+
+/* Bias that keeps negative priorities ordered in an unsigned heap key */
+#define CH_PRIORITY_BIAS    (1ll << 40)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* One arc, both in the builder and in the stored index */
+typedef struct
+{
+    uint32_t vertex; /* Adjacent vertex */
+    uint32_t weight; /* Arc weight */
+} ch_arc_t;
+
+/* Fixed header at the start of the index block */
+typedef struct
+{
+    uint32_t magic;        /* CH_MAGIC */
+    uint32_t version;      /* CH_VERSION */
+    uint32_t num_vertices; /* Vertices */
+    uint32_t num_forward;  /* Arcs in the forward upward graph */
+    uint32_t num_backward; /* Arcs in the backward upward graph */
+    uint32_t reserved[3];  /* Zero */
+} ch_header_t;
+
+struct graph_ch
+{
+    const ch_header_t * p_header;       /* Start of the block */
+    const uint32_t *    p_order;        /* Original id -> rank */
+    const uint32_t *    p_fwd_offsets;  /* num_vertices + 1 */
+    const ch_arc_t *    p_fwd_arcs;     /* Arcs to higher ranks */
+    const uint32_t *    p_bwd_offsets;  /* num_vertices + 1 */
+    const ch_arc_t *    p_bwd_arcs;     /* Arcs from higher ranks */
+    void *              p_block;        /* Heap or mapped block */
+    size_t              size;           /* Block size in bytes */
+    bool                b_mapped;       /* Block came from mmap */
+};
+
+/* Growable arc list of one vertex while contracting */
+typedef struct
+{
+    ch_arc_t * p_arcs;
+    uint32_t   len;
+    uint32_t   cap;
+} arc_list_t;
+
+/* Binary heap entry */
+typedef struct
+{
+    uint64_t key;
+    uint32_t vertex;
+} heap_entry_t;
+
+/* Growable binary min-heap */
+typedef struct
+{
+    heap_entry_t * p_entries;
+    size_t         len;
+    size_t         cap;
+} ch_heap_t;
+
+/* Upward arc recorded when its lower endpoint is contracted */
+typedef struct
+{
+    uint32_t low;    /* Contracted endpoint */
+    uint32_t high;   /* Endpoint still in the graph */
+    uint32_t weight; /* Arc weight */
+} up_arc_t;
+
+/* Growable list of upward arcs */
+typedef struct
+{
+    up_arc_t * p_arcs;
+    size_t     len;
+    size_t     cap;
+} up_list_t;
+
+/* Builder state */
+typedef struct
+{
+    uint32_t           num_vertices;
+    arc_list_t *       p_out;        /* Remaining out-arcs per vertex */
+    arc_list_t *       p_in;         /* Remaining in-arcs per vertex */
+    uint32_t *         p_rank;       /* Contraction rank, or GRAPH_NO_VERTEX */
+    uint32_t *         p_deleted;    /* Contracted neighbours per vertex */
+    uint64_t *         p_dist;       /* Witness search distances */
+    uint32_t *         p_stamp;      /* Witness search generation per vertex */
+    uint32_t *         p_wanted;     /* Generation while still a target */
+    uint32_t           generation;
+    ch_heap_t          witness;      /* Witness search heap */
+    up_list_t          forward;      /* Upward out-arcs */
+    up_list_t          backward;     /* Upward in-arcs */
+    graph_ch_stats_t * p_stats;
+} builder_t;
+
+struct graph_ch_query
+{
+    uint32_t   num_vertices;
+    uint64_t * p_dist[2];  /* Forward and backward distances */
+    uint32_t * p_stamp[2]; /* Generation that wrote each distance */
+    uint32_t   generation;
+    ch_heap_t  heap[2];    /* Forward and backward queues */
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static bool     heap_push(ch_heap_t * p_heap, uint64_t key, uint32_t vertex);
+static heap_entry_t heap_pop(ch_heap_t * p_heap);
+static bool     arc_set_min(arc_list_t * p_list,
+                            uint32_t     vertex,
+                            uint32_t     weight);
+static void     arc_remove(arc_list_t * p_list, uint32_t vertex);
+static bool     up_push(up_list_t * p_list,
+                        uint32_t    low,
+                        uint32_t    high,
+                        uint32_t    weight);
+static bool     builder_init(builder_t * p_build, const graph_t * p_graph);
+static void     builder_free(builder_t * p_build);
+static bool     witness_search(builder_t *        p_build,
+                               uint32_t           source,
+                               uint32_t           skip,
+                               const arc_list_t * p_targets,
+                               uint64_t           bound,
+                               uint32_t           settle_limit);
+static bool     contract(builder_t * p_build,
+                         uint32_t    vertex,
+                         bool        b_simulate,
+                         int64_t *   p_shortcuts);
+static bool     priority(builder_t * p_build,
+                         uint32_t    vertex,
+                         uint64_t *  p_key);
+static bool     contract_all(builder_t * p_build);
+static bool     finish_contract(builder_t * p_build, uint32_t vertex);
+static size_t   block_size(uint32_t num_vertices,
+                           uint32_t num_forward,
+                           uint32_t num_backward);
+static void     bind_block(graph_ch_t * p_ch);
+static graph_ch_t * assemble(const builder_t * p_build);
+static void     fill_side(const up_list_t * p_list,
+                          const uint32_t *  p_rank,
+                          uint32_t          num_vertices,
+                          uint32_t *        p_offsets,
+                          ch_arc_t *        p_arcs);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Builds a contraction hierarchy.
+ *
+ * @param[in]  p_graph Graph to preprocess (weights must be non-negative)
+ * @param[out] p_stats Optional build counters
+ *
+ * @return Pointer to the new hierarchy, or NULL on failure
+ */
+graph_ch_t *
+graph_ch_build(const graph_t * p_graph, graph_ch_stats_t * p_stats)
+{
+    if ((NULL == p_graph) || (0 == p_graph->num_vertices))
+    {
+        return NULL;
+    }
+
+    graph_ch_stats_t stats = { 0 };
+    builder_t        build = { 0 };
+    graph_ch_t *     p_ch  = NULL;
+
+    build.p_stats = &stats;
+
+    if (builder_init(&build, p_graph) && contract_all(&build))
+    {
+        p_ch = assemble(&build);
+    }
+
+    stats.upward_arcs = build.forward.len + build.backward.len;
+    builder_free(&build);
+
+    if (NULL != p_stats)
+    {
+        *p_stats = stats;
+    }
+
+    return p_ch;
+}
+
+/*!
+ * @brief Writes a hierarchy to a file.
+ *
+ * @param[in] p_ch   Hierarchy
+ * @param[in] p_path Output path
+ *
+ * @return GRAPH_CH_SUCCESS on success, negative error code on failure
+ */
+int
+graph_ch_save(const graph_ch_t * p_ch, const char * p_path)
+{
+    if ((NULL == p_ch) || (NULL == p_path))
+    {
+        return GRAPH_CH_ERROR_PARAM;
+    }
+
+    FILE * p_file = fopen(p_path, "wb");
+    if (NULL == p_file)
+    {
+        return GRAPH_CH_ERROR_IO;
+    }
+
+    size_t written = fwrite(p_ch->p_block, 1, p_ch->size, p_file);
+    int    closed  = fclose(p_file);
+
+    return ((written == p_ch->size) && (0 == closed)) ? GRAPH_CH_SUCCESS
+                                                      : GRAPH_CH_ERROR_IO;
+}
+
+/*!
+ * @brief Maps a file written by graph_ch_save read-only.
+ *
+ * Only the header and the offset totals are checked, so the arcs are
+ * paged in lazily by the first queries that touch them.
+ *
+ * @param[in] p_path File path
+ *
+ * @return Pointer to the hierarchy, or NULL if the file is missing or not
+ *         a valid hierarchy
+ */
+graph_ch_t *
+graph_ch_open(const char * p_path)
+{
+    if (NULL == p_path)
+    {
+        return NULL;
+    }
+
+    int fd = open(p_path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat info;
+    void *      p_map = MAP_FAILED;
+
+    if ((0 == fstat(fd, &info))
+        && ((size_t)info.st_size >= sizeof(ch_header_t)))
+    {
+        p_map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (MAP_FAILED == p_map)
+    {
+        return NULL;
+    }
+
+    const ch_header_t * p_header = p_map;
+    graph_ch_t *        p_ch     = NULL;
+
+    if ((CH_MAGIC == p_header->magic) && (CH_VERSION == p_header->version)
+        && ((size_t)info.st_size
+            == block_size(p_header->num_vertices,
+                          p_header->num_forward,
+                          p_header->num_backward)))
+    {
+        p_ch = calloc(1, sizeof(graph_ch_t));
+    }
+
+    if (NULL == p_ch)
+    {
+        munmap(p_map, (size_t)info.st_size);
+        return NULL;
+    }
+
+    p_ch->p_block  = p_map;
+    p_ch->size     = (size_t)info.st_size;
+    p_ch->b_mapped = true;
+    bind_block(p_ch);
+
+    if ((p_ch->p_fwd_offsets[p_header->num_vertices] != p_header->num_forward)
+        || (p_ch->p_bwd_offsets[p_header->num_vertices]
+            != p_header->num_backward))
+    {
+        graph_ch_destroy(&p_ch);
+    }
+
+    return p_ch;
+}
+
+/*!
+ * @brief Gets the number of vertices of the original graph.
+ *
+ * @param[in] p_ch Hierarchy
+ *
+ * @return Vertex count, or 0 for NULL
+ */
+uint32_t
+graph_ch_vertices(const graph_ch_t * p_ch)
+{
+    return (NULL != p_ch) ? p_ch->p_header->num_vertices : 0;
+}
+
+/*!
+ * @brief Gets the size of the index as stored on disk.
+ *
+ * @param[in] p_ch Hierarchy
+ *
+ * @return Size in bytes, or 0 for NULL
+ */
+size_t
+graph_ch_size(const graph_ch_t * p_ch)
+{
+    return (NULL != p_ch) ? p_ch->size : 0;
+}
+
+/*!
+ * @brief Frees or unmaps a hierarchy.
+ *
+ * @param[in,out] pp_ch Pointer to the hierarchy pointer; set to NULL
+ */
+void
+graph_ch_destroy(graph_ch_t ** pp_ch)
+{
+    if ((NULL == pp_ch) || (NULL == *pp_ch))
+    {
+        return;
+    }
+
+    if ((*pp_ch)->b_mapped)
+    {
+        munmap((*pp_ch)->p_block, (*pp_ch)->size);
+    }
+    else
+    {
+        free((*pp_ch)->p_block);
+    }
+
+    free(*pp_ch);
+    *pp_ch = NULL;
+}
+
+/*!
+ * @brief Allocates query state for a hierarchy.
+ *
+ * @param[in] p_ch Hierarchy the state will be used with
+ *
+ * @return Pointer to the new query state, or NULL on failure
+ */
+graph_ch_query_t *
+graph_ch_query_create(const graph_ch_t * p_ch)
+{
+    if (NULL == p_ch)
+    {
+        return NULL;
+    }
+
+    graph_ch_query_t * p_query = calloc(1, sizeof(graph_ch_query_t));
+    if (NULL == p_query)
+    {
+        return NULL;
+    }
+
+    uint32_t count        = p_ch->p_header->num_vertices;
+    p_query->num_vertices = count;
+
+    bool b_ok = true;
+    for (int side = 0; side < 2; side++)
+    {
+        p_query->p_dist[side]  = malloc(count * sizeof(uint64_t));
+        p_query->p_stamp[side] = calloc(count, sizeof(uint32_t));
+        b_ok = b_ok && (NULL != p_query->p_dist[side])
+               && (NULL != p_query->p_stamp[side]);
+    }
+
+    if (!b_ok)
+    {
+        graph_ch_query_destroy(&p_query);
+    }
+
+    return p_query;
+}
+
+/*!
+ * @brief Frees query state.
+ *
+ * @param[in,out] pp_query Pointer to the query state pointer; set to NULL
+ */
+void
+graph_ch_query_destroy(graph_ch_query_t ** pp_query)
+{
+    if ((NULL == pp_query) || (NULL == *pp_query))
+    {
+        return;
+    }
+
+    for (int side = 0; side < 2; side++)
+    {
+        free((*pp_query)->p_dist[side]);
+        free((*pp_query)->p_stamp[side]);
+        free((*pp_query)->heap[side].p_entries);
+    }
+
+    free(*pp_query);
+    *pp_query = NULL;
+}
+
+/*!
+ * @brief Shortest path distance between two vertices.
+ *
+ * Runs the forward and backward upward searches interleaved, always
+ * advancing the side with the smaller queue head, and stops once both
+ * heads reach the best meeting distance. A vertex is stalled (not
+ * expanded) when a higher-ranked vertex already reaches it more cheaply,
+ * which prunes most of the search space on road graphs.
+ *
+ * @param[in]     p_ch     Hierarchy
+ * @param[in,out] p_query  Query state created for p_ch
+ * @param[in]     source   Start vertex (original id)
+ * @param[in]     target   Destination vertex (original id)
+ *
+ * @return Distance, or GRAPH_CH_INFINITY if target is unreachable or an
+ *         argument is invalid
+ */
+uint64_t
+graph_ch_distance(const graph_ch_t * p_ch,
+                  graph_ch_query_t * p_query,
+                  uint32_t           source,
+                  uint32_t           target)
+{
+    if ((NULL == p_ch) || (NULL == p_query)
+        || (p_query->num_vertices != p_ch->p_header->num_vertices)
+        || (source >= p_query->num_vertices)
+        || (target >= p_query->num_vertices))
+    {
+        return GRAPH_CH_INFINITY;
+    }
+
+    if (source == target)
+    {
+        return 0;
+    }
+
+    p_query->generation++;
+    if (0 == p_query->generation)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            memset(p_query->p_stamp[side], 0,
+                   p_query->num_vertices * sizeof(uint32_t));
+        }
+        p_query->generation = 1;
+    }
+
+    const uint32_t * offsets[2] = { p_ch->p_fwd_offsets, p_ch->p_bwd_offsets };
+    const ch_arc_t * arcs[2]    = { p_ch->p_fwd_arcs, p_ch->p_bwd_arcs };
+    uint32_t         starts[2]  = { p_ch->p_order[source],
+                                    p_ch->p_order[target] };
+    uint32_t         gen        = p_query->generation;
+    uint64_t         best       = GRAPH_CH_INFINITY;
+
+    for (int side = 0; side < 2; side++)
+    {
+        p_query->heap[side].len                  = 0;
+        p_query->p_dist[side][starts[side]]  = 0;
+        p_query->p_stamp[side][starts[side]] = gen;
+        if (!heap_push(&p_query->heap[side], 0, starts[side]))
+        {
+            return GRAPH_CH_INFINITY;
+        }
+    }
+
+    for (;;)
+    {
+        ch_heap_t * p_fwd = &p_query->heap[0];
+        ch_heap_t * p_bwd = &p_query->heap[1];
+        int         side;
+
+        if ((0 != p_fwd->len)
+            && ((0 == p_bwd->len)
+                || (p_fwd->p_entries[0].key <= p_bwd->p_entries[0].key)))
+        {
+            side = 0;
+        }
+        else if (0 != p_bwd->len)
+        {
+            side = 1;
+        }
+        else
+        {
+            break;
+        }
+
+        // The chosen head is the smaller one, so neither side can improve
+        if (p_query->heap[side].p_entries[0].key >= best)
+        {
+            break;
+        }
+
+        heap_entry_t top       = heap_pop(&p_query->heap[side]);
+        uint32_t     vertex    = top.vertex;
+        uint64_t *   p_dist    = p_query->p_dist[side];
+        uint32_t *   p_stamp   = p_query->p_stamp[side];
+        int          other     = 1 - side;
+
+        if (top.key > p_dist[vertex])
+        {
+            continue;
+        }
+
+        if ((gen == p_query->p_stamp[other][vertex])
+            && ((top.key + p_query->p_dist[other][vertex]) < best))
+        {
+            best = top.key + p_query->p_dist[other][vertex];
+        }
+
+        // Stall-on-demand: arcs of the opposite graph come from higher ranks
+        bool b_stalled = false;
+        for (uint32_t arc = offsets[other][vertex];
+             (arc < offsets[other][vertex + 1]) && !b_stalled;
+             arc++)
+        {
+            uint32_t higher = arcs[other][arc].vertex;
+            uint64_t via    = p_dist[higher] + arcs[other][arc].weight;
+            b_stalled       = (gen == p_stamp[higher]) && (via < top.key);
+        }
+
+        if (b_stalled)
+        {
+            continue;
+        }
+
+        for (uint32_t arc = offsets[side][vertex];
+             arc < offsets[side][vertex + 1];
+             arc++)
+        {
+            uint32_t next = arcs[side][arc].vertex;
+            uint64_t dist = top.key + arcs[side][arc].weight;
+
+            if ((gen != p_stamp[next]) || (dist < p_dist[next]))
+            {
+                p_stamp[next] = gen;
+                p_dist[next]  = dist;
+                if (!heap_push(&p_query->heap[side], dist, next))
+                {
+                    return GRAPH_CH_INFINITY;
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Pushes an entry, doubling the heap when it is full.
+ *
+ * @param[in,out] p_heap Heap
+ * @param[in]     key    Priority
+ * @param[in]     vertex Payload
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+heap_push(ch_heap_t * p_heap, uint64_t key, uint32_t vertex)
+{
+    if (p_heap->len == p_heap->cap)
+    {
+        size_t         cap       = (0 == p_heap->cap) ? 256 : (p_heap->cap * 2);
+        heap_entry_t * p_entries = realloc(p_heap->p_entries,
+                                           cap * sizeof(heap_entry_t));
+        if (NULL == p_entries)
+        {
+            return false;
+        }
+        p_heap->p_entries = p_entries;
+        p_heap->cap       = cap;
+    }
+
+    heap_entry_t * p_entries = p_heap->p_entries;
+    size_t         pos       = p_heap->len++;
+
+    while (pos > 0)
+    {
+        size_t parent = (pos - 1) / 2;
+        if (p_entries[parent].key <= key)
+        {
+            break;
+        }
+        p_entries[pos] = p_entries[parent];
+        pos            = parent;
+    }
+
+    p_entries[pos].key    = key;
+    p_entries[pos].vertex = vertex;
+    return true;
+}
+
+/*!
+ * @brief Removes and returns the entry with the smallest key.
+ *
+ * @param[in,out] p_heap Non-empty heap
+ *
+ * @return Smallest entry
+ */
+static heap_entry_t
+heap_pop(ch_heap_t * p_heap)
+{
+    heap_entry_t * p_entries = p_heap->p_entries;
+    heap_entry_t   top       = p_entries[0];
+    heap_entry_t   last      = p_entries[--p_heap->len];
+    size_t         len       = p_heap->len;
+    size_t         pos       = 0;
+
+    for (;;)
+    {
+        size_t child = (2 * pos) + 1;
+        if (child >= len)
+        {
+            break;
+        }
+        if (((child + 1) < len)
+            && (p_entries[child + 1].key < p_entries[child].key))
+        {
+            child++;
+        }
+        if (last.key <= p_entries[child].key)
+        {
+            break;
+        }
+        p_entries[pos] = p_entries[child];
+        pos            = child;
+    }
+
+    if (len > 0)
+    {
+        p_entries[pos] = last;
+    }
+
+    return top;
+}
+
+/*!
+ * @brief Adds an arc, or lowers the weight of an existing arc to the same
+ *        vertex.
+ *
+ * @param[in,out] p_list Arc list
+ * @param[in]     vertex Adjacent vertex
+ * @param[in]     weight Arc weight
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+arc_set_min(arc_list_t * p_list, uint32_t vertex, uint32_t weight)
+{
+    for (uint32_t idx = 0; idx < p_list->len; idx++)
+    {
+        if (vertex == p_list->p_arcs[idx].vertex)
+        {
+            if (weight < p_list->p_arcs[idx].weight)
+            {
+                p_list->p_arcs[idx].weight = weight;
+            }
+            return true;
+        }
+    }
+
+    if (p_list->len == p_list->cap)
+    {
+        uint32_t   cap    = (0 == p_list->cap) ? 4 : (p_list->cap * 2);
+        ch_arc_t * p_arcs = realloc(p_list->p_arcs, cap * sizeof(ch_arc_t));
+        if (NULL == p_arcs)
+        {
+            return false;
+        }
+        p_list->p_arcs = p_arcs;
+        p_list->cap    = cap;
+    }
+
+    p_list->p_arcs[p_list->len].vertex = vertex;
+    p_list->p_arcs[p_list->len].weight = weight;
+    p_list->len++;
+    return true;
+}
+
+/*!
+ * @brief Removes the arc to a vertex, if present, by swapping in the last.
+ *
+ * @param[in,out] p_list Arc list
+ * @param[in]     vertex Adjacent vertex to remove
+ */
+static void
+arc_remove(arc_list_t * p_list, uint32_t vertex)
+{
+    for (uint32_t idx = 0; idx < p_list->len; idx++)
+    {
+        if (vertex == p_list->p_arcs[idx].vertex)
+        {
+            p_list->p_arcs[idx] = p_list->p_arcs[--p_list->len];
+            return;
+        }
+    }
+}
+
+/*!
+ * @brief Appends an upward arc.
+ *
+ * @param[in,out] p_list List
+ * @param[in]     low    Contracted endpoint
+ * @param[in]     high   Remaining endpoint
+ * @param[in]     weight Arc weight
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+up_push(up_list_t * p_list, uint32_t low, uint32_t high, uint32_t weight)
+{
+    if (p_list->len == p_list->cap)
+    {
+        size_t     cap    = (0 == p_list->cap) ? 1024 : (p_list->cap * 2);
+        up_arc_t * p_arcs = realloc(p_list->p_arcs, cap * sizeof(up_arc_t));
+        if (NULL == p_arcs)
+        {
+            return false;
+        }
+        p_list->p_arcs = p_arcs;
+        p_list->cap    = cap;
+    }
+
+    p_list->p_arcs[p_list->len].low    = low;
+    p_list->p_arcs[p_list->len].high   = high;
+    p_list->p_arcs[p_list->len].weight = weight;
+    p_list->len++;
+    return true;
+}
+
+/*!
+ * @brief Allocates builder state and copies the graph into arc lists,
+ *        dropping self loops and keeping the lightest parallel arc.
+ *
+ * @param[out] p_build Builder
+ * @param[in]  p_graph Source graph
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+builder_init(builder_t * p_build, const graph_t * p_graph)
+{
+    uint32_t count = p_graph->num_vertices;
+
+    p_build->num_vertices = count;
+    p_build->p_out        = calloc(count, sizeof(arc_list_t));
+    p_build->p_in         = calloc(count, sizeof(arc_list_t));
+    p_build->p_rank       = malloc(count * sizeof(uint32_t));
+    p_build->p_deleted    = calloc(count, sizeof(uint32_t));
+    p_build->p_dist       = malloc(count * sizeof(uint64_t));
+    p_build->p_stamp      = calloc(count, sizeof(uint32_t));
+    p_build->p_wanted     = calloc(count, sizeof(uint32_t));
+
+    if ((NULL == p_build->p_out) || (NULL == p_build->p_in)
+        || (NULL == p_build->p_rank) || (NULL == p_build->p_deleted)
+        || (NULL == p_build->p_dist)
+        || (NULL == p_build->p_stamp) || (NULL == p_build->p_wanted))
+    {
+        return false;
+    }
+
+    for (uint32_t vertex = 0; vertex < count; vertex++)
+    {
+        p_build->p_rank[vertex] = GRAPH_NO_VERTEX;
+
+        for (uint64_t edge = p_graph->p_offsets[vertex];
+             edge < p_graph->p_offsets[vertex + 1];
+             edge++)
+        {
+            uint32_t target = p_graph->p_targets[edge];
+            uint32_t weight = p_graph->p_weights[edge];
+
+            if ((target != vertex)
+                && (!arc_set_min(&p_build->p_out[vertex], target, weight)
+                    || !arc_set_min(&p_build->p_in[target], vertex, weight)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Frees builder state.
+ *
+ * @param[in,out] p_build Builder
+ */
+static void
+builder_free(builder_t * p_build)
+{
+    for (uint32_t vertex = 0; vertex < p_build->num_vertices; vertex++)
+    {
+        if (NULL != p_build->p_out)
+        {
+            free(p_build->p_out[vertex].p_arcs);
+        }
+        if (NULL != p_build->p_in)
+        {
+            free(p_build->p_in[vertex].p_arcs);
+        }
+    }
+
+    free(p_build->p_out);
+    free(p_build->p_in);
+    free(p_build->p_rank);
+    free(p_build->p_deleted);
+    free(p_build->p_dist);
+    free(p_build->p_stamp);
+    free(p_build->p_wanted);
+    free(p_build->witness.p_entries);
+    free(p_build->forward.p_arcs);
+    free(p_build->backward.p_arcs);
+}
+
+/*!
+ * @brief Bounded Dijkstra over the remaining graph that avoids one vertex.
+ *
+ * Distances are left in p_dist for vertices whose stamp matches the
+ * current generation. The search also ends once every target is settled.
+ *
+ * @param[in,out] p_build      Builder
+ * @param[in]     source       Start vertex
+ * @param[in]     skip         Vertex being contracted
+ * @param[in]     p_targets    Out-arcs of skip; their heads are the targets
+ * @param[in]     bound        Stop once the queue head exceeds this
+ * @param[in]     settle_limit Stop after settling this many vertices
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+witness_search(builder_t *        p_build,
+               uint32_t           source,
+               uint32_t           skip,
+               const arc_list_t * p_targets,
+               uint64_t           bound,
+               uint32_t           settle_limit)
+{
+    p_build->generation++;
+    if (0 == p_build->generation)
+    {
+        memset(p_build->p_stamp, 0, p_build->num_vertices * sizeof(uint32_t));
+        p_build->generation = 1;
+    }
+
+    uint32_t    gen     = p_build->generation;
+    ch_heap_t * p_heap  = &p_build->witness;
+    uint32_t    settled = 0;
+    uint32_t    wanted  = 0;
+
+    for (uint32_t idx = 0; idx < p_targets->len; idx++)
+    {
+        uint32_t target = p_targets->p_arcs[idx].vertex;
+        if ((target != source) && (gen != p_build->p_wanted[target]))
+        {
+            p_build->p_wanted[target] = gen;
+            wanted++;
+        }
+    }
+
+    p_build->p_stats->witness_runs++;
+    p_heap->len                = 0;
+    p_build->p_dist[source]    = 0;
+    p_build->p_stamp[source]   = gen;
+
+    if (!heap_push(p_heap, 0, source))
+    {
+        return false;
+    }
+
+    while ((0 != p_heap->len) && (settled < settle_limit) && (0 != wanted))
+    {
+        heap_entry_t top = heap_pop(p_heap);
+
+        if (top.key > bound)
+        {
+            break;
+        }
+        if (top.key > p_build->p_dist[top.vertex])
+        {
+            continue;
+        }
+
+        settled++;
+        if (gen == p_build->p_wanted[top.vertex])
+        {
+            p_build->p_wanted[top.vertex] = 0;
+            wanted--;
+        }
+
+        const arc_list_t * p_out = &p_build->p_out[top.vertex];
+        for (uint32_t idx = 0; idx < p_out->len; idx++)
+        {
+            uint32_t next = p_out->p_arcs[idx].vertex;
+            uint64_t dist = top.key + p_out->p_arcs[idx].weight;
+
+            if ((next != skip)
+                && ((gen != p_build->p_stamp[next])
+                    || (dist < p_build->p_dist[next])))
+            {
+                p_build->p_stamp[next] = gen;
+                p_build->p_dist[next]  = dist;
+                if (!heap_push(p_heap, dist, next))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Contracts a vertex, or only counts the shortcuts it would need.
+ *
+ * For every remaining in-neighbour u and out-neighbour w of the vertex, a
+ * shortcut u->w is needed unless a witness path avoiding the vertex is no
+ * longer than u->vertex->w.
+ *
+ * @param[in,out] p_build     Builder
+ * @param[in]     vertex      Vertex to contract
+ * @param[in]     b_simulate  Only count, do not add shortcuts
+ * @param[out]    p_shortcuts Number of shortcuts needed
+ *
+ * @return true on success, false on allocation failure or weight overflow
+ */
+static bool
+contract(builder_t * p_build,
+         uint32_t    vertex,
+         bool        b_simulate,
+         int64_t *   p_shortcuts)
+{
+    const arc_list_t * p_in   = &p_build->p_in[vertex];
+    const arc_list_t * p_out  = &p_build->p_out[vertex];
+    uint32_t           limit  = b_simulate ? CH_SETTLE_SIMULATE
+                                           : CH_SETTLE_CONTRACT;
+    int64_t            needed = 0;
+
+    for (uint32_t in = 0; in < p_in->len; in++)
+    {
+        uint32_t from  = p_in->p_arcs[in].vertex;
+        uint64_t first = p_in->p_arcs[in].weight;
+        uint64_t bound = 0;
+        bool     b_any = false;
+
+        for (uint32_t out = 0; out < p_out->len; out++)
+        {
+            uint64_t through = first + p_out->p_arcs[out].weight;
+            if (p_out->p_arcs[out].vertex != from)
+            {
+                b_any = true;
+                bound = (through > bound) ? through : bound;
+            }
+        }
+
+        if (!b_any)
+        {
+            continue;
+        }
+
+        if (!witness_search(p_build, from, vertex, p_out, bound, limit))
+        {
+            return false;
+        }
+
+        for (uint32_t out = 0; out < p_out->len; out++)
+        {
+            uint32_t to      = p_out->p_arcs[out].vertex;
+            uint64_t through = first + p_out->p_arcs[out].weight;
+
+            if ((to == from)
+                || ((p_build->generation == p_build->p_stamp[to])
+                    && (p_build->p_dist[to] <= through)))
+            {
+                continue;
+            }
+
+            needed++;
+            if (b_simulate)
+            {
+                continue;
+            }
+
+            if ((through >= UINT32_MAX)
+                || !arc_set_min(&p_build->p_out[from], to, (uint32_t)through)
+                || !arc_set_min(&p_build->p_in[to], from, (uint32_t)through))
+            {
+                return false;
+            }
+            p_build->p_stats->shortcuts++;
+        }
+    }
+
+    *p_shortcuts = needed;
+    return true;
+}
+
+/*!
+ * @brief Computes the heap key of a vertex from its current neighbourhood.
+ *
+ * Priority is twice the edge difference plus the number of contracted
+ * neighbours, so cheap vertices go first and contraction spreads evenly
+ * over the graph instead of eating into one region.
+ *
+ * @param[in,out] p_build Builder
+ * @param[in]     vertex  Vertex
+ * @param[out]    p_key   Heap key
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+priority(builder_t * p_build, uint32_t vertex, uint64_t * p_key)
+{
+    int64_t shortcuts = 0;
+
+    if (!contract(p_build, vertex, true, &shortcuts))
+    {
+        return false;
+    }
+
+    int64_t removed = (int64_t)p_build->p_in[vertex].len
+                      + (int64_t)p_build->p_out[vertex].len;
+    int64_t value   = (2 * (shortcuts - removed)) + p_build->p_deleted[vertex];
+
+    *p_key = (uint64_t)(value + CH_PRIORITY_BIAS);
+    return true;
+}
+
+/*!
+ * @brief Contracts every vertex in priority order with lazy updates.
+ *
+ * @param[in,out] p_build Builder
+ *
+ * @return true on success, false on failure
+ */
+static bool
+contract_all(builder_t * p_build)
+{
+    ch_heap_t queue = { 0 };
+    bool      b_ok  = true;
+
+    for (uint32_t vertex = 0; b_ok && (vertex < p_build->num_vertices);
+         vertex++)
+    {
+        uint64_t key = 0;
+        b_ok = priority(p_build, vertex, &key)
+               && heap_push(&queue, key, vertex);
+    }
+
+    uint32_t rank = 0;
+    while (b_ok && (0 != queue.len))
+    {
+        heap_entry_t top = heap_pop(&queue);
+        uint64_t     key = 0;
+
+        b_ok = priority(p_build, top.vertex, &key);
+
+        // Lazy update: requeue if the refreshed priority lost its place
+        if (b_ok && (0 != queue.len) && (key > queue.p_entries[0].key))
+        {
+            b_ok = heap_push(&queue, key, top.vertex);
+            p_build->p_stats->lazy_updates++;
+            continue;
+        }
+
+        int64_t shortcuts = 0;
+        b_ok = b_ok && contract(p_build, top.vertex, false, &shortcuts)
+               && finish_contract(p_build, top.vertex);
+        p_build->p_rank[top.vertex] = rank++;
+    }
+
+    free(queue.p_entries);
+    return b_ok;
+}
+
+/*!
+ * @brief Records the upward arcs of a just-contracted vertex and removes
+ *        it from its neighbours.
+ *
+ * @param[in,out] p_build Builder
+ * @param[in]     vertex  Contracted vertex
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+finish_contract(builder_t * p_build, uint32_t vertex)
+{
+    arc_list_t * p_out = &p_build->p_out[vertex];
+    arc_list_t * p_in  = &p_build->p_in[vertex];
+
+    for (uint32_t idx = 0; idx < p_out->len; idx++)
+    {
+        uint32_t next = p_out->p_arcs[idx].vertex;
+
+        if (!up_push(&p_build->forward,
+                     vertex,
+                     next,
+                     p_out->p_arcs[idx].weight))
+        {
+            return false;
+        }
+        arc_remove(&p_build->p_in[next], vertex);
+        p_build->p_deleted[next]++;
+    }
+
+    for (uint32_t idx = 0; idx < p_in->len; idx++)
+    {
+        uint32_t prev = p_in->p_arcs[idx].vertex;
+
+        if (!up_push(&p_build->backward,
+                     vertex,
+                     prev,
+                     p_in->p_arcs[idx].weight))
+        {
+            return false;
+        }
+        arc_remove(&p_build->p_out[prev], vertex);
+        p_build->p_deleted[prev]++;
+    }
+
+    free(p_out->p_arcs);
+    free(p_in->p_arcs);
+    memset(p_out, 0, sizeof(arc_list_t));
+    memset(p_in, 0, sizeof(arc_list_t));
+    return true;
+}
+
+/*!
+ * @brief Size of an index block.
+ *
+ * @param[in] num_vertices Vertices
+ * @param[in] num_forward  Forward arcs
+ * @param[in] num_backward Backward arcs
+ *
+ * @return Size in bytes
+ */
+static size_t
+block_size(uint32_t num_vertices, uint32_t num_forward, uint32_t num_backward)
+{
+    return sizeof(ch_header_t) + ((size_t)num_vertices * sizeof(uint32_t))
+           + (2 * ((size_t)num_vertices + 1) * sizeof(uint32_t))
+           + (((size_t)num_forward + num_backward) * sizeof(ch_arc_t));
+}
+
+/*!
+ * @brief Points the array fields of a hierarchy into its block.
+ *
+ * @param[in,out] p_ch Hierarchy with p_block set
+ */
+static void
+bind_block(graph_ch_t * p_ch)
+{
+    const ch_header_t * p_header = p_ch->p_block;
+    const uint32_t *    p_words  = (const uint32_t *)(p_header + 1);
+    uint32_t            count    = p_header->num_vertices;
+
+    p_ch->p_header      = p_header;
+    p_ch->p_order       = p_words;
+    p_ch->p_fwd_offsets = p_ch->p_order + count;
+    p_ch->p_fwd_arcs    = (const ch_arc_t *)(p_ch->p_fwd_offsets + count + 1);
+    p_ch->p_bwd_offsets = (const uint32_t *)(p_ch->p_fwd_arcs
+                                             + p_header->num_forward);
+    p_ch->p_bwd_arcs    = (const ch_arc_t *)(p_ch->p_bwd_offsets + count + 1);
+}
+
+/*!
+ * @brief Lays out the finished hierarchy as one block, renumbered by rank.
+ *
+ * @param[in] p_build Builder after contract_all
+ *
+ * @return Pointer to the new hierarchy, or NULL on failure
+ */
+static graph_ch_t *
+assemble(const builder_t * p_build)
+{
+    if ((p_build->forward.len >= UINT32_MAX)
+        || (p_build->backward.len >= UINT32_MAX))
+    {
+        return NULL;
+    }
+
+    uint32_t     count    = p_build->num_vertices;
+    uint32_t     forward  = (uint32_t)p_build->forward.len;
+    uint32_t     backward = (uint32_t)p_build->backward.len;
+    size_t       size     = block_size(count, forward, backward);
+    graph_ch_t * p_ch     = calloc(1, sizeof(graph_ch_t));
+    void *       p_block  = calloc(1, size);
+
+    if ((NULL == p_ch) || (NULL == p_block))
+    {
+        free(p_ch);
+        free(p_block);
+        return NULL;
+    }
+
+    ch_header_t * p_header  = p_block;
+    p_header->magic         = CH_MAGIC;
+    p_header->version       = CH_VERSION;
+    p_header->num_vertices  = count;
+    p_header->num_forward   = forward;
+    p_header->num_backward  = backward;
+
+    p_ch->p_block = p_block;
+    p_ch->size    = size;
+    bind_block(p_ch);
+
+    // The arrays are const for queries; the builder owns them until now
+    memcpy((uint32_t *)p_ch->p_order,
+           p_build->p_rank,
+           count * sizeof(uint32_t));
+    fill_side(&p_build->forward,
+              p_build->p_rank,
+              count,
+              (uint32_t *)p_ch->p_fwd_offsets,
+              (ch_arc_t *)p_ch->p_fwd_arcs);
+    fill_side(&p_build->backward,
+              p_build->p_rank,
+              count,
+              (uint32_t *)p_ch->p_bwd_offsets,
+              (ch_arc_t *)p_ch->p_bwd_arcs);
+
+    return p_ch;
+}
+
+/*!
+ * @brief Counting-sorts upward arcs into CSR keyed by the rank of their
+ *        low endpoint.
+ *
+ * @param[in]  p_list       Upward arcs
+ * @param[in]  p_rank       Rank of every original vertex
+ * @param[in]  num_vertices Vertices
+ * @param[out] p_offsets    num_vertices + 1 offsets, zeroed on entry
+ * @param[out] p_arcs       Arcs with rank-numbered targets
+ */
+static void
+fill_side(const up_list_t * p_list,
+          const uint32_t *  p_rank,
+          uint32_t          num_vertices,
+          uint32_t *        p_offsets,
+          ch_arc_t *        p_arcs)
+{
+    for (size_t idx = 0; idx < p_list->len; idx++)
+    {
+        p_offsets[p_rank[p_list->p_arcs[idx].low]]++;
+    }
+
+    // Inclusive prefix sum: every offset is the end of its range for now
+    for (uint32_t vertex = 1; vertex < num_vertices; vertex++)
+    {
+        p_offsets[vertex] += p_offsets[vertex - 1];
+    }
+
+    // Placing from the back walks every offset down to its range start
+    for (size_t idx = p_list->len; idx > 0; idx--)
+    {
+        const up_arc_t * p_up = &p_list->p_arcs[idx - 1];
+        uint32_t         slot = --p_offsets[p_rank[p_up->low]];
+
+        p_arcs[slot].vertex = p_rank[p_up->high];
+        p_arcs[slot].weight = p_up->weight;
+    }
+
+    p_offsets[num_vertices] = (uint32_t)p_list->len;
+}
+
+/*** end of file ***/
@@ -0,0 +1,167 @@
+/** @file graph_ch.h
+ *
+ * @brief Contraction Hierarchies for fast point-to-point distances.
+ *
+ * graph_ch_build() contracts the vertices of a static graph one at a time
+ * in order of importance, adding a shortcut u->w whenever removing v would
+ * break the only shortest u->v->w path. Vertices are then renumbered by
+ * contraction rank and only the upward arcs are kept: a forward graph of
+ * arcs to higher-ranked vertices and a backward graph of arcs from them.
+ * A query is a bidirectional Dijkstra that only climbs, so it settles a
+ * few hundred vertices even on continental road graphs.
+ *
+ * The index is one flat block laid out exactly as it is stored on disk,
+ * so graph_ch_open() maps a saved file and queries it without parsing.
+ * Only distances are answered; shortcuts do not record the vertex they
+ * bypass.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef GRAPH_CH_H
+#define GRAPH_CH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "graph.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define GRAPH_CH_SUCCESS      (0)
+#define GRAPH_CH_ERROR_PARAM  (-1)
+#define GRAPH_CH_ERROR_IO     (-2)
+
+#define GRAPH_CH_INFINITY     (UINT64_MAX)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Built or mapped hierarchy */
+typedef struct graph_ch graph_ch_t;
+
+/* Reusable per-thread query state */
+typedef struct graph_ch_query graph_ch_query_t;
+
+/* Counters filled in by graph_ch_build */
+typedef struct
+{
+    uint64_t shortcuts;       /* Shortcut arcs added */
+    uint64_t upward_arcs;     /* Forward plus backward arcs kept */
+    uint64_t witness_runs;    /* Witness searches run */
+    uint32_t lazy_updates;    /* Vertices requeued with a worse priority */
+} graph_ch_stats_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Builds a contraction hierarchy.
+ *
+ * Vertices are ordered by twice the edge difference (shortcuts added
+ * minus arcs removed) plus the number of already contracted neighbours.
+ * Priorities are refreshed lazily: a popped vertex is re-evaluated and
+ * pushed back if it is no longer the minimum. Witness searches are
+ * bounded, so a few unnecessary shortcuts may be added; distances stay
+ * exact.
+ *
+ * @param[in]  p_graph Graph to preprocess (weights must be non-negative)
+ * @param[out] p_stats Optional build counters
+ *
+ * @return Pointer to the new hierarchy, or NULL on failure
+ */
+graph_ch_t *
+graph_ch_build(const graph_t * p_graph, graph_ch_stats_t * p_stats);
+
+/*!
+ * @brief Writes a hierarchy to a file.
+ *
+ * @param[in] p_ch   Hierarchy
+ * @param[in] p_path Output path
+ *
+ * @return GRAPH_CH_SUCCESS on success, negative error code on failure
+ */
+int
+graph_ch_save(const graph_ch_t * p_ch, const char * p_path);
+
+/*!
+ * @brief Maps a file written by graph_ch_save read-only.
+ *
+ * @param[in] p_path File path
+ *
+ * @return Pointer to the hierarchy, or NULL if the file is missing or not
+ *         a valid hierarchy
+ */
+graph_ch_t *
+graph_ch_open(const char * p_path);
+
+/*!
+ * @brief Gets the number of vertices of the original graph.
+ *
+ * @param[in] p_ch Hierarchy
+ *
+ * @return Vertex count, or 0 for NULL
+ */
+uint32_t
+graph_ch_vertices(const graph_ch_t * p_ch);
+
+/*!
+ * @brief Gets the size of the index as stored on disk.
+ *
+ * @param[in] p_ch Hierarchy
+ *
+ * @return Size in bytes, or 0 for NULL
+ */
+size_t
+graph_ch_size(const graph_ch_t * p_ch);
+
+/*!
+ * @brief Frees or unmaps a hierarchy.
+ *
+ * @param[in,out] pp_ch Pointer to the hierarchy pointer; set to NULL
+ */
+void
+graph_ch_destroy(graph_ch_t ** pp_ch);
+
+/*!
+ * @brief Allocates query state for a hierarchy.
+ *
+ * @param[in] p_ch Hierarchy the state will be used with
+ *
+ * @return Pointer to the new query state, or NULL on failure
+ */
+graph_ch_query_t *
+graph_ch_query_create(const graph_ch_t * p_ch);
+
+/*!
+ * @brief Frees query state.
+ *
+ * @param[in,out] pp_query Pointer to the query state pointer; set to NULL
+ */
+void
+graph_ch_query_destroy(graph_ch_query_t ** pp_query);
+
+/*!
+ * @brief Shortest path distance between two vertices.
+ *
+ * @param[in]     p_ch     Hierarchy
+ * @param[in,out] p_query  Query state created for p_ch
+ * @param[in]     source   Start vertex (original id)
+ * @param[in]     target   Destination vertex (original id)
+ *
+ * @return Distance, or GRAPH_CH_INFINITY if target is unreachable or an
+ *         argument is invalid
+ */
+uint64_t
+graph_ch_distance(const graph_ch_t * p_ch,
+                  graph_ch_query_t * p_query,
+                  uint32_t           source,
+                  uint32_t           target);
+
+#endif /* GRAPH_CH_H */
+
+/*** end of file ***/
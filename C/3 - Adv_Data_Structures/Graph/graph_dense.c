@@ -0,0 +1,617 @@
+/** @file graph_dense.c
+ *
+ * @brief Implementation of the bitset adjacency matrix.
+ *
+ * All algorithms are built on three row kernels: AND with popcount, OR,
+ * and the BFS step that masks a frontier with the visited set. With
+ * __AVX2__ defined (e.g. -mavx2 or -march=native) the kernels work on
+ * 256-bit vectors and count bits with the nibble lookup method (Mula et
+ * al.), which has no dependency on the scalar popcnt instruction;
+ * otherwise they fall back to one 64-bit word and __builtin_popcountll at
+ * a time.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "graph_dense.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define WORD_BITS   (64u)
+#define LINE_WORDS  (8u)  /* 64-bit words per 64-byte cache line */
+#define LINE_BYTES  (64u)
+
+#define ROW(p_dense, vertex) \
+    ((p_dense)->p_rows + ((size_t)(vertex) * (p_dense)->row_words))
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint64_t words_and_count(const uint64_t * p_a,
+                                const uint64_t * p_b,
+                                size_t           count);
+static void     words_or(uint64_t *       p_dst,
+                         const uint64_t * p_src,
+                         size_t           count);
+static bool     words_advance(uint64_t * p_next,
+                              uint64_t * p_visited,
+                              size_t     count);
+static void     set_bit(graph_dense_t * p_dense, uint32_t u, uint32_t v);
+static void     clear_bit(graph_dense_t * p_dense, uint32_t u, uint32_t v);
+static bool     test_bit(const uint64_t * p_row, uint32_t vertex);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Creates a dense graph with no edges.
+ *
+ * @param[in] num_vertices Number of vertices (1..GRAPH_DENSE_MAX_VERTICES)
+ * @param[in] b_undirected Mirror every added or removed edge
+ *
+ * @return Pointer to the new graph, or NULL on invalid input or allocation
+ *         failure
+ */
+graph_dense_t *
+graph_dense_create(uint32_t num_vertices, bool b_undirected)
+{
+    if ((0 == num_vertices) || (num_vertices > GRAPH_DENSE_MAX_VERTICES))
+    {
+        return NULL;
+    }
+
+    graph_dense_t * p_dense = calloc(1, sizeof(graph_dense_t));
+    if (NULL == p_dense)
+    {
+        return NULL;
+    }
+
+    // Whole cache lines per row keep every row aligned like the first one
+    uint32_t lines = (num_vertices + (LINE_WORDS * WORD_BITS) - 1)
+                     / (LINE_WORDS * WORD_BITS);
+    size_t   bytes = (size_t)num_vertices * lines * LINE_BYTES;
+    void *   p_mem = NULL;
+
+    if (0 != posix_memalign(&p_mem, LINE_BYTES, bytes))
+    {
+        free(p_dense);
+        return NULL;
+    }
+
+    memset(p_mem, 0, bytes);
+    p_dense->num_vertices = num_vertices;
+    p_dense->row_words    = lines * LINE_WORDS;
+    p_dense->b_undirected = b_undirected;
+    p_dense->p_rows       = p_mem;
+
+    return p_dense;
+}
+
+/*!
+ * @brief Copies the arcs of a CSR graph into a dense graph.
+ *
+ * @param[in] p_graph CSR graph with at most GRAPH_DENSE_MAX_VERTICES
+ *                    vertices
+ *
+ * @return Pointer to the new graph, or NULL on invalid input or allocation
+ *         failure
+ */
+graph_dense_t *
+graph_dense_from_graph(const graph_t * p_graph)
+{
+    if (NULL == p_graph)
+    {
+        return NULL;
+    }
+
+    graph_dense_t * p_dense
+        = graph_dense_create(p_graph->num_vertices, p_graph->b_undirected);
+    if (NULL == p_dense)
+    {
+        return NULL;
+    }
+
+    // An undirected CSR graph already stores both directions
+    for (uint32_t vertex = 0; vertex < p_graph->num_vertices; vertex++)
+    {
+        uint64_t * p_row = ROW(p_dense, vertex);
+        for (uint64_t edge = p_graph->p_offsets[vertex];
+             edge < p_graph->p_offsets[vertex + 1];
+             edge++)
+        {
+            uint32_t target = p_graph->p_targets[edge];
+            p_row[target / WORD_BITS] |= 1ull << (target % WORD_BITS);
+        }
+    }
+
+    return p_dense;
+}
+
+/*!
+ * @brief Adds the edge u->v (and v->u for an undirected graph).
+ *
+ * @param[in,out] p_dense Graph
+ * @param[in]     u       Source vertex
+ * @param[in]     v       Destination vertex
+ *
+ * @return GRAPH_DENSE_SUCCESS on success, negative error code on failure
+ */
+int
+graph_dense_add_edge(graph_dense_t * p_dense, uint32_t u, uint32_t v)
+{
+    if ((NULL == p_dense) || (u >= p_dense->num_vertices)
+        || (v >= p_dense->num_vertices))
+    {
+        return GRAPH_DENSE_ERROR_PARAM;
+    }
+
+    set_bit(p_dense, u, v);
+    if (p_dense->b_undirected)
+    {
+        set_bit(p_dense, v, u);
+    }
+
+    return GRAPH_DENSE_SUCCESS;
+}
+
+/*!
+ * @brief Removes the edge u->v (and v->u for an undirected graph).
+ *
+ * @param[in,out] p_dense Graph
+ * @param[in]     u       Source vertex
+ * @param[in]     v       Destination vertex
+ *
+ * @return GRAPH_DENSE_SUCCESS on success, negative error code on failure
+ */
+int
+graph_dense_remove_edge(graph_dense_t * p_dense, uint32_t u, uint32_t v)
+{
+    if ((NULL == p_dense) || (u >= p_dense->num_vertices)
+        || (v >= p_dense->num_vertices))
+    {
+        return GRAPH_DENSE_ERROR_PARAM;
+    }
+
+    clear_bit(p_dense, u, v);
+    if (p_dense->b_undirected)
+    {
+        clear_bit(p_dense, v, u);
+    }
+
+    return GRAPH_DENSE_SUCCESS;
+}
+
+/*!
+ * @brief Tests for the arc u->v.
+ *
+ * @param[in] p_dense Graph
+ * @param[in] u       Source vertex
+ * @param[in] v       Destination vertex
+ *
+ * @return true if the arc exists, false otherwise or on invalid input
+ */
+bool
+graph_dense_has_edge(const graph_dense_t * p_dense, uint32_t u, uint32_t v)
+{
+    if ((NULL == p_dense) || (u >= p_dense->num_vertices)
+        || (v >= p_dense->num_vertices))
+    {
+        return false;
+    }
+
+    return test_bit(ROW(p_dense, u), v);
+}
+
+/*!
+ * @brief Counts the out-neighbours of a vertex.
+ *
+ * @param[in] p_dense Graph
+ * @param[in] vertex  Vertex
+ *
+ * @return Out-degree, or 0 on invalid input
+ */
+uint32_t
+graph_dense_degree(const graph_dense_t * p_dense, uint32_t vertex)
+{
+    if ((NULL == p_dense) || (vertex >= p_dense->num_vertices))
+    {
+        return 0;
+    }
+
+    const uint64_t * p_row = ROW(p_dense, vertex);
+    return (uint32_t)words_and_count(p_row, p_row, p_dense->row_words);
+}
+
+/*!
+ * @brief Counts the vertices that are out-neighbours of both u and v.
+ *
+ * @param[in] p_dense Graph
+ * @param[in] u       First vertex
+ * @param[in] v       Second vertex
+ *
+ * @return Size of the intersection of both rows, or 0 on invalid input
+ */
+uint32_t
+graph_dense_common(const graph_dense_t * p_dense, uint32_t u, uint32_t v)
+{
+    if ((NULL == p_dense) || (u >= p_dense->num_vertices)
+        || (v >= p_dense->num_vertices))
+    {
+        return 0;
+    }
+
+    return (uint32_t)words_and_count(
+        ROW(p_dense, u), ROW(p_dense, v), p_dense->row_words);
+}
+
+/*!
+ * @brief Counts triangles.
+ *
+ * @param[in] p_dense Graph
+ *
+ * @return Number of triangles, or 0 for NULL
+ */
+uint64_t
+graph_dense_triangles(const graph_dense_t * p_dense)
+{
+    if (NULL == p_dense)
+    {
+        return 0;
+    }
+
+    uint64_t total = 0;
+    size_t   words = p_dense->row_words;
+
+    for (uint32_t u = 0; u < p_dense->num_vertices; u++)
+    {
+        const uint64_t * p_row_u = ROW(p_dense, u);
+
+        // Walk the neighbours v > u of u
+        for (size_t word = u / WORD_BITS; word < words; word++)
+        {
+            uint64_t bits = p_row_u[word];
+            if ((u / WORD_BITS) == word)
+            {
+                bits &= (~0ull << (u % WORD_BITS)) << 1;
+            }
+
+            while (0 != bits)
+            {
+                uint32_t v = (uint32_t)((word * WORD_BITS)
+                                        + (uint32_t)__builtin_ctzll(bits));
+                bits &= bits - 1;
+
+                // Common neighbours w > v: partial first word, then the rest
+                const uint64_t * p_row_v = ROW(p_dense, v);
+                size_t           first   = (v + 1) / WORD_BITS;
+                if (first >= words)
+                {
+                    continue;
+                }
+
+                uint64_t head = p_row_u[first] & p_row_v[first]
+                                & (~0ull << ((v + 1) % WORD_BITS));
+                total += (uint64_t)__builtin_popcountll(head);
+                total += words_and_count(p_row_u + first + 1,
+                                         p_row_v + first + 1,
+                                         words - first - 1);
+            }
+        }
+    }
+
+    return total;
+}
+
+/*!
+ * @brief Breadth-first search from one source vertex.
+ *
+ * @param[in]  p_dense Graph
+ * @param[in]  source  Start vertex
+ * @param[out] p_depth num_vertices entries; hop count from the source or
+ *                     GRAPH_DENSE_UNREACHED
+ *
+ * @return GRAPH_DENSE_SUCCESS on success, negative error code on failure
+ */
+int
+graph_dense_bfs(const graph_dense_t * p_dense,
+                uint32_t              source,
+                uint32_t *            p_depth)
+{
+    if ((NULL == p_dense) || (source >= p_dense->num_vertices)
+        || (NULL == p_depth))
+    {
+        return GRAPH_DENSE_ERROR_PARAM;
+    }
+
+    size_t     words  = p_dense->row_words;
+    uint64_t * p_bits = calloc(3 * words, sizeof(uint64_t));
+    if (NULL == p_bits)
+    {
+        return GRAPH_DENSE_ERROR_MEMORY;
+    }
+
+    uint64_t * p_visited  = p_bits;
+    uint64_t * p_frontier = p_bits + words;
+    uint64_t * p_next     = p_bits + (2 * words);
+
+    for (uint32_t vertex = 0; vertex < p_dense->num_vertices; vertex++)
+    {
+        p_depth[vertex] = GRAPH_DENSE_UNREACHED;
+    }
+
+    p_depth[source]                = 0;
+    p_visited[source / WORD_BITS]  = 1ull << (source % WORD_BITS);
+    p_frontier[source / WORD_BITS] = 1ull << (source % WORD_BITS);
+    uint32_t level                 = 0;
+    bool     b_more                = true;
+
+    while (b_more)
+    {
+        memset(p_next, 0, words * sizeof(uint64_t));
+        for (size_t word = 0; word < words; word++)
+        {
+            uint64_t bits = p_frontier[word];
+            while (0 != bits)
+            {
+                uint32_t vertex = (uint32_t)((word * WORD_BITS)
+                                             + (uint32_t)__builtin_ctzll(bits));
+                bits &= bits - 1;
+                words_or(p_next, ROW(p_dense, vertex), words);
+            }
+        }
+
+        b_more = words_advance(p_next, p_visited, words);
+        level++;
+
+        for (size_t word = 0; b_more && (word < words); word++)
+        {
+            uint64_t bits = p_next[word];
+            while (0 != bits)
+            {
+                p_depth[(word * WORD_BITS) + (uint32_t)__builtin_ctzll(bits)]
+                    = level;
+                bits &= bits - 1;
+            }
+        }
+
+        uint64_t * p_swap = p_frontier;
+        p_frontier        = p_next;
+        p_next            = p_swap;
+    }
+
+    free(p_bits);
+    return GRAPH_DENSE_SUCCESS;
+}
+
+/*!
+ * @brief Computes the transitive closure (Warshall's algorithm on rows).
+ *
+ * @param[in] p_dense Graph
+ *
+ * @return Pointer to a new graph holding the closure, or NULL on failure
+ */
+graph_dense_t *
+graph_dense_closure(const graph_dense_t * p_dense)
+{
+    if (NULL == p_dense)
+    {
+        return NULL;
+    }
+
+    graph_dense_t * p_closure
+        = graph_dense_create(p_dense->num_vertices, p_dense->b_undirected);
+    if (NULL == p_closure)
+    {
+        return NULL;
+    }
+
+    size_t words = p_dense->row_words;
+    memcpy(p_closure->p_rows,
+           p_dense->p_rows,
+           (size_t)p_dense->num_vertices * words * sizeof(uint64_t));
+
+    // After step k every row holds the vertices reachable through
+    // intermediate vertices 0..k, so a row that reaches k takes in row k
+    for (uint32_t via = 0; via < p_closure->num_vertices; via++)
+    {
+        const uint64_t * p_via = ROW(p_closure, via);
+        for (uint32_t vertex = 0; vertex < p_closure->num_vertices; vertex++)
+        {
+            if ((vertex != via) && test_bit(ROW(p_closure, vertex), via))
+            {
+                words_or(ROW(p_closure, vertex), p_via, words);
+            }
+        }
+    }
+
+    return p_closure;
+}
+
+/*!
+ * @brief Frees a dense graph.
+ *
+ * @param[in,out] pp_dense Pointer to the graph pointer; set to NULL
+ */
+void
+graph_dense_destroy(graph_dense_t ** pp_dense)
+{
+    if ((NULL == pp_dense) || (NULL == *pp_dense))
+    {
+        return;
+    }
+
+    free((*pp_dense)->p_rows);
+    free(*pp_dense);
+    *pp_dense = NULL;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+#ifdef __AVX2__
+/*!
+ * @brief Counts the set bits of each 64-bit lane of a vector.
+ *
+ * @param[in] value Vector
+ *
+ * @return Four 64-bit lane counts
+ */
+static inline __m256i
+popcount_lanes(__m256i value)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                            1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3,
+                                            1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+    __m256i low   = _mm256_and_si256(value, nibble);
+    __m256i high  = _mm256_and_si256(_mm256_srli_epi16(value, 4), nibble);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                    _mm256_shuffle_epi8(lookup, high));
+
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+#endif
+
+/*!
+ * @brief Counts the bits set in both of two word arrays.
+ *
+ * @param[in] p_a   First array
+ * @param[in] p_b   Second array
+ * @param[in] count Number of words
+ *
+ * @return popcount(p_a & p_b)
+ */
+static uint64_t
+words_and_count(const uint64_t * p_a, const uint64_t * p_b, size_t count)
+{
+    uint64_t total = 0;
+    size_t   idx   = 0;
+
+#ifdef __AVX2__
+    __m256i sum = _mm256_setzero_si256();
+    for (; (idx + 4) <= count; idx += 4)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(p_a + idx));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(p_b + idx));
+        sum       = _mm256_add_epi64(sum,
+                                     popcount_lanes(_mm256_and_si256(a, b)));
+    }
+
+    total = (uint64_t)_mm256_extract_epi64(sum, 0)
+            + (uint64_t)_mm256_extract_epi64(sum, 1)
+            + (uint64_t)_mm256_extract_epi64(sum, 2)
+            + (uint64_t)_mm256_extract_epi64(sum, 3);
+#endif
+
+    for (; idx < count; idx++)
+    {
+        total += (uint64_t)__builtin_popcountll(p_a[idx] & p_b[idx]);
+    }
+
+    return total;
+}
+
+/*!
+ * @brief ORs one word array into another.
+ *
+ * @param[in,out] p_dst Destination array
+ * @param[in]     p_src Source array
+ * @param[in]     count Number of words
+ */
+static void
+words_or(uint64_t * p_dst, const uint64_t * p_src, size_t count)
+{
+    size_t idx = 0;
+
+#ifdef __AVX2__
+    for (; (idx + 4) <= count; idx += 4)
+    {
+        __m256i dst = _mm256_loadu_si256((const __m256i *)(p_dst + idx));
+        __m256i src = _mm256_loadu_si256((const __m256i *)(p_src + idx));
+        _mm256_storeu_si256((__m256i *)(p_dst + idx),
+                            _mm256_or_si256(dst, src));
+    }
+#endif
+
+    for (; idx < count; idx++)
+    {
+        p_dst[idx] |= p_src[idx];
+    }
+}
+
+/*!
+ * @brief Drops visited vertices from the next frontier and marks the rest
+ *        visited.
+ *
+ * @param[in,out] p_next    Next frontier
+ * @param[in,out] p_visited Visited set
+ * @param[in]     count     Number of words
+ *
+ * @return true if the next frontier is not empty
+ */
+static bool
+words_advance(uint64_t * p_next, uint64_t * p_visited, size_t count)
+{
+    uint64_t any = 0;
+    size_t   idx = 0;
+
+#ifdef __AVX2__
+    __m256i seen = _mm256_setzero_si256();
+    for (; (idx + 4) <= count; idx += 4)
+    {
+        __m256i next = _mm256_loadu_si256((const __m256i *)(p_next + idx));
+        __m256i done
+            = _mm256_loadu_si256((const __m256i *)(p_visited + idx));
+
+        next = _mm256_andnot_si256(done, next);
+        _mm256_storeu_si256((__m256i *)(p_next + idx), next);
+        _mm256_storeu_si256((__m256i *)(p_visited + idx),
+                            _mm256_or_si256(done, next));
+        seen = _mm256_or_si256(seen, next);
+    }
+    any = (uint64_t)!_mm256_testz_si256(seen, seen);
+#endif
+
+    for (; idx < count; idx++)
+    {
+        p_next[idx] &= ~p_visited[idx];
+        p_visited[idx] |= p_next[idx];
+        any |= p_next[idx];
+    }
+
+    return (0 != any);
+}
+
+static void
+set_bit(graph_dense_t * p_dense, uint32_t u, uint32_t v)
+{
+    ROW(p_dense, u)[v / WORD_BITS] |= 1ull << (v % WORD_BITS);
+}
+
+static void
+clear_bit(graph_dense_t * p_dense, uint32_t u, uint32_t v)
+{
+    ROW(p_dense, u)[v / WORD_BITS] &= ~(1ull << (v % WORD_BITS));
+}
+
+static bool
+test_bit(const uint64_t * p_row, uint32_t vertex)
+{
+    return 0 != ((p_row[vertex / WORD_BITS] >> (vertex % WORD_BITS)) & 1u);
+}
+
+/*** end of file ***/
@@ -0,0 +1,231 @@
+/** @file graph_runner.c
+ *
+ * @brief Implementation of the fork-join runner used by the graph searches.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "graph_runner.h"
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* Argument handed to one pool job */
+typedef struct
+{
+    graph_runner_t * p_runner; /* Owning runner */
+    uint32_t         worker;   /* Task index passed to fn */
+} runner_slot_t;
+
+struct graph_runner
+{
+    thread_pool_t *   p_pool;      /* Pool that runs tasks 1..n-1 */
+    uint32_t          num_workers; /* Tasks per run */
+    runner_slot_t *   p_slots;     /* One slot per worker */
+    graph_task_fn_t   fn;          /* Task body of the current run */
+    void *            p_ctx;       /* Context of the current run */
+    uint32_t          pending;     /* Pool tasks not finished yet */
+    pthread_mutex_t   lock;        /* Protects pending */
+    pthread_cond_t    done;        /* Signalled when pending reaches 0 */
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void * runner_job(void * p_arg);
+static void   runner_finish_one(graph_runner_t * p_runner);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Creates a runner bound to a pool.
+ *
+ * @param[in] p_pool      Thread pool (NULL runs every task on the caller)
+ * @param[in] num_workers Tasks per run (must be > 0)
+ *
+ * @return Pointer to the new runner, or NULL on failure
+ */
+graph_runner_t *
+graph_runner_create(thread_pool_t * p_pool, uint32_t num_workers)
+{
+    if (0 == num_workers)
+    {
+        return NULL;
+    }
+
+    graph_runner_t * p_runner = calloc(1, sizeof(graph_runner_t));
+    if (NULL == p_runner)
+    {
+        return NULL;
+    }
+
+    p_runner->p_slots = calloc(num_workers, sizeof(runner_slot_t));
+    if (NULL == p_runner->p_slots)
+    {
+        free(p_runner);
+        return NULL;
+    }
+
+    if (0 != pthread_mutex_init(&p_runner->lock, NULL))
+    {
+        free(p_runner->p_slots);
+        free(p_runner);
+        return NULL;
+    }
+
+    if (0 != pthread_cond_init(&p_runner->done, NULL))
+    {
+        pthread_mutex_destroy(&p_runner->lock);
+        free(p_runner->p_slots);
+        free(p_runner);
+        return NULL;
+    }
+
+    p_runner->p_pool      = p_pool;
+    p_runner->num_workers = num_workers;
+
+    for (uint32_t idx = 0; idx < num_workers; idx++)
+    {
+        p_runner->p_slots[idx].p_runner = p_runner;
+        p_runner->p_slots[idx].worker   = idx;
+    }
+
+    return p_runner;
+}
+
+/*!
+ * @brief Runs fn(p_ctx, worker) for every worker and waits for all of them.
+ *
+ * @param[in] p_runner Runner
+ * @param[in] fn       Task body
+ * @param[in] p_ctx    Shared task context
+ */
+void
+graph_runner_run(graph_runner_t * p_runner, graph_task_fn_t fn, void * p_ctx)
+{
+    if ((NULL == p_runner) || (NULL == fn))
+    {
+        return;
+    }
+
+    p_runner->fn    = fn;
+    p_runner->p_ctx = p_ctx;
+
+    if ((NULL == p_runner->p_pool) || (1 == p_runner->num_workers))
+    {
+        for (uint32_t idx = 0; idx < p_runner->num_workers; idx++)
+        {
+            fn(p_ctx, idx);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&p_runner->lock);
+    p_runner->pending = p_runner->num_workers - 1;
+    pthread_mutex_unlock(&p_runner->lock);
+
+    for (uint32_t idx = 1; idx < p_runner->num_workers; idx++)
+    {
+        thread_job_t job = { .job_fn = runner_job,
+                             .p_arg  = &p_runner->p_slots[idx] };
+
+        // A refused task still has to run before the barrier can release
+        if (0 != thread_pool_submit(p_runner->p_pool, &job))
+        {
+            runner_job(&p_runner->p_slots[idx]);
+        }
+    }
+
+    fn(p_ctx, 0);
+
+    pthread_mutex_lock(&p_runner->lock);
+    while (0 != p_runner->pending)
+    {
+        pthread_cond_wait(&p_runner->done, &p_runner->lock);
+    }
+    pthread_mutex_unlock(&p_runner->lock);
+}
+
+/*!
+ * @brief Gets the number of tasks per run.
+ *
+ * @param[in] p_runner Runner
+ *
+ * @return Number of workers, or 0 for a NULL runner
+ */
+uint32_t
+graph_runner_workers(const graph_runner_t * p_runner)
+{
+    return (NULL != p_runner) ? p_runner->num_workers : 0;
+}
+
+/*!
+ * @brief Frees a runner.
+ *
+ * @param[in,out] pp_runner Pointer to the runner pointer; set to NULL
+ */
+void
+graph_runner_destroy(graph_runner_t ** pp_runner)
+{
+    if ((NULL == pp_runner) || (NULL == *pp_runner))
+    {
+        return;
+    }
+
+    graph_runner_t * p_runner = *pp_runner;
+
+    pthread_cond_destroy(&p_runner->done);
+    pthread_mutex_destroy(&p_runner->lock);
+    free(p_runner->p_slots);
+    free(p_runner);
+    *pp_runner = NULL;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Pool job: runs one task and reports completion.
+ *
+ * @param[in] p_arg Pointer to the runner_slot_t of the task
+ *
+ * @return NULL in all cases
+ */
+static void *
+runner_job(void * p_arg)
+{
+    runner_slot_t *  p_slot   = (runner_slot_t *)p_arg;
+    graph_runner_t * p_runner = p_slot->p_runner;
+
+    p_runner->fn(p_runner->p_ctx, p_slot->worker);
+    runner_finish_one(p_runner);
+
+    return NULL;
+}
+
+/*!
+ * @brief Decrements the pending count and wakes the caller at zero.
+ *
+ * @param[in] p_runner Runner
+ */
+static void
+runner_finish_one(graph_runner_t * p_runner)
+{
+    pthread_mutex_lock(&p_runner->lock);
+    p_runner->pending--;
+    if (0 == p_runner->pending)
+    {
+        pthread_cond_signal(&p_runner->done);
+    }
+    pthread_mutex_unlock(&p_runner->lock);
+}
+
+/*** end of file ***/
@@ -0,0 +1,75 @@
+/** @file graph_runner.h
+ *
+ * @brief Fork-join helper that runs one task per worker on a thread pool.
+ *
+ * graph_runner_run() submits tasks 1..num_workers-1 to the pool, runs task
+ * 0 on the calling thread and returns once every task has finished, so
+ * each call is a full barrier. Tasks that the pool refuses are run on the
+ * calling thread instead, which keeps the result correct under load.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef GRAPH_RUNNER_H
+#define GRAPH_RUNNER_H
+
+#include <stdint.h>
+#include "../Thread_Pool/thread_pool.h"
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+// Opaque fork-join runner
+typedef struct graph_runner graph_runner_t;
+
+// Task body; worker is 0..num_workers-1
+typedef void (*graph_task_fn_t)(void * p_ctx, uint32_t worker);
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Creates a runner bound to a pool.
+ *
+ * @param[in] p_pool      Thread pool (NULL runs every task on the caller)
+ * @param[in] num_workers Tasks per run (must be > 0)
+ *
+ * @return Pointer to the new runner, or NULL on failure
+ */
+graph_runner_t *
+graph_runner_create(thread_pool_t * p_pool, uint32_t num_workers);
+
+/*!
+ * @brief Runs fn(p_ctx, worker) for every worker and waits for all of them.
+ *
+ * @param[in] p_runner Runner
+ * @param[in] fn       Task body
+ * @param[in] p_ctx    Shared task context
+ */
+void
+graph_runner_run(graph_runner_t * p_runner, graph_task_fn_t fn, void * p_ctx);
+
+/*!
+ * @brief Gets the number of tasks per run.
+ *
+ * @param[in] p_runner Runner
+ *
+ * @return Number of workers, or 0 for a NULL runner
+ */
+uint32_t
+graph_runner_workers(const graph_runner_t * p_runner);
+
+/*!
+ * @brief Frees a runner.
+ *
+ * @param[in,out] pp_runner Pointer to the runner pointer; set to NULL
+ */
+void
+graph_runner_destroy(graph_runner_t ** pp_runner);
+
+#endif /* GRAPH_RUNNER_H */
+
+/*** end of file ***/
@@ -0,0 +1,855 @@
+/** @file graph_search.c
+ *
+ * @brief Direction-optimizing BFS and delta-stepping SSSP over a thread pool.
+ *
+ * Every search step is a graph_runner_run() call: the work of the step is
+ * split into num_workers contiguous slices, and the runner acts as the
+ * barrier between steps. Workers collect newly discovered vertices in
+ * private buffers which the calling thread concatenates between steps.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "graph_runner.h"
+#include "graph_search.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define BFS_ALPHA          (14u) /* Go bottom-up when frontier edges > m_u / alpha */
+#define BFS_BETA           (24u) /* Go top-down when frontier < n / beta */
+#define BITS_PER_WORD      (64u)
+#define INITIAL_VEC_CAP    (64u)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* Growable array of vertex ids owned by one worker */
+typedef struct
+{
+    uint32_t * p_items; /* Vertex ids */
+    size_t     len;     /* Entries in use */
+    size_t     cap;     /* Entries allocated */
+} vertex_vec_t;
+
+/* Per-worker BFS scratch, padded apart to avoid false sharing */
+typedef struct
+{
+    vertex_vec_t next;        /* Vertices discovered in this step */
+    uint64_t     scout_count; /* Out-degree sum of discovered vertices */
+    bool         b_failed;    /* An allocation failed */
+    char         pad[64];
+} bfs_worker_t;
+
+/* Shared BFS state */
+typedef struct
+{
+    const graph_t * p_graph;
+    uint32_t *      p_parent;
+    uint32_t *      p_depth;
+    uint32_t        num_workers;
+    uint32_t        level;       /* Depth of the current frontier */
+    uint32_t *      p_queue;     /* Frontier as a list (top-down) */
+    size_t          queue_len;
+    uint64_t *      p_front;     /* Frontier as a bitmap (bottom-up) */
+    uint64_t *      p_next;      /* Next frontier bitmap (bottom-up) */
+    size_t          num_words;   /* Words per bitmap */
+    bfs_worker_t *  p_workers;
+} bfs_ctx_t;
+
+/* Per-worker delta-stepping scratch */
+typedef struct
+{
+    vertex_vec_t * p_bins;   /* Bucket index -> vertices to settle */
+    size_t         num_bins; /* Buckets allocated */
+    bool           b_failed; /* An allocation failed */
+    char           pad[64];
+} sssp_worker_t;
+
+/* Shared delta-stepping state */
+typedef struct
+{
+    const graph_t * p_graph;
+    uint64_t *      p_dist;
+    uint64_t        delta;
+    uint64_t        bin;         /* Bucket being settled */
+    uint32_t        num_workers;
+    uint32_t *      p_frontier;  /* Vertices of the current bucket */
+    size_t          frontier_len;
+    size_t          frontier_cap;
+    sssp_worker_t * p_workers;
+} sssp_ctx_t;
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static int  bfs_run(bfs_ctx_t *         p_ctx,
+                    graph_runner_t *    p_runner,
+                    uint32_t            source,
+                    graph_bfs_mode_t    mode,
+                    graph_bfs_stats_t * p_stats);
+static int  sssp_run(sssp_ctx_t * p_ctx, graph_runner_t * p_runner, uint32_t source);
+static bool vec_push(vertex_vec_t * p_vec, uint32_t vertex);
+static void slice_bounds(size_t    len,
+                         uint32_t  parts,
+                         uint32_t  part,
+                         size_t *  p_begin,
+                         size_t *  p_end);
+static bool gather_workers(bfs_ctx_t * p_ctx);
+static void bfs_top_down_task(void * p_arg, uint32_t worker);
+static void bfs_bottom_up_task(void * p_arg, uint32_t worker);
+static void bfs_queue_to_bitmap_task(void * p_arg, uint32_t worker);
+static void bfs_bitmap_to_queue_task(void * p_arg, uint32_t worker);
+static void sssp_relax_task(void * p_arg, uint32_t worker);
+static bool sssp_next_bucket(sssp_ctx_t * p_ctx);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Breadth-first search from one source vertex.
+ *
+ * @param[in]  p_graph     Graph to search
+ * @param[in]  source      Start vertex
+ * @param[in]  mode        Frontier expansion strategy
+ * @param[in]  p_pool      Thread pool for the workers (NULL runs serially)
+ * @param[in]  num_workers Tasks per step (1..GRAPH_SEARCH_MAX_WORKERS)
+ * @param[out] p_parent    BFS tree parent of every vertex
+ * @param[out] p_depth     Optional hop count of every vertex
+ * @param[out] p_stats     Optional search counters
+ *
+ * @return GRAPH_SEARCH_SUCCESS on success, negative error code on failure
+ */
+int
+graph_bfs(const graph_t *     p_graph,
+          uint32_t            source,
+          graph_bfs_mode_t    mode,
+          thread_pool_t *     p_pool,
+          uint32_t            num_workers,
+          uint32_t *          p_parent,
+          uint32_t *          p_depth,
+          graph_bfs_stats_t * p_stats)
+{
+    if ((NULL == p_graph) || (NULL == p_parent)
+        || (source >= p_graph->num_vertices) || (0 == num_workers)
+        || (num_workers > GRAPH_SEARCH_MAX_WORKERS))
+    {
+        return GRAPH_SEARCH_ERROR_PARAM;
+    }
+
+    bfs_ctx_t ctx = { 0 };
+    ctx.p_graph     = p_graph;
+    ctx.p_parent    = p_parent;
+    ctx.p_depth     = p_depth;
+    ctx.num_workers = num_workers;
+    ctx.num_words
+        = ((size_t)p_graph->num_vertices + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    ctx.p_queue   = malloc((size_t)p_graph->num_vertices * sizeof(uint32_t));
+    ctx.p_front   = calloc(ctx.num_words, sizeof(uint64_t));
+    ctx.p_next    = calloc(ctx.num_words, sizeof(uint64_t));
+    ctx.p_workers = calloc(num_workers, sizeof(bfs_worker_t));
+
+    graph_runner_t * p_runner = graph_runner_create(p_pool, num_workers);
+    int              result   = GRAPH_SEARCH_ERROR_MEMORY;
+
+    if ((NULL != ctx.p_queue) && (NULL != ctx.p_front) && (NULL != ctx.p_next)
+        && (NULL != ctx.p_workers) && (NULL != p_runner))
+    {
+        result = bfs_run(&ctx, p_runner, source, mode, p_stats);
+    }
+
+    if (NULL != ctx.p_workers)
+    {
+        for (uint32_t idx = 0; idx < num_workers; idx++)
+        {
+            free(ctx.p_workers[idx].next.p_items);
+        }
+    }
+    free(ctx.p_workers);
+    free(ctx.p_next);
+    free(ctx.p_front);
+    free(ctx.p_queue);
+    graph_runner_destroy(&p_runner);
+
+    return result;
+}
+
+/*!
+ * @brief Delta-stepping single-source shortest paths.
+ *
+ * @param[in]  p_graph     Graph to search (weights must be non-negative)
+ * @param[in]  source      Start vertex
+ * @param[in]  delta       Bucket width (must be > 0)
+ * @param[in]  p_pool      Thread pool for the workers (NULL runs serially)
+ * @param[in]  num_workers Tasks per step (1..GRAPH_SEARCH_MAX_WORKERS)
+ * @param[out] p_dist      Shortest distance of every vertex
+ *
+ * @return GRAPH_SEARCH_SUCCESS on success, negative error code on failure
+ */
+int
+graph_sssp_delta(const graph_t * p_graph,
+                 uint32_t        source,
+                 uint32_t        delta,
+                 thread_pool_t * p_pool,
+                 uint32_t        num_workers,
+                 uint64_t *      p_dist)
+{
+    if ((NULL == p_graph) || (NULL == p_dist) || (0 == delta)
+        || (source >= p_graph->num_vertices) || (0 == num_workers)
+        || (num_workers > GRAPH_SEARCH_MAX_WORKERS))
+    {
+        return GRAPH_SEARCH_ERROR_PARAM;
+    }
+
+    sssp_ctx_t ctx   = { 0 };
+    ctx.p_graph      = p_graph;
+    ctx.p_dist       = p_dist;
+    ctx.delta        = delta;
+    ctx.num_workers  = num_workers;
+    ctx.frontier_cap = INITIAL_VEC_CAP;
+    ctx.p_frontier   = malloc(ctx.frontier_cap * sizeof(uint32_t));
+    ctx.p_workers    = calloc(num_workers, sizeof(sssp_worker_t));
+
+    graph_runner_t * p_runner = graph_runner_create(p_pool, num_workers);
+    int              result   = GRAPH_SEARCH_ERROR_MEMORY;
+
+    if ((NULL != ctx.p_frontier) && (NULL != ctx.p_workers)
+        && (NULL != p_runner))
+    {
+        result = sssp_run(&ctx, p_runner, source);
+    }
+
+    if (NULL != ctx.p_workers)
+    {
+        for (uint32_t idx = 0; idx < num_workers; idx++)
+        {
+            for (size_t bin = 0; bin < ctx.p_workers[idx].num_bins; bin++)
+            {
+                free(ctx.p_workers[idx].p_bins[bin].p_items);
+            }
+            free(ctx.p_workers[idx].p_bins);
+        }
+    }
+    free(ctx.p_workers);
+    free(ctx.p_frontier);
+    graph_runner_destroy(&p_runner);
+
+    return result;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Level loop of graph_bfs once all scratch memory is allocated.
+ *
+ * @param[in,out] p_ctx    BFS state
+ * @param[in]     p_runner Fork-join runner
+ * @param[in]     source   Start vertex
+ * @param[in]     mode     Frontier expansion strategy
+ * @param[out]    p_stats  Optional search counters
+ *
+ * @return GRAPH_SEARCH_SUCCESS on success, negative error code on failure
+ */
+static int
+bfs_run(bfs_ctx_t *         p_ctx,
+        graph_runner_t *    p_runner,
+        uint32_t            source,
+        graph_bfs_mode_t    mode,
+        graph_bfs_stats_t * p_stats)
+{
+    const graph_t * p_graph      = p_ctx->p_graph;
+    uint32_t        num_vertices = p_graph->num_vertices;
+
+    for (uint32_t vertex = 0; vertex < num_vertices; vertex++)
+    {
+        p_ctx->p_parent[vertex] = GRAPH_NO_VERTEX;
+    }
+    if (NULL != p_ctx->p_depth)
+    {
+        for (uint32_t vertex = 0; vertex < num_vertices; vertex++)
+        {
+            p_ctx->p_depth[vertex] = GRAPH_DEPTH_UNREACHED;
+        }
+        p_ctx->p_depth[source] = 0;
+    }
+
+    p_ctx->p_parent[source] = source;
+    p_ctx->p_queue[0]       = source;
+    p_ctx->queue_len        = 1;
+
+    graph_bfs_stats_t stats         = { 0 };
+    uint64_t          edges_to_scan = p_graph->num_edges;
+    uint64_t          scout_count   = graph_out_degree(p_graph, source);
+    bool              b_bottom_up   = (GRAPH_BFS_BOTTOM_UP == mode);
+    bool              b_as_bitmap   = false;
+
+    stats.visited = 1;
+
+    while (0 != p_ctx->queue_len)
+    {
+        // Direction choice for this level
+        if (GRAPH_BFS_AUTO == mode)
+        {
+            if (!b_bottom_up && (scout_count > (edges_to_scan / BFS_ALPHA)))
+            {
+                b_bottom_up = true;
+            }
+            else if (b_bottom_up
+                     && (p_ctx->queue_len < (num_vertices / BFS_BETA)))
+            {
+                b_bottom_up = false;
+            }
+        }
+
+        if (b_bottom_up)
+        {
+            if (!b_as_bitmap)
+            {
+                memset(p_ctx->p_front, 0, p_ctx->num_words * sizeof(uint64_t));
+                graph_runner_run(p_runner, bfs_queue_to_bitmap_task, p_ctx);
+                b_as_bitmap = true;
+            }
+
+            graph_runner_run(p_runner, bfs_bottom_up_task, p_ctx);
+
+            uint64_t * p_swap = p_ctx->p_front;
+            p_ctx->p_front    = p_ctx->p_next;
+            p_ctx->p_next     = p_swap;
+
+            // While in bitmap form queue_len only carries the frontier size
+            p_ctx->queue_len = 0;
+            for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+            {
+                p_ctx->queue_len += p_ctx->p_workers[idx].scout_count;
+            }
+            stats.bottom_up_steps++;
+        }
+        else
+        {
+            if (b_as_bitmap)
+            {
+                graph_runner_run(p_runner, bfs_bitmap_to_queue_task, p_ctx);
+                if (!gather_workers(p_ctx))
+                {
+                    return GRAPH_SEARCH_ERROR_MEMORY;
+                }
+                b_as_bitmap = false;
+                scout_count = 0;
+            }
+
+            edges_to_scan = (edges_to_scan > scout_count)
+                                ? (edges_to_scan - scout_count)
+                                : 0;
+
+            graph_runner_run(p_runner, bfs_top_down_task, p_ctx);
+
+            scout_count = 0;
+            for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+            {
+                scout_count += p_ctx->p_workers[idx].scout_count;
+            }
+
+            if (!gather_workers(p_ctx))
+            {
+                return GRAPH_SEARCH_ERROR_MEMORY;
+            }
+            stats.top_down_steps++;
+        }
+
+        stats.visited += p_ctx->queue_len;
+        p_ctx->level++;
+        if (0 != p_ctx->queue_len)
+        {
+            stats.levels++;
+        }
+    }
+
+    if (NULL != p_stats)
+    {
+        *p_stats = stats;
+    }
+
+    return GRAPH_SEARCH_SUCCESS;
+}
+
+/*!
+ * @brief Bucket loop of graph_sssp_delta once scratch memory is allocated.
+ *
+ * @param[in,out] p_ctx    Delta-stepping state
+ * @param[in]     p_runner Fork-join runner
+ * @param[in]     source   Start vertex
+ *
+ * @return GRAPH_SEARCH_SUCCESS on success, negative error code on failure
+ */
+static int
+sssp_run(sssp_ctx_t * p_ctx, graph_runner_t * p_runner, uint32_t source)
+{
+    for (uint32_t vertex = 0; vertex < p_ctx->p_graph->num_vertices; vertex++)
+    {
+        p_ctx->p_dist[vertex] = GRAPH_DIST_INFINITY;
+    }
+
+    p_ctx->p_dist[source]  = 0;
+    p_ctx->p_frontier[0]   = source;
+    p_ctx->frontier_len    = 1;
+    p_ctx->bin             = 0;
+
+    for (;;)
+    {
+        graph_runner_run(p_runner, sssp_relax_task, p_ctx);
+
+        for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+        {
+            if (p_ctx->p_workers[idx].b_failed)
+            {
+                return GRAPH_SEARCH_ERROR_MEMORY;
+            }
+        }
+
+        if (!sssp_next_bucket(p_ctx))
+        {
+            return GRAPH_SEARCH_SUCCESS;
+        }
+
+        // Gather the chosen bucket from every worker into the frontier
+        size_t needed = 0;
+        for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+        {
+            sssp_worker_t * p_worker = &p_ctx->p_workers[idx];
+            if (p_ctx->bin < p_worker->num_bins)
+            {
+                needed += p_worker->p_bins[p_ctx->bin].len;
+            }
+        }
+
+        if (needed > p_ctx->frontier_cap)
+        {
+            uint32_t * p_new
+                = realloc(p_ctx->p_frontier, needed * sizeof(uint32_t));
+            if (NULL == p_new)
+            {
+                return GRAPH_SEARCH_ERROR_MEMORY;
+            }
+            p_ctx->p_frontier   = p_new;
+            p_ctx->frontier_cap = needed;
+        }
+
+        p_ctx->frontier_len = 0;
+        for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+        {
+            sssp_worker_t * p_worker = &p_ctx->p_workers[idx];
+            if (p_ctx->bin >= p_worker->num_bins)
+            {
+                continue;
+            }
+
+            vertex_vec_t * p_bin = &p_worker->p_bins[p_ctx->bin];
+            if (0 != p_bin->len)
+            {
+                memcpy(&p_ctx->p_frontier[p_ctx->frontier_len],
+                       p_bin->p_items,
+                       p_bin->len * sizeof(uint32_t));
+                p_ctx->frontier_len += p_bin->len;
+                p_bin->len = 0;
+            }
+        }
+    }
+}
+
+/*!
+ * @brief Appends a vertex to a growable vector.
+ *
+ * @param[in,out] p_vec  Vector
+ * @param[in]     vertex Vertex id to append
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+vec_push(vertex_vec_t * p_vec, uint32_t vertex)
+{
+    if (p_vec->len == p_vec->cap)
+    {
+        size_t     new_cap = (0 == p_vec->cap) ? INITIAL_VEC_CAP
+                                               : (2 * p_vec->cap);
+        uint32_t * p_new = realloc(p_vec->p_items, new_cap * sizeof(uint32_t));
+        if (NULL == p_new)
+        {
+            return false;
+        }
+        p_vec->p_items = p_new;
+        p_vec->cap     = new_cap;
+    }
+
+    p_vec->p_items[p_vec->len++] = vertex;
+    return true;
+}
+
+/*!
+ * @brief Computes the [begin, end) range of one part of an even split.
+ *
+ * @param[in]  len     Length being split
+ * @param[in]  parts   Number of parts
+ * @param[in]  part    Part index
+ * @param[out] p_begin First index of the part
+ * @param[out] p_end   One past the last index of the part
+ */
+static void
+slice_bounds(size_t len, uint32_t parts, uint32_t part, size_t * p_begin, size_t * p_end)
+{
+    *p_begin = (len * part) / parts;
+    *p_end   = (len * (part + 1)) / parts;
+}
+
+/*!
+ * @brief Concatenates the workers' discovered vertices into the queue.
+ *
+ * @param[in,out] p_ctx BFS state
+ *
+ * @return true on success, false if a worker failed to allocate
+ */
+static bool
+gather_workers(bfs_ctx_t * p_ctx)
+{
+    p_ctx->queue_len = 0;
+
+    for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+    {
+        bfs_worker_t * p_worker = &p_ctx->p_workers[idx];
+
+        if (p_worker->b_failed)
+        {
+            return false;
+        }
+
+        if (0 != p_worker->next.len)
+        {
+            memcpy(&p_ctx->p_queue[p_ctx->queue_len],
+                   p_worker->next.p_items,
+                   p_worker->next.len * sizeof(uint32_t));
+            p_ctx->queue_len += p_worker->next.len;
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Top-down step: claims unvisited out-neighbours of the frontier.
+ *
+ * A neighbour is claimed by compare-and-swap on its parent slot, so every
+ * vertex is discovered by exactly one worker.
+ *
+ * @param[in,out] p_arg  BFS state
+ * @param[in]     worker Worker index
+ */
+static void
+bfs_top_down_task(void * p_arg, uint32_t worker)
+{
+    bfs_ctx_t *     p_ctx    = (bfs_ctx_t *)p_arg;
+    bfs_worker_t *  p_worker = &p_ctx->p_workers[worker];
+    const graph_t * p_graph  = p_ctx->p_graph;
+    uint32_t        depth    = p_ctx->level + 1;
+    size_t          begin    = 0;
+    size_t          end      = 0;
+
+    p_worker->next.len    = 0;
+    p_worker->scout_count = 0;
+    slice_bounds(p_ctx->queue_len, p_ctx->num_workers, worker, &begin, &end);
+
+    for (size_t idx = begin; idx < end; idx++)
+    {
+        uint32_t vertex = p_ctx->p_queue[idx];
+
+        for (uint64_t edge = p_graph->p_offsets[vertex];
+             edge < p_graph->p_offsets[vertex + 1];
+             edge++)
+        {
+            uint32_t  target   = p_graph->p_targets[edge];
+            uint32_t  expected = GRAPH_NO_VERTEX;
+
+            if ((GRAPH_NO_VERTEX
+                 == __atomic_load_n(&p_ctx->p_parent[target], __ATOMIC_RELAXED))
+                && __atomic_compare_exchange_n(&p_ctx->p_parent[target],
+                                               &expected,
+                                               vertex,
+                                               false,
+                                               __ATOMIC_RELAXED,
+                                               __ATOMIC_RELAXED))
+            {
+                if (NULL != p_ctx->p_depth)
+                {
+                    p_ctx->p_depth[target] = depth;
+                }
+                if (!vec_push(&p_worker->next, target))
+                {
+                    p_worker->b_failed = true;
+                    return;
+                }
+                p_worker->scout_count += graph_out_degree(p_graph, target);
+            }
+        }
+    }
+}
+
+/*!
+ * @brief Bottom-up step: every unvisited vertex looks for a frontier parent.
+ *
+ * Worker slices are whole bitmap words, so each worker writes its own words
+ * of the next bitmap without atomics. scout_count receives the number of
+ * vertices found.
+ *
+ * @param[in,out] p_arg  BFS state
+ * @param[in]     worker Worker index
+ */
+static void
+bfs_bottom_up_task(void * p_arg, uint32_t worker)
+{
+    bfs_ctx_t *     p_ctx    = (bfs_ctx_t *)p_arg;
+    bfs_worker_t *  p_worker = &p_ctx->p_workers[worker];
+    const graph_t * p_graph  = p_ctx->p_graph;
+    uint32_t        depth    = p_ctx->level + 1;
+    size_t          begin    = 0;
+    size_t          end      = 0;
+    uint64_t        found    = 0;
+
+    slice_bounds(p_ctx->num_words, p_ctx->num_workers, worker, &begin, &end);
+
+    for (size_t word = begin; word < end; word++)
+    {
+        uint64_t bits  = 0;
+        uint32_t first = (uint32_t)(word * BITS_PER_WORD);
+        uint32_t last  = first + BITS_PER_WORD;
+
+        if (last > p_graph->num_vertices)
+        {
+            last = p_graph->num_vertices;
+        }
+
+        for (uint32_t vertex = first; vertex < last; vertex++)
+        {
+            if (GRAPH_NO_VERTEX != p_ctx->p_parent[vertex])
+            {
+                continue;
+            }
+
+            for (uint64_t edge = p_graph->p_in_offsets[vertex];
+                 edge < p_graph->p_in_offsets[vertex + 1];
+                 edge++)
+            {
+                uint32_t source = p_graph->p_in_sources[edge];
+
+                if (0 != (p_ctx->p_front[source / BITS_PER_WORD]
+                          & (1ull << (source % BITS_PER_WORD))))
+                {
+                    p_ctx->p_parent[vertex] = source;
+                    if (NULL != p_ctx->p_depth)
+                    {
+                        p_ctx->p_depth[vertex] = depth;
+                    }
+                    bits |= 1ull << (vertex - first);
+                    found++;
+                    break;
+                }
+            }
+        }
+
+        p_ctx->p_next[word] = bits;
+    }
+
+    p_worker->scout_count = found;
+}
+
+/*!
+ * @brief Sets the frontier bitmap bits of one slice of the frontier queue.
+ *
+ * @param[in,out] p_arg  BFS state
+ * @param[in]     worker Worker index
+ */
+static void
+bfs_queue_to_bitmap_task(void * p_arg, uint32_t worker)
+{
+    bfs_ctx_t * p_ctx = (bfs_ctx_t *)p_arg;
+    size_t      begin = 0;
+    size_t      end   = 0;
+
+    slice_bounds(p_ctx->queue_len, p_ctx->num_workers, worker, &begin, &end);
+
+    for (size_t idx = begin; idx < end; idx++)
+    {
+        uint32_t vertex = p_ctx->p_queue[idx];
+        __atomic_fetch_or(&p_ctx->p_front[vertex / BITS_PER_WORD],
+                          1ull << (vertex % BITS_PER_WORD),
+                          __ATOMIC_RELAXED);
+    }
+}
+
+/*!
+ * @brief Collects the set bits of one slice of the frontier bitmap.
+ *
+ * @param[in,out] p_arg  BFS state
+ * @param[in]     worker Worker index
+ */
+static void
+bfs_bitmap_to_queue_task(void * p_arg, uint32_t worker)
+{
+    bfs_ctx_t *    p_ctx    = (bfs_ctx_t *)p_arg;
+    bfs_worker_t * p_worker = &p_ctx->p_workers[worker];
+    size_t         begin    = 0;
+    size_t         end      = 0;
+
+    p_worker->next.len = 0;
+    slice_bounds(p_ctx->num_words, p_ctx->num_workers, worker, &begin, &end);
+
+    for (size_t word = begin; word < end; word++)
+    {
+        uint64_t bits = p_ctx->p_front[word];
+
+        while (0 != bits)
+        {
+            uint32_t vertex = (uint32_t)((word * BITS_PER_WORD)
+                                         + (uint32_t)__builtin_ctzll(bits));
+            if (!vec_push(&p_worker->next, vertex))
+            {
+                p_worker->b_failed = true;
+                return;
+            }
+            bits &= bits - 1;
+        }
+    }
+}
+
+/*!
+ * @brief Relaxes the out-edges of one slice of the current bucket.
+ *
+ * Distances are lowered with an atomic compare-and-swap loop; a vertex
+ * whose distance was lowered is queued in the worker's bucket for its new
+ * distance. Entries whose distance already dropped below the current
+ * bucket were settled earlier and are skipped.
+ *
+ * @param[in,out] p_arg  Delta-stepping state
+ * @param[in]     worker Worker index
+ */
+static void
+sssp_relax_task(void * p_arg, uint32_t worker)
+{
+    sssp_ctx_t *    p_ctx    = (sssp_ctx_t *)p_arg;
+    sssp_worker_t * p_worker = &p_ctx->p_workers[worker];
+    const graph_t * p_graph  = p_ctx->p_graph;
+    uint64_t        floor    = p_ctx->bin * p_ctx->delta;
+    size_t          begin    = 0;
+    size_t          end      = 0;
+
+    slice_bounds(p_ctx->frontier_len, p_ctx->num_workers, worker, &begin, &end);
+
+    for (size_t idx = begin; idx < end; idx++)
+    {
+        uint32_t vertex = p_ctx->p_frontier[idx];
+        uint64_t dist
+            = __atomic_load_n(&p_ctx->p_dist[vertex], __ATOMIC_RELAXED);
+
+        if (dist < floor)
+        {
+            continue;
+        }
+
+        for (uint64_t edge = p_graph->p_offsets[vertex];
+             edge < p_graph->p_offsets[vertex + 1];
+             edge++)
+        {
+            uint32_t target   = p_graph->p_targets[edge];
+            uint64_t new_dist = dist + p_graph->p_weights[edge];
+            uint64_t old_dist
+                = __atomic_load_n(&p_ctx->p_dist[target], __ATOMIC_RELAXED);
+
+            while (new_dist < old_dist)
+            {
+                if (__atomic_compare_exchange_n(&p_ctx->p_dist[target],
+                                                &old_dist,
+                                                new_dist,
+                                                true,
+                                                __ATOMIC_RELAXED,
+                                                __ATOMIC_RELAXED))
+                {
+                    uint64_t bin = new_dist / p_ctx->delta;
+
+                    if (bin >= p_worker->num_bins)
+                    {
+                        size_t new_count = 2 * p_worker->num_bins;
+                        if (new_count <= bin)
+                        {
+                            new_count = (size_t)bin + 1;
+                        }
+                        vertex_vec_t * p_new     = realloc(
+                            p_worker->p_bins, new_count * sizeof(vertex_vec_t));
+                        if (NULL == p_new)
+                        {
+                            p_worker->b_failed = true;
+                            return;
+                        }
+                        memset(&p_new[p_worker->num_bins],
+                               0,
+                               (new_count - p_worker->num_bins)
+                                   * sizeof(vertex_vec_t));
+                        p_worker->p_bins   = p_new;
+                        p_worker->num_bins = new_count;
+                    }
+
+                    if (!vec_push(&p_worker->p_bins[bin], target))
+                    {
+                        p_worker->b_failed = true;
+                        return;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * @brief Advances p_ctx->bin to the lowest bucket any worker still holds.
+ *
+ * @param[in,out] p_ctx Delta-stepping state
+ *
+ * @return true if a non-empty bucket was found, false when done
+ */
+static bool
+sssp_next_bucket(sssp_ctx_t * p_ctx)
+{
+    size_t max_bins = 0;
+
+    for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+    {
+        if (p_ctx->p_workers[idx].num_bins > max_bins)
+        {
+            max_bins = p_ctx->p_workers[idx].num_bins;
+        }
+    }
+
+    for (uint64_t bin = p_ctx->bin; bin < max_bins; bin++)
+    {
+        for (uint32_t idx = 0; idx < p_ctx->num_workers; idx++)
+        {
+            sssp_worker_t * p_worker = &p_ctx->p_workers[idx];
+
+            if ((bin < p_worker->num_bins) && (0 != p_worker->p_bins[bin].len))
+            {
+                p_ctx->bin = bin;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*** end of file ***/
@@ -0,0 +1,120 @@
+/** @file graph_search.h
+ *
+ * @brief Parallel breadth-first search and single-source shortest paths.
+ *
+ * Both searches split each step across num_workers tasks submitted to a
+ * thread pool; the calling thread runs one of the tasks itself and waits
+ * for the rest before the next step. With a NULL pool or one worker the
+ * searches run serially on the caller.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef GRAPH_SEARCH_H
+#define GRAPH_SEARCH_H
+
+#include <stdint.h>
+#include "graph.h"
+#include "../Thread_Pool/thread_pool.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define GRAPH_SEARCH_SUCCESS      (0)
+#define GRAPH_SEARCH_ERROR_PARAM  (-1)
+#define GRAPH_SEARCH_ERROR_MEMORY (-2)
+
+#define GRAPH_SEARCH_MAX_WORKERS  (64)
+#define GRAPH_DIST_INFINITY       (UINT64_MAX)
+#define GRAPH_DEPTH_UNREACHED     (UINT32_MAX)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Frontier expansion strategy for graph_bfs */
+typedef enum
+{
+    GRAPH_BFS_AUTO = 0,    /* Direction-optimizing: switch by frontier size */
+    GRAPH_BFS_TOP_DOWN,    /* Always expand out-edges of the frontier */
+    GRAPH_BFS_BOTTOM_UP    /* Always scan in-edges of unvisited vertices */
+} graph_bfs_mode_t;
+
+/* Counters filled in by graph_bfs */
+typedef struct
+{
+    uint32_t levels;          /* Number of BFS levels expanded */
+    uint32_t top_down_steps;  /* Levels expanded top-down */
+    uint32_t bottom_up_steps; /* Levels expanded bottom-up */
+    uint64_t visited;         /* Vertices reached, including the source */
+} graph_bfs_stats_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Breadth-first search from one source vertex.
+ *
+ * In GRAPH_BFS_AUTO mode a level is expanded bottom-up once the edges
+ * leaving the frontier exceed 1/14 of the edges still unexplored, and
+ * top-down again once the frontier shrinks below 1/24 of the vertices
+ * (Beamer et al.).
+ *
+ * @param[in]  p_graph     Graph to search
+ * @param[in]  source      Start vertex
+ * @param[in]  mode        Frontier expansion strategy
+ * @param[in]  p_pool      Thread pool for the workers (NULL runs serially)
+ * @param[in]  num_workers Tasks per step (1..GRAPH_SEARCH_MAX_WORKERS)
+ * @param[out] p_parent    num_vertices entries; BFS tree parent of every
+ *                         reached vertex (the source is its own parent),
+ *                         GRAPH_NO_VERTEX otherwise
+ * @param[out] p_depth     Optional num_vertices entries; hop count from the
+ *                         source or GRAPH_DEPTH_UNREACHED
+ * @param[out] p_stats     Optional search counters
+ *
+ * @return GRAPH_SEARCH_SUCCESS on success, negative error code on failure
+ */
+int
+graph_bfs(const graph_t *     p_graph,
+          uint32_t            source,
+          graph_bfs_mode_t    mode,
+          thread_pool_t *     p_pool,
+          uint32_t            num_workers,
+          uint32_t *          p_parent,
+          uint32_t *          p_depth,
+          graph_bfs_stats_t * p_stats);
+
+/*!
+ * @brief Delta-stepping single-source shortest paths.
+ *
+ * Tentative distances are grouped into buckets of width delta. All
+ * vertices of the lowest non-empty bucket are relaxed in parallel, with
+ * distance updates done by atomic compare-and-swap, until the bucket stays
+ * empty; then the next bucket is processed. A delta close to the average
+ * edge weight is a good start; delta = 1 degenerates to Dijkstra order and
+ * a very large delta to Bellman-Ford.
+ *
+ * @param[in]  p_graph     Graph to search (weights must be non-negative)
+ * @param[in]  source      Start vertex
+ * @param[in]  delta       Bucket width (must be > 0)
+ * @param[in]  p_pool      Thread pool for the workers (NULL runs serially)
+ * @param[in]  num_workers Tasks per step (1..GRAPH_SEARCH_MAX_WORKERS)
+ * @param[out] p_dist      num_vertices entries; shortest distance from the
+ *                         source or GRAPH_DIST_INFINITY
+ *
+ * @return GRAPH_SEARCH_SUCCESS on success, negative error code on failure
+ */
+int
+graph_sssp_delta(const graph_t * p_graph,
+                 uint32_t        source,
+                 uint32_t        delta,
+                 thread_pool_t * p_pool,
+                 uint32_t        num_workers,
+                 uint64_t *      p_dist);
+
+#endif /* GRAPH_SEARCH_H */
+
+/*** end of file ***/
@@ -0,0 +1,789 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "graph.h"
+#include "graph_ch.h"
+#include "graph_dense.h"
+#include "graph_search.h"
+#include "td_graph.h"
+
+#define TEST_WORKERS (4)
+
+// Serial reference BFS depths
+static void
+reference_bfs(const graph_t * p_graph, uint32_t source, uint32_t * p_depth)
+{
+    uint32_t * p_queue = malloc(p_graph->num_vertices * sizeof(uint32_t));
+    size_t     head    = 0;
+    size_t     tail    = 0;
+
+    for (uint32_t idx = 0; idx < p_graph->num_vertices; idx++)
+    {
+        p_depth[idx] = GRAPH_DEPTH_UNREACHED;
+    }
+
+    p_depth[source]  = 0;
+    p_queue[tail++]  = source;
+
+    while (head < tail)
+    {
+        uint32_t vertex = p_queue[head++];
+        for (uint64_t edge = p_graph->p_offsets[vertex];
+             edge < p_graph->p_offsets[vertex + 1];
+             edge++)
+        {
+            uint32_t target = p_graph->p_targets[edge];
+            if (GRAPH_DEPTH_UNREACHED == p_depth[target])
+            {
+                p_depth[target] = p_depth[vertex] + 1;
+                p_queue[tail++] = target;
+            }
+        }
+    }
+
+    free(p_queue);
+}
+
+// Serial reference Dijkstra with an O(V^2) scan, fine for test sizes
+static void
+reference_dijkstra(const graph_t * p_graph, uint32_t source, uint64_t * p_dist)
+{
+    bool * p_done = calloc(p_graph->num_vertices, sizeof(bool));
+
+    for (uint32_t idx = 0; idx < p_graph->num_vertices; idx++)
+    {
+        p_dist[idx] = GRAPH_DIST_INFINITY;
+    }
+    p_dist[source] = 0;
+
+    for (;;)
+    {
+        uint32_t best = GRAPH_NO_VERTEX;
+        for (uint32_t idx = 0; idx < p_graph->num_vertices; idx++)
+        {
+            if (!p_done[idx] && (GRAPH_DIST_INFINITY != p_dist[idx])
+                && ((GRAPH_NO_VERTEX == best) || (p_dist[idx] < p_dist[best])))
+            {
+                best = idx;
+            }
+        }
+
+        if (GRAPH_NO_VERTEX == best)
+        {
+            break;
+        }
+
+        p_done[best] = true;
+        for (uint64_t edge = p_graph->p_offsets[best];
+             edge < p_graph->p_offsets[best + 1];
+             edge++)
+        {
+            uint32_t target = p_graph->p_targets[edge];
+            uint64_t cand   = p_dist[best] + p_graph->p_weights[edge];
+            if (cand < p_dist[target])
+            {
+                p_dist[target] = cand;
+            }
+        }
+    }
+
+    free(p_done);
+}
+
+// Brute-force earliest arrival: tries every departure minute of the next
+// day on each edge instead of trusting the precomputed waiting times
+static void
+reference_td(const td_graph_t * p_graph,
+             uint32_t           source,
+             uint32_t           depart,
+             uint32_t *         p_arrival)
+{
+    bool * p_done = calloc(p_graph->num_vertices, sizeof(bool));
+
+    for (uint32_t idx = 0; idx < p_graph->num_vertices; idx++)
+    {
+        p_arrival[idx] = TD_INFINITY;
+    }
+    p_arrival[source] = depart;
+
+    for (;;)
+    {
+        uint32_t best = TD_NO_VERTEX;
+        for (uint32_t idx = 0; idx < p_graph->num_vertices; idx++)
+        {
+            if (!p_done[idx] && (TD_INFINITY != p_arrival[idx])
+                && ((TD_NO_VERTEX == best)
+                    || (p_arrival[idx] < p_arrival[best])))
+            {
+                best = idx;
+            }
+        }
+
+        if (TD_NO_VERTEX == best)
+        {
+            break;
+        }
+
+        p_done[best] = true;
+        for (uint32_t edge = p_graph->p_offsets[best];
+             edge < p_graph->p_offsets[best + 1];
+             edge++)
+        {
+            uint32_t target = p_graph->p_targets[edge];
+            for (uint32_t leave = p_arrival[best];
+                 leave <= (p_arrival[best] + TD_MINUTES_PER_DAY);
+                 leave++)
+            {
+                uint32_t minute = leave % TD_MINUTES_PER_DAY;
+                uint32_t bucket = p_graph->num_buckets - 1;
+                for (uint32_t idx = 0; idx < p_graph->num_buckets; idx++)
+                {
+                    if (p_graph->p_bucket_start[idx] <= minute)
+                    {
+                        bucket = idx;
+                    }
+                }
+
+                uint32_t travel
+                    = p_graph->p_weights[(edge * p_graph->num_buckets) + bucket]
+                          .travel;
+                if ((TD_INFINITY != travel)
+                    && ((leave + travel) < p_arrival[target]))
+                {
+                    p_arrival[target] = leave + travel;
+                }
+            }
+        }
+    }
+
+    free(p_done);
+}
+
+// Writes a random city in the traffic_routes.json shape
+static char *
+random_city_json(uint32_t num_streets, uint32_t seed)
+{
+    static const char * periods[] = { "0500", "0800", "1700", "2400" };
+    size_t               cap      = 1 << 20;
+    char *               p_text   = malloc(cap);
+    size_t               len      = 0;
+
+    srand(seed);
+    len += (size_t)snprintf(p_text + len, cap - len, "{");
+    for (uint32_t period = 0; period < 4; period++)
+    {
+        len += (size_t)snprintf(p_text + len, cap - len, "%s\"%s\": {",
+                                (0 == period) ? "" : ",", periods[period]);
+        for (uint32_t from = 0; from < num_streets; from++)
+        {
+            len += (size_t)snprintf(p_text + len, cap - len,
+                                    "%s\"S%u\": {", (0 == from) ? "" : ",",
+                                    from);
+            bool b_first = true;
+            for (uint32_t to = 0; to < num_streets; to++)
+            {
+                // Sparse, and some roads close for a period
+                if ((to != from) && (0 == (rand() % 6)))
+                {
+                    len += (size_t)snprintf(p_text + len, cap - len,
+                                            "%s\"S%u\": %d",
+                                            b_first ? "" : ", ", to,
+                                            1 + (rand() % 300));
+                    b_first = false;
+                }
+            }
+            len += (size_t)snprintf(p_text + len, cap - len, "}");
+        }
+        len += (size_t)snprintf(p_text + len, cap - len, "}");
+    }
+    snprintf(p_text + len, cap - len, "}");
+
+    return p_text;
+}
+
+START_TEST(test_create_csr)
+{
+    graph_edge_t edges[] = { { 0, 1, 5 }, { 0, 2, 3 }, { 2, 1, 1 } };
+    graph_t *    p_graph = graph_create(3, edges, 3, false);
+
+    ck_assert_ptr_nonnull(p_graph);
+    ck_assert_uint_eq(p_graph->num_edges, 3);
+    ck_assert_uint_eq(graph_out_degree(p_graph, 0), 2);
+    ck_assert_uint_eq(graph_out_degree(p_graph, 1), 0);
+    ck_assert_uint_eq(p_graph->p_in_offsets[2] - p_graph->p_in_offsets[1], 2);
+
+    graph_destroy(&p_graph);
+    ck_assert_ptr_null(p_graph);
+}
+END_TEST
+
+START_TEST(test_create_rejects_bad_vertex)
+{
+    graph_edge_t edges[] = { { 0, 7, 1 } };
+
+    ck_assert_ptr_null(graph_create(3, edges, 1, true));
+    ck_assert_ptr_null(graph_create(0, NULL, 0, true));
+}
+END_TEST
+
+START_TEST(test_bfs_modes_match_reference)
+{
+    graph_t *       p_graph = graph_generate_rmat(12, 8, 0, 42, true);
+    thread_pool_t * p_pool  = thread_pool_initialize(TEST_WORKERS);
+    ck_assert_ptr_nonnull(p_graph);
+    ck_assert_ptr_nonnull(p_pool);
+
+    uint32_t   num    = p_graph->num_vertices;
+    uint32_t * p_ref  = malloc(num * sizeof(uint32_t));
+    uint32_t * p_dep  = malloc(num * sizeof(uint32_t));
+    uint32_t * p_par  = malloc(num * sizeof(uint32_t));
+    uint32_t   source = 0;
+
+    while (0 == graph_out_degree(p_graph, source))
+    {
+        source++;
+    }
+    reference_bfs(p_graph, source, p_ref);
+
+    graph_bfs_mode_t modes[]
+        = { GRAPH_BFS_AUTO, GRAPH_BFS_TOP_DOWN, GRAPH_BFS_BOTTOM_UP };
+
+    for (size_t mode = 0; mode < 3; mode++)
+    {
+        graph_bfs_stats_t stats = { 0 };
+        ck_assert_int_eq(graph_bfs(p_graph, source, modes[mode], p_pool,
+                                   TEST_WORKERS, p_par, p_dep, &stats),
+                         GRAPH_SEARCH_SUCCESS);
+        ck_assert_mem_eq(p_ref, p_dep, num * sizeof(uint32_t));
+
+        // Every parent must sit exactly one level above its child
+        for (uint32_t vertex = 0; vertex < num; vertex++)
+        {
+            if ((vertex != source) && (GRAPH_NO_VERTEX != p_par[vertex]))
+            {
+                ck_assert_uint_eq(p_dep[p_par[vertex]] + 1, p_dep[vertex]);
+            }
+        }
+    }
+
+    free(p_par);
+    free(p_dep);
+    free(p_ref);
+    thread_pool_shutdown(p_pool);
+    thread_pool_destroy(p_pool);
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_bfs_directed_uses_in_edges)
+{
+    graph_edge_t edges[] = { { 0, 1, 1 }, { 1, 2, 1 }, { 3, 0, 1 } };
+    graph_t *    p_graph = graph_create(4, edges, 3, false);
+    uint32_t     parent[4];
+    uint32_t     depth[4];
+
+    ck_assert_int_eq(graph_bfs(p_graph, 0, GRAPH_BFS_BOTTOM_UP, NULL, 1,
+                               parent, depth, NULL),
+                     GRAPH_SEARCH_SUCCESS);
+    ck_assert_uint_eq(depth[2], 2);
+    ck_assert_uint_eq(parent[2], 1);
+    ck_assert_uint_eq(depth[3], GRAPH_DEPTH_UNREACHED);
+    ck_assert_uint_eq(parent[3], GRAPH_NO_VERTEX);
+
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_sssp_matches_dijkstra)
+{
+    graph_t *       p_graph = graph_generate_rmat(10, 8, 100, 7, false);
+    thread_pool_t * p_pool  = thread_pool_initialize(TEST_WORKERS);
+    ck_assert_ptr_nonnull(p_graph);
+
+    uint32_t   num   = p_graph->num_vertices;
+    uint64_t * p_ref = malloc(num * sizeof(uint64_t));
+    uint64_t * p_got = malloc(num * sizeof(uint64_t));
+
+    reference_dijkstra(p_graph, 3, p_ref);
+
+    uint32_t deltas[] = { 1, 16, 1000000 };
+    for (size_t idx = 0; idx < 3; idx++)
+    {
+        ck_assert_int_eq(graph_sssp_delta(p_graph, 3, deltas[idx], p_pool,
+                                          TEST_WORKERS, p_got),
+                         GRAPH_SEARCH_SUCCESS);
+        ck_assert_mem_eq(p_ref, p_got, num * sizeof(uint64_t));
+    }
+
+    free(p_got);
+    free(p_ref);
+    thread_pool_shutdown(p_pool);
+    thread_pool_destroy(p_pool);
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_search_rejects_bad_params)
+{
+    graph_edge_t edges[] = { { 0, 1, 1 } };
+    graph_t *    p_graph = graph_create(2, edges, 1, true);
+    uint32_t     parent[2];
+    uint64_t     dist[2];
+
+    ck_assert_int_eq(graph_bfs(p_graph, 5, GRAPH_BFS_AUTO, NULL, 1, parent,
+                               NULL, NULL),
+                     GRAPH_SEARCH_ERROR_PARAM);
+    ck_assert_int_eq(graph_sssp_delta(p_graph, 0, 0, NULL, 1, dist),
+                     GRAPH_SEARCH_ERROR_PARAM);
+    ck_assert_int_eq(graph_sssp_delta(p_graph, 0, 1, NULL, 0, dist),
+                     GRAPH_SEARCH_ERROR_PARAM);
+
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_td_parse_buckets_and_names)
+{
+    const char * p_json
+        = "{ \"2400\": { \"Snake Loop\": { \"Debug \\u0044rive\": 7 } },"
+          "  \"0800\": { \"Snake Loop\": { \"Debug Drive\": 20.4 },"
+          "              \"Debug Drive\": { } } }";
+    td_graph_t * p_graph = td_graph_parse(p_json, strlen(p_json));
+
+    ck_assert_ptr_nonnull(p_graph);
+    ck_assert_uint_eq(p_graph->num_vertices, 2);
+    ck_assert_uint_eq(p_graph->num_edges, 1);
+    ck_assert_uint_eq(p_graph->num_buckets, 2);
+    ck_assert_uint_eq(p_graph->p_bucket_start[0], 0);
+    ck_assert_uint_eq(p_graph->p_bucket_start[1], 480);
+
+    uint32_t from = td_graph_find(p_graph, "Snake Loop");
+    uint32_t to   = td_graph_find(p_graph, "Debug Drive");
+    ck_assert_uint_ne(from, TD_NO_VERTEX);
+    ck_assert_uint_ne(to, TD_NO_VERTEX);
+    ck_assert_uint_eq(td_graph_find(p_graph, "Nowhere"), TD_NO_VERTEX);
+    ck_assert_str_eq(td_graph_name(p_graph, to), "Debug Drive");
+    ck_assert_uint_eq(p_graph->p_weights[0].travel, 7);
+    ck_assert_uint_eq(p_graph->p_weights[1].travel, 20);
+
+    td_graph_destroy(&p_graph);
+    ck_assert_ptr_null(p_graph);
+}
+END_TEST
+
+START_TEST(test_td_waits_for_faster_bucket)
+{
+    const char * p_json
+        = "{ \"0500\": { \"A\": { \"B\": 60 }, \"B\": { \"C\": 1 } },"
+          "  \"0600\": { \"A\": { \"B\": 5 } } }";
+    td_graph_t *     p_graph = td_graph_parse(p_json, strlen(p_json));
+    td_workspace_t * p_work  = td_workspace_create(p_graph);
+    uint32_t         arrival = 0;
+    uint32_t         path[3];
+
+    ck_assert_ptr_nonnull(p_work);
+
+    // Leaving at 05:59 takes an hour; waiting a minute takes five
+    ck_assert_int_eq(td_earliest_arrival(p_graph, p_work, 0, 1, 359,
+                                         &arrival),
+                     TD_GRAPH_SUCCESS);
+    ck_assert_uint_eq(arrival, 365);
+
+    // B -> C is closed after 06:00 and reopens at 05:00 the next day
+    ck_assert_int_eq(td_earliest_arrival(p_graph, p_work, 0, 2, 359,
+                                         &arrival),
+                     TD_GRAPH_SUCCESS);
+    ck_assert_uint_eq(arrival, 1440 + 300 + 1);
+    ck_assert_uint_eq(td_workspace_path(p_work, path, 3), 3);
+    ck_assert_uint_eq(path[0], 0);
+    ck_assert_uint_eq(path[1], 1);
+    ck_assert_uint_eq(path[2], 2);
+
+    ck_assert_int_eq(td_earliest_arrival(p_graph, p_work, 2, 0, 0, &arrival),
+                     TD_GRAPH_SUCCESS);
+    ck_assert_uint_eq(arrival, TD_INFINITY);
+    ck_assert_uint_eq(td_workspace_path(p_work, path, 3), 0);
+
+    td_workspace_destroy(&p_work);
+    td_graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_td_matches_reference)
+{
+    char *           p_json  = random_city_json(40, 11);
+    td_graph_t *     p_graph = td_graph_parse(p_json, strlen(p_json));
+    td_workspace_t * p_work  = td_workspace_create(p_graph);
+    ck_assert_ptr_nonnull(p_graph);
+    ck_assert_ptr_nonnull(p_work);
+
+    uint32_t   num   = p_graph->num_vertices;
+    uint32_t * p_ref = malloc(num * sizeof(uint32_t));
+    uint32_t   departs[] = { 0, 299, 300, 479, 1000, 1439 };
+
+    for (uint32_t source = 0; source < num; source += 7)
+    {
+        for (size_t idx = 0; idx < 6; idx++)
+        {
+            reference_td(p_graph, source, departs[idx], p_ref);
+            for (uint32_t target = 0; target < num; target++)
+            {
+                uint32_t arrival = 0;
+                ck_assert_int_eq(td_earliest_arrival(p_graph, p_work, source,
+                                                     target, departs[idx],
+                                                     &arrival),
+                                 TD_GRAPH_SUCCESS);
+                ck_assert_uint_eq(arrival, p_ref[target]);
+            }
+        }
+    }
+
+    free(p_ref);
+    free(p_json);
+    td_workspace_destroy(&p_work);
+    td_graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_td_batch_matches_single)
+{
+    char *           p_json  = random_city_json(60, 5);
+    td_graph_t *     p_graph = td_graph_parse(p_json, strlen(p_json));
+    td_workspace_t * p_work  = td_workspace_create(p_graph);
+    thread_pool_t *  p_pool  = thread_pool_initialize(TEST_WORKERS);
+    td_query_t *     queries = malloc(500 * sizeof(td_query_t));
+
+    for (uint32_t idx = 0; idx < 500; idx++)
+    {
+        queries[idx].source = (idx * 7) % p_graph->num_vertices;
+        queries[idx].target = (idx * 13) % p_graph->num_vertices;
+        queries[idx].depart = (idx * 37) % TD_MINUTES_PER_DAY;
+    }
+
+    ck_assert_int_eq(td_batch(p_graph, p_pool, TEST_WORKERS, queries, 500),
+                     TD_GRAPH_SUCCESS);
+
+    for (uint32_t idx = 0; idx < 500; idx++)
+    {
+        uint32_t arrival = 0;
+        td_earliest_arrival(p_graph, p_work, queries[idx].source,
+                            queries[idx].target, queries[idx].depart,
+                            &arrival);
+        ck_assert_uint_eq(queries[idx].arrival, arrival);
+    }
+
+    ck_assert_int_eq(td_batch(p_graph, p_pool, 0, queries, 500),
+                     TD_GRAPH_ERROR_PARAM);
+
+    free(queries);
+    free(p_json);
+    thread_pool_shutdown(p_pool);
+    thread_pool_destroy(p_pool);
+    td_workspace_destroy(&p_work);
+    td_graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_td_parse_rejects_bad_input)
+{
+    const char * bad[] = {
+        "{ \"0860\": { } }",
+        "{ \"2401\": { } }",
+        "{ \"800\": { } }",
+        "{ \"0800\": { \"A\": { \"B\": -1 } } }",
+        "{ \"0800\": { \"A\": { \"B\": 1 } } } x",
+        "{ \"0800\": { \"A\": { \"B\": 1 }",
+        "{ \"0800\": { \"A\": { \"B\": { } } } }",
+        "[ ]",
+    };
+
+    for (size_t idx = 0; idx < (sizeof(bad) / sizeof(bad[0])); idx++)
+    {
+        ck_assert_ptr_null(td_graph_parse(bad[idx], strlen(bad[idx])));
+    }
+
+    ck_assert_ptr_null(td_graph_load("/nonexistent/traffic_routes.json"));
+}
+END_TEST
+
+// Compares CH distances from a few sources with the reference Dijkstra
+static void
+check_ch_against_dijkstra(const graph_t * p_graph, const graph_ch_t * p_ch)
+{
+    uint32_t           num     = p_graph->num_vertices;
+    uint64_t *         p_ref   = malloc(num * sizeof(uint64_t));
+    graph_ch_query_t * p_query = graph_ch_query_create(p_ch);
+
+    ck_assert_ptr_nonnull(p_query);
+    ck_assert_uint_eq(graph_ch_vertices(p_ch), num);
+
+    for (uint32_t source = 0; source < num; source += (num / 7) + 1)
+    {
+        reference_dijkstra(p_graph, source, p_ref);
+        for (uint32_t target = 0; target < num; target++)
+        {
+            uint64_t expect = (GRAPH_DIST_INFINITY == p_ref[target])
+                                  ? GRAPH_CH_INFINITY
+                                  : p_ref[target];
+            ck_assert_uint_eq(graph_ch_distance(p_ch, p_query, source, target),
+                              expect);
+        }
+    }
+
+    graph_ch_query_destroy(&p_query);
+    free(p_ref);
+}
+
+START_TEST(test_ch_road_matches_dijkstra)
+{
+    graph_t *        p_graph = graph_generate_road(24, 20, 40, 3);
+    graph_ch_stats_t stats   = { 0 };
+    ck_assert_ptr_nonnull(p_graph);
+
+    graph_ch_t * p_ch = graph_ch_build(p_graph, &stats);
+    ck_assert_ptr_nonnull(p_ch);
+    ck_assert_uint_gt(stats.shortcuts, 0);
+    ck_assert_uint_gt(graph_ch_size(p_ch), 0);
+
+    check_ch_against_dijkstra(p_graph, p_ch);
+
+    graph_ch_destroy(&p_ch);
+    ck_assert_ptr_null(p_ch);
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_ch_directed_matches_dijkstra)
+{
+    graph_t *    p_graph = graph_generate_rmat(9, 4, 50, 21, false);
+    graph_ch_t * p_ch    = graph_ch_build(p_graph, NULL);
+    ck_assert_ptr_nonnull(p_ch);
+
+    check_ch_against_dijkstra(p_graph, p_ch);
+
+    graph_ch_destroy(&p_ch);
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_ch_save_and_map)
+{
+    char         path[]  = "/tmp/graph_ch_XXXXXX";
+    int          fd      = mkstemp(path);
+    graph_t *    p_graph = graph_generate_road(16, 16, 20, 9);
+    graph_ch_t * p_ch    = graph_ch_build(p_graph, NULL);
+
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+    ck_assert_int_eq(graph_ch_save(p_ch, path), GRAPH_CH_SUCCESS);
+
+    graph_ch_t * p_mapped = graph_ch_open(path);
+    ck_assert_ptr_nonnull(p_mapped);
+    ck_assert_uint_eq(graph_ch_size(p_mapped), graph_ch_size(p_ch));
+    check_ch_against_dijkstra(p_graph, p_mapped);
+    graph_ch_destroy(&p_mapped);
+
+    // A truncated file must be refused
+    ck_assert_int_eq(truncate(path, (off_t)graph_ch_size(p_ch) - 4), 0);
+    ck_assert_ptr_null(graph_ch_open(path));
+    ck_assert_ptr_null(graph_ch_open("/nonexistent/graph.ch"));
+    ck_assert_int_eq(graph_ch_save(NULL, path), GRAPH_CH_ERROR_PARAM);
+
+    unlink(path);
+    graph_ch_destroy(&p_ch);
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_dense_edges)
+{
+    graph_dense_t * p_dense = graph_dense_create(130, true);
+    ck_assert_ptr_nonnull(p_dense);
+    ck_assert_uint_eq(p_dense->row_words % 8, 0);
+
+    // Vertex 129 lives in the third word of a row
+    ck_assert_int_eq(graph_dense_add_edge(p_dense, 0, 129),
+                     GRAPH_DENSE_SUCCESS);
+    ck_assert_int_eq(graph_dense_add_edge(p_dense, 0, 64),
+                     GRAPH_DENSE_SUCCESS);
+    ck_assert_int_eq(graph_dense_add_edge(p_dense, 64, 129),
+                     GRAPH_DENSE_SUCCESS);
+    ck_assert(graph_dense_has_edge(p_dense, 129, 0));
+    ck_assert_uint_eq(graph_dense_degree(p_dense, 0), 2);
+    ck_assert_uint_eq(graph_dense_common(p_dense, 0, 64), 1);
+    ck_assert_uint_eq(graph_dense_triangles(p_dense), 1);
+
+    ck_assert_int_eq(graph_dense_remove_edge(p_dense, 129, 0),
+                     GRAPH_DENSE_SUCCESS);
+    ck_assert(!graph_dense_has_edge(p_dense, 0, 129));
+    ck_assert_uint_eq(graph_dense_triangles(p_dense), 0);
+
+    ck_assert_int_eq(graph_dense_add_edge(p_dense, 0, 130),
+                     GRAPH_DENSE_ERROR_PARAM);
+    ck_assert_int_eq(graph_dense_bfs(p_dense, 130, NULL),
+                     GRAPH_DENSE_ERROR_PARAM);
+    ck_assert_ptr_null(graph_dense_create(0, true));
+    ck_assert_ptr_null(
+        graph_dense_create(GRAPH_DENSE_MAX_VERTICES + 1, true));
+
+    graph_dense_destroy(&p_dense);
+    ck_assert_ptr_null(p_dense);
+}
+END_TEST
+
+START_TEST(test_dense_matches_csr)
+{
+    graph_t *       p_graph = graph_generate_rmat(8, 24, 0, 5, true);
+    graph_dense_t * p_dense = graph_dense_from_graph(p_graph);
+    ck_assert_ptr_nonnull(p_dense);
+
+    uint32_t   num      = p_graph->num_vertices;
+    bool *     p_matrix = calloc((size_t)num * num, sizeof(bool));
+    uint32_t * p_ref    = malloc(num * sizeof(uint32_t));
+    uint32_t * p_depth  = malloc(num * sizeof(uint32_t));
+
+    for (uint32_t u = 0; u < num; u++)
+    {
+        uint32_t degree = 0;
+        for (uint64_t edge = p_graph->p_offsets[u];
+             edge < p_graph->p_offsets[u + 1];
+             edge++)
+        {
+            size_t cell = ((size_t)u * num) + p_graph->p_targets[edge];
+            degree += p_matrix[cell] ? 0 : 1;
+            p_matrix[cell] = true;
+        }
+        ck_assert_uint_eq(graph_dense_degree(p_dense, u), degree);
+    }
+
+    uint64_t triangles = 0;
+    for (uint32_t u = 0; u < num; u++)
+    {
+        for (uint32_t v = u + 1; v < num; v++)
+        {
+            for (uint32_t w = v + 1;
+                 p_matrix[((size_t)u * num) + v] && (w < num);
+                 w++)
+            {
+                triangles += (p_matrix[((size_t)u * num) + w]
+                              && p_matrix[((size_t)v * num) + w])
+                                 ? 1
+                                 : 0;
+            }
+        }
+    }
+    ck_assert_uint_gt(triangles, 0);
+    ck_assert_uint_eq(graph_dense_triangles(p_dense), triangles);
+
+    for (uint32_t source = 0; source < num; source += 37)
+    {
+        reference_bfs(p_graph, source, p_ref);
+        ck_assert_int_eq(graph_dense_bfs(p_dense, source, p_depth),
+                         GRAPH_DENSE_SUCCESS);
+        ck_assert_mem_eq(p_ref, p_depth, num * sizeof(uint32_t));
+    }
+
+    free(p_depth);
+    free(p_ref);
+    free(p_matrix);
+    graph_dense_destroy(&p_dense);
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+START_TEST(test_dense_closure_matches_bfs)
+{
+    graph_t *       p_graph   = graph_generate_rmat(8, 2, 0, 13, false);
+    graph_dense_t * p_dense   = graph_dense_from_graph(p_graph);
+    graph_dense_t * p_closure = graph_dense_closure(p_dense);
+    ck_assert_ptr_nonnull(p_closure);
+
+    uint32_t   num   = p_graph->num_vertices;
+    uint32_t * p_ref = malloc(num * sizeof(uint32_t));
+
+    for (uint32_t source = 0; source < num; source++)
+    {
+        reference_bfs(p_graph, source, p_ref);
+
+        // The source reaches itself only through one of its in-arcs
+        bool b_cycle = false;
+        for (uint64_t edge = p_graph->p_in_offsets[source];
+             edge < p_graph->p_in_offsets[source + 1];
+             edge++)
+        {
+            b_cycle |= (GRAPH_DEPTH_UNREACHED
+                        != p_ref[p_graph->p_in_sources[edge]]);
+        }
+
+        for (uint32_t target = 0; target < num; target++)
+        {
+            bool b_expect = (target == source)
+                                ? b_cycle
+                                : (GRAPH_DEPTH_UNREACHED != p_ref[target]);
+            ck_assert(graph_dense_has_edge(p_closure, source, target)
+                      == b_expect);
+        }
+    }
+
+    free(p_ref);
+    graph_dense_destroy(&p_closure);
+    graph_dense_destroy(&p_dense);
+    graph_destroy(&p_graph);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+graph_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Graph");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_create_csr);
+    tcase_add_test(tc_core, test_create_rejects_bad_vertex);
+    tcase_add_test(tc_core, test_bfs_modes_match_reference);
+    tcase_add_test(tc_core, test_bfs_directed_uses_in_edges);
+    tcase_add_test(tc_core, test_sssp_matches_dijkstra);
+    tcase_add_test(tc_core, test_search_rejects_bad_params);
+    tcase_add_test(tc_core, test_td_parse_buckets_and_names);
+    tcase_add_test(tc_core, test_td_waits_for_faster_bucket);
+    tcase_add_test(tc_core, test_td_matches_reference);
+    tcase_add_test(tc_core, test_td_batch_matches_single);
+    tcase_add_test(tc_core, test_td_parse_rejects_bad_input);
+    tcase_add_test(tc_core, test_ch_road_matches_dijkstra);
+    tcase_add_test(tc_core, test_ch_directed_matches_dijkstra);
+    tcase_add_test(tc_core, test_ch_save_and_map);
+    tcase_add_test(tc_core, test_dense_edges);
+    tcase_add_test(tc_core, test_dense_matches_csr);
+    tcase_add_test(tc_core, test_dense_closure_matches_bfs);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = graph_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -0,0 +1,1580 @@
+/** @file td_graph.c
+ *
+ * @brief Implementation of the time-dependent graph, its JSON loader and
+ *        the earliest-arrival search.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph_runner.h"
+#include "td_graph.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define NAME_INDEX_MIN   (64u)
+#define NUMBER_MAX_LEN   (63)
+#define BATCH_CHUNK      (16u)
+#define MAX_NESTING      (3)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* One travel time read from the file, before buckets are merged */
+typedef struct
+{
+    uint32_t src;    /* Source vertex */
+    uint32_t dst;    /* Destination vertex */
+    uint32_t period; /* Index of the "HHMM" key it was read under */
+    uint32_t seq;    /* Order of appearance, so the last duplicate wins */
+    uint32_t travel; /* Minutes */
+} raw_edge_t;
+
+/* Growable byte buffer */
+typedef struct
+{
+    char * p_data;
+    size_t len;
+    size_t cap;
+} byte_buf_t;
+
+/* State carried through the JSON parse */
+typedef struct
+{
+    const char * p_cur;          /* Next unread byte */
+    const char * p_end;          /* One past the last byte */
+    byte_buf_t   scratch;        /* Decoded string being read */
+    byte_buf_t   names;          /* Street names, NUL separated */
+    uint32_t *   p_name_offsets; /* Offset of each name in names */
+    uint32_t     num_names;
+    uint32_t     names_cap;
+    uint32_t *   p_name_index;   /* Open addressing table of vertex ids */
+    uint32_t     name_mask;
+    uint32_t *   p_periods;      /* Start minute of each "HHMM" key */
+    uint32_t     num_periods;
+    uint32_t     periods_cap;
+    raw_edge_t * p_raw;          /* Travel times in file order */
+    uint32_t     num_raw;
+    uint32_t     raw_cap;
+} parser_t;
+
+struct td_workspace
+{
+    uint32_t   num_vertices; /* Size of the arrays below */
+    uint32_t * p_arrival;    /* Best known arrival per vertex */
+    uint32_t * p_parent;     /* Predecessor on the best route */
+    uint32_t * p_stamp;      /* Query generation that wrote the slot */
+    uint32_t   generation;   /* Current query generation */
+    uint64_t * p_heap;       /* Binary heap of (arrival << 32 | vertex) */
+    size_t     heap_len;
+    size_t     heap_cap;
+    uint32_t   source;       /* Source of the last query */
+    uint32_t   target;       /* Target of the last query */
+    bool       b_reached;    /* Last query reached its target */
+};
+
+/* Shared state of a td_batch call */
+typedef struct
+{
+    const td_graph_t * p_graph;
+    td_workspace_t **  pp_work;   /* One workspace per worker */
+    td_query_t *       p_queries;
+    size_t             count;
+    size_t             next;      /* Next unclaimed query (atomic) */
+} batch_ctx_t;
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static bool     buf_reserve(byte_buf_t * p_buf, size_t extra);
+static bool     grow_array(void ** pp_array, uint32_t * p_cap, size_t elem);
+static void     skip_space(parser_t * p_parser);
+static bool     expect_char(parser_t * p_parser, char expected);
+static bool     parse_string(parser_t * p_parser);
+static bool     parse_escape(parser_t * p_parser);
+static bool     parse_minutes(parser_t * p_parser, uint32_t * p_minutes);
+static bool     parse_period_key(parser_t * p_parser, uint32_t * p_minute);
+static bool     parse_object(parser_t * p_parser,
+                             uint32_t   depth,
+                             uint32_t   period,
+                             uint32_t   src);
+static uint32_t hash_name(const char * p_name, size_t len);
+static uint32_t lookup_name(const char *     p_names,
+                            const uint32_t * p_offsets,
+                            const uint32_t * p_index,
+                            uint32_t         mask,
+                            const char *     p_name,
+                            size_t           len);
+static bool     intern_name(parser_t * p_parser, uint32_t * p_vertex);
+static bool     rehash_names(parser_t * p_parser);
+static void     parser_free(parser_t * p_parser);
+static int      compare_raw(const void * p_lhs, const void * p_rhs);
+static int      compare_minutes(const void * p_lhs, const void * p_rhs);
+static bool     build_buckets(td_graph_t * p_graph, parser_t * p_parser);
+static bool     build_edges(td_graph_t * p_graph, parser_t * p_parser);
+static void     fill_later(td_graph_t * p_graph);
+static void     heap_push(td_workspace_t * p_work, uint64_t entry);
+static uint64_t heap_pop(td_workspace_t * p_work);
+static void     batch_task(void * p_arg, uint32_t worker);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Builds a graph from JSON text.
+ *
+ * @param[in] p_text JSON text (need not be NUL terminated)
+ * @param[in] length Number of bytes in p_text
+ *
+ * @return Pointer to the new graph, or NULL on malformed input or
+ *         allocation failure
+ */
+td_graph_t *
+td_graph_parse(const char * p_text, size_t length)
+{
+    if (NULL == p_text)
+    {
+        return NULL;
+    }
+
+    parser_t parser = { 0 };
+    parser.p_cur    = p_text;
+    parser.p_end    = p_text + length;
+
+    bool b_ok = parse_object(&parser, 0, 0, 0);
+    if (b_ok)
+    {
+        skip_space(&parser);
+        b_ok = (parser.p_cur == parser.p_end);
+    }
+
+    td_graph_t * p_graph = b_ok ? calloc(1, sizeof(td_graph_t)) : NULL;
+    if (NULL == p_graph)
+    {
+        parser_free(&parser);
+        return NULL;
+    }
+
+    // The name table moves into the graph as built
+    p_graph->num_vertices   = parser.num_names;
+    p_graph->p_names        = parser.names.p_data;
+    p_graph->p_name_offsets = parser.p_name_offsets;
+    p_graph->p_name_index   = parser.p_name_index;
+    p_graph->name_mask      = parser.name_mask;
+    parser.names.p_data     = NULL;
+    parser.p_name_offsets   = NULL;
+    parser.p_name_index     = NULL;
+
+    if (!build_buckets(p_graph, &parser) || !build_edges(p_graph, &parser))
+    {
+        td_graph_destroy(&p_graph);
+    }
+    else
+    {
+        fill_later(p_graph);
+    }
+
+    parser_free(&parser);
+    return p_graph;
+}
+
+/*!
+ * @brief Reads and parses a JSON file.
+ *
+ * @param[in] p_path Path to the file
+ *
+ * @return Pointer to the new graph, or NULL on failure
+ */
+td_graph_t *
+td_graph_load(const char * p_path)
+{
+    if (NULL == p_path)
+    {
+        return NULL;
+    }
+
+    FILE * p_file = fopen(p_path, "rb");
+    if (NULL == p_file)
+    {
+        return NULL;
+    }
+
+    td_graph_t * p_graph = NULL;
+    long         size    = -1;
+
+    if (0 == fseek(p_file, 0, SEEK_END))
+    {
+        size = ftell(p_file);
+        rewind(p_file);
+    }
+
+    char * p_text = (size >= 0) ? malloc((size_t)size + 1) : NULL;
+    if ((NULL != p_text)
+        && ((size_t)size == fread(p_text, 1, (size_t)size, p_file)))
+    {
+        p_graph = td_graph_parse(p_text, (size_t)size);
+    }
+
+    free(p_text);
+    fclose(p_file);
+    return p_graph;
+}
+
+/*!
+ * @brief Looks up a street by name.
+ *
+ * @param[in] p_graph Graph
+ * @param[in] p_name  Street name
+ *
+ * @return Vertex id, or TD_NO_VERTEX if the street is unknown
+ */
+uint32_t
+td_graph_find(const td_graph_t * p_graph, const char * p_name)
+{
+    if ((NULL == p_graph) || (NULL == p_name)
+        || (NULL == p_graph->p_name_index))
+    {
+        return TD_NO_VERTEX;
+    }
+
+    return lookup_name(p_graph->p_names,
+                       p_graph->p_name_offsets,
+                       p_graph->p_name_index,
+                       p_graph->name_mask,
+                       p_name,
+                       strlen(p_name));
+}
+
+/*!
+ * @brief Gets the name of a street.
+ *
+ * @param[in] p_graph Graph
+ * @param[in] vertex  Vertex id
+ *
+ * @return Street name, or NULL for an invalid vertex
+ */
+const char *
+td_graph_name(const td_graph_t * p_graph, uint32_t vertex)
+{
+    if ((NULL == p_graph) || (vertex >= p_graph->num_vertices))
+    {
+        return NULL;
+    }
+
+    return p_graph->p_names + p_graph->p_name_offsets[vertex];
+}
+
+/*!
+ * @brief Frees a graph and all of its arrays.
+ *
+ * @param[in,out] pp_graph Pointer to the graph pointer; set to NULL
+ */
+void
+td_graph_destroy(td_graph_t ** pp_graph)
+{
+    if ((NULL == pp_graph) || (NULL == *pp_graph))
+    {
+        return;
+    }
+
+    td_graph_t * p_graph = *pp_graph;
+
+    free(p_graph->p_bucket_start);
+    free(p_graph->p_minute_bucket);
+    free(p_graph->p_minute_left);
+    free(p_graph->p_offsets);
+    free(p_graph->p_targets);
+    free(p_graph->p_weights);
+    free(p_graph->p_names);
+    free(p_graph->p_name_offsets);
+    free(p_graph->p_name_index);
+    free(p_graph);
+    *pp_graph = NULL;
+}
+
+/*!
+ * @brief Allocates search state sized for a graph.
+ *
+ * @param[in] p_graph Graph the workspace will be used with
+ *
+ * @return Pointer to the new workspace, or NULL on failure
+ */
+td_workspace_t *
+td_workspace_create(const td_graph_t * p_graph)
+{
+    if (NULL == p_graph)
+    {
+        return NULL;
+    }
+
+    td_workspace_t * p_work = calloc(1, sizeof(td_workspace_t));
+    if (NULL == p_work)
+    {
+        return NULL;
+    }
+
+    size_t count = (0 == p_graph->num_vertices) ? 1 : p_graph->num_vertices;
+
+    // Every relaxation pushes at most once, plus the source
+    p_work->num_vertices = p_graph->num_vertices;
+    p_work->heap_cap     = (size_t)p_graph->num_edges + 1;
+    p_work->p_arrival    = malloc(count * sizeof(uint32_t));
+    p_work->p_parent     = malloc(count * sizeof(uint32_t));
+    p_work->p_stamp      = calloc(count, sizeof(uint32_t));
+    p_work->p_heap       = malloc(p_work->heap_cap * sizeof(uint64_t));
+
+    if ((NULL == p_work->p_arrival) || (NULL == p_work->p_parent)
+        || (NULL == p_work->p_stamp) || (NULL == p_work->p_heap))
+    {
+        td_workspace_destroy(&p_work);
+    }
+
+    return p_work;
+}
+
+/*!
+ * @brief Frees a workspace.
+ *
+ * @param[in,out] pp_work Pointer to the workspace pointer; set to NULL
+ */
+void
+td_workspace_destroy(td_workspace_t ** pp_work)
+{
+    if ((NULL == pp_work) || (NULL == *pp_work))
+    {
+        return;
+    }
+
+    free((*pp_work)->p_arrival);
+    free((*pp_work)->p_parent);
+    free((*pp_work)->p_stamp);
+    free((*pp_work)->p_heap);
+    free(*pp_work);
+    *pp_work = NULL;
+}
+
+/*!
+ * @brief Earliest arrival from source to target when leaving at depart.
+ *
+ * Time-dependent Dijkstra: labels are arrival minutes and an edge leaving
+ * at minute t costs min(travel in t's bucket, wait for the next bucket
+ * and take the best later travel time), which td_weight_t precomputes.
+ *
+ * @param[in]     p_graph   Graph
+ * @param[in,out] p_work    Workspace created for p_graph
+ * @param[in]     source    Start vertex
+ * @param[in]     target    Destination vertex
+ * @param[in]     depart    Departure minute of the day (0..1439)
+ * @param[out]    p_arrival Arrival minute counted from the same midnight
+ *                          as depart, or TD_INFINITY if unreachable
+ *
+ * @return TD_GRAPH_SUCCESS on success, TD_GRAPH_ERROR_PARAM on bad input
+ */
+int
+td_earliest_arrival(const td_graph_t * p_graph,
+                    td_workspace_t *   p_work,
+                    uint32_t           source,
+                    uint32_t           target,
+                    uint32_t           depart,
+                    uint32_t *         p_arrival)
+{
+    if ((NULL == p_graph) || (NULL == p_work) || (NULL == p_arrival)
+        || (p_work->num_vertices != p_graph->num_vertices)
+        || (source >= p_graph->num_vertices)
+        || (target >= p_graph->num_vertices)
+        || (depart >= TD_MINUTES_PER_DAY))
+    {
+        return TD_GRAPH_ERROR_PARAM;
+    }
+
+    // Stamps avoid clearing the per-vertex arrays before every query
+    p_work->generation++;
+    if (0 == p_work->generation)
+    {
+        memset(p_work->p_stamp, 0, p_work->num_vertices * sizeof(uint32_t));
+        p_work->generation = 1;
+    }
+
+    uint32_t   gen       = p_work->generation;
+    uint32_t * p_best    = p_work->p_arrival;
+    uint32_t * p_parent  = p_work->p_parent;
+    uint32_t * p_stamp   = p_work->p_stamp;
+    uint32_t   buckets   = p_graph->num_buckets;
+
+    p_work->source    = source;
+    p_work->target    = target;
+    p_work->b_reached = false;
+    p_work->heap_len  = 0;
+
+    p_best[source]   = depart;
+    p_parent[source] = source;
+    p_stamp[source]  = gen;
+    heap_push(p_work, ((uint64_t)depart << 32) | source);
+
+    *p_arrival = TD_INFINITY;
+
+    while (0 != p_work->heap_len)
+    {
+        uint64_t top    = heap_pop(p_work);
+        uint32_t now    = (uint32_t)(top >> 32);
+        uint32_t vertex = (uint32_t)top;
+
+        if (now > p_best[vertex])
+        {
+            continue;
+        }
+
+        if (vertex == target)
+        {
+            p_work->b_reached = true;
+            *p_arrival        = now;
+            break;
+        }
+
+        uint32_t            minute = now % TD_MINUTES_PER_DAY;
+        uint64_t            wait   = (uint64_t)now
+                                     + p_graph->p_minute_left[minute];
+        const td_weight_t * p_row
+            = p_graph->p_weights + p_graph->p_minute_bucket[minute];
+
+        for (uint32_t edge = p_graph->p_offsets[vertex];
+             edge < p_graph->p_offsets[vertex + 1];
+             edge++)
+        {
+            const td_weight_t * p_weight = p_row + ((size_t)edge * buckets);
+            uint64_t            arrive   = (uint64_t)now + p_weight->travel;
+            uint64_t            later    = wait + p_weight->later;
+
+            if (later < arrive)
+            {
+                arrive = later;
+            }
+
+            if (arrive >= TD_INFINITY)
+            {
+                continue;
+            }
+
+            uint32_t next = p_graph->p_targets[edge];
+            if ((gen != p_stamp[next]) || (arrive < p_best[next]))
+            {
+                p_stamp[next]  = gen;
+                p_best[next]   = (uint32_t)arrive;
+                p_parent[next] = vertex;
+                heap_push(p_work, (arrive << 32) | next);
+            }
+        }
+    }
+
+    return TD_GRAPH_SUCCESS;
+}
+
+/*!
+ * @brief Copies the route found by the last td_earliest_arrival call.
+ *
+ * @param[in]  p_work   Workspace used for the query
+ * @param[out] p_path   Vertex ids from source to target
+ * @param[in]  capacity Number of entries p_path can hold
+ *
+ * @return Number of vertices on the route (0 if the target was not
+ *         reached); only min(return, capacity) entries are written
+ */
+uint32_t
+td_workspace_path(const td_workspace_t * p_work,
+                  uint32_t *             p_path,
+                  uint32_t               capacity)
+{
+    if ((NULL == p_work) || !p_work->b_reached)
+    {
+        return 0;
+    }
+
+    uint32_t length = 1;
+    for (uint32_t vertex = p_work->target; vertex != p_work->source;
+         vertex      = p_work->p_parent[vertex])
+    {
+        length++;
+    }
+
+    if ((NULL == p_path) || (length > capacity))
+    {
+        return length;
+    }
+
+    uint32_t vertex = p_work->target;
+    for (uint32_t idx = length; idx > 0; idx--)
+    {
+        p_path[idx - 1] = vertex;
+        vertex          = p_work->p_parent[vertex];
+    }
+
+    return length;
+}
+
+/*!
+ * @brief Answers many queries in parallel.
+ *
+ * @param[in]     p_graph     Graph
+ * @param[in]     p_pool      Thread pool (NULL runs serially)
+ * @param[in]     num_workers Tasks to split the batch over
+ *                            (1..TD_MAX_WORKERS)
+ * @param[in,out] p_queries   Queries; arrival is filled in
+ * @param[in]     count       Number of queries
+ *
+ * @return TD_GRAPH_SUCCESS on success, negative error code on failure
+ */
+int
+td_batch(const td_graph_t * p_graph,
+         thread_pool_t *    p_pool,
+         uint32_t           num_workers,
+         td_query_t *       p_queries,
+         size_t             count)
+{
+    if ((NULL == p_graph) || ((NULL == p_queries) && (0 != count))
+        || (0 == num_workers) || (num_workers > TD_MAX_WORKERS))
+    {
+        return TD_GRAPH_ERROR_PARAM;
+    }
+
+    // Never start more workers than there are chunks to hand out
+    size_t chunks = (count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    if ((size_t)num_workers > chunks)
+    {
+        num_workers = (0 == chunks) ? 1 : (uint32_t)chunks;
+    }
+
+    td_workspace_t * workspaces[TD_MAX_WORKERS] = { 0 };
+    graph_runner_t * p_runner = graph_runner_create(p_pool, num_workers);
+    int              result   = (NULL != p_runner) ? TD_GRAPH_SUCCESS
+                                                   : TD_GRAPH_ERROR_MEMORY;
+
+    for (uint32_t idx = 0; (TD_GRAPH_SUCCESS == result) && (idx < num_workers);
+         idx++)
+    {
+        workspaces[idx] = td_workspace_create(p_graph);
+        if (NULL == workspaces[idx])
+        {
+            result = TD_GRAPH_ERROR_MEMORY;
+        }
+    }
+
+    if (TD_GRAPH_SUCCESS == result)
+    {
+        batch_ctx_t ctx = { .p_graph   = p_graph,
+                            .pp_work   = workspaces,
+                            .p_queries = p_queries,
+                            .count     = count,
+                            .next      = 0 };
+
+        graph_runner_run(p_runner, batch_task, &ctx);
+    }
+
+    for (uint32_t idx = 0; idx < num_workers; idx++)
+    {
+        td_workspace_destroy(&workspaces[idx]);
+    }
+    graph_runner_destroy(&p_runner);
+
+    return result;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Makes room for extra bytes in a buffer, doubling its capacity.
+ *
+ * @param[in,out] p_buf Buffer
+ * @param[in]     extra Bytes that must fit after the current length
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+buf_reserve(byte_buf_t * p_buf, size_t extra)
+{
+    if ((p_buf->len + extra) <= p_buf->cap)
+    {
+        return true;
+    }
+
+    size_t cap = (0 == p_buf->cap) ? 256 : p_buf->cap;
+    while (cap < (p_buf->len + extra))
+    {
+        cap *= 2;
+    }
+
+    char * p_data = realloc(p_buf->p_data, cap);
+    if (NULL == p_data)
+    {
+        return false;
+    }
+
+    p_buf->p_data = p_data;
+    p_buf->cap    = cap;
+    return true;
+}
+
+/*!
+ * @brief Doubles the capacity of a heap array.
+ *
+ * @param[in,out] pp_array Array pointer
+ * @param[in,out] p_cap    Capacity in elements
+ * @param[in]     elem     Element size in bytes
+ *
+ * @return true on success, false on allocation failure or overflow
+ */
+static bool
+grow_array(void ** pp_array, uint32_t * p_cap, size_t elem)
+{
+    if (*p_cap > (UINT32_MAX / 2))
+    {
+        return false;
+    }
+
+    uint32_t cap = (0 == *p_cap) ? 64 : (*p_cap * 2);
+
+    void * p_array = realloc(*pp_array, (size_t)cap * elem);
+    if (NULL == p_array)
+    {
+        return false;
+    }
+
+    *pp_array = p_array;
+    *p_cap    = cap;
+    return true;
+}
+
+/*!
+ * @brief Skips JSON whitespace.
+ *
+ * @param[in,out] p_parser Parser
+ */
+static void
+skip_space(parser_t * p_parser)
+{
+    while ((p_parser->p_cur < p_parser->p_end)
+           && ((' ' == *p_parser->p_cur) || ('\t' == *p_parser->p_cur)
+               || ('\n' == *p_parser->p_cur) || ('\r' == *p_parser->p_cur)))
+    {
+        p_parser->p_cur++;
+    }
+}
+
+/*!
+ * @brief Skips whitespace and consumes one expected character.
+ *
+ * @param[in,out] p_parser Parser
+ * @param[in]     expected Character that must come next
+ *
+ * @return true if the character was found
+ */
+static bool
+expect_char(parser_t * p_parser, char expected)
+{
+    skip_space(p_parser);
+    if ((p_parser->p_cur < p_parser->p_end) && (expected == *p_parser->p_cur))
+    {
+        p_parser->p_cur++;
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * @brief Decodes a JSON string into the scratch buffer, NUL terminated.
+ *
+ * @param[in,out] p_parser Parser positioned before the opening quote
+ *
+ * @return true on success, false on malformed input or allocation failure
+ */
+static bool
+parse_string(parser_t * p_parser)
+{
+    if (!expect_char(p_parser, '"'))
+    {
+        return false;
+    }
+
+    p_parser->scratch.len = 0;
+
+    while (p_parser->p_cur < p_parser->p_end)
+    {
+        // Copy the run of plain bytes in one go
+        const char * p_start = p_parser->p_cur;
+        while ((p_parser->p_cur < p_parser->p_end)
+               && ('"' != *p_parser->p_cur) && ('\\' != *p_parser->p_cur)
+               && ((unsigned char)*p_parser->p_cur >= 0x20))
+        {
+            p_parser->p_cur++;
+        }
+
+        size_t run = (size_t)(p_parser->p_cur - p_start);
+        if (!buf_reserve(&p_parser->scratch, run + 1))
+        {
+            return false;
+        }
+        memcpy(p_parser->scratch.p_data + p_parser->scratch.len, p_start, run);
+        p_parser->scratch.len += run;
+
+        if (p_parser->p_cur >= p_parser->p_end)
+        {
+            break;
+        }
+
+        if ('"' == *p_parser->p_cur)
+        {
+            p_parser->p_cur++;
+            p_parser->scratch.p_data[p_parser->scratch.len] = '\0';
+            return true;
+        }
+
+        if (('\\' != *p_parser->p_cur) || !parse_escape(p_parser))
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * @brief Decodes one backslash escape into the scratch buffer.
+ *
+ * \uXXXX escapes are written as UTF-8; a surrogate pair is combined into
+ * one code point.
+ *
+ * @param[in,out] p_parser Parser positioned on the backslash
+ *
+ * @return true on success, false on malformed input or allocation failure
+ */
+static bool
+parse_escape(parser_t * p_parser)
+{
+    static const char from[] = "\"\\/bfnrt";
+    static const char to[]   = "\"\\/\b\f\n\r\t";
+
+    if (((p_parser->p_end - p_parser->p_cur) < 2)
+        || !buf_reserve(&p_parser->scratch, 5))
+    {
+        return false;
+    }
+
+    char         kind  = p_parser->p_cur[1];
+    const char * p_hit = ('\0' != kind) ? strchr(from, kind) : NULL;
+    p_parser->p_cur += 2;
+
+    if (NULL != p_hit)
+    {
+        p_parser->scratch.p_data[p_parser->scratch.len++] = to[p_hit - from];
+        return true;
+    }
+
+    uint32_t code  = 0;
+    uint32_t units = 0;
+    while ('u' == kind)
+    {
+        if ((p_parser->p_end - p_parser->p_cur) < 4)
+        {
+            return false;
+        }
+
+        uint32_t unit = 0;
+        for (int idx = 0; idx < 4; idx++)
+        {
+            char digit = *p_parser->p_cur++;
+            unit <<= 4;
+            if ((digit >= '0') && (digit <= '9'))
+            {
+                unit |= (uint32_t)(digit - '0');
+            }
+            else if (((digit | 0x20) >= 'a') && ((digit | 0x20) <= 'f'))
+            {
+                unit |= (uint32_t)((digit | 0x20) - 'a' + 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        units++;
+        if ((1 == units) && (unit >= 0xD800) && (unit < 0xDC00)
+            && ((p_parser->p_end - p_parser->p_cur) >= 6)
+            && ('\\' == p_parser->p_cur[0]) && ('u' == p_parser->p_cur[1]))
+        {
+            // High surrogate: the low half follows as a second escape
+            code = unit;
+            p_parser->p_cur += 2;
+            continue;
+        }
+
+        if ((2 == units) && ((unit < 0xDC00) || (unit > 0xDFFF)))
+        {
+            return false;
+        }
+
+        code = (2 == units)
+                   ? (0x10000 + ((code - 0xD800) << 10) + (unit - 0xDC00))
+                   : unit;
+        kind = '\0';
+    }
+
+    if (0 == units)
+    {
+        return false;
+    }
+
+    char * p_out = p_parser->scratch.p_data + p_parser->scratch.len;
+    if (code < 0x80)
+    {
+        p_out[0] = (char)code;
+        p_parser->scratch.len += 1;
+    }
+    else if (code < 0x800)
+    {
+        p_out[0] = (char)(0xC0 | (code >> 6));
+        p_out[1] = (char)(0x80 | (code & 0x3F));
+        p_parser->scratch.len += 2;
+    }
+    else if (code < 0x10000)
+    {
+        p_out[0] = (char)(0xE0 | (code >> 12));
+        p_out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        p_out[2] = (char)(0x80 | (code & 0x3F));
+        p_parser->scratch.len += 3;
+    }
+    else
+    {
+        p_out[0] = (char)(0xF0 | (code >> 18));
+        p_out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+        p_out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+        p_out[3] = (char)(0x80 | (code & 0x3F));
+        p_parser->scratch.len += 4;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Reads a non-negative JSON number rounded to whole minutes.
+ *
+ * @param[in,out] p_parser  Parser
+ * @param[out]    p_minutes Parsed value
+ *
+ * @return true on success, false on malformed or out of range input
+ */
+static bool
+parse_minutes(parser_t * p_parser, uint32_t * p_minutes)
+{
+    char   text[NUMBER_MAX_LEN + 1];
+    size_t len = 0;
+
+    skip_space(p_parser);
+    while ((p_parser->p_cur < p_parser->p_end) && (len < NUMBER_MAX_LEN)
+           && ('\0' != *p_parser->p_cur)
+           && (NULL != strchr("+-.0123456789eE", *p_parser->p_cur)))
+    {
+        text[len++] = *p_parser->p_cur++;
+    }
+    text[len] = '\0';
+
+    char * p_stop = NULL;
+    double value  = strtod(text, &p_stop);
+
+    if ((0 == len) || (p_stop != (text + len)) || !(value >= 0.0)
+        || (value >= (double)(TD_INFINITY / 2)))
+    {
+        return false;
+    }
+
+    *p_minutes = (uint32_t)(value + 0.5);
+    return true;
+}
+
+/*!
+ * @brief Converts the "HHMM" key in the scratch buffer to a minute of day.
+ *
+ * @param[in]  p_parser Parser holding the decoded key
+ * @param[out] p_minute Minute of the day; 2400 wraps to 0
+ *
+ * @return true if the key is four digits with HH <= 24 and MM < 60
+ */
+static bool
+parse_period_key(parser_t * p_parser, uint32_t * p_minute)
+{
+    const char * p_key = p_parser->scratch.p_data;
+
+    if (4 != p_parser->scratch.len)
+    {
+        return false;
+    }
+
+    for (int idx = 0; idx < 4; idx++)
+    {
+        if ((p_key[idx] < '0') || (p_key[idx] > '9'))
+        {
+            return false;
+        }
+    }
+
+    uint32_t hours   = (uint32_t)(((p_key[0] - '0') * 10) + (p_key[1] - '0'));
+    uint32_t minutes = (uint32_t)(((p_key[2] - '0') * 10) + (p_key[3] - '0'));
+
+    if ((hours > 24) || (minutes >= 60) || ((24 == hours) && (0 != minutes)))
+    {
+        return false;
+    }
+
+    *p_minute = ((hours * 60) + minutes) % TD_MINUTES_PER_DAY;
+    return true;
+}
+
+/*!
+ * @brief Parses one level of the period / from / to object nesting.
+ *
+ * Depth 0 is the root keyed by period, depth 1 is keyed by the source
+ * street and depth 2 by the destination street with travel times as
+ * values.
+ *
+ * @param[in,out] p_parser Parser
+ * @param[in]     depth    Nesting level (0..2)
+ * @param[in]     period   Index of the enclosing period key
+ * @param[in]     src      Enclosing source vertex
+ *
+ * @return true on success, false on malformed input or allocation failure
+ */
+static bool
+parse_object(parser_t * p_parser, uint32_t depth, uint32_t period, uint32_t src)
+{
+    if ((depth >= MAX_NESTING) || !expect_char(p_parser, '{'))
+    {
+        return false;
+    }
+
+    if (expect_char(p_parser, '}'))
+    {
+        return true;
+    }
+
+    do
+    {
+        uint32_t key = 0;
+        bool     b_ok;
+
+        if (!parse_string(p_parser))
+        {
+            return false;
+        }
+
+        if (0 == depth)
+        {
+            b_ok = parse_period_key(p_parser, &key);
+            if (b_ok && (p_parser->num_periods == p_parser->periods_cap))
+            {
+                b_ok = grow_array((void **)&p_parser->p_periods,
+                                  &p_parser->periods_cap,
+                                  sizeof(uint32_t));
+            }
+            if (b_ok)
+            {
+                p_parser->p_periods[p_parser->num_periods] = key;
+                key = p_parser->num_periods++;
+            }
+        }
+        else
+        {
+            b_ok = intern_name(p_parser, &key);
+        }
+
+        if (!b_ok || !expect_char(p_parser, ':'))
+        {
+            return false;
+        }
+
+        if (2 == depth)
+        {
+            uint32_t travel = 0;
+            if (!parse_minutes(p_parser, &travel))
+            {
+                return false;
+            }
+
+            if ((p_parser->num_raw == p_parser->raw_cap)
+                && !grow_array((void **)&p_parser->p_raw,
+                               &p_parser->raw_cap,
+                               sizeof(raw_edge_t)))
+            {
+                return false;
+            }
+
+            raw_edge_t * p_raw = &p_parser->p_raw[p_parser->num_raw];
+            p_raw->src         = src;
+            p_raw->dst         = key;
+            p_raw->period      = period;
+            p_raw->seq         = p_parser->num_raw++;
+            p_raw->travel      = travel;
+        }
+        else if (!parse_object(p_parser,
+                               depth + 1,
+                               (0 == depth) ? key : period,
+                               key))
+        {
+            return false;
+        }
+    } while (expect_char(p_parser, ','));
+
+    return expect_char(p_parser, '}');
+}
+
+/*!
+ * @brief FNV-1a hash of a street name.
+ *
+ * @param[in] p_name Name bytes
+ * @param[in] len    Number of bytes
+ *
+ * @return 32-bit hash
+ */
+static uint32_t
+hash_name(const char * p_name, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t idx = 0; idx < len; idx++)
+    {
+        hash ^= (unsigned char)p_name[idx];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/*!
+ * @brief Finds a name in an open addressing table.
+ *
+ * @param[in] p_names   Name storage
+ * @param[in] p_offsets Offset of each name in p_names
+ * @param[in] p_index   Table of vertex ids (TD_NO_VERTEX marks empty)
+ * @param[in] mask      Table size - 1
+ * @param[in] p_name    Name to look for
+ * @param[in] len       Length of p_name
+ *
+ * @return Vertex id, or TD_NO_VERTEX if absent
+ */
+static uint32_t
+lookup_name(const char *     p_names,
+            const uint32_t * p_offsets,
+            const uint32_t * p_index,
+            uint32_t         mask,
+            const char *     p_name,
+            size_t           len)
+{
+    for (uint32_t slot = hash_name(p_name, len) & mask;;
+         slot          = (slot + 1) & mask)
+    {
+        uint32_t vertex = p_index[slot];
+        if (TD_NO_VERTEX == vertex)
+        {
+            return TD_NO_VERTEX;
+        }
+
+        const char * p_have = p_names + p_offsets[vertex];
+        if ((0 == strncmp(p_have, p_name, len)) && ('\0' == p_have[len]))
+        {
+            return vertex;
+        }
+    }
+}
+
+/*!
+ * @brief Maps the street name in the scratch buffer to a vertex id,
+ *        adding it if it is new.
+ *
+ * @param[in,out] p_parser Parser
+ * @param[out]    p_vertex Vertex id
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+intern_name(parser_t * p_parser, uint32_t * p_vertex)
+{
+    const char * p_name = p_parser->scratch.p_data;
+    size_t       len    = p_parser->scratch.len;
+
+    // Keep the table at most half full
+    if ((p_parser->num_names * 2) >= p_parser->name_mask)
+    {
+        if (!rehash_names(p_parser))
+        {
+            return false;
+        }
+    }
+
+    uint32_t vertex = lookup_name(p_parser->names.p_data,
+                                  p_parser->p_name_offsets,
+                                  p_parser->p_name_index,
+                                  p_parser->name_mask,
+                                  p_name,
+                                  len);
+    if (TD_NO_VERTEX != vertex)
+    {
+        *p_vertex = vertex;
+        return true;
+    }
+
+    if (((p_parser->num_names == p_parser->names_cap)
+         && !grow_array((void **)&p_parser->p_name_offsets,
+                        &p_parser->names_cap,
+                        sizeof(uint32_t)))
+        || !buf_reserve(&p_parser->names, len + 1)
+        || (p_parser->names.len > (UINT32_MAX - len)))
+    {
+        return false;
+    }
+
+    vertex = p_parser->num_names++;
+    p_parser->p_name_offsets[vertex] = (uint32_t)p_parser->names.len;
+    memcpy(p_parser->names.p_data + p_parser->names.len, p_name, len + 1);
+    p_parser->names.len += len + 1;
+
+    uint32_t slot = hash_name(p_name, len) & p_parser->name_mask;
+    while (TD_NO_VERTEX != p_parser->p_name_index[slot])
+    {
+        slot = (slot + 1) & p_parser->name_mask;
+    }
+    p_parser->p_name_index[slot] = vertex;
+
+    *p_vertex = vertex;
+    return true;
+}
+
+/*!
+ * @brief Doubles the name table and reinserts every name.
+ *
+ * @param[in,out] p_parser Parser
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+rehash_names(parser_t * p_parser)
+{
+    uint32_t size = (0 == p_parser->name_mask) ? NAME_INDEX_MIN
+                                               : ((p_parser->name_mask + 1) * 2);
+    uint32_t * p_index = malloc((size_t)size * sizeof(uint32_t));
+    if (NULL == p_index)
+    {
+        return false;
+    }
+
+    memset(p_index, 0xFF, (size_t)size * sizeof(uint32_t));
+
+    for (uint32_t vertex = 0; vertex < p_parser->num_names; vertex++)
+    {
+        const char * p_name = p_parser->names.p_data
+                              + p_parser->p_name_offsets[vertex];
+        uint32_t     slot   = hash_name(p_name, strlen(p_name)) & (size - 1);
+
+        while (TD_NO_VERTEX != p_index[slot])
+        {
+            slot = (slot + 1) & (size - 1);
+        }
+        p_index[slot] = vertex;
+    }
+
+    free(p_parser->p_name_index);
+    p_parser->p_name_index = p_index;
+    p_parser->name_mask    = size - 1;
+    return true;
+}
+
+/*!
+ * @brief Frees whatever the parser still owns.
+ *
+ * @param[in,out] p_parser Parser
+ */
+static void
+parser_free(parser_t * p_parser)
+{
+    free(p_parser->scratch.p_data);
+    free(p_parser->names.p_data);
+    free(p_parser->p_name_offsets);
+    free(p_parser->p_name_index);
+    free(p_parser->p_periods);
+    free(p_parser->p_raw);
+}
+
+/*!
+ * @brief qsort comparator ordering raw edges by source, destination and
+ *        file order.
+ *
+ * @param[in] p_lhs First raw_edge_t
+ * @param[in] p_rhs Second raw_edge_t
+ *
+ * @return Negative, zero or positive as p_lhs sorts before, with or after
+ *         p_rhs
+ */
+static int
+compare_raw(const void * p_lhs, const void * p_rhs)
+{
+    const raw_edge_t * p_a = p_lhs;
+    const raw_edge_t * p_b = p_rhs;
+
+    if (p_a->src != p_b->src)
+    {
+        return (p_a->src < p_b->src) ? -1 : 1;
+    }
+    if (p_a->dst != p_b->dst)
+    {
+        return (p_a->dst < p_b->dst) ? -1 : 1;
+    }
+    if (p_a->seq != p_b->seq)
+    {
+        return (p_a->seq < p_b->seq) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief qsort comparator for minutes of the day.
+ *
+ * @param[in] p_lhs First uint32_t minute
+ * @param[in] p_rhs Second uint32_t minute
+ *
+ * @return Negative, zero or positive as p_lhs is less, equal or greater
+ */
+static int
+compare_minutes(const void * p_lhs, const void * p_rhs)
+{
+    uint32_t lhs = *(const uint32_t *)p_lhs;
+    uint32_t rhs = *(const uint32_t *)p_rhs;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/*!
+ * @brief Turns the period keys into sorted buckets and the per-minute
+ *        lookup tables.
+ *
+ * Keys that name the same minute share a bucket. Each raw edge's period
+ * is rewritten to its bucket index.
+ *
+ * @param[in,out] p_graph  Graph being built
+ * @param[in,out] p_parser Parser holding the periods and raw edges
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+build_buckets(td_graph_t * p_graph, parser_t * p_parser)
+{
+    uint32_t count = p_parser->num_periods;
+
+    p_graph->p_bucket_start  = malloc(((0 == count) ? 1 : count)
+                                      * sizeof(uint32_t));
+    p_graph->p_minute_bucket = malloc(TD_MINUTES_PER_DAY * sizeof(uint16_t));
+    p_graph->p_minute_left   = malloc(TD_MINUTES_PER_DAY * sizeof(uint16_t));
+
+    if ((NULL == p_graph->p_bucket_start) || (NULL == p_graph->p_minute_bucket)
+        || (NULL == p_graph->p_minute_left))
+    {
+        return false;
+    }
+
+    uint32_t * p_start = p_graph->p_bucket_start;
+    uint32_t   buckets = 0;
+
+    if (0 != count)
+    {
+        memcpy(p_start, p_parser->p_periods, count * sizeof(uint32_t));
+        qsort(p_start, count, sizeof(uint32_t), compare_minutes);
+
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            if ((0 == buckets) || (p_start[buckets - 1] != p_start[idx]))
+            {
+                p_start[buckets++] = p_start[idx];
+            }
+        }
+    }
+    p_graph->num_buckets = buckets;
+
+    // Minutes before the first start still belong to the last bucket
+    uint32_t bucket = (0 == buckets) ? 0 : (buckets - 1);
+    for (uint32_t minute = 0; minute < TD_MINUTES_PER_DAY; minute++)
+    {
+        while (((bucket + 1) < buckets) && (p_start[bucket + 1] <= minute))
+        {
+            bucket++;
+        }
+        if ((0 != buckets) && (minute == p_start[0]))
+        {
+            bucket = 0;
+        }
+
+        uint32_t next = TD_MINUTES_PER_DAY;
+        if (0 != buckets)
+        {
+            next = (minute < p_start[0])       ? p_start[0]
+                   : ((bucket + 1) < buckets) ? p_start[bucket + 1]
+                                              : (p_start[0] + TD_MINUTES_PER_DAY);
+        }
+
+        p_graph->p_minute_bucket[minute] = (uint16_t)bucket;
+        p_graph->p_minute_left[minute]   = (uint16_t)(next - minute);
+    }
+
+    for (uint32_t idx = 0; idx < p_parser->num_raw; idx++)
+    {
+        uint32_t minute = p_parser->p_periods[p_parser->p_raw[idx].period];
+        p_parser->p_raw[idx].period = p_graph->p_minute_bucket[minute];
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Groups the raw travel times by street pair into CSR edges.
+ *
+ * @param[in,out] p_graph  Graph being built
+ * @param[in,out] p_parser Parser holding the raw edges; they are sorted
+ *
+ * @return true on success, false on allocation failure
+ */
+static bool
+build_edges(td_graph_t * p_graph, parser_t * p_parser)
+{
+    raw_edge_t * p_raw   = p_parser->p_raw;
+    uint32_t     num_raw = p_parser->num_raw;
+    uint32_t     buckets = p_graph->num_buckets;
+
+    if (0 != num_raw)
+    {
+        qsort(p_raw, num_raw, sizeof(raw_edge_t), compare_raw);
+    }
+
+    uint32_t num_edges = 0;
+    for (uint32_t idx = 0; idx < num_raw; idx++)
+    {
+        if ((0 == idx) || (p_raw[idx].src != p_raw[idx - 1].src)
+            || (p_raw[idx].dst != p_raw[idx - 1].dst))
+        {
+            num_edges++;
+        }
+    }
+
+    p_graph->num_edges = num_edges;
+    p_graph->p_offsets = calloc((size_t)p_graph->num_vertices + 1,
+                                sizeof(uint32_t));
+    p_graph->p_targets = malloc(((0 == num_edges) ? 1 : num_edges)
+                                * sizeof(uint32_t));
+    p_graph->p_weights = malloc(((0 == num_edges) ? 1 : num_edges)
+                                * ((0 == buckets) ? 1 : buckets)
+                                * sizeof(td_weight_t));
+
+    if ((NULL == p_graph->p_offsets) || (NULL == p_graph->p_targets)
+        || (NULL == p_graph->p_weights))
+    {
+        return false;
+    }
+
+    uint32_t edge = 0;
+    for (uint32_t idx = 0; idx < num_raw; idx++)
+    {
+        if ((0 == idx) || (p_raw[idx].src != p_raw[idx - 1].src)
+            || (p_raw[idx].dst != p_raw[idx - 1].dst))
+        {
+            // A pair absent from a bucket is closed during that bucket
+            edge++;
+            p_graph->p_targets[edge - 1] = p_raw[idx].dst;
+            p_graph->p_offsets[p_raw[idx].src + 1]++;
+
+            for (uint32_t bucket = 0; bucket < buckets; bucket++)
+            {
+                p_graph->p_weights[((size_t)(edge - 1) * buckets) + bucket]
+                    .travel
+                    = TD_INFINITY;
+            }
+        }
+
+        p_graph->p_weights[((size_t)(edge - 1) * buckets) + p_raw[idx].period]
+            .travel
+            = p_raw[idx].travel;
+    }
+
+    for (uint32_t vertex = 0; vertex < p_graph->num_vertices; vertex++)
+    {
+        p_graph->p_offsets[vertex + 1] += p_graph->p_offsets[vertex];
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Precomputes, per edge and bucket, the best arrival reachable by
+ *        waiting for a later bucket.
+ *
+ * later is measured from the end of the bucket; it is the minimum over the
+ * following bucket starts (one full day ahead) of the wait from the end of
+ * the bucket to that start plus the travel time there.
+ *
+ * @param[in,out] p_graph Graph with travel times filled in
+ */
+static void
+fill_later(td_graph_t * p_graph)
+{
+    uint32_t         buckets = p_graph->num_buckets;
+    const uint32_t * p_start = p_graph->p_bucket_start;
+
+    for (uint32_t edge = 0; edge < p_graph->num_edges; edge++)
+    {
+        td_weight_t * p_row = p_graph->p_weights + ((size_t)edge * buckets);
+
+        for (uint32_t bucket = 0; bucket < buckets; bucket++)
+        {
+            uint32_t end  = p_start[(bucket + 1) % buckets];
+            uint64_t best = TD_INFINITY;
+
+            for (uint32_t step = 1; step <= buckets; step++)
+            {
+                uint32_t other  = (bucket + step) % buckets;
+                uint32_t offset = (p_start[other] + TD_MINUTES_PER_DAY - end)
+                                  % TD_MINUTES_PER_DAY;
+                uint64_t cand   = (uint64_t)offset + p_row[other].travel;
+
+                if ((TD_INFINITY != p_row[other].travel) && (cand < best))
+                {
+                    best = cand;
+                }
+            }
+
+            p_row[bucket].later
+                = (best >= TD_INFINITY) ? TD_INFINITY : (uint32_t)best;
+        }
+    }
+}
+
+/*!
+ * @brief Pushes an entry onto the workspace heap.
+ *
+ * @param[in,out] p_work Workspace
+ * @param[in]     entry  (arrival << 32) | vertex
+ */
+static void
+heap_push(td_workspace_t * p_work, uint64_t entry)
+{
+    uint64_t * p_heap = p_work->p_heap;
+    size_t     pos    = p_work->heap_len++;
+
+    while (pos > 0)
+    {
+        size_t parent = (pos - 1) / 2;
+        if (p_heap[parent] <= entry)
+        {
+            break;
+        }
+        p_heap[pos] = p_heap[parent];
+        pos         = parent;
+    }
+
+    p_heap[pos] = entry;
+}
+
+/*!
+ * @brief Removes and returns the smallest heap entry.
+ *
+ * @param[in,out] p_work Workspace with a non-empty heap
+ *
+ * @return Smallest entry
+ */
+static uint64_t
+heap_pop(td_workspace_t * p_work)
+{
+    uint64_t * p_heap = p_work->p_heap;
+    uint64_t   top    = p_heap[0];
+    uint64_t   last   = p_heap[--p_work->heap_len];
+    size_t     len    = p_work->heap_len;
+    size_t     pos    = 0;
+
+    for (;;)
+    {
+        size_t child = (2 * pos) + 1;
+        if (child >= len)
+        {
+            break;
+        }
+        if (((child + 1) < len) && (p_heap[child + 1] < p_heap[child]))
+        {
+            child++;
+        }
+        if (last <= p_heap[child])
+        {
+            break;
+        }
+        p_heap[pos] = p_heap[child];
+        pos         = child;
+    }
+
+    if (len > 0)
+    {
+        p_heap[pos] = last;
+    }
+
+    return top;
+}
+
+/*!
+ * @brief Batch task: claims chunks of queries until none are left.
+ *
+ * @param[in] p_arg  batch_ctx_t of the batch
+ * @param[in] worker Worker index, selects the workspace
+ */
+static void
+batch_task(void * p_arg, uint32_t worker)
+{
+    batch_ctx_t *    p_ctx  = (batch_ctx_t *)p_arg;
+    td_workspace_t * p_work = p_ctx->pp_work[worker];
+
+    for (;;)
+    {
+        size_t begin = __atomic_fetch_add(&p_ctx->next, BATCH_CHUNK,
+                                          __ATOMIC_RELAXED);
+        if (begin >= p_ctx->count)
+        {
+            break;
+        }
+
+        size_t end = begin + BATCH_CHUNK;
+        if (end > p_ctx->count)
+        {
+            end = p_ctx->count;
+        }
+
+        for (size_t idx = begin; idx < end; idx++)
+        {
+            td_query_t * p_query = &p_ctx->p_queries[idx];
+
+            if (TD_GRAPH_SUCCESS
+                != td_earliest_arrival(p_ctx->p_graph,
+                                       p_work,
+                                       p_query->source,
+                                       p_query->target,
+                                       p_query->depart,
+                                       &p_query->arrival))
+            {
+                p_query->arrival = TD_INFINITY;
+            }
+        }
+    }
+}
+
+/*** end of file ***/
@@ -0,0 +1,223 @@
+/** @file td_graph.h
+ *
+ * @brief Time-dependent road graph with earliest-arrival queries.
+ *
+ * Loads the traffic_routes.json shape used by the Pylandia exercise:
+ *
+ *     { "HHMM" : { "from street" : { "to street" : minutes, ... }, ... } }
+ *
+ * Each "HHMM" key starts a time bucket that lasts until the next key, and
+ * the day wraps, so "2400" is the same as "0000". Every street pair that
+ * appears in any bucket becomes one CSR edge holding one travel time per
+ * bucket; a pair missing from a bucket is closed during that bucket.
+ *
+ * Travel time depends on the departure minute, so a query returns the
+ * earliest arrival time rather than a fixed distance. Drivers may wait at
+ * an intersection for a faster bucket to begin. That makes every edge FIFO
+ * (leaving later never arrives earlier) and lets a single Dijkstra pass
+ * answer the query exactly.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef TD_GRAPH_H
+#define TD_GRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../Thread_Pool/thread_pool.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define TD_GRAPH_SUCCESS      (0)
+#define TD_GRAPH_ERROR_PARAM  (-1)
+#define TD_GRAPH_ERROR_MEMORY (-2)
+
+#define TD_MINUTES_PER_DAY    (1440u)
+#define TD_NO_VERTEX          (UINT32_MAX)
+#define TD_INFINITY           (UINT32_MAX)
+#define TD_MAX_WORKERS        (64)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Travel time of one edge during one bucket */
+typedef struct
+{
+    uint32_t travel; /* Minutes when leaving inside the bucket, or TD_INFINITY */
+    uint32_t later;  /* Best arrival, counted from the end of the bucket, when
+                        waiting for a later bucket instead */
+} td_weight_t;
+
+/* Time-bucketed CSR graph */
+typedef struct
+{
+    uint32_t      num_vertices;   /* Number of streets */
+    uint32_t      num_edges;      /* Number of street pairs */
+    uint32_t      num_buckets;    /* Number of time buckets */
+    uint32_t *    p_bucket_start; /* Start minute of each bucket, ascending */
+    uint16_t *    p_minute_bucket; /* Bucket of every minute of the day */
+    uint16_t *    p_minute_left;  /* Minutes until the next bucket begins */
+    uint32_t *    p_offsets;      /* num_vertices + 1 out-edge offsets */
+    uint32_t *    p_targets;      /* Out-edge targets */
+    td_weight_t * p_weights;      /* num_buckets weights per edge */
+    char *        p_names;        /* NUL terminated street names */
+    uint32_t *    p_name_offsets; /* Offset of each name in p_names */
+    uint32_t *    p_name_index;   /* Open addressing table of vertex ids */
+    uint32_t      name_mask;      /* Table size - 1 */
+} td_graph_t;
+
+/* Per-thread search state, reusable across queries on one graph */
+typedef struct td_workspace td_workspace_t;
+
+/* One query of a batch */
+typedef struct
+{
+    uint32_t source;  /* Start vertex */
+    uint32_t target;  /* Destination vertex */
+    uint32_t depart;  /* Departure minute of the day */
+    uint32_t arrival; /* Out: arrival minute (may pass 1440) or TD_INFINITY */
+} td_query_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Builds a graph from JSON text.
+ *
+ * Travel times are rounded to whole minutes and must not be negative.
+ * Repeated keys keep the last value, as Python's json module does.
+ *
+ * @param[in] p_text JSON text (need not be NUL terminated)
+ * @param[in] length Number of bytes in p_text
+ *
+ * @return Pointer to the new graph, or NULL on malformed input or
+ *         allocation failure
+ */
+td_graph_t *
+td_graph_parse(const char * p_text, size_t length);
+
+/*!
+ * @brief Reads and parses a JSON file.
+ *
+ * @param[in] p_path Path to the file
+ *
+ * @return Pointer to the new graph, or NULL on failure
+ */
+td_graph_t *
+td_graph_load(const char * p_path);
+
+/*!
+ * @brief Looks up a street by name.
+ *
+ * @param[in] p_graph Graph
+ * @param[in] p_name  Street name
+ *
+ * @return Vertex id, or TD_NO_VERTEX if the street is unknown
+ */
+uint32_t
+td_graph_find(const td_graph_t * p_graph, const char * p_name);
+
+/*!
+ * @brief Gets the name of a street.
+ *
+ * @param[in] p_graph Graph
+ * @param[in] vertex  Vertex id
+ *
+ * @return Street name, or NULL for an invalid vertex
+ */
+const char *
+td_graph_name(const td_graph_t * p_graph, uint32_t vertex);
+
+/*!
+ * @brief Frees a graph and all of its arrays.
+ *
+ * @param[in,out] pp_graph Pointer to the graph pointer; set to NULL
+ */
+void
+td_graph_destroy(td_graph_t ** pp_graph);
+
+/*!
+ * @brief Allocates search state sized for a graph.
+ *
+ * @param[in] p_graph Graph the workspace will be used with
+ *
+ * @return Pointer to the new workspace, or NULL on failure
+ */
+td_workspace_t *
+td_workspace_create(const td_graph_t * p_graph);
+
+/*!
+ * @brief Frees a workspace.
+ *
+ * @param[in,out] pp_work Pointer to the workspace pointer; set to NULL
+ */
+void
+td_workspace_destroy(td_workspace_t ** pp_work);
+
+/*!
+ * @brief Earliest arrival from source to target when leaving at depart.
+ *
+ * @param[in]     p_graph   Graph
+ * @param[in,out] p_work    Workspace created for p_graph
+ * @param[in]     source    Start vertex
+ * @param[in]     target    Destination vertex
+ * @param[in]     depart    Departure minute of the day (0..1439)
+ * @param[out]    p_arrival Arrival minute counted from the same midnight
+ *                          as depart, or TD_INFINITY if unreachable
+ *
+ * @return TD_GRAPH_SUCCESS on success, TD_GRAPH_ERROR_PARAM on bad input
+ */
+int
+td_earliest_arrival(const td_graph_t * p_graph,
+                    td_workspace_t *   p_work,
+                    uint32_t           source,
+                    uint32_t           target,
+                    uint32_t           depart,
+                    uint32_t *         p_arrival);
+
+/*!
+ * @brief Copies the route found by the last td_earliest_arrival call.
+ *
+ * @param[in]  p_work   Workspace used for the query
+ * @param[out] p_path   Vertex ids from source to target
+ * @param[in]  capacity Number of entries p_path can hold
+ *
+ * @return Number of vertices on the route (0 if the target was not
+ *         reached); only min(return, capacity) entries are written
+ */
+uint32_t
+td_workspace_path(const td_workspace_t * p_work,
+                  uint32_t *             p_path,
+                  uint32_t               capacity);
+
+/*!
+ * @brief Answers many queries in parallel.
+ *
+ * Each worker owns one workspace and claims queries in small chunks, so
+ * long and short queries balance out across workers.
+ *
+ * @param[in]     p_graph     Graph
+ * @param[in]     p_pool      Thread pool (NULL runs serially)
+ * @param[in]     num_workers Tasks to split the batch over
+ *                            (1..TD_MAX_WORKERS)
+ * @param[in,out] p_queries   Queries; arrival is filled in
+ * @param[in]     count       Number of queries
+ *
+ * @return TD_GRAPH_SUCCESS on success, negative error code on failure
+ */
+int
+td_batch(const td_graph_t * p_graph,
+         thread_pool_t *    p_pool,
+         uint32_t           num_workers,
+         td_query_t *       p_queries,
+         size_t             count);
+
+#endif /* TD_GRAPH_H */
+
+/*** end of file ***/
@@ -0,0 +1,175 @@
+/** @file intern.h
+ *
+ * @brief Thread-safe string interning: one canonical copy of each string,
+ *        with a stable 32-bit id.
+ *
+ * Interning a string returns a pointer to the pool's own copy of it. Equal
+ * strings always give the same pointer, so once both sides are interned,
+ * string equality is a pointer compare and the string's hash, length and
+ * id are read from just in front of it instead of being worked out again.
+ * The copy is NUL-terminated and can be used anywhere a const char * can.
+ * It stays valid, at the same address, until the pool is destroyed;
+ * strings are never removed.
+ *
+ * The copies are packed into an append-only arena of large chunks, so a
+ * string costs its bytes plus a 12-byte header rather than a malloc block
+ * per copy. The index is split into INTERN_SHARDS shards by hash, each
+ * with its own lock, so threads interning different strings rarely wait
+ * for each other. intern_lookup() turns an id back into the string
+ * without taking a lock.
+ *
+ * intern_key_hash() and intern_key_equals() are hash_table_t callbacks for
+ * tables keyed by interned strings; no key_copy is needed, as the pool
+ * owns the bytes.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define INTERN_NONE      (0u)           /* Not an id: no string, or failure */
+#define INTERN_MAX_IDS   (1u << 26)     /* Strings one pool can hold */
+#define INTERN_MAX_LEN   (UINT32_MAX / 2u)
+#define INTERN_SHARDS    (16u)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct intern_pool intern_pool_t;
+
+/* Totals from intern_stats() */
+typedef struct
+{
+    uint32_t strings;      /* Distinct strings */
+    size_t   string_bytes; /* Their lengths, plus a NUL each */
+    size_t   arena_bytes;  /* Chunk memory holding them, with headers */
+    size_t   index_bytes;  /* Hash index and id directory */
+} intern_stats_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty pool.
+ *
+ * @param[in] expected Number of strings to size the index for; it grows
+ *                     past this as needed
+ *
+ * @return Pointer to the pool, or NULL on failure
+ */
+intern_pool_t *
+intern_create(uint32_t expected);
+
+/*!
+ * @brief Frees the pool and every string in it. No thread may be using the
+ *        pool or any of its strings.
+ *
+ * @param[in,out] pp_pool Pointer to the pool pointer; set to NULL
+ */
+void
+intern_destroy(intern_pool_t ** pp_pool);
+
+/*!
+ * @brief Interns len bytes, which need not be NUL-terminated and may
+ *        contain NULs.
+ *
+ * @param[in,out] p_pool  Pool
+ * @param[in]     p_bytes Bytes to intern (may be NULL if len is 0)
+ * @param[in]     len     Number of bytes, at most INTERN_MAX_LEN
+ *
+ * @return Canonical copy, or NULL on failure
+ */
+const char *
+intern_bytes(intern_pool_t * p_pool, const char * p_bytes, size_t len);
+
+/*!
+ * @brief Interns a NUL-terminated string.
+ *
+ * @return Canonical copy, or NULL on failure
+ */
+const char *
+intern_string(intern_pool_t * p_pool, const char * p_str);
+
+/*!
+ * @brief Interns len bytes and returns the id of the canonical copy.
+ *
+ * @return Id, or INTERN_NONE on failure
+ */
+uint32_t
+intern_id(intern_pool_t * p_pool, const char * p_bytes, size_t len);
+
+/*!
+ * @brief Finds the canonical copy of len bytes without adding it.
+ *
+ * @details A string that was never interned cannot equal any interned
+ *          one, so a NULL result answers an equality search on its own.
+ *
+ * @return Canonical copy, or NULL if the bytes were never interned
+ */
+const char *
+intern_find(intern_pool_t * p_pool, const char * p_bytes, size_t len);
+
+/*!
+ * @brief Returns the string with the given id. Takes no lock.
+ *
+ * @return Canonical copy, or NULL if no string has this id
+ */
+const char *
+intern_lookup(const intern_pool_t * p_pool, uint32_t id);
+
+/*!
+ * @brief Id of a canonical copy. p_str must have come from a pool.
+ */
+uint32_t
+intern_id_of(const char * p_str);
+
+/*!
+ * @brief 32-bit hash of a canonical copy, computed when it was interned.
+ */
+uint32_t
+intern_hash_of(const char * p_str);
+
+/*!
+ * @brief Length in bytes of a canonical copy, not counting its NUL.
+ */
+size_t
+intern_length_of(const char * p_str);
+
+/*!
+ * @brief hash_table_t hash callback for interned keys: the stored hash,
+ *        reduced to the capacity.
+ */
+uint32_t
+intern_key_hash(const void * p_key, uint32_t capacity);
+
+/*!
+ * @brief hash_table_t equality callback for interned keys: a pointer
+ *        compare.
+ */
+bool
+intern_key_equals(const void * p_key1, const void * p_key2);
+
+/*!
+ * @brief Sums the pool's memory use. Takes each shard's lock in turn.
+ *
+ * @param[in]  p_pool  Pool
+ * @param[out] p_stats Totals
+ */
+void
+intern_stats(intern_pool_t * p_pool, intern_stats_t * p_stats);
+
+#endif /* INTERN_H */
+
+/*** end of file ***/
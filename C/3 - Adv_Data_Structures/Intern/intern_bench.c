@@ -0,0 +1,434 @@
+/** @file intern_bench.c
+ *
+ * @brief Key-heavy workloads with copied strings and with interned ones.
+ *
+ * NAMES distinct names, 10 to 40 bytes long, are referenced REFS times in
+ * random order, as the keys of parsed records are. The references are
+ * stored two ways:
+ *
+ * - copied: one strdup() per reference, as hash_table_t's key_copy,
+ *   the Patricia trie and the airport loader do today;
+ * - interned: one intern_string() per reference, sharing one copy of
+ *   each name.
+ *
+ * Reported are the bytes and string copies each way takes, and the time to
+ * store the references on one thread and on several. Then a hash_table_t
+ * counting references per name is run both ways: keyed by strings, with
+ * a string hash and strcmp(), and keyed by interned pointers, with the
+ * stored hash and a pointer compare.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L intern_bench.c
+ *        intern.c "../../1 - Basic_Data_Structures/5 - Hash_Table/hash_table.c"
+ *        "../../1 - Basic_Data_Structures/0 - Allocator/allocator.c"
+ *        -pthread
+ *
+ * Usage: intern_bench [names] [refs] [threads]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "intern.h"
+#include "../../1 - Basic_Data_Structures/5 - Hash_Table/hash_table.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_NAMES    (200000u)
+#define DEFAULT_REFS     (5000000u)
+#define DEFAULT_THREADS  (4u)
+#define MAX_THREADS      (64u)
+#define NAME_MIN         (10u)
+#define NAME_MAX         (40u)
+#define MALLOC_OVERHEAD  (16u)  /* Typical header and rounding per block */
+#define SEED             (0x9E3779B97F4A7C15ull)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+typedef struct
+{
+    intern_pool_t * p_pool;
+    char **         pp_names;
+    const uint32_t * p_refs;
+    const char **   pp_out;
+    uint32_t        first;
+    uint32_t        count;
+} worker_arg_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static pthread_t    g_threads[MAX_THREADS];
+static worker_arg_t g_args[MAX_THREADS];
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint64_t next_random(uint64_t * p_state);
+static char **  make_names(uint32_t names);
+static void *   worker(void * p_arg);
+static double   intern_threads(intern_pool_t * p_pool,
+                               char **         pp_names,
+                               const uint32_t * p_refs,
+                               const char **   pp_out,
+                               uint32_t        refs,
+                               uint32_t        thread_count);
+static uint32_t hash_string(const void * p_key, uint32_t capacity);
+static bool     strings_equal(const void * p_lhs, const void * p_rhs);
+static void *   copy_string(const void * p_key);
+static double   count_refs(hash_table_t *      p_table,
+                           const char * const * pp_keys,
+                           uint32_t            refs);
+static double   now_seconds(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t names        = DEFAULT_NAMES;
+    uint32_t refs         = DEFAULT_REFS;
+    uint32_t thread_count = DEFAULT_THREADS;
+    uint64_t state        = SEED;
+
+    if (argc > 1)
+    {
+        names = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        refs = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        thread_count = (uint32_t)strtoul(argv[3], NULL, 10);
+    }
+
+    if ((0u == names) || (0u == refs) || (0u == thread_count)
+        || (thread_count > MAX_THREADS))
+    {
+        fprintf(stderr, "usage: intern_bench [names] [refs] [threads 1-%u]\n",
+                MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    char **       pp_names  = make_names(names);
+    uint32_t *    p_refs    = malloc((size_t)refs * sizeof(uint32_t));
+    char **       pp_copies = malloc((size_t)refs * sizeof(char *));
+    const char ** pp_interned = malloc((size_t)refs * sizeof(char *));
+
+    if ((NULL == pp_names) || (NULL == p_refs) || (NULL == pp_copies)
+        || (NULL == pp_interned))
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t ref = 0; ref < refs; ref++)
+    {
+        p_refs[ref] = (uint32_t)(next_random(&state) % names);
+    }
+
+    printf("%u names referenced %u times\n\n", names, refs);
+
+    // Copied: one block per reference
+    size_t copy_bytes = 0;
+    double start      = now_seconds();
+
+    for (uint32_t ref = 0; ref < refs; ref++)
+    {
+        const char * p_name = pp_names[p_refs[ref]];
+        size_t       len    = strlen(p_name) + 1u;
+
+        pp_copies[ref] = malloc(len);
+        if (NULL == pp_copies[ref])
+        {
+            fprintf(stderr, "out of memory\n");
+            return EXIT_FAILURE;
+        }
+        memcpy(pp_copies[ref], p_name, len);
+        copy_bytes += len;
+    }
+
+    double copy_s = now_seconds() - start;
+
+    // Interned, spread over threads; checked, then redone on one thread
+    intern_pool_t * p_pool   = intern_create(names);
+    double          shared_s = intern_threads(p_pool, pp_names, p_refs,
+                                              pp_interned, refs, thread_count);
+
+    for (uint32_t ref = 0; ref < refs; ref++)
+    {
+        if (pp_interned[ref] != intern_find(p_pool, pp_copies[ref],
+                                            strlen(pp_copies[ref])))
+        {
+            fprintf(stderr, "reference %u not canonical\n", ref);
+            return EXIT_FAILURE;
+        }
+    }
+
+    intern_destroy(&p_pool);
+    p_pool = intern_create(names);
+
+    double         one_s = intern_threads(p_pool, pp_names, p_refs,
+                                          pp_interned, refs, 1u);
+    intern_stats_t stats;
+
+    intern_stats(p_pool, &stats);
+
+    size_t copy_total   = copy_bytes + ((size_t)refs * MALLOC_OVERHEAD);
+    size_t intern_total = stats.arena_bytes + stats.index_bytes;
+
+    printf("storage        bytes       copies   time     rate\n");
+    printf("  copied   %10.1f MiB %9u %7.3f s %6.1f M/s\n",
+           (double)copy_total / (1024.0 * 1024.0), refs, copy_s,
+           refs / copy_s / 1e6);
+    printf("  interned %10.1f MiB %9u %7.3f s %6.1f M/s  (1 thread)\n",
+           (double)intern_total / (1024.0 * 1024.0), stats.strings, one_s,
+           refs / one_s / 1e6);
+    printf("  interned %28s %7.3f s %6.1f M/s  (%u threads)\n", "", shared_s,
+           refs / shared_s / 1e6, thread_count);
+    printf("  saved %.1f%%: %zu string bytes for %u names, arena %zu, "
+           "index %zu\n\n",
+           100.0 * (1.0 - (double)intern_total / (double)copy_total),
+           stats.string_bytes, stats.strings, stats.arena_bytes,
+           stats.index_bytes);
+
+    // Counting references per name in a hash table, keyed both ways
+    hash_table_t by_string;
+    hash_table_t by_pointer;
+
+    if (!hash_table_init(&by_string, names, 0.75f, hash_string, strings_equal,
+                         copy_string, free)
+        || !hash_table_init(&by_pointer, names, 0.75f, intern_key_hash,
+                            intern_key_equals, NULL, NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    double string_s  = count_refs(&by_string, (const char * const *)pp_copies,
+                                  refs);
+    double pointer_s = count_refs(&by_pointer, pp_interned, refs);
+
+    printf("hash table count  time     ns/ref\n");
+    printf("  string keys  %7.3f s %8.1f\n", string_s, string_s * 1e9 / refs);
+    printf("  interned     %7.3f s %8.1f  (%.2fx)\n", pointer_s,
+           pointer_s * 1e9 / refs, string_s / pointer_s);
+
+    hash_table_destroy(&by_string, true);
+    hash_table_destroy(&by_pointer, true);
+    intern_destroy(&p_pool);
+
+    for (uint32_t ref = 0; ref < refs; ref++)
+    {
+        free(pp_copies[ref]);
+    }
+
+    for (uint32_t name = 0; name < names; name++)
+    {
+        free(pp_names[name]);
+    }
+
+    free(pp_names);
+    free(p_refs);
+    free(pp_copies);
+    free((void *)pp_interned);
+
+    return EXIT_SUCCESS;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static uint64_t
+next_random(uint64_t * p_state)
+{
+    uint64_t value = (*p_state += 0x9E3779B97F4A7C15ull);
+
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/*!
+ * @brief Distinct names of NAME_MIN to NAME_MAX bytes: a random lowercase
+ *        stem and the name's number, so no two are equal.
+ */
+static char **
+make_names(uint32_t names)
+{
+    char **  pp_names = calloc(names, sizeof(char *));
+    uint64_t state    = SEED ^ names;
+
+    if (NULL == pp_names)
+    {
+        return NULL;
+    }
+
+    for (uint32_t name = 0; name < names; name++)
+    {
+        char   text[NAME_MAX + 16u];
+        char   tail[16];
+        size_t tail_len = (size_t)snprintf(tail, sizeof(tail), ".%u", name);
+        size_t len      = NAME_MIN + (size_t)(next_random(&state)
+                                              % (NAME_MAX - NAME_MIN + 1u));
+        size_t stem     = (len > tail_len) ? (len - tail_len) : 1u;
+
+        for (size_t idx = 0; idx < stem; idx++)
+        {
+            text[idx] = (char)('a' + (next_random(&state) % 26u));
+        }
+        memcpy(&text[stem], tail, tail_len + 1u);
+
+        pp_names[name] = malloc(strlen(text) + 1u);
+        if (NULL == pp_names[name])
+        {
+            return NULL;
+        }
+        strcpy(pp_names[name], text);
+    }
+
+    return pp_names;
+}
+
+static void *
+worker(void * p_arg)
+{
+    worker_arg_t * p_work = p_arg;
+
+    for (uint32_t ref = p_work->first; ref < (p_work->first + p_work->count);
+         ref++)
+    {
+        p_work->pp_out[ref] = intern_string(p_work->p_pool,
+                                            p_work->pp_names[p_work->p_refs[ref]]);
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief Interns every reference, split evenly over thread_count threads.
+ *
+ * @return Seconds taken
+ */
+static double
+intern_threads(intern_pool_t * p_pool,
+               char **         pp_names,
+               const uint32_t * p_refs,
+               const char **   pp_out,
+               uint32_t        refs,
+               uint32_t        thread_count)
+{
+    double   start = now_seconds();
+    uint32_t share = refs / thread_count;
+
+    for (uint32_t id = 0; id < thread_count; id++)
+    {
+        g_args[id].p_pool   = p_pool;
+        g_args[id].pp_names = pp_names;
+        g_args[id].p_refs   = p_refs;
+        g_args[id].pp_out   = pp_out;
+        g_args[id].first    = id * share;
+        g_args[id].count    = (id + 1u == thread_count) ? (refs - id * share)
+                                                        : share;
+        (void)pthread_create(&g_threads[id], NULL, worker, &g_args[id]);
+    }
+
+    for (uint32_t id = 0; id < thread_count; id++)
+    {
+        (void)pthread_join(g_threads[id], NULL);
+    }
+
+    return now_seconds() - start;
+}
+
+/* FNV-1a, as a string-keyed table would use */
+static uint32_t
+hash_string(const void * p_key, uint32_t capacity)
+{
+    uint32_t hash = 2166136261u;
+
+    for (const unsigned char * p_char = p_key; '\0' != *p_char; p_char++)
+    {
+        hash = (hash ^ *p_char) * 16777619u;
+    }
+
+    return hash % capacity;
+}
+
+static bool
+strings_equal(const void * p_lhs, const void * p_rhs)
+{
+    return 0 == strcmp(p_lhs, p_rhs);
+}
+
+static void *
+copy_string(const void * p_key)
+{
+    size_t len    = strlen(p_key) + 1u;
+    void * p_copy = malloc(len);
+
+    if (NULL != p_copy)
+    {
+        memcpy(p_copy, p_key, len);
+    }
+
+    return p_copy;
+}
+
+/*!
+ * @brief Counts the references to each key in p_table.
+ *
+ * @return Seconds taken
+ */
+static double
+count_refs(hash_table_t * p_table, const char * const * pp_keys, uint32_t refs)
+{
+    double start = now_seconds();
+
+    for (uint32_t ref = 0; ref < refs; ref++)
+    {
+        uint64_t * p_count = hash_table_get(p_table, pp_keys[ref]);
+
+        if (NULL == p_count)
+        {
+            p_count = calloc(1u, sizeof(uint64_t));
+            if (NULL == p_count)
+            {
+                break;
+            }
+            (void)hash_table_put(p_table, pp_keys[ref], p_count);
+        }
+
+        (*p_count)++;
+    }
+
+    return now_seconds() - start;
+}
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/*** end of file ***/
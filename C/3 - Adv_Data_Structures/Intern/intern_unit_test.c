@@ -0,0 +1,222 @@
+#include <check.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+
+#define MANY_STRINGS (100000u)
+#define THREADS      (4u)
+#define SHARED       (10000u)
+
+typedef struct
+{
+    intern_pool_t * p_pool;
+    uint32_t        offset;    /* Where this thread starts */
+    const char **   pp_copies; /* Copy of string i at index i */
+} intern_worker_t;
+
+static uint32_t
+make_key(char * p_buf, size_t size, uint32_t idx)
+{
+    return (uint32_t)snprintf(p_buf, size, "string-%u", idx);
+}
+
+// Interns the shared strings, each thread starting at a different one
+static void *
+intern_worker(void * p_arg)
+{
+    intern_worker_t * p_work = p_arg;
+    char              key[32];
+
+    for (uint32_t step = 0; step < SHARED; step++)
+    {
+        uint32_t idx = (p_work->offset + step) % SHARED;
+        uint32_t len = make_key(key, sizeof(key), idx);
+
+        p_work->pp_copies[idx] = intern_bytes(p_work->p_pool, key, len);
+    }
+
+    return NULL;
+}
+
+START_TEST(test_pointer_identity)
+{
+    intern_pool_t * p_pool   = intern_create(16);
+    char            first[]  = "hello";
+    char            second[] = "hello";
+
+    ck_assert_ptr_nonnull(p_pool);
+    ck_assert_ptr_null(intern_find(p_pool, "hello", 5));
+
+    const char * p_copy = intern_string(p_pool, first);
+    ck_assert_ptr_nonnull(p_copy);
+    ck_assert_ptr_ne(p_copy, first);
+    ck_assert_str_eq(p_copy, "hello");
+
+    // Equal bytes from anywhere give the same copy
+    ck_assert_ptr_eq(intern_string(p_pool, second), p_copy);
+    ck_assert_ptr_eq(intern_bytes(p_pool, "hello, world", 5), p_copy);
+    ck_assert_ptr_eq(intern_find(p_pool, second, 5), p_copy);
+    ck_assert_uint_eq(intern_length_of(p_copy), 5);
+
+    // Different bytes, a prefix, or embedded NULs give different copies
+    const char * p_hell = intern_bytes(p_pool, "hello", 4);
+    const char * p_nul  = intern_bytes(p_pool, "hello\0x", 7);
+    ck_assert_ptr_ne(p_hell, p_copy);
+    ck_assert_ptr_ne(p_nul, p_copy);
+    ck_assert_uint_eq(intern_length_of(p_nul), 7);
+    ck_assert_mem_eq(p_nul, "hello\0x", 8);
+
+    // The empty string is a string like any other
+    const char * p_empty = intern_bytes(p_pool, NULL, 0);
+    ck_assert_ptr_nonnull(p_empty);
+    ck_assert_ptr_eq(intern_string(p_pool, ""), p_empty);
+
+    ck_assert(intern_key_equals(p_copy, intern_string(p_pool, "hello")));
+    ck_assert(!intern_key_equals(p_copy, p_hell));
+    ck_assert_uint_eq(intern_key_hash(p_copy, 1024),
+                      intern_hash_of(p_copy) % 1024);
+
+    intern_destroy(&p_pool);
+    ck_assert_ptr_null(p_pool);
+}
+END_TEST
+
+START_TEST(test_id_round_trip)
+{
+    // Sized far too small, so the index and id directory grow
+    intern_pool_t * p_pool  = intern_create(16);
+    const char **   pp_copy = calloc(MANY_STRINGS, sizeof(char *));
+    uint32_t *      p_ids   = calloc(MANY_STRINGS, sizeof(uint32_t));
+    char            key[32];
+
+    ck_assert_ptr_nonnull(p_pool);
+    ck_assert_ptr_nonnull(pp_copy);
+    ck_assert_ptr_nonnull(p_ids);
+
+    for (uint32_t idx = 0; idx < MANY_STRINGS; idx++)
+    {
+        uint32_t len = make_key(key, sizeof(key), idx);
+
+        p_ids[idx] = intern_id(p_pool, key, len);
+        ck_assert_uint_ne(p_ids[idx], INTERN_NONE);
+        pp_copy[idx] = intern_lookup(p_pool, p_ids[idx]);
+        ck_assert_ptr_nonnull(pp_copy[idx]);
+        ck_assert_str_eq(pp_copy[idx], key);
+    }
+
+    // Ids are distinct, stable, and map back and forth
+    for (uint32_t idx = 0; idx < MANY_STRINGS; idx++)
+    {
+        uint32_t len = make_key(key, sizeof(key), idx);
+
+        ck_assert_uint_eq(intern_id(p_pool, key, len), p_ids[idx]);
+        ck_assert_uint_eq(intern_id_of(pp_copy[idx]), p_ids[idx]);
+        ck_assert_ptr_eq(intern_lookup(p_pool, p_ids[idx]), pp_copy[idx]);
+        ck_assert_ptr_eq(intern_string(p_pool, key), pp_copy[idx]);
+        if (idx > 0)
+        {
+            ck_assert_uint_ne(p_ids[idx], p_ids[idx - 1]);
+        }
+    }
+
+    ck_assert_ptr_null(intern_lookup(p_pool, INTERN_NONE));
+    ck_assert_ptr_null(intern_lookup(p_pool, INTERN_MAX_IDS - 1));
+
+    intern_stats_t stats;
+    intern_stats(p_pool, &stats);
+    ck_assert_uint_eq(stats.strings, MANY_STRINGS);
+    ck_assert_uint_ge(stats.arena_bytes, stats.string_bytes);
+
+    free(p_ids);
+    free(pp_copy);
+    intern_destroy(&p_pool);
+}
+END_TEST
+
+START_TEST(test_concurrent_intern)
+{
+    intern_pool_t * p_pool = intern_create(64);
+    intern_worker_t workers[THREADS];
+    pthread_t       threads[THREADS];
+
+    ck_assert_ptr_nonnull(p_pool);
+
+    for (uint32_t idx = 0; idx < THREADS; idx++)
+    {
+        workers[idx].p_pool    = p_pool;
+        workers[idx].offset    = idx * (SHARED / THREADS);
+        workers[idx].pp_copies = calloc(SHARED, sizeof(char *));
+        ck_assert_ptr_nonnull(workers[idx].pp_copies);
+        ck_assert_int_eq(
+            pthread_create(&threads[idx], NULL, intern_worker, &workers[idx]),
+            0);
+    }
+    for (uint32_t idx = 0; idx < THREADS; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+
+    // Racing threads still agree on one copy per string
+    for (uint32_t str = 0; str < SHARED; str++)
+    {
+        ck_assert_ptr_nonnull(workers[0].pp_copies[str]);
+        for (uint32_t idx = 1; idx < THREADS; idx++)
+        {
+            ck_assert_ptr_eq(workers[idx].pp_copies[str],
+                             workers[0].pp_copies[str]);
+        }
+    }
+
+    intern_stats_t stats;
+    intern_stats(p_pool, &stats);
+    ck_assert_uint_eq(stats.strings, SHARED);
+
+    for (uint32_t idx = 0; idx < THREADS; idx++)
+    {
+        free(workers[idx].pp_copies);
+    }
+    intern_destroy(&p_pool);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+intern_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Intern");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_pointer_identity);
+    tcase_add_test(tc_core, test_id_round_trip);
+    tcase_add_test(tc_core, test_concurrent_intern);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = intern_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
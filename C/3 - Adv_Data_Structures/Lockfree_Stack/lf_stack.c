@@ -0,0 +1,326 @@
+/** @file lf_stack.c
+ *
+ * @brief Implementation of the tagged-index lock-free stack.
+ *
+ * The head word is (tag << 32) | index, with LFSTACK_NONE as the index of
+ * an empty stack. p_next[i] is the index below i while i is on the stack.
+ * Both are only touched through __atomic builtins, since a thread that
+ * lost a race may still read a link another thread is rewriting; the CAS
+ * on the head then fails and the value read is discarded.
+ *
+ * Every successful CAS is acquire-release, so each one carries the links
+ * written before all earlier ones. A pop that loads the head with acquire
+ * can therefore follow links several entries deep, which is what lets a
+ * magazine take a whole chain in one CAS.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "lf_stack.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define CACHE_LINE     (64u)
+#define MAGAZINE_HALF  (LFSTACK_MAGAZINE_SIZE / 2u)
+
+#define HEAD_INDEX(head) ((uint32_t)((head) & 0xFFFFFFFFu))
+#define HEAD_TAG(head)   ((uint32_t)((head) >> 32))
+#define HEAD_MAKE(tag, index) \
+    (((uint64_t)(tag) << 32) | (uint64_t)(index))
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* Allocated cache-line aligned; the head gets a line to itself so that
+   threads spinning on it do not also evict capacity and p_next. */
+struct lfstack
+{
+    uint64_t   head;
+    uint8_t    pad[CACHE_LINE - sizeof(uint64_t)];
+    uint32_t   capacity;
+    uint32_t * p_next;
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void     push_chain(lfstack_t * p_stack, uint32_t first, uint32_t last);
+static uint32_t pop_chain(lfstack_t * p_stack,
+                          uint32_t *  p_out,
+                          uint32_t    max_count);
+static void     spill(lfstack_magazine_t * p_magazine, uint32_t count);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+lfstack_t *
+lfstack_create(uint32_t capacity, bool b_full)
+{
+    lfstack_t * p_stack = NULL;
+
+    if ((0u == capacity) || (capacity > LFSTACK_MAX_CAPACITY))
+    {
+        return NULL;
+    }
+
+    if (0 != posix_memalign((void **)&p_stack, CACHE_LINE, sizeof(*p_stack)))
+    {
+        return NULL;
+    }
+
+    memset(p_stack, 0, sizeof(*p_stack));
+    p_stack->capacity = capacity;
+    p_stack->p_next   = malloc((size_t)capacity * sizeof(uint32_t));
+
+    if (NULL == p_stack->p_next)
+    {
+        free(p_stack);
+        return NULL;
+    }
+
+    if (b_full)
+    {
+        for (uint32_t index = 0u; index < capacity; index++)
+        {
+            p_stack->p_next[index]
+                = (index + 1u < capacity) ? (index + 1u) : LFSTACK_NONE;
+        }
+
+        p_stack->head = HEAD_MAKE(0u, 0u);
+    }
+    else
+    {
+        for (uint32_t index = 0u; index < capacity; index++)
+        {
+            p_stack->p_next[index] = LFSTACK_NONE;
+        }
+
+        p_stack->head = HEAD_MAKE(0u, LFSTACK_NONE);
+    }
+
+    return p_stack;
+}
+
+void
+lfstack_destroy(lfstack_t ** pp_stack)
+{
+    if ((NULL == pp_stack) || (NULL == *pp_stack))
+    {
+        return;
+    }
+
+    free((*pp_stack)->p_next);
+    free(*pp_stack);
+    *pp_stack = NULL;
+}
+
+int
+lfstack_push(lfstack_t * p_stack, uint32_t index)
+{
+    if ((NULL == p_stack) || (index >= p_stack->capacity))
+    {
+        return LFSTACK_ERROR_PARAM;
+    }
+
+    push_chain(p_stack, index, index);
+    return LFSTACK_SUCCESS;
+}
+
+uint32_t
+lfstack_pop(lfstack_t * p_stack)
+{
+    uint32_t index = LFSTACK_NONE;
+
+    if (NULL == p_stack)
+    {
+        return LFSTACK_NONE;
+    }
+
+    (void)pop_chain(p_stack, &index, 1u);
+    return index;
+}
+
+uint32_t
+lfstack_capacity(const lfstack_t * p_stack)
+{
+    return (NULL == p_stack) ? 0u : p_stack->capacity;
+}
+
+int
+lfstack_magazine_init(lfstack_magazine_t * p_magazine, lfstack_t * p_stack)
+{
+    if ((NULL == p_magazine) || (NULL == p_stack))
+    {
+        return LFSTACK_ERROR_PARAM;
+    }
+
+    p_magazine->p_stack = p_stack;
+    p_magazine->count   = 0u;
+    return LFSTACK_SUCCESS;
+}
+
+uint32_t
+lfstack_magazine_pop(lfstack_magazine_t * p_magazine)
+{
+    if ((NULL == p_magazine) || (NULL == p_magazine->p_stack))
+    {
+        return LFSTACK_NONE;
+    }
+
+    if (0u == p_magazine->count)
+    {
+        p_magazine->count = pop_chain(p_magazine->p_stack,
+                                      p_magazine->slots,
+                                      MAGAZINE_HALF);
+
+        if (0u == p_magazine->count)
+        {
+            return LFSTACK_NONE;
+        }
+    }
+
+    p_magazine->count--;
+    return p_magazine->slots[p_magazine->count];
+}
+
+int
+lfstack_magazine_push(lfstack_magazine_t * p_magazine, uint32_t index)
+{
+    if ((NULL == p_magazine) || (NULL == p_magazine->p_stack)
+        || (index >= p_magazine->p_stack->capacity))
+    {
+        return LFSTACK_ERROR_PARAM;
+    }
+
+    if (LFSTACK_MAGAZINE_SIZE == p_magazine->count)
+    {
+        spill(p_magazine, MAGAZINE_HALF);
+    }
+
+    p_magazine->slots[p_magazine->count] = index;
+    p_magazine->count++;
+    return LFSTACK_SUCCESS;
+}
+
+void
+lfstack_magazine_flush(lfstack_magazine_t * p_magazine)
+{
+    if ((NULL == p_magazine) || (NULL == p_magazine->p_stack))
+    {
+        return;
+    }
+
+    spill(p_magazine, p_magazine->count);
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Pushes a chain already linked from first to last through p_next.
+ */
+static void
+push_chain(lfstack_t * p_stack, uint32_t first, uint32_t last)
+{
+    uint64_t old_head = __atomic_load_n(&p_stack->head, __ATOMIC_RELAXED);
+    uint64_t new_head = 0u;
+
+    do
+    {
+        __atomic_store_n(&p_stack->p_next[last],
+                         HEAD_INDEX(old_head),
+                         __ATOMIC_RELAXED);
+        new_head = HEAD_MAKE(HEAD_TAG(old_head) + 1u, first);
+    } while (!__atomic_compare_exchange_n(&p_stack->head,
+                                          &old_head,
+                                          new_head,
+                                          true,
+                                          __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+}
+
+/*!
+ * @brief Pops up to max_count indices in one CAS, top first.
+ *
+ * The links are followed before the CAS, so another thread may change
+ * them meanwhile. Any such change moves the tag, the CAS fails and the
+ * walk starts again from the new head.
+ *
+ * @return Number of indices written to p_out
+ */
+static uint32_t
+pop_chain(lfstack_t * p_stack, uint32_t * p_out, uint32_t max_count)
+{
+    uint64_t old_head = __atomic_load_n(&p_stack->head, __ATOMIC_ACQUIRE);
+    uint64_t new_head = 0u;
+    uint32_t count    = 0u;
+
+    do
+    {
+        uint32_t index = HEAD_INDEX(old_head);
+
+        count = 0u;
+
+        while ((count < max_count) && (LFSTACK_NONE != index))
+        {
+            p_out[count] = index;
+            count++;
+            index = __atomic_load_n(&p_stack->p_next[index], __ATOMIC_RELAXED);
+        }
+
+        if (0u == count)
+        {
+            return 0u;
+        }
+
+        new_head = HEAD_MAKE(HEAD_TAG(old_head) + 1u, index);
+    } while (!__atomic_compare_exchange_n(&p_stack->head,
+                                          &old_head,
+                                          new_head,
+                                          true,
+                                          __ATOMIC_ACQ_REL,
+                                          __ATOMIC_ACQUIRE));
+
+    return count;
+}
+
+/*!
+ * @brief Moves the oldest count entries of a magazine to the stack in one
+ *        CAS and keeps the most recently pushed ones, which are the most
+ *        likely to still be in this thread's cache.
+ */
+static void
+spill(lfstack_magazine_t * p_magazine, uint32_t count)
+{
+    lfstack_t * p_stack = p_magazine->p_stack;
+
+    if (0u == count)
+    {
+        return;
+    }
+
+    for (uint32_t slot = 0u; slot + 1u < count; slot++)
+    {
+        __atomic_store_n(&p_stack->p_next[p_magazine->slots[slot]],
+                         p_magazine->slots[slot + 1u],
+                         __ATOMIC_RELAXED);
+    }
+
+    push_chain(p_stack, p_magazine->slots[0], p_magazine->slots[count - 1u]);
+
+    p_magazine->count -= count;
+    memmove(p_magazine->slots,
+            &p_magazine->slots[count],
+            (size_t)p_magazine->count * sizeof(uint32_t));
+}
+
+/*** end of file ***/
@@ -0,0 +1,160 @@
+/** @file lf_stack.h
+ *
+ * @brief Lock-free LIFO free list of slot indices, with per-thread
+ *        magazines.
+ *
+ * An lfstack_t holds the indices 0 .. capacity-1 of objects the caller
+ * keeps in its own array, such as connection or buffer objects. It is a
+ * free list: a thread pops an index to take an object and pushes it back
+ * to return it. This is a Treiber stack, but its head is one 64-bit word
+ * holding a 32-bit index and a 32-bit tag, not a pointer. Every successful
+ * compare-and-swap bumps the tag, so a thread that read the head, was
+ * preempted while others popped and pushed the same index back, and then
+ * retries its CAS fails instead of corrupting the list (the ABA problem).
+ * The tag repeats only after 2^32 updates during one such preemption.
+ *
+ * The links live in an array the stack owns for its whole life. Reading
+ * the link of an index another thread has just popped therefore reads
+ * valid memory, and the tag makes the CAS built on that stale read fail.
+ * No node is ever freed while the stack exists, so hazard pointers or
+ * epochs are not needed.
+ *
+ * A magazine is a thread's private cache of up to LFSTACK_MAGAZINE_SIZE
+ * indices. Pops and pushes go to the magazine; only when it runs empty or
+ * full does it move half a magazine to or from the shared stack in one
+ * CAS. Most operations then never touch the shared head. A magazine must
+ * only be used by one thread at a time. Indices in a magazine cannot be
+ * popped by other threads, so flush it when the thread is done.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef LF_STACK_H
+#define LF_STACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define LFSTACK_SUCCESS       (0)
+#define LFSTACK_ERROR_PARAM   (-1)  /* NULL, or an index out of range */
+
+#define LFSTACK_NONE          (UINT32_MAX)  /* No index: the stack is empty */
+#define LFSTACK_MAX_CAPACITY  (UINT32_MAX - 1u)
+#define LFSTACK_MAGAZINE_SIZE (32u)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct lfstack lfstack_t;
+
+/* One thread's cache of indices; the fields are private */
+typedef struct
+{
+    lfstack_t * p_stack;
+    uint32_t    count;
+    uint32_t    slots[LFSTACK_MAGAZINE_SIZE];
+} lfstack_magazine_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Creates a stack of indices 0 .. capacity-1.
+ *
+ * @param[in] capacity Number of indices
+ * @param[in] b_full   true to start with every index on the stack (index 0
+ *                     on top), false to start empty
+ *
+ * @return Pointer to the stack, or NULL on failure
+ */
+lfstack_t *
+lfstack_create(uint32_t capacity, bool b_full);
+
+/*!
+ * @brief Frees the stack. No thread may be using it or a magazine of it.
+ *
+ * @param[in,out] pp_stack Pointer to the stack pointer; set to NULL
+ */
+void
+lfstack_destroy(lfstack_t ** pp_stack);
+
+/*!
+ * @brief Pushes an index. The index must not already be on the stack or in
+ *        a magazine.
+ *
+ * @param[in,out] p_stack Stack
+ * @param[in]     index   Index below the capacity
+ *
+ * @return LFSTACK_SUCCESS or LFSTACK_ERROR_PARAM
+ */
+int
+lfstack_push(lfstack_t * p_stack, uint32_t index);
+
+/*!
+ * @brief Pops the most recently pushed index.
+ *
+ * @param[in,out] p_stack Stack
+ *
+ * @return The index, or LFSTACK_NONE if the stack is empty
+ */
+uint32_t
+lfstack_pop(lfstack_t * p_stack);
+
+/*!
+ * @brief Number of indices the stack was created with.
+ */
+uint32_t
+lfstack_capacity(const lfstack_t * p_stack);
+
+/*!
+ * @brief Starts an empty magazine for the calling thread.
+ *
+ * @param[out] p_magazine Magazine
+ * @param[in]  p_stack    Stack it refills from and spills to
+ *
+ * @return LFSTACK_SUCCESS or LFSTACK_ERROR_PARAM
+ */
+int
+lfstack_magazine_init(lfstack_magazine_t * p_magazine, lfstack_t * p_stack);
+
+/*!
+ * @brief Pops an index, refilling the magazine from the stack when it is
+ *        empty.
+ *
+ * @param[in,out] p_magazine Magazine
+ *
+ * @return The index, or LFSTACK_NONE if the magazine and stack are empty
+ */
+uint32_t
+lfstack_magazine_pop(lfstack_magazine_t * p_magazine);
+
+/*!
+ * @brief Pushes an index, spilling half the magazine to the stack when it
+ *        is full.
+ *
+ * @param[in,out] p_magazine Magazine
+ * @param[in]     index      Index below the capacity
+ *
+ * @return LFSTACK_SUCCESS or LFSTACK_ERROR_PARAM
+ */
+int
+lfstack_magazine_push(lfstack_magazine_t * p_magazine, uint32_t index);
+
+/*!
+ * @brief Returns every index in the magazine to the stack.
+ *
+ * @param[in,out] p_magazine Magazine
+ */
+void
+lfstack_magazine_flush(lfstack_magazine_t * p_magazine);
+
+#endif /* LF_STACK_H */
+
+/*** end of file ***/
@@ -0,0 +1,359 @@
+/** @file lf_stack_bench.c
+ *
+ * @brief Object recycling through a mutexed stack_t and an lfstack_t.
+ *
+ * Every thread repeatedly takes HOLD objects from a shared free list,
+ * writes to them and gives them back, the way connection and buffer
+ * objects are recycled. The free list is, in turn:
+ *
+ * - a stack_t of object pointers behind a pthread mutex;
+ * - an lfstack_t of object indices, every take and give a CAS on the head;
+ * - the same lfstack_t reached through a per-thread magazine, so only one
+ *   take or give in LFSTACK_MAGAZINE_SIZE / 2 touches the head.
+ *
+ * After each run every object must be back on the list exactly once,
+ * which is checked before the result is printed.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L lf_stack_bench.c
+ *        lf_stack.c "../../1 - Basic_Data_Structures/3 - Stack/stack.c"
+ *        "../../1 - Basic_Data_Structures/10 - Deque/deque.c"
+ *        "../../1 - Basic_Data_Structures/0 - Allocator/allocator.c"
+ *        -pthread
+ *
+ * Usage: lf_stack_bench [threads] [rounds_per_thread]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lf_stack.h"
+#include "../../1 - Basic_Data_Structures/3 - Stack/stack.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_THREADS  (4u)
+#define DEFAULT_ROUNDS   (1000000u)
+#define MAX_THREADS      (64u)
+#define HOLD             (4u) /* Objects a thread holds at once */
+#define SPARE_PER_THREAD (64u)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+typedef struct
+{
+    uint64_t payload[8];
+} object_t;
+
+typedef enum
+{
+    MODE_MUTEX = 0,
+    MODE_LOCKFREE,
+    MODE_MAGAZINE,
+    MODE_COUNT
+} bench_mode_t;
+
+typedef struct
+{
+    bench_mode_t      mode;
+    uint32_t          rounds;
+    object_t *        p_objects;
+    uint32_t          object_count;
+    stack_t           locked;
+    pthread_mutex_t   lock;
+    lfstack_t *       p_free;
+    pthread_barrier_t start;
+} shared_t;
+
+typedef struct
+{
+    shared_t * p_shared;
+    uint32_t   id;
+    uint64_t   misses; /* Takes that found the list empty */
+} worker_arg_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const char * const g_mode_names[MODE_COUNT] = {
+    "mutex stack_t", "lfstack", "lfstack+magazine"
+};
+
+static pthread_t    g_threads[MAX_THREADS];
+static worker_arg_t g_args[MAX_THREADS];
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void *     worker(void * p_arg);
+static object_t * take(shared_t * p_shared, lfstack_magazine_t * p_magazine);
+static void       give(shared_t *           p_shared,
+                       lfstack_magazine_t * p_magazine,
+                       object_t *           p_object);
+static bool       verify(shared_t * p_shared);
+static double     now_seconds(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t     thread_count = DEFAULT_THREADS;
+    uint32_t     rounds       = DEFAULT_ROUNDS;
+    shared_t     shared;
+    int          status = EXIT_SUCCESS;
+
+    if (argc > 1)
+    {
+        thread_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        rounds = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if ((0u == thread_count) || (thread_count > MAX_THREADS) || (0u == rounds))
+    {
+        fprintf(stderr, "usage: %s [threads 1-%u] [rounds]\n", argv[0],
+                MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    shared.rounds       = rounds;
+    shared.object_count = thread_count * SPARE_PER_THREAD;
+    shared.p_objects    = calloc(shared.object_count, sizeof(object_t));
+
+    if (NULL == shared.p_objects)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("%u threads, %u rounds of %u takes and gives each, %u objects\n",
+           thread_count, rounds, HOLD, shared.object_count);
+
+    for (int mode = 0; mode < MODE_COUNT; mode++)
+    {
+        shared.mode   = (bench_mode_t)mode;
+        shared.p_free = lfstack_create(shared.object_count, true);
+        (void)stack_init(&shared.locked);
+        (void)pthread_mutex_init(&shared.lock, NULL);
+        (void)pthread_barrier_init(&shared.start, NULL, thread_count + 1u);
+
+        for (uint32_t index = shared.object_count; index > 0u; index--)
+        {
+            (void)stack_push(&shared.locked, &shared.p_objects[index - 1u]);
+        }
+
+        if (NULL == shared.p_free)
+        {
+            free(shared.p_objects);
+            return EXIT_FAILURE;
+        }
+
+        for (uint32_t id = 0u; id < thread_count; id++)
+        {
+            g_args[id].p_shared = &shared;
+            g_args[id].id       = id;
+            g_args[id].misses   = 0u;
+            (void)pthread_create(&g_threads[id], NULL, worker, &g_args[id]);
+        }
+
+        (void)pthread_barrier_wait(&shared.start);
+        double   start  = now_seconds();
+        uint64_t misses = 0u;
+
+        for (uint32_t id = 0u; id < thread_count; id++)
+        {
+            (void)pthread_join(g_threads[id], NULL);
+            misses += g_args[id].misses;
+        }
+
+        double   elapsed = now_seconds() - start;
+        uint64_t ops     = (uint64_t)thread_count * rounds * HOLD * 2u;
+        bool     b_ok    = verify(&shared);
+
+        printf("%-18s %8.2f Mops/s %7.1f ns/op  misses %llu  %s\n",
+               g_mode_names[mode],
+               (double)ops / elapsed / 1e6,
+               elapsed * 1e9 / (double)ops,
+               (unsigned long long)misses,
+               b_ok ? "ok" : "LOST OR DUPLICATED OBJECTS");
+
+        if (!b_ok)
+        {
+            status = EXIT_FAILURE;
+        }
+
+        stack_destroy(&shared.locked, false);
+        lfstack_destroy(&shared.p_free);
+        (void)pthread_mutex_destroy(&shared.lock);
+        (void)pthread_barrier_destroy(&shared.start);
+    }
+
+    free(shared.p_objects);
+    return status;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static void *
+worker(void * p_arg)
+{
+    worker_arg_t *     p_worker = p_arg;
+    shared_t *         p_shared = p_worker->p_shared;
+    lfstack_magazine_t magazine;
+    object_t *         held[HOLD];
+
+    (void)lfstack_magazine_init(&magazine, p_shared->p_free);
+    (void)pthread_barrier_wait(&p_shared->start);
+
+    for (uint32_t round = 0u; round < p_shared->rounds; round++)
+    {
+        for (uint32_t slot = 0u; slot < HOLD; slot++)
+        {
+            held[slot] = take(p_shared, &magazine);
+
+            if (NULL == held[slot])
+            {
+                p_worker->misses++;
+                continue;
+            }
+
+            held[slot]->payload[0] = ((uint64_t)p_worker->id << 32) | round;
+        }
+
+        for (uint32_t slot = HOLD; slot > 0u; slot--)
+        {
+            if (NULL != held[slot - 1u])
+            {
+                give(p_shared, &magazine, held[slot - 1u]);
+            }
+        }
+    }
+
+    lfstack_magazine_flush(&magazine);
+    return NULL;
+}
+
+static object_t *
+take(shared_t * p_shared, lfstack_magazine_t * p_magazine)
+{
+    object_t * p_object = NULL;
+    uint32_t   index    = LFSTACK_NONE;
+
+    switch (p_shared->mode)
+    {
+        case MODE_MUTEX:
+            (void)pthread_mutex_lock(&p_shared->lock);
+            p_object = stack_pop(&p_shared->locked);
+            (void)pthread_mutex_unlock(&p_shared->lock);
+            return p_object;
+
+        case MODE_LOCKFREE:
+            index = lfstack_pop(p_shared->p_free);
+            break;
+
+        default:
+            index = lfstack_magazine_pop(p_magazine);
+            break;
+    }
+
+    return (LFSTACK_NONE == index) ? NULL : &p_shared->p_objects[index];
+}
+
+static void
+give(shared_t *           p_shared,
+     lfstack_magazine_t * p_magazine,
+     object_t *           p_object)
+{
+    uint32_t index = (uint32_t)(p_object - p_shared->p_objects);
+
+    switch (p_shared->mode)
+    {
+        case MODE_MUTEX:
+            (void)pthread_mutex_lock(&p_shared->lock);
+            (void)stack_push(&p_shared->locked, p_object);
+            (void)pthread_mutex_unlock(&p_shared->lock);
+            break;
+
+        case MODE_LOCKFREE:
+            (void)lfstack_push(p_shared->p_free, index);
+            break;
+
+        default:
+            (void)lfstack_magazine_push(p_magazine, index);
+            break;
+    }
+}
+
+/*!
+ * @brief Drains the list used by the run and checks that it held every
+ *        object exactly once.
+ */
+static bool
+verify(shared_t * p_shared)
+{
+    uint8_t * p_seen = calloc(p_shared->object_count, 1u);
+    uint32_t  count  = 0u;
+    bool      b_ok   = (NULL != p_seen);
+
+    while (b_ok)
+    {
+        uint32_t index = LFSTACK_NONE;
+
+        if (MODE_MUTEX == p_shared->mode)
+        {
+            object_t * p_object = stack_pop(&p_shared->locked);
+
+            if (NULL != p_object)
+            {
+                index = (uint32_t)(p_object - p_shared->p_objects);
+            }
+        }
+        else
+        {
+            index = lfstack_pop(p_shared->p_free);
+        }
+
+        if (LFSTACK_NONE == index)
+        {
+            break;
+        }
+
+        b_ok = (index < p_shared->object_count) && (0u == p_seen[index]);
+
+        if (b_ok)
+        {
+            p_seen[index] = 1u;
+            count++;
+        }
+    }
+
+    free(p_seen);
+    return b_ok && (count == p_shared->object_count);
+}
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/*** end of file ***/
@@ -0,0 +1,201 @@
+#include <check.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lf_stack.h"
+
+#define THREADS  (4u)
+#define ROUNDS   (20000u)
+#define CAPACITY (64u)
+
+// Pops every index left on the stack and checks each is there exactly once
+static void
+assert_each_once(lfstack_t * p_stack)
+{
+    uint32_t capacity = lfstack_capacity(p_stack);
+    bool *   p_seen   = calloc(capacity, sizeof(bool));
+    uint32_t count    = 0;
+    uint32_t index;
+
+    ck_assert_ptr_nonnull(p_seen);
+
+    while (LFSTACK_NONE != (index = lfstack_pop(p_stack)))
+    {
+        ck_assert_uint_lt(index, capacity);
+        ck_assert(!p_seen[index]);
+        p_seen[index] = true;
+        count++;
+    }
+
+    ck_assert_uint_eq(count, capacity);
+    free(p_seen);
+}
+
+// Takes and gives back batches of indices through its own magazine
+static void *
+churn(void * p_arg)
+{
+    lfstack_magazine_t * p_magazine = p_arg;
+    uint32_t             held[LFSTACK_MAGAZINE_SIZE];
+
+    for (uint32_t round = 0; round < ROUNDS; round++)
+    {
+        uint32_t count = 0;
+
+        for (uint32_t idx = 0; idx < 1 + (round % LFSTACK_MAGAZINE_SIZE);
+             idx++)
+        {
+            uint32_t index = lfstack_magazine_pop(p_magazine);
+            if (LFSTACK_NONE != index)
+            {
+                held[count++] = index;
+            }
+        }
+
+        while (count > 0)
+        {
+            lfstack_magazine_push(p_magazine, held[--count]);
+        }
+    }
+
+    lfstack_magazine_flush(p_magazine);
+    return NULL;
+}
+
+START_TEST(test_lifo_order)
+{
+    lfstack_t * p_stack = lfstack_create(8, true);
+
+    ck_assert_ptr_nonnull(p_stack);
+
+    // A full stack starts with index 0 on top
+    ck_assert_uint_eq(lfstack_pop(p_stack), 0);
+    ck_assert_uint_eq(lfstack_pop(p_stack), 1);
+
+    ck_assert_int_eq(lfstack_push(p_stack, 0), LFSTACK_SUCCESS);
+    ck_assert_int_eq(lfstack_push(p_stack, 1), LFSTACK_SUCCESS);
+    ck_assert_uint_eq(lfstack_pop(p_stack), 1);
+    ck_assert_uint_eq(lfstack_pop(p_stack), 0);
+
+    for (uint32_t idx = 2; idx < 8; idx++)
+    {
+        ck_assert_uint_eq(lfstack_pop(p_stack), idx);
+    }
+    ck_assert_uint_eq(lfstack_pop(p_stack), LFSTACK_NONE);
+
+    lfstack_destroy(&p_stack);
+    ck_assert_ptr_null(p_stack);
+}
+END_TEST
+
+START_TEST(test_bad_params)
+{
+    lfstack_t * p_stack = lfstack_create(4, false);
+
+    ck_assert_ptr_nonnull(p_stack);
+    ck_assert_uint_eq(lfstack_pop(p_stack), LFSTACK_NONE);
+    ck_assert_int_eq(lfstack_push(p_stack, 4), LFSTACK_ERROR_PARAM);
+    ck_assert_int_eq(lfstack_push(NULL, 0), LFSTACK_ERROR_PARAM);
+    ck_assert_int_eq(lfstack_magazine_init(NULL, p_stack), LFSTACK_ERROR_PARAM);
+    ck_assert_ptr_null(lfstack_create(0, true));
+
+    lfstack_destroy(&p_stack);
+}
+END_TEST
+
+START_TEST(test_magazine_refill_spill_flush)
+{
+    lfstack_t *        p_stack = lfstack_create(CAPACITY, true);
+    lfstack_magazine_t magazine;
+    uint32_t           held[CAPACITY];
+
+    ck_assert_ptr_nonnull(p_stack);
+    ck_assert_int_eq(lfstack_magazine_init(&magazine, p_stack), LFSTACK_SUCCESS);
+
+    // Taking more than a magazine holds refills it from the stack
+    for (uint32_t idx = 0; idx < CAPACITY; idx++)
+    {
+        held[idx] = lfstack_magazine_pop(&magazine);
+        ck_assert_uint_ne(held[idx], LFSTACK_NONE);
+    }
+    ck_assert_uint_eq(lfstack_magazine_pop(&magazine), LFSTACK_NONE);
+
+    // Giving them all back spills to the stack; flush returns the rest
+    for (uint32_t idx = 0; idx < CAPACITY; idx++)
+    {
+        ck_assert_int_eq(lfstack_magazine_push(&magazine, held[idx]),
+                         LFSTACK_SUCCESS);
+    }
+    ck_assert_int_eq(lfstack_magazine_push(&magazine, CAPACITY),
+                     LFSTACK_ERROR_PARAM);
+    lfstack_magazine_flush(&magazine);
+
+    assert_each_once(p_stack);
+    lfstack_destroy(&p_stack);
+}
+END_TEST
+
+START_TEST(test_concurrent_conserves_indices)
+{
+    lfstack_t *        p_stack = lfstack_create(CAPACITY, true);
+    lfstack_magazine_t magazines[THREADS];
+    pthread_t          threads[THREADS];
+
+    ck_assert_ptr_nonnull(p_stack);
+
+    for (uint32_t idx = 0; idx < THREADS; idx++)
+    {
+        lfstack_magazine_init(&magazines[idx], p_stack);
+        ck_assert_int_eq(
+            pthread_create(&threads[idx], NULL, churn, &magazines[idx]), 0);
+    }
+    for (uint32_t idx = 0; idx < THREADS; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+
+    assert_each_once(p_stack);
+    lfstack_destroy(&p_stack);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+lf_stack_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Lockfree_Stack");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_lifo_order);
+    tcase_add_test(tc_core, test_bad_params);
+    tcase_add_test(tc_core, test_magazine_refill_spill_flush);
+    tcase_add_test(tc_core, test_concurrent_conserves_indices);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = lf_stack_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
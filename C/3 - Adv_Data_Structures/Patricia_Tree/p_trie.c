@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "p_trie.h"
+#include "../../1 - Basic_Data_Structures/0 - Allocator/allocator.h"
 
 // Define structures
 struct pat_node {
@@ -11,24 +12,34 @@ struct pat_node {
     struct pat_node **children;
     bool str_complete;
     int num_of_children;
+    const allocator_t *p_alloc; // Keys, children arrays and children
 };
 
 struct patricia_tree {
     pat_node_t *root;
     int size;
+    const allocator_t *p_alloc; // Allocator for the tree (NULL for malloc)
 };
 
+static char *string_duplicate_ex(const char *str, const allocator_t *p_alloc);
+
 // Function to create a new Patricia Tree
 patricia_tree_t *
 create_patricia_tree(void) {
-    patricia_tree_t *tree = (patricia_tree_t *)calloc(1, sizeof(patricia_tree_t));
+    return create_patricia_tree_ex(NULL);
+}
+
+// Function to create a new Patricia Tree whose nodes come from p_alloc
+patricia_tree_t *
+create_patricia_tree_ex(const allocator_t *p_alloc) {
+    patricia_tree_t *tree = (patricia_tree_t *)ALLOC_ZEROED(p_alloc, 1, sizeof(patricia_tree_t));
     if (tree == NULL) {
         return NULL;
     }
 
-    tree->root = (pat_node_t *)calloc(1, sizeof(pat_node_t));
+    tree->root = (pat_node_t *)ALLOC_ZEROED(p_alloc, 1, sizeof(pat_node_t));
     if (tree->root == NULL) {
-        free(tree);
+        ALLOC_FREE(p_alloc, tree);
         return NULL;
     }
 
@@ -37,13 +48,20 @@ create_patricia_tree(void) {
     tree->root->children = NULL;
     tree->root->str_complete = false;
     tree->root->num_of_children = 0;
+    tree->root->p_alloc = p_alloc;
     tree->size = 0;
+    tree->p_alloc = p_alloc;
     return tree;
 }
 
 pat_node_t * create_node(char *key, pat_node_t *parent)
 {
-    pat_node_t *new_node = calloc(1, sizeof(pat_node_t));
+    return create_node_ex(key, parent, (parent != NULL) ? parent->p_alloc : NULL);
+}
+
+pat_node_t * create_node_ex(char *key, pat_node_t *parent, const allocator_t *p_alloc)
+{
+    pat_node_t *new_node = ALLOC_ZEROED(p_alloc, 1, sizeof(pat_node_t));
     
     if (new_node == NULL) 
     {
@@ -51,12 +69,12 @@ pat_node_t * create_node(char *key, pat_node_t *parent)
         return NULL;
     }
 
-    new_node->key = string_duplicate(key);
+    new_node->key = string_duplicate_ex(key, p_alloc);
     
     if (new_node->key == NULL) 
     {
         fprintf(stderr, "Memory allocation for key failed\n");
-        free(new_node);
+        ALLOC_FREE(p_alloc, new_node);
         return NULL;
     }
 
@@ -64,14 +82,15 @@ pat_node_t * create_node(char *key, pat_node_t *parent)
     new_node->children = NULL;
     new_node->str_complete = false;
     new_node->num_of_children = 0;
+    new_node->p_alloc = p_alloc;
 
     if (parent != NULL) {
-        parent->children = realloc(parent->children, (parent->num_of_children + 1) * sizeof(pat_node_t *));
+        parent->children = ALLOC_RESIZE(parent->p_alloc, parent->children, (parent->num_of_children + 1) * sizeof(pat_node_t *));
         if (parent->children == NULL) 
         {
             fprintf(stderr, "Memory allocation for children array failed\n");
-            free(new_node->key);
-            free(new_node);
+            ALLOC_FREE(p_alloc, new_node->key);
+            ALLOC_FREE(p_alloc, new_node);
             return NULL;
         }
 
@@ -84,7 +103,7 @@ pat_node_t * create_node(char *key, pat_node_t *parent)
 
 bool insert_node(const char *string, pat_node_t *root) 
 {
-    char *working_string = string_duplicate(string);
+    char *working_string = string_duplicate_ex(string, root->p_alloc);
     if (working_string == NULL) {
         fprintf(stderr, "Memory allocation failed\n");
         return false;
@@ -92,7 +111,7 @@ bool insert_node(const char *string, pat_node_t *root)
 
     bool result = insert_node_helper(working_string, root);
     
-    free(working_string);
+    ALLOC_FREE(root->p_alloc, working_string);
     return result;
 }
 
@@ -102,7 +121,7 @@ bool insert_node_helper(char *string, pat_node_t *current_node)
     
     // If the current node is empty, just insert the string here
     if (current_node->key == NULL) {
-        current_node->key = string_duplicate(string);
+        current_node->key = string_duplicate_ex(string, current_node->p_alloc);
         current_node->str_complete = true;
         return true;
     }
@@ -118,7 +137,7 @@ bool insert_node_helper(char *string, pat_node_t *current_node)
 
     // If we need to split the current node
     if (common_prefix < current_len) {
-        pat_node_t *new_child = create_node(current_node->key + common_prefix, NULL);
+        pat_node_t *new_child = create_node_ex(current_node->key + common_prefix, NULL, current_node->p_alloc);
         new_child->str_complete = current_node->str_complete;
         new_child->children = current_node->children;
         new_child->num_of_children = current_node->num_of_children;
@@ -128,7 +147,7 @@ bool insert_node_helper(char *string, pat_node_t *current_node)
         }
 
         current_node->key[common_prefix] = '\0';
-        current_node->children = malloc(sizeof(pat_node_t*) * 2);  // Allocate space for 2 children
+        current_node->children = ALLOC_NEW(current_node->p_alloc, sizeof(pat_node_t*) * 2);  // Allocate space for 2 children
         current_node->children[0] = new_child;
         current_node->num_of_children = 1;
         current_node->str_complete = false;
@@ -158,12 +177,10 @@ bool insert_node_helper(char *string, pat_node_t *current_node)
                     return insert_node_helper(string + current_len, current_node->children[i]);
                 }
             }
-            // If no matching child found, create a new one
+            // If no matching child found, create a new one; create_node
+            // appends it to the children
             pat_node_t *new_child = create_node(string + current_len, current_node);
             new_child->str_complete = true;
-            current_node->children = realloc(current_node->children, (current_node->num_of_children + 1) * sizeof(pat_node_t*));
-            current_node->children[current_node->num_of_children] = new_child;
-            current_node->num_of_children++;
         } else {
             // The string is exactly the current node
             current_node->str_complete = true;
@@ -176,8 +193,12 @@ bool insert_node_helper(char *string, pat_node_t *current_node)
 }
 
 char* string_duplicate(const char* str) {
+    return string_duplicate_ex(str, NULL);
+}
+
+static char *string_duplicate_ex(const char *str, const allocator_t *p_alloc) {
     size_t len = strlen(str) + 1;
-    char* dup = malloc(len);
+    char* dup = ALLOC_NEW(p_alloc, len);
     if (dup != NULL) {
         memcpy(dup, str, len);
     }
@@ -254,7 +275,7 @@ void prefix_breakdown(pat_node_t * current_node, size_t diff_index)
     }
 
     // Update the current node
-    current_node->children = malloc(sizeof(pat_node_t*));
+    current_node->children = ALLOC_NEW(current_node->p_alloc, sizeof(pat_node_t*));
     current_node->children[0] = new_child;
     current_node->num_of_children = 1;
     truncate_string(current_node->key, diff_index);
@@ -309,14 +330,15 @@ void free_patricia_tree(pat_node_t *node) {
         free_patricia_tree(node->children[i]);
     }
 
-    free(node->key);
-    free(node->children);
-    free(node);
+    ALLOC_FREE(node->p_alloc, node->key);
+    ALLOC_FREE(node->p_alloc, node->children);
+    ALLOC_FREE(node->p_alloc, node);
 }
 
 int main() {
-    // Create a new Patricia tree
-    patricia_tree_t *tree = create_patricia_tree();
+    // Create a new Patricia tree, counting what it allocates
+    alloc_tracker_t *tracker = alloc_tracker_create(NULL, 0);
+    patricia_tree_t *tree = create_patricia_tree_ex(alloc_tracker_allocator(tracker));
     if (tree == NULL) {
         fprintf(stderr, "Failed to create Patricia tree\n");
         return 1;
@@ -351,9 +373,11 @@ int main() {
     printf("\nFinal Patricia Tree Structure:\n");
     print_patricia_tree(tree->root, 0);
 
-    // Free the tree
+    // Free the tree; nothing should be left live
     free_patricia_tree(tree->root);
-    free(tree);
+    ALLOC_FREE(tree->p_alloc, tree);
+    alloc_tracker_print(tracker, stdout);
+    alloc_tracker_destroy(&tracker);
 
     return 0;
 }
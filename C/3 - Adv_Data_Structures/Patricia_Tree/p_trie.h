@@ -1,13 +1,19 @@
 #ifndef PATRICIA_TREE_H
 #define PATRICIA_TREE_H
 
+#include "../../1 - Basic_Data_Structures/0 - Allocator/allocator.h"
+
 typedef struct patricia_tree patricia_tree_t;
 typedef struct pat_node pat_node_t;
 
 patricia_tree_t * create_patricia_tree (void);
 
+patricia_tree_t * create_patricia_tree_ex (const allocator_t *p_alloc);
+
 pat_node_t * create_node(char *key, pat_node_t *parent);
 
+pat_node_t * create_node_ex(char *key, pat_node_t *parent, const allocator_t *p_alloc);
+
 bool insert_node(const char * string,  pat_node_t * current_node);
 
 bool insert_node_helper(char * string, pat_node_t * current_node);   
@@ -0,0 +1,270 @@
+/** @file persistent.h
+ *
+ * @brief Persistent (immutable) vector and hash map with structural
+ *        sharing, and a cell that publishes versions to lock-free readers.
+ *
+ * Neither structure is ever changed. An update returns a new version and
+ * leaves the old one as it was. The versions share every node the update
+ * did not touch, so one costs O(log32 n) new memory and time.
+ *
+ * - pvec_t is a 32-way trie of the elements in index order, with the last
+ *   up to 32 elements in a separate tail so appends rarely touch the trie.
+ * - pmap_t is a hash array mapped trie: each level takes 5 bits of the
+ *   key's hash and keeps only the children present, found by popcount of
+ *   a 32-bit bitmap. Keys whose hashes are fully equal share a collision
+ *   node at the bottom.
+ *
+ * Payloads follow the conventions of dynamic_array_t and hash_table_t:
+ * elements, keys and values are void pointers and the callbacks are
+ * hash_table_t's (hash_function is called with a capacity of UINT32_MAX).
+ * Since a payload may be held by many versions at once, a structure never
+ * frees one outright. If value_retain and value_release are given, every
+ * node holding a value takes a reference with value_retain and drops it
+ * with value_release when it is freed; otherwise the caller must keep
+ * values alive as long as any version holding them. Keys made by key_copy
+ * are freed with key_free when the last version holding them goes.
+ *
+ * Versions are reference counted. A version from create or an update is
+ * owned by the caller, who ends it with pvec_release() or pmap_release();
+ * pvec_retain() and pmap_retain() add owners. Versions and their nodes may
+ * be read, retained and released from any thread.
+ *
+ * persist_cell_t holds the current version of either kind. Readers take
+ * it with persist_cell_load(), a lock-free O(1) snapshot, and read it as
+ * long as they like while writers publish newer versions with
+ * persist_cell_store(). Writers must be serialized among themselves, e.g.
+ * by the lock that already guards the data being written. The cell packs
+ * a version pointer and a 16-bit count of readers in the middle of a load
+ * into one 64-bit word, so it needs user-space pointers to fit in 48 bits,
+ * as they do on x86-64 and AArch64 Linux.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef PERSISTENT_H
+#define PERSISTENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct pvec pvec_t;
+typedef struct pmap pmap_t;
+
+/* Current version of a pvec_t or pmap_t; the fields are private */
+typedef struct
+{
+    uint64_t word;  /* Version pointer and in-flight reader count */
+} persist_cell_t;
+
+/*************************************************************************
+ * Function Declarations: vector
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty vector.
+ *
+ * @param[in] value_retain  Takes a reference to an element (may be NULL)
+ * @param[in] value_release Drops a reference to an element (may be NULL)
+ *
+ * @return The empty vector, owned by the caller, or NULL on failure
+ */
+pvec_t *
+pvec_create(void (*value_retain)(void * p_data),
+            void (*value_release)(void * p_data));
+
+/*!
+ * @brief Adds an owner to a version.
+ *
+ * @return p_vec
+ */
+pvec_t *
+pvec_retain(pvec_t * p_vec);
+
+/*!
+ * @brief Drops an owner of a version, freeing it with the last one.
+ *
+ * @param[in] p_vec Version (may be NULL)
+ */
+void
+pvec_release(pvec_t * p_vec);
+
+/*!
+ * @brief New version with p_data appended.
+ *
+ * @return New version, owned by the caller, or NULL on failure
+ */
+pvec_t *
+pvec_push(const pvec_t * p_vec, void * p_data);
+
+/*!
+ * @brief New version with the element at position replaced by p_data.
+ *
+ * @return New version, owned by the caller, or NULL on failure or if
+ *         position is out of range
+ */
+pvec_t *
+pvec_set(const pvec_t * p_vec, uint32_t position, void * p_data);
+
+/*!
+ * @brief New version without the last element.
+ *
+ * @return New version, owned by the caller, or NULL on failure or if the
+ *         vector is empty
+ */
+pvec_t *
+pvec_pop(const pvec_t * p_vec);
+
+/*!
+ * @brief Element at position.
+ *
+ * @return The element, or NULL if position is out of range
+ */
+void *
+pvec_get(const pvec_t * p_vec, uint32_t position);
+
+/*!
+ * @brief Number of elements.
+ */
+uint32_t
+pvec_size(const pvec_t * p_vec);
+
+/*************************************************************************
+ * Function Declarations: hash map
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty map.
+ *
+ * @param[in] hash_function Hash of a key, called with capacity UINT32_MAX
+ * @param[in] key_equals    Key comparison
+ * @param[in] key_copy      Copies a key (may be NULL for simple keys)
+ * @param[in] key_free      Frees a copied key (may be NULL)
+ * @param[in] value_retain  Takes a reference to a value (may be NULL)
+ * @param[in] value_release Drops a reference to a value (may be NULL)
+ *
+ * @return The empty map, owned by the caller, or NULL on failure
+ */
+pmap_t *
+pmap_create(uint32_t (*hash_function)(const void * p_key, uint32_t capacity),
+            bool (*key_equals)(const void * p_key1, const void * p_key2),
+            void * (*key_copy)(const void * p_key),
+            void (*key_free)(void * p_key),
+            void (*value_retain)(void * p_value),
+            void (*value_release)(void * p_value));
+
+/*!
+ * @brief Adds an owner to a version.
+ *
+ * @return p_map
+ */
+pmap_t *
+pmap_retain(pmap_t * p_map);
+
+/*!
+ * @brief Drops an owner of a version, freeing it with the last one.
+ *
+ * @param[in] p_map Version (may be NULL)
+ */
+void
+pmap_release(pmap_t * p_map);
+
+/*!
+ * @brief New version with p_key mapped to p_value.
+ *
+ * @return New version, owned by the caller, or NULL on failure
+ */
+pmap_t *
+pmap_put(const pmap_t * p_map, const void * p_key, void * p_value);
+
+/*!
+ * @brief New version without p_key. If p_key is absent this is p_map
+ *        itself with one more owner.
+ *
+ * @return New version, owned by the caller, or NULL on failure
+ */
+pmap_t *
+pmap_remove(const pmap_t * p_map, const void * p_key);
+
+/*!
+ * @brief Value mapped to p_key.
+ *
+ * @return The value, or NULL if the key is absent
+ */
+void *
+pmap_get(const pmap_t * p_map, const void * p_key);
+
+/*!
+ * @brief Checks whether p_key is present.
+ */
+bool
+pmap_contains_key(const pmap_t * p_map, const void * p_key);
+
+/*!
+ * @brief Number of keys.
+ */
+uint32_t
+pmap_size(const pmap_t * p_map);
+
+/*!
+ * @brief Calls visit for every key and value, in hash order, until it
+ *        returns false.
+ *
+ * @param[in] p_map Version
+ * @param[in] visit Callback
+ * @param[in] p_arg Passed to visit
+ */
+void
+pmap_for_each(const pmap_t * p_map,
+              bool (*visit)(void * p_arg, const void * p_key, void * p_value),
+              void * p_arg);
+
+/*************************************************************************
+ * Function Declarations: publishing cell
+ *************************************************************************/
+
+/*!
+ * @brief Starts a cell holding p_version, taking over the caller's
+ *        ownership of it.
+ *
+ * @param[out] p_cell    Cell
+ * @param[in]  p_version pvec_t or pmap_t version (may be NULL)
+ */
+void
+persist_cell_init(persist_cell_t * p_cell, void * p_version);
+
+/*!
+ * @brief Snapshot of the current version. Lock-free; never waits for a
+ *        writer.
+ *
+ * @return The version, owned by the caller (release it when done), or NULL
+ *         if the cell is empty
+ */
+void *
+persist_cell_load(persist_cell_t * p_cell);
+
+/*!
+ * @brief Publishes p_version, taking over the caller's ownership of it,
+ *        and drops the cell's ownership of the one it replaces. Readers
+ *        holding the old version keep it until they release it.
+ *
+ * @param[in,out] p_cell    Cell
+ * @param[in]     p_version pvec_t or pmap_t version (may be NULL)
+ */
+void
+persist_cell_store(persist_cell_t * p_cell, void * p_version);
+
+/*!
+ * @brief Empties the cell, dropping its ownership of the current version.
+ *        No thread may be loading from it.
+ */
+void
+persist_cell_destroy(persist_cell_t * p_cell);
+
+#endif /* PERSISTENT_H */
+
+/*** end of file ***/
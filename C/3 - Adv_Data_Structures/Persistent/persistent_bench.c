@@ -0,0 +1,401 @@
+/** @file persistent_bench.c
+ *
+ * @brief Consistent reads of a table of records under a steady writer:
+ *        a locked copy against a persistent-vector snapshot.
+ *
+ * RECORDS records, each stamped with the number of the update that last
+ * wrote it, are read whole by reader threads while one writer rewrites
+ * them one at a time, as user_db_list() and user_db_update() do:
+ *
+ * - locked: the records are an array under a mutex; a reader holds the
+ *   mutex while it copies every record out, and the writer holds it to
+ *   change one;
+ * - snapshot: the records are immutable, reference-counted copies in a
+ *   pvec_t published through a persist_cell_t; a reader takes a snapshot
+ *   without a lock and copies from it at leisure, and the writer builds
+ *   a new version with pvec_set() and publishes it.
+ *
+ * Each mode runs for SECONDS seconds per reader count. Reported are full
+ * reads per second over all readers and updates per second, the latter
+ * showing how much the readers hold the writer up. Every read checks the
+ * records it copied are intact.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L persistent_bench.c
+ *        persistent.c -pthread
+ *
+ * Usage: persistent_bench [records] [max readers] [seconds]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "persistent.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_RECORDS  (10000u)
+#define DEFAULT_READERS  (8u)
+#define DEFAULT_SECONDS  (1.0)
+#define MAX_READERS      (64u)
+#define NAME_LEN         (32u)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+typedef struct
+{
+    uint32_t id;
+    uint32_t stamp;           /* Update that last wrote the record */
+    char     name[NAME_LEN];  /* Derived from id and stamp */
+    uint32_t role;
+} record_t;
+
+/* Immutable record shared by snapshots */
+typedef struct
+{
+    uint32_t refs;
+    record_t record;
+} shared_record_t;
+
+typedef struct
+{
+    bool     b_snapshot;
+    uint64_t reads;
+    bool     b_torn;
+} reader_arg_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static uint32_t        g_records;
+static bool            g_b_stop;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static record_t *      g_p_table;
+
+static persist_cell_t  g_cell;
+
+static pthread_t       g_threads[MAX_READERS + 1u];
+static reader_arg_t    g_args[MAX_READERS];
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void              fill_record(record_t * p_record,
+                                     uint32_t   id,
+                                     uint32_t   stamp);
+static bool              record_intact(const record_t * p_record, uint32_t id);
+static shared_record_t * shared_new(uint32_t id, uint32_t stamp);
+static void              shared_retain(void * p_data);
+static void              shared_release(void * p_data);
+static void *            reader(void * p_arg);
+static void *            writer(void * p_arg);
+static void              run(bool     b_snapshot,
+                             uint32_t reader_count,
+                             double   seconds);
+static double            now_seconds(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t max_readers = DEFAULT_READERS;
+    double   seconds     = DEFAULT_SECONDS;
+
+    g_records = DEFAULT_RECORDS;
+
+    if (argc > 1)
+    {
+        g_records = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        max_readers = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        seconds = strtod(argv[3], NULL);
+    }
+
+    if ((0u == g_records) || (0u == max_readers)
+        || (max_readers > MAX_READERS) || !(seconds > 0.0))
+    {
+        fprintf(stderr, "usage: persistent_bench [records] [readers 1-%u] "
+                        "[seconds]\n", MAX_READERS);
+        return EXIT_FAILURE;
+    }
+
+    // Both tables start with the same records
+    pvec_t * p_vec = pvec_create(shared_retain, shared_release);
+
+    g_p_table = malloc((size_t)g_records * sizeof(record_t));
+
+    if ((NULL == p_vec) || (NULL == g_p_table))
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t id = 0; id < g_records; id++)
+    {
+        shared_record_t * p_shared = shared_new(id, 0u);
+        pvec_t *          p_next   = (NULL == p_shared)
+                                         ? NULL
+                                         : pvec_push(p_vec, p_shared);
+
+        if (NULL == p_next)
+        {
+            fprintf(stderr, "out of memory\n");
+            return EXIT_FAILURE;
+        }
+
+        shared_release(p_shared);
+        pvec_release(p_vec);
+        p_vec = p_next;
+        fill_record(&g_p_table[id], id, 0u);
+    }
+
+    persist_cell_init(&g_cell, p_vec);
+
+    printf("%u records of %zu bytes, one writer\n\n", g_records,
+           sizeof(record_t));
+    printf("readers  mode       reads/s    updates/s\n");
+
+    for (uint32_t readers = 1u; readers <= max_readers; readers *= 2u)
+    {
+        run(false, readers, seconds);
+        run(true, readers, seconds);
+    }
+
+    persist_cell_destroy(&g_cell);
+    free(g_p_table);
+
+    return EXIT_SUCCESS;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static void
+fill_record(record_t * p_record, uint32_t id, uint32_t stamp)
+{
+    memset(p_record, 0, sizeof(*p_record));
+    p_record->id    = id;
+    p_record->stamp = stamp;
+    p_record->role  = stamp % 3u;
+    (void)snprintf(p_record->name, sizeof(p_record->name), "user%u.%u", id,
+                   stamp);
+}
+
+/* A record written halfway through a read would not match itself */
+static bool
+record_intact(const record_t * p_record, uint32_t id)
+{
+    record_t expected;
+
+    fill_record(&expected, id, p_record->stamp);
+    return 0 == memcmp(&expected, p_record, sizeof(expected));
+}
+
+static shared_record_t *
+shared_new(uint32_t id, uint32_t stamp)
+{
+    shared_record_t * p_shared = malloc(sizeof(*p_shared));
+
+    if (NULL != p_shared)
+    {
+        p_shared->refs = 1u;
+        fill_record(&p_shared->record, id, stamp);
+    }
+
+    return p_shared;
+}
+
+static void
+shared_retain(void * p_data)
+{
+    shared_record_t * p_shared = p_data;
+
+    (void)__atomic_fetch_add(&p_shared->refs, 1u, __ATOMIC_RELAXED);
+}
+
+static void
+shared_release(void * p_data)
+{
+    shared_record_t * p_shared = p_data;
+
+    if (0u == __atomic_sub_fetch(&p_shared->refs, 1u, __ATOMIC_ACQ_REL))
+    {
+        free(p_shared);
+    }
+}
+
+static void *
+reader(void * p_arg)
+{
+    reader_arg_t * p_reader = p_arg;
+    record_t *     p_copy   = malloc((size_t)g_records * sizeof(record_t));
+
+    if (NULL == p_copy)
+    {
+        return NULL;
+    }
+
+    while (!__atomic_load_n(&g_b_stop, __ATOMIC_RELAXED))
+    {
+        if (p_reader->b_snapshot)
+        {
+            pvec_t * p_vec = persist_cell_load(&g_cell);
+
+            for (uint32_t id = 0; id < g_records; id++)
+            {
+                const shared_record_t * p_shared = pvec_get(p_vec, id);
+                p_copy[id]                       = p_shared->record;
+            }
+
+            pvec_release(p_vec);
+        }
+        else
+        {
+            pthread_mutex_lock(&g_lock);
+            memcpy(p_copy, g_p_table, (size_t)g_records * sizeof(record_t));
+            pthread_mutex_unlock(&g_lock);
+        }
+
+        for (uint32_t id = 0; id < g_records; id++)
+        {
+            p_reader->b_torn |= !record_intact(&p_copy[id], id);
+        }
+
+        p_reader->reads++;
+    }
+
+    free(p_copy);
+    return NULL;
+}
+
+/*!
+ * @brief Rewrites records in turn until stopped.
+ *
+ * @param[in,out] p_arg Points to a uint64_t, non-zero on entry for snapshot
+ *                      mode, that receives the number of updates made
+ */
+static void *
+writer(void * p_arg)
+{
+    uint64_t * p_updates  = p_arg;
+    bool       b_snapshot = (0u != *p_updates);
+    uint32_t   stamp      = 1u;
+
+    *p_updates = 0u;
+
+    while (!__atomic_load_n(&g_b_stop, __ATOMIC_RELAXED))
+    {
+        uint32_t id = stamp % g_records;
+
+        if (b_snapshot)
+        {
+            // Writers are serialized; here there is just one
+            shared_record_t * p_shared = shared_new(id, stamp);
+            pvec_t *          p_vec    = persist_cell_load(&g_cell);
+            pvec_t *          p_next   = (NULL == p_shared)
+                                             ? NULL
+                                             : pvec_set(p_vec, id, p_shared);
+
+            pvec_release(p_vec);
+
+            if (NULL != p_shared)
+            {
+                shared_release(p_shared);
+            }
+
+            if (NULL != p_next)
+            {
+                persist_cell_store(&g_cell, p_next);
+            }
+        }
+        else
+        {
+            pthread_mutex_lock(&g_lock);
+            fill_record(&g_p_table[id], id, stamp);
+            pthread_mutex_unlock(&g_lock);
+        }
+
+        stamp++;
+        (*p_updates)++;
+    }
+
+    return NULL;
+}
+
+static void
+run(bool b_snapshot, uint32_t reader_count, double seconds)
+{
+    uint64_t updates = b_snapshot ? 1u : 0u;
+    uint64_t reads   = 0u;
+    bool     b_torn  = false;
+
+    __atomic_store_n(&g_b_stop, false, __ATOMIC_RELAXED);
+
+    for (uint32_t id = 0; id < reader_count; id++)
+    {
+        g_args[id].b_snapshot = b_snapshot;
+        g_args[id].reads      = 0u;
+        g_args[id].b_torn     = false;
+        (void)pthread_create(&g_threads[id], NULL, reader, &g_args[id]);
+    }
+
+    (void)pthread_create(&g_threads[reader_count], NULL, writer, &updates);
+
+    struct timespec pause = { (time_t)seconds,
+                              (long)((seconds - (double)(time_t)seconds)
+                                     * 1e9) };
+    double          start = now_seconds();
+
+    (void)nanosleep(&pause, NULL);
+    __atomic_store_n(&g_b_stop, true, __ATOMIC_RELAXED);
+
+    for (uint32_t id = 0; id <= reader_count; id++)
+    {
+        (void)pthread_join(g_threads[id], NULL);
+    }
+
+    double elapsed = now_seconds() - start;
+
+    for (uint32_t id = 0; id < reader_count; id++)
+    {
+        reads  += g_args[id].reads;
+        b_torn |= g_args[id].b_torn;
+    }
+
+    printf("%7u  %-8s %9.0f %12.0f%s\n", reader_count,
+           b_snapshot ? "snapshot" : "locked", (double)reads / elapsed,
+           (double)updates / elapsed, b_torn ? "  TORN READ" : "");
+}
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/*** end of file ***/
@@ -0,0 +1,292 @@
+#include <check.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "persistent.h"
+
+#define VEC_SIZE  (2000u)  /* Deep enough for a trie of three levels */
+#define VERSIONS  (2000u)
+#define READERS   (3u)
+
+// Keys and values are small integers carried in the pointer
+#define AS_PTR(n) ((void *)(uintptr_t)(n))
+#define AS_INT(p) ((uint32_t)(uintptr_t)(p))
+
+static int64_t g_references;  /* Retains minus releases */
+
+static void
+count_retain(void * p_data)
+{
+    (void)p_data;
+    __atomic_add_fetch(&g_references, 1, __ATOMIC_RELAXED);
+}
+
+static void
+count_release(void * p_data)
+{
+    (void)p_data;
+    __atomic_sub_fetch(&g_references, 1, __ATOMIC_RELAXED);
+}
+
+static uint32_t
+int_hash(const void * p_key, uint32_t capacity)
+{
+    uint32_t hash = AS_INT(p_key) * 2654435761u;
+
+    return hash % capacity;
+}
+
+// Keys share eight hashes, so many end in collision nodes
+static uint32_t
+colliding_hash(const void * p_key, uint32_t capacity)
+{
+    return int_hash(AS_PTR(AS_INT(p_key) % 8), capacity);
+}
+
+static bool
+int_equals(const void * p_key1, const void * p_key2)
+{
+    return p_key1 == p_key2;
+}
+
+static pmap_t *
+int_map(uint32_t (*hash_function)(const void *, uint32_t))
+{
+    return pmap_create(hash_function, int_equals, NULL, NULL, count_retain,
+                       count_release);
+}
+
+// Version n of the published map holds keys 1 .. n mapped to themselves
+static void *
+check_snapshots(void * p_arg)
+{
+    persist_cell_t * p_cell = p_arg;
+    uint32_t         seen   = 0;
+
+    while (seen < VERSIONS)
+    {
+        pmap_t * p_map = persist_cell_load(p_cell);
+        uint32_t size  = pmap_size(p_map);
+
+        ck_assert_uint_ge(size, seen);
+        ck_assert_ptr_eq(pmap_get(p_map, AS_PTR(size)),
+                         (0 == size) ? NULL : AS_PTR(size));
+        ck_assert(!pmap_contains_key(p_map, AS_PTR(size + 1)));
+        seen = size;
+        pmap_release(p_map);
+    }
+
+    return NULL;
+}
+
+START_TEST(test_vector_versions)
+{
+    pvec_t ** pp_versions = calloc(VEC_SIZE + 1, sizeof(pvec_t *));
+
+    g_references = 0;
+    ck_assert_ptr_nonnull(pp_versions);
+    pp_versions[0] = pvec_create(count_retain, count_release);
+    ck_assert_ptr_nonnull(pp_versions[0]);
+
+    for (uint32_t idx = 0; idx < VEC_SIZE; idx++)
+    {
+        pp_versions[idx + 1] = pvec_push(pp_versions[idx], AS_PTR(idx + 1));
+        ck_assert_ptr_nonnull(pp_versions[idx + 1]);
+    }
+
+    // Every version still holds exactly what it held when made
+    for (uint32_t version = 0; version <= VEC_SIZE; version += 97)
+    {
+        ck_assert_uint_eq(pvec_size(pp_versions[version]), version);
+        for (uint32_t idx = 0; idx < version; idx++)
+        {
+            ck_assert_uint_eq(AS_INT(pvec_get(pp_versions[version], idx)),
+                              idx + 1);
+        }
+        ck_assert_ptr_null(pvec_get(pp_versions[version], version));
+    }
+
+    pvec_t * p_set = pvec_set(pp_versions[VEC_SIZE], 5, AS_PTR(999999));
+    pvec_t * p_pop = pvec_pop(pp_versions[VEC_SIZE]);
+    ck_assert_uint_eq(AS_INT(pvec_get(p_set, 5)), 999999);
+    ck_assert_uint_eq(AS_INT(pvec_get(pp_versions[VEC_SIZE], 5)), 6);
+    ck_assert_uint_eq(pvec_size(p_pop), VEC_SIZE - 1);
+    ck_assert_uint_eq(pvec_size(pp_versions[VEC_SIZE]), VEC_SIZE);
+    ck_assert_ptr_null(pvec_set(p_pop, VEC_SIZE, AS_PTR(1)));
+    ck_assert_ptr_null(pvec_pop(pp_versions[0]));
+
+    pvec_release(p_set);
+    pvec_release(p_pop);
+    for (uint32_t version = 0; version <= VEC_SIZE; version++)
+    {
+        pvec_release(pp_versions[version]);
+    }
+    free(pp_versions);
+    ck_assert_int_eq(g_references, 0);
+}
+END_TEST
+
+START_TEST(test_snapshot_isolation_across_stores)
+{
+    persist_cell_t cell;
+    pmap_t *       p_map = int_map(int_hash);
+
+    g_references = 0;
+    ck_assert_ptr_nonnull(p_map);
+
+    for (uint32_t key = 1; key <= 100; key++)
+    {
+        pmap_t * p_next = pmap_put(p_map, AS_PTR(key), AS_PTR(key));
+        pmap_release(p_map);
+        p_map = p_next;
+    }
+    persist_cell_init(&cell, p_map);
+
+    pmap_t * p_before = persist_cell_load(&cell);
+    ck_assert_ptr_eq(p_before, p_map);
+
+    // Publish a version with one key changed, one removed and one added
+    pmap_t * p_changed = pmap_put(p_map, AS_PTR(1), AS_PTR(1001));
+    pmap_t * p_removed = pmap_remove(p_changed, AS_PTR(2));
+    pmap_t * p_after   = pmap_put(p_removed, AS_PTR(101), AS_PTR(101));
+    pmap_release(p_changed);
+    pmap_release(p_removed);
+    persist_cell_store(&cell, p_after);
+
+    // The snapshot taken before the store is untouched
+    ck_assert_uint_eq(pmap_size(p_before), 100);
+    ck_assert_uint_eq(AS_INT(pmap_get(p_before, AS_PTR(1))), 1);
+    ck_assert(pmap_contains_key(p_before, AS_PTR(2)));
+    ck_assert(!pmap_contains_key(p_before, AS_PTR(101)));
+
+    pmap_t * p_current = persist_cell_load(&cell);
+    ck_assert_ptr_eq(p_current, p_after);
+    ck_assert_uint_eq(pmap_size(p_current), 100);
+    ck_assert_uint_eq(AS_INT(pmap_get(p_current, AS_PTR(1))), 1001);
+    ck_assert(!pmap_contains_key(p_current, AS_PTR(2)));
+    ck_assert_uint_eq(AS_INT(pmap_get(p_current, AS_PTR(101))), 101);
+
+    // Removing an absent key hands back the same version
+    pmap_t * p_same = pmap_remove(p_current, AS_PTR(2));
+    ck_assert_ptr_eq(p_same, p_current);
+
+    pmap_release(p_same);
+    pmap_release(p_current);
+    pmap_release(p_before);
+    persist_cell_destroy(&cell);
+    ck_assert_int_eq(g_references, 0);
+}
+END_TEST
+
+START_TEST(test_map_collisions)
+{
+    pmap_t * p_map = int_map(colliding_hash);
+
+    g_references = 0;
+    ck_assert_ptr_nonnull(p_map);
+
+    for (uint32_t key = 1; key <= 64; key++)
+    {
+        pmap_t * p_next = pmap_put(p_map, AS_PTR(key), AS_PTR(key + 1));
+        pmap_release(p_map);
+        p_map = p_next;
+        ck_assert_ptr_nonnull(p_map);
+    }
+    ck_assert_uint_eq(pmap_size(p_map), 64);
+
+    pmap_t * p_less = pmap_remove(p_map, AS_PTR(17));
+    ck_assert_uint_eq(pmap_size(p_less), 63);
+    ck_assert(!pmap_contains_key(p_less, AS_PTR(17)));
+    ck_assert(pmap_contains_key(p_map, AS_PTR(17)));
+
+    for (uint32_t key = 1; key <= 64; key++)
+    {
+        ck_assert_uint_eq(AS_INT(pmap_get(p_map, AS_PTR(key))), key + 1);
+        if (17 != key)
+        {
+            ck_assert_uint_eq(AS_INT(pmap_get(p_less, AS_PTR(key))), key + 1);
+        }
+    }
+
+    pmap_release(p_less);
+    pmap_release(p_map);
+    ck_assert_int_eq(g_references, 0);
+}
+END_TEST
+
+START_TEST(test_readers_during_stores)
+{
+    persist_cell_t cell;
+    pthread_t      threads[READERS];
+    pmap_t *       p_map = int_map(int_hash);
+
+    g_references = 0;
+    ck_assert_ptr_nonnull(p_map);
+    persist_cell_init(&cell, pmap_retain(p_map));
+
+    for (uint32_t idx = 0; idx < READERS; idx++)
+    {
+        ck_assert_int_eq(
+            pthread_create(&threads[idx], NULL, check_snapshots, &cell), 0);
+    }
+
+    // The single writer builds each version from the last one it published
+    for (uint32_t key = 1; key <= VERSIONS; key++)
+    {
+        pmap_t * p_next = pmap_put(p_map, AS_PTR(key), AS_PTR(key));
+        pmap_release(p_map);
+        p_map = p_next;
+        persist_cell_store(&cell, pmap_retain(p_map));
+    }
+
+    for (uint32_t idx = 0; idx < READERS; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+
+    pmap_release(p_map);
+    persist_cell_destroy(&cell);
+    ck_assert_int_eq(g_references, 0);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+persistent_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Persistent");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_vector_versions);
+    tcase_add_test(tc_core, test_snapshot_isolation_across_stores);
+    tcase_add_test(tc_core, test_map_collisions);
+    tcase_add_test(tc_core, test_readers_during_stores);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = persistent_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
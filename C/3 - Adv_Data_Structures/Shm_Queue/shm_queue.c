@@ -0,0 +1,927 @@
+/** @file shm_queue.c
+ *
+ * @brief Implementation of the shared-memory message queue.
+ *
+ * Positions count up from 0 for ever; position pos lives in slot
+ * pos & (capacity - 1). A slot's sequence number is pos while it waits for
+ * the producer of pos, pos + 1 once that message is published, and
+ * pos + capacity once it has been read, which is the producer turn of the
+ * next lap. Recovery marks the message of a dead producer by publishing
+ * pos + 1 with SEQ_ABANDONED set, which consumers take and throw away.
+ *
+ * The tail and head are claimed with CAS (plain stores in SPSC mode) and
+ * a slot is handed over by a release store of its sequence number that
+ * the other side loads with acquire. A process stores the position it is
+ * about to claim in its peer entry before it claims it, both sequentially
+ * consistent, so a recovering process that sees the claim also sees whose
+ * it is.
+ *
+ * A sleeper bumps the waiters count and then looks at the queue again
+ * before it sleeps; the other side publishes and then, after a full
+ * fence, reads the count. One of them sees the other, and FUTEX_WAIT on
+ * a counter the waker bumps closes the gap between looking and sleeping.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "shm_queue.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define CACHE_LINE       (64u)
+#define SHMQ_MAGIC       (0x514d4853u)           /* "SHMQ" */
+#define SHMQ_VERSION     (1u)
+
+#define POS_NONE         (UINT64_MAX)            /* Peer is not mid-operation */
+#define SEQ_ABANDONED    (1ull << 63)            /* Published by recovery */
+
+#define SPIN_TRIES       (64u)      /* Attempts before a waiter sleeps */
+#define RECOVER_SLICE_MS (20)       /* Sleep between checks for dead peers */
+#define MSEC_PER_SEC     (1000)
+#define NSEC_PER_MSEC    (1000000l)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* One attached process. Each entry has a cache line to itself. */
+typedef struct
+{
+    uint32_t pid;      /* 0 when the entry is free */
+    uint32_t reserved;
+    uint64_t enq_pos;  /* Position being produced, or POS_NONE */
+    uint64_t deq_pos;  /* Position being consumed, or POS_NONE */
+    uint8_t  pad[CACHE_LINE - 24u];
+} peer_t;
+
+/* Start of the shared memory; the slots follow. The tail, the head and
+   each futex get a cache line of their own. */
+typedef struct
+{
+    uint32_t magic;          /* Written last by the creator */
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t msg_size;
+    uint32_t slot_size;
+    uint32_t mode;
+    uint64_t map_size;
+    uint8_t  pad0[CACHE_LINE - 32u];
+    uint64_t tail;           /* Next position to produce */
+    uint8_t  pad1[CACHE_LINE - 8u];
+    uint64_t head;           /* Next position to consume */
+    uint8_t  pad2[CACHE_LINE - 8u];
+    uint32_t items;          /* Futex bumped to wake consumers */
+    uint32_t item_waiters;   /* Consumers asleep or about to be */
+    uint8_t  pad3[CACHE_LINE - 8u];
+    uint32_t spaces;         /* Futex bumped to wake producers */
+    uint32_t space_waiters;  /* Producers asleep or about to be */
+    uint8_t  pad4[CACHE_LINE - 8u];
+    peer_t   peers[SHMQ_MAX_PEERS];
+} shared_t;
+
+typedef struct
+{
+    uint64_t seq;
+    uint32_t length;
+    uint32_t reserved;
+    uint8_t  data[];
+} slot_t;
+
+struct shmq
+{
+    shared_t * p_shared;
+    uint8_t *  p_slots;
+    size_t     map_size;
+    int        fd;
+    uint32_t   capacity;
+    uint32_t   msg_size;
+    uint32_t   slot_size;
+    bool       b_spsc;
+    peer_t *   p_peer;    /* This handle's entry */
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static shmq_t * attach(int fd);
+static bool     join_peers(shmq_t * p_queue);
+static slot_t * slot_at(const shmq_t * p_queue, uint64_t pos);
+static bool     claim(uint64_t * p_end, uint64_t * p_pos, bool b_spsc);
+static bool     pid_alive(uint32_t pid);
+static bool     intent_held(const shared_t * p_shared,
+                            uint64_t         pos,
+                            bool             b_enqueue);
+static void     wake(uint32_t * p_futex, uint32_t * p_waiters, int count);
+static bool     sleep_on(uint32_t *              p_futex,
+                         uint32_t                ticket,
+                         const struct timespec * p_deadline);
+static bool     deadline_after(int32_t timeout_ms, struct timespec * p_out);
+static bool     deadline_passed(const struct timespec * p_deadline);
+static size_t   slot_size_for(uint32_t msg_size);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+shmq_t *
+shmq_create(const char * p_name,
+            uint32_t     capacity,
+            uint32_t     msg_size,
+            shmq_mode_t  mode)
+{
+    uint32_t slots = 2u;
+
+    if ((0u == capacity) || (capacity > SHMQ_MAX_CAPACITY) || (0u == msg_size)
+        || (msg_size > SHMQ_MAX_MSG_SIZE)
+        || ((SHMQ_MODE_MPMC != mode) && (SHMQ_MODE_SPSC != mode)))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    while (slots < capacity)
+    {
+        slots *= 2u;
+    }
+
+    int fd = (NULL != p_name)
+                 ? shm_open(p_name, O_RDWR | O_CREAT | O_EXCL, 0600)
+                 : memfd_create("shm_queue", MFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    size_t slot_size = slot_size_for(msg_size);
+    size_t map_size  = sizeof(shared_t) + ((size_t)slots * slot_size);
+
+    if (0 != ftruncate(fd, (off_t)map_size))
+    {
+        int error = errno;
+
+        (void)close(fd);
+        if (NULL != p_name)
+        {
+            (void)shm_unlink(p_name);
+        }
+        errno = error;
+        return NULL;
+    }
+
+    shared_t * p_shared
+        = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (MAP_FAILED == p_shared)
+    {
+        int error = errno;
+
+        (void)close(fd);
+        if (NULL != p_name)
+        {
+            (void)shm_unlink(p_name);
+        }
+        errno = error;
+        return NULL;
+    }
+
+    // ftruncate() zeroed the memory; set what is not zero
+    p_shared->version   = SHMQ_VERSION;
+    p_shared->capacity  = slots;
+    p_shared->msg_size  = msg_size;
+    p_shared->slot_size = (uint32_t)slot_size;
+    p_shared->mode      = (uint32_t)mode;
+    p_shared->map_size  = map_size;
+
+    for (uint32_t idx = 0u; idx < SHMQ_MAX_PEERS; idx++)
+    {
+        p_shared->peers[idx].enq_pos = POS_NONE;
+        p_shared->peers[idx].deq_pos = POS_NONE;
+    }
+
+    uint8_t * p_slots = (uint8_t *)p_shared + sizeof(shared_t);
+
+    for (uint32_t idx = 0u; idx < slots; idx++)
+    {
+        ((slot_t *)(void *)(p_slots + ((size_t)idx * slot_size)))->seq = idx;
+    }
+
+    __atomic_store_n(&p_shared->magic, SHMQ_MAGIC, __ATOMIC_RELEASE);
+    (void)munmap(p_shared, map_size);
+
+    shmq_t * p_queue = attach(fd);
+    int      error   = errno;
+
+    (void)close(fd);
+
+    if ((NULL == p_queue) && (NULL != p_name))
+    {
+        (void)shm_unlink(p_name);
+    }
+
+    errno = error;
+    return p_queue;
+}
+
+shmq_t *
+shmq_open(const char * p_name)
+{
+    if (NULL == p_name)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    int fd = shm_open(p_name, O_RDWR, 0);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    shmq_t * p_queue = attach(fd);
+    int      error   = errno;
+
+    (void)close(fd);
+    errno = error;
+    return p_queue;
+}
+
+shmq_t *
+shmq_open_fd(int fd)
+{
+    return attach(fd);
+}
+
+void
+shmq_close(shmq_t ** pp_queue)
+{
+    if ((NULL == pp_queue) || (NULL == *pp_queue))
+    {
+        return;
+    }
+
+    shmq_t * p_queue = *pp_queue;
+
+    __atomic_store_n(&p_queue->p_peer->enq_pos, POS_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_queue->p_peer->deq_pos, POS_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_queue->p_peer->pid, 0u, __ATOMIC_RELEASE);
+
+    (void)munmap(p_queue->p_shared, p_queue->map_size);
+    (void)close(p_queue->fd);
+    free(p_queue);
+    *pp_queue = NULL;
+}
+
+bool
+shmq_unlink(const char * p_name)
+{
+    return (NULL != p_name) && (0 == shm_unlink(p_name));
+}
+
+int
+shmq_fd(const shmq_t * p_queue)
+{
+    return (NULL == p_queue) ? -1 : p_queue->fd;
+}
+
+bool
+shmq_enqueue(shmq_t * const p_queue, const void * const p_msg, uint32_t length)
+{
+    if ((NULL == p_queue) || (NULL == p_msg) || (length > p_queue->msg_size))
+    {
+        return false;
+    }
+
+    shared_t * p_shared = p_queue->p_shared;
+    uint64_t   pos      = __atomic_load_n(&p_shared->tail, __ATOMIC_RELAXED);
+    slot_t *   p_slot   = NULL;
+
+    for (;;)
+    {
+        p_slot       = slot_at(p_queue, pos);
+        uint64_t seq = __atomic_load_n(&p_slot->seq, __ATOMIC_ACQUIRE);
+        int64_t  diff
+            = (int64_t)((seq & ~SEQ_ABANDONED) - pos);
+
+        if (0 == diff)
+        {
+            __atomic_store_n(&p_queue->p_peer->enq_pos, pos, __ATOMIC_SEQ_CST);
+
+            if (claim(&p_shared->tail, &pos, p_queue->b_spsc))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The consumer of this slot one lap ago is not done: full
+            __atomic_store_n(&p_queue->p_peer->enq_pos, POS_NONE,
+                             __ATOMIC_RELEASE);
+            return false;
+        }
+        else
+        {
+            pos = __atomic_load_n(&p_shared->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(p_slot->data, p_msg, length);
+    p_slot->length = length;
+    __atomic_store_n(&p_slot->seq, pos + 1u, __ATOMIC_RELEASE);
+    __atomic_store_n(&p_queue->p_peer->enq_pos, POS_NONE, __ATOMIC_RELEASE);
+
+    wake(&p_shared->items, &p_shared->item_waiters, 1);
+    return true;
+}
+
+bool
+shmq_dequeue(shmq_t * const p_queue, void * const p_msg, uint32_t * const p_length)
+{
+    if ((NULL == p_queue) || (NULL == p_msg) || (NULL == p_length))
+    {
+        return false;
+    }
+
+    shared_t * p_shared = p_queue->p_shared;
+    uint64_t   pos      = __atomic_load_n(&p_shared->head, __ATOMIC_RELAXED);
+
+    for (;;)
+    {
+        slot_t * p_slot = slot_at(p_queue, pos);
+        uint64_t seq    = __atomic_load_n(&p_slot->seq, __ATOMIC_ACQUIRE);
+        int64_t  diff   = (int64_t)((seq & ~SEQ_ABANDONED) - (pos + 1u));
+
+        if (diff < 0)
+        {
+            // Not published yet: empty, or a producer is mid-write
+            __atomic_store_n(&p_queue->p_peer->deq_pos, POS_NONE,
+                             __ATOMIC_RELEASE);
+            return false;
+        }
+
+        if (diff > 0)
+        {
+            pos = __atomic_load_n(&p_shared->head, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        __atomic_store_n(&p_queue->p_peer->deq_pos, pos, __ATOMIC_SEQ_CST);
+
+        uint64_t claimed = pos;
+
+        if (!claim(&p_shared->head, &pos, p_queue->b_spsc))
+        {
+            continue;
+        }
+
+        bool b_abandoned = (0u != (seq & SEQ_ABANDONED));
+
+        if (!b_abandoned)
+        {
+            *p_length = p_slot->length;
+            memcpy(p_msg, p_slot->data, p_slot->length);
+        }
+
+        __atomic_store_n(&p_slot->seq, claimed + p_queue->capacity,
+                         __ATOMIC_RELEASE);
+        __atomic_store_n(&p_queue->p_peer->deq_pos, POS_NONE,
+                         __ATOMIC_RELEASE);
+        wake(&p_shared->spaces, &p_shared->space_waiters, 1);
+
+        if (!b_abandoned)
+        {
+            return true;
+        }
+
+        // A dead producer's slot: move on to the next position
+        pos = claimed + 1u;
+    }
+}
+
+bool
+shmq_enqueue_wait(shmq_t * const     p_queue,
+                  const void * const p_msg,
+                  uint32_t           length,
+                  int32_t            timeout_ms)
+{
+    struct timespec deadline;
+    bool            b_deadline = deadline_after(timeout_ms, &deadline);
+
+    if ((NULL == p_queue) || (NULL == p_msg) || (length > p_queue->msg_size))
+    {
+        return false;
+    }
+
+    shared_t * p_shared = p_queue->p_shared;
+
+    for (;;)
+    {
+        for (uint32_t spin = 0u; spin < SPIN_TRIES; spin++)
+        {
+            if (shmq_enqueue(p_queue, p_msg, length))
+            {
+                return true;
+            }
+        }
+
+        uint32_t ticket = __atomic_load_n(&p_shared->spaces, __ATOMIC_ACQUIRE);
+
+        (void)__atomic_add_fetch(&p_shared->space_waiters, 1u,
+                                 __ATOMIC_SEQ_CST);
+
+        bool b_done     = shmq_enqueue(p_queue, p_msg, length);
+        bool b_timedout = !b_done
+                          && !sleep_on(&p_shared->spaces, ticket,
+                                       b_deadline ? &deadline : NULL);
+
+        (void)__atomic_sub_fetch(&p_shared->space_waiters, 1u,
+                                 __ATOMIC_SEQ_CST);
+
+        if (b_done)
+        {
+            return true;
+        }
+
+        if (b_timedout)
+        {
+            // Full for a while: perhaps a consumer died holding a slot
+            (void)shmq_recover(p_queue);
+        }
+
+        if (b_deadline && deadline_passed(&deadline))
+        {
+            return shmq_enqueue(p_queue, p_msg, length);
+        }
+    }
+}
+
+bool
+shmq_dequeue_wait(shmq_t * const   p_queue,
+                  void * const     p_msg,
+                  uint32_t * const p_length,
+                  int32_t          timeout_ms)
+{
+    struct timespec deadline;
+    bool            b_deadline = deadline_after(timeout_ms, &deadline);
+
+    if ((NULL == p_queue) || (NULL == p_msg) || (NULL == p_length))
+    {
+        return false;
+    }
+
+    shared_t * p_shared = p_queue->p_shared;
+
+    for (;;)
+    {
+        for (uint32_t spin = 0u; spin < SPIN_TRIES; spin++)
+        {
+            if (shmq_dequeue(p_queue, p_msg, p_length))
+            {
+                return true;
+            }
+        }
+
+        uint32_t ticket = __atomic_load_n(&p_shared->items, __ATOMIC_ACQUIRE);
+
+        (void)__atomic_add_fetch(&p_shared->item_waiters, 1u,
+                                 __ATOMIC_SEQ_CST);
+
+        bool b_done     = shmq_dequeue(p_queue, p_msg, p_length);
+        bool b_timedout = !b_done
+                          && !sleep_on(&p_shared->items, ticket,
+                                       b_deadline ? &deadline : NULL);
+
+        (void)__atomic_sub_fetch(&p_shared->item_waiters, 1u,
+                                 __ATOMIC_SEQ_CST);
+
+        if (b_done)
+        {
+            return true;
+        }
+
+        if (b_timedout)
+        {
+            // Empty for a while: perhaps a producer died mid-write
+            (void)shmq_recover(p_queue);
+        }
+
+        if (b_deadline && deadline_passed(&deadline))
+        {
+            return shmq_dequeue(p_queue, p_msg, p_length);
+        }
+    }
+}
+
+uint32_t
+shmq_recover(shmq_t * const p_queue)
+{
+    uint32_t reclaimed = 0u;
+
+    if (NULL == p_queue)
+    {
+        return 0u;
+    }
+
+    shared_t * p_shared = p_queue->p_shared;
+
+    for (uint32_t idx = 0u; idx < SHMQ_MAX_PEERS; idx++)
+    {
+        peer_t * p_peer = &p_shared->peers[idx];
+        uint32_t pid    = __atomic_load_n(&p_peer->pid, __ATOMIC_ACQUIRE);
+
+        if ((0u == pid) || pid_alive(pid))
+        {
+            continue;
+        }
+
+        bool     b_settled = true;
+        uint64_t enq_pos   = __atomic_load_n(&p_peer->enq_pos, __ATOMIC_SEQ_CST);
+        uint64_t deq_pos   = __atomic_load_n(&p_peer->deq_pos, __ATOMIC_SEQ_CST);
+
+        // Claimed but never published: publish it as abandoned, unless a
+        // live producer is the one that claimed it
+        if (POS_NONE != enq_pos)
+        {
+            slot_t * p_slot   = slot_at(p_queue, enq_pos);
+            uint64_t expected = enq_pos;
+            bool     b_stuck
+                = (__atomic_load_n(&p_slot->seq, __ATOMIC_SEQ_CST) == enq_pos)
+                  && (__atomic_load_n(&p_shared->tail, __ATOMIC_SEQ_CST)
+                      > enq_pos);
+
+            if (b_stuck && intent_held(p_shared, enq_pos, true))
+            {
+                b_settled = false;
+            }
+            else if (b_stuck
+                     && __atomic_compare_exchange_n(
+                         &p_slot->seq, &expected,
+                         (enq_pos + 1u) | SEQ_ABANDONED, false,
+                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            {
+                reclaimed++;
+            }
+        }
+
+        // Claimed but never released: free the slot for the next lap
+        if (POS_NONE != deq_pos)
+        {
+            slot_t * p_slot   = slot_at(p_queue, deq_pos);
+            uint64_t seq      = __atomic_load_n(&p_slot->seq, __ATOMIC_SEQ_CST);
+            uint64_t expected = seq;
+            bool     b_stuck
+                = ((seq & ~SEQ_ABANDONED) == (deq_pos + 1u))
+                  && (__atomic_load_n(&p_shared->head, __ATOMIC_SEQ_CST)
+                      > deq_pos);
+
+            if (b_stuck && intent_held(p_shared, deq_pos, false))
+            {
+                b_settled = false;
+            }
+            else if (b_stuck
+                     && __atomic_compare_exchange_n(
+                         &p_slot->seq, &expected,
+                         deq_pos + p_queue->capacity, false,
+                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            {
+                reclaimed++;
+            }
+        }
+
+        // Keep the entry of a peer whose slot could not be judged yet
+        if (b_settled)
+        {
+            __atomic_store_n(&p_peer->enq_pos, POS_NONE, __ATOMIC_RELAXED);
+            __atomic_store_n(&p_peer->deq_pos, POS_NONE, __ATOMIC_RELAXED);
+            (void)__atomic_compare_exchange_n(&p_peer->pid, &pid, 0u, false,
+                                              __ATOMIC_RELEASE,
+                                              __ATOMIC_RELAXED);
+        }
+    }
+
+    if (reclaimed > 0u)
+    {
+        wake(&p_shared->items, &p_shared->item_waiters, INT_MAX);
+        wake(&p_shared->spaces, &p_shared->space_waiters, INT_MAX);
+    }
+
+    return reclaimed;
+}
+
+uint32_t
+shmq_size(const shmq_t * p_queue)
+{
+    if (NULL == p_queue)
+    {
+        return 0u;
+    }
+
+    uint64_t head = __atomic_load_n(&p_queue->p_shared->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&p_queue->p_shared->tail, __ATOMIC_ACQUIRE);
+    uint64_t size = (tail > head) ? (tail - head) : 0u;
+
+    return (size > p_queue->capacity) ? p_queue->capacity : (uint32_t)size;
+}
+
+uint32_t
+shmq_msg_size(const shmq_t * p_queue)
+{
+    return (NULL == p_queue) ? 0u : p_queue->msg_size;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Maps a queue's memory, checks it and joins its peers.
+ *
+ * @param[in] fd Descriptor of the memory; duplicated, not taken over
+ *
+ * @return Handle, or NULL on failure (errno is set)
+ */
+static shmq_t *
+attach(int fd)
+{
+    struct stat info;
+
+    if (0 != fstat(fd, &info))
+    {
+        return NULL;
+    }
+
+    if (info.st_size < (off_t)sizeof(shared_t))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t     map_size = (size_t)info.st_size;
+    shared_t * p_shared
+        = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (MAP_FAILED == p_shared)
+    {
+        return NULL;
+    }
+
+    // The creator may still be setting it up; its magic comes last
+    uint32_t capacity = p_shared->capacity;
+    bool     b_valid
+        = (SHMQ_MAGIC == __atomic_load_n(&p_shared->magic, __ATOMIC_ACQUIRE))
+          && (SHMQ_VERSION == p_shared->version) && (capacity >= 2u)
+          && (capacity <= SHMQ_MAX_CAPACITY)
+          && (0u == (capacity & (capacity - 1u)))
+          && (p_shared->msg_size <= SHMQ_MAX_MSG_SIZE)
+          && (p_shared->slot_size == slot_size_for(p_shared->msg_size))
+          && (p_shared->map_size == map_size)
+          && (map_size == sizeof(shared_t)
+                              + ((size_t)capacity * p_shared->slot_size));
+
+    shmq_t * p_queue = b_valid ? calloc(1u, sizeof(*p_queue)) : NULL;
+
+    if (NULL == p_queue)
+    {
+        (void)munmap(p_shared, map_size);
+        errno = b_valid ? ENOMEM : EINVAL;
+        return NULL;
+    }
+
+    p_queue->p_shared  = p_shared;
+    p_queue->p_slots   = (uint8_t *)p_shared + sizeof(shared_t);
+    p_queue->map_size  = map_size;
+    p_queue->capacity  = capacity;
+    p_queue->msg_size  = p_shared->msg_size;
+    p_queue->slot_size = p_shared->slot_size;
+    p_queue->b_spsc    = ((uint32_t)SHMQ_MODE_SPSC == p_shared->mode);
+    p_queue->fd        = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+
+    if ((p_queue->fd < 0) || !join_peers(p_queue))
+    {
+        int error = (p_queue->fd < 0) ? errno : EMFILE;
+
+        if (p_queue->fd >= 0)
+        {
+            (void)close(p_queue->fd);
+        }
+        (void)munmap(p_shared, map_size);
+        free(p_queue);
+        errno = error;
+        return NULL;
+    }
+
+    return p_queue;
+}
+
+/* Takes a free peer entry, clearing out dead peers if there is none */
+static bool
+join_peers(shmq_t * p_queue)
+{
+    uint32_t pid = (uint32_t)getpid();
+
+    for (uint32_t attempt = 0u; attempt < 2u; attempt++)
+    {
+        for (uint32_t idx = 0u; idx < SHMQ_MAX_PEERS; idx++)
+        {
+            peer_t * p_peer = &p_queue->p_shared->peers[idx];
+            uint32_t unused = 0u;
+
+            if (__atomic_compare_exchange_n(&p_peer->pid, &unused, pid, false,
+                                            __ATOMIC_ACQ_REL,
+                                            __ATOMIC_RELAXED))
+            {
+                p_queue->p_peer = p_peer;
+                return true;
+            }
+        }
+
+        // recover() only needs the slots; the handle has no entry yet
+        (void)shmq_recover(p_queue);
+    }
+
+    return false;
+}
+
+static slot_t *
+slot_at(const shmq_t * p_queue, uint64_t pos)
+{
+    size_t idx = (size_t)(pos & (uint64_t)(p_queue->capacity - 1u));
+
+    return (slot_t *)(void *)(p_queue->p_slots + (idx * p_queue->slot_size));
+}
+
+/*!
+ * @brief Moves a tail or head on from *p_pos.
+ *
+ * @param[in,out] p_end  Tail or head
+ * @param[in,out] p_pos  Position to claim; on failure, the current value
+ * @param[in]     b_spsc Only this process moves *p_end
+ *
+ * @return true if the position was claimed
+ */
+static bool
+claim(uint64_t * p_end, uint64_t * p_pos, bool b_spsc)
+{
+    if (b_spsc)
+    {
+        __atomic_store_n(p_end, *p_pos + 1u, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    return __atomic_compare_exchange_n(p_end, p_pos, *p_pos + 1u, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+static bool
+pid_alive(uint32_t pid)
+{
+    return (0 == kill((pid_t)pid, 0)) || (EPERM == errno);
+}
+
+/* Whether a live peer has said it is producing (or consuming) pos */
+static bool
+intent_held(const shared_t * p_shared, uint64_t pos, bool b_enqueue)
+{
+    for (uint32_t idx = 0u; idx < SHMQ_MAX_PEERS; idx++)
+    {
+        const peer_t * p_peer = &p_shared->peers[idx];
+        uint64_t       intent = b_enqueue
+                                    ? __atomic_load_n(&p_peer->enq_pos,
+                                                      __ATOMIC_SEQ_CST)
+                                    : __atomic_load_n(&p_peer->deq_pos,
+                                                      __ATOMIC_SEQ_CST);
+        uint32_t       pid = __atomic_load_n(&p_peer->pid, __ATOMIC_ACQUIRE);
+
+        if ((intent == pos) && (0u != pid) && pid_alive(pid))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Wakes up to count sleepers, with no system call when there are none */
+static void
+wake(uint32_t * p_futex, uint32_t * p_waiters, int count)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (0u == __atomic_load_n(p_waiters, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    (void)__atomic_add_fetch(p_futex, 1u, __ATOMIC_RELEASE);
+    (void)syscall(SYS_futex, p_futex, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+/*!
+ * @brief Sleeps while *p_futex is ticket, for at most RECOVER_SLICE_MS
+ *        and not past the deadline.
+ *
+ * @return false if the sleep ran its full slice, true if it was woken or
+ *         the value had already moved on
+ */
+static bool
+sleep_on(uint32_t * p_futex, uint32_t ticket, const struct timespec * p_deadline)
+{
+    struct timespec slice = { 0, RECOVER_SLICE_MS * NSEC_PER_MSEC };
+
+    if (NULL != p_deadline)
+    {
+        struct timespec now;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+        long left_ns = ((long)(p_deadline->tv_sec - now.tv_sec) * MSEC_PER_SEC
+                        * NSEC_PER_MSEC)
+                       + (p_deadline->tv_nsec - now.tv_nsec);
+
+        if (left_ns <= 0)
+        {
+            return false;
+        }
+
+        if (left_ns < slice.tv_nsec)
+        {
+            slice.tv_nsec = left_ns;
+        }
+    }
+
+    // Not FUTEX_PRIVATE_FLAG: the word is shared between processes
+    long result = syscall(SYS_futex, p_futex, FUTEX_WAIT, ticket, &slice,
+                          NULL, 0);
+
+    return (0 == result) || (ETIMEDOUT != errno);
+}
+
+/*!
+ * @brief Works out the CLOCK_MONOTONIC time timeout_ms from now.
+ *
+ * @return false if there is no deadline (SHMQ_WAIT_FOREVER)
+ */
+static bool
+deadline_after(int32_t timeout_ms, struct timespec * p_out)
+{
+    if (timeout_ms < 0)
+    {
+        return false;
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, p_out);
+
+    p_out->tv_sec += timeout_ms / MSEC_PER_SEC;
+    p_out->tv_nsec += (long)(timeout_ms % MSEC_PER_SEC) * NSEC_PER_MSEC;
+
+    if (p_out->tv_nsec >= (long)MSEC_PER_SEC * NSEC_PER_MSEC)
+    {
+        p_out->tv_sec++;
+        p_out->tv_nsec -= (long)MSEC_PER_SEC * NSEC_PER_MSEC;
+    }
+
+    return true;
+}
+
+static bool
+deadline_passed(const struct timespec * p_deadline)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec > p_deadline->tv_sec)
+           || ((now.tv_sec == p_deadline->tv_sec)
+               && (now.tv_nsec >= p_deadline->tv_nsec));
+}
+
+/* A slot is its header and the message, rounded up to whole cache lines
+   so that neighbouring slots do not share one */
+static size_t
+slot_size_for(uint32_t msg_size)
+{
+    size_t size = sizeof(slot_t) + msg_size;
+
+    return (size + CACHE_LINE - 1u) & ~(size_t)(CACHE_LINE - 1u);
+}
+
+/*** end of file ***/
@@ -0,0 +1,230 @@
+/** @file shm_queue.h
+ *
+ * @brief Bounded FIFO of fixed-size messages in shared memory, for handing
+ *        work between processes on one host.
+ *
+ * The queue lives in a memory object every process maps: a POSIX shared
+ * memory object when it is given a name, or an anonymous memfd otherwise,
+ * whose descriptor is inherited over fork() or passed over a Unix socket.
+ * A message is copied into a slot of a ring, so no pointers cross
+ * processes. Each slot carries a sequence number that says whose turn it
+ * is, the design of Dmitry Vyukov's bounded MPMC queue: a producer claims
+ * a position with one compare-and-swap on the tail, fills the slot and
+ * publishes it by advancing the slot's sequence; consumers do the same on
+ * the head. With SHMQ_MODE_SPSC, one producer and one consumer process
+ * claim positions with plain stores instead.
+ *
+ * shmq_enqueue() and shmq_dequeue() never block, like queue_enqueue() and
+ * queue_dequeue(). The *_wait variants sleep on a futex in the shared
+ * memory while the queue is full or empty, and are woken by the other
+ * side; a process only makes the wake-up system call when someone sleeps.
+ *
+ * A process that dies between claiming a position and publishing it
+ * would leave every later consumer (or producer, one lap later) waiting
+ * on that slot. Each attached process therefore records the position it
+ * is working on in a table in the shared memory. shmq_recover() looks up
+ * the processes in the table that no longer exist and reclaims the slots
+ * they left half done: a message being written is dropped, and the slot
+ * of a message being read is freed, the message being lost with its
+ * reader. The *_wait functions call it themselves when the queue stays
+ * stuck. Liveness is checked with kill(pid, 0), so all processes must
+ * share a PID namespace, and a dead process whose PID is reused before
+ * recovery runs looks alive.
+ *
+ * A handle belongs to the process that made it: after fork(), the child
+ * opens its own handle with shmq_open_fd(shmq_fd(p_parent_handle)).
+ * Handles are not to be shared between threads without a lock.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef SHM_QUEUE_H
+#define SHM_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define SHMQ_MAX_PEERS    (64u)         /* Processes attached at once */
+#define SHMQ_MAX_CAPACITY (1u << 24)    /* Slots in one queue */
+#define SHMQ_MAX_MSG_SIZE (1u << 20)    /* Bytes in one message */
+
+#define SHMQ_WAIT_FOREVER (-1)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef enum
+{
+    SHMQ_MODE_MPMC,  /* Any number of producers and consumers */
+    SHMQ_MODE_SPSC   /* One producer process and one consumer process */
+} shmq_mode_t;
+
+typedef struct shmq shmq_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Creates a queue in new shared memory and attaches to it.
+ *
+ * @param[in] p_name   POSIX shared memory name ("/name"), which must not
+ *                     exist yet; NULL for an anonymous memfd
+ * @param[in] capacity Number of slots, rounded up to a power of two
+ * @param[in] msg_size Largest message, in bytes
+ * @param[in] mode     SHMQ_MODE_MPMC or SHMQ_MODE_SPSC
+ *
+ * @return Handle, or NULL on failure (errno is set)
+ */
+shmq_t *
+shmq_create(const char * p_name,
+            uint32_t     capacity,
+            uint32_t     msg_size,
+            shmq_mode_t  mode);
+
+/*!
+ * @brief Attaches to a queue another process created with a name.
+ *
+ * @param[in] p_name POSIX shared memory name given to shmq_create()
+ *
+ * @return Handle, or NULL on failure (errno is set)
+ */
+shmq_t *
+shmq_open(const char * p_name);
+
+/*!
+ * @brief Attaches to a queue through a descriptor of its memory, e.g. one
+ *        inherited over fork() or received over a Unix socket. The
+ *        descriptor is duplicated; the caller keeps its own.
+ *
+ * @param[in] fd Descriptor from shmq_fd()
+ *
+ * @return Handle, or NULL on failure (errno is set)
+ */
+shmq_t *
+shmq_open_fd(int fd);
+
+/*!
+ * @brief Detaches from a queue. The memory goes when the last process
+ *        unmaps it and, for a named queue, once it is unlinked.
+ *
+ * @param[in,out] pp_queue Pointer to the handle; set to NULL
+ */
+void
+shmq_close(shmq_t ** pp_queue);
+
+/*!
+ * @brief Removes a queue's name. Processes attached keep using it.
+ *
+ * @param[in] p_name POSIX shared memory name given to shmq_create()
+ *
+ * @return true on success, false otherwise (errno is set)
+ */
+bool
+shmq_unlink(const char * p_name);
+
+/*!
+ * @brief Descriptor of the queue's memory, for shmq_open_fd().
+ *
+ * @return Descriptor, or -1 if p_queue is NULL
+ */
+int
+shmq_fd(const shmq_t * p_queue);
+
+/*!
+ * @brief Adds a message at the back of the queue without blocking.
+ *
+ * @param[in,out] p_queue Queue
+ * @param[in]     p_msg   Message
+ * @param[in]     length  Bytes in the message, at most the message size
+ *
+ * @return true on success, false if the queue is full or the parameters
+ *         are invalid
+ */
+bool
+shmq_enqueue(shmq_t * const p_queue, const void * const p_msg, uint32_t length);
+
+/*!
+ * @brief Removes the message at the front of the queue without blocking.
+ *
+ * @param[in,out] p_queue  Queue
+ * @param[out]    p_msg    Buffer of at least the message size
+ * @param[out]    p_length Bytes in the message
+ *
+ * @return true on success, false if the queue is empty or the parameters
+ *         are invalid
+ */
+bool
+shmq_dequeue(shmq_t * const p_queue, void * const p_msg, uint32_t * const p_length);
+
+/*!
+ * @brief Adds a message at the back of the queue, sleeping while it is
+ *        full.
+ *
+ * @param[in,out] p_queue    Queue
+ * @param[in]     p_msg      Message
+ * @param[in]     length     Bytes in the message, at most the message size
+ * @param[in]     timeout_ms Longest wait, or SHMQ_WAIT_FOREVER
+ *
+ * @return true on success, false on timeout or invalid parameters
+ */
+bool
+shmq_enqueue_wait(shmq_t * const     p_queue,
+                  const void * const p_msg,
+                  uint32_t           length,
+                  int32_t            timeout_ms);
+
+/*!
+ * @brief Removes the message at the front of the queue, sleeping while it
+ *        is empty.
+ *
+ * @param[in,out] p_queue    Queue
+ * @param[out]    p_msg      Buffer of at least the message size
+ * @param[out]    p_length   Bytes in the message
+ * @param[in]     timeout_ms Longest wait, or SHMQ_WAIT_FOREVER
+ *
+ * @return true on success, false on timeout or invalid parameters
+ */
+bool
+shmq_dequeue_wait(shmq_t * const   p_queue,
+                  void * const     p_msg,
+                  uint32_t * const p_length,
+                  int32_t          timeout_ms);
+
+/*!
+ * @brief Reclaims the slots that attached processes which have since died
+ *        left half written or half read, and frees their table entries.
+ *
+ * @param[in,out] p_queue Queue
+ *
+ * @return Number of slots reclaimed
+ */
+uint32_t
+shmq_recover(shmq_t * const p_queue);
+
+/*!
+ * @brief Number of messages in the queue, counting those being written or
+ *        read; only a snapshot while other processes use it.
+ *
+ * @return Number of messages, or 0 if p_queue is NULL
+ */
+uint32_t
+shmq_size(const shmq_t * p_queue);
+
+/*!
+ * @brief Largest message the queue takes, in bytes.
+ *
+ * @return Message size, or 0 if p_queue is NULL
+ */
+uint32_t
+shmq_msg_size(const shmq_t * p_queue);
+
+#endif /* SHM_QUEUE_H */
+
+/*** end of file ***/
@@ -0,0 +1,506 @@
+/** @file shm_queue_bench.c
+ *
+ * @brief Handing messages to another process: a shmq_t against Unix
+ *        domain sockets.
+ *
+ * A child process echoes UNIX_SERVER_MAX_MSG_LEN-byte messages back to
+ * the parent over, in turn:
+ *
+ * - shmq:    a request and a reply shmq_t in a memfd, in SPSC mode, with
+ *            the child sleeping in shmq_dequeue_wait();
+ * - socket:  one connected AF_UNIX stream socket held open;
+ * - connect: a connection per message, accepted, read, echoed and closed
+ *            the way unix_server.c serves its clients.
+ *
+ * Each path is timed twice. Ping-pong sends a message and waits for its
+ * echo before the next, and gives the round-trip latency. Stream sends
+ * all messages without waiting, the child echoing only the last, and
+ * gives messages per second one way. Every echo is checked against what
+ * was sent.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L shm_queue_bench.c
+ *        shm_queue.c
+ *
+ * Usage: shm_queue_bench [messages]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "shm_queue.h"
+#include "../../C_Server/unix_server.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_MESSAGES (100000u)
+#define MSG_LEN          (UNIX_SERVER_MAX_MSG_LEN)
+#define QUEUE_CAPACITY   (1024u)
+#define NSEC_PER_SEC     (1000000000ull)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef enum
+{
+    PATH_SHMQ,
+    PATH_SOCKET,
+    PATH_CONNECT,
+    PATH_COUNT
+} path_t;
+
+/* One way between parent and child; each side uses its own fields */
+typedef struct
+{
+    path_t             path;
+    shmq_t *           p_requests;
+    shmq_t *           p_replies;
+    int                fds[2];     /* Socket pair: parent's end, child's */
+    int                listen_fd;
+    int                conn_fd;    /* Connection of the current message */
+    struct sockaddr_un addr;
+} link_t;
+
+typedef struct
+{
+    double p50_us;
+    double p99_us;
+    double mean_us;
+    double msgs_per_sec;
+} result_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const char * const g_path_names[PATH_COUNT] = {
+    "shmq", "socket", "connect"
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static bool     link_open(link_t * p_link, path_t path);
+static void     link_close(link_t * p_link);
+static bool     run(path_t path, uint32_t count, bool b_ping_pong,
+                    result_t * p_result, uint64_t * p_rtt_ns);
+static void     serve(link_t * p_link, uint32_t count, bool b_echo_all);
+static bool     client_send(link_t * p_link, const uint8_t * p_msg);
+static bool     client_recv(link_t * p_link, uint8_t * p_msg);
+static void     client_done(link_t * p_link);
+static bool     read_full(int fd, uint8_t * p_buf, size_t length);
+static bool     write_full(int fd, const uint8_t * p_buf, size_t length);
+static int      compare_u64(const void * p_data1, const void * p_data2);
+static uint64_t now_ns(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t count = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10)
+                                : DEFAULT_MESSAGES;
+
+    if (0u == count)
+    {
+        fprintf(stderr, "usage: shm_queue_bench [messages]\n");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t * p_rtt_ns = malloc((size_t)count * sizeof(uint64_t));
+
+    if (NULL == p_rtt_ns)
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u messages of %u bytes\n\n", count, MSG_LEN);
+    printf("%-8s %10s %10s %10s %12s\n", "path", "p50 us", "p99 us",
+           "mean us", "msg/s");
+
+    int status = EXIT_SUCCESS;
+
+    for (int path = 0; path < (int)PATH_COUNT; path++)
+    {
+        result_t result;
+
+        if (!run((path_t)path, count, true, &result, p_rtt_ns)
+            || !run((path_t)path, count, false, &result, NULL))
+        {
+            printf("%-8s failed\n", g_path_names[path]);
+            status = EXIT_FAILURE;
+            continue;
+        }
+
+        printf("%-8s %10.2f %10.2f %10.2f %12.0f\n", g_path_names[path],
+               result.p50_us, result.p99_us, result.mean_us,
+               result.msgs_per_sec);
+    }
+
+    free(p_rtt_ns);
+
+    return status;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static bool
+link_open(link_t * p_link, path_t path)
+{
+    memset(p_link, 0, sizeof(*p_link));
+    p_link->path      = path;
+    p_link->fds[0]    = -1;
+    p_link->fds[1]    = -1;
+    p_link->listen_fd = -1;
+    p_link->conn_fd   = -1;
+
+    switch (path)
+    {
+        case PATH_SHMQ:
+            p_link->p_requests
+                = shmq_create(NULL, QUEUE_CAPACITY, MSG_LEN, SHMQ_MODE_SPSC);
+            p_link->p_replies
+                = shmq_create(NULL, QUEUE_CAPACITY, MSG_LEN, SHMQ_MODE_SPSC);
+            return (NULL != p_link->p_requests) && (NULL != p_link->p_replies);
+
+        case PATH_SOCKET:
+            return 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, p_link->fds);
+
+        case PATH_CONNECT:
+            p_link->addr.sun_family = AF_UNIX;
+            (void)snprintf(p_link->addr.sun_path, sizeof(p_link->addr.sun_path),
+                           "/tmp/shm_queue_bench.%ld.sock", (long)getpid());
+            (void)unlink(p_link->addr.sun_path);
+            p_link->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+            return (p_link->listen_fd >= 0)
+                   && (0 == bind(p_link->listen_fd,
+                                 (struct sockaddr *)&p_link->addr,
+                                 sizeof(p_link->addr)))
+                   && (0 == listen(p_link->listen_fd,
+                                   UNIX_SERVER_LISTEN_BACKLOG));
+
+        default:
+            return false;
+    }
+}
+
+static void
+link_close(link_t * p_link)
+{
+    shmq_close(&p_link->p_requests);
+    shmq_close(&p_link->p_replies);
+
+    for (int idx = 0; idx < 2; idx++)
+    {
+        if (p_link->fds[idx] >= 0)
+        {
+            (void)close(p_link->fds[idx]);
+        }
+    }
+
+    if (p_link->listen_fd >= 0)
+    {
+        (void)close(p_link->listen_fd);
+        (void)unlink(p_link->addr.sun_path);
+    }
+}
+
+/*!
+ * @brief Times count messages to an echoing child over one path.
+ *
+ * @param[in]  path        Way to the child
+ * @param[in]  count       Messages to send
+ * @param[in]  b_ping_pong Wait for each echo (latency) or stream them
+ *                         (messages per second)
+ * @param[out] p_result    Latency or rate, whichever was measured
+ * @param[out] p_rtt_ns    count round-trip times, for ping-pong
+ *
+ * @return true on success, false if a message went wrong
+ */
+static bool
+run(path_t path, uint32_t count, bool b_ping_pong, result_t * p_result,
+    uint64_t * p_rtt_ns)
+{
+    link_t link;
+
+    if (!link_open(&link, path))
+    {
+        link_close(&link);
+        return false;
+    }
+
+    pid_t child = fork();
+
+    if (child < 0)
+    {
+        link_close(&link);
+        return false;
+    }
+
+    if (0 == child)
+    {
+        serve(&link, count, b_ping_pong);
+    }
+
+    if (PATH_SOCKET == path)
+    {
+        (void)close(link.fds[1]);
+        link.fds[1] = -1;
+    }
+
+    uint8_t  msg[MSG_LEN];
+    uint8_t  echo[MSG_LEN];
+    bool     b_ok     = true;
+    uint64_t start_ns = now_ns();
+
+    memset(msg, 'm', sizeof(msg));
+
+    for (uint32_t idx = 0u; b_ok && (idx < count); idx++)
+    {
+        bool     b_wait  = b_ping_pong || (idx + 1u == count);
+        uint64_t sent_ns = now_ns();
+
+        memcpy(msg, &idx, sizeof(idx));
+        b_ok = client_send(&link, msg);
+
+        if (b_ok && b_wait)
+        {
+            b_ok = client_recv(&link, echo) && (0 == memcmp(msg, echo, MSG_LEN));
+        }
+
+        client_done(&link);
+
+        if (b_ping_pong)
+        {
+            p_rtt_ns[idx] = now_ns() - sent_ns;
+        }
+    }
+
+    uint64_t elapsed_ns = now_ns() - start_ns;
+    int      child_status;
+
+    if (!b_ok)
+    {
+        (void)kill(child, SIGKILL);
+    }
+
+    b_ok = (child == waitpid(child, &child_status, 0)) && b_ok
+           && WIFEXITED(child_status) && (0 == WEXITSTATUS(child_status));
+    link_close(&link);
+
+    if (!b_ok)
+    {
+        return false;
+    }
+
+    if (!b_ping_pong)
+    {
+        p_result->msgs_per_sec = (double)count * (double)NSEC_PER_SEC
+                                 / (double)elapsed_ns;
+        return true;
+    }
+
+    qsort(p_rtt_ns, count, sizeof(uint64_t), compare_u64);
+
+    p_result->p50_us  = (double)p_rtt_ns[count / 2u] / 1e3;
+    p_result->p99_us  = (double)p_rtt_ns[(uint32_t)((uint64_t)count * 99u / 100u)]
+                        / 1e3;
+    p_result->mean_us = (double)elapsed_ns / (double)count / 1e3;
+
+    return true;
+}
+
+/* The child: echoes every message, or only the last, then exits */
+static void
+serve(link_t * p_link, uint32_t count, bool b_echo_all)
+{
+    uint8_t  msg[MSG_LEN];
+    uint32_t length = 0u;
+    bool     b_ok   = true;
+    shmq_t * p_requests = NULL;
+    shmq_t * p_replies  = NULL;
+
+    // A handle belongs to the process that made it
+    if (PATH_SHMQ == p_link->path)
+    {
+        p_requests = shmq_open_fd(shmq_fd(p_link->p_requests));
+        p_replies  = shmq_open_fd(shmq_fd(p_link->p_replies));
+        b_ok       = (NULL != p_requests) && (NULL != p_replies);
+    }
+
+    for (uint32_t idx = 0u; b_ok && (idx < count); idx++)
+    {
+        bool b_echo = b_echo_all || (idx + 1u == count);
+        int  fd     = p_link->fds[1];
+
+        switch (p_link->path)
+        {
+            case PATH_SHMQ:
+                b_ok = shmq_dequeue_wait(p_requests, msg, &length,
+                                         SHMQ_WAIT_FOREVER)
+                       && (!b_echo
+                           || shmq_enqueue_wait(p_replies, msg, length,
+                                                SHMQ_WAIT_FOREVER));
+                break;
+
+            case PATH_CONNECT:
+                fd = accept(p_link->listen_fd, NULL, NULL);
+                b_ok = (fd >= 0);
+                // fall through
+
+            case PATH_SOCKET:
+                b_ok = b_ok && read_full(fd, msg, MSG_LEN)
+                       && (!b_echo || write_full(fd, msg, MSG_LEN));
+
+                if ((PATH_CONNECT == p_link->path) && (fd >= 0))
+                {
+                    (void)close(fd);
+                }
+                break;
+
+            default:
+                b_ok = false;
+                break;
+        }
+    }
+
+    shmq_close(&p_requests);
+    shmq_close(&p_replies);
+    _exit(b_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static bool
+client_send(link_t * p_link, const uint8_t * p_msg)
+{
+    switch (p_link->path)
+    {
+        case PATH_SHMQ:
+            return shmq_enqueue_wait(p_link->p_requests, p_msg, MSG_LEN,
+                                     SHMQ_WAIT_FOREVER);
+
+        case PATH_SOCKET:
+            return write_full(p_link->fds[0], p_msg, MSG_LEN);
+
+        case PATH_CONNECT:
+            p_link->conn_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+            return (p_link->conn_fd >= 0)
+                   && (0 == connect(p_link->conn_fd,
+                                    (struct sockaddr *)&p_link->addr,
+                                    sizeof(p_link->addr)))
+                   && write_full(p_link->conn_fd, p_msg, MSG_LEN);
+
+        default:
+            return false;
+    }
+}
+
+static bool
+client_recv(link_t * p_link, uint8_t * p_msg)
+{
+    uint32_t length = 0u;
+
+    switch (p_link->path)
+    {
+        case PATH_SHMQ:
+            return shmq_dequeue_wait(p_link->p_replies, p_msg, &length,
+                                     SHMQ_WAIT_FOREVER)
+                   && (MSG_LEN == length);
+
+        case PATH_SOCKET:
+            return read_full(p_link->fds[0], p_msg, MSG_LEN);
+
+        case PATH_CONNECT:
+            return read_full(p_link->conn_fd, p_msg, MSG_LEN);
+
+        default:
+            return false;
+    }
+}
+
+/* Ends a message's connection, on the path that makes one per message */
+static void
+client_done(link_t * p_link)
+{
+    if (p_link->conn_fd >= 0)
+    {
+        (void)close(p_link->conn_fd);
+        p_link->conn_fd = -1;
+    }
+}
+
+static bool
+read_full(int fd, uint8_t * p_buf, size_t length)
+{
+    while (length > 0u)
+    {
+        ssize_t got = read(fd, p_buf, length);
+
+        if (got <= 0)
+        {
+            return false;
+        }
+
+        p_buf += got;
+        length -= (size_t)got;
+    }
+
+    return true;
+}
+
+static bool
+write_full(int fd, const uint8_t * p_buf, size_t length)
+{
+    while (length > 0u)
+    {
+        ssize_t put = write(fd, p_buf, length);
+
+        if (put <= 0)
+        {
+            return false;
+        }
+
+        p_buf += put;
+        length -= (size_t)put;
+    }
+
+    return true;
+}
+
+static int
+compare_u64(const void * p_data1, const void * p_data2)
+{
+    uint64_t value1 = *(const uint64_t *)p_data1;
+    uint64_t value2 = *(const uint64_t *)p_data2;
+
+    return (value1 > value2) - (value1 < value2);
+}
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+/*** end of file ***/
@@ -0,0 +1,395 @@
+// The source comes first, as it sets its feature macros before any header
+#include "shm_queue.c"
+#include <check.h>
+#include <stdio.h>
+#include <sys/wait.h>
+
+#define MESSAGES  (20000u)
+#define PRODUCERS (2)
+#define CONSUMERS (2)
+#define STOP      (UINT64_MAX)  /* Producer id that ends a consumer */
+
+// Waits for a child and reports whether it exited with status 0
+static bool
+child_ok(pid_t pid)
+{
+    int status = 0;
+
+    return (pid == waitpid(pid, &status, 0)) && WIFEXITED(status)
+           && (0 == WEXITSTATUS(status));
+}
+
+// Sends MESSAGES numbered messages tagged with the producer's id
+static bool
+produce(int fd, uint64_t producer)
+{
+    shmq_t * p_queue = shmq_open_fd(fd);
+    bool     b_ok    = (NULL != p_queue);
+
+    for (uint64_t idx = 0; b_ok && (idx < MESSAGES); idx++)
+    {
+        uint64_t msg[2] = { producer, idx };
+        b_ok            = shmq_enqueue_wait(p_queue, msg, sizeof(msg),
+                                            SHMQ_WAIT_FOREVER);
+    }
+
+    shmq_close(&p_queue);
+    return b_ok;
+}
+
+// Receives until told to stop, checking each producer's messages arrive
+// in order, and reports the count and sum of the numbers received
+static bool
+consume(int fd, int done_fd)
+{
+    shmq_t * p_queue = shmq_open_fd(fd);
+    shmq_t * p_done  = shmq_open_fd(done_fd);
+    uint64_t next[PRODUCERS] = { 0 };
+    uint64_t result[2]       = { 0, 0 };
+    bool     b_ok            = (NULL != p_queue) && (NULL != p_done);
+
+    while (b_ok)
+    {
+        uint64_t msg[2];
+        uint32_t len = 0;
+
+        b_ok = shmq_dequeue_wait(p_queue, msg, &len, SHMQ_WAIT_FOREVER)
+               && (sizeof(msg) == len);
+        if (!b_ok || (STOP == msg[0]))
+        {
+            break;
+        }
+
+        // Other consumers take some of them, so only the order is known
+        b_ok          = (msg[0] < PRODUCERS) && (msg[1] >= next[msg[0]]);
+        next[msg[0]]  = msg[1] + 1;
+        result[0]    += 1;
+        result[1]    += msg[1];
+    }
+
+    b_ok = b_ok && shmq_enqueue_wait(p_done, result, sizeof(result), 1000);
+    shmq_close(&p_queue);
+    shmq_close(&p_done);
+    return b_ok;
+}
+
+// Runs producers and consumers as processes and checks nothing was lost
+// or delivered twice
+static void
+run_processes(shmq_mode_t mode, int producers, int consumers)
+{
+    shmq_t * p_queue = shmq_create(NULL, 64, 64, mode);
+    shmq_t * p_done  = shmq_create(NULL, 8, 16, SHMQ_MODE_MPMC);
+    pid_t    pids[PRODUCERS + CONSUMERS];
+
+    ck_assert_ptr_nonnull(p_queue);
+    ck_assert_ptr_nonnull(p_done);
+
+    for (int idx = 0; idx < producers + consumers; idx++)
+    {
+        pids[idx] = fork();
+        ck_assert_int_ge(pids[idx], 0);
+        if (0 == pids[idx])
+        {
+            bool b_ok = (idx < producers)
+                            ? produce(shmq_fd(p_queue), (uint64_t)idx)
+                            : consume(shmq_fd(p_queue), shmq_fd(p_done));
+            _exit(b_ok ? 0 : 1);
+        }
+    }
+
+    for (int idx = 0; idx < producers; idx++)
+    {
+        ck_assert(child_ok(pids[idx]));
+    }
+    for (int idx = 0; idx < consumers; idx++)
+    {
+        uint64_t msg[2] = { STOP, 0 };
+        ck_assert(shmq_enqueue_wait(p_queue, msg, sizeof(msg), 1000));
+    }
+
+    uint64_t count = 0;
+    uint64_t sum   = 0;
+    for (int idx = 0; idx < consumers; idx++)
+    {
+        uint64_t result[2];
+        uint32_t len = 0;
+
+        ck_assert(shmq_dequeue_wait(p_done, result, &len, 2000));
+        count += result[0];
+        sum   += result[1];
+        ck_assert(child_ok(pids[producers + idx]));
+    }
+
+    ck_assert_uint_eq(count, (uint64_t)producers * MESSAGES);
+    ck_assert_uint_eq(sum, (uint64_t)producers * MESSAGES * (MESSAGES - 1) / 2);
+
+    shmq_close(&p_queue);
+    shmq_close(&p_done);
+}
+
+// Forks a peer that claims the next slot to write (or read) and dies
+// before finishing, as a process killed mid-operation would
+static void
+die_mid_operation(const shmq_t * p_queue, bool b_enqueue)
+{
+    pid_t pid = fork();
+
+    ck_assert_int_ge(pid, 0);
+    if (0 == pid)
+    {
+        shmq_t *   p_peer = shmq_open_fd(shmq_fd(p_queue));
+        uint64_t * p_end  = b_enqueue ? &p_peer->p_shared->tail
+                                      : &p_peer->p_shared->head;
+        uint64_t * p_mine = b_enqueue ? &p_peer->p_peer->enq_pos
+                                      : &p_peer->p_peer->deq_pos;
+        uint64_t   pos    = __atomic_load_n(p_end, __ATOMIC_SEQ_CST);
+
+        __atomic_store_n(p_mine, pos, __ATOMIC_SEQ_CST);
+        _exit(claim(p_end, &pos, false) ? 0 : 1);
+    }
+
+    ck_assert(child_ok(pid));
+}
+
+START_TEST(test_wraparound)
+{
+    shmq_t * p_queue = shmq_create(NULL, 4, 16, SHMQ_MODE_MPMC);
+    char     msg[16];
+    char     got[16];
+    uint32_t len      = 0;
+    uint32_t sent     = 0;
+    uint32_t received = 0;
+
+    ck_assert_ptr_nonnull(p_queue);
+    ck_assert_uint_eq(shmq_msg_size(p_queue), 16);
+
+    // Batches of 1 to 4 go round the four slots hundreds of times; every
+    // full batch must stop at the capacity
+    for (uint32_t round = 0; round < 1000; round++)
+    {
+        uint32_t batch = 1 + (round % 4);
+
+        for (uint32_t idx = 0; idx < batch; idx++, sent++)
+        {
+            uint32_t size = 1 + (sent % 16);
+            memset(msg, 'a' + (int)(sent % 26), size);
+            ck_assert(shmq_enqueue(p_queue, msg, size));
+        }
+        ck_assert_uint_eq(shmq_size(p_queue), batch);
+        if (4 == batch)
+        {
+            ck_assert(!shmq_enqueue(p_queue, msg, 1));
+        }
+
+        for (uint32_t idx = 0; idx < batch; idx++, received++)
+        {
+            uint32_t size = 1 + (received % 16);
+            memset(msg, 'a' + (int)(received % 26), size);
+            ck_assert(shmq_dequeue(p_queue, got, &len));
+            ck_assert_uint_eq(len, size);
+            ck_assert_mem_eq(got, msg, size);
+        }
+        ck_assert(!shmq_dequeue(p_queue, got, &len));
+    }
+
+    // Too long for a slot
+    ck_assert(!shmq_enqueue(p_queue, msg, 17));
+
+    shmq_close(&p_queue);
+    ck_assert_ptr_null(p_queue);
+}
+END_TEST
+
+START_TEST(test_mpmc_processes)
+{
+    run_processes(SHMQ_MODE_MPMC, PRODUCERS, CONSUMERS);
+}
+END_TEST
+
+START_TEST(test_spsc_processes)
+{
+    run_processes(SHMQ_MODE_SPSC, 1, 1);
+}
+END_TEST
+
+START_TEST(test_named_and_timeout)
+{
+    const char * p_name = "/shm_queue_unit_test";
+    char         buf[8];
+    uint32_t     len = 0;
+
+    (void)shmq_unlink(p_name);
+
+    shmq_t * p_owner = shmq_create(p_name, 2, 8, SHMQ_MODE_MPMC);
+    ck_assert_ptr_nonnull(p_owner);
+    ck_assert_ptr_null(shmq_create(p_name, 2, 8, SHMQ_MODE_MPMC));
+    ck_assert_int_eq(errno, EEXIST);
+
+    shmq_t * p_other = shmq_open(p_name);
+    ck_assert_ptr_nonnull(p_other);
+    ck_assert(shmq_enqueue(p_owner, "one", 3));
+    ck_assert(shmq_enqueue(p_owner, "two", 3));
+    ck_assert(!shmq_enqueue_wait(p_owner, "three", 5, 30));
+
+    ck_assert(shmq_dequeue(p_other, buf, &len));
+    ck_assert_mem_eq(buf, "one", 3);
+    ck_assert(shmq_dequeue(p_other, buf, &len));
+    ck_assert_mem_eq(buf, "two", 3);
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ck_assert(!shmq_dequeue_wait(p_other, buf, &len, 50));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ck_assert_int_ge((end.tv_sec - start.tv_sec) * MSEC_PER_SEC
+                         + (end.tv_nsec - start.tv_nsec) / NSEC_PER_MSEC,
+                     50);
+
+    ck_assert(shmq_unlink(p_name));
+    ck_assert_ptr_null(shmq_open(p_name));
+    shmq_close(&p_owner);
+    shmq_close(&p_other);
+}
+END_TEST
+
+START_TEST(test_dead_producer_recovered)
+{
+    shmq_t * p_queue = shmq_create(NULL, 4, 8, SHMQ_MODE_MPMC);
+    char     buf[8];
+    uint32_t len = 0;
+
+    ck_assert_ptr_nonnull(p_queue);
+    ck_assert(shmq_enqueue(p_queue, "a", 1));
+    die_mid_operation(p_queue, true);
+    ck_assert(shmq_enqueue(p_queue, "c", 1));
+
+    // The message after the abandoned slot is stuck behind it until a
+    // waiting reader finds the writer dead and skips the slot
+    ck_assert(shmq_dequeue(p_queue, buf, &len));
+    ck_assert_int_eq(buf[0], 'a');
+    ck_assert(!shmq_dequeue(p_queue, buf, &len));
+    ck_assert(shmq_dequeue_wait(p_queue, buf, &len, 1000));
+    ck_assert_int_eq(buf[0], 'c');
+    ck_assert(!shmq_dequeue(p_queue, buf, &len));
+
+    // The dead peer's table entry was freed along the way
+    uint32_t used = 0;
+    for (uint32_t idx = 0; idx < SHMQ_MAX_PEERS; idx++)
+    {
+        used += (0 != p_queue->p_shared->peers[idx].pid) ? 1 : 0;
+    }
+    ck_assert_uint_eq(used, 1);
+
+    shmq_close(&p_queue);
+}
+END_TEST
+
+START_TEST(test_dead_consumer_recovered)
+{
+    shmq_t * p_queue = shmq_create(NULL, 4, 8, SHMQ_MODE_MPMC);
+    char     buf[8];
+    uint32_t len = 0;
+
+    ck_assert_ptr_nonnull(p_queue);
+    for (uint32_t idx = 0; idx < 4; idx++)
+    {
+        ck_assert(shmq_enqueue(p_queue, "m", 1));
+    }
+    die_mid_operation(p_queue, false);
+
+    // The dead reader's slot is the next one to write into; a waiting
+    // writer finds the reader dead and takes it back
+    for (uint32_t idx = 0; idx < 3; idx++)
+    {
+        ck_assert(shmq_dequeue(p_queue, buf, &len));
+    }
+    ck_assert(!shmq_enqueue(p_queue, "n", 1));
+    ck_assert(shmq_enqueue_wait(p_queue, "n", 1, 1000));
+
+    // Afterwards all four slots are usable again
+    for (uint32_t idx = 0; idx < 3; idx++)
+    {
+        ck_assert(shmq_enqueue(p_queue, "n", 1));
+    }
+    ck_assert(!shmq_enqueue(p_queue, "n", 1));
+    for (uint32_t idx = 0; idx < 4; idx++)
+    {
+        ck_assert(shmq_dequeue(p_queue, buf, &len));
+        ck_assert_int_eq(buf[0], 'n');
+    }
+    ck_assert(!shmq_dequeue(p_queue, buf, &len));
+
+    shmq_close(&p_queue);
+}
+END_TEST
+
+START_TEST(test_peer_table_reclaims_dead)
+{
+    shmq_t * p_queue = shmq_create(NULL, 4, 8, SHMQ_MODE_MPMC);
+
+    ck_assert_ptr_nonnull(p_queue);
+
+    // Peers that die without closing fill the table; later ones still fit
+    for (uint32_t idx = 0; idx < 2 * SHMQ_MAX_PEERS; idx++)
+    {
+        pid_t pid = fork();
+
+        ck_assert_int_ge(pid, 0);
+        if (0 == pid)
+        {
+            _exit((NULL != shmq_open_fd(shmq_fd(p_queue))) ? 0 : 1);
+        }
+        ck_assert(child_ok(pid));
+    }
+
+    shmq_t * p_late = shmq_open_fd(shmq_fd(p_queue));
+    ck_assert_ptr_nonnull(p_late);
+    shmq_close(&p_late);
+    shmq_close(&p_queue);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+shm_queue_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Shm_Queue");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_wraparound);
+    tcase_add_test(tc_core, test_mpmc_processes);
+    tcase_add_test(tc_core, test_spsc_processes);
+    tcase_add_test(tc_core, test_named_and_timeout);
+    tcase_add_test(tc_core, test_dead_producer_recovered);
+    tcase_add_test(tc_core, test_dead_consumer_recovered);
+    tcase_add_test(tc_core, test_peer_table_reclaims_dead);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = shm_queue_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -0,0 +1,283 @@
+/** @file sketch.h
+ *
+ * @brief Fixed-memory streaming summaries: distinct counts, frequencies
+ *        and heavy hitters.
+ *
+ * - hll_t (HyperLogLog) estimates how many distinct keys were added, to
+ *   about 1.04 / sqrt(2^precision), e.g. 0.8% at precision 14 in 16 KiB.
+ *   It starts sparse, storing only the registers that are set, and turns
+ *   dense once that would take more room than the dense array.
+ * - cms_t (Count-Min) estimates how often any key was added. An estimate
+ *   is never low, and is high by more than epsilon times the total with
+ *   probability at most delta. Adds use conservative update, raising only
+ *   the counters that are at the minimum, which makes estimates tighter.
+ * - topk_t (Space-Saving) keeps the k most frequent keys with counts that
+ *   are never low and high by at most the reported error. Any key seen
+ *   more than total / k times is guaranteed to be kept.
+ *
+ * None of them grows with the number of keys. HLL and Count-Min take a
+ * 64-bit hash of the key, e.g. from sketch_hash(); top-k stores the key,
+ * truncated to TOPK_KEY_MAX bytes, so it can list it.
+ *
+ * The sketches are not thread-safe. To count from several threads, give
+ * each thread its own sketches and merge them into a shared one from time
+ * to time; merging sketches of the same shape gives the sketch of the
+ * combined stream, and clearing the per-thread ones starts a new period.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define SKETCH_SUCCESS       (0)
+#define SKETCH_ERROR_PARAM   (-1)
+#define SKETCH_ERROR_MEMORY  (-2)
+#define SKETCH_ERROR_SHAPE   (-3)  /* Merged sketches differ in size */
+
+#define HLL_MIN_PRECISION    (4u)
+#define HLL_MAX_PRECISION    (18u)
+
+#define TOPK_KEY_MAX         (48u) /* Longer keys are cut to this */
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct hll hll_t;
+typedef struct cms cms_t;
+typedef struct topk topk_t;
+
+/* One entry of topk_list() */
+typedef struct
+{
+    char     key[TOPK_KEY_MAX + 1u]; /* NUL-terminated copy */
+    uint32_t key_len;
+    uint64_t count;  /* Never below the true count */
+    uint64_t error;  /* count - error is never above the true count */
+} topk_item_t;
+
+/*************************************************************************
+ * Function Declarations: hashing
+ *************************************************************************/
+
+/*!
+ * @brief 64-bit hash of a byte string, for hll_add() and cms_add().
+ *
+ * @param[in] p_key Key bytes
+ * @param[in] len   Number of bytes
+ *
+ * @return Hash
+ */
+uint64_t
+sketch_hash(const void * p_key, size_t len);
+
+/*************************************************************************
+ * Function Declarations: HyperLogLog
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty HyperLogLog sketch.
+ *
+ * @param[in] precision HLL_MIN_PRECISION .. HLL_MAX_PRECISION; the dense
+ *                      form has 2^precision one-byte registers
+ *
+ * @return Pointer to the sketch, or NULL on failure
+ */
+hll_t *
+hll_create(uint32_t precision);
+
+/*!
+ * @brief Frees a sketch.
+ *
+ * @param[in,out] pp_hll Pointer to the sketch pointer; set to NULL
+ */
+void
+hll_destroy(hll_t ** pp_hll);
+
+/*!
+ * @brief Adds a key.
+ *
+ * @param[in,out] p_hll Sketch
+ * @param[in]     hash  Hash of the key
+ *
+ * @return SKETCH_SUCCESS, or SKETCH_ERROR_MEMORY if turning dense failed;
+ *         the sketch is then unchanged
+ */
+int
+hll_add(hll_t * p_hll, uint64_t hash);
+
+/*!
+ * @brief Merges src into dst, which then counts the keys of both.
+ *
+ * @param[in,out] p_dst Sketch merged into
+ * @param[in]     p_src Sketch of the same precision
+ *
+ * @return SKETCH_SUCCESS or a negative error code
+ */
+int
+hll_merge(hll_t * p_dst, const hll_t * p_src);
+
+/*!
+ * @brief Estimated number of distinct keys added.
+ */
+uint64_t
+hll_estimate(const hll_t * p_hll);
+
+/*!
+ * @brief Forgets every key; a dense sketch stays dense.
+ */
+void
+hll_clear(hll_t * p_hll);
+
+/*!
+ * @brief Whether the sketch is still in its sparse form.
+ */
+bool
+hll_is_sparse(const hll_t * p_hll);
+
+/*************************************************************************
+ * Function Declarations: Count-Min
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty Count-Min sketch.
+ *
+ * @param[in] epsilon Error bound as a fraction of the total, e.g. 0.001;
+ *                    sets the width to about e / epsilon counters
+ * @param[in] delta   Chance of exceeding the bound, e.g. 0.01; sets the
+ *                    depth to ln(1 / delta) rows
+ *
+ * @return Pointer to the sketch, or NULL on failure
+ */
+cms_t *
+cms_create(double epsilon, double delta);
+
+/*!
+ * @brief Frees a sketch.
+ *
+ * @param[in,out] pp_cms Pointer to the sketch pointer; set to NULL
+ */
+void
+cms_destroy(cms_t ** pp_cms);
+
+/*!
+ * @brief Adds count occurrences of a key. Counters saturate rather than
+ *        wrap.
+ *
+ * @param[in,out] p_cms Sketch
+ * @param[in]     hash  Hash of the key
+ * @param[in]     count Occurrences
+ *
+ * @return The key's estimate after the add
+ */
+uint32_t
+cms_add(cms_t * p_cms, uint64_t hash, uint32_t count);
+
+/*!
+ * @brief Estimated occurrences of a key.
+ */
+uint32_t
+cms_estimate(const cms_t * p_cms, uint64_t hash);
+
+/*!
+ * @brief Adds src's counts to dst.
+ *
+ * @param[in,out] p_dst Sketch merged into
+ * @param[in]     p_src Sketch created with the same epsilon and delta
+ *
+ * @return SKETCH_SUCCESS or a negative error code
+ */
+int
+cms_merge(cms_t * p_dst, const cms_t * p_src);
+
+/*!
+ * @brief Total of all counts added.
+ */
+uint64_t
+cms_total(const cms_t * p_cms);
+
+/*!
+ * @brief Sets every count back to zero.
+ */
+void
+cms_clear(cms_t * p_cms);
+
+/*************************************************************************
+ * Function Declarations: top-k
+ *************************************************************************/
+
+/*!
+ * @brief Creates an empty top-k summary.
+ *
+ * @param[in] k Keys tracked; a few times the number to be reported gives
+ *              tighter counts
+ *
+ * @return Pointer to the summary, or NULL on failure
+ */
+topk_t *
+topk_create(uint32_t k);
+
+/*!
+ * @brief Frees a summary.
+ *
+ * @param[in,out] pp_topk Pointer to the summary pointer; set to NULL
+ */
+void
+topk_destroy(topk_t ** pp_topk);
+
+/*!
+ * @brief Adds count occurrences of a key. When the summary is full, the
+ *        key takes the place of the least frequent one.
+ *
+ * @param[in,out] p_topk Summary
+ * @param[in]     p_key  Key bytes
+ * @param[in]     len    Number of bytes
+ * @param[in]     count  Occurrences
+ *
+ * @return SKETCH_SUCCESS or SKETCH_ERROR_PARAM
+ */
+int
+topk_add(topk_t * p_topk, const void * p_key, size_t len, uint64_t count);
+
+/*!
+ * @brief Adds src's keys and counts to dst; the errors add up too.
+ *
+ * @param[in,out] p_dst Summary merged into
+ * @param[in]     p_src Summary of any size
+ *
+ * @return SKETCH_SUCCESS or a negative error code
+ */
+int
+topk_merge(topk_t * p_dst, const topk_t * p_src);
+
+/*!
+ * @brief Lists the most frequent keys, highest count first.
+ *
+ * @param[in]  p_topk    Summary
+ * @param[out] p_items   Array for the entries
+ * @param[in]  max_items Size of the array
+ *
+ * @return Number of entries written
+ */
+uint32_t
+topk_list(const topk_t * p_topk, topk_item_t * p_items, uint32_t max_items);
+
+/*!
+ * @brief Forgets every key.
+ */
+void
+topk_clear(topk_t * p_topk);
+
+#endif /* SKETCH_H */
+
+/*** end of file ***/
@@ -0,0 +1,477 @@
+/** @file sketch_bench.c
+ *
+ * @brief Client-address statistics from sketches and from exact counts.
+ *
+ * A stream of EVENTS connection events comes from CLIENTS distinct IPv4
+ * addresses with Zipf-distributed frequencies, as real client traffic
+ * roughly is. Each event is counted:
+ *
+ * - exactly, in a hash_table_t from address to counter, whose memory
+ *   grows with the number of distinct addresses;
+ * - by an hll_t, a cms_t and a topk_t, in fixed memory, first on one
+ *   thread and then split over threads, each with its own sketches, that
+ *   are merged at the end.
+ *
+ * Reported are the update rates, the HyperLogLog's distinct-count error,
+ * the Count-Min error on the 1000 busiest addresses and on all of them,
+ * and how many of the true top TOP_REPORT the top-k summary finds.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L sketch_bench.c
+ *        sketch.c "../../1 - Basic_Data_Structures/5 - Hash_Table/hash_table.c"
+ *        "../../1 - Basic_Data_Structures/0 - Allocator/allocator.c"
+ *        -pthread -lm
+ *
+ * Usage: sketch_bench [clients] [events] [threads]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sketch.h"
+#include "../../1 - Basic_Data_Structures/5 - Hash_Table/hash_table.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_CLIENTS  (1000000u)
+#define DEFAULT_EVENTS   (10000000u)
+#define DEFAULT_THREADS  (4u)
+#define MAX_THREADS      (64u)
+#define ZIPF_EXPONENT    (1.1)
+#define HLL_PRECISION    (14u)
+#define CMS_EPSILON      (0.0005)
+#define CMS_DELTA        (0.01)
+#define TOPK_K           (1024u)
+#define TOP_REPORT       (100u)
+#define BUSIEST          (1000u)
+#define ADDR_LEN         (16u)
+#define SEED             (0x9E3779B97F4A7C15ull)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+typedef struct
+{
+    char text[ADDR_LEN];
+} addr_t;
+
+typedef struct
+{
+    hll_t *  p_hll;
+    cms_t *  p_cms;
+    topk_t * p_topk;
+} sketches_t;
+
+typedef struct
+{
+    const addr_t *   p_addrs;
+    const uint32_t * p_events;
+    uint32_t         first;
+    uint32_t         count;
+    sketches_t       sketches;
+} worker_arg_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static pthread_t    g_threads[MAX_THREADS];
+static worker_arg_t g_args[MAX_THREADS];
+static topk_item_t  g_top[TOP_REPORT];
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static bool       sketches_create(sketches_t * p_sketches);
+static void       sketches_destroy(sketches_t * p_sketches);
+static void       count_events(const addr_t *   p_addrs,
+                               const uint32_t * p_events,
+                               uint32_t         first,
+                               uint32_t         count,
+                               sketches_t *     p_sketches);
+static void *     worker(void * p_arg);
+static uint32_t   hash_addr(const void * p_key, uint32_t capacity);
+static bool       addrs_equal(const void * p_lhs, const void * p_rhs);
+static uint32_t * make_events(uint32_t clients, uint32_t events);
+static int        compare_counts_desc(const void * p_lhs, const void * p_rhs);
+static void       report_accuracy(const sketches_t * p_sketches,
+                                  const addr_t *     p_addrs,
+                                  const uint64_t *   p_exact,
+                                  uint32_t           clients,
+                                  uint64_t           events);
+static double     now_seconds(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t     clients      = DEFAULT_CLIENTS;
+    uint32_t     events       = DEFAULT_EVENTS;
+    uint32_t     thread_count = DEFAULT_THREADS;
+    hash_table_t table;
+    sketches_t   single       = { 0 };
+    sketches_t   merged       = { 0 };
+
+    if (argc > 1)
+    {
+        clients = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        events = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        thread_count = (uint32_t)strtoul(argv[3], NULL, 10);
+    }
+
+    if ((0u == clients) || (0u == events) || (0u == thread_count)
+        || (thread_count > MAX_THREADS))
+    {
+        fprintf(stderr, "usage: %s [clients] [events] [threads 1-%u]\n",
+                argv[0], MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    addr_t *   p_addrs  = calloc(clients, sizeof(addr_t));
+    uint64_t * p_exact  = calloc(clients, sizeof(uint64_t));
+    uint32_t * p_events = make_events(clients, events);
+
+    if ((NULL == p_addrs) || (NULL == p_exact) || (NULL == p_events)
+        || !sketches_create(&single) || !sketches_create(&merged)
+        || !hash_table_init(&table, 1024u, 0.75f, hash_addr, addrs_equal,
+                            NULL, NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t id = 0u; id < clients; id++)
+    {
+        uint32_t ip = 0x0A000000u | ((id * 2654435761u) & 0x00FFFFFFu);
+
+        (void)snprintf(p_addrs[id].text, ADDR_LEN, "%u.%u.%u.%u",
+                       ip >> 24, (ip >> 16) & 0xFFu, (ip >> 8) & 0xFFu,
+                       ip & 0xFFu);
+    }
+
+    // Exact: the table maps each address to its counter
+    double start = now_seconds();
+
+    for (uint32_t idx = 0u; idx < events; idx++)
+    {
+        const addr_t * p_addr    = &p_addrs[p_events[idx]];
+        uint64_t *     p_counter = hash_table_get(&table, p_addr);
+
+        if (NULL == p_counter)
+        {
+            p_counter = &p_exact[p_events[idx]];
+            (void)hash_table_put(&table, p_addr, p_counter);
+        }
+
+        (*p_counter)++;
+    }
+
+    double exact_s = now_seconds() - start;
+
+    start = now_seconds();
+    count_events(p_addrs, p_events, 0u, events, &single);
+    double single_s = now_seconds() - start;
+
+    // Threads: each counts a slice into its own sketches, merged at the end
+    uint32_t slice = events / thread_count;
+
+    start = now_seconds();
+
+    for (uint32_t id = 0u; id < thread_count; id++)
+    {
+        g_args[id].p_addrs  = p_addrs;
+        g_args[id].p_events = p_events;
+        g_args[id].first    = id * slice;
+        g_args[id].count    = slice;
+
+        if (id + 1u == thread_count)
+        {
+            g_args[id].count = events - (id * slice);
+        }
+
+        if (!sketches_create(&g_args[id].sketches))
+        {
+            fprintf(stderr, "out of memory\n");
+            return EXIT_FAILURE;
+        }
+
+        (void)pthread_create(&g_threads[id], NULL, worker, &g_args[id]);
+    }
+
+    for (uint32_t id = 0u; id < thread_count; id++)
+    {
+        (void)pthread_join(g_threads[id], NULL);
+        (void)hll_merge(merged.p_hll, g_args[id].sketches.p_hll);
+        (void)cms_merge(merged.p_cms, g_args[id].sketches.p_cms);
+        (void)topk_merge(merged.p_topk, g_args[id].sketches.p_topk);
+        sketches_destroy(&g_args[id].sketches);
+    }
+
+    double threads_s = now_seconds() - start;
+
+    printf("%u clients, %u events, Zipf %.1f\n", clients, events,
+           ZIPF_EXPONENT);
+    printf("exact hash_table_t   %7.2f M updates/s  %u entries\n",
+           (double)events / exact_s / 1e6, hash_table_size(&table));
+    printf("sketches, 1 thread   %7.2f M updates/s  (hll+cms+topk each)\n",
+           (double)events / single_s / 1e6);
+    printf("sketches, %u threads  %7.2f M updates/s  incl. merge\n",
+           thread_count, (double)events / threads_s / 1e6);
+    printf("\n1 thread:\n");
+    report_accuracy(&single, p_addrs, p_exact, clients, events);
+    printf("\n%u threads, merged:\n", thread_count);
+    report_accuracy(&merged, p_addrs, p_exact, clients, events);
+
+    hash_table_destroy(&table, false);
+    sketches_destroy(&single);
+    sketches_destroy(&merged);
+    free(p_addrs);
+    free(p_exact);
+    free(p_events);
+    return EXIT_SUCCESS;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static bool
+sketches_create(sketches_t * p_sketches)
+{
+    p_sketches->p_hll  = hll_create(HLL_PRECISION);
+    p_sketches->p_cms  = cms_create(CMS_EPSILON, CMS_DELTA);
+    p_sketches->p_topk = topk_create(TOPK_K);
+
+    return (NULL != p_sketches->p_hll) && (NULL != p_sketches->p_cms)
+           && (NULL != p_sketches->p_topk);
+}
+
+static void
+sketches_destroy(sketches_t * p_sketches)
+{
+    hll_destroy(&p_sketches->p_hll);
+    cms_destroy(&p_sketches->p_cms);
+    topk_destroy(&p_sketches->p_topk);
+}
+
+static void
+count_events(const addr_t *   p_addrs,
+             const uint32_t * p_events,
+             uint32_t         first,
+             uint32_t         count,
+             sketches_t *     p_sketches)
+{
+    for (uint32_t idx = first; idx < first + count; idx++)
+    {
+        const char * p_text = p_addrs[p_events[idx]].text;
+        size_t       len    = strlen(p_text);
+        uint64_t     hash   = sketch_hash(p_text, len);
+
+        (void)hll_add(p_sketches->p_hll, hash);
+        (void)cms_add(p_sketches->p_cms, hash, 1u);
+        (void)topk_add(p_sketches->p_topk, p_text, len, 1u);
+    }
+}
+
+static void *
+worker(void * p_arg)
+{
+    worker_arg_t * p_worker = p_arg;
+
+    count_events(p_worker->p_addrs, p_worker->p_events, p_worker->first,
+                 p_worker->count, &p_worker->sketches);
+    return NULL;
+}
+
+static uint32_t
+hash_addr(const void * p_key, uint32_t capacity)
+{
+    const addr_t * p_addr = p_key;
+
+    return (uint32_t)(sketch_hash(p_addr->text, strlen(p_addr->text))
+                      % capacity);
+}
+
+static bool
+addrs_equal(const void * p_lhs, const void * p_rhs)
+{
+    const addr_t * p_left  = p_lhs;
+    const addr_t * p_right = p_rhs;
+
+    return 0 == strcmp(p_left->text, p_right->text);
+}
+
+/*!
+ * @brief Draws events from a Zipf distribution over client ids, by
+ *        bisecting its cumulative distribution.
+ *
+ * @return Array of client ids, or NULL if out of memory
+ */
+static uint32_t *
+make_events(uint32_t clients, uint32_t events)
+{
+    double *   p_cdf    = malloc((size_t)clients * sizeof(double));
+    uint32_t * p_events = malloc((size_t)events * sizeof(uint32_t));
+    double     total    = 0.0;
+    uint64_t   rng      = SEED;
+
+    if ((NULL == p_cdf) || (NULL == p_events))
+    {
+        free(p_cdf);
+        free(p_events);
+        return NULL;
+    }
+
+    for (uint32_t rank = 0u; rank < clients; rank++)
+    {
+        total       += 1.0 / pow((double)rank + 1.0, ZIPF_EXPONENT);
+        p_cdf[rank]  = total;
+    }
+
+    for (uint32_t idx = 0u; idx < events; idx++)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+
+        double   target = ((double)(rng >> 11) / 9007199254740992.0) * total;
+        uint32_t low    = 0u;
+        uint32_t high   = clients - 1u;
+
+        while (low < high)
+        {
+            uint32_t mid = low + ((high - low) / 2u);
+
+            if (p_cdf[mid] < target)
+            {
+                low = mid + 1u;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        p_events[idx] = low;
+    }
+
+    free(p_cdf);
+    return p_events;
+}
+
+static int
+compare_counts_desc(const void * p_lhs, const void * p_rhs)
+{
+    uint64_t left  = *(const uint64_t *)p_lhs;
+    uint64_t right = *(const uint64_t *)p_rhs;
+
+    return (left < right) - (left > right);
+}
+
+/*!
+ * @brief Compares a set of sketches against the exact counts. Client id
+ *        is Zipf rank, so the busiest clients are the lowest ids.
+ */
+static void
+report_accuracy(const sketches_t * p_sketches,
+                const addr_t *     p_addrs,
+                const uint64_t *   p_exact,
+                uint32_t           clients,
+                uint64_t           events)
+{
+    uint64_t   distinct = 0u;
+    double     busy_err = 0.0;
+    double     all_err  = 0.0;
+    uint64_t   over_eps = 0u;
+    uint32_t   found    = 0u;
+    uint32_t   busiest  = (clients < BUSIEST) ? clients : BUSIEST;
+    uint64_t * p_sorted = malloc((size_t)clients * sizeof(uint64_t));
+
+    if (NULL == p_sorted)
+    {
+        return;
+    }
+
+    for (uint32_t id = 0u; id < clients; id++)
+    {
+        const char * p_text = p_addrs[id].text;
+        uint64_t     hash   = sketch_hash(p_text, strlen(p_text));
+        double       error  = (double)cms_estimate(p_sketches->p_cms, hash)
+                       - (double)p_exact[id];
+
+        distinct    += (p_exact[id] > 0u) ? 1u : 0u;
+        all_err     += error;
+        busy_err    += (id < busiest) ? error : 0.0;
+        over_eps    += (error > CMS_EPSILON * (double)events) ? 1u : 0u;
+        p_sorted[id] = p_exact[id];
+    }
+
+    // Top-k recall: listed keys whose true count reaches the true
+    // TOP_REPORT-th largest
+    qsort(p_sorted, clients, sizeof(uint64_t), compare_counts_desc);
+
+    uint64_t threshold = p_sorted[(clients < TOP_REPORT) ? (clients - 1u)
+                                                         : (TOP_REPORT - 1u)];
+    uint32_t listed    = topk_list(p_sketches->p_topk, g_top, TOP_REPORT);
+    uint64_t max_err   = 0u;
+
+    for (uint32_t item = 0u; item < listed; item++)
+    {
+        for (uint32_t id = 0u; id < clients; id++)
+        {
+            if (0 == strcmp(p_addrs[id].text, g_top[item].key))
+            {
+                found   += (p_exact[id] >= threshold) ? 1u : 0u;
+                max_err  = (g_top[item].count - p_exact[id] > max_err)
+                               ? (g_top[item].count - p_exact[id])
+                               : max_err;
+                break;
+            }
+        }
+    }
+
+    uint64_t estimate = hll_estimate(p_sketches->p_hll);
+
+    printf("  hll   distinct %llu, exact %llu, error %+.2f%%\n",
+           (unsigned long long)estimate, (unsigned long long)distinct,
+           100.0 * ((double)estimate - (double)distinct) / (double)distinct);
+    printf("  cms   mean overcount: busiest %u %.1f, all %.1f; "
+           "over eps*N %llu of %u\n",
+           busiest, busy_err / busiest, all_err / clients,
+           (unsigned long long)over_eps, clients);
+    printf("  topk  %u of true top %u found, max overcount %llu\n",
+           found, TOP_REPORT, (unsigned long long)max_err);
+
+    free(p_sorted);
+}
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/*** end of file ***/
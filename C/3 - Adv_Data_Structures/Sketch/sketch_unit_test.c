@@ -0,0 +1,286 @@
+#include <check.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sketch.h"
+
+#define CMS_KEYS (5000u)
+
+static uint64_t
+key_hash(uint32_t idx)
+{
+    return sketch_hash(&idx, sizeof(idx));
+}
+
+// Relative error of an HLL estimate of n distinct keys
+static double
+hll_error(const hll_t * p_hll, uint32_t n)
+{
+    return fabs((double)hll_estimate(p_hll) - n) / n;
+}
+
+// Three standard errors for a precision
+static double
+hll_bound(uint32_t precision)
+{
+    return 3.0 * 1.04 / sqrt((double)(1u << precision));
+}
+
+START_TEST(test_hll_error_bound)
+{
+    hll_t *  p_hll = hll_create(14);
+    uint32_t added = 0;
+
+    ck_assert_ptr_nonnull(p_hll);
+    ck_assert(hll_is_sparse(p_hll));
+    ck_assert_uint_eq(hll_estimate(p_hll), 0);
+
+    // Checked while sparse, around the switch to dense, and well past it
+    const uint32_t checkpoints[] = { 100, 1000, 10000, 100000, 1000000 };
+    for (uint32_t idx = 0; idx < sizeof(checkpoints) / sizeof(checkpoints[0]);
+         idx++)
+    {
+        for (; added < checkpoints[idx]; added++)
+        {
+            ck_assert_int_eq(hll_add(p_hll, key_hash(added)), SKETCH_SUCCESS);
+        }
+        ck_assert_double_le(hll_error(p_hll, added), hll_bound(14));
+    }
+    ck_assert(!hll_is_sparse(p_hll));
+
+    // Keys seen before do not count again
+    for (uint32_t idx = 0; idx < 100000; idx++)
+    {
+        hll_add(p_hll, key_hash(idx));
+    }
+    ck_assert_double_le(hll_error(p_hll, added), hll_bound(14));
+
+    hll_destroy(&p_hll);
+    ck_assert_ptr_null(p_hll);
+}
+END_TEST
+
+START_TEST(test_hll_small_precisions)
+{
+    // 4, 5 and 6 use the tabulated bias constants
+    for (uint32_t precision = HLL_MIN_PRECISION; precision <= 8; precision++)
+    {
+        hll_t * p_hll = hll_create(precision);
+        ck_assert_ptr_nonnull(p_hll);
+
+        for (uint32_t idx = 0; idx < 100000; idx++)
+        {
+            hll_add(p_hll, key_hash(idx));
+        }
+        ck_assert_double_le(hll_error(p_hll, 100000), hll_bound(precision));
+        hll_destroy(&p_hll);
+    }
+
+    ck_assert_ptr_null(hll_create(HLL_MIN_PRECISION - 1));
+    ck_assert_ptr_null(hll_create(HLL_MAX_PRECISION + 1));
+}
+END_TEST
+
+START_TEST(test_hll_merge)
+{
+    hll_t * p_left  = hll_create(12);
+    hll_t * p_right = hll_create(12);
+    hll_t * p_other = hll_create(10);
+
+    ck_assert_ptr_nonnull(p_left);
+    ck_assert_ptr_nonnull(p_right);
+    ck_assert_ptr_nonnull(p_other);
+
+    // Overlapping halves: 0 .. 60k and 40k .. 100k
+    for (uint32_t idx = 0; idx < 60000; idx++)
+    {
+        hll_add(p_left, key_hash(idx));
+        hll_add(p_right, key_hash(idx + 40000));
+    }
+
+    ck_assert_int_eq(hll_merge(p_left, p_right), SKETCH_SUCCESS);
+    ck_assert_double_le(hll_error(p_left, 100000), hll_bound(12));
+    ck_assert_int_eq(hll_merge(p_left, p_other), SKETCH_ERROR_SHAPE);
+
+    hll_clear(p_left);
+    ck_assert_uint_eq(hll_estimate(p_left), 0);
+
+    hll_destroy(&p_left);
+    hll_destroy(&p_right);
+    hll_destroy(&p_other);
+}
+END_TEST
+
+START_TEST(test_cms_error_bound)
+{
+    const double epsilon = 0.001;
+    const double delta   = 0.01;
+    cms_t *      p_cms   = cms_create(epsilon, delta);
+    uint32_t *   p_true  = calloc(CMS_KEYS, sizeof(uint32_t));
+    uint64_t     state   = 1;
+
+    ck_assert_ptr_nonnull(p_cms);
+    ck_assert_ptr_nonnull(p_true);
+
+    // Skewed stream: low keys are far more frequent
+    for (uint32_t idx = 0; idx < 500000; idx++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint32_t key = (uint32_t)((state % CMS_KEYS) * (state % CMS_KEYS)
+                                  / CMS_KEYS);
+        p_true[key]++;
+        ck_assert_uint_ge(cms_add(p_cms, key_hash(key), 1), p_true[key]);
+    }
+    ck_assert_uint_eq(cms_total(p_cms), 500000);
+
+    // Never low, and high by more than epsilon * total at most delta of
+    // the time
+    double   bound = epsilon * (double)cms_total(p_cms);
+    uint32_t over  = 0;
+    for (uint32_t key = 0; key < CMS_KEYS; key++)
+    {
+        uint32_t estimate = cms_estimate(p_cms, key_hash(key));
+        ck_assert_uint_ge(estimate, p_true[key]);
+        over += ((double)(estimate - p_true[key]) > bound) ? 1 : 0;
+    }
+    ck_assert_double_le((double)over / CMS_KEYS, delta);
+
+    free(p_true);
+    cms_destroy(&p_cms);
+    ck_assert_ptr_null(p_cms);
+}
+END_TEST
+
+START_TEST(test_cms_merge_and_saturate)
+{
+    cms_t * p_dst   = cms_create(0.01, 0.01);
+    cms_t * p_src   = cms_create(0.01, 0.01);
+    cms_t * p_other = cms_create(0.001, 0.01);
+
+    ck_assert_ptr_nonnull(p_dst);
+    ck_assert_ptr_nonnull(p_src);
+    ck_assert_ptr_nonnull(p_other);
+
+    cms_add(p_dst, key_hash(1), 5);
+    cms_add(p_src, key_hash(1), 7);
+    cms_add(p_src, key_hash(2), 3);
+
+    ck_assert_int_eq(cms_merge(p_dst, p_src), SKETCH_SUCCESS);
+    ck_assert_uint_ge(cms_estimate(p_dst, key_hash(1)), 12);
+    ck_assert_uint_ge(cms_estimate(p_dst, key_hash(2)), 3);
+    ck_assert_uint_eq(cms_total(p_dst), 15);
+    ck_assert_int_eq(cms_merge(p_dst, p_other), SKETCH_ERROR_SHAPE);
+
+    // Counters stop at the top instead of wrapping
+    cms_add(p_dst, key_hash(3), UINT32_MAX - 1);
+    ck_assert_uint_eq(cms_add(p_dst, key_hash(3), 10), UINT32_MAX);
+
+    cms_clear(p_dst);
+    ck_assert_uint_eq(cms_estimate(p_dst, key_hash(1)), 0);
+    ck_assert_uint_eq(cms_total(p_dst), 0);
+
+    cms_destroy(&p_dst);
+    cms_destroy(&p_src);
+    cms_destroy(&p_other);
+}
+END_TEST
+
+START_TEST(test_topk_heavy_hitters)
+{
+    topk_t *      p_topk  = topk_create(16);
+    topk_item_t * p_items = calloc(16, sizeof(topk_item_t));
+    char          key[16];
+    uint64_t      total = 0;
+
+    ck_assert_ptr_nonnull(p_topk);
+    ck_assert_ptr_nonnull(p_items);
+
+    // "heavyN" occurs 1250 * (N + 1) times among 20000 single keys, so
+    // heavy1 .. heavy3 take more than total / k and must be kept
+    for (uint32_t idx = 0; idx < 20000; idx++)
+    {
+        int len = snprintf(key, sizeof(key), "light%u", idx);
+        ck_assert_int_eq(topk_add(p_topk, key, (size_t)len, 1), SKETCH_SUCCESS);
+        total++;
+
+        if (0 == (idx % 4))
+        {
+            len = snprintf(key, sizeof(key), "heavy%u", (idx / 4) % 4);
+            topk_add(p_topk, key, (size_t)len, 1 + (idx / 4) % 4);
+            total += 1 + (idx / 4) % 4;
+        }
+    }
+
+    ck_assert_uint_gt(2500, total / 16);
+
+    uint32_t count = topk_list(p_topk, p_items, 16);
+    ck_assert_uint_eq(count, 16);
+
+    // Highest count first; the kept heavy keys lead, heaviest first, and
+    // their counts bracket the truth
+    for (uint32_t idx = 1; idx < count; idx++)
+    {
+        ck_assert_uint_ge(p_items[idx - 1].count, p_items[idx].count);
+    }
+    for (uint32_t rank = 0; rank < 3; rank++)
+    {
+        uint64_t truth = 1250u * (4 - rank);
+
+        snprintf(key, sizeof(key), "heavy%u", 3 - rank);
+        ck_assert_str_eq(p_items[rank].key, key);
+        ck_assert_uint_ge(p_items[rank].count, truth);
+        ck_assert_uint_le(p_items[rank].count - p_items[rank].error, truth);
+        ck_assert_uint_le(p_items[rank].error, total / 16);
+    }
+
+    free(p_items);
+    topk_destroy(&p_topk);
+    ck_assert_ptr_null(p_topk);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+sketch_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Sketch");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_hll_error_bound);
+    tcase_add_test(tc_core, test_hll_small_precisions);
+    tcase_add_test(tc_core, test_hll_merge);
+    tcase_add_test(tc_core, test_cms_error_bound);
+    tcase_add_test(tc_core, test_cms_merge_and_saturate);
+    tcase_add_test(tc_core, test_topk_heavy_hitters);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = sketch_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -0,0 +1,717 @@
+/** @file client_mux.c
+ *
+ * @brief Implementation of the pipelined request multiplexer.
+ *
+ * Calls move through two FIFO lists under the multiplexer lock: the send
+ * list holds submitted requests, the wait list requests already copied to
+ * the output buffer. The I/O thread promotes calls from one list to the
+ * other while the window has room, and the head of the wait list owns
+ * every reply line until its "END". Submitters wake the I/O thread out of
+ * poll() through a pipe.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "client_mux.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define INITIAL_BUFFER (256u)
+#define WAKE_DRAIN     (64u)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* Where a call is in its exchange */
+typedef enum
+{
+    CALL_IDLE = 0, /* Never submitted */
+    CALL_PENDING,  /* Submitted, reply not complete */
+    CALL_DONE      /* Reply complete or failed */
+} call_state_t;
+
+struct client_mux_call
+{
+    client_mux_call_t * p_next;      /* Send or wait list link */
+    pthread_cond_t      done;        /* Signalled when the reply completes */
+    call_state_t        state;       /* Exchange progress */
+    int                 status;      /* Result once CALL_DONE */
+    char *              p_request;   /* Copy of the request text */
+    size_t              request_len; /* Request length in bytes */
+    size_t              request_cap; /* Request buffer size */
+    char *              p_reply;     /* Reply lines received so far */
+    size_t              reply_len;   /* Reply length in bytes */
+    size_t              reply_cap;   /* Reply buffer size */
+};
+
+struct client_mux
+{
+    int                 socket_fd;       /* Connection, used by I/O thread */
+    int                 wake_fds[2];     /* Pipe that interrupts poll() */
+    uint32_t            max_outstanding; /* Window of unanswered requests */
+    uint32_t            outstanding;     /* Requests on the wait list */
+    bool                b_running;       /* I/O thread should keep going */
+    bool                b_joined;        /* I/O thread has been joined */
+    int64_t             next_tag;        /* Tag of the last request */
+    pthread_mutex_t     lock;            /* Guards lists and call state */
+    pthread_t           thread;          /* I/O thread */
+    client_mux_call_t * p_send_head;     /* Submitted, not yet buffered */
+    client_mux_call_t * p_send_tail;
+    client_mux_call_t * p_wait_head;     /* Buffered or sent, unanswered */
+    client_mux_call_t * p_wait_tail;
+    char *              p_out;           /* I/O thread only: bytes to write */
+    size_t              out_len;
+    size_t              out_sent;
+    size_t              out_cap;
+    char *              p_in;            /* I/O thread: partial input line */
+    size_t              in_len;
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void * io_thread(void * p_arg);
+static bool   fill_output(client_mux_t * p_mux);
+static bool   flush_output(client_mux_t * p_mux);
+static bool   read_replies(client_mux_t * p_mux);
+static bool   take_line(client_mux_t * p_mux, char * p_line, size_t len);
+static void   finish_call(client_mux_t * p_mux, int status);
+static void   fail_all(client_mux_t * p_mux);
+static bool   append(char ** pp_buf,
+                     size_t * p_len,
+                     size_t * p_cap,
+                     const char * p_data,
+                     size_t       len);
+static void   wake(client_mux_t * p_mux);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Takes over a connected socket and starts its I/O thread.
+ *
+ * @param[in] socket_fd       Connected stream socket
+ * @param[in] max_outstanding Requests written but not yet answered (> 0)
+ *
+ * @return Pointer to the multiplexer, or NULL on failure
+ */
+client_mux_t *
+client_mux_create(int socket_fd, uint32_t max_outstanding)
+{
+    if ((socket_fd < 0) || (0 == max_outstanding))
+    {
+        return NULL;
+    }
+
+    client_mux_t * p_mux = calloc(1, sizeof(client_mux_t));
+    if (NULL == p_mux)
+    {
+        return NULL;
+    }
+
+    p_mux->socket_fd       = socket_fd;
+    p_mux->max_outstanding = max_outstanding;
+    p_mux->b_running       = true;
+    p_mux->p_in            = malloc(CLIENT_MUX_MAX_LINE);
+
+    if ((NULL == p_mux->p_in) || (0 != pipe(p_mux->wake_fds)))
+    {
+        free(p_mux->p_in);
+        free(p_mux);
+        return NULL;
+    }
+
+    fcntl(p_mux->wake_fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(p_mux->wake_fds[1], F_SETFL, O_NONBLOCK);
+
+    if (0 != pthread_mutex_init(&p_mux->lock, NULL))
+    {
+        close(p_mux->wake_fds[0]);
+        close(p_mux->wake_fds[1]);
+        free(p_mux->p_in);
+        free(p_mux);
+        return NULL;
+    }
+
+    if (0 != pthread_create(&p_mux->thread, NULL, io_thread, p_mux))
+    {
+        pthread_mutex_destroy(&p_mux->lock);
+        close(p_mux->wake_fds[0]);
+        close(p_mux->wake_fds[1]);
+        free(p_mux->p_in);
+        free(p_mux);
+        return NULL;
+    }
+
+    return p_mux;
+}
+
+/*!
+ * @brief Allocates an exchange that can be submitted repeatedly.
+ *
+ * @param[in] p_mux Multiplexer the call will be used with
+ *
+ * @return Pointer to the call, or NULL on failure
+ */
+client_mux_call_t *
+client_mux_call_create(client_mux_t * p_mux)
+{
+    if (NULL == p_mux)
+    {
+        return NULL;
+    }
+
+    client_mux_call_t * p_call = calloc(1, sizeof(client_mux_call_t));
+    if (NULL == p_call)
+    {
+        return NULL;
+    }
+
+    if (0 != pthread_cond_init(&p_call->done, NULL))
+    {
+        free(p_call);
+        return NULL;
+    }
+
+    return p_call;
+}
+
+/*!
+ * @brief Frees an exchange that is not in progress.
+ *
+ * @param[in,out] pp_call Pointer to the call pointer; set to NULL
+ */
+void
+client_mux_call_destroy(client_mux_call_t ** pp_call)
+{
+    if ((NULL == pp_call) || (NULL == *pp_call))
+    {
+        return;
+    }
+
+    pthread_cond_destroy(&(*pp_call)->done);
+    free((*pp_call)->p_request);
+    free((*pp_call)->p_reply);
+    free(*pp_call);
+    *pp_call = NULL;
+}
+
+/*!
+ * @brief Queues a request line without waiting for its reply.
+ *
+ * @param[in]     p_mux     Multiplexer
+ * @param[in,out] p_call    Idle call to carry the exchange
+ * @param[in]     p_request Request text, normally ending in a newline
+ *
+ * @return Tag of the request, or a negative error code
+ */
+int64_t
+client_mux_submit(client_mux_t *      p_mux,
+                  client_mux_call_t * p_call,
+                  const char *        p_request)
+{
+    if ((NULL == p_mux) || (NULL == p_call) || (NULL == p_request))
+    {
+        return CLIENT_MUX_ERROR_PARAM;
+    }
+
+    pthread_mutex_lock(&p_mux->lock);
+    call_state_t state = p_call->state;
+    pthread_mutex_unlock(&p_mux->lock);
+
+    if (CALL_PENDING == state)
+    {
+        return CLIENT_MUX_ERROR_PARAM;
+    }
+
+    // The call is idle, so nothing else touches its buffers
+    p_call->request_len = 0;
+    p_call->reply_len   = 0;
+    if (!append(&p_call->p_request,
+                &p_call->request_len,
+                &p_call->request_cap,
+                p_request,
+                strlen(p_request))
+        || !append(&p_call->p_reply,
+                   &p_call->reply_len,
+                   &p_call->reply_cap,
+                   "",
+                   0))
+    {
+        return CLIENT_MUX_ERROR_MEMORY;
+    }
+
+    pthread_mutex_lock(&p_mux->lock);
+    if (!p_mux->b_running)
+    {
+        pthread_mutex_unlock(&p_mux->lock);
+        return CLIENT_MUX_ERROR_CLOSED;
+    }
+
+    p_call->state  = CALL_PENDING;
+    p_call->status = CLIENT_MUX_SUCCESS;
+    p_call->p_next = NULL;
+    if (NULL == p_mux->p_send_tail)
+    {
+        p_mux->p_send_head = p_call;
+    }
+    else
+    {
+        p_mux->p_send_tail->p_next = p_call;
+    }
+    p_mux->p_send_tail = p_call;
+
+    int64_t tag = ++p_mux->next_tag;
+    pthread_mutex_unlock(&p_mux->lock);
+
+    wake(p_mux);
+    return tag;
+}
+
+/*!
+ * @brief Waits for a submitted request to be answered.
+ *
+ * @param[in]     p_mux    Multiplexer
+ * @param[in,out] p_call   Submitted call
+ * @param[out]    pp_reply Reply text (NUL terminated)
+ * @param[out]    p_len    Optional reply length in bytes
+ *
+ * @return CLIENT_MUX_SUCCESS, or CLIENT_MUX_ERROR_CLOSED if the connection
+ *         ended before the reply was complete
+ */
+int
+client_mux_wait(client_mux_t *      p_mux,
+                client_mux_call_t * p_call,
+                const char **       pp_reply,
+                size_t *            p_len)
+{
+    if ((NULL == p_mux) || (NULL == p_call) || (NULL == pp_reply))
+    {
+        return CLIENT_MUX_ERROR_PARAM;
+    }
+
+    pthread_mutex_lock(&p_mux->lock);
+    while (CALL_PENDING == p_call->state)
+    {
+        pthread_cond_wait(&p_call->done, &p_mux->lock);
+    }
+
+    int status = (CALL_DONE == p_call->state) ? p_call->status
+                                              : CLIENT_MUX_ERROR_PARAM;
+    pthread_mutex_unlock(&p_mux->lock);
+
+    *pp_reply = (NULL != p_call->p_reply) ? p_call->p_reply : "";
+    if (NULL != p_len)
+    {
+        *p_len = p_call->reply_len;
+    }
+
+    return status;
+}
+
+/*!
+ * @brief Stops the I/O thread and fails every call not yet answered.
+ *
+ * @param[in] p_mux Multiplexer
+ */
+void
+client_mux_shutdown(client_mux_t * p_mux)
+{
+    if (NULL == p_mux)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&p_mux->lock);
+    p_mux->b_running = false;
+    bool b_join      = !p_mux->b_joined;
+    p_mux->b_joined  = true;
+    pthread_mutex_unlock(&p_mux->lock);
+
+    if (b_join)
+    {
+        wake(p_mux);
+        pthread_join(p_mux->thread, NULL);
+    }
+}
+
+/*!
+ * @brief Shuts down and frees a multiplexer.
+ *
+ * @param[in,out] pp_mux Pointer to the multiplexer pointer; set to NULL
+ */
+void
+client_mux_destroy(client_mux_t ** pp_mux)
+{
+    if ((NULL == pp_mux) || (NULL == *pp_mux))
+    {
+        return;
+    }
+
+    client_mux_t * p_mux = *pp_mux;
+    client_mux_shutdown(p_mux);
+
+    pthread_mutex_destroy(&p_mux->lock);
+    close(p_mux->wake_fds[0]);
+    close(p_mux->wake_fds[1]);
+    free(p_mux->p_out);
+    free(p_mux->p_in);
+    free(p_mux);
+    *pp_mux = NULL;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Owns the socket: writes queued requests, reads and routes replies.
+ *
+ * @param[in] p_arg Multiplexer
+ *
+ * @return NULL in all cases
+ */
+static void *
+io_thread(void * p_arg)
+{
+    client_mux_t * p_mux = p_arg;
+    bool           b_ok  = true;
+
+    pthread_mutex_lock(&p_mux->lock);
+    while (b_ok && p_mux->b_running)
+    {
+        b_ok          = fill_output(p_mux);
+        bool b_output = (p_mux->out_sent < p_mux->out_len);
+        pthread_mutex_unlock(&p_mux->lock);
+
+        struct pollfd fds[2] = {
+            { .fd     = p_mux->socket_fd,
+              .events = (short)(POLLIN | (b_output ? POLLOUT : 0)) },
+            { .fd = p_mux->wake_fds[0], .events = POLLIN }
+        };
+
+        if ((poll(fds, 2, -1) < 0) && (EINTR != errno))
+        {
+            b_ok = false;
+        }
+
+        if (0 != (fds[1].revents & POLLIN))
+        {
+            char drain[WAKE_DRAIN];
+            while (read(p_mux->wake_fds[0], drain, sizeof(drain)) > 0)
+            {
+            }
+        }
+
+        if (b_ok && (0 != (fds[0].revents & POLLOUT)))
+        {
+            b_ok = flush_output(p_mux);
+        }
+
+        if (b_ok && (0 != (fds[0].revents & (POLLIN | POLLHUP | POLLERR))))
+        {
+            b_ok = read_replies(p_mux);
+        }
+
+        pthread_mutex_lock(&p_mux->lock);
+    }
+
+    p_mux->b_running = false;
+    fail_all(p_mux);
+    pthread_mutex_unlock(&p_mux->lock);
+
+    return NULL;
+}
+
+/*!
+ * @brief Moves submitted calls into the output buffer while the window
+ *        has room. Called with the lock held.
+ *
+ * @param[in,out] p_mux Multiplexer
+ *
+ * @return false if the output buffer could not grow
+ */
+static bool
+fill_output(client_mux_t * p_mux)
+{
+    while ((NULL != p_mux->p_send_head)
+           && (p_mux->outstanding < p_mux->max_outstanding))
+    {
+        client_mux_call_t * p_call = p_mux->p_send_head;
+
+        if (!append(&p_mux->p_out,
+                    &p_mux->out_len,
+                    &p_mux->out_cap,
+                    p_call->p_request,
+                    p_call->request_len))
+        {
+            return false;
+        }
+
+        p_mux->p_send_head = p_call->p_next;
+        if (NULL == p_mux->p_send_head)
+        {
+            p_mux->p_send_tail = NULL;
+        }
+
+        p_call->p_next = NULL;
+        if (NULL == p_mux->p_wait_tail)
+        {
+            p_mux->p_wait_head = p_call;
+        }
+        else
+        {
+            p_mux->p_wait_tail->p_next = p_call;
+        }
+        p_mux->p_wait_tail = p_call;
+        p_mux->outstanding++;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Writes as much of the output buffer as the socket takes.
+ *
+ * @param[in,out] p_mux Multiplexer
+ *
+ * @return false if the connection failed
+ */
+static bool
+flush_output(client_mux_t * p_mux)
+{
+    ssize_t sent = send(p_mux->socket_fd,
+                        p_mux->p_out + p_mux->out_sent,
+                        p_mux->out_len - p_mux->out_sent,
+                        MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    if (sent > 0)
+    {
+        p_mux->out_sent += (size_t)sent;
+        if (p_mux->out_sent == p_mux->out_len)
+        {
+            p_mux->out_sent = 0;
+            p_mux->out_len  = 0;
+        }
+    }
+
+    return (sent >= 0) || (EAGAIN == errno) || (EWOULDBLOCK == errno)
+           || (EINTR == errno);
+}
+
+/*!
+ * @brief Reads what the socket has and hands every complete line to the
+ *        oldest unanswered call.
+ *
+ * @param[in,out] p_mux Multiplexer
+ *
+ * @return false if the connection ended, failed, or broke the protocol
+ */
+static bool
+read_replies(client_mux_t * p_mux)
+{
+    ssize_t got = recv(p_mux->socket_fd,
+                       p_mux->p_in + p_mux->in_len,
+                       CLIENT_MUX_MAX_LINE - p_mux->in_len,
+                       MSG_DONTWAIT);
+
+    if (0 == got)
+    {
+        return false;
+    }
+
+    if (got < 0)
+    {
+        return (EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno);
+    }
+
+    p_mux->in_len += (size_t)got;
+
+    size_t start = 0;
+    bool   b_ok  = true;
+
+    pthread_mutex_lock(&p_mux->lock);
+    for (size_t idx = 0; b_ok && (idx < p_mux->in_len); idx++)
+    {
+        if ('\n' == p_mux->p_in[idx])
+        {
+            b_ok  = take_line(p_mux, p_mux->p_in + start, idx - start);
+            start = idx + 1;
+        }
+    }
+    pthread_mutex_unlock(&p_mux->lock);
+
+    // Keep the unfinished line; one that fills the buffer is an error
+    memmove(p_mux->p_in, p_mux->p_in + start, p_mux->in_len - start);
+    p_mux->in_len -= start;
+
+    return b_ok && (p_mux->in_len < CLIENT_MUX_MAX_LINE);
+}
+
+/*!
+ * @brief Routes one reply line. Called with the lock held.
+ *
+ * @param[in,out] p_mux  Multiplexer
+ * @param[in]     p_line Line without its newline
+ * @param[in]     len    Line length
+ *
+ * @return false for a line nobody is waiting for, or if memory runs out
+ */
+static bool
+take_line(client_mux_t * p_mux, char * p_line, size_t len)
+{
+    client_mux_call_t * p_call = p_mux->p_wait_head;
+
+    if ((len > 0) && ('\r' == p_line[len - 1]))
+    {
+        len--;
+    }
+
+    if (NULL == p_call)
+    {
+        return false;
+    }
+
+    if ((len == (sizeof(CLIENT_MUX_END_LINE) - 1))
+        && (0 == memcmp(p_line, CLIENT_MUX_END_LINE, len)))
+    {
+        finish_call(p_mux, CLIENT_MUX_SUCCESS);
+        return true;
+    }
+
+    return append(&p_call->p_reply,
+                  &p_call->reply_len,
+                  &p_call->reply_cap,
+                  p_line,
+                  len)
+           && append(&p_call->p_reply,
+                     &p_call->reply_len,
+                     &p_call->reply_cap,
+                     "\n",
+                     1);
+}
+
+/*!
+ * @brief Completes the oldest unanswered call. Called with the lock held.
+ *
+ * @param[in,out] p_mux  Multiplexer
+ * @param[in]     status Result for the caller
+ */
+static void
+finish_call(client_mux_t * p_mux, int status)
+{
+    client_mux_call_t * p_call = p_mux->p_wait_head;
+
+    p_mux->p_wait_head = p_call->p_next;
+    if (NULL == p_mux->p_wait_head)
+    {
+        p_mux->p_wait_tail = NULL;
+    }
+    p_mux->outstanding--;
+
+    p_call->p_next = NULL;
+    p_call->status = status;
+    p_call->state  = CALL_DONE;
+    pthread_cond_signal(&p_call->done);
+}
+
+/*!
+ * @brief Fails every unanswered call. Called with the lock held.
+ *
+ * @param[in,out] p_mux Multiplexer
+ */
+static void
+fail_all(client_mux_t * p_mux)
+{
+    while (NULL != p_mux->p_wait_head)
+    {
+        finish_call(p_mux, CLIENT_MUX_ERROR_CLOSED);
+    }
+
+    while (NULL != p_mux->p_send_head)
+    {
+        client_mux_call_t * p_call = p_mux->p_send_head;
+
+        p_mux->p_send_head = p_call->p_next;
+        p_call->p_next     = NULL;
+        p_call->status     = CLIENT_MUX_ERROR_CLOSED;
+        p_call->state      = CALL_DONE;
+        pthread_cond_signal(&p_call->done);
+    }
+    p_mux->p_send_tail = NULL;
+}
+
+/*!
+ * @brief Appends bytes to a growable buffer, keeping it NUL terminated.
+ *
+ * @param[in,out] pp_buf Buffer pointer
+ * @param[in,out] p_len  Bytes in use
+ * @param[in,out] p_cap  Allocated size
+ * @param[in]     p_data Bytes to add
+ * @param[in]     len    Number of bytes
+ *
+ * @return false if the buffer could not grow
+ */
+static bool
+append(char ** pp_buf,
+       size_t * p_len,
+       size_t * p_cap,
+       const char * p_data,
+       size_t       len)
+{
+    size_t need = *p_len + len + 1;
+
+    if (need > *p_cap)
+    {
+        size_t cap = (0 == *p_cap) ? INITIAL_BUFFER : *p_cap;
+        while (cap < need)
+        {
+            cap *= 2;
+        }
+
+        char * p_grown = realloc(*pp_buf, cap);
+        if (NULL == p_grown)
+        {
+            return false;
+        }
+
+        *pp_buf = p_grown;
+        *p_cap  = cap;
+    }
+
+    memcpy(*pp_buf + *p_len, p_data, len);
+    *p_len += len;
+    (*pp_buf)[*p_len] = '\0';
+    return true;
+}
+
+/*!
+ * @brief Interrupts the I/O thread's poll().
+ *
+ * @param[in] p_mux Multiplexer
+ */
+static void
+wake(client_mux_t * p_mux)
+{
+    // A full pipe already guarantees a wakeup
+    char byte = 0;
+    ssize_t ignored = write(p_mux->wake_fds[1], &byte, 1);
+    (void)ignored;
+}
+
+/*** end of file ***/
@@ -0,0 +1,139 @@
+/** @file client_mux.h
+ *
+ * @brief Pipelined request multiplexer over one line-based connection.
+ *
+ * One I/O thread owns the socket. Worker threads hand it request lines and
+ * sleep on a per-call condition variable; the I/O thread writes requests
+ * as long as fewer than the configured window are outstanding, splits the
+ * incoming byte stream into lines and appends them to the reply of the
+ * oldest outstanding call until an "END" line completes it. Replies are
+ * matched to requests by order, since the bartender protocol answers
+ * requests in the order it receives them and carries no request id of its
+ * own; every call is tagged with its position in that order.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef CLIENT_MUX_H
+#define CLIENT_MUX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define CLIENT_MUX_SUCCESS       (0)
+#define CLIENT_MUX_ERROR_PARAM   (-1)
+#define CLIENT_MUX_ERROR_MEMORY  (-2)
+#define CLIENT_MUX_ERROR_CLOSED  (-3)  /* Connection lost or mux shut down */
+
+#define CLIENT_MUX_MAX_LINE      (65536) /* Longest reply line accepted */
+#define CLIENT_MUX_END_LINE      "END"   /* Line that completes a reply */
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Connection owner and its I/O thread */
+typedef struct client_mux client_mux_t;
+
+/* One request/reply exchange; reusable once it has completed */
+typedef struct client_mux_call client_mux_call_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Takes over a connected socket and starts its I/O thread.
+ *
+ * The socket is only accessed by the I/O thread from then on; it is not
+ * closed by client_mux_destroy.
+ *
+ * @param[in] socket_fd       Connected stream socket
+ * @param[in] max_outstanding Requests written but not yet answered (> 0)
+ *
+ * @return Pointer to the multiplexer, or NULL on failure
+ */
+client_mux_t *
+client_mux_create(int socket_fd, uint32_t max_outstanding);
+
+/*!
+ * @brief Allocates an exchange that can be submitted repeatedly.
+ *
+ * @param[in] p_mux Multiplexer the call will be used with
+ *
+ * @return Pointer to the call, or NULL on failure
+ */
+client_mux_call_t *
+client_mux_call_create(client_mux_t * p_mux);
+
+/*!
+ * @brief Frees an exchange that is not in progress.
+ *
+ * @param[in,out] pp_call Pointer to the call pointer; set to NULL
+ */
+void
+client_mux_call_destroy(client_mux_call_t ** pp_call);
+
+/*!
+ * @brief Queues a request line without waiting for its reply.
+ *
+ * @param[in]     p_mux     Multiplexer
+ * @param[in,out] p_call    Idle call to carry the exchange
+ * @param[in]     p_request Request text, normally ending in a newline
+ *
+ * @return Tag of the request (1 for the first request on the connection),
+ *         or a negative error code
+ */
+int64_t
+client_mux_submit(client_mux_t *      p_mux,
+                  client_mux_call_t * p_call,
+                  const char *        p_request);
+
+/*!
+ * @brief Waits for a submitted request to be answered.
+ *
+ * The reply holds every line received before "END", each ending in a
+ * newline, and stays valid until the call is submitted again or freed.
+ *
+ * @param[in]     p_mux    Multiplexer
+ * @param[in,out] p_call   Submitted call
+ * @param[out]    pp_reply Reply text (NUL terminated)
+ * @param[out]    p_len    Optional reply length in bytes
+ *
+ * @return CLIENT_MUX_SUCCESS, or CLIENT_MUX_ERROR_CLOSED if the connection
+ *         ended before the reply was complete
+ */
+int
+client_mux_wait(client_mux_t *      p_mux,
+                client_mux_call_t * p_call,
+                const char **       pp_reply,
+                size_t *            p_len);
+
+/*!
+ * @brief Stops the I/O thread and fails every call not yet answered.
+ *
+ * Workers blocked in client_mux_wait return CLIENT_MUX_ERROR_CLOSED.
+ *
+ * @param[in] p_mux Multiplexer
+ */
+void
+client_mux_shutdown(client_mux_t * p_mux);
+
+/*!
+ * @brief Shuts down and frees a multiplexer.
+ *
+ * No worker may still be using it.
+ *
+ * @param[in,out] pp_mux Pointer to the multiplexer pointer; set to NULL
+ */
+void
+client_mux_destroy(client_mux_t ** pp_mux);
+
+#endif /* CLIENT_MUX_H */
+
+/*** end of file ***/
@@ -0,0 +1,448 @@
+/** @file client_mux_bench.c
+ *
+ * @brief Bartender exchanges per second with turn-taking and with the mux.
+ *
+ * A fake bartender runs on one end of a socketpair. It answers every
+ * TAKE_ONE_DOWN line with IMAGE_LINES image lines and an "END" line, but
+ * only RTT_US after the request arrived, like a server across a network;
+ * it keeps any number of requests in flight. WORKERS client threads then
+ * talk to it for a fixed time in each mode:
+ *
+ * - turn-taking: a worker takes the shared lock, sends one request, reads
+ *   the reply up to "END", unlocks and sleeps, as worker.c always did.
+ *   Only one exchange is ever in flight.
+ * - mux: the workers share a client_mux_t and keep DEPTH requests each
+ *   queued, sleeping on completions instead of a timer.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L client_mux_bench.c
+ *        client_mux.c -pthread
+ *
+ * Usage: client_mux_bench [seconds_per_run]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "client_mux.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define WORKERS         (4)
+#define RTT_US          (2000u)
+#define IMAGE_LINES     (3)
+#define MAX_DEPTH       (16)
+#define MAX_PENDING     (4096u)
+#define DEFAULT_SECONDS (2u)
+#define LINE_SIZE       (256)
+#define NUM_MODES       (5u)
+
+#define NSEC_PER_USEC   (1000ull)
+#define NSEC_PER_MSEC   (1000000ull)
+#define NSEC_PER_SEC    (1000000000ull)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Fake server state */
+typedef struct
+{
+    int      socket_fd;
+    uint64_t p_due[MAX_PENDING]; /* Reply times of queued requests */
+    uint32_t head;
+    uint32_t count;
+    char     in[LINE_SIZE * 4];                    /* Partial request line */
+    char     reply[LINE_SIZE * (IMAGE_LINES + 1)]; /* Canned reply */
+} bartender_t;
+
+/* Everything the client threads of one run share */
+typedef struct
+{
+    int             socket_fd;  /* Turn-taking: shared socket */
+    pthread_mutex_t turn_lock;  /* Turn-taking: one exchange at a time */
+    uint32_t        sleep_us;   /* Turn-taking: pause after each turn */
+    char            in[4096];   /* Turn-taking: bytes read past a line */
+    size_t          in_len;
+    client_mux_t *  p_mux;      /* Mux mode when not NULL */
+    uint32_t        depth;      /* Mux: requests queued per worker */
+    uint64_t        stop_ns;    /* When workers stop starting exchanges */
+    uint64_t        exchanges;  /* Completed exchanges, all workers */
+    uint64_t        failures;   /* Replies that were not what was sent */
+} run_t;
+
+/* One benchmark row */
+typedef struct
+{
+    const char * p_name;
+    uint32_t     sleep_us; /* Turn-taking mode */
+    uint32_t     depth;    /* Mux mode when not 0 */
+} bench_mode_t;
+
+/*************************************************************************
+ * Static Functions
+ *************************************************************************/
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+static bool
+send_all(int socket_fd, const char * p_data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t sent = send(socket_fd, p_data, len, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return false;
+        }
+        p_data += sent;
+        len    -= (size_t)sent;
+    }
+    return true;
+}
+
+/*!
+ * @brief Answers requests RTT_US after they arrive until the client end
+ *        of the socketpair is closed.
+ *
+ * @param[in] p_arg Bartender state
+ *
+ * @return NULL in all cases
+ */
+static void *
+bartender_thread(void * p_arg)
+{
+    bartender_t * p_bar     = p_arg;
+    char *        in        = p_bar->in;
+    size_t        in_len    = 0;
+    char *        reply     = p_bar->reply;
+    size_t        reply_len = 0;
+
+    for (int line = 0; line < IMAGE_LINES; line++)
+    {
+        reply_len += (size_t)snprintf(reply + reply_len,
+                                      sizeof(p_bar->reply) - reply_len,
+                                      "IMAGE %d 0123456789abcdef\n",
+                                      line);
+    }
+    reply_len += (size_t)snprintf(reply + reply_len,
+                                  sizeof(p_bar->reply) - reply_len,
+                                  "END\n");
+
+    for (;;)
+    {
+        // Send every reply that is due, then sleep until the next one
+        uint64_t now     = now_ns();
+        int      timeout = -1;
+        while (p_bar->count > 0)
+        {
+            uint64_t due = p_bar->p_due[p_bar->head];
+            if (due > now)
+            {
+                timeout = (int)(((due - now) + NSEC_PER_MSEC - 1)
+                                / NSEC_PER_MSEC);
+                break;
+            }
+            if (!send_all(p_bar->socket_fd, reply, reply_len))
+            {
+                return NULL;
+            }
+            p_bar->head = (p_bar->head + 1) % MAX_PENDING;
+            p_bar->count--;
+        }
+
+        struct pollfd pfd = { .fd = p_bar->socket_fd, .events = POLLIN };
+        if (poll(&pfd, 1, timeout) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t got = recv(p_bar->socket_fd, in + in_len,
+                           sizeof(p_bar->in) - in_len, 0);
+        if (got <= 0)
+        {
+            return NULL;
+        }
+        in_len += (size_t)got;
+
+        size_t start = 0;
+        for (size_t idx = 0; idx < in_len; idx++)
+        {
+            if (('\n' == in[idx]) && (p_bar->count < MAX_PENDING))
+            {
+                uint32_t tail = (p_bar->head + p_bar->count) % MAX_PENDING;
+                p_bar->p_due[tail] = now_ns() + (RTT_US * NSEC_PER_USEC);
+                p_bar->count++;
+                start = idx + 1;
+            }
+        }
+        memmove(in, in + start, in_len - start);
+        in_len -= start;
+    }
+}
+
+/*!
+ * @brief Reads one line from the shared socket. Called under the turn lock.
+ *
+ * @param[in,out] p_run Run state
+ * @param[out]    p_line Line without its newline
+ *
+ * @return false if the connection ended
+ */
+static bool
+read_line(run_t * p_run, char * p_line)
+{
+    for (;;)
+    {
+        char * p_end = memchr(p_run->in, '\n', p_run->in_len);
+        if (NULL != p_end)
+        {
+            size_t len = (size_t)(p_end - p_run->in);
+            memcpy(p_line, p_run->in, len);
+            p_line[len] = '\0';
+            p_run->in_len -= len + 1;
+            memmove(p_run->in, p_end + 1, p_run->in_len);
+            return true;
+        }
+
+        ssize_t got = recv(p_run->socket_fd, p_run->in + p_run->in_len,
+                           sizeof(p_run->in) - p_run->in_len, 0);
+        if (got <= 0)
+        {
+            return false;
+        }
+        p_run->in_len += (size_t)got;
+    }
+}
+
+static void *
+turn_worker(void * p_arg)
+{
+    static const char request[] = "TAKE_ONE_DOWN 80\n";
+    run_t *           p_run     = p_arg;
+    char              line[LINE_SIZE];
+
+    while (now_ns() < p_run->stop_ns)
+    {
+        pthread_mutex_lock(&p_run->turn_lock);
+        bool b_ok = send_all(p_run->socket_fd, request, sizeof(request) - 1);
+        int  lines = 0;
+        while (b_ok && (b_ok = read_line(p_run, line))
+               && (0 != strcmp(line, "END")))
+        {
+            lines++;
+        }
+        p_run->exchanges++;
+        p_run->failures += (b_ok && (IMAGE_LINES == lines)) ? 0 : 1;
+        pthread_mutex_unlock(&p_run->turn_lock);
+
+        if (!b_ok)
+        {
+            break;
+        }
+        if (p_run->sleep_us > 0)
+        {
+            struct timespec pause = {
+                .tv_sec  = 0,
+                .tv_nsec = (long)(p_run->sleep_us * NSEC_PER_USEC)
+            };
+            nanosleep(&pause, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+static void *
+mux_worker(void * p_arg)
+{
+    run_t *             p_run = p_arg;
+    client_mux_call_t * calls[MAX_DEPTH] = { NULL };
+    uint64_t            done  = 0;
+    uint64_t            bad   = 0;
+    uint32_t            queued;
+
+    for (queued = 0; queued < p_run->depth; queued++)
+    {
+        calls[queued] = client_mux_call_create(p_run->p_mux);
+        if ((NULL == calls[queued])
+            || (client_mux_submit(p_run->p_mux, calls[queued],
+                                  "TAKE_ONE_DOWN 80\n") < 0))
+        {
+            client_mux_call_destroy(&calls[queued]);
+            break;
+        }
+    }
+
+    // Wait on the oldest request, then queue another in its place
+    uint32_t live = queued;
+    for (uint32_t idx = 0; live > 0; idx = (idx + 1) % queued)
+    {
+        const char * p_reply = NULL;
+        size_t       len     = 0;
+
+        if (NULL == calls[idx])
+        {
+            continue;
+        }
+        if (CLIENT_MUX_SUCCESS
+            != client_mux_wait(p_run->p_mux, calls[idx], &p_reply, &len))
+        {
+            break;
+        }
+
+        int lines = 0;
+        for (size_t pos = 0; pos < len; pos++)
+        {
+            lines += ('\n' == p_reply[pos]) ? 1 : 0;
+        }
+        done++;
+        bad += (IMAGE_LINES == lines) ? 0 : 1;
+
+        if ((now_ns() >= p_run->stop_ns)
+            || (client_mux_submit(p_run->p_mux, calls[idx],
+                                  "TAKE_ONE_DOWN 80\n") < 0))
+        {
+            client_mux_call_destroy(&calls[idx]);
+            live--;
+        }
+    }
+
+    for (uint32_t idx = 0; idx < queued; idx++)
+    {
+        client_mux_call_destroy(&calls[idx]);
+    }
+
+    __atomic_add_fetch(&p_run->exchanges, done, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&p_run->failures, bad, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/*!
+ * @brief Runs one mode against a fresh bartender and prints a result row.
+ *
+ * @param[in] p_mode  Mode under test
+ * @param[in] seconds Length of the run
+ *
+ * @return true if every reply was well formed
+ */
+static bool
+run_one(const bench_mode_t * p_mode, uint32_t seconds)
+{
+    int           fds[2];
+    pthread_t     bar_thread;
+    pthread_t     workers[WORKERS];
+    bartender_t * p_bar = calloc(1, sizeof(bartender_t));
+    run_t *       p_run = calloc(1, sizeof(run_t));
+
+    if ((NULL == p_bar) || (NULL == p_run)
+        || (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds)))
+    {
+        free(p_bar);
+        free(p_run);
+        return false;
+    }
+
+    p_bar->socket_fd = fds[1];
+    pthread_create(&bar_thread, NULL, bartender_thread, p_bar);
+
+    p_run->socket_fd = fds[0];
+    p_run->sleep_us  = p_mode->sleep_us;
+    p_run->depth     = p_mode->depth;
+    pthread_mutex_init(&p_run->turn_lock, NULL);
+    if (0 != p_mode->depth)
+    {
+        p_run->p_mux = client_mux_create(fds[0], WORKERS * p_mode->depth);
+    }
+
+    uint64_t start = now_ns();
+    p_run->stop_ns = start + (seconds * NSEC_PER_SEC);
+    for (int idx = 0; idx < WORKERS; idx++)
+    {
+        pthread_create(&workers[idx], NULL,
+                       (NULL != p_run->p_mux) ? mux_worker : turn_worker,
+                       p_run);
+    }
+    for (int idx = 0; idx < WORKERS; idx++)
+    {
+        pthread_join(workers[idx], NULL);
+    }
+    double secs = (double)(now_ns() - start) / NSEC_PER_SEC;
+
+    client_mux_destroy(&p_run->p_mux);
+    close(fds[0]);
+    pthread_join(bar_thread, NULL);
+    close(fds[1]);
+
+    printf("  %-22s %10.0f %10llu\n",
+           p_mode->p_name,
+           (double)p_run->exchanges / secs,
+           (unsigned long long)p_run->failures);
+
+    bool b_ok = (0 == p_run->failures) && (p_run->exchanges > 0);
+    pthread_mutex_destroy(&p_run->turn_lock);
+    free(p_run);
+    free(p_bar);
+    return b_ok;
+}
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t seconds
+        = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_SECONDS;
+
+    const bench_mode_t modes[NUM_MODES] = {
+        { "turns + 100 ms sleep", 100000, 0 },
+        { "turns, no sleep", 0, 0 },
+        { "mux depth 1", 0, 1 },
+        { "mux depth 4", 0, 4 },
+        { "mux depth 16", 0, MAX_DEPTH },
+    };
+
+    if (0 == seconds)
+    {
+        seconds = 1;
+    }
+
+    printf("%d workers, %u us round trip, %d image lines per reply\n\n",
+           WORKERS,
+           RTT_US,
+           IMAGE_LINES);
+    printf("  %-22s %10s %10s\n", "mode", "exch/s", "bad");
+
+    bool b_ok = true;
+    for (uint32_t idx = 0; idx < NUM_MODES; idx++)
+    {
+        b_ok = run_one(&modes[idx], seconds) && b_ok;
+    }
+
+    return b_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*** end of file ***/
@@ -0,0 +1,382 @@
+#include <check.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "client_mux.h"
+
+#define WORKERS    (6)
+#define LINE_SIZE  (64)
+#define WAIT_MS    (2000)
+#define QUIET_MS   (200)
+
+// Bartender end of the socketpair and what has been read from it
+typedef struct
+{
+    int    fd;
+    char   buffer[1024];
+    size_t len;
+} bartender_t;
+
+typedef struct
+{
+    client_mux_t * p_mux;
+    int            id;
+    int64_t        tag;
+    int            status;
+    char           reply[LINE_SIZE * 2];
+} waiter_t;
+
+static int         g_fds[2];
+static bartender_t g_bar;
+
+static void
+pair_setup(void)
+{
+    ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, g_fds), 0);
+    g_bar.fd  = g_fds[1];
+    g_bar.len = 0;
+}
+
+static void
+pair_teardown(void)
+{
+    close(g_fds[0]);
+    if (g_fds[1] >= 0)
+    {
+        close(g_fds[1]);
+    }
+}
+
+// Reads one request line, waiting at most timeout_ms; false on timeout
+static bool
+bartender_read_line(bartender_t * p_bar, char * p_line, int timeout_ms)
+{
+    for (;;)
+    {
+        char * p_nl = memchr(p_bar->buffer, '\n', p_bar->len);
+        if (NULL != p_nl)
+        {
+            size_t len = (size_t)(p_nl - p_bar->buffer);
+
+            memcpy(p_line, p_bar->buffer, len);
+            p_line[len] = '\0';
+            p_bar->len -= len + 1;
+            memmove(p_bar->buffer, p_nl + 1, p_bar->len);
+            return true;
+        }
+
+        struct pollfd pfd = { p_bar->fd, POLLIN, 0 };
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+        {
+            return false;
+        }
+
+        ssize_t got = read(p_bar->fd,
+                           p_bar->buffer + p_bar->len,
+                           sizeof(p_bar->buffer) - p_bar->len);
+        if (got <= 0)
+        {
+            return false;
+        }
+        p_bar->len += (size_t)got;
+    }
+}
+
+static void
+bartender_write(bartender_t * p_bar, const char * p_text)
+{
+    size_t len = strlen(p_text);
+
+    ck_assert_int_eq(write(p_bar->fd, p_text, len), (ssize_t)len);
+}
+
+// Submits one request, named after the worker, and waits for its reply
+static void *
+waiter_run(void * p_arg)
+{
+    waiter_t *          p_waiter = p_arg;
+    client_mux_call_t * p_call   = client_mux_call_create(p_waiter->p_mux);
+    char                request[LINE_SIZE];
+    const char *        p_reply  = "";
+
+    snprintf(request, sizeof(request), "TAKE_ONE_DOWN %d\n", p_waiter->id);
+    p_waiter->status = CLIENT_MUX_ERROR_MEMORY;
+
+    if (NULL != p_call)
+    {
+        p_waiter->tag = client_mux_submit(p_waiter->p_mux, p_call, request);
+        p_waiter->status
+            = (p_waiter->tag > 0)
+                  ? client_mux_wait(p_waiter->p_mux, p_call, &p_reply, NULL)
+                  : (int)p_waiter->tag;
+        snprintf(p_waiter->reply, sizeof(p_waiter->reply), "%s", p_reply);
+        client_mux_call_destroy(&p_call);
+    }
+
+    return NULL;
+}
+
+START_TEST(test_pipelined_replies_reach_their_waiters)
+{
+    bartender_t *  p_bar = &g_bar;
+    client_mux_t * p_mux = client_mux_create(g_fds[0], WORKERS);
+    static waiter_t waiters[WORKERS];
+    pthread_t      threads[WORKERS];
+    char           lines[WORKERS][LINE_SIZE];
+
+    ck_assert_ptr_nonnull(p_mux);
+
+    for (int idx = 0; idx < WORKERS; idx++)
+    {
+        waiters[idx] = (waiter_t){ .p_mux = p_mux, .id = idx + 1 };
+        ck_assert_int_eq(
+            pthread_create(&threads[idx], NULL, waiter_run, &waiters[idx]), 0);
+    }
+
+    // Every request is on the wire before any of them has been answered
+    for (int idx = 0; idx < WORKERS; idx++)
+    {
+        ck_assert(bartender_read_line(p_bar, lines[idx], WAIT_MS));
+        ck_assert_int_eq(strncmp(lines[idx], "TAKE_ONE_DOWN ", 14), 0);
+    }
+
+    // Answer in order, each reply naming its request, cut at odd places
+    static char replies[WORKERS * LINE_SIZE * 2];
+    size_t len = 0;
+    for (int idx = 0; idx < WORKERS; idx++)
+    {
+        len += (size_t)snprintf(replies + len, sizeof(replies) - len,
+                                "IMAGE for %s\nIMAGE %d\nEND\n", lines[idx],
+                                idx);
+    }
+    for (size_t pos = 0; pos < len; pos += 7)
+    {
+        size_t piece = (len - pos < 7) ? (len - pos) : 7;
+        ck_assert_int_eq(write(p_bar->fd, replies + pos, piece), (ssize_t)piece);
+    }
+
+    bool b_tag_seen[WORKERS + 1] = { false };
+    for (int idx = 0; idx < WORKERS; idx++)
+    {
+        char expected[LINE_SIZE * 2];
+
+        pthread_join(threads[idx], NULL);
+        ck_assert_int_eq(waiters[idx].status, CLIENT_MUX_SUCCESS);
+        ck_assert_int_ge(waiters[idx].tag, 1);
+        ck_assert_int_le(waiters[idx].tag, WORKERS);
+        ck_assert(!b_tag_seen[waiters[idx].tag]);
+        b_tag_seen[waiters[idx].tag] = true;
+
+        // The tag is the request's place on the wire, and the reply is the
+        // one written for that place
+        int64_t place = waiters[idx].tag - 1;
+        snprintf(expected, sizeof(expected),
+                 "IMAGE for TAKE_ONE_DOWN %d\nIMAGE %d\n", waiters[idx].id,
+                 (int)place);
+        ck_assert_str_eq(waiters[idx].reply, expected);
+    }
+
+    client_mux_destroy(&p_mux);
+    ck_assert_ptr_null(p_mux);
+}
+END_TEST
+
+START_TEST(test_window_limits_requests_in_flight)
+{
+    bartender_t *       p_bar = &g_bar;
+    client_mux_t *      p_mux = client_mux_create(g_fds[0], 2);
+    client_mux_call_t * p_calls[4];
+    char                line[LINE_SIZE];
+    const char *        p_reply;
+    size_t              len;
+
+    ck_assert_ptr_nonnull(p_mux);
+
+    for (int idx = 0; idx < 4; idx++)
+    {
+        p_calls[idx] = client_mux_call_create(p_mux);
+        ck_assert_ptr_nonnull(p_calls[idx]);
+        snprintf(line, sizeof(line), "TAKE_ONE_DOWN %d\n", idx);
+        ck_assert_int_eq(client_mux_submit(p_mux, p_calls[idx], line),
+                         idx + 1);
+    }
+
+    // Only two requests go out until one of them is answered
+    ck_assert(bartender_read_line(p_bar, line, WAIT_MS));
+    ck_assert_str_eq(line, "TAKE_ONE_DOWN 0");
+    ck_assert(bartender_read_line(p_bar, line, WAIT_MS));
+    ck_assert_str_eq(line, "TAKE_ONE_DOWN 1");
+    ck_assert(!bartender_read_line(p_bar, line, QUIET_MS));
+
+    bartender_write(p_bar, "IMAGE zero\nEND\n");
+    ck_assert_int_eq(client_mux_wait(p_mux, p_calls[0], &p_reply, &len),
+                     CLIENT_MUX_SUCCESS);
+    ck_assert_str_eq(p_reply, "IMAGE zero\n");
+    ck_assert_uint_eq(len, strlen("IMAGE zero\n"));
+
+    ck_assert(bartender_read_line(p_bar, line, WAIT_MS));
+    ck_assert_str_eq(line, "TAKE_ONE_DOWN 2");
+    ck_assert(!bartender_read_line(p_bar, line, QUIET_MS));
+
+    // An empty reply is just "END"
+    bartender_write(p_bar, "END\nIMAGE two\nEN");
+    ck_assert(bartender_read_line(p_bar, line, WAIT_MS));
+    ck_assert_str_eq(line, "TAKE_ONE_DOWN 3");
+    bartender_write(p_bar, "D\nIMAGE three\nEND\n");
+
+    ck_assert_int_eq(client_mux_wait(p_mux, p_calls[1], &p_reply, NULL),
+                     CLIENT_MUX_SUCCESS);
+    ck_assert_str_eq(p_reply, "");
+    ck_assert_int_eq(client_mux_wait(p_mux, p_calls[2], &p_reply, NULL),
+                     CLIENT_MUX_SUCCESS);
+    ck_assert_str_eq(p_reply, "IMAGE two\n");
+    ck_assert_int_eq(client_mux_wait(p_mux, p_calls[3], &p_reply, NULL),
+                     CLIENT_MUX_SUCCESS);
+    ck_assert_str_eq(p_reply, "IMAGE three\n");
+
+    // A completed call can carry another exchange
+    ck_assert_int_eq(client_mux_submit(p_mux, p_calls[0], "TAKE_ONE_DOWN 4\n"),
+                     5);
+    ck_assert(bartender_read_line(p_bar, line, WAIT_MS));
+    ck_assert_str_eq(line, "TAKE_ONE_DOWN 4");
+    bartender_write(p_bar, "IMAGE four\nEND\n");
+    ck_assert_int_eq(client_mux_wait(p_mux, p_calls[0], &p_reply, NULL),
+                     CLIENT_MUX_SUCCESS);
+    ck_assert_str_eq(p_reply, "IMAGE four\n");
+
+    for (int idx = 0; idx < 4; idx++)
+    {
+        client_mux_call_destroy(&p_calls[idx]);
+    }
+    client_mux_destroy(&p_mux);
+}
+END_TEST
+
+START_TEST(test_peer_closes_mid_pipeline)
+{
+    bartender_t *  p_bar = &g_bar;
+    client_mux_t * p_mux = client_mux_create(g_fds[0], WORKERS);
+    static waiter_t waiters[3];
+    pthread_t      threads[3];
+    char           lines[3][LINE_SIZE];
+
+    ck_assert_ptr_nonnull(p_mux);
+
+    for (int idx = 0; idx < 3; idx++)
+    {
+        waiters[idx] = (waiter_t){ .p_mux = p_mux, .id = idx + 1 };
+        ck_assert_int_eq(
+            pthread_create(&threads[idx], NULL, waiter_run, &waiters[idx]), 0);
+    }
+    for (int idx = 0; idx < 3; idx++)
+    {
+        ck_assert(bartender_read_line(p_bar, lines[idx], WAIT_MS));
+    }
+
+    // The first reply is whole, the second is cut off by the close
+    char text[LINE_SIZE * 2];
+    snprintf(text, sizeof(text), "IMAGE for %s\nEND\nIMAGE half\n", lines[0]);
+    bartender_write(p_bar, text);
+    close(p_bar->fd);
+    g_fds[1] = -1;
+
+    int succeeded = 0;
+    for (int idx = 0; idx < 3; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+
+        if (1 == waiters[idx].tag)
+        {
+            char expected[LINE_SIZE * 2];
+            snprintf(expected, sizeof(expected),
+                     "IMAGE for TAKE_ONE_DOWN %d\n", waiters[idx].id);
+            ck_assert_int_eq(waiters[idx].status, CLIENT_MUX_SUCCESS);
+            ck_assert_str_eq(waiters[idx].reply, expected);
+            succeeded++;
+        }
+        else
+        {
+            ck_assert_int_eq(waiters[idx].status, CLIENT_MUX_ERROR_CLOSED);
+        }
+    }
+    ck_assert_int_eq(succeeded, 1);
+
+    // Nothing more can be submitted on a lost connection
+    client_mux_call_t * p_call = client_mux_call_create(p_mux);
+    ck_assert_ptr_nonnull(p_call);
+    ck_assert_int_eq(client_mux_submit(p_mux, p_call, "TAKE_ONE_DOWN 9\n"),
+                     CLIENT_MUX_ERROR_CLOSED);
+
+    client_mux_call_destroy(&p_call);
+    client_mux_destroy(&p_mux);
+}
+END_TEST
+
+START_TEST(test_shutdown_fails_waiters)
+{
+    bartender_t *  p_bar = &g_bar;
+    client_mux_t * p_mux = client_mux_create(g_fds[0], WORKERS);
+    waiter_t       waiter = { .p_mux = p_mux, .id = 1 };
+    pthread_t      thread;
+    char           line[LINE_SIZE];
+
+    ck_assert_ptr_nonnull(p_mux);
+    ck_assert_ptr_null(client_mux_create(g_fds[0], 0));
+
+    ck_assert_int_eq(pthread_create(&thread, NULL, waiter_run, &waiter), 0);
+    ck_assert(bartender_read_line(p_bar, line, WAIT_MS));
+
+    client_mux_shutdown(p_mux);
+    pthread_join(thread, NULL);
+    ck_assert_int_eq(waiter.status, CLIENT_MUX_ERROR_CLOSED);
+
+    client_mux_destroy(&p_mux);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+client_mux_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Client_Mux");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_checked_fixture(tc_core, pair_setup, pair_teardown);
+    tcase_add_test(tc_core, test_pipelined_replies_reach_their_waiters);
+    tcase_add_test(tc_core, test_window_limits_requests_in_flight);
+    tcase_add_test(tc_core, test_peer_closes_mid_pipeline);
+    tcase_add_test(tc_core, test_shutdown_fails_waiters);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = client_mux_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
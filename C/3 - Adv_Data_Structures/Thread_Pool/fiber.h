@@ -0,0 +1,206 @@
+/** @file fiber.h
+ *
+ * @brief Stackful coroutines scheduled on a thread pool.
+ *
+ * A fiber is a function with its own stack that a pool worker runs until
+ * it finishes or waits. The socket wrappers below try the operation
+ * without blocking; if it would block, the fiber hands its descriptor to
+ * the scheduler's epoll thread and switches back to the worker, which
+ * goes on with other fibers. When the descriptor becomes ready the fiber
+ * is queued on the pool again, possibly resuming on another worker. A few
+ * threads can therefore serve as many blocking-style sessions as there
+ * are stacks.
+ *
+ * A fiber can bound its waits: an idle timeout limits each wait and a
+ * deadline limits all of them together. A wait that runs out fails with
+ * ETIMEDOUT. The epoll thread keeps these timers in a timer_wheel_t and
+ * sleeps until the next one is due, so idle sessions are reaped without
+ * scanning them.
+ *
+ * The wrappers behave like the plain calls when not used from a fiber, so
+ * the same code can run as an ordinary pool job; timeouts apply only to
+ * waits on a fiber. A fiber must not hold a
+ * pthread mutex across a call that may wait, since it may wake on a
+ * different thread.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef FIBER_H
+#define FIBER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define FIBER_SUCCESS        (0)
+#define FIBER_ERROR_PARAM    (-1)
+#define FIBER_ERROR_MEMORY   (-2)
+#define FIBER_ERROR_QUEUE    (-3)  /* Scheduler is shutting down */
+
+#define FIBER_DEFAULT_STACK  (65536u)  /* Bytes, including a guard page */
+#define FIBER_MIN_STACK      (16384u)
+
+#define FIBER_WAIT_READ      (0x1u)
+#define FIBER_WAIT_WRITE     (0x2u)
+
+#define FIBER_NO_TIMEOUT     (-1)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Pool, epoll thread and bookkeeping for a set of fibers */
+typedef struct fiber_sched fiber_sched_t;
+
+/* Body of a fiber */
+typedef void (*fiber_fn_t)(void * p_arg);
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Starts a scheduler with its own pool and epoll thread.
+ *
+ * @param[in] num_threads Pool workers that run fibers (> 0)
+ * @param[in] stack_size  Stack bytes per fiber, 0 for FIBER_DEFAULT_STACK
+ *
+ * @return Pointer to the scheduler, or NULL on failure
+ */
+fiber_sched_t *
+fiber_sched_create(int num_threads, size_t stack_size);
+
+/*!
+ * @brief Starts a fiber. May be called from any thread or fiber.
+ *
+ * @param[in] p_sched Scheduler
+ * @param[in] fiber_fn Body
+ * @param[in] p_arg    Argument for the body
+ *
+ * @return FIBER_SUCCESS or a negative error code
+ */
+int
+fiber_spawn(fiber_sched_t * p_sched, fiber_fn_t fiber_fn, void * p_arg);
+
+/*!
+ * @brief Number of fibers started and not yet finished.
+ *
+ * @param[in] p_sched Scheduler
+ *
+ * @return Live fiber count
+ */
+uint64_t
+fiber_sched_live(fiber_sched_t * p_sched);
+
+/*!
+ * @brief Blocks the calling thread until every fiber has finished.
+ *
+ * @param[in] p_sched Scheduler
+ */
+void
+fiber_sched_wait(fiber_sched_t * p_sched);
+
+/*!
+ * @brief Waits for all fibers, then stops the pool and epoll thread.
+ *        Spawns from then on fail with FIBER_ERROR_QUEUE.
+ *
+ * @param[in] p_sched Scheduler
+ */
+void
+fiber_sched_shutdown(fiber_sched_t * p_sched);
+
+/*!
+ * @brief Shuts down and frees a scheduler.
+ *
+ * @param[in,out] pp_sched Pointer to the scheduler pointer; set to NULL
+ */
+void
+fiber_sched_destroy(fiber_sched_t ** pp_sched);
+
+/*!
+ * @brief Whether the caller is running on a fiber.
+ *
+ * @return true inside a fiber
+ */
+bool
+fiber_is_running(void);
+
+/*!
+ * @brief Lets other ready fibers run; returns at once outside a fiber.
+ */
+void
+fiber_yield(void);
+
+/*!
+ * @brief Limits every later wait of the calling fiber to timeout_ms.
+ *
+ * @param[in] timeout_ms Milliseconds, or FIBER_NO_TIMEOUT
+ *
+ * @return FIBER_SUCCESS, or FIBER_ERROR_PARAM outside a fiber
+ */
+int
+fiber_set_idle_timeout(int timeout_ms);
+
+/*!
+ * @brief Makes every wait of the calling fiber that has not finished
+ *        timeout_ms from now fail.
+ *
+ * @param[in] timeout_ms Milliseconds from now, or FIBER_NO_TIMEOUT
+ *
+ * @return FIBER_SUCCESS, or FIBER_ERROR_PARAM outside a fiber
+ */
+int
+fiber_set_deadline(int timeout_ms);
+
+/*!
+ * @brief Waits until a descriptor is readable or writable.
+ *
+ * Outside a fiber this blocks the thread in poll().
+ *
+ * @param[in] fd     Descriptor
+ * @param[in] events FIBER_WAIT_READ and/or FIBER_WAIT_WRITE
+ *
+ * @return 0, or -1 with errno set (ETIMEDOUT when a timeout ran out)
+ */
+int
+fiber_wait_fd(int fd, uint32_t events);
+
+/*!
+ * @brief recv() that suspends the fiber instead of blocking the thread.
+ *
+ * @return As recv()
+ */
+ssize_t
+fiber_recv(int fd, void * p_buf, size_t len, int flags);
+
+/*!
+ * @brief send() that suspends the fiber instead of blocking the thread.
+ *
+ * Signals for broken connections are suppressed (MSG_NOSIGNAL).
+ *
+ * @return As send()
+ */
+ssize_t
+fiber_send(int fd, const void * p_buf, size_t len, int flags);
+
+/*!
+ * @brief accept() that suspends the fiber instead of blocking the thread.
+ *
+ * The listening socket is switched to non-blocking mode.
+ *
+ * @return As accept()
+ */
+int
+fiber_accept(int fd, struct sockaddr * p_addr, socklen_t * p_addr_len);
+
+#endif /* FIBER_H */
+
+/*** end of file ***/
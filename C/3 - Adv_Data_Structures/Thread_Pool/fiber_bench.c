@@ -0,0 +1,408 @@
+/** @file fiber_bench.c
+ *
+ * @brief Concurrent slow sessions served by pool jobs and by fibers.
+ *
+ * A child process opens many loopback TCP connections to the benchmark.
+ * Every session is ROUNDS exchanges: the server sends "PING" and the
+ * client answers "PONG" after thinking for delay_ms. The server side of a
+ * session is one function written in blocking style with fiber_send and
+ * fiber_recv, run two ways with the same number of threads:
+ *
+ * - as an ordinary pool job, so each session holds a thread while it
+ *   waits for the client and at most num_threads sessions make progress;
+ * - as a fiber, so a waiting session only holds its stack.
+ *
+ * Pool jobs are measured on a smaller number of clients, since they take
+ * clients / num_threads session times to finish.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L fiber_bench.c fiber.c
+ *        thread_pool.c queue.c ../Timer_Wheel/timer_wheel.c -pthread
+ *
+ * Usage: fiber_bench [clients] [threads] [delay_ms]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "fiber.h"
+#include "thread_pool.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_CLIENTS  (10000u)
+#define DEFAULT_THREADS  (4)
+#define DEFAULT_DELAY_MS (20u)
+#define ROUNDS           (3u)
+#define POOL_CLIENTS     (50u)  /* Per thread, for the pool job run */
+#define EVENT_BATCH      (64)
+#define SPARE_FDS        (64u)
+
+#define NSEC_PER_MSEC    (1000000ull)
+#define NSEC_PER_SEC     (1000000000ull)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Server side of one run */
+typedef struct
+{
+    int             listen_fd;
+    uint32_t        clients;
+    fiber_sched_t * p_sched;   /* Fiber run only */
+    uint64_t        active;    /* Sessions in progress */
+    uint64_t        peak;      /* Most sessions in progress at once */
+    uint64_t        completed; /* Sessions that finished every round */
+} server_t;
+
+/* Pending client answer */
+typedef struct
+{
+    uint64_t due_ns;
+    int      fd;
+} reply_t;
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static server_t g_server;
+
+/*************************************************************************
+ * Static Functions
+ *************************************************************************/
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+/*!
+ * @brief Server side of one session, in blocking style.
+ *
+ * @param[in] p_arg Accepted socket, as an intptr_t
+ */
+static void
+session(void * p_arg)
+{
+    int      fd     = (int)(intptr_t)p_arg;
+    uint64_t active = __atomic_add_fetch(&g_server.active, 1, __ATOMIC_RELAXED);
+    uint64_t peak   = __atomic_load_n(&g_server.peak, __ATOMIC_RELAXED);
+    uint32_t rounds = 0;
+
+    while ((active > peak)
+           && !__atomic_compare_exchange_n(&g_server.peak, &peak, active,
+                                           false, __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED))
+    {
+    }
+
+    for (; rounds < ROUNDS; rounds++)
+    {
+        char    reply[8];
+        ssize_t got = 0;
+        ssize_t part = 1;
+
+        if (5 != fiber_send(fd, "PING\n", 5, 0))
+        {
+            break;
+        }
+        // The answer is exactly "PONG\n", possibly split
+        while ((got < 5) && (part > 0))
+        {
+            part = fiber_recv(fd, reply + got, (size_t)(5 - got), 0);
+            got += (part > 0) ? part : 0;
+        }
+        if (got < 5)
+        {
+            break;
+        }
+    }
+
+    close(fd);
+    __atomic_sub_fetch(&g_server.active, 1, __ATOMIC_RELAXED);
+    if (ROUNDS == rounds)
+    {
+        __atomic_add_fetch(&g_server.completed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void *
+session_job(void * p_arg)
+{
+    session(p_arg);
+    return NULL;
+}
+
+/*!
+ * @brief Fiber that accepts every client and starts a session fiber each.
+ *
+ * @param[in] p_arg Unused
+ */
+static void
+acceptor(void * p_arg)
+{
+    (void)p_arg;
+
+    for (uint32_t idx = 0; idx < g_server.clients; idx++)
+    {
+        int fd = fiber_accept(g_server.listen_fd, NULL, NULL);
+        if ((fd < 0)
+            || (FIBER_SUCCESS
+                != fiber_spawn(g_server.p_sched, session,
+                               (void *)(intptr_t)fd)))
+        {
+            fprintf(stderr, "accept/spawn failed: %s\n", strerror(errno));
+            return;
+        }
+    }
+}
+
+/*!
+ * @brief Child process: connects every client and answers each PING after
+ *        delay_ms, until the server closes every connection.
+ *
+ * @return Process exit status
+ */
+static int
+run_clients(uint16_t port, uint32_t clients, uint32_t delay_ms)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET,
+                                .sin_port   = htons(port) };
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+
+    int       epoll_fd  = epoll_create1(0);
+    reply_t * p_pending = calloc(clients, sizeof(reply_t));
+    uint32_t  head      = 0;
+    uint32_t  count     = 0;
+    uint32_t  closed    = 0;
+
+    if ((epoll_fd < 0) || (NULL == p_pending))
+    {
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t idx = 0; idx < clients; idx++)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        if ((fd < 0)
+            || ((0 != connect(fd, (struct sockaddr *)&addr, sizeof(addr)))
+                && (EINPROGRESS != errno)))
+        {
+            return EXIT_FAILURE;
+        }
+
+        struct epoll_event event = { .events = EPOLLIN, .data.fd = fd };
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    while (closed < clients)
+    {
+        // Answers are due in arrival order, since the delay is fixed
+        uint64_t now     = now_ns();
+        int      timeout = -1;
+        while (count > 0)
+        {
+            reply_t * p_reply = &p_pending[head];
+            if (p_reply->due_ns > now)
+            {
+                timeout = (int)(((p_reply->due_ns - now) + NSEC_PER_MSEC - 1)
+                                / NSEC_PER_MSEC);
+                break;
+            }
+            send(p_reply->fd, "PONG\n", 5, MSG_NOSIGNAL);
+            head = (head + 1) % clients;
+            count--;
+        }
+
+        struct epoll_event events[EVENT_BATCH];
+        int ready = epoll_wait(epoll_fd, events, EVENT_BATCH, timeout);
+
+        for (int idx = 0; idx < ready; idx++)
+        {
+            int     fd = events[idx].data.fd;
+            char    buf[64];
+            ssize_t got = recv(fd, buf, sizeof(buf), 0);
+
+            if (got <= 0)
+            {
+                close(fd);
+                closed++;
+                continue;
+            }
+
+            for (ssize_t pos = 0; pos < got; pos++)
+            {
+                if (('\n' == buf[pos]) && (count < clients))
+                {
+                    uint32_t tail = (head + count) % clients;
+                    p_pending[tail].due_ns
+                        = now_ns() + ((uint64_t)delay_ms * NSEC_PER_MSEC);
+                    p_pending[tail].fd = fd;
+                    count++;
+                }
+            }
+        }
+    }
+
+    free(p_pending);
+    close(epoll_fd);
+    return EXIT_SUCCESS;
+}
+
+/*!
+ * @brief Serves clients sessions one way and prints a result row.
+ *
+ * @return true if every session completed
+ */
+static bool
+run_one(bool b_fibers, uint32_t clients, int threads, uint32_t delay_ms)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = 0 };
+    socklen_t          len  = sizeof(addr);
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+
+    memset(&g_server, 0, sizeof(g_server));
+    g_server.clients   = clients;
+    g_server.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if ((g_server.listen_fd < 0)
+        || (0 != bind(g_server.listen_fd, (struct sockaddr *)&addr,
+                      sizeof(addr)))
+        || (0 != listen(g_server.listen_fd, SOMAXCONN))
+        || (0 != getsockname(g_server.listen_fd, (struct sockaddr *)&addr,
+                             &len)))
+    {
+        perror("listen");
+        return false;
+    }
+
+    // Fork before any thread exists
+    pid_t child = fork();
+    if (0 == child)
+    {
+        close(g_server.listen_fd);
+        _exit(run_clients(ntohs(addr.sin_port), clients, delay_ms));
+    }
+
+    uint64_t start = now_ns();
+
+    if (b_fibers)
+    {
+        g_server.p_sched = fiber_sched_create(threads, 0);
+        if ((NULL == g_server.p_sched)
+            || (FIBER_SUCCESS
+                != fiber_spawn(g_server.p_sched, acceptor, NULL)))
+        {
+            return false;
+        }
+        fiber_sched_destroy(&g_server.p_sched);
+    }
+    else
+    {
+        thread_pool_config_t config = thread_pool_config_default(threads);
+        config.queue_capacity       = 0;
+        thread_pool_t * p_pool      = thread_pool_initialize_ex(&config);
+
+        for (uint32_t idx = 0; (NULL != p_pool) && (idx < clients); idx++)
+        {
+            int          fd  = accept(g_server.listen_fd, NULL, NULL);
+            thread_job_t job = { .job_fn = session_job,
+                                 .p_arg  = (void *)(intptr_t)fd };
+            if ((fd < 0) || (THREAD_POOL_SUCCESS
+                             != thread_pool_submit(p_pool, &job)))
+            {
+                break;
+            }
+        }
+
+        thread_pool_shutdown(p_pool);
+        thread_pool_destroy(p_pool);
+    }
+
+    double secs   = (double)(now_ns() - start) / NSEC_PER_SEC;
+    int    status = 0;
+    waitpid(child, &status, 0);
+    close(g_server.listen_fd);
+
+    printf("  %-10s %8u %8.2f %12.0f %10llu\n",
+           b_fibers ? "fibers" : "pool jobs",
+           clients,
+           secs,
+           (double)g_server.completed / secs,
+           (unsigned long long)g_server.peak);
+
+    return (clients == g_server.completed) && WIFEXITED(status)
+           && (EXIT_SUCCESS == WEXITSTATUS(status));
+}
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t clients
+        = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_CLIENTS;
+    int      threads  = (argc > 2) ? atoi(argv[2]) : DEFAULT_THREADS;
+    uint32_t delay_ms = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 10)
+                                   : DEFAULT_DELAY_MS;
+
+    // Each process holds one descriptor per client
+    struct rlimit limit;
+    if (0 == getrlimit(RLIMIT_NOFILE, &limit))
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if ((clients + SPARE_FDS) > limit.rlim_cur)
+        {
+            clients = (uint32_t)(limit.rlim_cur - SPARE_FDS);
+        }
+    }
+
+    if ((0 == clients) || (threads <= 0))
+    {
+        fprintf(stderr, "usage: fiber_bench [clients] [threads] [delay_ms]\n");
+        return EXIT_FAILURE;
+    }
+
+    uint32_t pool_clients = (uint32_t)threads * POOL_CLIENTS;
+    pool_clients          = (pool_clients < clients) ? pool_clients : clients;
+
+    printf("%d threads, %u rounds of %u ms client think time per session\n\n",
+           threads,
+           ROUNDS,
+           delay_ms);
+    printf("  %-10s %8s %8s %12s %10s\n",
+           "mode",
+           "clients",
+           "seconds",
+           "sessions/s",
+           "peak");
+
+    bool b_ok = run_one(false, pool_clients, threads, delay_ms);
+    b_ok      = run_one(true, clients, threads, delay_ms) && b_ok;
+
+    return b_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*** end of file ***/
@@ -0,0 +1,414 @@
+#include <check.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "fiber.h"
+
+#define WORKERS      (4)
+#define FIBERS       (64)
+#define YIELDS       (100)
+#define RACERS       (32)
+#define IDLE_MS      (20)
+#define DEADLINE_MS  (30)
+#define LATE_MS      (1000)
+
+// What one fiber saw; checked on the main thread once the fibers are done
+typedef struct
+{
+    fiber_sched_t * p_sched;
+    int             fds[2];
+    int             yields;
+    bool            b_always_running;
+    int             wait_status;
+    int             wait_errno;
+    int             timeouts;
+    int             returns;
+    uint64_t        elapsed_ms;
+    char            byte;
+} record_t;
+
+static record_t g_records[FIBERS];
+
+static uint64_t
+now_ms(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000u) + ((uint64_t)now.tv_nsec / 1000000u);
+}
+
+static void
+sleep_ms(long ms)
+{
+    struct timespec delay = { .tv_sec  = ms / 1000,
+                              .tv_nsec = (ms % 1000) * 1000000L };
+
+    (void)nanosleep(&delay, NULL);
+}
+
+static void
+records_setup(void)
+{
+    for (int idx = 0; idx < FIBERS; idx++)
+    {
+        g_records[idx]        = (record_t) { 0 };
+        g_records[idx].fds[0] = -1;
+        g_records[idx].fds[1] = -1;
+    }
+}
+
+static void
+records_teardown(void)
+{
+    for (int idx = 0; idx < FIBERS; idx++)
+    {
+        for (int end = 0; end < 2; end++)
+        {
+            if (g_records[idx].fds[end] >= 0)
+            {
+                close(g_records[idx].fds[end]);
+            }
+        }
+    }
+}
+
+static void
+open_pair(record_t * p_record)
+{
+    ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, p_record->fds), 0);
+}
+
+// Yields repeatedly; every resume must still see itself as a fiber
+static void
+yielder(void * p_arg)
+{
+    record_t * p_record = p_arg;
+
+    p_record->b_always_running = true;
+
+    for (int idx = 0; idx < YIELDS; idx++)
+    {
+        fiber_yield();
+        p_record->yields++;
+        p_record->b_always_running &= fiber_is_running();
+    }
+}
+
+// Spawns the rest of the yielders from inside a fiber
+static void
+spawner(void * p_arg)
+{
+    record_t * p_record = p_arg;
+
+    for (int idx = 1; idx < FIBERS; idx++)
+    {
+        p_record->wait_status
+            |= fiber_spawn(p_record->p_sched, yielder, &g_records[idx]);
+    }
+
+    yielder(p_arg);
+}
+
+START_TEST(test_spawn_yield_wait_completes)
+{
+    fiber_sched_t * p_sched = fiber_sched_create(WORKERS, 0);
+    ck_assert_ptr_nonnull(p_sched);
+
+    g_records[0].p_sched = p_sched;
+    ck_assert_int_eq(fiber_spawn(p_sched, spawner, &g_records[0]),
+                     FIBER_SUCCESS);
+
+    fiber_sched_wait(p_sched);
+    ck_assert_int_eq(fiber_sched_live(p_sched), 0);
+    ck_assert_int_eq(g_records[0].wait_status, FIBER_SUCCESS);
+
+    for (int idx = 0; idx < FIBERS; idx++)
+    {
+        ck_assert_int_eq(g_records[idx].yields, YIELDS);
+        ck_assert(g_records[idx].b_always_running);
+    }
+
+    // Outside a fiber the calls fall back to the thread
+    ck_assert(!fiber_is_running());
+    fiber_yield();
+    ck_assert_int_eq(fiber_set_idle_timeout(IDLE_MS), FIBER_ERROR_PARAM);
+    ck_assert_int_eq(fiber_set_deadline(IDLE_MS), FIBER_ERROR_PARAM);
+
+    fiber_sched_destroy(&p_sched);
+    ck_assert_ptr_null(p_sched);
+}
+END_TEST
+
+// Waits for the peer's byte, then reads it
+static void
+reader(void * p_arg)
+{
+    record_t * p_record = p_arg;
+
+    p_record->wait_status = fiber_wait_fd(p_record->fds[0], FIBER_WAIT_READ);
+    p_record->wait_errno  = errno;
+    p_record->returns
+        = (int)fiber_recv(p_record->fds[0], &p_record->byte, 1, 0);
+}
+
+static void
+writer(void * p_arg)
+{
+    record_t * p_record = p_arg;
+    char       byte     = 'x';
+
+    p_record->returns = (int)fiber_send(p_record->fds[1], &byte, 1, 0);
+}
+
+START_TEST(test_wait_fd_wakes_on_readiness)
+{
+    // One worker: the writer only runs if the waiting reader gave it up
+    fiber_sched_t * p_sched = fiber_sched_create(1, 0);
+    ck_assert_ptr_nonnull(p_sched);
+
+    open_pair(&g_records[0]);
+    g_records[1].fds[1] = g_records[0].fds[1];
+    g_records[0].fds[1] = -1;
+
+    ck_assert_int_eq(fiber_spawn(p_sched, reader, &g_records[0]),
+                     FIBER_SUCCESS);
+    ck_assert_int_eq(fiber_spawn(p_sched, writer, &g_records[1]),
+                     FIBER_SUCCESS);
+
+    fiber_sched_wait(p_sched);
+    ck_assert_int_eq(g_records[0].wait_status, 0);
+    ck_assert_int_eq(g_records[0].returns, 1);
+    ck_assert_int_eq(g_records[0].byte, 'x');
+    ck_assert_int_eq(g_records[1].returns, 1);
+
+    fiber_sched_destroy(&p_sched);
+}
+END_TEST
+
+// Waits on a silent socket under an idle timeout, then without one
+static void
+idle_waiter(void * p_arg)
+{
+    record_t * p_record = p_arg;
+    uint64_t   start    = now_ms();
+
+    (void)fiber_set_idle_timeout(IDLE_MS);
+    p_record->wait_status = fiber_wait_fd(p_record->fds[0], FIBER_WAIT_READ);
+    p_record->wait_errno  = errno;
+    p_record->elapsed_ms  = now_ms() - start;
+    p_record->timeouts += (ETIMEDOUT == p_record->wait_errno) ? 1 : 0;
+    p_record->returns++;
+
+    // The timed-out wait must not resume this fiber a second time
+    (void)fiber_set_idle_timeout(FIBER_NO_TIMEOUT);
+    if (0 == fiber_wait_fd(p_record->fds[0], FIBER_WAIT_READ))
+    {
+        p_record->returns++;
+    }
+}
+
+START_TEST(test_idle_timeout_fires_once)
+{
+    fiber_sched_t * p_sched = fiber_sched_create(WORKERS, 0);
+    ck_assert_ptr_nonnull(p_sched);
+
+    open_pair(&g_records[0]);
+    ck_assert_int_eq(fiber_spawn(p_sched, idle_waiter, &g_records[0]),
+                     FIBER_SUCCESS);
+
+    sleep_ms(IDLE_MS * 5);
+    ck_assert_int_eq(g_records[0].returns, 1);
+    ck_assert_int_eq(g_records[0].wait_status, -1);
+    ck_assert_int_eq(g_records[0].wait_errno, ETIMEDOUT);
+    ck_assert_uint_ge(g_records[0].elapsed_ms, IDLE_MS);
+    ck_assert_uint_lt(g_records[0].elapsed_ms, LATE_MS);
+
+    ck_assert_int_eq(write(g_records[0].fds[1], "x", 1), 1);
+    fiber_sched_wait(p_sched);
+    ck_assert_int_eq(g_records[0].timeouts, 1);
+    ck_assert_int_eq(g_records[0].returns, 2);
+
+    fiber_sched_destroy(&p_sched);
+}
+END_TEST
+
+// A deadline ends the first wait past it and fails later ones at once
+static void
+deadline_waiter(void * p_arg)
+{
+    record_t * p_record = p_arg;
+    uint64_t   start    = now_ms();
+
+    (void)fiber_set_idle_timeout(LATE_MS);
+    (void)fiber_set_deadline(DEADLINE_MS);
+
+    for (int idx = 0; idx < 2; idx++)
+    {
+        if ((0 != fiber_wait_fd(p_record->fds[0], FIBER_WAIT_READ))
+            && (ETIMEDOUT == errno))
+        {
+            p_record->timeouts++;
+        }
+        p_record->returns++;
+        if (0 == idx)
+        {
+            p_record->elapsed_ms = now_ms() - start;
+        }
+    }
+
+    // Cleared, the deadline no longer applies
+    (void)fiber_set_deadline(FIBER_NO_TIMEOUT);
+    (void)fiber_send(p_record->fds[1], "x", 1, 0);
+    p_record->wait_status = fiber_wait_fd(p_record->fds[0], FIBER_WAIT_READ);
+}
+
+START_TEST(test_deadline_fires_once_per_wait)
+{
+    fiber_sched_t * p_sched = fiber_sched_create(WORKERS, 0);
+    ck_assert_ptr_nonnull(p_sched);
+
+    open_pair(&g_records[0]);
+    ck_assert_int_eq(fiber_spawn(p_sched, deadline_waiter, &g_records[0]),
+                     FIBER_SUCCESS);
+
+    fiber_sched_wait(p_sched);
+    ck_assert_int_eq(g_records[0].returns, 2);
+    ck_assert_int_eq(g_records[0].timeouts, 2);
+    ck_assert_uint_ge(g_records[0].elapsed_ms, DEADLINE_MS);
+    ck_assert_uint_lt(g_records[0].elapsed_ms, LATE_MS);
+    ck_assert_int_eq(g_records[0].wait_status, 0);
+
+    fiber_sched_destroy(&p_sched);
+}
+END_TEST
+
+// One timed wait that readiness and the timer race to end
+static void
+racer(void * p_arg)
+{
+    record_t * p_record = p_arg;
+
+    (void)fiber_set_idle_timeout(IDLE_MS);
+    p_record->wait_status = fiber_wait_fd(p_record->fds[0], FIBER_WAIT_READ);
+    p_record->timeouts += (0 != p_record->wait_status) ? 1 : 0;
+    p_record->returns++;
+
+    // A second resume from the loser would run this fiber twice
+    fiber_yield();
+}
+
+START_TEST(test_timeout_racing_readiness_resumes_once)
+{
+    fiber_sched_t * p_sched = fiber_sched_create(WORKERS, 0);
+    ck_assert_ptr_nonnull(p_sched);
+
+    for (int idx = 0; idx < RACERS; idx++)
+    {
+        open_pair(&g_records[idx]);
+        ck_assert_int_eq(fiber_spawn(p_sched, racer, &g_records[idx]),
+                         FIBER_SUCCESS);
+    }
+
+    // Writes land on both sides of the timeout
+    sleep_ms(IDLE_MS - 2);
+    for (int idx = 0; idx < RACERS; idx++)
+    {
+        ck_assert_int_eq(write(g_records[idx].fds[1], "x", 1), 1);
+        if (0 == (idx % 8))
+        {
+            sleep_ms(1);
+        }
+    }
+
+    fiber_sched_wait(p_sched);
+
+    for (int idx = 0; idx < RACERS; idx++)
+    {
+        ck_assert_int_eq(g_records[idx].returns, 1);
+        ck_assert_int_le(g_records[idx].timeouts, 1);
+    }
+
+    fiber_sched_destroy(&p_sched);
+}
+END_TEST
+
+static void
+noop(void * p_arg)
+{
+    (void)p_arg;
+}
+
+START_TEST(test_spawn_after_shutdown_fails)
+{
+    fiber_sched_t * p_sched = fiber_sched_create(WORKERS, 0);
+    ck_assert_ptr_nonnull(p_sched);
+
+    ck_assert_int_eq(fiber_spawn(NULL, noop, NULL), FIBER_ERROR_PARAM);
+    ck_assert_int_eq(fiber_spawn(p_sched, NULL, NULL), FIBER_ERROR_PARAM);
+    ck_assert_int_eq(fiber_spawn(p_sched, noop, NULL), FIBER_SUCCESS);
+
+    fiber_sched_shutdown(p_sched);
+    ck_assert_int_eq(fiber_sched_live(p_sched), 0);
+    ck_assert_int_eq(fiber_spawn(p_sched, noop, NULL), FIBER_ERROR_QUEUE);
+    ck_assert_int_eq(fiber_sched_live(p_sched), 0);
+
+    // A second shutdown, and destroy after it, are harmless
+    fiber_sched_shutdown(p_sched);
+    fiber_sched_destroy(&p_sched);
+    ck_assert_ptr_null(p_sched);
+    fiber_sched_destroy(&p_sched);
+
+    ck_assert_ptr_null(fiber_sched_create(0, 0));
+    ck_assert_ptr_null(fiber_sched_create(1, FIBER_MIN_STACK - 1));
+}
+END_TEST
+
+//
+// Define test suite and add test cases
+//
+Suite *
+fiber_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Fiber");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_checked_fixture(tc_core, records_setup, records_teardown);
+    tcase_add_test(tc_core, test_spawn_yield_wait_completes);
+    tcase_add_test(tc_core, test_wait_fd_wakes_on_readiness);
+    tcase_add_test(tc_core, test_idle_timeout_fires_once);
+    tcase_add_test(tc_core, test_deadline_fires_once_per_wait);
+    tcase_add_test(tc_core, test_timeout_racing_readiness_resumes_once);
+    tcase_add_test(tc_core, test_spawn_after_shutdown_fails);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = fiber_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -0,0 +1,891 @@
+/** @file image_stream.c
+ *
+ * @brief Implementation of the streaming bartender reply processor.
+ *
+ * Only the first bytes of each line (at most "IMAGE ") are ever copied, to
+ * tell the line kinds apart when they arrive split over reads; the rest of
+ * the line is handled in place in the ring. Decoded bytes and the
+ * newline after them go into the output buffer, prefixes and suffixes are
+ * referenced where they are, and consecutive decoded pieces share one
+ * iovec.
+ *
+ * A stream with a line decoder cannot decode piece by piece, since the
+ * decoder may need the whole line: image lines are gathered in a line
+ * buffer, header included, and decoded at their newline. Only then are
+ * the prefix, the decoded line and the suffix queued, so a line the
+ * decoder rejects leaves nothing behind in the output.
+ *
+ * The AVX2 decoder looks up 32 bytes at a time: the low nibble of each
+ * byte indexes a 16-byte row of the table with vpshufb, and the high
+ * nibble selects which row lookup is kept. Rows where the table is the
+ * identity are skipped, so a dictionary of printable characters costs six
+ * lookups per vector rather than sixteen.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include "image_stream.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define IMAGE_HEADER     "IMAGE "
+#define IMAGE_HEADER_LEN (sizeof(IMAGE_HEADER) - 1)
+#define END_HEADER       "END"
+#define END_HEADER_LEN   (sizeof(END_HEADER) - 1)
+#define RING_MASK        (IMAGE_STREAM_RING_SIZE - 1u)
+#define TABLE_ROWS       (16u)
+#define ROW_BYTES        (16u)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* What the rest of the current line is */
+typedef enum
+{
+    LINE_START = 0, /* Collecting the header */
+    LINE_IMAGE,     /* Image payload, decoded as it arrives */
+    LINE_END,       /* "END" line, reply complete at the newline */
+    LINE_SKIP       /* Anything else, discarded */
+} line_state_t;
+
+struct image_stream
+{
+    uint8_t      table[256];               /* Decode table */
+    image_stream_decoder_t decode_fn;      /* Line decoder, or NULL */
+    const char * p_dictionary;             /* Passed to decode_fn */
+    char *       p_line;                   /* Image line being gathered */
+    char *       p_decoded;                /* decode_fn output */
+    size_t       line_len;
+    size_t       line_cap;                 /* Size of p_line and p_decoded */
+    uint64_t     failures;                 /* Lines decode_fn rejected */
+    const char * p_prefix;                 /* Caller's line before images */
+    const char * p_suffix;                 /* Caller's line after images */
+    int          output_fd;
+    line_state_t state;
+    char         header[IMAGE_HEADER_LEN]; /* Start of the current line */
+    size_t       header_len;
+    bool         b_trim_newline;           /* "END" ended at a read edge */
+    size_t       ring_head;                /* Next byte to process */
+    size_t       ring_tail;                /* Next byte to fill */
+    uint8_t *    p_ring;
+    size_t       out_len;                  /* Bytes used in p_out */
+    bool         b_open;                   /* Last iovec ends at out_len */
+    size_t       iov_count;
+    struct iovec iov[IMAGE_STREAM_MAX_IOV];
+    uint8_t *    p_out;
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static int  process(image_stream_t * p_stream,
+                    const uint8_t *  p_data,
+                    size_t           len,
+                    bool             b_last,
+                    size_t *         p_used);
+static int  start_line(image_stream_t * p_stream,
+                       const uint8_t *  p_data,
+                       size_t           len,
+                       bool             b_last,
+                       size_t *         p_used);
+static int  push_iov(image_stream_t * p_stream, const void * p_base,
+                     size_t len);
+static int  push_output(image_stream_t * p_stream,
+                        const uint8_t *  p_data,
+                        size_t           len,
+                        bool             b_decode);
+static int  begin_image(image_stream_t * p_stream);
+static image_stream_t * create_stream(int output_fd);
+static int  append_line(image_stream_t * p_stream,
+                        const uint8_t *  p_data,
+                        size_t           len);
+static int  decode_line(image_stream_t * p_stream);
+static bool set_lines(image_stream_t * p_stream,
+                      const char *     p_prefix,
+                      const char *     p_suffix);
+static int  end_image(image_stream_t * p_stream);
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static const char g_newline[] = "\n";
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Decodes bytes through a table.
+ *
+ * @param[in]  p_table 256-entry table
+ * @param[in]  p_src   Encoded bytes
+ * @param[out] p_dst   Decoded bytes (may equal p_src)
+ * @param[in]  len     Number of bytes
+ */
+void
+image_stream_decode(const uint8_t p_table[256],
+                    const uint8_t * p_src,
+                    uint8_t *       p_dst,
+                    size_t          len)
+{
+    size_t idx = 0;
+
+#ifdef __AVX2__
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i       rows[TABLE_ROWS];
+    uint8_t       hi_codes[TABLE_ROWS];
+    uint32_t      num_rows = 0;
+
+    // Rows that map every byte to itself need no lookup at all
+    for (uint32_t row = 0; (len >= 32) && (row < TABLE_ROWS); row++)
+    {
+        const uint8_t * p_row = p_table + (row * ROW_BYTES);
+        bool            b_id  = true;
+
+        for (uint32_t col = 0; b_id && (col < ROW_BYTES); col++)
+        {
+            b_id = (p_row[col] == (uint8_t)((row * ROW_BYTES) + col));
+        }
+
+        if (!b_id)
+        {
+            hi_codes[num_rows] = (uint8_t)row;
+            rows[num_rows++]   = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i *)p_row));
+        }
+    }
+
+    for (; (idx + 32) <= len; idx += 32)
+    {
+        __m256i in  = _mm256_loadu_si256((const __m256i *)(p_src + idx));
+        __m256i lo  = _mm256_and_si256(in, low);
+        __m256i hi  = _mm256_and_si256(_mm256_srli_epi16(in, 4), low);
+        __m256i out = in;
+
+        for (uint32_t row = 0; row < num_rows; row++)
+        {
+            __m256i hit = _mm256_cmpeq_epi8(
+                hi, _mm256_set1_epi8((char)hi_codes[row]));
+            out = _mm256_blendv_epi8(
+                out, _mm256_shuffle_epi8(rows[row], lo), hit);
+        }
+
+        _mm256_storeu_si256((__m256i *)(p_dst + idx), out);
+    }
+#endif
+
+    for (; idx < len; idx++)
+    {
+        p_dst[idx] = p_table[p_src[idx]];
+    }
+}
+
+/*!
+ * @brief Creates a stream that decodes through a substitution table and
+ *        writes images to output_fd.
+ *
+ * @param[in] p_table   256-entry decode table (copied)
+ * @param[in] output_fd Descriptor the images are written to
+ *
+ * @return Pointer to the stream, or NULL on failure
+ */
+image_stream_t *
+image_stream_create(const uint8_t p_table[256], int output_fd)
+{
+    if (NULL == p_table)
+    {
+        return NULL;
+    }
+
+    image_stream_t * p_stream = create_stream(output_fd);
+    if (NULL != p_stream)
+    {
+        memcpy(p_stream->table, p_table, sizeof(p_stream->table));
+    }
+
+    return p_stream;
+}
+
+/*!
+ * @brief Creates a stream that decodes each image line with the caller's
+ *        decoder and writes images to output_fd.
+ *
+ * @param[in] decode_fn    Line decoder, e.g. decode_server_message()
+ * @param[in] p_dictionary Passed to decode_fn; must outlive the stream
+ * @param[in] output_fd    Descriptor the images are written to
+ *
+ * @return Pointer to the stream, or NULL on failure
+ */
+image_stream_t *
+image_stream_create_decoder(image_stream_decoder_t decode_fn,
+                            const char *           p_dictionary,
+                            int                    output_fd)
+{
+    if (NULL == decode_fn)
+    {
+        return NULL;
+    }
+
+    image_stream_t * p_stream = create_stream(output_fd);
+    if (NULL == p_stream)
+    {
+        return NULL;
+    }
+
+    p_stream->decode_fn    = decode_fn;
+    p_stream->p_dictionary = p_dictionary;
+    p_stream->line_cap     = IMAGE_STREAM_LINE_SIZE;
+    p_stream->p_line       = malloc(p_stream->line_cap);
+    p_stream->p_decoded    = malloc(p_stream->line_cap);
+    if ((NULL == p_stream->p_line) || (NULL == p_stream->p_decoded))
+    {
+        image_stream_destroy(&p_stream);
+    }
+
+    return p_stream;
+}
+
+/*!
+ * @brief Number of image lines the stream's decoder has rejected.
+ *
+ * @param[in] p_stream Stream
+ *
+ * @return Failures since the stream was created, 0 if p_stream is NULL
+ */
+uint64_t
+image_stream_decode_failures(const image_stream_t * p_stream)
+{
+    return (NULL == p_stream) ? 0 : p_stream->failures;
+}
+
+/*!
+ * @brief Reads from a socket once, if no input is buffered, and processes
+ *        everything buffered up to the next "END" line.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     input_fd Socket or other readable descriptor
+ * @param[in]     p_prefix Line written before every image
+ * @param[in]     p_suffix Line written after every image
+ *
+ * @return IMAGE_STREAM_END, IMAGE_STREAM_SUCCESS if more input is needed,
+ *         or a negative error code
+ */
+int
+image_stream_read(image_stream_t * p_stream,
+                  int              input_fd,
+                  const char *     p_prefix,
+                  const char *     p_suffix)
+{
+    if ((input_fd < 0) || !set_lines(p_stream, p_prefix, p_suffix))
+    {
+        return IMAGE_STREAM_ERROR_PARAM;
+    }
+
+    if (p_stream->ring_head == p_stream->ring_tail)
+    {
+        // The ring is empty, so both free segments start at the tail
+        size_t       start = p_stream->ring_tail & RING_MASK;
+        struct iovec free_space[2] = {
+            { .iov_base = p_stream->p_ring + start,
+              .iov_len  = IMAGE_STREAM_RING_SIZE - start },
+            { .iov_base = p_stream->p_ring, .iov_len = start },
+        };
+
+        ssize_t got = readv(input_fd, free_space, (0 == start) ? 1 : 2);
+        if (0 == got)
+        {
+            return IMAGE_STREAM_ERROR_CLOSED;
+        }
+        if (got < 0)
+        {
+            return (EINTR == errno) ? IMAGE_STREAM_SUCCESS
+                                    : IMAGE_STREAM_ERROR_IO;
+        }
+        p_stream->ring_tail += (size_t)got;
+    }
+
+    while (p_stream->ring_head != p_stream->ring_tail)
+    {
+        size_t start   = p_stream->ring_head & RING_MASK;
+        size_t pending = p_stream->ring_tail - p_stream->ring_head;
+        size_t len     = IMAGE_STREAM_RING_SIZE - start;
+        size_t used    = 0;
+
+        len        = (pending < len) ? pending : len;
+        int status = process(p_stream,
+                             p_stream->p_ring + start,
+                             len,
+                             (len == pending),
+                             &used);
+        p_stream->ring_head += used;
+
+        if (IMAGE_STREAM_SUCCESS != status)
+        {
+            return status;
+        }
+    }
+
+    return IMAGE_STREAM_SUCCESS;
+}
+
+/*!
+ * @brief Processes bytes that are already in memory.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_data   Reply bytes
+ * @param[in]     len      Number of bytes
+ * @param[in]     p_prefix Line written before every image
+ * @param[in]     p_suffix Line written after every image
+ * @param[out]    p_used   Bytes consumed; less than len only after "END"
+ *
+ * @return IMAGE_STREAM_END, IMAGE_STREAM_SUCCESS, or a negative error code
+ */
+int
+image_stream_consume(image_stream_t * p_stream,
+                     const char *     p_data,
+                     size_t           len,
+                     const char *     p_prefix,
+                     const char *     p_suffix,
+                     size_t *         p_used)
+{
+    if (((NULL == p_data) && (len > 0)) || (NULL == p_used)
+        || !set_lines(p_stream, p_prefix, p_suffix))
+    {
+        return IMAGE_STREAM_ERROR_PARAM;
+    }
+
+    return process(p_stream, (const uint8_t *)p_data, len, true, p_used);
+}
+
+/*!
+ * @brief Writes everything queued so far.
+ *
+ * @param[in,out] p_stream Stream
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_IO
+ */
+int
+image_stream_flush(image_stream_t * p_stream)
+{
+    if (NULL == p_stream)
+    {
+        return IMAGE_STREAM_ERROR_PARAM;
+    }
+
+    struct iovec * p_iov  = p_stream->iov;
+    int            count  = (int)p_stream->iov_count;
+    int            status = IMAGE_STREAM_SUCCESS;
+
+    while (count > 0)
+    {
+        ssize_t written = writev(p_stream->output_fd, p_iov, count);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            status = IMAGE_STREAM_ERROR_IO;
+            break;
+        }
+
+        // Skip what was written and resume inside a partly written iovec
+        while ((count > 0) && ((size_t)written >= p_iov->iov_len))
+        {
+            written -= (ssize_t)p_iov->iov_len;
+            p_iov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            p_iov->iov_base  = (char *)p_iov->iov_base + written;
+            p_iov->iov_len  -= (size_t)written;
+        }
+    }
+
+    p_stream->iov_count = 0;
+    p_stream->out_len   = 0;
+    p_stream->b_open    = false;
+    return status;
+}
+
+/*!
+ * @brief Frees a stream without flushing it.
+ *
+ * @param[in,out] pp_stream Pointer to the stream pointer; set to NULL
+ */
+void
+image_stream_destroy(image_stream_t ** pp_stream)
+{
+    if ((NULL == pp_stream) || (NULL == *pp_stream))
+    {
+        return;
+    }
+
+    free((*pp_stream)->p_ring);
+    free((*pp_stream)->p_out);
+    free((*pp_stream)->p_line);
+    free((*pp_stream)->p_decoded);
+    free(*pp_stream);
+    *pp_stream = NULL;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Runs the line state machine over one contiguous piece of input.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_data   Input bytes
+ * @param[in]     len      Number of bytes
+ * @param[in]     b_last   No more input is available after this piece
+ * @param[out]    p_used   Bytes consumed
+ *
+ * @return IMAGE_STREAM_END after an "END" line, IMAGE_STREAM_SUCCESS when
+ *         the piece is used up, or a negative error code
+ */
+static int
+process(image_stream_t * p_stream,
+        const uint8_t *  p_data,
+        size_t           len,
+        bool             b_last,
+        size_t *         p_used)
+{
+    size_t pos    = 0;
+    int    status = IMAGE_STREAM_SUCCESS;
+
+    while ((IMAGE_STREAM_SUCCESS == status) && (pos < len))
+    {
+        size_t          rest   = len - pos;
+        const uint8_t * p_rest = p_data + pos;
+
+        if (LINE_START == p_stream->state)
+        {
+            size_t used = 0;
+            status      = start_line(p_stream, p_rest, rest, b_last, &used);
+            pos        += used;
+            continue;
+        }
+
+        const uint8_t * p_newline = memchr(p_rest, '\n', rest);
+        size_t          body      = (NULL == p_newline)
+                                        ? rest
+                                        : (size_t)(p_newline - p_rest);
+
+        if ((LINE_IMAGE == p_stream->state) && (NULL != p_stream->decode_fn))
+        {
+            status = append_line(p_stream, p_rest, body);
+        }
+        else if (LINE_IMAGE == p_stream->state)
+        {
+            status = push_output(p_stream, p_rest, body, true);
+        }
+
+        pos += body;
+        if ((IMAGE_STREAM_SUCCESS != status) || (NULL == p_newline))
+        {
+            continue;
+        }
+
+        pos++;
+        if ((LINE_IMAGE == p_stream->state) && (NULL != p_stream->decode_fn))
+        {
+            status = decode_line(p_stream);
+        }
+        else if (LINE_IMAGE == p_stream->state)
+        {
+            status = end_image(p_stream);
+        }
+        else if (LINE_END == p_stream->state)
+        {
+            status = IMAGE_STREAM_END;
+        }
+        p_stream->state = LINE_START;
+    }
+
+    *p_used = pos;
+
+    if (IMAGE_STREAM_END == status)
+    {
+        int flushed = image_stream_flush(p_stream);
+        status      = (IMAGE_STREAM_SUCCESS == flushed) ? status : flushed;
+    }
+
+    return status;
+}
+
+/*!
+ * @brief Collects the first bytes of a line until its kind is known.
+ *
+ * A line that is exactly "END" also completes the reply when it ends at
+ * the edge of the available input without a newline, since the server
+ * may send it as a bare message; a newline that follows later is dropped.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_data   Input bytes
+ * @param[in]     len      Number of bytes (> 0)
+ * @param[in]     b_last   No more input is available after this piece
+ * @param[out]    p_used   Bytes consumed
+ *
+ * @return IMAGE_STREAM_END, IMAGE_STREAM_SUCCESS, or a negative error code
+ */
+static int
+start_line(image_stream_t * p_stream,
+           const uint8_t *  p_data,
+           size_t           len,
+           bool             b_last,
+           size_t *         p_used)
+{
+    size_t pos = 0;
+
+    if (p_stream->b_trim_newline && (0 == p_stream->header_len))
+    {
+        while ((pos < len) && ('\r' == p_data[pos]))
+        {
+            pos++;
+        }
+        if ((pos < len) && ('\n' == p_data[pos]))
+        {
+            pos++;
+        }
+        p_stream->b_trim_newline = (pos == len);
+    }
+
+    while ((pos < len) && (p_stream->header_len < IMAGE_HEADER_LEN))
+    {
+        uint8_t byte = p_data[pos++];
+
+        if ('\n' == byte)
+        {
+            bool b_end = (p_stream->header_len >= END_HEADER_LEN)
+                         && (0 == memcmp(p_stream->header, END_HEADER,
+                                         END_HEADER_LEN));
+            p_stream->header_len = 0;
+            *p_used              = pos;
+            return b_end ? IMAGE_STREAM_END : IMAGE_STREAM_SUCCESS;
+        }
+
+        p_stream->header[p_stream->header_len++] = (char)byte;
+
+        if ((END_HEADER_LEN == p_stream->header_len)
+            && (0 == memcmp(p_stream->header, END_HEADER, END_HEADER_LEN)))
+        {
+            p_stream->header_len = 0;
+            if (b_last && (pos == len))
+            {
+                p_stream->b_trim_newline = true;
+                *p_used                  = pos;
+                return IMAGE_STREAM_END;
+            }
+            p_stream->state = LINE_END;
+            *p_used         = pos;
+            return IMAGE_STREAM_SUCCESS;
+        }
+    }
+
+    *p_used = pos;
+    if (p_stream->header_len < IMAGE_HEADER_LEN)
+    {
+        return IMAGE_STREAM_SUCCESS;
+    }
+
+    p_stream->header_len = 0;
+    if (0 != memcmp(p_stream->header, IMAGE_HEADER, IMAGE_HEADER_LEN))
+    {
+        p_stream->state = LINE_SKIP;
+        return IMAGE_STREAM_SUCCESS;
+    }
+
+    p_stream->state = LINE_IMAGE;
+
+    // A whole line goes to the decoder, header and all
+    if (NULL != p_stream->decode_fn)
+    {
+        p_stream->line_len = 0;
+        return append_line(p_stream, (const uint8_t *)IMAGE_HEADER,
+                           IMAGE_HEADER_LEN);
+    }
+
+    return begin_image(p_stream);
+}
+
+/*!
+ * @brief Appends an iovec, writing out the queue first if it is full.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_base   Bytes to write
+ * @param[in]     len      Number of bytes
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_IO
+ */
+static int
+push_iov(image_stream_t * p_stream, const void * p_base, size_t len)
+{
+    if (IMAGE_STREAM_MAX_IOV == p_stream->iov_count)
+    {
+        int status = image_stream_flush(p_stream);
+        if (IMAGE_STREAM_SUCCESS != status)
+        {
+            return status;
+        }
+    }
+
+    p_stream->iov[p_stream->iov_count].iov_base = (void *)p_base;
+    p_stream->iov[p_stream->iov_count].iov_len  = len;
+    p_stream->iov_count++;
+    p_stream->b_open = false;
+    return IMAGE_STREAM_SUCCESS;
+}
+
+/*!
+ * @brief Copies or decodes bytes into the output buffer, writing it out
+ *        whenever it fills up.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_data   Bytes to add
+ * @param[in]     len      Number of bytes
+ * @param[in]     b_decode Decode through the table instead of copying
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_IO
+ */
+static int
+push_output(image_stream_t * p_stream,
+            const uint8_t *  p_data,
+            size_t           len,
+            bool             b_decode)
+{
+    while (len > 0)
+    {
+        if ((IMAGE_STREAM_OUTPUT_SIZE == p_stream->out_len)
+            || (!p_stream->b_open
+                && (IMAGE_STREAM_MAX_IOV == p_stream->iov_count)))
+        {
+            int status = image_stream_flush(p_stream);
+            if (IMAGE_STREAM_SUCCESS != status)
+            {
+                return status;
+            }
+        }
+
+        size_t    room  = IMAGE_STREAM_OUTPUT_SIZE - p_stream->out_len;
+        size_t    piece = (len < room) ? len : room;
+        uint8_t * p_dst = p_stream->p_out + p_stream->out_len;
+
+        if (!p_stream->b_open)
+        {
+            // Cannot flush: the queue was just checked for room
+            push_iov(p_stream, p_dst, 0);
+            p_stream->b_open = true;
+        }
+
+        if (b_decode)
+        {
+            image_stream_decode(p_stream->table, p_data, p_dst, piece);
+        }
+        else
+        {
+            memcpy(p_dst, p_data, piece);
+        }
+
+        p_stream->iov[p_stream->iov_count - 1].iov_len += piece;
+        p_stream->out_len                              += piece;
+        p_data                                         += piece;
+        len                                            -= piece;
+    }
+
+    return IMAGE_STREAM_SUCCESS;
+}
+
+/*!
+ * @brief Allocates a stream with empty buffers.
+ *
+ * @param[in] output_fd Descriptor the images are written to
+ *
+ * @return Pointer to the stream, or NULL on failure
+ */
+static image_stream_t *
+create_stream(int output_fd)
+{
+    if (output_fd < 0)
+    {
+        return NULL;
+    }
+
+    image_stream_t * p_stream = calloc(1, sizeof(image_stream_t));
+    if (NULL == p_stream)
+    {
+        return NULL;
+    }
+
+    p_stream->p_ring = malloc(IMAGE_STREAM_RING_SIZE);
+    p_stream->p_out  = malloc(IMAGE_STREAM_OUTPUT_SIZE);
+    if ((NULL == p_stream->p_ring) || (NULL == p_stream->p_out))
+    {
+        image_stream_destroy(&p_stream);
+        return NULL;
+    }
+
+    p_stream->output_fd = output_fd;
+
+    return p_stream;
+}
+
+/*!
+ * @brief Adds bytes to the image line being gathered, doubling the line
+ *        and decoder buffers when they are full.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_data   Bytes to add
+ * @param[in]     len      Number of bytes
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_MEMORY
+ */
+static int
+append_line(image_stream_t * p_stream, const uint8_t * p_data, size_t len)
+{
+    // One byte is kept for the NUL the decoder expects
+    while (p_stream->line_len + len >= p_stream->line_cap)
+    {
+        size_t new_cap   = p_stream->line_cap * 2;
+        char * p_line    = realloc(p_stream->p_line, new_cap);
+        if (NULL == p_line)
+        {
+            return IMAGE_STREAM_ERROR_MEMORY;
+        }
+        p_stream->p_line = p_line;
+
+        char * p_decoded = realloc(p_stream->p_decoded, new_cap);
+        if (NULL == p_decoded)
+        {
+            return IMAGE_STREAM_ERROR_MEMORY;
+        }
+        p_stream->p_decoded = p_decoded;
+        p_stream->line_cap  = new_cap;
+    }
+
+    memcpy(p_stream->p_line + p_stream->line_len, p_data, len);
+    p_stream->line_len += len;
+    return IMAGE_STREAM_SUCCESS;
+}
+
+/*!
+ * @brief Decodes the gathered image line and queues it between its
+ *        prefix and suffix; a line the decoder rejects is only counted.
+ *
+ * @param[in,out] p_stream Stream
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_IO
+ */
+static int
+decode_line(image_stream_t * p_stream)
+{
+    p_stream->p_line[p_stream->line_len] = '\0';
+    memset(p_stream->p_decoded, 0, p_stream->line_cap);
+
+    if (0 != p_stream->decode_fn(p_stream->p_line, p_stream->p_dictionary,
+                                 p_stream->p_decoded, p_stream->line_cap))
+    {
+        p_stream->failures++;
+        return IMAGE_STREAM_SUCCESS;
+    }
+
+    // Terminated by the decoder, or at the latest by the last byte
+    p_stream->p_decoded[p_stream->line_cap - 1] = '\0';
+
+    int status = begin_image(p_stream);
+    if (IMAGE_STREAM_SUCCESS == status)
+    {
+        status = push_output(p_stream, (const uint8_t *)p_stream->p_decoded,
+                             strlen(p_stream->p_decoded), false);
+    }
+    if (IMAGE_STREAM_SUCCESS == status)
+    {
+        status = end_image(p_stream);
+    }
+    return status;
+}
+
+/*!
+ * @brief Queues the prefix line of an image.
+ *
+ * @param[in,out] p_stream Stream
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_IO
+ */
+static int
+begin_image(image_stream_t * p_stream)
+{
+    int status
+        = push_iov(p_stream, p_stream->p_prefix, strlen(p_stream->p_prefix));
+    if (IMAGE_STREAM_SUCCESS == status)
+    {
+        status = push_iov(p_stream, g_newline, 1);
+    }
+    return status;
+}
+
+/*!
+ * @brief Ends the decoded line and queues the suffix line of an image.
+ *
+ * @param[in,out] p_stream Stream
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_IO
+ */
+static int
+end_image(image_stream_t * p_stream)
+{
+    int status = push_output(p_stream, (const uint8_t *)g_newline, 1, false);
+    if (IMAGE_STREAM_SUCCESS == status)
+    {
+        status = push_iov(p_stream,
+                          p_stream->p_suffix,
+                          strlen(p_stream->p_suffix));
+    }
+    if (IMAGE_STREAM_SUCCESS == status)
+    {
+        status = push_iov(p_stream, g_newline, 1);
+    }
+    return status;
+}
+
+/*!
+ * @brief Records the lines to write around images for the current call.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_prefix Line written before every image
+ * @param[in]     p_suffix Line written after every image
+ *
+ * @return false if any pointer is NULL
+ */
+static bool
+set_lines(image_stream_t * p_stream, const char * p_prefix,
+          const char * p_suffix)
+{
+    if ((NULL == p_stream) || (NULL == p_prefix) || (NULL == p_suffix))
+    {
+        return false;
+    }
+
+    p_stream->p_prefix = p_prefix;
+    p_stream->p_suffix = p_suffix;
+    return true;
+}
+
+/*** end of file ***/
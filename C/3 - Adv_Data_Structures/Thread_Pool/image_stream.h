@@ -0,0 +1,187 @@
+/** @file image_stream.h
+ *
+ * @brief Streaming reader, decoder and writer for bartender replies.
+ *
+ * Bytes from the socket land in a ring buffer and are framed into lines
+ * without being copied. The payload of an "IMAGE " line is decoded piece
+ * by piece, as it arrives, straight into an output buffer, so a line may
+ * be any length and may be split over or share reads with other lines.
+ * Decoded images are queued with the caller's prefix and suffix as an
+ * iovec list and written with one writev() per reply (or whenever the
+ * output buffer fills up).
+ *
+ * How an image line is decoded is up to the caller. A stream made with
+ * image_stream_create_decoder() collects each "IMAGE " line whole and
+ * hands it to the caller's decoder, such as decode_server_message(). One
+ * made with image_stream_create() decodes through the caller's 256-entry
+ * table instead, piece by piece as the line arrives and vectorised with
+ * AVX2 when __AVX2__ is defined; use it only for a decoding known to be a
+ * byte-for-byte substitution.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef IMAGE_STREAM_H
+#define IMAGE_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define IMAGE_STREAM_SUCCESS       (0)  /* Reply not finished yet */
+#define IMAGE_STREAM_END           (1)  /* "END" line seen, output flushed */
+#define IMAGE_STREAM_ERROR_PARAM   (-1)
+#define IMAGE_STREAM_ERROR_MEMORY  (-2)
+#define IMAGE_STREAM_ERROR_CLOSED  (-3) /* Peer closed the connection */
+#define IMAGE_STREAM_ERROR_IO      (-4) /* Read or write failed */
+
+#define IMAGE_STREAM_RING_SIZE     (65536u) /* Input ring, power of two */
+#define IMAGE_STREAM_OUTPUT_SIZE   (65536u) /* Decoded bytes per writev */
+#define IMAGE_STREAM_MAX_IOV       (64u)    /* iovecs per writev */
+#define IMAGE_STREAM_LINE_SIZE     (4096u)  /* First line buffer, grows */
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Reader, decoder and writer state for one connection */
+typedef struct image_stream image_stream_t;
+
+/* Decodes one whole image line, "IMAGE " header included and newline
+   left off, into a NUL-terminated string of at most out_size bytes.
+   Returns 0 on success, as decode_server_message() does. */
+typedef int (*image_stream_decoder_t)(const char * p_message,
+                                      const char * p_dictionary,
+                                      char *       p_decoded,
+                                      size_t       out_size);
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Decodes bytes through a table; any split of the input gives the
+ *        same output.
+ *
+ * @param[in]  p_table 256-entry table
+ * @param[in]  p_src   Encoded bytes
+ * @param[out] p_dst   Decoded bytes (may equal p_src)
+ * @param[in]  len     Number of bytes
+ */
+void
+image_stream_decode(const uint8_t p_table[256],
+                    const uint8_t * p_src,
+                    uint8_t *       p_dst,
+                    size_t          len);
+
+/*!
+ * @brief Creates a stream that decodes through a substitution table and
+ *        writes images to output_fd.
+ *
+ * @param[in] p_table   256-entry decode table (copied)
+ * @param[in] output_fd Descriptor the images are written to
+ *
+ * @return Pointer to the stream, or NULL on failure
+ */
+image_stream_t *
+image_stream_create(const uint8_t p_table[256], int output_fd);
+
+/*!
+ * @brief Creates a stream that decodes each image line with the caller's
+ *        decoder and writes images to output_fd.
+ *
+ * The decoder gets the whole line, NUL-terminated, and an output buffer
+ * as large as the line buffer, which starts at IMAGE_STREAM_LINE_SIZE and
+ * doubles for longer lines. A line it fails to decode is left out of the
+ * output, prefix and suffix too, and counted in
+ * image_stream_decode_failures().
+ *
+ * @param[in] decode_fn    Line decoder, e.g. decode_server_message()
+ * @param[in] p_dictionary Passed to decode_fn; must outlive the stream
+ * @param[in] output_fd    Descriptor the images are written to
+ *
+ * @return Pointer to the stream, or NULL on failure
+ */
+image_stream_t *
+image_stream_create_decoder(image_stream_decoder_t decode_fn,
+                            const char *           p_dictionary,
+                            int                    output_fd);
+
+/*!
+ * @brief Number of image lines the stream's decoder has rejected.
+ *
+ * @param[in] p_stream Stream
+ *
+ * @return Failures since the stream was created, 0 if p_stream is NULL
+ */
+uint64_t
+image_stream_decode_failures(const image_stream_t * p_stream);
+
+/*!
+ * @brief Reads from a socket once, if no input is buffered, and processes
+ *        everything buffered up to the next "END" line.
+ *
+ * Every image is written between a prefix and a suffix line, each followed
+ * by a newline as puts() did. They are not copied and must stay valid
+ * until the output is flushed, which happens before IMAGE_STREAM_END is
+ * returned. Bytes after "END" stay buffered for the next reply.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     input_fd Socket or other readable descriptor
+ * @param[in]     p_prefix Line written before every image
+ * @param[in]     p_suffix Line written after every image
+ *
+ * @return IMAGE_STREAM_END, IMAGE_STREAM_SUCCESS if more input is needed,
+ *         or a negative error code
+ */
+int
+image_stream_read(image_stream_t * p_stream,
+                  int              input_fd,
+                  const char *     p_prefix,
+                  const char *     p_suffix);
+
+/*!
+ * @brief Processes bytes that are already in memory.
+ *
+ * @param[in,out] p_stream Stream
+ * @param[in]     p_data   Reply bytes
+ * @param[in]     len      Number of bytes
+ * @param[in]     p_prefix Line written before every image
+ * @param[in]     p_suffix Line written after every image
+ * @param[out]    p_used   Bytes consumed; less than len only after "END"
+ *
+ * @return IMAGE_STREAM_END, IMAGE_STREAM_SUCCESS, or a negative error code
+ */
+int
+image_stream_consume(image_stream_t * p_stream,
+                     const char *     p_data,
+                     size_t           len,
+                     const char *     p_prefix,
+                     const char *     p_suffix,
+                     size_t *         p_used);
+
+/*!
+ * @brief Writes everything queued so far.
+ *
+ * @param[in,out] p_stream Stream
+ *
+ * @return IMAGE_STREAM_SUCCESS or IMAGE_STREAM_ERROR_IO
+ */
+int
+image_stream_flush(image_stream_t * p_stream);
+
+/*!
+ * @brief Frees a stream without flushing it.
+ *
+ * @param[in,out] pp_stream Pointer to the stream pointer; set to NULL
+ */
+void
+image_stream_destroy(image_stream_t ** pp_stream);
+
+#endif /* IMAGE_STREAM_H */
+
+/*** end of file ***/
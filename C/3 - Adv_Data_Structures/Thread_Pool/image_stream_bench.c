@@ -0,0 +1,592 @@
+/** @file image_stream_bench.c
+ *
+ * @brief Decode throughput of image_stream against the per-message path.
+ *
+ * Generates bartender replies made of IMAGE lines with random payloads,
+ * a few unrelated lines and "END", then measures decoded MB/s for:
+ *
+ * - the decode kernel alone, against a plain table loop;
+ * - the old worker.c path on messages small enough for it (4 KB buffer
+ *   cleared before every message, a second buffer cleared and filled by
+ *   a table loop, three puts-style writes), with every message handed to
+ *   it whole as if each recv() returned exactly one message;
+ * - image_stream_read on the same replies read from a file, with images
+ *   written to /dev/null;
+ * - image_stream_read on replies with images of up to LARGE_MAX bytes;
+ * - image_stream_read with a line decoder instead of a table, the path
+ *   worker.c takes with decode_server_message().
+ *
+ * The payloads use a stand-in cipher, byte FIRST_CODE + k for
+ * dictionary[k], decoded through a table in one mode and by
+ * table_decoder() in the other.
+ *
+ * Every figure is the best of REPEATS runs. Before timing, the replies
+ * are pushed through a pipe in random pieces so lines arrive split and
+ * coalesced, and the stream output is compared byte for byte with a
+ * reference decode.
+ *
+ * Build: gcc -O2 -march=native -std=c99 -D_POSIX_C_SOURCE=200809L
+ *        image_stream_bench.c image_stream.c -pthread
+ *
+ * Usage: image_stream_bench [replies]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "image_stream.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_REPLIES (2000u)
+#define LINES_PER_REPLY (8u)
+#define SMALL_MAX       (3000u)  /* Fits the old 4 KB message buffer */
+#define LARGE_MAX       (200000u)
+#define LEGACY_SIZE     (4096u)
+#define KERNEL_BYTES    (64u * 1024u * 1024u)
+#define MAX_PIECE       (9000u)
+#define DICTIONARY_LEN  (90u)
+#define FIRST_CODE      (' ')    /* Code of dictionary[0] */
+#define REPEATS         (3u)     /* Best of, to ride out scheduler noise */
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Generated replies and what decoding them must produce */
+typedef struct
+{
+    char *   p_input;
+    size_t   input_len;
+    char *   p_expected;
+    size_t   expected_len;
+    uint64_t payload;    /* Decoded image bytes */
+    uint32_t replies;
+} workload_t;
+
+/* Pipe writer for the split/coalesced check */
+typedef struct
+{
+    int          fd;
+    const char * p_data;
+    size_t       len;
+    uint64_t     seed;
+} feeder_t;
+
+/*************************************************************************
+ * Static Data
+ *************************************************************************/
+
+static uint8_t g_table[256]; /* Used by table_decoder() */
+
+/*************************************************************************
+ * Static Functions
+ *************************************************************************/
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+static double
+best(double current, double candidate)
+{
+    return (candidate > current) ? candidate : current;
+}
+
+static uint32_t
+next_random(uint64_t * p_state)
+{
+    *p_state = (*p_state * 6364136223846793005ull) + 1442695040888963407ull;
+    return (uint32_t)(*p_state >> 33);
+}
+
+static bool
+append(char ** pp_buf, size_t * p_len, size_t * p_cap, const char * p_data,
+       size_t len)
+{
+    if ((*p_len + len) > *p_cap)
+    {
+        size_t cap = (0 == *p_cap) ? 4096 : *p_cap;
+        while (cap < (*p_len + len))
+        {
+            cap *= 2;
+        }
+        char * p_grown = realloc(*pp_buf, cap);
+        if (NULL == p_grown)
+        {
+            return false;
+        }
+        *pp_buf = p_grown;
+        *p_cap  = cap;
+    }
+    memcpy(*pp_buf + *p_len, p_data, len);
+    *p_len += len;
+    return true;
+}
+
+/*!
+ * @brief Generates replies and their reference output.
+ *
+ * @param[out] p_work      Workload
+ * @param[in]  p_table     Decode table
+ * @param[in]  replies     Number of replies
+ * @param[in]  max_payload Longest image payload
+ * @param[in]  p_prefix    Prefix line
+ * @param[in]  p_suffix    Suffix line
+ *
+ * @return false if memory ran out
+ */
+static bool
+generate(workload_t *    p_work,
+         const uint8_t * p_table,
+         uint32_t        replies,
+         uint32_t        max_payload,
+         const char *    p_prefix,
+         const char *    p_suffix)
+{
+    uint64_t state     = max_payload;
+    size_t   in_cap    = 0;
+    size_t   out_cap   = 0;
+    char *   p_payload = malloc(max_payload);
+    bool     b_ok      = (NULL != p_payload);
+
+    memset(p_work, 0, sizeof(*p_work));
+    p_work->replies = replies;
+
+    for (uint32_t reply = 0; b_ok && (reply < replies); reply++)
+    {
+        for (uint32_t line = 0; b_ok && (line < LINES_PER_REPLY); line++)
+        {
+            if (0 == (next_random(&state) % 8))
+            {
+                b_ok = append(&p_work->p_input, &p_work->input_len, &in_cap,
+                              "WAIT\n", 5);
+                continue;
+            }
+
+            uint32_t len = 1 + (next_random(&state) % max_payload);
+            for (uint32_t idx = 0; idx < len; idx++)
+            {
+                p_payload[idx] = (char)(FIRST_CODE
+                                        + (next_random(&state)
+                                           % DICTIONARY_LEN));
+            }
+
+            b_ok = append(&p_work->p_input, &p_work->input_len, &in_cap,
+                          "IMAGE ", 6)
+                   && append(&p_work->p_input, &p_work->input_len, &in_cap,
+                             p_payload, len)
+                   && append(&p_work->p_input, &p_work->input_len, &in_cap,
+                             "\n", 1);
+
+            for (uint32_t idx = 0; idx < len; idx++)
+            {
+                p_payload[idx] = (char)p_table[(uint8_t)p_payload[idx]];
+            }
+
+            b_ok = b_ok
+                   && append(&p_work->p_expected, &p_work->expected_len,
+                             &out_cap, p_prefix, strlen(p_prefix))
+                   && append(&p_work->p_expected, &p_work->expected_len,
+                             &out_cap, "\n", 1)
+                   && append(&p_work->p_expected, &p_work->expected_len,
+                             &out_cap, p_payload, len)
+                   && append(&p_work->p_expected, &p_work->expected_len,
+                             &out_cap, "\n", 1)
+                   && append(&p_work->p_expected, &p_work->expected_len,
+                             &out_cap, p_suffix, strlen(p_suffix))
+                   && append(&p_work->p_expected, &p_work->expected_len,
+                             &out_cap, "\n", 1);
+            p_work->payload += len;
+        }
+
+        b_ok = b_ok
+               && append(&p_work->p_input, &p_work->input_len, &in_cap,
+                         "END\n", 4);
+    }
+
+    free(p_payload);
+    return b_ok;
+}
+
+static void *
+feeder_thread(void * p_arg)
+{
+    feeder_t * p_feed = p_arg;
+    size_t     pos    = 0;
+
+    while (pos < p_feed->len)
+    {
+        size_t piece = 1 + (next_random(&p_feed->seed) % MAX_PIECE);
+        piece        = (piece < (p_feed->len - pos)) ? piece
+                                                     : (p_feed->len - pos);
+        ssize_t sent = write(p_feed->fd, p_feed->p_data + pos, piece);
+        if (sent <= 0)
+        {
+            break;
+        }
+        pos += (size_t)sent;
+    }
+
+    close(p_feed->fd);
+    return NULL;
+}
+
+/*!
+ * @brief Builds the decode table of the stand-in cipher: byte
+ *        FIRST_CODE + k decodes to dictionary[k], every other byte to
+ *        itself.
+ */
+static void
+build_table(uint8_t p_table[256], const char * p_dictionary)
+{
+    for (uint32_t code = 0; code < 256; code++)
+    {
+        p_table[code] = (uint8_t)code;
+    }
+
+    for (uint32_t idx = 0;
+         ('\0' != p_dictionary[idx]) && (FIRST_CODE + idx < 256);
+         idx++)
+    {
+        p_table[FIRST_CODE + idx] = (uint8_t)p_dictionary[idx];
+    }
+}
+
+/*!
+ * @brief Line decoder for the stand-in cipher, shaped like
+ *        decode_server_message(); decodes through g_table.
+ *
+ * @return 0 on success, -1 if the line is not an image or does not fit
+ */
+static int
+table_decoder(const char * p_message, const char * p_dictionary,
+              char * p_decoded, size_t out_size)
+{
+    (void)p_dictionary;
+
+    if (0 != strncmp(p_message, "IMAGE ", 6))
+    {
+        return -1;
+    }
+
+    size_t len = strlen(p_message + 6);
+    if (len >= out_size)
+    {
+        return -1;
+    }
+
+    image_stream_decode(g_table, (const uint8_t *)p_message + 6,
+                        (uint8_t *)p_decoded, len);
+    p_decoded[len] = '\0';
+    return 0;
+}
+
+/*!
+ * @brief Creates the stream under test: a line decoder stream when
+ *        decode_fn is given, a table stream otherwise.
+ */
+static image_stream_t *
+create_stream(const uint8_t * p_table, image_stream_decoder_t decode_fn,
+              int output_fd)
+{
+    return (NULL != decode_fn)
+               ? image_stream_create_decoder(decode_fn, NULL, output_fd)
+               : image_stream_create(p_table, output_fd);
+}
+
+/*!
+ * @brief Runs replies through a stream reading input_fd until every "END"
+ *        is seen.
+ *
+ * @return false on a stream error or early end of input
+ */
+static bool
+drain(image_stream_t * p_stream, int input_fd, uint32_t replies,
+      const char * p_prefix, const char * p_suffix)
+{
+    uint32_t ends = 0;
+
+    while (ends < replies)
+    {
+        int status
+            = image_stream_read(p_stream, input_fd, p_prefix, p_suffix);
+        if (status < 0)
+        {
+            return false;
+        }
+        ends += (IMAGE_STREAM_END == status) ? 1 : 0;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Checks the stream output against the reference with input that
+ *        arrives through a pipe in random pieces.
+ */
+static bool
+check_split(const workload_t * p_work, const uint8_t * p_table,
+            image_stream_decoder_t decode_fn, const char * p_prefix,
+            const char * p_suffix)
+{
+    int      fds[2];
+    FILE *   p_out = tmpfile();
+    bool     b_ok  = false;
+
+    if ((NULL == p_out) || (0 != pipe(fds)))
+    {
+        return false;
+    }
+
+    feeder_t feed = { fds[1], p_work->p_input, p_work->input_len, 7 };
+    pthread_t thread;
+    pthread_create(&thread, NULL, feeder_thread, &feed);
+
+    image_stream_t * p_stream
+        = create_stream(p_table, decode_fn, fileno(p_out));
+    if (NULL != p_stream)
+    {
+        b_ok = drain(p_stream, fds[0], p_work->replies, p_prefix, p_suffix);
+    }
+
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    image_stream_destroy(&p_stream);
+
+    // Read the output back and compare
+    char * p_got = malloc(p_work->expected_len + 1);
+    b_ok         = b_ok && (NULL != p_got) && (0 == fseek(p_out, 0, SEEK_SET))
+                   && (p_work->expected_len
+                       == fread(p_got, 1, p_work->expected_len + 1, p_out))
+                   && (0 == memcmp(p_got, p_work->p_expected,
+                                   p_work->expected_len));
+    free(p_got);
+    fclose(p_out);
+    return b_ok;
+}
+
+/*!
+ * @brief Times the stream on a workload stored in a file.
+ *
+ * @return Decoded MB/s, or 0 on failure
+ */
+static double
+time_stream(const workload_t * p_work, const uint8_t * p_table,
+            image_stream_decoder_t decode_fn, const char * p_prefix,
+            const char * p_suffix, int null_fd)
+{
+    FILE * p_in = tmpfile();
+    if ((NULL == p_in)
+        || (p_work->input_len
+            != fwrite(p_work->p_input, 1, p_work->input_len, p_in))
+        || (0 != fflush(p_in)))
+    {
+        return 0.0;
+    }
+
+    image_stream_t * p_stream = create_stream(p_table, decode_fn, null_fd);
+    lseek(fileno(p_in), 0, SEEK_SET);
+
+    double start = now_seconds();
+    bool   b_ok  = (NULL != p_stream)
+                   && drain(p_stream, fileno(p_in), p_work->replies, p_prefix,
+                            p_suffix);
+    double secs  = now_seconds() - start;
+
+    image_stream_destroy(&p_stream);
+    fclose(p_in);
+    return b_ok ? ((double)p_work->payload / secs) / 1e6 : 0.0;
+}
+
+/*!
+ * @brief Times the old per-message path on a workload of small messages.
+ *
+ * @return Decoded MB/s
+ */
+static double
+time_legacy(const workload_t * p_work, const uint8_t * p_table,
+            const char * p_prefix, const char * p_suffix, FILE * p_null)
+{
+    static char message[LEGACY_SIZE];
+    static char decoded[LEGACY_SIZE];
+    const char * p_pos = p_work->p_input;
+    const char * p_end = p_work->p_input + p_work->input_len;
+
+    double start = now_seconds();
+    while (p_pos < p_end)
+    {
+        const char * p_newline = memchr(p_pos, '\n', (size_t)(p_end - p_pos));
+        size_t       len       = (size_t)(p_newline - p_pos) + 1;
+
+        // One recv() per message into a cleared buffer
+        memset(message, 0, sizeof(message));
+        memcpy(message, p_pos, len);
+        p_pos = p_newline + 1;
+
+        if (0 == strncmp(message, "IMAGE ", 6))
+        {
+            memset(decoded, 0, sizeof(decoded));
+            size_t payload = len - 7;
+            for (size_t idx = 0; idx < payload; idx++)
+            {
+                decoded[idx] = (char)p_table[(uint8_t)message[idx + 6]];
+            }
+            fputs(p_prefix, p_null);
+            fputc('\n', p_null);
+            fputs(decoded, p_null);
+            fputc('\n', p_null);
+            fputs(p_suffix, p_null);
+            fputc('\n', p_null);
+        }
+    }
+    fflush(p_null);
+    double secs = now_seconds() - start;
+
+    return ((double)p_work->payload / secs) / 1e6;
+}
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t replies
+        = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_REPLIES;
+    const char * p_prefix = "\033[31m";
+    const char * p_suffix = "\033[0m";
+    char         dictionary[DICTIONARY_LEN + 1];
+    uint8_t      table[256];
+    uint64_t     state = 3;
+
+    if (0 == replies)
+    {
+        replies = 1;
+    }
+
+    // A shuffled printable alphabet
+    for (uint32_t idx = 0; idx < DICTIONARY_LEN; idx++)
+    {
+        dictionary[idx] = (char)('!' + idx);
+    }
+    for (uint32_t idx = DICTIONARY_LEN - 1; idx > 0; idx--)
+    {
+        uint32_t other    = next_random(&state) % (idx + 1);
+        char     swap     = dictionary[idx];
+        dictionary[idx]   = dictionary[other];
+        dictionary[other] = swap;
+    }
+    dictionary[DICTIONARY_LEN] = '\0';
+    build_table(table, dictionary);
+    memcpy(g_table, table, sizeof(g_table));
+
+    workload_t small;
+    workload_t large;
+    uint8_t *  p_kernel  = malloc(KERNEL_BYTES);
+    uint8_t *  p_ref     = malloc(KERNEL_BYTES);
+    uint8_t *  p_decoded = malloc(KERNEL_BYTES);
+    int        null_fd   = open("/dev/null", O_WRONLY);
+    FILE *     p_null    = fopen("/dev/null", "w");
+
+    if (!generate(&small, table, replies, SMALL_MAX, p_prefix, p_suffix)
+        || !generate(&large, table, replies / 10 + 1, LARGE_MAX, p_prefix,
+                     p_suffix)
+        || (NULL == p_kernel) || (NULL == p_ref) || (NULL == p_decoded)
+        || (null_fd < 0)
+        || (NULL == p_null))
+    {
+        fprintf(stderr, "setup failed\n");
+        return EXIT_FAILURE;
+    }
+
+    bool b_split
+        = check_split(&large, table, NULL, p_prefix, p_suffix)
+          && check_split(&small, table, NULL, p_prefix, p_suffix)
+          && check_split(&large, NULL, table_decoder, p_prefix, p_suffix)
+          && check_split(&small, NULL, table_decoder, p_prefix, p_suffix);
+    printf("split/coalesced input check: %s\n\n", b_split ? "ok" : "FAILED");
+
+    // Kernel alone, on memory that has already been touched
+    for (size_t idx = 0; idx < KERNEL_BYTES; idx++)
+    {
+        p_kernel[idx] = (uint8_t)next_random(&state);
+    }
+    memset(p_ref, 0, KERNEL_BYTES);
+    memset(p_decoded, 0, KERNEL_BYTES);
+
+    double scalar = 0.0;
+    double vector = 0.0;
+    double legacy = 0.0;
+    double stream = 0.0;
+    double big    = 0.0;
+    double lines  = 0.0;
+    for (uint32_t run = 0; run < REPEATS; run++)
+    {
+        double start = now_seconds();
+        for (size_t idx = 0; idx < KERNEL_BYTES; idx++)
+        {
+            p_ref[idx] = table[p_kernel[idx]];
+        }
+        scalar = best(scalar, KERNEL_BYTES / (now_seconds() - start) / 1e6);
+
+        start = now_seconds();
+        image_stream_decode(table, p_kernel, p_decoded, KERNEL_BYTES);
+        vector = best(vector, KERNEL_BYTES / (now_seconds() - start) / 1e6);
+
+        legacy = best(legacy,
+                      time_legacy(&small, table, p_prefix, p_suffix, p_null));
+        stream = best(stream, time_stream(&small, table, NULL, p_prefix,
+                                          p_suffix, null_fd));
+        big    = best(big, time_stream(&large, table, NULL, p_prefix,
+                                       p_suffix, null_fd));
+        lines  = best(lines, time_stream(&small, NULL, table_decoder,
+                                         p_prefix, p_suffix, null_fd));
+    }
+
+    bool b_same = (0 == memcmp(p_decoded, p_ref, KERNEL_BYTES));
+
+    printf("%-34s %10s\n", "", "MB/s");
+    printf("%-34s %10.0f\n", "table loop", scalar);
+    printf("%-34s %10.0f  (%s)\n",
+           "image_stream_decode",
+           vector,
+#ifdef __AVX2__
+           "AVX2");
+#else
+           "scalar");
+#endif
+    printf("%-34s %10.0f\n", "per-message path, <= 3 KB images", legacy);
+    printf("%-34s %10.0f\n", "image_stream, <= 3 KB images", stream);
+    printf("%-34s %10.0f\n", "image_stream, <= 200 KB images", big);
+    printf("%-34s %10.0f\n", "line decoder, <= 3 KB images", lines);
+
+    fclose(p_null);
+    close(null_fd);
+    free(p_decoded);
+    free(p_ref);
+    free(p_kernel);
+    free(small.p_input);
+    free(small.p_expected);
+    free(large.p_input);
+    free(large.p_expected);
+
+    return (b_split && b_same) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*** end of file ***/
@@ -0,0 +1,476 @@
+#include <check.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "image_stream.h"
+
+#define FIRST_CODE (0xA0u) /* Byte that decodes to g_dictionary[0] */
+#define PREFIX     "<image>"
+#define SUFFIX     "</image>"
+#define MAX_PIECE  (3000u)
+
+static const char g_dictionary[] = " .:-=+*#%@";
+
+// Reply input, and what decoding it line by line must produce
+typedef struct
+{
+    char *   p_data;
+    size_t   len;
+    size_t   cap;
+    char *   p_expected;
+    size_t   expected_len;
+    size_t   expected_cap;
+    uint64_t rejected;
+} script_t;
+
+// Writes a buffer into a socket in random pieces from its own thread
+typedef struct
+{
+    int          fd;
+    const char * p_data;
+    size_t       len;
+    uint64_t     seed;
+} feeder_t;
+
+static int      g_fds[2];
+static int      g_out = -1;
+static uint8_t  g_table[256];
+static script_t g_script;
+
+static uint32_t
+next_random(uint64_t * p_state)
+{
+    *p_state = (*p_state * 6364136223846793005ull) + 1442695040888963407ull;
+    return (uint32_t)(*p_state >> 33);
+}
+
+/*!
+ * @brief Stand-in for decode_server_message(), which is not part of this
+ *        tree: maps byte FIRST_CODE + k to dictionary[k] and rejects
+ *        anything else, so it needs the whole line to succeed.
+ */
+static int
+reference_decoder(const char * p_message,
+                  const char * p_dictionary,
+                  char *       p_decoded,
+                  size_t       out_size)
+{
+    size_t codes = strlen(p_dictionary);
+
+    if (0 != strncmp(p_message, "IMAGE ", 6))
+    {
+        return -1;
+    }
+
+    size_t len = strlen(p_message + 6);
+    if (len >= out_size)
+    {
+        return -1;
+    }
+
+    for (size_t idx = 0; idx < len; idx++)
+    {
+        uint8_t code = (uint8_t)p_message[6 + idx];
+
+        if ((code < FIRST_CODE) || (code >= FIRST_CODE + codes))
+        {
+            return -1;
+        }
+        p_decoded[idx] = p_dictionary[code - FIRST_CODE];
+    }
+
+    p_decoded[len] = '\0';
+    return 0;
+}
+
+static void
+append(char ** pp_buf, size_t * p_len, size_t * p_cap, const char * p_data,
+       size_t len)
+{
+    if ((*p_len + len) > *p_cap)
+    {
+        size_t cap = (0 == *p_cap) ? 4096 : *p_cap;
+        while (cap < (*p_len + len))
+        {
+            cap *= 2;
+        }
+        *pp_buf = realloc(*pp_buf, cap);
+        ck_assert_ptr_nonnull(*pp_buf);
+        *p_cap = cap;
+    }
+
+    memcpy(*pp_buf + *p_len, p_data, len);
+    *p_len += len;
+}
+
+// Adds a line to the script and, for an image the decoder accepts, what
+// the stream must write for it, taken from the decoder itself
+static void
+script_line(script_t * p_script, const char * p_line, size_t len)
+{
+    append(&p_script->p_data, &p_script->len, &p_script->cap, p_line, len);
+    append(&p_script->p_data, &p_script->len, &p_script->cap, "\n", 1);
+
+    if ((len < 6) || (0 != strncmp(p_line, "IMAGE ", 6)))
+    {
+        return;
+    }
+
+    char * p_message = malloc(len + 1);
+    char * p_decoded = malloc(len + 1);
+    ck_assert_ptr_nonnull(p_message);
+    ck_assert_ptr_nonnull(p_decoded);
+    memcpy(p_message, p_line, len);
+    p_message[len] = '\0';
+
+    if (0 == reference_decoder(p_message, g_dictionary, p_decoded, len + 1))
+    {
+        append(&p_script->p_expected, &p_script->expected_len,
+               &p_script->expected_cap, PREFIX "\n", strlen(PREFIX) + 1);
+        append(&p_script->p_expected, &p_script->expected_len,
+               &p_script->expected_cap, p_decoded, strlen(p_decoded));
+        append(&p_script->p_expected, &p_script->expected_len,
+               &p_script->expected_cap, "\n" SUFFIX "\n",
+               strlen(SUFFIX) + 2);
+    }
+    else
+    {
+        p_script->rejected++;
+    }
+
+    free(p_message);
+    free(p_decoded);
+}
+
+// Adds an image line of len codes; a rejected line carries one bad byte
+static void
+script_image(script_t * p_script, size_t len, bool b_reject, uint64_t * p_state)
+{
+    char * p_line = malloc(len + 6);
+    ck_assert_ptr_nonnull(p_line);
+
+    memcpy(p_line, "IMAGE ", 6);
+    for (size_t idx = 0; idx < len; idx++)
+    {
+        p_line[6 + idx] = (char)(FIRST_CODE
+                                 + (next_random(p_state)
+                                    % (sizeof(g_dictionary) - 1)));
+    }
+    if (b_reject)
+    {
+        p_line[6 + (next_random(p_state) % len)] = 'x';
+    }
+
+    script_line(p_script, p_line, len + 6);
+    free(p_line);
+}
+
+static void
+script_end(script_t * p_script)
+{
+    script_line(p_script, "END", 3);
+}
+
+static void
+stream_setup(void)
+{
+    char path[] = "/tmp/image_stream_testXXXXXX";
+
+    ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, g_fds), 0);
+    g_out = mkstemp(path);
+    ck_assert_int_ge(g_out, 0);
+    unlink(path);
+
+    for (uint32_t code = 0; code < 256; code++)
+    {
+        g_table[code] = (uint8_t)code;
+    }
+    for (uint32_t idx = 0; idx < sizeof(g_dictionary) - 1; idx++)
+    {
+        g_table[FIRST_CODE + idx] = (uint8_t)g_dictionary[idx];
+    }
+
+    memset(&g_script, 0, sizeof(g_script));
+}
+
+static void
+stream_teardown(void)
+{
+    close(g_fds[0]);
+    close(g_fds[1]);
+    close(g_out);
+    free(g_script.p_data);
+    free(g_script.p_expected);
+}
+
+static image_stream_t *
+create_stream(bool b_decoder)
+{
+    image_stream_t * p_stream
+        = b_decoder ? image_stream_create_decoder(reference_decoder,
+                                                  g_dictionary, g_out)
+                    : image_stream_create(g_table, g_out);
+
+    ck_assert_ptr_nonnull(p_stream);
+    ck_assert_int_eq(ftruncate(g_out, 0), 0);
+    ck_assert_int_eq(lseek(g_out, 0, SEEK_SET), 0);
+    return p_stream;
+}
+
+static void
+send_all(const char * p_data, size_t len)
+{
+    ck_assert_int_eq(write(g_fds[1], p_data, len), (ssize_t)len);
+}
+
+static void *
+feeder_run(void * p_arg)
+{
+    feeder_t * p_feed = p_arg;
+    size_t     pos    = 0;
+
+    while (pos < p_feed->len)
+    {
+        size_t piece = 1 + (next_random(&p_feed->seed) % MAX_PIECE);
+        piece        = (piece < (p_feed->len - pos)) ? piece
+                                                     : (p_feed->len - pos);
+        ssize_t sent = write(p_feed->fd, p_feed->p_data + pos, piece);
+        if (sent <= 0)
+        {
+            break;
+        }
+        pos += (size_t)sent;
+    }
+
+    return NULL;
+}
+
+// Reads replies until the given number of "END" lines have been seen
+static void
+read_replies(image_stream_t * p_stream, uint32_t replies)
+{
+    uint32_t ends = 0;
+
+    while (ends < replies)
+    {
+        int status = image_stream_read(p_stream, g_fds[0], PREFIX, SUFFIX);
+
+        ck_assert_int_ge(status, 0);
+        ends += (IMAGE_STREAM_END == status) ? 1 : 0;
+    }
+}
+
+// Checks the output file holds exactly the expected bytes
+static void
+assert_output(const char * p_expected, size_t len)
+{
+    char * p_actual = malloc(len + 1);
+    ck_assert_ptr_nonnull(p_actual);
+
+    ck_assert_int_eq(pread(g_out, p_actual, len + 1, 0), (ssize_t)len);
+    ck_assert_int_eq(memcmp(p_actual, p_expected, len), 0);
+
+    free(p_actual);
+}
+
+START_TEST(test_frame_split_across_reads)
+{
+    uint64_t state = 1;
+
+    script_image(&g_script, 20, false, &state);
+    script_line(&g_script, "WAIT", 4);
+    script_image(&g_script, 5, false, &state);
+    script_end(&g_script);
+
+    // Cut the reply at every byte, inside headers and "END" included
+    for (int mode = 0; mode < 2; mode++)
+    {
+        for (size_t cut = 1; cut < g_script.len; cut++)
+        {
+            image_stream_t * p_stream = create_stream(1 == mode);
+
+            send_all(g_script.p_data, cut);
+            int status = image_stream_read(p_stream, g_fds[0], PREFIX, SUFFIX);
+
+            // A bare "END" at the edge of the input completes the reply
+            if ((g_script.len - 1) == cut)
+            {
+                ck_assert_int_eq(status, IMAGE_STREAM_END);
+                ck_assert_int_eq(image_stream_flush(p_stream),
+                                 IMAGE_STREAM_SUCCESS);
+                send_all(g_script.p_data + cut, g_script.len - cut);
+                char byte;
+                ck_assert_int_eq(read(g_fds[0], &byte, 1), 1);
+            }
+            else
+            {
+                ck_assert_int_eq(status, IMAGE_STREAM_SUCCESS);
+                send_all(g_script.p_data + cut, g_script.len - cut);
+                read_replies(p_stream, 1);
+            }
+
+            assert_output(g_script.p_expected, g_script.expected_len);
+            image_stream_destroy(&p_stream);
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_frames_coalesced_in_one_read)
+{
+    uint64_t state = 2;
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+        image_stream_t * p_stream = create_stream(1 == mode);
+
+        g_script.len          = 0;
+        g_script.expected_len = 0;
+        script_image(&g_script, 30, false, &state);
+        script_end(&g_script);
+
+        size_t first_len      = g_script.len;
+        size_t first_expected = g_script.expected_len;
+
+        script_image(&g_script, 40, false, &state);
+        script_image(&g_script, 1, false, &state);
+        script_end(&g_script);
+
+        // Both replies arrive in one read; the second stays buffered and
+        // is handled without reading the socket again
+        send_all(g_script.p_data, g_script.len);
+        ck_assert_int_eq(image_stream_read(p_stream, g_fds[0], PREFIX, SUFFIX),
+                         IMAGE_STREAM_END);
+        assert_output(g_script.p_expected, first_expected);
+
+        ck_assert_int_eq(image_stream_read(p_stream, g_fds[0], PREFIX, SUFFIX),
+                         IMAGE_STREAM_END);
+        assert_output(g_script.p_expected, g_script.expected_len);
+        ck_assert_uint_gt(g_script.len, first_len);
+
+        image_stream_destroy(&p_stream);
+    }
+}
+END_TEST
+
+START_TEST(test_frame_over_line_buffer)
+{
+    const size_t lengths[] = { IMAGE_STREAM_LINE_SIZE - 7,
+                               IMAGE_STREAM_LINE_SIZE - 6,
+                               IMAGE_STREAM_LINE_SIZE,
+                               10000,
+                               IMAGE_STREAM_RING_SIZE + 12345 };
+    uint64_t     state     = 3;
+
+    for (size_t idx = 0; idx < sizeof(lengths) / sizeof(lengths[0]); idx++)
+    {
+        script_image(&g_script, lengths[idx], false, &state);
+    }
+    script_end(&g_script);
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+        image_stream_t * p_stream = create_stream(1 == mode);
+        feeder_t         feed = { g_fds[1], g_script.p_data, g_script.len, 7 };
+        pthread_t        thread;
+
+        ck_assert_int_eq(pthread_create(&thread, NULL, feeder_run, &feed), 0);
+        read_replies(p_stream, 1);
+        pthread_join(thread, NULL);
+
+        assert_output(g_script.p_expected, g_script.expected_len);
+        ck_assert_uint_eq(image_stream_decode_failures(p_stream), 0);
+        image_stream_destroy(&p_stream);
+    }
+}
+END_TEST
+
+START_TEST(test_output_matches_decoder)
+{
+    uint64_t state = 4;
+
+    // Random replies, with lines the decoder rejects mixed in
+    for (uint32_t reply = 0; reply < 40; reply++)
+    {
+        for (uint32_t line = 0; line < 12; line++)
+        {
+            uint32_t kind = next_random(&state) % 10;
+
+            if (0 == kind)
+            {
+                script_line(&g_script, "WAIT", 4);
+            }
+            else
+            {
+                script_image(&g_script, 1 + (next_random(&state) % 3000),
+                             1 == kind, &state);
+            }
+        }
+        script_end(&g_script);
+    }
+    ck_assert_uint_gt(g_script.rejected, 0);
+
+    image_stream_t * p_stream = create_stream(true);
+    feeder_t         feed     = { g_fds[1], g_script.p_data, g_script.len, 9 };
+    pthread_t        thread;
+
+    ck_assert_int_eq(pthread_create(&thread, NULL, feeder_run, &feed), 0);
+    read_replies(p_stream, 40);
+    pthread_join(thread, NULL);
+
+    // Everything written matches calling the decoder on each line, and a
+    // rejected line leaves nothing behind
+    assert_output(g_script.p_expected, g_script.expected_len);
+    ck_assert_uint_eq(image_stream_decode_failures(p_stream),
+                      g_script.rejected);
+
+    image_stream_destroy(&p_stream);
+    ck_assert_ptr_null(p_stream);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+image_stream_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Image_Stream");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_checked_fixture(tc_core, stream_setup, stream_teardown);
+    tcase_add_test(tc_core, test_frame_split_across_reads);
+    tcase_add_test(tc_core, test_frames_coalesced_in_one_read);
+    tcase_add_test(tc_core, test_frame_over_line_buffer);
+    tcase_add_test(tc_core, test_output_matches_decoder);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = image_stream_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -0,0 +1,270 @@
+/** @file overload_bench.c
+ *
+ * @brief Throughput and latency of each thread pool overload policy.
+ *
+ * An open-loop producer submits jobs at a fixed rate to a pool of WORKERS
+ * threads. Each job sleeps for SERVICE_US, like a request waiting on I/O,
+ * so the pool can finish WORKERS / SERVICE_US jobs per second regardless
+ * of the core count. The offered load is swept from below to well above
+ * that capacity. For every policy the benchmark reports the jobs finished
+ * per second, how many of them finished within the client deadline
+ * (goodput), their latency from submit to completion, and how many jobs
+ * were refused or dropped.
+ *
+ * An unbounded queue keeps accepting work, so its latency grows without
+ * limit and goodput falls to nothing once the backlog is older than the
+ * deadline. The bounded policies and CoDel shedding keep latency bounded
+ * and goodput near capacity.
+ *
+ * Build: gcc -O2 -std=c99 -D_POSIX_C_SOURCE=200809L overload_bench.c
+ *        thread_pool.c queue.c -pthread
+ *
+ * Usage: overload_bench [seconds_per_run]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "thread_pool.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define WORKERS         (4)
+#define SERVICE_US      (2000u)
+#define CAPACITY        (64)
+#define DEADLINE_MS     (100u)
+#define BLOCK_MS        (20)
+#define CODEL_TARGET_MS (5)
+#define DEFAULT_SECONDS (2u)
+#define NUM_LOADS       (4u)
+#define NUM_POLICIES    (6u)
+
+#define NSEC_PER_USEC   (1000ull)
+#define NSEC_PER_MSEC   (1000000ull)
+#define NSEC_PER_SEC    (1000000000ull)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Life of one submitted job */
+typedef struct
+{
+    uint64_t submit_ns; /* When the producer submitted it */
+    uint64_t done_ns;   /* When it finished, 0 if it never ran */
+} job_record_t;
+
+/* One pool configuration under test */
+typedef struct
+{
+    const char *         p_name;
+    thread_pool_config_t config;
+} bench_policy_t;
+
+/*************************************************************************
+ * Static Functions
+ *************************************************************************/
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+static void
+sleep_until(uint64_t when_ns)
+{
+    struct timespec when = { .tv_sec  = (time_t)(when_ns / NSEC_PER_SEC),
+                             .tv_nsec = (long)(when_ns % NSEC_PER_SEC) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, NULL);
+}
+
+static void *
+service_job(void * p_arg)
+{
+    job_record_t *  p_record = p_arg;
+    struct timespec service  = { .tv_sec  = 0,
+                                 .tv_nsec = (long)(SERVICE_US * NSEC_PER_USEC) };
+
+    nanosleep(&service, NULL);
+    __atomic_store_n(&p_record->done_ns, now_ns(), __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static int
+compare_u64(const void * p_a, const void * p_b)
+{
+    uint64_t a = *(const uint64_t *)p_a;
+    uint64_t b = *(const uint64_t *)p_b;
+    return (a > b) - (a < b);
+}
+
+static thread_pool_config_t
+make_config(int capacity, thread_pool_policy_t policy, int codel_target_ms)
+{
+    thread_pool_config_t config = thread_pool_config_default(WORKERS);
+    config.queue_capacity       = capacity;
+    config.policy               = policy;
+    config.block_timeout_ms     = BLOCK_MS;
+    config.codel_target_ms      = codel_target_ms;
+    return config;
+}
+
+/*!
+ * @brief Runs one policy at one offered load and prints a result row.
+ *
+ * @param[in] p_policy Pool configuration
+ * @param[in] rate     Offered jobs per second
+ * @param[in] seconds  Length of the submit phase
+ *
+ * @return true on success, false if the pool or buffers could not be made
+ */
+static bool
+run_one(const bench_policy_t * p_policy, uint32_t rate, uint32_t seconds)
+{
+    uint64_t       count     = (uint64_t)rate * seconds;
+    job_record_t * p_records = calloc(count, sizeof(job_record_t));
+    uint64_t *     p_latency = malloc(count * sizeof(uint64_t));
+    thread_pool_t * p_pool   = thread_pool_initialize_ex(&p_policy->config);
+
+    if ((NULL == p_records) || (NULL == p_latency) || (NULL == p_pool))
+    {
+        free(p_records);
+        free(p_latency);
+        thread_pool_destroy(p_pool);
+        return false;
+    }
+
+    uint64_t refused = 0;
+    uint64_t start   = now_ns();
+    uint64_t gap     = NSEC_PER_SEC / rate;
+
+    // Open loop: arrivals follow the clock, not the pool's progress
+    for (uint64_t idx = 0; idx < count; idx++)
+    {
+        sleep_until(start + (idx * gap));
+
+        thread_job_t job = { .job_fn = service_job, .p_arg = &p_records[idx] };
+        p_records[idx].submit_ns = now_ns();
+        if (THREAD_POOL_SUCCESS != thread_pool_submit(p_pool, &job))
+        {
+            refused++;
+        }
+    }
+
+    // Shutdown lets the workers finish the backlog
+    thread_pool_shutdown(p_pool);
+    uint64_t elapsed = now_ns() - start;
+
+    thread_pool_stats_t stats = { 0 };
+    thread_pool_get_stats(p_pool, &stats);
+    thread_pool_destroy(p_pool);
+
+    uint64_t done = 0;
+    uint64_t good = 0;
+    for (uint64_t idx = 0; idx < count; idx++)
+    {
+        if (0 != p_records[idx].done_ns)
+        {
+            uint64_t latency   = p_records[idx].done_ns - p_records[idx].submit_ns;
+            p_latency[done++]  = latency;
+            good              += (latency <= (DEADLINE_MS * NSEC_PER_MSEC)) ? 1 : 0;
+        }
+    }
+
+    qsort(p_latency, done, sizeof(uint64_t), compare_u64);
+    double secs = (double)elapsed / NSEC_PER_SEC;
+    double p50  = (0 == done) ? 0.0 : (double)p_latency[done / 2] / NSEC_PER_MSEC;
+    double p99  = (0 == done)
+                      ? 0.0
+                      : (double)p_latency[(done * 99) / 100] / NSEC_PER_MSEC;
+
+    printf("  %-14s %8.0f %8.0f %9.1f %9.1f %8llu %8llu\n",
+           p_policy->p_name,
+           (double)done / secs,
+           (double)good / secs,
+           p50,
+           p99,
+           (unsigned long long)refused,
+           (unsigned long long)(stats.dropped + stats.shed));
+
+    free(p_latency);
+    free(p_records);
+    return true;
+}
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    uint32_t seconds
+        = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_SECONDS;
+    uint32_t capacity = (uint32_t)((WORKERS * 1000000ull) / SERVICE_US);
+
+    // Percent of the pool's capacity offered
+    const uint32_t loads[NUM_LOADS] = { 80, 150, 300, 600 };
+
+    const bench_policy_t policies[NUM_POLICIES] = {
+        { "unbounded", make_config(0, THREAD_POOL_POLICY_REJECT, 0) },
+        { "reject", make_config(CAPACITY, THREAD_POOL_POLICY_REJECT, 0) },
+        { "block", make_config(CAPACITY, THREAD_POOL_POLICY_BLOCK, 0) },
+        { "caller-runs",
+          make_config(CAPACITY, THREAD_POOL_POLICY_CALLER_RUNS, 0) },
+        { "drop-oldest",
+          make_config(CAPACITY, THREAD_POOL_POLICY_DROP_OLDEST, 0) },
+        { "codel",
+          make_config(0, THREAD_POOL_POLICY_REJECT, CODEL_TARGET_MS) },
+    };
+
+    if (0 == seconds)
+    {
+        seconds = 1;
+    }
+
+    printf("%d workers, %u us per job (capacity %u jobs/s), queue %d, "
+           "deadline %u ms\n",
+           WORKERS,
+           SERVICE_US,
+           capacity,
+           CAPACITY,
+           DEADLINE_MS);
+
+    for (uint32_t load = 0; load < NUM_LOADS; load++)
+    {
+        uint32_t rate = (capacity * loads[load]) / 100;
+
+        printf("\noffered %u jobs/s (%u%%)\n", rate, loads[load]);
+        printf("  %-14s %8s %8s %9s %9s %8s %8s\n",
+               "policy",
+               "done/s",
+               "good/s",
+               "p50 ms",
+               "p99 ms",
+               "refused",
+               "dropped");
+
+        for (uint32_t idx = 0; idx < NUM_POLICIES; idx++)
+        {
+            if (!run_one(&policies[idx], rate, seconds))
+            {
+                fprintf(stderr, "out of memory\n");
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*** end of file ***/
@@ -4,14 +4,6 @@
  */
 
  #include "queue.h"
- #include <stdlib.h>
- 
- /*************************************************************************
- * Constants and Macros
- *************************************************************************/
- 
- // Maximum number of items allowed in queue to prevent unbounded growth 
- #define MAX_QUEUE_SIZE (100)
  
  /*************************************************************************
  * Private Data Structures
@@ -30,6 +22,8 @@
      node_t *p_front;      // Points to first element 
      node_t *p_rear;       // Points to last element 
      int size;             // Number of elements currently in queue 
+     int capacity;         // Maximum size, or QUEUE_UNBOUNDED 
+     const allocator_t *p_alloc; // Source of the queue and its nodes 
  };
  
  /*************************************************************************
@@ -48,8 +42,49 @@
  queue_t *
  queue_create(void)
  {
-  
-     return calloc(1, sizeof(queue_t));
+     return queue_create_bounded(QUEUE_DEFAULT_CAPACITY);
+ }
+ 
+ /*!
+  * @brief Creates a new empty queue holding at most capacity items.
+  *
+  * @param[in] capacity Maximum number of items, or QUEUE_UNBOUNDED
+  *
+  * @return Pointer to newly created queue if successful, NULL if capacity
+  *         is negative or memory allocation fails
+  */
+ queue_t *
+ queue_create_bounded(int capacity)
+ {
+     return queue_create_ex(capacity, NULL);
+ }
+ 
+ /*!
+  * @brief Creates a new empty queue whose nodes come from an allocator.
+  *
+  * @param[in] capacity Maximum number of items, or QUEUE_UNBOUNDED
+  * @param[in] p_alloc  Allocator for the queue and its nodes; NULL for
+  *                     malloc
+  *
+  * @return Pointer to newly created queue if successful, NULL if capacity
+  *         is negative or memory allocation fails
+  */
+ queue_t *
+ queue_create_ex(int capacity, const allocator_t *p_alloc)
+ {
+     if (capacity < 0)
+     {
+         return NULL;
+     }
+ 
+     queue_t *p_queue = ALLOC_ZEROED(p_alloc, 1, sizeof(queue_t));
+     if (NULL != p_queue)
+     {
+         p_queue->capacity = capacity;
+         p_queue->p_alloc = p_alloc;
+     }
+ 
+     return p_queue;
  }
  
  /*!
@@ -75,10 +110,10 @@
      {
          struct node *p_temp = p_current;  // Save current node 
          p_current = p_current->next;      // Move to next node 
-         free(p_temp);                     // Free saved node 
+         ALLOC_FREE((*p_queue)->p_alloc, p_temp); // Free saved node 
      }
  
-     free(*p_queue);
+     ALLOC_FREE((*p_queue)->p_alloc, *p_queue);
      *p_queue = NULL;
  }
  
@@ -95,13 +130,13 @@
  int
  queue_enqueue(queue_t * const p_queue, void * const p_item)
  {
-     if ((NULL == p_queue) || (NULL == p_item) || (p_queue->size >= MAX_QUEUE_SIZE))
+     if ((NULL == p_queue) || (NULL == p_item) || queue_is_full(p_queue))
      {
          return -1;
      }
  
      // Allocating and initialize new node
-     node_t *p_new_node = calloc(1, sizeof(node_t));
+     node_t *p_new_node = ALLOC_ZEROED(p_queue->p_alloc, 1, sizeof(node_t));
      if (NULL == p_new_node)
      {
          return -1;
@@ -160,7 +195,7 @@
          p_queue->p_rear = NULL;
      }
  
-     free(p_node_to_remove);
+     ALLOC_FREE(p_queue->p_alloc, p_node_to_remove);
      return 0;
  }
  
@@ -189,5 +224,19 @@
      return ((NULL == p_queue) || (0 == p_queue->size));
  }
  
+ /*!
+  * @brief Checks if the queue has reached its capacity.
+  *
+  * @param[in] p_queue Pointer to the queue
+  * @return true if queue is full or NULL, false otherwise
+  */
+ bool
+ queue_is_full(queue_t * const p_queue)
+ {
+     return ((NULL == p_queue)
+             || ((QUEUE_UNBOUNDED != p_queue->capacity)
+                 && (p_queue->size >= p_queue->capacity)));
+ }
+ 
   /*** end of file ***/
  
\ No newline at end of file
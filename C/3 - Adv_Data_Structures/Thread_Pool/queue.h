@@ -12,6 +12,17 @@
  #define QUEUE_H
 
  #include <stdbool.h>
+ #include "../../1 - Basic_Data_Structures/0 - Allocator/allocator.h"
+ 
+ /*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+ 
+ // Capacity used by queue_create() 
+ #define QUEUE_DEFAULT_CAPACITY (100)
+ 
+ // Capacity value that never refuses an item 
+ #define QUEUE_UNBOUNDED        (0)
  
  /*************************************************************************
  * Type Definitions
@@ -34,6 +45,32 @@
   */
  queue_t *queue_create(void);
  
+ /** 
+  * @brief Creates a new empty queue holding at most capacity items.
+  *
+  * queue_create() is queue_create_bounded(QUEUE_DEFAULT_CAPACITY).
+  *
+  * @param[in] capacity Maximum number of items, or QUEUE_UNBOUNDED
+  *
+  * @return Pointer to newly created queue or NULL if capacity is negative
+  *         or allocation fails
+  */
+ queue_t *queue_create_bounded(int capacity);
+ 
+ /** 
+  * @brief Creates a new empty queue whose nodes come from an allocator.
+  *
+  * queue_create_bounded() is queue_create_ex(capacity, NULL).
+  *
+  * @param[in] capacity Maximum number of items, or QUEUE_UNBOUNDED
+  * @param[in] p_alloc  Allocator for the queue and its nodes; NULL for
+  *                     malloc
+  *
+  * @return Pointer to newly created queue or NULL if capacity is negative
+  *         or allocation fails
+  */
+ queue_t *queue_create_ex(int capacity, const allocator_t *p_alloc);
+ 
  /** 
   * @brief Destroys a queue and frees all associated memory.
   *
@@ -79,6 +116,15 @@
   */
  bool queue_is_empty(queue_t *p_queue);
  
+ /**
+  * @brief Checks if queue has reached its capacity.
+  *
+  * @param[in] p_queue The queue to check
+  *
+  * @return true if full or NULL, false otherwise
+  */
+ bool queue_is_full(queue_t *p_queue);
+ 
  #endif /* QUEUE_H */
  
  /*** end of file ***/
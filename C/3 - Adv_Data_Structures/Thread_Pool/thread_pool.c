@@ -6,29 +6,47 @@
  * threads. Jobs can be submitted to the pool and will be executed by the next
  * available worker thread. The implementation is thread-safe and uses condition
  * variables for efficient thread synchronization.
+ *
+ * The job queue is bounded. What happens when it is full is chosen per pool
+ * (reject, block, caller-runs or drop-oldest), and workers can additionally
+ * shed jobs by queue age. Shedding follows the CoDel idea (Nichols and
+ * Jacobson, RFC 8289) as adapted for request queues: only a queue that has
+ * not drained for a whole interval counts as overloaded, and then jobs
+ * older than the short target are dropped instead of run.
  */
 
  #include "thread_pool.h"
  #include "queue.h"
+ #include <errno.h>
  #include <pthread.h>
  #include <stdlib.h>
+ #include <time.h>
  
  /*************************************************************************
  * Constants and Macros
  *************************************************************************/
  
- #define THREAD_POOL_SUCCESS        (0)
- #define THREAD_POOL_ERROR_PARAM    (-1)
- #define THREAD_POOL_ERROR_MEMORY   (-2)
- #define THREAD_POOL_ERROR_QUEUE    (-3)
- #define THREAD_POOL_ERROR_THREAD   (-4)
  #define THREAD_POOL_STATE_RUNNING  (1)
  #define THREAD_POOL_STATE_STOPPING (0)
  
+ #define NSEC_PER_MSEC              (1000000ull)
+ #define NSEC_PER_SEC               (1000000000ull)
+ #define CODEL_DEFAULT_INTERVAL_MS  (100)
+ #define SERVICE_EWMA_SHIFT         (3)   // Each new run time weighs 1/8
+ 
  /*************************************************************************
  * Private Data Structures
  *************************************************************************/
  
+ /**
+  * @brief Queued copy of a submitted job.
+  */
+ typedef struct pool_job
+ {
+     thread_job_t job;          // Job as submitted
+     uint64_t     enqueued_ns;  // Monotonic time it entered the queue
+ } pool_job_t;
+ 
  /**
   * @brief Internal structure representing the thread pool.
   *
@@ -37,12 +55,17 @@
   */
  struct thread_pool
  {
-     int             num_threads;    // Number of worker threads 
-     int             state;          // Current pool state (running/stopping) 
-     queue_t *       p_queue;        // Queue of pending jobs 
-     pthread_t *     p_threads;      // Array of worker thread handles 
-     pthread_mutex_t pool_lock;      // Mutex for thread synchronization 
-     pthread_cond_t  signal;         // Condition variable for worker notification 
+     int                  num_threads;    // Number of worker threads
+     int                  state;          // Current pool state (running/stopping)
+     thread_pool_config_t config;         // Queue sizing and overload policy
+     queue_t *            p_queue;        // Queue of pending jobs
+     pthread_t *          p_threads;      // Array of worker thread handles
+     pthread_mutex_t      pool_lock;      // Mutex for thread synchronization
+     pthread_cond_t       signal;         // Condition variable for worker notification
+     pthread_cond_t       space;          // Signalled when a job leaves the queue
+     thread_pool_stats_t  stats;          // Admission counters
+     uint64_t             service_ns;     // Moving average of job run time
+     uint64_t             last_empty_ns;  // Last time the queue was seen empty
  };
  
  /*************************************************************************
@@ -60,6 +83,13 @@
   */
  static void * thread_pool_worker(void * p_arg);
  
+ static int      wait_for_space(thread_pool_t * p_pool);
+ static bool     codel_should_drop(thread_pool_t *    p_pool,
+                                   const pool_job_t * p_job,
+                                   uint64_t           now);
+ static void     drop_job(thread_pool_t * p_pool, pool_job_t * p_job);
+ static uint64_t now_ns(void);
+ 
  /*************************************************************************
  * Public Functions
  *************************************************************************/
@@ -68,14 +98,16 @@
   * @brief Submits a new job to be executed by the thread pool.
   *
   * This function adds a new job to the pool's job queue. The job will be
-  * executed by the next available worker thread.
+  * executed by the next available worker thread. If the queue is full the
+  * pool's policy decides between refusing, waiting, running the job on the
+  * caller, or evicting the oldest queued job.
   *
   * @param[in] p_pool Pointer to the thread pool
   * @param[in] p_job  Pointer to the job structure containing function and args
   *
   * @return THREAD_POOL_SUCCESS on success, negative error code on failure
   */
- int 
+ int
  thread_pool_submit(thread_pool_t * const p_pool, thread_job_t * const p_job)
  {
      // Validate input parameters
@@ -85,46 +117,102 @@
      }
  
      // Allocate memory for job copy
-     thread_job_t * p_new_job = malloc(sizeof(thread_job_t));
+     pool_job_t * p_new_job = malloc(sizeof(pool_job_t));
      if (NULL == p_new_job)
      {
          return THREAD_POOL_ERROR_MEMORY;
      }
  
      // Copy job data
-     *p_new_job = *p_job;
+     p_new_job->job = *p_job;
  
      pthread_mutex_lock(&p_pool->pool_lock);
  
+     int          result    = THREAD_POOL_SUCCESS;
+     bool         b_inline  = false;
+     pool_job_t * p_evicted = NULL;
+ 
+     if (THREAD_POOL_POLICY_BLOCK == p_pool->config.policy)
+     {
+         result = wait_for_space(p_pool);
+     }
+ 
      // Check if pool is still running
      if (THREAD_POOL_STATE_RUNNING != p_pool->state)
      {
-         pthread_mutex_unlock(&p_pool->pool_lock);
-         free(p_new_job);
-         return THREAD_POOL_ERROR_QUEUE;
+         result = THREAD_POOL_ERROR_QUEUE;
+     }
+     else if ((THREAD_POOL_SUCCESS == result) && queue_is_full(p_pool->p_queue))
+     {
+         switch (p_pool->config.policy)
+         {
+             case THREAD_POOL_POLICY_CALLER_RUNS:
+                 p_pool->stats.caller_runs++;
+                 b_inline = true;
+                 break;
+ 
+             case THREAD_POOL_POLICY_DROP_OLDEST:
+                 queue_dequeue(p_pool->p_queue, (void **)&p_evicted);
+                 p_pool->stats.dropped++;
+                 break;
+ 
+             default:
+                 p_pool->stats.rejected++;
+                 result = THREAD_POOL_ERROR_BUSY;
+                 break;
+         }
      }
  
      // Add job to queue
-     int result = queue_enqueue(p_pool->p_queue, p_new_job);
-     if (0 != result)
+     if ((THREAD_POOL_SUCCESS == result) && !b_inline)
      {
-         pthread_mutex_unlock(&p_pool->pool_lock);
-         free(p_new_job);
-         return THREAD_POOL_ERROR_QUEUE;
+         p_new_job->enqueued_ns = now_ns();
+ 
+         // A job entering an empty queue starts a burst, which gets a whole
+         // interval to drain however long the queue sat idle before it
+         if (queue_is_empty(p_pool->p_queue))
+         {
+             p_pool->last_empty_ns = p_new_job->enqueued_ns;
+         }
+ 
+         if (0 != queue_enqueue(p_pool->p_queue, p_new_job))
+         {
+             result = THREAD_POOL_ERROR_QUEUE;
+         }
+         else
+         {
+             // Signal waiting worker threads
+             p_pool->stats.submitted++;
+             pthread_cond_signal(&p_pool->signal);
+         }
      }
  
-     // Signal waiting worker threads
-     pthread_cond_signal(&p_pool->signal);
      pthread_mutex_unlock(&p_pool->pool_lock);
  
-     return THREAD_POOL_SUCCESS;
+     if (NULL != p_evicted)
+     {
+         drop_job(p_pool, p_evicted);
+     }
+ 
+     // Caller-runs slows the producer down to the rate the pool can absorb
+     if (b_inline)
+     {
+         p_new_job->job.job_fn(p_new_job->job.p_arg);
+     }
+ 
+     if ((THREAD_POOL_SUCCESS != result) || b_inline)
+     {
+         free(p_new_job);
+     }
+ 
+     return result;
  }
  
  /*!
   * @brief Initializes a new thread pool with specified number of worker threads.
   *
-  * Creates and initializes a thread pool with the given number of worker threads.
-  * Sets up the job queue and synchronization primitives.
+  * Creates and initializes a thread pool with the given number of worker threads
+  * and the default configuration from thread_pool_config_default().
   *
   * @param[in] num_threads Number of worker threads to create (must be > 0)
   *
@@ -133,11 +221,61 @@
  thread_pool_t *
  thread_pool_initialize(int num_threads)
  {
-     if (num_threads <= 0)
+     thread_pool_config_t config = thread_pool_config_default(num_threads);
+     return thread_pool_initialize_ex(&config);
+ }
+ 
+ /*!
+  * @brief Gets the configuration used by thread_pool_initialize().
+  *
+  * @param[in] num_threads Number of worker threads
+  *
+  * @return Default configuration
+  */
+ thread_pool_config_t
+ thread_pool_config_default(int num_threads)
+ {
+     thread_pool_config_t config = {
+         .num_threads       = num_threads,
+         .queue_capacity    = THREAD_POOL_DEFAULT_CAPACITY,
+         .policy            = THREAD_POOL_POLICY_REJECT,
+         .block_timeout_ms  = -1,
+         .codel_target_ms   = 0,
+         .codel_interval_ms = CODEL_DEFAULT_INTERVAL_MS,
+         .on_drop           = NULL,
+         .p_drop_ctx        = NULL,
+         .p_alloc           = NULL
+     };
+ 
+     return config;
+ }
+ 
+ /*!
+  * @brief Initializes a new thread pool from an explicit configuration.
+  *
+  * Sets up the bounded job queue, synchronization primitives and worker
+  * threads.
+  *
+  * @param[in] p_config Pool configuration
+  *
+  * @return Pointer to initialized thread pool or NULL on failure
+  */
+ thread_pool_t *
+ thread_pool_initialize_ex(const thread_pool_config_t * const p_config)
+ {
+     if ((NULL == p_config) || (p_config->num_threads <= 0)
+         || (p_config->queue_capacity < 0)
+         || (p_config->policy < THREAD_POOL_POLICY_REJECT)
+         || (p_config->policy > THREAD_POOL_POLICY_DROP_OLDEST)
+         || (p_config->codel_target_ms < 0)
+         || ((p_config->codel_target_ms > 0)
+             && (p_config->codel_interval_ms <= 0)))
      {
          return NULL;
      }
  
+     int num_threads = p_config->num_threads;
+ 
      // Allocate thread pool structure
      thread_pool_t * p_pool = calloc(1, sizeof(thread_pool_t));
      if (NULL == p_pool)
@@ -148,9 +286,12 @@
      // Initialize basic members
      p_pool->num_threads = num_threads;
      p_pool->state = THREAD_POOL_STATE_RUNNING;
-     
+     p_pool->config = *p_config;
+     p_pool->last_empty_ns = now_ns();
+ 
      // Create job queue
-     p_pool->p_queue = queue_create();
+     p_pool->p_queue = queue_create_ex(p_config->queue_capacity,
+                                       p_config->p_alloc);
      if (NULL == p_pool->p_queue)
      {
          free(p_pool);
@@ -165,19 +306,43 @@
          return NULL;
      }
  
-     // Initialize condition variable
+     // Initialize condition variables; blocked submits time out on the
+     // monotonic clock so wall clock changes do not stretch the timeout
+     pthread_condattr_t attr;
+     if (0 != pthread_condattr_init(&attr))
+     {
+         pthread_mutex_destroy(&p_pool->pool_lock);
+         queue_destroy(&p_pool->p_queue);
+         free(p_pool);
+         return NULL;
+     }
+     pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+ 
      if (0 != pthread_cond_init(&p_pool->signal, NULL))
      {
+         pthread_condattr_destroy(&attr);
          pthread_mutex_destroy(&p_pool->pool_lock);
          queue_destroy(&p_pool->p_queue);
          free(p_pool);
          return NULL;
      }
  
+     if (0 != pthread_cond_init(&p_pool->space, &attr))
+     {
+         pthread_condattr_destroy(&attr);
+         pthread_cond_destroy(&p_pool->signal);
+         pthread_mutex_destroy(&p_pool->pool_lock);
+         queue_destroy(&p_pool->p_queue);
+         free(p_pool);
+         return NULL;
+     }
+     pthread_condattr_destroy(&attr);
+ 
      // Allocate thread handles array
      p_pool->p_threads = calloc(num_threads, sizeof(pthread_t));
      if (NULL == p_pool->p_threads)
      {
+         pthread_cond_destroy(&p_pool->space);
          pthread_cond_destroy(&p_pool->signal);
          pthread_mutex_destroy(&p_pool->pool_lock);
          queue_destroy(&p_pool->p_queue);
@@ -188,12 +353,14 @@
      // Create worker threads
      for (int idx = 0; idx < num_threads; idx++)
      {
-         if (0 != pthread_create(&p_pool->p_threads[idx], NULL, 
+         if (0 != pthread_create(&p_pool->p_threads[idx], NULL,
                                thread_pool_worker, p_pool))
          {
              // Thread creation failed - clean up
+             pthread_mutex_lock(&p_pool->pool_lock);
              p_pool->state = THREAD_POOL_STATE_STOPPING;
              pthread_cond_broadcast(&p_pool->signal);
+             pthread_mutex_unlock(&p_pool->pool_lock);
  
              // Wait for already created threads
              for (int j = 0; j < idx; j++)
@@ -203,6 +370,7 @@
  
              // Free resources
              free(p_pool->p_threads);
+             pthread_cond_destroy(&p_pool->space);
              pthread_cond_destroy(&p_pool->signal);
              pthread_mutex_destroy(&p_pool->pool_lock);
              queue_destroy(&p_pool->p_queue);
@@ -218,7 +386,8 @@
   * @brief Shuts down the thread pool and waits for all worker threads to complete.
   *
   * Initiates an orderly shutdown of the thread pool. Sets the pool state to
-  * stopping and waits for all worker threads to complete their current jobs.
+  * stopping, wakes submitters blocked on a full queue, and waits for all worker
+  * threads to complete the jobs already queued.
   *
   * @param[in] p_pool Pointer to the thread pool
   *
@@ -235,6 +404,7 @@
      pthread_mutex_lock(&p_pool->pool_lock);
      p_pool->state = THREAD_POOL_STATE_STOPPING;
      pthread_cond_broadcast(&p_pool->signal);
+     pthread_cond_broadcast(&p_pool->space);
      pthread_mutex_unlock(&p_pool->pool_lock);
  
      // Wait for all threads to complete
@@ -251,7 +421,7 @@
   *
   * Cleans up all resources allocated by the thread pool including the job queue,
   * synchronization primitives, and thread handles. The pool should be shut down
-  * before calling this function.
+  * before calling this function. Jobs still queued are passed to on_drop.
   *
   * @param[in] p_pool Pointer to the thread pool to destroy
   */
@@ -264,17 +434,18 @@
      }
  
      // Free any remaining jobs in queue
-     thread_job_t * p_job = NULL;
+     pool_job_t * p_job = NULL;
      while (0 == queue_dequeue(p_pool->p_queue, (void **)&p_job))
      {
          if (NULL != p_job)
          {
-             free(p_job);
+             drop_job(p_pool, p_job);
          }
      }
  
      // Free all resources
      free(p_pool->p_threads);
+     pthread_cond_destroy(&p_pool->space);
      pthread_cond_destroy(&p_pool->signal);
      pthread_mutex_destroy(&p_pool->pool_lock);
      queue_destroy(&p_pool->p_queue);
@@ -329,6 +500,63 @@
      return running;
  }
  
+ /*!
+  * @brief Estimates how long a refused caller should wait before retrying.
+  *
+  * The queue plus the refused job, spread over all workers, at the moving
+  * average job run time.
+  *
+  * @param[in] p_pool Pointer to the thread pool
+  *
+  * @return Suggested delay in milliseconds (at least 1), or negative error code
+  */
+ int
+ thread_pool_retry_after_ms(thread_pool_t * const p_pool)
+ {
+     if (NULL == p_pool)
+     {
+         return THREAD_POOL_ERROR_PARAM;
+     }
+ 
+     pthread_mutex_lock(&p_pool->pool_lock);
+     uint64_t backlog = (uint64_t)queue_size(p_pool->p_queue) + 1;
+     uint64_t wait_ns = (backlog * p_pool->service_ns)
+                        / (uint64_t)p_pool->num_threads;
+     pthread_mutex_unlock(&p_pool->pool_lock);
+ 
+     uint64_t wait_ms = (wait_ns + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC;
+     if (wait_ms < 1)
+     {
+         wait_ms = 1;
+     }
+ 
+     return (wait_ms > (uint64_t)INT32_MAX) ? INT32_MAX : (int)wait_ms;
+ }
+ 
+ /*!
+  * @brief Copies the pool's admission counters.
+  *
+  * @param[in]  p_pool  Pointer to the thread pool
+  * @param[out] p_stats Counters
+  *
+  * @return THREAD_POOL_SUCCESS on success, negative error code on failure
+  */
+ int
+ thread_pool_get_stats(thread_pool_t * const       p_pool,
+                       thread_pool_stats_t * const p_stats)
+ {
+     if ((NULL == p_pool) || (NULL == p_stats))
+     {
+         return THREAD_POOL_ERROR_PARAM;
+     }
+ 
+     pthread_mutex_lock(&p_pool->pool_lock);
+     *p_stats = p_pool->stats;
+     pthread_mutex_unlock(&p_pool->pool_lock);
+ 
+     return THREAD_POOL_SUCCESS;
+ }
+ 
  /*************************************************************************
  * Private Functions
  *************************************************************************/
@@ -338,6 +566,7 @@
   *
   * Main function for worker threads. Continuously monitors the job queue and
   * executes jobs when available. Exits when pool is stopping and queue is empty.
+  * A job that CoDel picks for shedding is handed to on_drop instead of run.
   *
   * @param[in] p_arg Pointer to the thread pool structure
   *
@@ -347,6 +576,8 @@
  thread_pool_worker(void * const p_arg)
  {
      thread_pool_t * const p_pool = (thread_pool_t *)p_arg;
+     uint64_t              ran_ns = 0;
+     bool                  b_ran  = false;
  
      if (NULL == p_pool)
      {
@@ -357,15 +588,24 @@
      {
          pthread_mutex_lock(&p_pool->pool_lock);
  
+         // Account for the previous job while holding the lock anyway
+         if (b_ran)
+         {
+             int64_t error = (int64_t)ran_ns - (int64_t)p_pool->service_ns;
+             p_pool->service_ns += (uint64_t)(error / (1 << SERVICE_EWMA_SHIFT));
+             p_pool->stats.completed++;
+             b_ran = false;
+         }
+ 
          // Wait while pool is running but no jobs available
-         while ((THREAD_POOL_STATE_RUNNING == p_pool->state) && 
+         while ((THREAD_POOL_STATE_RUNNING == p_pool->state) &&
                 (queue_is_empty(p_pool->p_queue)))
          {
              pthread_cond_wait(&p_pool->signal, &p_pool->pool_lock);
          }
  
          // Exit if pool is stopping and no more jobs
-         if ((THREAD_POOL_STATE_RUNNING != p_pool->state) && 
+         if ((THREAD_POOL_STATE_RUNNING != p_pool->state) &&
              (queue_is_empty(p_pool->p_queue)))
          {
              pthread_mutex_unlock(&p_pool->pool_lock);
@@ -373,18 +613,35 @@
          }
  
          // Get next job from queue
-         thread_job_t * p_job = NULL;
+         pool_job_t * p_job = NULL;
          int result = queue_dequeue(p_pool->p_queue, (void **)&p_job);
+         bool b_shed = false;
+ 
+         if ((0 == result) && (NULL != p_job))
+         {
+             pthread_cond_signal(&p_pool->space);
+             b_shed = codel_should_drop(p_pool, p_job, now_ns());
+             if (b_shed)
+             {
+                 p_pool->stats.shed++;
+             }
+         }
  
          pthread_mutex_unlock(&p_pool->pool_lock);
  
          // Execute job if dequeue successful
          if ((0 == result) && (NULL != p_job))
          {
-             if (NULL != p_job->job_fn)
+             if (b_shed)
              {
-                 p_job->job_fn(p_job->p_arg);
+                 drop_job(p_pool, p_job);
+                 continue;
              }
+ 
+             uint64_t start = now_ns();
+             p_job->job.job_fn(p_job->job.p_arg);
+             ran_ns = now_ns() - start;
+             b_ran = true;
              free(p_job);
          }
      }
@@ -392,4 +649,111 @@
      return NULL;
  }
  
+ /*!
+  * @brief Waits, with the pool lock held, until the queue has room.
+  *
+  * @param[in] p_pool Pointer to the thread pool
+  *
+  * @return THREAD_POOL_SUCCESS once there is room or the pool stops,
+  *         THREAD_POOL_ERROR_TIMEOUT if block_timeout_ms passes first
+  */
+ static int
+ wait_for_space(thread_pool_t * const p_pool)
+ {
+     int             timeout_ms = p_pool->config.block_timeout_ms;
+     struct timespec deadline;
+ 
+     if (timeout_ms >= 0)
+     {
+         clock_gettime(CLOCK_MONOTONIC, &deadline);
+         uint64_t nsec = (uint64_t)deadline.tv_nsec
+                         + ((uint64_t)timeout_ms * NSEC_PER_MSEC);
+         deadline.tv_sec += (time_t)(nsec / NSEC_PER_SEC);
+         deadline.tv_nsec = (long)(nsec % NSEC_PER_SEC);
+     }
+ 
+     while ((THREAD_POOL_STATE_RUNNING == p_pool->state)
+            && queue_is_full(p_pool->p_queue))
+     {
+         if (timeout_ms < 0)
+         {
+             pthread_cond_wait(&p_pool->space, &p_pool->pool_lock);
+         }
+         else if ((ETIMEDOUT == pthread_cond_timedwait(&p_pool->space,
+                                                        &p_pool->pool_lock,
+                                                        &deadline))
+                  && queue_is_full(p_pool->p_queue))
+         {
+             p_pool->stats.timed_out++;
+             return THREAD_POOL_ERROR_TIMEOUT;
+         }
+     }
+ 
+     return THREAD_POOL_SUCCESS;
+ }
+ 
+ /*!
+  * @brief Decides, with the pool lock held, whether to shed a dequeued job.
+  *
+  * A queue that was empty within the last interval, because a dequeue
+  * drained it or because a submit found it so, is absorbing a burst and
+  * only jobs older than a whole interval are dropped. A queue that has not
+  * been empty for longer than that holds a standing backlog; its jobs get
+  * the short target instead, so the pool spends its time on recent work.
+  *
+  * @param[in,out] p_pool Pointer to the thread pool
+  * @param[in]     p_job  Job just taken from the queue
+  * @param[in]     now    Current monotonic time in nanoseconds
+  *
+  * @return true if the job should be dropped instead of run
+  */
+ static bool
+ codel_should_drop(thread_pool_t * const    p_pool,
+                   const pool_job_t * const p_job,
+                   uint64_t                 now)
+ {
+     uint64_t target   = (uint64_t)p_pool->config.codel_target_ms * NSEC_PER_MSEC;
+     uint64_t interval = (uint64_t)p_pool->config.codel_interval_ms * NSEC_PER_MSEC;
+ 
+     if (0 == target)
+     {
+         return false;
+     }
+ 
+     uint64_t limit = ((now - p_pool->last_empty_ns) > interval) ? target : interval;
+     bool     b_old = ((now - p_job->enqueued_ns) > limit);
+ 
+     if (queue_is_empty(p_pool->p_queue))
+     {
+         p_pool->last_empty_ns = now;
+     }
+ 
+     return b_old;
+ }
+ 
+ /*!
+  * @brief Hands a discarded job to on_drop and frees it.
+  *
+  * @param[in] p_pool Pointer to the thread pool
+  * @param[in] p_job  Job removed from the queue
+  */
+ static void
+ drop_job(thread_pool_t * const p_pool, pool_job_t * const p_job)
+ {
+     if (NULL != p_pool->config.on_drop)
+     {
+         p_pool->config.on_drop(&p_job->job, p_pool->config.p_drop_ctx);
+     }
+ 
+     free(p_job);
+ }
+ 
+ static uint64_t
+ now_ns(void)
+ {
+     struct timespec now;
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+ }
+ 
  /*** end of file ***/
\ No newline at end of file
@@ -12,6 +12,23 @@
  #define THREAD_POOL_H
  
  #include <stdbool.h>
+ #include <stdint.h>
+ #include "../../1 - Basic_Data_Structures/0 - Allocator/allocator.h"
+ 
+ /*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+ 
+ #define THREAD_POOL_SUCCESS          (0)
+ #define THREAD_POOL_ERROR_PARAM      (-1)
+ #define THREAD_POOL_ERROR_MEMORY     (-2)
+ #define THREAD_POOL_ERROR_QUEUE      (-3)  // Pool is not running 
+ #define THREAD_POOL_ERROR_THREAD     (-4)
+ #define THREAD_POOL_ERROR_BUSY       (-5)  // Queue full; see retry_after 
+ #define THREAD_POOL_ERROR_TIMEOUT    (-6)  // Blocked submit ran out of time 
+ 
+ // Queue capacity used by thread_pool_initialize() 
+ #define THREAD_POOL_DEFAULT_CAPACITY (100)
  
  /*************************************************************************
  * Type Definitions
@@ -27,6 +44,46 @@
      void * p_arg;                    // Job function argument 
  } thread_job_t;
  
+ // What thread_pool_submit does when the queue is full 
+ typedef enum thread_pool_policy
+ {
+     THREAD_POOL_POLICY_REJECT = 0,   // Fail with THREAD_POOL_ERROR_BUSY 
+     THREAD_POOL_POLICY_BLOCK,        // Wait up to block_timeout_ms for room 
+     THREAD_POOL_POLICY_CALLER_RUNS,  // Run the job on the submitting thread 
+     THREAD_POOL_POLICY_DROP_OLDEST   // Discard the oldest queued job 
+ } thread_pool_policy_t;
+ 
+ // Called, outside the pool lock, with every job the pool discards 
+ typedef void (*thread_pool_drop_fn_t)(const thread_job_t * p_job,
+                                       void *               p_ctx);
+ 
+ // Pool sizing and overload behaviour for thread_pool_initialize_ex 
+ typedef struct thread_pool_config
+ {
+     int                   num_threads;       // Worker threads (> 0) 
+     int                   queue_capacity;    // Max queued jobs, 0 = no cap 
+     thread_pool_policy_t  policy;            // Full-queue behaviour 
+     int                   block_timeout_ms;  // BLOCK only; < 0 waits forever 
+     int                   codel_target_ms;   // Queue delay goal, 0 = off 
+     int                   codel_interval_ms; // Time over goal before shedding 
+     thread_pool_drop_fn_t on_drop;           // Optional; frees dropped jobs 
+     void *                p_drop_ctx;        // Passed to on_drop 
+     const allocator_t *   p_alloc;           // Queue nodes, NULL = malloc;
+                                              // called under the pool lock 
+ } thread_pool_config_t;
+ 
+ // Counters since the pool was created 
+ typedef struct thread_pool_stats
+ {
+     uint64_t submitted;    // Jobs accepted into the queue 
+     uint64_t completed;    // Jobs run by workers 
+     uint64_t rejected;     // REJECT refusals 
+     uint64_t timed_out;    // BLOCK submits that gave up 
+     uint64_t caller_runs;  // Jobs run by the submitting thread 
+     uint64_t dropped;      // Jobs evicted by DROP_OLDEST 
+     uint64_t shed;         // Jobs discarded for waiting too long (CoDel) 
+ } thread_pool_stats_t;
+ 
  /*************************************************************************
  * Function Declarations
  *************************************************************************/
@@ -34,6 +91,8 @@
  /*!
   * @brief Creates and initializes a thread pool.
   *
+  * Same as thread_pool_initialize_ex() with thread_pool_config_default().
+  *
   * @param[in] num_threads Number of worker threads to create
   *
   * @return Pointer to created thread pool if successful, NULL if failure
@@ -41,9 +100,49 @@
  thread_pool_t * 
  thread_pool_initialize(int num_threads);
  
+ /*!
+  * @brief Gets the configuration used by thread_pool_initialize().
+  *
+  * THREAD_POOL_DEFAULT_CAPACITY queued jobs, REJECT policy, no load
+  * shedding.
+  *
+  * @param[in] num_threads Number of worker threads
+  *
+  * @return Default configuration
+  */
+ thread_pool_config_t
+ thread_pool_config_default(int num_threads);
+ 
+ /*!
+  * @brief Creates a thread pool with explicit queue sizing and overload
+  *        policy.
+  *
+  * With codel_target_ms set, workers shed jobs by how long they have
+  * queued, following CoDel: while the queue has been empty at least once
+  * in the last codel_interval_ms, including just before the first job of
+  * a burst went in, only jobs that waited a whole interval are dropped, so
+  * bursts are absorbed. Once it has stayed non-empty for longer
+  * than that, the backlog is standing and jobs that waited more than
+  * codel_target_ms are dropped instead of run, keeping the delay of the
+  * jobs that do run near the target. Dropped jobs go to on_drop.
+  *
+  * @param[in] p_config Pool configuration
+  *
+  * @return Pointer to created thread pool if successful, NULL if failure
+  */
+ thread_pool_t *
+ thread_pool_initialize_ex(const thread_pool_config_t * p_config);
+ 
  /*!
   * @brief Submits a job to be executed by the thread pool.
   *
+  * When the queue is full the configured policy applies: REJECT returns
+  * THREAD_POOL_ERROR_BUSY, BLOCK waits for room and returns
+  * THREAD_POOL_ERROR_TIMEOUT if none frees up in time, CALLER_RUNS runs
+  * the job before returning, and DROP_OLDEST hands the oldest queued job
+  * to on_drop to make room. THREAD_POOL_ERROR_QUEUE means only that the
+  * pool is not running; a full queue no longer returns it.
+  *
   * @param[in] p_pool Pointer to thread pool
   * @param[in] p_job Pointer to job structure
   *
@@ -90,6 +189,31 @@
  bool 
  thread_pool_is_running(thread_pool_t * p_pool);
  
+ /*!
+  * @brief Estimates how long a refused caller should wait before retrying.
+  *
+  * The hint is the time the workers need to drain the current queue at
+  * the recent average job duration.
+  *
+  * @param[in] p_pool Pointer to thread pool
+  *
+  * @return Suggested delay in milliseconds (at least 1), or negative error
+  *         code
+  */
+ int
+ thread_pool_retry_after_ms(thread_pool_t * p_pool);
+ 
+ /*!
+  * @brief Copies the pool's admission counters.
+  *
+  * @param[in]  p_pool  Pointer to thread pool
+  * @param[out] p_stats Counters
+  *
+  * @return 0 on success, negative error code on failure
+  */
+ int
+ thread_pool_get_stats(thread_pool_t * p_pool, thread_pool_stats_t * p_stats);
+ 
  #endif /* THREAD_POOL_H */
 
 /*** end of file ***/
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "thread_pool.h"
+
+// Sleeps for the number of milliseconds its argument points at
+static void *
+sleep_job(void * p_arg)
+{
+    int             ms   = *(const int *)p_arg;
+    struct timespec wait = { ms / 1000, (long)(ms % 1000) * 1000000L };
+
+    nanosleep(&wait, NULL);
+    return NULL;
+}
+
+// Spins until the flag its argument points at is set
+static void *
+gate_job(void * p_arg)
+{
+    struct timespec wait = { 0, 1000000L };
+
+    while (!__atomic_load_n((bool *)p_arg, __ATOMIC_ACQUIRE))
+    {
+        nanosleep(&wait, NULL);
+    }
+
+    return NULL;
+}
+
+static void
+sleep_ms(int ms)
+{
+    struct timespec wait = { ms / 1000, (long)(ms % 1000) * 1000000L };
+
+    nanosleep(&wait, NULL);
+}
+
+static thread_pool_config_t
+codel_config(int target_ms, int interval_ms)
+{
+    thread_pool_config_t config = thread_pool_config_default(1);
+
+    config.codel_target_ms   = target_ms;
+    config.codel_interval_ms = interval_ms;
+
+    return config;
+}
+
+START_TEST(test_codel_absorbs_burst_after_idle)
+{
+    // One long job keeps the worker busy while the queue sits empty; a
+    // burst arriving near its end must get the interval, not the target
+    thread_pool_config_t config = codel_config(5, 100);
+    thread_pool_t *      p_pool = thread_pool_initialize_ex(&config);
+    int                  long_ms  = 300;
+    int                  short_ms = 2;
+    thread_job_t         long_job  = { sleep_job, &long_ms };
+    thread_job_t         short_job = { sleep_job, &short_ms };
+
+    ck_assert_ptr_nonnull(p_pool);
+    ck_assert_int_eq(thread_pool_submit(p_pool, &long_job), THREAD_POOL_SUCCESS);
+    sleep_ms(280);
+
+    for (int idx = 0; idx < 20; idx++)
+    {
+        ck_assert_int_eq(thread_pool_submit(p_pool, &short_job),
+                         THREAD_POOL_SUCCESS);
+    }
+
+    ck_assert_int_eq(thread_pool_shutdown(p_pool), THREAD_POOL_SUCCESS);
+
+    thread_pool_stats_t stats;
+    ck_assert_int_eq(thread_pool_get_stats(p_pool, &stats), THREAD_POOL_SUCCESS);
+    ck_assert_uint_eq(stats.completed, 21);
+    ck_assert_uint_eq(stats.shed, 0);
+
+    thread_pool_destroy(p_pool);
+}
+END_TEST
+
+START_TEST(test_codel_sheds_standing_backlog)
+{
+    // 40 x 10 ms of work queued at once keeps the queue non-empty well past
+    // the 50 ms interval, after which jobs older than 5 ms are dropped
+    thread_pool_config_t config = codel_config(5, 50);
+    thread_pool_t *      p_pool = thread_pool_initialize_ex(&config);
+    int                  ms     = 10;
+    thread_job_t         job    = { sleep_job, &ms };
+
+    ck_assert_ptr_nonnull(p_pool);
+
+    for (int idx = 0; idx < 40; idx++)
+    {
+        ck_assert_int_eq(thread_pool_submit(p_pool, &job), THREAD_POOL_SUCCESS);
+    }
+
+    ck_assert_int_eq(thread_pool_shutdown(p_pool), THREAD_POOL_SUCCESS);
+
+    thread_pool_stats_t stats;
+    ck_assert_int_eq(thread_pool_get_stats(p_pool, &stats), THREAD_POOL_SUCCESS);
+    ck_assert_uint_gt(stats.shed, 0);
+    ck_assert_uint_gt(stats.completed, 0);
+    ck_assert_uint_eq(stats.completed + stats.shed, 40);
+
+    thread_pool_destroy(p_pool);
+}
+END_TEST
+
+START_TEST(test_reject_returns_busy)
+{
+    thread_pool_config_t config = thread_pool_config_default(1);
+    bool                 b_open = false;
+    int                  ms     = 1;
+    thread_job_t         gate   = { gate_job, &b_open };
+    thread_job_t         job    = { sleep_job, &ms };
+
+    config.queue_capacity = 1;
+
+    thread_pool_t * p_pool = thread_pool_initialize_ex(&config);
+    ck_assert_ptr_nonnull(p_pool);
+
+    // Once the worker holds the gate, one job fills the queue
+    ck_assert_int_eq(thread_pool_submit(p_pool, &gate), THREAD_POOL_SUCCESS);
+    while (0 != thread_pool_get_queue_size(p_pool))
+    {
+        sleep_ms(1);
+    }
+
+    ck_assert_int_eq(thread_pool_submit(p_pool, &job), THREAD_POOL_SUCCESS);
+    ck_assert_int_eq(thread_pool_submit(p_pool, &job), THREAD_POOL_ERROR_BUSY);
+    ck_assert_int_ge(thread_pool_retry_after_ms(p_pool), 1);
+
+    __atomic_store_n(&b_open, true, __ATOMIC_RELEASE);
+    ck_assert_int_eq(thread_pool_shutdown(p_pool), THREAD_POOL_SUCCESS);
+
+    thread_pool_stats_t stats;
+    ck_assert_int_eq(thread_pool_get_stats(p_pool, &stats), THREAD_POOL_SUCCESS);
+    ck_assert_uint_eq(stats.rejected, 1);
+    ck_assert_uint_eq(stats.completed, 2);
+
+    // A stopped pool refuses with ERROR_QUEUE, not ERROR_BUSY
+    ck_assert_int_eq(thread_pool_submit(p_pool, &job), THREAD_POOL_ERROR_QUEUE);
+
+    thread_pool_destroy(p_pool);
+}
+END_TEST
+
+START_TEST(test_queue_nodes_come_from_allocator)
+{
+    alloc_tracker_t *    p_tracker = alloc_tracker_create(NULL, 0);
+    thread_pool_config_t config    = thread_pool_config_default(1);
+    bool                 b_open    = false;
+    int                  ms        = 1;
+    thread_job_t         gate      = { gate_job, &b_open };
+    thread_job_t         job       = { sleep_job, &ms };
+    alloc_stats_t        stats;
+
+    config.p_alloc = alloc_tracker_allocator(p_tracker);
+
+    thread_pool_t * p_pool = thread_pool_initialize_ex(&config);
+    ck_assert_ptr_nonnull(p_pool);
+
+    // The queue itself, then one node per job waiting behind the gate
+    ck_assert_int_eq(thread_pool_submit(p_pool, &gate), THREAD_POOL_SUCCESS);
+    while (0 != thread_pool_get_queue_size(p_pool))
+    {
+        sleep_ms(1);
+    }
+    for (int idx = 0; idx < 3; idx++)
+    {
+        ck_assert_int_eq(thread_pool_submit(p_pool, &job), THREAD_POOL_SUCCESS);
+    }
+
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.allocs, 5);
+    ck_assert_uint_eq(stats.frees, 1);
+
+    __atomic_store_n(&b_open, true, __ATOMIC_RELEASE);
+    ck_assert_int_eq(thread_pool_shutdown(p_pool), THREAD_POOL_SUCCESS);
+    thread_pool_destroy(p_pool);
+
+    alloc_tracker_stats(p_tracker, &stats);
+    ck_assert_uint_eq(stats.frees, stats.allocs);
+    ck_assert_uint_eq(stats.live_bytes, 0);
+
+    alloc_tracker_destroy(&p_tracker);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+thread_pool_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Thread_Pool");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_codel_absorbs_burst_after_idle);
+    tcase_add_test(tc_core, test_codel_sheds_standing_backlog);
+    tcase_add_test(tc_core, test_reject_returns_busy);
+    tcase_add_test(tc_core, test_queue_nodes_come_from_allocator);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = thread_pool_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -11,6 +11,7 @@
  #include <string.h>
  #include <unistd.h>
  #include "worker.h"
+ #include "image_stream.h"
  #include "server_message.h"
  #include "syslog.h"
  #include "initialize.h"
@@ -29,6 +30,8 @@
      char              suffix[SUFFIX_BUFFER_SIZE]; 
      pthread_mutex_t * client_turn_lock;
      int               socket_fd;
+     client_mux_t *    p_mux;
+     image_stream_t *  p_stream;
      const char *      dictionary;
  } thread_worker_data_t;
  
@@ -37,16 +40,41 @@
  *************************************************************************/
 
 /**
- * @brief Process a message received from the bartender
+ * @brief Creates a reply stream and registers it for cleanup
  *
- * @param[in] data Worker thread data
- * @param[in] message_buffer Buffer containing the message to process
- * @param[out] decoded_buffer Buffer for decoded image data
- * @return true if processing should continue, false if we should stop receiving
+ * @param[in] dictionary Dictionary for decoding messages
+ * @return Stream writing to stdout, or NULL on failure
  */
-static bool process_bartender_message(thread_worker_data_t* data, 
-    const char* message_buffer,
-    char* decoded_buffer);
+static image_stream_t* create_image_stream(const char* dictionary);
+
+/**
+ * @brief Image line decoder handed to the reply stream
+ *
+ * @param[in]  message    IMAGE line, header included
+ * @param[in]  dictionary Dictionary for decoding messages
+ * @param[out] decoded    Buffer for the decoded line
+ * @param[in]  size       Size of decoded
+ * @return 0 on success, as decode_server_message
+ */
+static int decode_image_line(const char* message,
+                             const char* dictionary,
+                             char* decoded,
+                             size_t size);
+
+/**
+ * @brief Logs the image lines the stream failed to decode since last seen
+ *
+ * @param[in]     stream Reply stream
+ * @param[in,out] seen   Failures already logged
+ */
+static void log_decode_failures(const image_stream_t* stream, uint64_t* seen);
+
+/**
+ * @brief Cleanup function wrapper for a reply stream
+ *
+ * @param[in] arg Stream to free
+ */
+static void image_stream_cleanup_wrapper(void* arg);
 
 /**
 * @brief Receive and process messages from the bartender
@@ -63,6 +91,14 @@ static bool handle_bartender_responses(thread_worker_data_t* data);
 * @return NULL in all cases
 */
 static void* thread_worker(void* arg);
+
+/**
+* @brief Worker thread function that pipelines requests through the mux
+*
+* @param[in] arg Pointer to thread_worker_data structure
+* @return NULL in all cases
+*/
+static void* thread_mux_worker(void* arg);
  
  /*************************************************************************
  * Public Functions
@@ -100,6 +136,13 @@ static void* thread_worker(void* arg);
          return false;
      }
  
+     // Workers take turns on the socket, so they share its reply stream
+     image_stream_t* stream = create_image_stream(dictionary);
+     if (NULL == stream)
+     {
+         return false;
+     }
+ 
      // Initialize and submit worker threads
      for (int idx = 0; idx < prefix_count; idx++)
      {
@@ -107,6 +150,7 @@ static void* thread_worker(void* arg);
          strncpy(worker_data[idx].suffix, suffix, sizeof(worker_data[idx].suffix) - 1);
          worker_data[idx].client_turn_lock = client_turn_lock;
          worker_data[idx].socket_fd = socket_fd;
+         worker_data[idx].p_stream = stream;
          worker_data[idx].dictionary = dictionary;
  
          thread_job_t job = {.job_fn = thread_worker, .p_arg = &worker_data[idx]};
@@ -122,6 +166,61 @@ static void* thread_worker(void* arg);
      return true;
  }
  
+ bool create_mux_workers(thread_pool_t* thread_pool,
+                         char prefixes[][PREFIX_BUFFER_SIZE],
+                         char* suffix,
+                         int prefix_count,
+                         client_mux_t* p_mux,
+                         const char* dictionary)
+ {
+     if (NULL == thread_pool || NULL == prefixes || NULL == suffix ||
+         prefix_count <= 0 || NULL == p_mux || NULL == dictionary)
+     {
+         syslog_write(ERROR, "Invalid parameters for create_mux_workers");
+         return false;
+     }
+ 
+     thread_worker_data_t* worker_data = calloc(prefix_count, sizeof(thread_worker_data_t));
+     if (NULL == worker_data)
+     {
+         syslog_write(CRITICAL, "Failed to allocate worker data");
+         return false;
+     }
+ 
+     if (!cleanup_add_void(worker_data_cleanup_wrapper, worker_data, 3))
+     {
+         syslog_write(ERROR, "Failed to add worker data cleanup");
+         free(worker_data);
+         return false;
+     }
+ 
+     for (int idx = 0; idx < prefix_count; idx++)
+     {
+         strncpy(worker_data[idx].prefix, prefixes[idx], sizeof(worker_data[idx].prefix) - 1);
+         strncpy(worker_data[idx].suffix, suffix, sizeof(worker_data[idx].suffix) - 1);
+         worker_data[idx].socket_fd = -1;
+         worker_data[idx].p_mux = p_mux;
+         worker_data[idx].p_stream = create_image_stream(dictionary);
+         worker_data[idx].dictionary = dictionary;
+ 
+         if (NULL == worker_data[idx].p_stream)
+         {
+             return false;
+         }
+ 
+         thread_job_t job = {.job_fn = thread_mux_worker, .p_arg = &worker_data[idx]};
+ 
+         if (thread_pool_submit(thread_pool, &job) != 0)
+         {
+             syslog_write(ERROR, "Failed to submit mux job for worker %d", idx);
+             return false;
+         }
+     }
+ 
+     syslog_write(INFO, "All mux worker threads created successfully");
+     return true;
+ }
+ 
  void worker_data_cleanup_wrapper(void* arg)
  {
      free(arg);
@@ -132,76 +231,106 @@ static void* thread_worker(void* arg);
 *************************************************************************/
 
 /**
- * @brief Process a message received from the bartender
+ * @brief Creates a reply stream and registers it for cleanup
  *
- * @param[in] data Worker thread data
- * @param[in] message_buffer Buffer containing the message to process
- * @param[out] decoded_buffer Buffer for decoded image data
- * @return true if processing should continue, false if we should stop receiving
+ * @param[in] dictionary Dictionary for decoding messages
+ * @return Stream writing to stdout, or NULL on failure
  */
-static bool process_bartender_message(thread_worker_data_t* data, 
-    const char* message_buffer,
-    char* decoded_buffer)
+static image_stream_t* create_image_stream(const char* dictionary)
 {
-// Check for END message
-if (strncmp(message_buffer, "END", 3) == 0)
+image_stream_t* stream = image_stream_create_decoder(decode_image_line,
+dictionary,
+STDOUT_FILENO);
+if (NULL == stream)
 {
-return false;
+syslog_write(CRITICAL, "Failed to allocate reply stream");
+return NULL;
 }
 
-// Check for IMAGE message
-if (strncmp(message_buffer, "IMAGE ", IMAGE_PREFIX_LEN) == 0)
+if (!cleanup_add_void(image_stream_cleanup_wrapper, stream, 3))
 {
-memset(decoded_buffer, 0, MAX_MESSAGE_SIZE);
-if (decode_server_message(message_buffer,
-data->dictionary,
-decoded_buffer,
-MAX_MESSAGE_SIZE)
-== 0)
+syslog_write(ERROR, "Failed to add reply stream cleanup");
+image_stream_destroy(&stream);
+return NULL;
+}
+
+return stream;
+}
+
+/**
+ * @brief Image line decoder handed to the reply stream
+ *
+ * @param[in]  message    IMAGE line, header included
+ * @param[in]  dictionary Dictionary for decoding messages
+ * @param[out] decoded    Buffer for the decoded line
+ * @param[in]  size       Size of decoded
+ * @return 0 on success, as decode_server_message
+ */
+static int decode_image_line(const char* message,
+                             const char* dictionary,
+                             char* decoded,
+                             size_t size)
 {
-puts(data->prefix);
-puts(decoded_buffer);
-puts(data->suffix);
+return decode_server_message(message, dictionary, decoded, size);
 }
-else
+
+/**
+ * @brief Logs the image lines the stream failed to decode since last seen
+ *
+ * @param[in]     stream Reply stream
+ * @param[in,out] seen   Failures already logged
+ */
+static void log_decode_failures(const image_stream_t* stream, uint64_t* seen)
+{
+uint64_t failures = image_stream_decode_failures(stream);
+
+for (; *seen < failures; (*seen)++)
 {
 syslog_write(ERROR, "Failed to decode server message");
 }
 }
 
-return true;
+/**
+ * @brief Cleanup function wrapper for a reply stream
+ *
+ * @param[in] arg Stream to free
+ */
+static void image_stream_cleanup_wrapper(void* arg)
+{
+image_stream_t* stream = (image_stream_t*)arg;
+image_stream_destroy(&stream);
 }
 
 /**
 * @brief Receive and process messages from the bartender
 *
+* Reads are framed into lines by the shared stream, so a reply may arrive
+* in any number of pieces; images are decoded and written as they arrive.
+*
 * @param[in] data Worker thread data
 * @return true on successful completion, false on error
 */
 static bool handle_bartender_responses(thread_worker_data_t* data)
 {
-char message_buffer[MAX_MESSAGE_SIZE];
-char decoded_buffer[MAX_MESSAGE_SIZE];
+// The stream is shared, so only failures during this reply are ours
+uint64_t seen = image_stream_decode_failures(data->p_stream);
 
 while (!is_bar_closed())
 {
-memset(message_buffer, 0, sizeof(message_buffer));
-ssize_t bytes_received = recv(data->socket_fd,
-   message_buffer,
-   sizeof(message_buffer) - 1,
-   0);
+int status = image_stream_read(data->p_stream,
+data->socket_fd,
+data->prefix,
+data->suffix);
+log_decode_failures(data->p_stream, &seen);
 
-if (bytes_received <= 0 || is_bar_closed())
+if (IMAGE_STREAM_END == status)
 {
-return false;
+return true;
 }
 
-message_buffer[bytes_received] = '\0';
-
-// Process the message, exit loop if it returns false
-if (!process_bartender_message(data, message_buffer, decoded_buffer))
+if (status < 0 || is_bar_closed())
 {
-return true;
+return false;
 }
 }
 
@@ -270,4 +399,76 @@ usleep(THREAD_SLEEP_USEC);
 }
 
 return NULL;
-}
\ No newline at end of file
+}
+
+/**
+* @brief Worker thread function that pipelines requests through the mux
+*
+* @param[in] arg Pointer to thread_worker_data structure
+* @return NULL in all cases
+*/
+static void* thread_mux_worker(void* arg)
+{
+thread_worker_data_t* data = (thread_worker_data_t*)arg;
+client_mux_call_t* calls[WORKER_PIPELINE_DEPTH] = { NULL };
+char request[MAX_MESSAGE_SIZE];
+int queued = 0;
+uint64_t seen = 0;
+
+// Fill the pipeline; replies come back in the order requests were queued
+for (; queued < WORKER_PIPELINE_DEPTH && !is_bar_closed(); queued++)
+{
+calls[queued] = client_mux_call_create(data->p_mux);
+snprintf(request, sizeof(request), "TAKE_ONE_DOWN %d\n", get_window_width());
+
+if (NULL == calls[queued] ||
+client_mux_submit(data->p_mux, calls[queued], request) < 0)
+{
+syslog_write(ERROR, "Failed to queue TAKE_ONE_DOWN message");
+client_mux_call_destroy(&calls[queued]);
+break;
+}
+}
+
+for (int idx = 0; queued > 0; idx = (idx + 1) % queued)
+{
+const char* reply = NULL;
+size_t len = 0;
+
+// Sleeps until the I/O thread completes this request
+if (client_mux_wait(data->p_mux, calls[idx], &reply, &len) != CLIENT_MUX_SUCCESS)
+{
+break;
+}
+
+// Decode the reply and write it out in one go, whole
+size_t used = 0;
+flockfile(stdout);
+image_stream_consume(data->p_stream, reply, len, data->prefix, data->suffix, &used);
+image_stream_flush(data->p_stream);
+funlockfile(stdout);
+log_decode_failures(data->p_stream, &seen);
+
+if (is_bar_closed())
+{
+break;
+}
+
+snprintf(request, sizeof(request), "TAKE_ONE_DOWN %d\n", get_window_width());
+if (client_mux_submit(data->p_mux, calls[idx], request) < 0)
+{
+syslog_write(ERROR, "Failed to queue TAKE_ONE_DOWN message");
+break;
+}
+}
+
+// Requests still queued fail once the connection owner shuts the mux down
+for (int idx = 0; idx < queued; idx++)
+{
+const char* reply = NULL;
+client_mux_wait(data->p_mux, calls[idx], &reply, NULL);
+client_mux_call_destroy(&calls[idx]);
+}
+
+return NULL;
+}
@@ -12,6 +12,7 @@
  #include <pthread.h>
  #include <stdbool.h>
  #include "../include/thread_pool.h"
+ #include "client_mux.h"
  
  /*************************************************************************
  * Constants and macros
@@ -22,6 +23,7 @@
  #define MAX_MESSAGE_SIZE    (4096)
  #define PREFIX_BUFFER_SIZE  (128)
  #define SUFFIX_BUFFER_SIZE  (128)
+ #define WORKER_PIPELINE_DEPTH (4)  /* Requests each mux worker keeps queued */
 
  /*************************************************************************
  * Type Definitions
@@ -48,6 +50,30 @@
                     int socket_fd,
                     const char* dictionary);
  
+ /**
+  * @brief Creates and submits workers that share a multiplexed connection
+  *
+  * Each worker keeps WORKER_PIPELINE_DEPTH TAKE_ONE_DOWN requests queued on
+  * the multiplexer and sleeps until one of them is answered, instead of
+  * taking turns on the socket and polling with usleep. Size the mux window
+  * to prefix_count * WORKER_PIPELINE_DEPTH to keep every request in flight.
+  *
+  * @param[in] thread_pool   Initialized thread pool
+  * @param[in] prefixes      Array of decoded color prefix strings
+  * @param[in] suffix        Terminal reset suffix string
+  * @param[in] prefix_count  Number of prefixes/threads to create
+  * @param[in] p_mux         Multiplexer that owns the server socket
+  * @param[in] dictionary    Dictionary for decoding messages
+  *
+  * @return true if all workers created successfully, false otherwise
+  */
+ bool create_mux_workers(thread_pool_t* thread_pool,
+                         char prefixes[][PREFIX_BUFFER_SIZE],
+                         char* suffix,
+                         int prefix_count,
+                         client_mux_t* p_mux,
+                         const char* dictionary);
+ 
  /**
   * @brief Cleanup function wrapper for thread worker data
   *
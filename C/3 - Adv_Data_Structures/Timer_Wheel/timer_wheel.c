@@ -0,0 +1,359 @@
+/** @file timer_wheel.c
+ *
+ * @brief Implementation of the hierarchical timing wheel.
+ *
+ * A timer expiring at tick e goes into the lowest level L with
+ * (e >> 6L) - (now >> 6L) <= 64, in slot (e >> 6L) & 63. The wheel first
+ * reaches that slot at tick (e >> 6L) << 6L, which is after now and no
+ * later than e, and no other visit to the slot comes in between. So at
+ * each tick t the wheel only has to:
+ *
+ * 1. cascade, from the top down, every level whose slot size divides t,
+ *    re-placing the timers of slot (t >> 6L) & 63 relative to t - 1; they
+ *    all land at least one level lower, and those due at t in the level-0
+ *    slot for t;
+ * 2. fire the level-0 slot for t, detached first so that timers the
+ *    callbacks add cannot join it.
+ *
+ * The same rule gives the tick of every busy slot's next visit, which is
+ * how advance skips the ticks with nothing to do.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stddef.h>
+#include "timer_wheel.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define SLOT_MASK       ((uint64_t)TIMER_WHEEL_SLOTS - 1u)
+#define LEVEL_SHIFT(lv) ((uint32_t)(lv) * TIMER_WHEEL_SLOT_BITS)
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void     place(timer_wheel_t * p_wheel, wheel_timer_t * p_timer);
+static void     unlink_timer(timer_wheel_t * p_wheel, wheel_timer_t * p_timer);
+static void     cascade(timer_wheel_t * p_wheel,
+                        uint32_t        level,
+                        uint64_t        tick);
+static uint32_t process_tick(timer_wheel_t * p_wheel, uint64_t tick);
+static uint64_t rotate_right(uint64_t bits, uint32_t count);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+void
+wheel_timer_init(wheel_timer_t *  p_timer,
+                 wheel_timer_fn_t timer_fn,
+                 void *           p_arg)
+{
+    if (NULL == p_timer)
+    {
+        return;
+    }
+
+    p_timer->p_next   = NULL;
+    p_timer->pp_prev  = NULL;
+    p_timer->expires  = 0u;
+    p_timer->timer_fn = timer_fn;
+    p_timer->p_arg    = p_arg;
+    p_timer->level    = 0u;
+    p_timer->slot     = 0u;
+}
+
+bool
+wheel_timer_is_pending(const wheel_timer_t * p_timer)
+{
+    return (NULL != p_timer) && (NULL != p_timer->pp_prev);
+}
+
+bool
+timer_wheel_init(timer_wheel_t * p_wheel, uint64_t now)
+{
+    if (NULL == p_wheel)
+    {
+        return false;
+    }
+
+    for (uint32_t level = 0u; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for (uint32_t slot = 0u; slot < TIMER_WHEEL_SLOTS; slot++)
+        {
+            p_wheel->p_slots[level][slot] = NULL;
+        }
+
+        p_wheel->occupied[level] = 0u;
+    }
+
+    p_wheel->now   = now;
+    p_wheel->count = 0u;
+    return true;
+}
+
+bool
+timer_wheel_add(timer_wheel_t * p_wheel,
+                wheel_timer_t * p_timer,
+                uint64_t        expires)
+{
+    if ((NULL == p_wheel) || (NULL == p_timer) || (NULL != p_timer->pp_prev))
+    {
+        return false;
+    }
+
+    p_timer->expires = (expires > p_wheel->now) ? expires
+                                                : (p_wheel->now + 1u);
+    place(p_wheel, p_timer);
+    p_wheel->count++;
+    return true;
+}
+
+bool
+timer_wheel_cancel(timer_wheel_t * p_wheel, wheel_timer_t * p_timer)
+{
+    if ((NULL == p_wheel) || !wheel_timer_is_pending(p_timer))
+    {
+        return false;
+    }
+
+    unlink_timer(p_wheel, p_timer);
+    p_wheel->count--;
+    return true;
+}
+
+uint32_t
+timer_wheel_advance(timer_wheel_t * p_wheel, uint64_t now)
+{
+    uint32_t fired = 0u;
+
+    if (NULL == p_wheel)
+    {
+        return 0u;
+    }
+
+    while (p_wheel->now < now)
+    {
+        uint64_t tick = timer_wheel_next_tick(p_wheel);
+
+        if (tick > now)
+        {
+            // Nothing is visited in between, so no slot is skipped
+            p_wheel->now = now;
+            break;
+        }
+
+        fired += process_tick(p_wheel, tick);
+    }
+
+    return fired;
+}
+
+uint64_t
+timer_wheel_next_tick(const timer_wheel_t * p_wheel)
+{
+    uint64_t next = TIMER_WHEEL_NEVER;
+
+    if ((NULL == p_wheel) || (0u == p_wheel->count))
+    {
+        return TIMER_WHEEL_NEVER;
+    }
+
+    for (uint32_t level = 0u; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (0u == p_wheel->occupied[level])
+        {
+            continue;
+        }
+
+        // Slot the level reaches next, and how many slots on the first
+        // busy one is
+        uint64_t first = (p_wheel->now >> LEVEL_SHIFT(level)) + 1u;
+        uint64_t busy  = rotate_right(p_wheel->occupied[level],
+                                      (uint32_t)(first & SLOT_MASK));
+        uint64_t tick  = (first + (uint64_t)__builtin_ctzll(busy))
+                        << LEVEL_SHIFT(level);
+
+        if (tick < next)
+        {
+            next = tick;
+        }
+    }
+
+    return next;
+}
+
+uint64_t
+timer_wheel_now(const timer_wheel_t * p_wheel)
+{
+    return (NULL == p_wheel) ? 0u : p_wheel->now;
+}
+
+uint32_t
+timer_wheel_count(const timer_wheel_t * p_wheel)
+{
+    return (NULL == p_wheel) ? 0u : p_wheel->count;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Links a timer into the slot for its expiry, relative to now.
+ */
+static void
+place(timer_wheel_t * p_wheel, wheel_timer_t * p_timer)
+{
+    uint32_t level = 0u;
+    uint64_t slot  = 0u;
+
+    for (level = 0u; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        uint64_t distance = (p_timer->expires >> LEVEL_SHIFT(level))
+                            - (p_wheel->now >> LEVEL_SHIFT(level));
+
+        if (distance <= TIMER_WHEEL_SLOTS)
+        {
+            slot = (p_timer->expires >> LEVEL_SHIFT(level)) & SLOT_MASK;
+            break;
+        }
+    }
+
+    if (TIMER_WHEEL_LEVELS == level)
+    {
+        // Past the horizon: park in the top slot visited last, to be
+        // placed again when it comes round
+        level = TIMER_WHEEL_LEVELS - 1u;
+        slot  = (p_wheel->now >> LEVEL_SHIFT(level)) & SLOT_MASK;
+    }
+
+    wheel_timer_t ** pp_head = &p_wheel->p_slots[level][slot];
+
+    p_timer->level   = (uint8_t)level;
+    p_timer->slot    = (uint8_t)slot;
+    p_timer->p_next  = *pp_head;
+    p_timer->pp_prev = pp_head;
+
+    if (NULL != *pp_head)
+    {
+        (*pp_head)->pp_prev = &p_timer->p_next;
+    }
+
+    *pp_head                  = p_timer;
+    p_wheel->occupied[level] |= (uint64_t)1u << slot;
+}
+
+/*!
+ * @brief Unlinks a pending timer from its slot; count is left alone.
+ */
+static void
+unlink_timer(timer_wheel_t * p_wheel, wheel_timer_t * p_timer)
+{
+    *p_timer->pp_prev = p_timer->p_next;
+
+    if (NULL != p_timer->p_next)
+    {
+        p_timer->p_next->pp_prev = p_timer->pp_prev;
+    }
+
+    if (NULL == p_wheel->p_slots[p_timer->level][p_timer->slot])
+    {
+        p_wheel->occupied[p_timer->level]
+            &= ~((uint64_t)1u << p_timer->slot);
+    }
+
+    p_timer->p_next  = NULL;
+    p_timer->pp_prev = NULL;
+}
+
+/*!
+ * @brief Re-places the timers of the level's slot for tick. The slot is
+ *        detached first, since timers past the horizon go straight back
+ *        into it.
+ */
+static void
+cascade(timer_wheel_t * p_wheel, uint32_t level, uint64_t tick)
+{
+    uint64_t        slot    = (tick >> LEVEL_SHIFT(level)) & SLOT_MASK;
+    wheel_timer_t * p_timer = p_wheel->p_slots[level][slot];
+
+    p_wheel->p_slots[level][slot] = NULL;
+    p_wheel->occupied[level]     &= ~((uint64_t)1u << slot);
+
+    while (NULL != p_timer)
+    {
+        wheel_timer_t * p_next = p_timer->p_next;
+
+        place(p_wheel, p_timer);
+        p_timer = p_next;
+    }
+}
+
+/*!
+ * @brief Cascades and fires everything due at tick.
+ *
+ * @return Number of timers fired
+ */
+static uint32_t
+process_tick(timer_wheel_t * p_wheel, uint64_t tick)
+{
+    uint32_t top   = 0u;
+    uint32_t fired = 0u;
+
+    while ((top + 1u < TIMER_WHEEL_LEVELS)
+           && (0u == (tick & ((1ull << LEVEL_SHIFT(top + 1u)) - 1u))))
+    {
+        top++;
+    }
+
+    p_wheel->now = tick - 1u;
+
+    for (uint32_t level = top; level > 0u; level--)
+    {
+        cascade(p_wheel, level, tick);
+    }
+
+    p_wheel->now = tick;
+
+    // Detach the due timers: one the callbacks add 64 ticks out lands in
+    // this same slot. A callback may still cancel a detached timer.
+    uint64_t        slot  = tick & SLOT_MASK;
+    wheel_timer_t * p_due = p_wheel->p_slots[0][slot];
+
+    p_wheel->p_slots[0][slot] = NULL;
+    p_wheel->occupied[0]     &= ~((uint64_t)1u << slot);
+
+    if (NULL != p_due)
+    {
+        p_due->pp_prev = &p_due;
+    }
+
+    while (NULL != p_due)
+    {
+        wheel_timer_t * p_timer = p_due;
+
+        unlink_timer(p_wheel, p_timer);
+        p_wheel->count--;
+        fired++;
+
+        if (NULL != p_timer->timer_fn)
+        {
+            p_timer->timer_fn(p_timer, p_timer->p_arg);
+        }
+    }
+
+    return fired;
+}
+
+static uint64_t
+rotate_right(uint64_t bits, uint32_t count)
+{
+    return (0u == count) ? bits : ((bits >> count) | (bits << (64u - count)));
+}
+
+/*** end of file ***/
@@ -0,0 +1,179 @@
+/** @file timer_wheel.h
+ *
+ * @brief Hierarchical timing wheel with O(1) add, cancel and tick.
+ *
+ * Time is counted in ticks, and the caller picks what a tick is, e.g. one
+ * millisecond. The wheel has TIMER_WHEEL_LEVELS levels of
+ * TIMER_WHEEL_SLOTS slots each. A level-0 slot covers one tick, a level-1
+ * slot 64 ticks, a level-2 slot 4096 ticks, and so on. A timer goes into
+ * the lowest level whose slots can reach its expiry. When the wheel
+ * reaches the start of a higher-level slot, that slot's timers move down
+ * a level ("cascade"); each timer moves at most once per level.
+ *
+ * Adding and cancelling a timer just links or unlinks it from a slot
+ * list. Advancing does work only for slots that hold timers: an occupancy
+ * bitmap per level finds the next busy slot, so a long idle stretch costs
+ * nothing, and no timer is inspected before it is due.
+ *
+ * The timers are embedded in the caller's structs, like the hooks in
+ * intrusive.h, so the wheel never allocates. The wheel is not thread-safe.
+ *
+ *     typedef struct
+ *     {
+ *         int           fd;
+ *         wheel_timer_t idle;
+ *     } conn_t;
+ *
+ *     wheel_timer_init(&p_conn->idle, close_idle_conn, p_conn);
+ *     timer_wheel_add(&wheel, &p_conn->idle, now_ms + IDLE_MS);
+ *
+ * Expiries beyond the 2^36-tick horizon still fire at the right tick.
+ * They are parked in the top level and re-placed each time it comes round.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define TIMER_WHEEL_SLOT_BITS (6u)
+#define TIMER_WHEEL_SLOTS     (1u << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_LEVELS    (6u)
+#define TIMER_WHEEL_NEVER     (UINT64_MAX)  /* No timer pending */
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+typedef struct wheel_timer wheel_timer_t;
+
+/* Called when a timer fires. The timer is no longer pending, so the
+   callback may add it again, and may add or cancel any other timer. */
+typedef void (*wheel_timer_fn_t)(wheel_timer_t * p_timer, void * p_arg);
+
+/* Embedded in the caller's struct; the link fields are private */
+struct wheel_timer
+{
+    wheel_timer_t *  p_next;
+    wheel_timer_t ** pp_prev;  /* NULL when not pending */
+    uint64_t         expires;  /* Tick it fires at */
+    wheel_timer_fn_t timer_fn;
+    void *           p_arg;
+    uint8_t          level;
+    uint8_t          slot;
+};
+
+typedef struct
+{
+    wheel_timer_t * p_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t        occupied[TIMER_WHEEL_LEVELS]; /* Bit per busy slot */
+    uint64_t        now;   /* Last tick processed */
+    uint32_t        count; /* Pending timers */
+} timer_wheel_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Sets up a timer that is not pending.
+ *
+ * @param[out] p_timer  Timer
+ * @param[in]  timer_fn Called when it fires
+ * @param[in]  p_arg    Passed to timer_fn
+ */
+void
+wheel_timer_init(wheel_timer_t *  p_timer,
+                 wheel_timer_fn_t timer_fn,
+                 void *           p_arg);
+
+/*!
+ * @brief Whether a timer is in a wheel, waiting to fire.
+ */
+bool
+wheel_timer_is_pending(const wheel_timer_t * p_timer);
+
+/*!
+ * @brief Initializes an empty wheel.
+ *
+ * @param[out] p_wheel Wheel
+ * @param[in]  now     Current tick
+ *
+ * @return true on success, false on NULL
+ */
+bool
+timer_wheel_init(timer_wheel_t * p_wheel, uint64_t now);
+
+/*!
+ * @brief Adds a timer. An expiry at or before the current tick fires on
+ *        the next tick.
+ *
+ * @param[in,out] p_wheel Wheel
+ * @param[in,out] p_timer Timer that is not pending
+ * @param[in]     expires Tick to fire at
+ *
+ * @return true on success, false on NULL or a pending timer
+ */
+bool
+timer_wheel_add(timer_wheel_t * p_wheel,
+                wheel_timer_t * p_timer,
+                uint64_t        expires);
+
+/*!
+ * @brief Cancels a pending timer; it will not fire.
+ *
+ * @param[in,out] p_wheel Wheel the timer is in
+ * @param[in,out] p_timer Timer
+ *
+ * @return true if it was pending, false otherwise
+ */
+bool
+timer_wheel_cancel(timer_wheel_t * p_wheel, wheel_timer_t * p_timer);
+
+/*!
+ * @brief Moves the wheel forward to tick now and fires every timer that
+ *        expires on the way, in expiry order.
+ *
+ * @param[in,out] p_wheel Wheel
+ * @param[in]     now     Current tick; earlier ticks are ignored
+ *
+ * @return Number of timers fired
+ */
+uint32_t
+timer_wheel_advance(timer_wheel_t * p_wheel, uint64_t now);
+
+/*!
+ * @brief The next tick at which timer_wheel_advance() has work: a timer
+ *        to fire or a slot to cascade. Nothing fires before it, so a
+ *        caller can sleep until then.
+ *
+ * @param[in] p_wheel Wheel
+ *
+ * @return The tick, or TIMER_WHEEL_NEVER if no timer is pending
+ */
+uint64_t
+timer_wheel_next_tick(const timer_wheel_t * p_wheel);
+
+/*!
+ * @brief The last tick the wheel was advanced to.
+ */
+uint64_t
+timer_wheel_now(const timer_wheel_t * p_wheel);
+
+/*!
+ * @brief Number of pending timers.
+ */
+uint32_t
+timer_wheel_count(const timer_wheel_t * p_wheel);
+
+#endif /* TIMER_WHEEL_H */
+
+/*** end of file ***/
@@ -0,0 +1,368 @@
+/** @file timer_wheel_bench.c
+ *
+ * @brief Connection idle timeouts on a timer_wheel_t and on a heap_t.
+ *
+ * Every connection has its own idle timeout of up to SPAN ticks, so about
+ * a million timers are pending at once. Each tick, resets_per_tick random
+ * connections see traffic and push their deadline back by their timeout,
+ * and then the clock advances one tick. A connection whose timer fires is
+ * re-armed, as a new connection taking its place would be. Both queues
+ * see the same deadlines, so they must fire the same timers.
+ *
+ * The heap_t queue is the usual lazy one, since heap_t cannot find an
+ * entry to move it. A reset only records the new deadline, which works
+ * because a reset never brings a deadline forward. When an entry reaches
+ * the top, it fires if the deadline has passed, and otherwise is pushed
+ * again with the current deadline. Each connection has one heap
+ * entry, but every push and pop is O(log n). The wheel cancels and re-adds
+ * in O(1).
+ *
+ * Build: gcc -O2 -std=c99 timer_wheel_bench.c timer_wheel.c
+ *        "../../1 - Basic_Data_Structures/7 - Heap/heap.c"
+ *        "../../1 - Basic_Data_Structures/0 - Allocator/allocator.c"
+ *
+ * Usage: timer_wheel_bench [timers] [ticks] [resets_per_tick]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "timer_wheel.h"
+#include "../../1 - Basic_Data_Structures/7 - Heap/heap.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_TIMERS (1000000u)
+#define DEFAULT_TICKS  (10000u)
+#define DEFAULT_RESETS (1000u)
+#define SPAN           (30000u) /* Longest idle timeout, in ticks */
+#define START_TICK     (1000u)
+#define SEED           (0x9E3779B97F4A7C15ull)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+typedef struct
+{
+    wheel_timer_t timer;
+    uint64_t      deadline; /* Current timeout, for the heap queue */
+    uint64_t      heap_key; /* Deadline the heap entry was pushed with */
+    uint32_t      timeout;  /* Idle timeout, 1 .. SPAN ticks */
+} conn_t;
+
+typedef struct
+{
+    conn_t *        p_conns;
+    uint32_t        conn_count;
+    timer_wheel_t * p_wheel;
+    heap_t          heap;
+    uint64_t        fired;
+} bench_state_t;
+
+typedef struct
+{
+    double   setup_s;
+    double   run_s;
+    uint64_t fired;
+    uint64_t resets;
+} result_t;
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint32_t idle_timeout(uint32_t id);
+static uint64_t xorshift(uint64_t * p_state);
+static void     on_wheel_fire(wheel_timer_t * p_timer, void * p_arg);
+static int32_t  compare_heap_keys(const void * p_lhs, const void * p_rhs);
+static void     reset_conns(bench_state_t * p_state);
+static bool     run_wheel(bench_state_t * p_state,
+                          uint32_t        ticks,
+                          uint32_t        resets_per_tick,
+                          result_t *      p_result);
+static bool     run_heap(bench_state_t * p_state,
+                         uint32_t        ticks,
+                         uint32_t        resets_per_tick,
+                         result_t *      p_result);
+static void     print_result(const char * p_name, const result_t * p_result);
+static double   now_seconds(void);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    bench_state_t state  = { 0 };
+    uint32_t      ticks  = DEFAULT_TICKS;
+    uint32_t      resets = DEFAULT_RESETS;
+    result_t      wheel  = { 0 };
+    result_t      heap   = { 0 };
+
+    state.conn_count = DEFAULT_TIMERS;
+
+    if (argc > 1)
+    {
+        state.conn_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        ticks = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if (argc > 3)
+    {
+        resets = (uint32_t)strtoul(argv[3], NULL, 10);
+    }
+
+    if (0u == state.conn_count)
+    {
+        fprintf(stderr, "usage: %s [timers] [ticks] [resets_per_tick]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    state.p_conns = calloc(state.conn_count, sizeof(conn_t));
+    state.p_wheel = malloc(sizeof(timer_wheel_t));
+
+    if ((NULL == state.p_conns) || (NULL == state.p_wheel)
+        || !run_wheel(&state, ticks, resets, &wheel)
+        || !run_heap(&state, ticks, resets, &heap))
+    {
+        fprintf(stderr, "out of memory\n");
+        free(state.p_conns);
+        free(state.p_wheel);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u timers, %u ticks, %u resets per tick, timeouts up to %u "
+           "ticks\n",
+           state.conn_count, ticks, resets, SPAN);
+    print_result("timer_wheel_t", &wheel);
+    print_result("heap_t (lazy)", &heap);
+
+    free(state.p_conns);
+    free(state.p_wheel);
+
+    if (wheel.fired != heap.fired)
+    {
+        fprintf(stderr, "fired counts differ\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief A connection's idle timeout, spread over 1 .. SPAN ticks.
+ */
+static uint32_t
+idle_timeout(uint32_t id)
+{
+    uint64_t mix = (uint64_t)id ^ SEED;
+
+    mix ^= mix >> 31;
+    mix *= 0x7FB5D329728EA185ull;
+    mix ^= mix >> 27;
+
+    return 1u + (uint32_t)(mix % SPAN);
+}
+
+static uint64_t
+xorshift(uint64_t * p_state)
+{
+    *p_state ^= *p_state << 13;
+    *p_state ^= *p_state >> 7;
+    *p_state ^= *p_state << 17;
+    return *p_state;
+}
+
+static void
+on_wheel_fire(wheel_timer_t * p_timer, void * p_arg)
+{
+    bench_state_t * p_state = p_arg;
+    conn_t *        p_conn  = (conn_t *)(void *)p_timer;
+    uint64_t        now     = timer_wheel_now(p_state->p_wheel);
+
+    p_state->fired++;
+    (void)timer_wheel_add(p_state->p_wheel,
+                          p_timer,
+                          now + p_conn->timeout);
+}
+
+static int32_t
+compare_heap_keys(const void * p_lhs, const void * p_rhs)
+{
+    const conn_t * p_left  = p_lhs;
+    const conn_t * p_right = p_rhs;
+
+    if (p_left->heap_key != p_right->heap_key)
+    {
+        return (p_left->heap_key < p_right->heap_key) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static void
+reset_conns(bench_state_t * p_state)
+{
+    for (uint32_t idx = 0u; idx < p_state->conn_count; idx++)
+    {
+        p_state->p_conns[idx].timeout = idle_timeout(idx);
+    }
+
+    p_state->fired = 0u;
+}
+
+static bool
+run_wheel(bench_state_t * p_state,
+          uint32_t        ticks,
+          uint32_t        resets_per_tick,
+          result_t *      p_result)
+{
+    timer_wheel_t * p_wheel = p_state->p_wheel;
+    uint64_t        rng     = SEED;
+
+    reset_conns(p_state);
+    (void)timer_wheel_init(p_wheel, START_TICK);
+
+    double start = now_seconds();
+
+    for (uint32_t idx = 0u; idx < p_state->conn_count; idx++)
+    {
+        conn_t * p_conn = &p_state->p_conns[idx];
+
+        wheel_timer_init(&p_conn->timer, on_wheel_fire, p_state);
+        (void)timer_wheel_add(p_wheel,
+                              &p_conn->timer,
+                              START_TICK + p_conn->timeout);
+    }
+
+    p_result->setup_s = now_seconds() - start;
+    start             = now_seconds();
+
+    for (uint64_t now = START_TICK; now < START_TICK + ticks; now++)
+    {
+        for (uint32_t reset = 0u; reset < resets_per_tick; reset++)
+        {
+            conn_t * p_conn
+                = &p_state->p_conns[xorshift(&rng) % p_state->conn_count];
+
+            (void)timer_wheel_cancel(p_wheel, &p_conn->timer);
+            (void)timer_wheel_add(p_wheel,
+                                  &p_conn->timer,
+                                  now + p_conn->timeout);
+        }
+
+        (void)timer_wheel_advance(p_wheel, now + 1u);
+    }
+
+    p_result->run_s  = now_seconds() - start;
+    p_result->fired  = p_state->fired;
+    p_result->resets = (uint64_t)ticks * resets_per_tick;
+    return true;
+}
+
+static bool
+run_heap(bench_state_t * p_state,
+         uint32_t        ticks,
+         uint32_t        resets_per_tick,
+         result_t *      p_result)
+{
+    heap_t * p_heap = &p_state->heap;
+    uint64_t rng    = SEED;
+
+    reset_conns(p_state);
+
+    if (!heap_init(p_heap, p_state->conn_count, 2.0f, compare_heap_keys))
+    {
+        return false;
+    }
+
+    double start = now_seconds();
+
+    for (uint32_t idx = 0u; idx < p_state->conn_count; idx++)
+    {
+        conn_t * p_conn = &p_state->p_conns[idx];
+
+        p_conn->deadline = START_TICK + p_conn->timeout;
+        p_conn->heap_key = p_conn->deadline;
+        (void)heap_insert(p_heap, p_conn);
+    }
+
+    p_result->setup_s = now_seconds() - start;
+    start             = now_seconds();
+
+    for (uint64_t now = START_TICK; now < START_TICK + ticks; now++)
+    {
+        for (uint32_t reset = 0u; reset < resets_per_tick; reset++)
+        {
+            conn_t * p_conn
+                = &p_state->p_conns[xorshift(&rng) % p_state->conn_count];
+
+            p_conn->deadline = now + p_conn->timeout;
+        }
+
+        conn_t * p_top = heap_peek_top(p_heap);
+
+        while ((NULL != p_top) && (p_top->heap_key <= now + 1u))
+        {
+            (void)heap_extract_top(p_heap);
+
+            if (p_top->deadline <= now + 1u)
+            {
+                p_state->fired++;
+                p_top->deadline = now + 1u + p_top->timeout;
+            }
+
+            p_top->heap_key = p_top->deadline;
+            (void)heap_insert(p_heap, p_top);
+            p_top = heap_peek_top(p_heap);
+        }
+    }
+
+    p_result->run_s  = now_seconds() - start;
+    p_result->fired  = p_state->fired;
+    p_result->resets = (uint64_t)ticks * resets_per_tick;
+    heap_destroy(p_heap, false);
+    return true;
+}
+
+static void
+print_result(const char * p_name, const result_t * p_result)
+{
+    uint64_t ops = p_result->resets + p_result->fired;
+
+    printf("%-14s setup %7.1f ms  run %8.1f ms  %6.1f ns/op  fired %llu\n",
+           p_name,
+           p_result->setup_s * 1e3,
+           p_result->run_s * 1e3,
+           (0u == ops) ? 0.0 : (p_result->run_s * 1e9 / (double)ops),
+           (unsigned long long)p_result->fired);
+}
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/*** end of file ***/
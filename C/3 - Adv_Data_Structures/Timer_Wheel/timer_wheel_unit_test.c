@@ -0,0 +1,240 @@
+#include <check.h>
+#include <stdlib.h>
+#include "timer_wheel.h"
+
+#define MAX_FIRED (64u)
+
+// A timer that records when and in what order it fired
+typedef struct
+{
+    wheel_timer_t   timer;
+    timer_wheel_t * p_wheel;
+    uint64_t        fired_at;
+    uint64_t        period;   /* Re-armed this far ahead when non-zero */
+    uint32_t        fire_count;
+} probe_t;
+
+// Too big for a test's stack
+static timer_wheel_t g_wheel;
+
+static probe_t * g_fired[MAX_FIRED];
+static uint32_t  g_fired_count;
+
+static void
+on_fire(wheel_timer_t * p_timer, void * p_arg)
+{
+    probe_t * p_probe = p_arg;
+
+    ck_assert_ptr_eq(p_timer, &p_probe->timer);
+    ck_assert(!wheel_timer_is_pending(p_timer));
+
+    p_probe->fired_at = timer_wheel_now(p_probe->p_wheel);
+    p_probe->fire_count++;
+
+    if (g_fired_count < MAX_FIRED)
+    {
+        g_fired[g_fired_count++] = p_probe;
+    }
+
+    if (0 != p_probe->period)
+    {
+        timer_wheel_add(p_probe->p_wheel, p_timer,
+                        p_probe->fired_at + p_probe->period);
+    }
+}
+
+static void
+probe_init(probe_t * p_probe, timer_wheel_t * p_wheel)
+{
+    p_probe->p_wheel    = p_wheel;
+    p_probe->fired_at   = 0;
+    p_probe->period     = 0;
+    p_probe->fire_count = 0;
+    wheel_timer_init(&p_probe->timer, on_fire, p_probe);
+}
+
+static void
+setup(void)
+{
+    g_fired_count = 0;
+}
+
+START_TEST(test_fire_order)
+{
+    // Expiries spread over three levels, added out of order
+    const uint64_t expiries[] = { 4100, 5, 70, 64, 3, 9000, 63, 4096, 65 };
+    const uint32_t count      = sizeof(expiries) / sizeof(expiries[0]);
+    probe_t        probes[sizeof(expiries) / sizeof(expiries[0])];
+
+    ck_assert(timer_wheel_init(&g_wheel, 0));
+
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        probe_init(&probes[idx], &g_wheel);
+        ck_assert(timer_wheel_add(&g_wheel, &probes[idx].timer, expiries[idx]));
+    }
+    ck_assert_uint_eq(timer_wheel_count(&g_wheel), count);
+    ck_assert_uint_eq(timer_wheel_next_tick(&g_wheel), 3);
+
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, 10000), count);
+    ck_assert_uint_eq(g_fired_count, count);
+    ck_assert_uint_eq(timer_wheel_count(&g_wheel), 0);
+    ck_assert_uint_eq(timer_wheel_next_tick(&g_wheel), TIMER_WHEEL_NEVER);
+
+    // In expiry order, each at its own tick
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        ck_assert_uint_eq(g_fired[idx]->fired_at,
+                          g_fired[idx]->timer.expires);
+        if (idx > 0)
+        {
+            ck_assert_uint_lt(g_fired[idx - 1]->fired_at,
+                              g_fired[idx]->fired_at);
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_fires_not_early_tick_by_tick)
+{
+    probe_t       probe;
+
+    ck_assert(timer_wheel_init(&g_wheel, 1000));
+    probe_init(&probe, &g_wheel);
+    ck_assert(timer_wheel_add(&g_wheel, &probe.timer, 1000 + 4097));
+
+    for (uint64_t tick = 1001; tick < 1000 + 4097; tick++)
+    {
+        ck_assert_uint_eq(timer_wheel_advance(&g_wheel, tick), 0);
+    }
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, 1000 + 4097), 1);
+    ck_assert_uint_eq(probe.fired_at, 1000 + 4097);
+}
+END_TEST
+
+START_TEST(test_cancel)
+{
+    probe_t       probes[3];
+
+    ck_assert(timer_wheel_init(&g_wheel, 0));
+    for (uint32_t idx = 0; idx < 3; idx++)
+    {
+        probe_init(&probes[idx], &g_wheel);
+        ck_assert(timer_wheel_add(&g_wheel, &probes[idx].timer, 100 * (idx + 1)));
+    }
+
+    // A pending timer cannot be added twice
+    ck_assert(!timer_wheel_add(&g_wheel, &probes[1].timer, 5));
+
+    ck_assert(timer_wheel_cancel(&g_wheel, &probes[1].timer));
+    ck_assert(!wheel_timer_is_pending(&probes[1].timer));
+    ck_assert(!timer_wheel_cancel(&g_wheel, &probes[1].timer));
+    ck_assert_uint_eq(timer_wheel_count(&g_wheel), 2);
+
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, 1000), 2);
+    ck_assert_uint_eq(probes[0].fire_count, 1);
+    ck_assert_uint_eq(probes[1].fire_count, 0);
+    ck_assert_uint_eq(probes[2].fire_count, 1);
+
+    // A cancelled timer can be added again
+    ck_assert(timer_wheel_add(&g_wheel, &probes[1].timer, 1001));
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, 1001), 1);
+    ck_assert_uint_eq(probes[1].fire_count, 1);
+}
+END_TEST
+
+START_TEST(test_past_expiry_fires_next_tick)
+{
+    probe_t       past;
+    probe_t       now;
+
+    ck_assert(timer_wheel_init(&g_wheel, 500));
+    probe_init(&past, &g_wheel);
+    probe_init(&now, &g_wheel);
+
+    ck_assert(timer_wheel_add(&g_wheel, &past.timer, 10));
+    ck_assert(timer_wheel_add(&g_wheel, &now.timer, 500));
+    ck_assert_uint_eq(timer_wheel_next_tick(&g_wheel), 501);
+
+    // Not on the current tick, which has already been processed
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, 500), 0);
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, 501), 2);
+    ck_assert_uint_eq(past.fired_at, 501);
+    ck_assert_uint_eq(now.fired_at, 501);
+}
+END_TEST
+
+START_TEST(test_rearm_from_callback)
+{
+    probe_t       probe;
+
+    ck_assert(timer_wheel_init(&g_wheel, 0));
+    probe_init(&probe, &g_wheel);
+    probe.period = 10;
+    ck_assert(timer_wheel_add(&g_wheel, &probe.timer, 10));
+
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, 100), 10);
+    ck_assert_uint_eq(probe.fired_at, 100);
+    ck_assert(wheel_timer_is_pending(&probe.timer));
+    ck_assert_uint_eq(timer_wheel_next_tick(&g_wheel), 110);
+}
+END_TEST
+
+START_TEST(test_beyond_horizon)
+{
+    const uint64_t expires = (1ull << 37) + 5;
+    probe_t        probe;
+
+    ck_assert(timer_wheel_init(&g_wheel, 0));
+    probe_init(&probe, &g_wheel);
+    ck_assert(timer_wheel_add(&g_wheel, &probe.timer, expires));
+
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, expires - 1), 0);
+    ck_assert_uint_eq(timer_wheel_advance(&g_wheel, expires), 1);
+    ck_assert_uint_eq(probe.fired_at, expires);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+timer_wheel_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+
+    s = suite_create("Timer_Wheel");
+
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, NULL);
+
+    tcase_add_test(tc_core, test_fire_order);
+    tcase_add_test(tc_core, test_fires_not_early_tick_by_tick);
+    tcase_add_test(tc_core, test_cancel);
+    tcase_add_test(tc_core, test_past_expiry_fires_next_tick);
+    tcase_add_test(tc_core, test_rearm_from_callback);
+    tcase_add_test(tc_core, test_beyond_horizon);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = timer_wheel_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include "../../1 - Basic_Data_Structures/0 - Allocator/allocator.h"
 
 #define NUM_CHARS 256
 #define ALPHA_CHARS 26
@@ -9,12 +10,17 @@
 typedef struct trie_node
 {
     bool terminal;
+    const allocator_t * p_alloc; // Children come from the same allocator
     struct trie_node * children[NUM_CHARS];
 }trie_node_t;
 
-trie_node_t * create_node()
+trie_node_t * create_node_ex(const allocator_t * p_alloc)
 {
-    trie_node_t * new_node = malloc(sizeof(*new_node));
+    trie_node_t * new_node = ALLOC_NEW(p_alloc, sizeof(*new_node));
+    if (NULL == new_node)
+    {
+        return NULL;
+    }
 
     for (int idx = 0; idx < NUM_CHARS; idx++)
     {
@@ -22,13 +28,23 @@ trie_node_t * create_node()
     }
 
     new_node->terminal = false;
+    new_node->p_alloc = p_alloc;
     return new_node;
 }
 
-bool trie_insert (trie_node_t **root, char * signed_text)
+trie_node_t * create_node()
+{
+    return create_node_ex(NULL);
+}
+
+// A missing root is made from p_alloc; nodes below an existing root come
+// from the root's allocator
+bool trie_insert_ex (trie_node_t **root, char * signed_text, const allocator_t * p_alloc)
 {
     if (NULL == *root)
-        *root = create_node();
+        *root = create_node_ex(p_alloc);
+    if (NULL == *root)
+        return false;
 
     unsigned char * text = (unsigned char *)signed_text;
     trie_node_t * tmp = *root;
@@ -38,7 +54,11 @@ bool trie_insert (trie_node_t **root, char * signed_text)
     {
         if (NULL == tmp->children[text[jdx]])
         {
-            tmp->children[text[jdx]] = create_node();
+            tmp->children[text[jdx]] = create_node_ex(tmp->p_alloc);
+            if (NULL == tmp->children[text[jdx]])
+            {
+                return false;
+            }
         }
         tmp = tmp->children[text[jdx]];
     }
@@ -54,6 +74,11 @@ bool trie_insert (trie_node_t **root, char * signed_text)
     }
 }
 
+bool trie_insert (trie_node_t **root, char * signed_text)
+{
+    return trie_insert_ex(root, signed_text, NULL);
+}
+
 void print_trie_rec(trie_node_t * node, unsigned char * prefix, int length)
 {
     unsigned char newprefix[length + 2];
@@ -139,7 +164,7 @@ trie_node_t * delete_str_recursive(trie_node_t * node, unsigned char * text, boo
 
         if (false == node_has_children(node))
         {
-            free(node);
+            ALLOC_FREE(node->p_alloc, node);
             node = NULL;
         }
 
@@ -150,7 +175,7 @@ trie_node_t * delete_str_recursive(trie_node_t * node, unsigned char * text, boo
 
     if (*deleted && !node_has_children(node) && !node->terminal)
     {
-        free(node);
+        ALLOC_FREE(node->p_alloc, node);
         node = NULL;
     }
 
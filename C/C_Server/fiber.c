@@ -0,0 +1,932 @@
+/** @file fiber.c
+ *
+ * @brief Implementation of pool-scheduled stackful coroutines.
+ *
+ * Every time a fiber is runnable a job that resumes it is submitted to the
+ * pool. The job switches to the fiber with swapcontext() and, once the
+ * fiber switches back, carries out what the fiber asked for while parked:
+ * queue it again (yield), arm its descriptor in epoll (wait), or free it
+ * (finished). Arming only happens after the switch, so the epoll thread
+ * can never resume a fiber that is still running on its stack. Descriptors
+ * are armed one-shot, so one readiness event resumes the fiber once.
+ *
+ * A wait with a timeout also puts the fiber's timer into the scheduler's
+ * timer wheel, which the epoll thread advances after every epoll_wait()
+ * and sleeps no longer than its next tick (a millisecond). Exactly one of
+ * the readiness event and the timer may resume the fiber. timer_lock is
+ * held from arming the descriptor until the timer is in the wheel, and
+ * the epoll thread takes it to cancel the timer of a ready descriptor. A
+ * timer that fires disarms the descriptor first, and both happen on the
+ * epoll thread, so no event for the fiber can still be delivered.
+ *
+ * The current fiber is a thread-local variable read through a function
+ * that is not inlined, because a fiber that waits may come back on a
+ * different thread and the compiler must not reuse a thread-local address
+ * computed before the switch.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/poll.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "../include/fiber.h"
+#include "../include/thread_pool.h"
+#include "../include/timer_wheel.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define EVENT_BATCH (64)
+#define WAKE_DRAIN  (64u)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* What a fiber asked its worker to do when it switched back */
+typedef enum
+{
+    PARK_YIELD = 0, /* Queue it again */
+    PARK_WAIT,      /* Arm wait_fd in epoll */
+    PARK_DONE       /* Free it */
+} park_t;
+
+typedef struct fiber
+{
+    ucontext_t      context;     /* Saved registers while parked */
+    ucontext_t *    p_return;    /* Worker context while running */
+    fiber_sched_t * p_sched;
+    fiber_fn_t      fiber_fn;
+    void *          p_arg;
+    uint8_t *       p_stack;     /* Lowest page is a guard page */
+    park_t          park;
+    int             wait_fd;
+    uint32_t        wait_events; /* epoll events for PARK_WAIT */
+    int             wait_error;  /* errno if arming failed or timed out */
+    wheel_timer_t   wait_timer;  /* Pending while a timed wait is armed */
+    int             idle_ms;     /* Limit per wait, or FIBER_NO_TIMEOUT */
+    uint64_t        deadline_ms; /* Limit for all waits, or
+                                    TIMER_WHEEL_NEVER */
+} fiber_t;
+
+struct fiber_sched
+{
+    thread_pool_t * p_pool;
+    int             epoll_fd;
+    int             wake_fds[2];  /* Stops the epoll thread */
+    pthread_t       loop_thread;
+    size_t          stack_size;
+    size_t          page_size;
+    pthread_mutex_t lock;         /* Guards live and b_stopping */
+    pthread_cond_t  idle;         /* Signalled when live drops to 0 */
+    uint64_t        live;
+    bool            b_stopping;
+    pthread_mutex_t timer_lock;   /* Guards timers and planned_wake */
+    timer_wheel_t   timers;       /* Timed waits, in ms ticks */
+    uint64_t        planned_wake; /* Tick the epoll thread sleeps until */
+};
+
+/*************************************************************************
+ * Private Data
+ *************************************************************************/
+
+static __thread fiber_t * gp_current = NULL;
+
+// Context of the worker thread while one of its fibers runs
+static __thread ucontext_t g_worker_context;
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static fiber_t * current_fiber(void) __attribute__((noinline));
+static void      set_current_fiber(fiber_t * p_fiber)
+    __attribute__((noinline));
+static void      fiber_entry(void);
+static void      park(fiber_t * p_fiber, park_t what);
+static void *    resume_job(void * p_arg);
+static int       schedule(fiber_t * p_fiber);
+static void      arm(fiber_t * p_fiber);
+static bool      arm_fd(fiber_t * p_fiber);
+static void      on_wait_timeout(wheel_timer_t * p_timer, void * p_arg);
+static void      wake_loop(fiber_sched_t * p_sched);
+static int       sleep_ms(uint64_t next_tick);
+static uint64_t  now_ms(void);
+static void      free_fiber(fiber_t * p_fiber);
+static void *    event_loop(void * p_arg);
+static bool      would_block(void);
+static void      release(fiber_sched_t * p_sched);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Starts a scheduler with its own pool and epoll thread.
+ *
+ * @param[in] num_threads Pool workers that run fibers (> 0)
+ * @param[in] stack_size  Stack bytes per fiber, 0 for FIBER_DEFAULT_STACK
+ *
+ * @return Pointer to the scheduler, or NULL on failure
+ */
+fiber_sched_t *
+fiber_sched_create(int num_threads, size_t stack_size)
+{
+    if ((num_threads <= 0)
+        || ((0 != stack_size) && (stack_size < FIBER_MIN_STACK)))
+    {
+        return NULL;
+    }
+
+    fiber_sched_t * p_sched = calloc(1, sizeof(fiber_sched_t));
+    if (NULL == p_sched)
+    {
+        return NULL;
+    }
+
+    // Resumes are never refused, however many fibers are ready at once
+    thread_pool_config_t config = thread_pool_config_default(num_threads);
+    config.queue_capacity       = 0;
+
+    p_sched->page_size  = (size_t)sysconf(_SC_PAGESIZE);
+    p_sched->stack_size = (0 == stack_size) ? FIBER_DEFAULT_STACK : stack_size;
+    p_sched->stack_size = ((p_sched->stack_size + p_sched->page_size - 1)
+                           / p_sched->page_size)
+                          * p_sched->page_size;
+    p_sched->wake_fds[0] = -1;
+    p_sched->wake_fds[1] = -1;
+    pthread_mutex_init(&p_sched->lock, NULL);
+    pthread_cond_init(&p_sched->idle, NULL);
+    pthread_mutex_init(&p_sched->timer_lock, NULL);
+    (void)timer_wheel_init(&p_sched->timers, now_ms());
+    p_sched->planned_wake = TIMER_WHEEL_NEVER;
+
+    struct epoll_event wake = { .events = EPOLLIN, .data.ptr = NULL };
+
+    p_sched->epoll_fd = epoll_create1(0);
+    if ((p_sched->epoll_fd < 0) || (0 != pipe(p_sched->wake_fds))
+        || (0 != fcntl(p_sched->wake_fds[1], F_SETFL, O_NONBLOCK))
+        || (0 != epoll_ctl(p_sched->epoll_fd,
+                           EPOLL_CTL_ADD,
+                           p_sched->wake_fds[0],
+                           &wake)))
+    {
+        release(p_sched);
+        return NULL;
+    }
+
+    p_sched->p_pool = thread_pool_initialize_ex(&config);
+    if (NULL == p_sched->p_pool)
+    {
+        release(p_sched);
+        return NULL;
+    }
+
+    if (0 != pthread_create(&p_sched->loop_thread, NULL, event_loop, p_sched))
+    {
+        thread_pool_destroy(p_sched->p_pool);
+        release(p_sched);
+        return NULL;
+    }
+
+    return p_sched;
+}
+
+/*!
+ * @brief Starts a fiber. May be called from any thread or fiber.
+ *
+ * @param[in] p_sched  Scheduler
+ * @param[in] fiber_fn Body
+ * @param[in] p_arg    Argument for the body
+ *
+ * @return FIBER_SUCCESS or a negative error code
+ */
+int
+fiber_spawn(fiber_sched_t * p_sched, fiber_fn_t fiber_fn, void * p_arg)
+{
+    if ((NULL == p_sched) || (NULL == fiber_fn))
+    {
+        return FIBER_ERROR_PARAM;
+    }
+
+    fiber_t * p_fiber = calloc(1, sizeof(fiber_t));
+    void *    p_stack = NULL;
+
+    if ((NULL == p_fiber)
+        || (0 != posix_memalign(&p_stack,
+                                p_sched->page_size,
+                                p_sched->stack_size)))
+    {
+        free(p_fiber);
+        return FIBER_ERROR_MEMORY;
+    }
+
+    p_fiber->p_sched     = p_sched;
+    p_fiber->fiber_fn    = fiber_fn;
+    p_fiber->p_arg       = p_arg;
+    p_fiber->p_stack     = p_stack;
+    p_fiber->idle_ms     = FIBER_NO_TIMEOUT;
+    p_fiber->deadline_ms = TIMER_WHEEL_NEVER;
+    wheel_timer_init(&p_fiber->wait_timer, on_wait_timeout, p_fiber);
+
+    // An overflow faults on the guard page instead of corrupting the heap
+    mprotect(p_fiber->p_stack, p_sched->page_size, PROT_NONE);
+
+    getcontext(&p_fiber->context);
+    p_fiber->context.uc_stack.ss_sp   = p_fiber->p_stack + p_sched->page_size;
+    p_fiber->context.uc_stack.ss_size = p_sched->stack_size
+                                        - p_sched->page_size;
+    p_fiber->context.uc_link          = NULL;
+    makecontext(&p_fiber->context, fiber_entry, 0);
+
+    pthread_mutex_lock(&p_sched->lock);
+    bool b_stopping = p_sched->b_stopping;
+    p_sched->live  += b_stopping ? 0 : 1;
+    pthread_mutex_unlock(&p_sched->lock);
+
+    if (b_stopping)
+    {
+        free_fiber(p_fiber);
+        return FIBER_ERROR_QUEUE;
+    }
+
+    int status = schedule(p_fiber);
+    if (FIBER_SUCCESS != status)
+    {
+        pthread_mutex_lock(&p_sched->lock);
+        p_sched->live--;
+        pthread_mutex_unlock(&p_sched->lock);
+        free_fiber(p_fiber);
+    }
+
+    return status;
+}
+
+/*!
+ * @brief Number of fibers started and not yet finished.
+ *
+ * @param[in] p_sched Scheduler
+ *
+ * @return Live fiber count
+ */
+uint64_t
+fiber_sched_live(fiber_sched_t * p_sched)
+{
+    if (NULL == p_sched)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&p_sched->lock);
+    uint64_t live = p_sched->live;
+    pthread_mutex_unlock(&p_sched->lock);
+
+    return live;
+}
+
+/*!
+ * @brief Blocks the calling thread until every fiber has finished.
+ *
+ * @param[in] p_sched Scheduler
+ */
+void
+fiber_sched_wait(fiber_sched_t * p_sched)
+{
+    if (NULL == p_sched)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&p_sched->lock);
+    while (0 != p_sched->live)
+    {
+        pthread_cond_wait(&p_sched->idle, &p_sched->lock);
+    }
+    pthread_mutex_unlock(&p_sched->lock);
+}
+
+/*!
+ * @brief Waits for all fibers, then stops the pool and epoll thread.
+ *
+ * @param[in,out] pp_sched Pointer to the scheduler pointer; set to NULL
+ */
+void
+fiber_sched_destroy(fiber_sched_t ** pp_sched)
+{
+    if ((NULL == pp_sched) || (NULL == *pp_sched))
+    {
+        return;
+    }
+
+    fiber_sched_t * p_sched = *pp_sched;
+    fiber_sched_wait(p_sched);
+
+    pthread_mutex_lock(&p_sched->lock);
+    p_sched->b_stopping = true;
+    pthread_mutex_unlock(&p_sched->lock);
+
+    wake_loop(p_sched);
+    pthread_join(p_sched->loop_thread, NULL);
+
+    thread_pool_shutdown(p_sched->p_pool);
+    thread_pool_destroy(p_sched->p_pool);
+
+    release(p_sched);
+    *pp_sched = NULL;
+}
+
+/*!
+ * @brief Whether the caller is running on a fiber.
+ *
+ * @return true inside a fiber
+ */
+bool
+fiber_is_running(void)
+{
+    return NULL != current_fiber();
+}
+
+/*!
+ * @brief Lets other ready fibers run; returns at once outside a fiber.
+ */
+void
+fiber_yield(void)
+{
+    fiber_t * p_fiber = current_fiber();
+
+    if (NULL != p_fiber)
+    {
+        park(p_fiber, PARK_YIELD);
+    }
+}
+
+/*!
+ * @brief Limits every later wait of the calling fiber to timeout_ms.
+ *
+ * @param[in] timeout_ms Milliseconds, or FIBER_NO_TIMEOUT
+ *
+ * @return FIBER_SUCCESS, or FIBER_ERROR_PARAM outside a fiber
+ */
+int
+fiber_set_idle_timeout(int timeout_ms)
+{
+    fiber_t * p_fiber = current_fiber();
+
+    if ((NULL == p_fiber)
+        || ((timeout_ms < 0) && (FIBER_NO_TIMEOUT != timeout_ms)))
+    {
+        return FIBER_ERROR_PARAM;
+    }
+
+    p_fiber->idle_ms = timeout_ms;
+    return FIBER_SUCCESS;
+}
+
+/*!
+ * @brief Makes every wait of the calling fiber that has not finished
+ *        timeout_ms from now fail.
+ *
+ * @param[in] timeout_ms Milliseconds from now, or FIBER_NO_TIMEOUT
+ *
+ * @return FIBER_SUCCESS, or FIBER_ERROR_PARAM outside a fiber
+ */
+int
+fiber_set_deadline(int timeout_ms)
+{
+    fiber_t * p_fiber = current_fiber();
+
+    if ((NULL == p_fiber)
+        || ((timeout_ms < 0) && (FIBER_NO_TIMEOUT != timeout_ms)))
+    {
+        return FIBER_ERROR_PARAM;
+    }
+
+    p_fiber->deadline_ms = (FIBER_NO_TIMEOUT == timeout_ms)
+                               ? TIMER_WHEEL_NEVER
+                               : (now_ms() + (uint64_t)timeout_ms);
+    return FIBER_SUCCESS;
+}
+
+/*!
+ * @brief Waits until a descriptor is readable or writable.
+ *
+ * @param[in] fd     Descriptor
+ * @param[in] events FIBER_WAIT_READ and/or FIBER_WAIT_WRITE
+ *
+ * @return 0, or -1 with errno set
+ */
+int
+fiber_wait_fd(int fd, uint32_t events)
+{
+    fiber_t * p_fiber = current_fiber();
+
+    if ((fd < 0) || (0 == (events & (FIBER_WAIT_READ | FIBER_WAIT_WRITE))))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (NULL == p_fiber)
+    {
+        struct pollfd pfd = {
+            .fd     = fd,
+            .events = (short)(((0 != (events & FIBER_WAIT_READ)) ? POLLIN : 0)
+                              | ((0 != (events & FIBER_WAIT_WRITE)) ? POLLOUT
+                                                                    : 0))
+        };
+        return (poll(&pfd, 1, -1) < 0) ? -1 : 0;
+    }
+
+    p_fiber->wait_fd     = fd;
+    p_fiber->wait_events = ((0 != (events & FIBER_WAIT_READ)) ? EPOLLIN : 0)
+                           | ((0 != (events & FIBER_WAIT_WRITE)) ? EPOLLOUT
+                                                                 : 0);
+    p_fiber->wait_error  = 0;
+    park(p_fiber, PARK_WAIT);
+
+    if (0 != p_fiber->wait_error)
+    {
+        errno = p_fiber->wait_error;
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief recv() that suspends the fiber instead of blocking the thread.
+ *
+ * @return As recv()
+ */
+ssize_t
+fiber_recv(int fd, void * p_buf, size_t len, int flags)
+{
+    if (!fiber_is_running())
+    {
+        return recv(fd, p_buf, len, flags);
+    }
+
+    for (;;)
+    {
+        ssize_t got = recv(fd, p_buf, len, flags | MSG_DONTWAIT);
+        if ((got >= 0) || !would_block()
+            || (0 != fiber_wait_fd(fd, FIBER_WAIT_READ)))
+        {
+            return got;
+        }
+    }
+}
+
+/*!
+ * @brief send() that suspends the fiber instead of blocking the thread.
+ *
+ * @return As send()
+ */
+ssize_t
+fiber_send(int fd, const void * p_buf, size_t len, int flags)
+{
+    if (!fiber_is_running())
+    {
+        return send(fd, p_buf, len, flags | MSG_NOSIGNAL);
+    }
+
+    for (;;)
+    {
+        ssize_t sent
+            = send(fd, p_buf, len, flags | MSG_DONTWAIT | MSG_NOSIGNAL);
+        if ((sent >= 0) || !would_block()
+            || (0 != fiber_wait_fd(fd, FIBER_WAIT_WRITE)))
+        {
+            return sent;
+        }
+    }
+}
+
+/*!
+ * @brief accept() that suspends the fiber instead of blocking the thread.
+ *
+ * @return As accept()
+ */
+int
+fiber_accept(int fd, struct sockaddr * p_addr, socklen_t * p_addr_len)
+{
+    if (!fiber_is_running())
+    {
+        return accept(fd, p_addr, p_addr_len);
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    if ((flags >= 0) && (0 == (flags & O_NONBLOCK)))
+    {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    for (;;)
+    {
+        int client = accept(fd, p_addr, p_addr_len);
+        if ((client >= 0) || !would_block()
+            || (0 != fiber_wait_fd(fd, FIBER_WAIT_READ)))
+        {
+            return client;
+        }
+    }
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static fiber_t *
+current_fiber(void)
+{
+    return gp_current;
+}
+
+static void
+set_current_fiber(fiber_t * p_fiber)
+{
+    gp_current = p_fiber;
+}
+
+/*!
+ * @brief First code run on a fiber's stack.
+ */
+static void
+fiber_entry(void)
+{
+    fiber_t * p_fiber = current_fiber();
+
+    p_fiber->fiber_fn(p_fiber->p_arg);
+
+    // Whichever worker runs the fiber now frees it
+    p_fiber->park = PARK_DONE;
+    setcontext(p_fiber->p_return);
+}
+
+/*!
+ * @brief Switches from a fiber back to the worker running it.
+ *
+ * @param[in,out] p_fiber Running fiber
+ * @param[in]     what    What the worker should do with it
+ */
+static void
+park(fiber_t * p_fiber, park_t what)
+{
+    p_fiber->park = what;
+    swapcontext(&p_fiber->context, p_fiber->p_return);
+}
+
+/*!
+ * @brief Pool job: runs a fiber until it parks, then acts on the park.
+ *
+ * @param[in] p_arg Fiber
+ *
+ * @return NULL in all cases
+ */
+static void *
+resume_job(void * p_arg)
+{
+    fiber_t * p_fiber = p_arg;
+
+    p_fiber->p_return = &g_worker_context;
+    set_current_fiber(p_fiber);
+    swapcontext(&g_worker_context, &p_fiber->context);
+    set_current_fiber(NULL);
+
+    switch (p_fiber->park)
+    {
+        case PARK_YIELD:
+            schedule(p_fiber);
+            break;
+
+        case PARK_WAIT:
+            arm(p_fiber);
+            break;
+
+        case PARK_DONE:
+        default:
+        {
+            fiber_sched_t * p_sched = p_fiber->p_sched;
+            free_fiber(p_fiber);
+
+            pthread_mutex_lock(&p_sched->lock);
+            if (0 == --p_sched->live)
+            {
+                pthread_cond_broadcast(&p_sched->idle);
+            }
+            pthread_mutex_unlock(&p_sched->lock);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief Queues a fiber to be resumed by a pool worker.
+ *
+ * @param[in] p_fiber Parked fiber
+ *
+ * @return FIBER_SUCCESS or FIBER_ERROR_QUEUE
+ */
+static int
+schedule(fiber_t * p_fiber)
+{
+    thread_job_t job = { .job_fn = resume_job, .p_arg = p_fiber };
+
+    return (THREAD_POOL_SUCCESS
+            == thread_pool_submit(p_fiber->p_sched->p_pool, &job))
+               ? FIBER_SUCCESS
+               : FIBER_ERROR_QUEUE;
+}
+
+/*!
+ * @brief Arms a parked fiber's descriptor for one readiness event, and
+ *        its timer if the wait is timed.
+ *
+ * A descriptor that cannot be polled, or a wait whose time has already
+ * run out, resumes the fiber with the error.
+ *
+ * @param[in,out] p_fiber Fiber parked in PARK_WAIT
+ */
+static void
+arm(fiber_t * p_fiber)
+{
+    fiber_sched_t * p_sched = p_fiber->p_sched;
+    uint64_t        expires = p_fiber->deadline_ms;
+    int             error   = 0;
+    bool            b_wake  = false;
+
+    if (FIBER_NO_TIMEOUT != p_fiber->idle_ms)
+    {
+        uint64_t idle_end = now_ms() + (uint64_t)p_fiber->idle_ms;
+        expires           = (idle_end < expires) ? idle_end : expires;
+    }
+
+    if (TIMER_WHEEL_NEVER == expires)
+    {
+        if (arm_fd(p_fiber))
+        {
+            return;
+        }
+
+        p_fiber->wait_error = errno;
+        schedule(p_fiber);
+        return;
+    }
+
+    pthread_mutex_lock(&p_sched->timer_lock);
+
+    if (expires <= now_ms())
+    {
+        error = ETIMEDOUT;
+    }
+    else if (!arm_fd(p_fiber))
+    {
+        error = errno;
+    }
+    else
+    {
+        (void)timer_wheel_add(&p_sched->timers, &p_fiber->wait_timer, expires);
+
+        // Only one wake per earlier deadline, however many fibers arm
+        if (expires < p_sched->planned_wake)
+        {
+            p_sched->planned_wake = expires;
+            b_wake                = true;
+        }
+    }
+
+    pthread_mutex_unlock(&p_sched->timer_lock);
+
+    if (0 != error)
+    {
+        p_fiber->wait_error = error;
+        schedule(p_fiber);
+    }
+    else if (b_wake)
+    {
+        wake_loop(p_sched);
+    }
+}
+
+/*!
+ * @brief Registers or re-arms a fiber's descriptor in epoll, one-shot.
+ *
+ * @param[in] p_fiber Fiber parked in PARK_WAIT
+ *
+ * @return true on success, false with errno set
+ */
+static bool
+arm_fd(fiber_t * p_fiber)
+{
+    int                epoll_fd = p_fiber->p_sched->epoll_fd;
+    struct epoll_event event    = {
+        .events   = p_fiber->wait_events | EPOLLONESHOT,
+        .data.ptr = p_fiber,
+    };
+
+    // Descriptors stay registered, disarmed, between waits
+    return (0 == epoll_ctl(epoll_fd, EPOLL_CTL_MOD, p_fiber->wait_fd, &event))
+           || ((ENOENT == errno)
+               && (0 == epoll_ctl(epoll_fd,
+                                  EPOLL_CTL_ADD,
+                                  p_fiber->wait_fd,
+                                  &event)));
+}
+
+/*!
+ * @brief Timer callback, on the epoll thread with timer_lock held: a
+ *        timed wait ran out.
+ *
+ * @param[in] p_timer Fiber's wait timer
+ * @param[in] p_arg   Fiber
+ */
+static void
+on_wait_timeout(wheel_timer_t * p_timer, void * p_arg)
+{
+    fiber_t *          p_fiber = p_arg;
+    struct epoll_event event   = { .events = 0, .data.ptr = p_fiber };
+
+    (void)p_timer;
+
+    // Disarmed, a late readiness event cannot resume the fiber again
+    (void)epoll_ctl(p_fiber->p_sched->epoll_fd,
+                    EPOLL_CTL_MOD,
+                    p_fiber->wait_fd,
+                    &event);
+    p_fiber->wait_error = ETIMEDOUT;
+    schedule(p_fiber);
+}
+
+/*!
+ * @brief Frees a fiber that is not running.
+ *
+ * @param[in] p_fiber Fiber
+ */
+static void
+free_fiber(fiber_t * p_fiber)
+{
+    // The guard page must be writable again before the heap reuses it
+    mprotect(p_fiber->p_stack,
+             p_fiber->p_sched->page_size,
+             PROT_READ | PROT_WRITE);
+    free(p_fiber->p_stack);
+    free(p_fiber);
+}
+
+/*!
+ * @brief Epoll thread: queues every fiber whose descriptor became ready
+ *        or whose wait timed out.
+ *
+ * @param[in] p_arg Scheduler
+ *
+ * @return NULL in all cases
+ */
+static void *
+event_loop(void * p_arg)
+{
+    fiber_sched_t *    p_sched = p_arg;
+    struct epoll_event events[EVENT_BATCH];
+
+    for (;;)
+    {
+        pthread_mutex_lock(&p_sched->timer_lock);
+        uint64_t next_tick    = timer_wheel_next_tick(&p_sched->timers);
+        p_sched->planned_wake = next_tick;
+        pthread_mutex_unlock(&p_sched->timer_lock);
+
+        int count = epoll_wait(p_sched->epoll_fd,
+                               events,
+                               EVENT_BATCH,
+                               sleep_ms(next_tick));
+        if ((count < 0) && (EINTR != errno))
+        {
+            return NULL;
+        }
+
+        for (int idx = 0; idx < count; idx++)
+        {
+            fiber_t * p_fiber = events[idx].data.ptr;
+
+            if (NULL != p_fiber)
+            {
+                pthread_mutex_lock(&p_sched->timer_lock);
+                (void)timer_wheel_cancel(&p_sched->timers,
+                                         &p_fiber->wait_timer);
+                pthread_mutex_unlock(&p_sched->timer_lock);
+
+                schedule(p_fiber);
+                continue;
+            }
+
+            char drain[WAKE_DRAIN];
+            ssize_t ignored = read(p_sched->wake_fds[0], drain, sizeof(drain));
+            (void)ignored;
+
+            pthread_mutex_lock(&p_sched->lock);
+            bool b_stopping = p_sched->b_stopping;
+            pthread_mutex_unlock(&p_sched->lock);
+
+            if (b_stopping)
+            {
+                return NULL;
+            }
+        }
+
+        pthread_mutex_lock(&p_sched->timer_lock);
+        (void)timer_wheel_advance(&p_sched->timers, now_ms());
+        pthread_mutex_unlock(&p_sched->timer_lock);
+    }
+}
+
+/*!
+ * @brief Interrupts the epoll thread's wait. The pipe is non-blocking,
+ *        and a full pipe already guarantees a wake.
+ *
+ * @param[in] p_sched Scheduler
+ */
+static void
+wake_loop(fiber_sched_t * p_sched)
+{
+    char    byte    = 0;
+    ssize_t ignored = write(p_sched->wake_fds[1], &byte, 1);
+    (void)ignored;
+}
+
+/*!
+ * @brief epoll_wait() timeout that wakes at a wheel tick.
+ *
+ * @param[in] next_tick Tick in ms, or TIMER_WHEEL_NEVER
+ *
+ * @return Milliseconds, or -1 to wait indefinitely
+ */
+static int
+sleep_ms(uint64_t next_tick)
+{
+    uint64_t now = now_ms();
+
+    if (TIMER_WHEEL_NEVER == next_tick)
+    {
+        return -1;
+    }
+
+    if (next_tick <= now)
+    {
+        return 0;
+    }
+
+    return (next_tick - now > (uint64_t)INT_MAX) ? INT_MAX
+                                                 : (int)(next_tick - now);
+}
+
+static uint64_t
+now_ms(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000u) + ((uint64_t)now.tv_nsec / 1000000u);
+}
+
+static bool
+would_block(void)
+{
+    return (EAGAIN == errno) || (EWOULDBLOCK == errno);
+}
+
+/*!
+ * @brief Closes a scheduler's descriptors and frees it.
+ *
+ * @param[in] p_sched Scheduler whose threads are not running
+ */
+static void
+release(fiber_sched_t * p_sched)
+{
+    if (p_sched->epoll_fd >= 0)
+    {
+        close(p_sched->epoll_fd);
+    }
+    if (p_sched->wake_fds[0] >= 0)
+    {
+        close(p_sched->wake_fds[0]);
+        close(p_sched->wake_fds[1]);
+    }
+    pthread_cond_destroy(&p_sched->idle);
+    pthread_mutex_destroy(&p_sched->lock);
+    pthread_mutex_destroy(&p_sched->timer_lock);
+    free(p_sched);
+}
+
+/*** end of file ***/
@@ -0,0 +1,634 @@
+/** @file intern.c
+ *
+ * @brief Implementation of the string interning pool.
+ *
+ * Each canonical copy is laid out in a chunk as a header { hash, id, len }
+ * followed by the bytes and a NUL, aligned to four bytes, and the pointer
+ * handed out is to the bytes. Chunks are CHUNK_SIZE bytes; a string too
+ * big to share one gets a chunk of its own. Nothing in a chunk moves or is
+ * freed before the pool is, which is what keeps the pointers stable.
+ *
+ * The hash's top SHARD_BITS bits pick the shard, and its low bits the
+ * slot in that shard's open-addressing index, kept at most half full so
+ * linear probes stay short. A slot holds the string pointer and its hash,
+ * so most mismatches are rejected without touching the string.
+ *
+ * Ids come from one atomic counter, starting at 1. The id directory is a
+ * fixed array of pages of PAGE_IDS string pointers, allocated when the
+ * first id in them is handed out and installed with a compare-and-swap.
+ * An entry is stored with release order once its string is complete, and
+ * intern_lookup() loads it with acquire order, so it needs no lock.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/intern.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define SHARD_BITS    (4u)   /* log2(INTERN_SHARDS) */
+#define CHUNK_SIZE    (64u * 1024u)
+#define MIN_SLOTS     (16u)  /* Per shard */
+#define MAX_SLOTS     (1u << 31)
+#define PAGE_BITS     (14u)
+#define PAGE_IDS      (1u << PAGE_BITS)
+#define PAGE_COUNT    (INTERN_MAX_IDS / PAGE_IDS)
+#define HEADER_ALIGN  (sizeof(uint32_t))
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* In front of every canonical copy */
+typedef struct
+{
+    uint32_t hash;
+    uint32_t id;
+    uint32_t len;
+} intern_header_t;
+
+typedef struct intern_chunk
+{
+    struct intern_chunk * p_next;
+    size_t                used;
+    size_t                size;
+    char                  data[];
+} intern_chunk_t;
+
+typedef struct
+{
+    const char * p_str;   /* NULL if the slot is empty */
+    uint32_t     hash;
+} intern_slot_t;
+
+typedef struct
+{
+    pthread_mutex_t  lock;
+    intern_slot_t *  p_slots;
+    uint32_t         mask;         /* Slots - 1 */
+    uint32_t         count;
+    intern_chunk_t * p_chunks;     /* Chunk being filled first */
+    size_t           arena_bytes;
+    size_t           string_bytes;
+} intern_shard_t;
+
+struct intern_pool
+{
+    intern_shard_t shards[INTERN_SHARDS];
+    uint32_t       next_id;               /* Atomic */
+    const char **  pp_pages[PAGE_COUNT];  /* Atomic; NULL until needed */
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint64_t               mix64(uint64_t value);
+static uint32_t               hash_bytes(const char * p_bytes, size_t len);
+static const intern_header_t * header_of(const char * p_str);
+static intern_shard_t *       shard_of(intern_pool_t * p_pool, uint32_t hash);
+static const char *           find_locked(const intern_shard_t * p_shard,
+                                          const char *           p_bytes,
+                                          size_t                 len,
+                                          uint32_t               hash);
+static const char *           add_locked(intern_pool_t *  p_pool,
+                                         intern_shard_t * p_shard,
+                                         const char *     p_bytes,
+                                         size_t           len,
+                                         uint32_t         hash);
+static bool                   grow_index(intern_shard_t * p_shard);
+static char *                 arena_alloc(intern_shard_t * p_shard, size_t size);
+static const char **          directory_page(intern_pool_t * p_pool, uint32_t id);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+intern_pool_t *
+intern_create(uint32_t expected)
+{
+    intern_pool_t * p_pool = calloc(1u, sizeof(*p_pool));
+
+    if (NULL == p_pool)
+    {
+        return NULL;
+    }
+
+    // Each shard's index starts big enough for its share at half load
+    uint32_t slots = MIN_SLOTS;
+
+    while ((slots < (MAX_SLOTS / 2u))
+           && ((uint64_t)slots < (2u * ((uint64_t)expected / INTERN_SHARDS + 1u))))
+    {
+        slots *= 2u;
+    }
+
+    p_pool->next_id = 1u;
+
+    for (uint32_t shard = 0; shard < INTERN_SHARDS; shard++)
+    {
+        intern_shard_t * p_shard = &p_pool->shards[shard];
+
+        p_shard->p_slots = calloc(slots, sizeof(intern_slot_t));
+
+        if ((NULL == p_shard->p_slots)
+            || (0 != pthread_mutex_init(&p_shard->lock, NULL)))
+        {
+            free(p_shard->p_slots);
+
+            while (shard-- > 0u)
+            {
+                pthread_mutex_destroy(&p_pool->shards[shard].lock);
+                free(p_pool->shards[shard].p_slots);
+            }
+
+            free(p_pool);
+            return NULL;
+        }
+
+        p_shard->mask = slots - 1u;
+    }
+
+    return p_pool;
+}
+
+void
+intern_destroy(intern_pool_t ** pp_pool)
+{
+    if ((NULL == pp_pool) || (NULL == *pp_pool))
+    {
+        return;
+    }
+
+    intern_pool_t * p_pool = *pp_pool;
+
+    for (uint32_t shard = 0; shard < INTERN_SHARDS; shard++)
+    {
+        intern_shard_t * p_shard = &p_pool->shards[shard];
+        intern_chunk_t * p_chunk = p_shard->p_chunks;
+
+        while (NULL != p_chunk)
+        {
+            intern_chunk_t * p_next = p_chunk->p_next;
+            free(p_chunk);
+            p_chunk = p_next;
+        }
+
+        free(p_shard->p_slots);
+        pthread_mutex_destroy(&p_shard->lock);
+    }
+
+    for (uint32_t page = 0; page < PAGE_COUNT; page++)
+    {
+        free((void *)p_pool->pp_pages[page]);
+    }
+
+    free(p_pool);
+    *pp_pool = NULL;
+}
+
+const char *
+intern_bytes(intern_pool_t * p_pool, const char * p_bytes, size_t len)
+{
+    if ((NULL == p_pool) || ((NULL == p_bytes) && (len > 0u))
+        || (len > INTERN_MAX_LEN))
+    {
+        return NULL;
+    }
+
+    uint32_t         hash    = hash_bytes(p_bytes, len);
+    intern_shard_t * p_shard = shard_of(p_pool, hash);
+
+    pthread_mutex_lock(&p_shard->lock);
+
+    const char * p_str = find_locked(p_shard, p_bytes, len, hash);
+
+    if (NULL == p_str)
+    {
+        p_str = add_locked(p_pool, p_shard, p_bytes, len, hash);
+    }
+
+    pthread_mutex_unlock(&p_shard->lock);
+
+    return p_str;
+}
+
+const char *
+intern_string(intern_pool_t * p_pool, const char * p_str)
+{
+    if (NULL == p_str)
+    {
+        return NULL;
+    }
+
+    return intern_bytes(p_pool, p_str, strlen(p_str));
+}
+
+uint32_t
+intern_id(intern_pool_t * p_pool, const char * p_bytes, size_t len)
+{
+    const char * p_str = intern_bytes(p_pool, p_bytes, len);
+
+    return (NULL == p_str) ? INTERN_NONE : header_of(p_str)->id;
+}
+
+const char *
+intern_find(intern_pool_t * p_pool, const char * p_bytes, size_t len)
+{
+    if ((NULL == p_pool) || ((NULL == p_bytes) && (len > 0u))
+        || (len > INTERN_MAX_LEN))
+    {
+        return NULL;
+    }
+
+    uint32_t         hash    = hash_bytes(p_bytes, len);
+    intern_shard_t * p_shard = shard_of(p_pool, hash);
+
+    pthread_mutex_lock(&p_shard->lock);
+    const char * p_str = find_locked(p_shard, p_bytes, len, hash);
+    pthread_mutex_unlock(&p_shard->lock);
+
+    return p_str;
+}
+
+const char *
+intern_lookup(const intern_pool_t * p_pool, uint32_t id)
+{
+    if ((NULL == p_pool) || (INTERN_NONE == id) || (id >= INTERN_MAX_IDS))
+    {
+        return NULL;
+    }
+
+    const char ** pp_page = __atomic_load_n(&p_pool->pp_pages[id >> PAGE_BITS],
+                                            __ATOMIC_ACQUIRE);
+
+    if (NULL == pp_page)
+    {
+        return NULL;
+    }
+
+    return __atomic_load_n(&pp_page[id & (PAGE_IDS - 1u)], __ATOMIC_ACQUIRE);
+}
+
+uint32_t
+intern_id_of(const char * p_str)
+{
+    return (NULL == p_str) ? INTERN_NONE : header_of(p_str)->id;
+}
+
+uint32_t
+intern_hash_of(const char * p_str)
+{
+    return (NULL == p_str) ? 0u : header_of(p_str)->hash;
+}
+
+size_t
+intern_length_of(const char * p_str)
+{
+    return (NULL == p_str) ? 0u : header_of(p_str)->len;
+}
+
+uint32_t
+intern_key_hash(const void * p_key, uint32_t capacity)
+{
+    return header_of(p_key)->hash % capacity;
+}
+
+bool
+intern_key_equals(const void * p_key1, const void * p_key2)
+{
+    return p_key1 == p_key2;
+}
+
+void
+intern_stats(intern_pool_t * p_pool, intern_stats_t * p_stats)
+{
+    if (NULL == p_stats)
+    {
+        return;
+    }
+
+    memset(p_stats, 0, sizeof(*p_stats));
+
+    if (NULL == p_pool)
+    {
+        return;
+    }
+
+    p_stats->index_bytes = sizeof(*p_pool);
+
+    for (uint32_t shard = 0; shard < INTERN_SHARDS; shard++)
+    {
+        intern_shard_t * p_shard = &p_pool->shards[shard];
+
+        pthread_mutex_lock(&p_shard->lock);
+        p_stats->strings      += p_shard->count;
+        p_stats->string_bytes += p_shard->string_bytes;
+        p_stats->arena_bytes  += p_shard->arena_bytes;
+        p_stats->index_bytes  += ((size_t)p_shard->mask + 1u)
+                                 * sizeof(intern_slot_t);
+        pthread_mutex_unlock(&p_shard->lock);
+    }
+
+    for (uint32_t page = 0; page < PAGE_COUNT; page++)
+    {
+        if (NULL != __atomic_load_n(&p_pool->pp_pages[page], __ATOMIC_ACQUIRE))
+        {
+            p_stats->index_bytes += PAGE_IDS * sizeof(const char *);
+        }
+    }
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+static uint64_t
+mix64(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+/*!
+ * @brief Hashes eight bytes at a time, and keeps the top 32 bits.
+ */
+static uint32_t
+hash_bytes(const char * p_bytes, size_t len)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ (uint64_t)len;
+
+    while (len >= 8u)
+    {
+        uint64_t word;
+
+        memcpy(&word, p_bytes, sizeof(word));
+        hash     = (hash ^ mix64(word)) * 0xFF51AFD7ED558CCDull;
+        p_bytes += 8u;
+        len     -= 8u;
+    }
+
+    if (len > 0u)
+    {
+        uint64_t word = 0u;
+
+        memcpy(&word, p_bytes, len);
+        hash = (hash ^ mix64(word)) * 0xFF51AFD7ED558CCDull;
+    }
+
+    return (uint32_t)(mix64(hash) >> 32);
+}
+
+static const intern_header_t *
+header_of(const char * p_str)
+{
+    return (const intern_header_t *)(const void *)p_str - 1;
+}
+
+static intern_shard_t *
+shard_of(intern_pool_t * p_pool, uint32_t hash)
+{
+    return &p_pool->shards[hash >> (32u - SHARD_BITS)];
+}
+
+static const char *
+find_locked(const intern_shard_t * p_shard,
+            const char *           p_bytes,
+            size_t                 len,
+            uint32_t               hash)
+{
+    uint32_t slot = hash & p_shard->mask;
+
+    for (;;)
+    {
+        const intern_slot_t * p_slot = &p_shard->p_slots[slot];
+
+        if (NULL == p_slot->p_str)
+        {
+            return NULL;
+        }
+
+        if ((p_slot->hash == hash) && (header_of(p_slot->p_str)->len == len)
+            && ((0u == len) || (0 == memcmp(p_slot->p_str, p_bytes, len))))
+        {
+            return p_slot->p_str;
+        }
+
+        slot = (slot + 1u) & p_shard->mask;
+    }
+}
+
+/*!
+ * @brief Copies a string the shard does not have into its arena, gives it
+ *        an id and indexes it.
+ *
+ * @return Canonical copy, or NULL if memory or ids ran out
+ */
+static const char *
+add_locked(intern_pool_t *  p_pool,
+           intern_shard_t * p_shard,
+           const char *     p_bytes,
+           size_t           len,
+           uint32_t         hash)
+{
+    if ((2u * ((uint64_t)p_shard->count + 1u)) > ((uint64_t)p_shard->mask + 1u)
+        && !grow_index(p_shard))
+    {
+        return NULL;
+    }
+
+    // A failed add after this wastes the id, which is harmless
+    uint32_t id = __atomic_fetch_add(&p_pool->next_id, 1u, __ATOMIC_RELAXED);
+
+    if (id >= INTERN_MAX_IDS)
+    {
+        return NULL;
+    }
+
+    const char ** pp_page = directory_page(p_pool, id);
+
+    if (NULL == pp_page)
+    {
+        return NULL;
+    }
+
+    size_t size = sizeof(intern_header_t) + len + 1u;
+    size        = (size + HEADER_ALIGN - 1u) & ~(HEADER_ALIGN - 1u);
+
+    char * p_block = arena_alloc(p_shard, size);
+
+    if (NULL == p_block)
+    {
+        return NULL;
+    }
+
+    intern_header_t header = { hash, id, (uint32_t)len };
+    char *          p_str  = p_block + sizeof(intern_header_t);
+
+    memcpy(p_block, &header, sizeof(header));
+    if (len > 0u)
+    {
+        memcpy(p_str, p_bytes, len);
+    }
+    p_str[len] = '\0';
+
+    __atomic_store_n(&pp_page[id & (PAGE_IDS - 1u)], p_str, __ATOMIC_RELEASE);
+
+    uint32_t slot = hash & p_shard->mask;
+
+    while (NULL != p_shard->p_slots[slot].p_str)
+    {
+        slot = (slot + 1u) & p_shard->mask;
+    }
+
+    p_shard->p_slots[slot].p_str = p_str;
+    p_shard->p_slots[slot].hash  = hash;
+    p_shard->count++;
+    p_shard->string_bytes += len + 1u;
+
+    return p_str;
+}
+
+/*!
+ * @brief Doubles a shard's index, reinserting from the stored hashes.
+ */
+static bool
+grow_index(intern_shard_t * p_shard)
+{
+    uint64_t slots = 2u * ((uint64_t)p_shard->mask + 1u);
+
+    if (slots > MAX_SLOTS)
+    {
+        return false;
+    }
+
+    intern_slot_t * p_slots = calloc((size_t)slots, sizeof(intern_slot_t));
+
+    if (NULL == p_slots)
+    {
+        return false;
+    }
+
+    uint32_t mask = (uint32_t)(slots - 1u);
+
+    for (uint64_t old = 0; old <= p_shard->mask; old++)
+    {
+        const intern_slot_t * p_old = &p_shard->p_slots[old];
+
+        if (NULL == p_old->p_str)
+        {
+            continue;
+        }
+
+        uint32_t slot = p_old->hash & mask;
+
+        while (NULL != p_slots[slot].p_str)
+        {
+            slot = (slot + 1u) & mask;
+        }
+
+        p_slots[slot] = *p_old;
+    }
+
+    free(p_shard->p_slots);
+    p_shard->p_slots = p_slots;
+    p_shard->mask    = mask;
+
+    return true;
+}
+
+/*!
+ * @brief Carves size bytes from the shard's current chunk, starting a new
+ *        one when it is full. A block over a quarter of a chunk gets a
+ *        chunk of its own, behind the current one, so the current one
+ *        keeps filling.
+ */
+static char *
+arena_alloc(intern_shard_t * p_shard, size_t size)
+{
+    intern_chunk_t * p_chunk = p_shard->p_chunks;
+
+    if ((NULL != p_chunk) && (size <= (p_chunk->size - p_chunk->used)))
+    {
+        char * p_block = p_chunk->data + p_chunk->used;
+        p_chunk->used += size;
+        return p_block;
+    }
+
+    bool   b_own = (size > (CHUNK_SIZE / 4u));
+    size_t bytes = b_own ? size : CHUNK_SIZE;
+
+    if (bytes > (SIZE_MAX - sizeof(intern_chunk_t)))
+    {
+        return NULL;
+    }
+
+    intern_chunk_t * p_new = malloc(sizeof(intern_chunk_t) + bytes);
+
+    if (NULL == p_new)
+    {
+        return NULL;
+    }
+
+    p_new->size = bytes;
+    p_new->used = size;
+    p_shard->arena_bytes += sizeof(intern_chunk_t) + bytes;
+
+    if (b_own && (NULL != p_chunk))
+    {
+        p_new->p_next   = p_chunk->p_next;
+        p_chunk->p_next = p_new;
+    }
+    else
+    {
+        p_new->p_next     = p_chunk;
+        p_shard->p_chunks = p_new;
+    }
+
+    return p_new->data;
+}
+
+/*!
+ * @brief Directory page holding the entry for id, allocated if this is
+ *        the first id in it. Threads racing to allocate it agree on one.
+ */
+static const char **
+directory_page(intern_pool_t * p_pool, uint32_t id)
+{
+    const char *** ppp_slot = &p_pool->pp_pages[id >> PAGE_BITS];
+    const char **  pp_page  = __atomic_load_n(ppp_slot, __ATOMIC_ACQUIRE);
+
+    if (NULL != pp_page)
+    {
+        return pp_page;
+    }
+
+    const char ** pp_new = calloc(PAGE_IDS, sizeof(const char *));
+
+    if (NULL == pp_new)
+    {
+        return NULL;
+    }
+
+    if (!__atomic_compare_exchange_n(ppp_slot, &pp_page, pp_new, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        // Another shard installed it first; pp_page now holds that one
+        free((void *)pp_new);
+        return pp_page;
+    }
+
+    return pp_new;
+}
+
+/*** end of file ***/
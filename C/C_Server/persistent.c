@@ -0,0 +1,1630 @@
+/** @file persistent.c
+ *
+ * @brief Implementation of the persistent vector, the persistent hash map
+ *        and the publishing cell.
+ *
+ * Every node and map entry carries a reference count: one per node or
+ * version that points at it. An update copies the nodes on the path to
+ * the change, taking a reference to every child it keeps; a node freed
+ * with its last reference drops its own. Counts change with atomic
+ * operations, so versions sharing nodes can be released on any thread.
+ *
+ * Vector: the root sits at level shift and leaves at level 0, each level
+ * taking 5 bits of the index. The last 1 to 32 elements are in the tail
+ * leaf; a push into a full tail moves the tail into the trie whole and
+ * starts a new one, adding a root level when the trie is full.
+ *
+ * Map: in the style of CHAMP, a node's slots hold its entries first, in
+ * bit order of datamap, then its child nodes, in bit order of nodemap.
+ * At shift 35 and beyond the hash is used up and a node is a collision
+ * list of count entries. Removal keeps the trie canonical: a child left
+ * with one entry is replaced by that entry in its parent, so the shape
+ * depends only on the keys, not on the order of updates.
+ *
+ * Cell: the word holds the version pointer in its low 48 bits and, above
+ * them, a signed count of loads in progress. A load adds one to the
+ * count, which keeps the version alive, takes a reference of its own,
+ * then takes its one back off the count if the version is still current.
+ * A store that swaps the version out adds the count it found to the old
+ * version's reference count, standing in for those loads, which then
+ * drop a reference instead. This is split reference counting.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "../include/persistent.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define BITS          (5u)
+#define WIDTH         (1u << BITS)
+#define MASK          (WIDTH - 1u)
+#define HASH_BITS     (32u)
+#define NO_SLOT       (UINT32_MAX)
+
+#define KIND_VEC      (1u)
+#define KIND_MAP      (2u)
+
+#define CELL_SHIFT    (48u)
+#define CELL_ONE      (1ull << CELL_SHIFT)
+#define CELL_POINTER  (CELL_ONE - 1u)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* First member of both kinds of version */
+typedef struct
+{
+    uint32_t refs;
+    uint32_t kind;
+} persist_header_t;
+
+typedef struct pvec_node
+{
+    uint32_t refs;
+    void *   p_slots[WIDTH]; /* Children, or elements in a leaf */
+} pvec_node_t;
+
+struct pvec
+{
+    persist_header_t header;
+    uint32_t         size;
+    uint32_t         shift;   /* Level of the root, at least BITS */
+    pvec_node_t *    p_root;  /* Never NULL, may be empty */
+    pvec_node_t *    p_tail;  /* NULL only when the vector is empty */
+    void (*value_retain)(void * p_data);
+    void (*value_release)(void * p_data);
+};
+
+typedef struct
+{
+    uint32_t refs;
+    uint32_t hash;
+    void *   p_key;
+    void *   p_value;
+} pmap_entry_t;
+
+typedef struct
+{
+    uint32_t refs;
+    uint32_t datamap;
+    uint32_t nodemap;
+    uint32_t count;      /* Slots in use */
+    void *   p_slots[];  /* Entries, then child nodes */
+} pmap_node_t;
+
+struct pmap
+{
+    persist_header_t header;
+    uint32_t         size;
+    pmap_node_t *    p_root;  /* Never NULL, may be empty */
+    uint32_t (*hash_function)(const void * p_key, uint32_t capacity);
+    bool (*key_equals)(const void * p_key1, const void * p_key2);
+    void * (*key_copy)(const void * p_key);
+    void (*key_free)(void * p_key);
+    void (*value_retain)(void * p_value);
+    void (*value_release)(void * p_value);
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static void          refs_retain(uint32_t * p_refs);
+static bool          refs_release(uint32_t * p_refs, uint32_t count);
+static void          version_release(void * p_version, uint32_t count);
+
+static pvec_node_t * vec_node_new(void);
+static void          vec_node_release(const pvec_t * p_vec,
+                                      pvec_node_t *  p_node,
+                                      uint32_t       level);
+static pvec_node_t * vec_node_copy(const pvec_t *      p_vec,
+                                   const pvec_node_t * p_node,
+                                   uint32_t            level,
+                                   uint32_t            skip);
+static pvec_t *      vec_version(const pvec_t * p_vec);
+static uint32_t      vec_tail_offset(uint32_t size);
+static pvec_node_t * vec_new_path(uint32_t level, pvec_node_t * p_leaf);
+static pvec_node_t * vec_push_tail(const pvec_t *      p_vec,
+                                   uint32_t            level,
+                                   const pvec_node_t * p_parent,
+                                   pvec_node_t *       p_leaf);
+static pvec_node_t * vec_assoc(const pvec_t *      p_vec,
+                               uint32_t            level,
+                               const pvec_node_t * p_node,
+                               uint32_t            position,
+                               void *              p_data);
+static bool          vec_pop_tail(const pvec_t *      p_vec,
+                                  uint32_t            level,
+                                  const pvec_node_t * p_node,
+                                  pvec_node_t **      pp_out);
+static pvec_node_t * vec_leaf_for(const pvec_t * p_vec, uint32_t position);
+
+static uint32_t      popcount(uint32_t bits);
+static pmap_t *      map_version(const pmap_t * p_map);
+static pmap_entry_t * map_entry_new(const pmap_t * p_map,
+                                    const void *   p_key,
+                                    void *         p_value,
+                                    uint32_t       hash);
+static void          map_entry_release(const pmap_t * p_map,
+                                       pmap_entry_t * p_entry);
+static pmap_node_t * map_node_new(uint32_t count);
+static void          map_node_release(const pmap_t * p_map,
+                                      pmap_node_t *  p_node,
+                                      uint32_t       shift);
+static pmap_node_t * map_node_rebuild(const pmap_node_t * p_old,
+                                      uint32_t            datamap,
+                                      uint32_t            nodemap,
+                                      uint32_t            count,
+                                      uint32_t            skip,
+                                      uint32_t            insert_at,
+                                      void *              p_insert);
+static pmap_node_t * map_merge(const pmap_t * p_map,
+                               pmap_entry_t * p_entry1,
+                               pmap_entry_t * p_entry2,
+                               uint32_t       shift);
+static pmap_node_t * map_put_node(const pmap_t *      p_map,
+                                  const pmap_node_t * p_node,
+                                  uint32_t            shift,
+                                  pmap_entry_t *      p_entry,
+                                  bool *              p_b_added);
+static bool          map_remove_node(const pmap_t *      p_map,
+                                     const pmap_node_t * p_node,
+                                     uint32_t            shift,
+                                     const void *        p_key,
+                                     uint32_t            hash,
+                                     pmap_node_t **      pp_out,
+                                     bool *              p_b_found);
+static const pmap_entry_t * map_find(const pmap_t * p_map,
+                                     const void *   p_key);
+static bool          map_visit(const pmap_node_t * p_node,
+                               uint32_t            shift,
+                               bool (*visit)(void *       p_arg,
+                                             const void * p_key,
+                                             void *       p_value),
+                               void *              p_arg);
+
+/*************************************************************************
+ * Public Functions: vector
+ *************************************************************************/
+
+pvec_t *
+pvec_create(void (*value_retain)(void * p_data),
+            void (*value_release)(void * p_data))
+{
+    pvec_t * p_vec = calloc(1u, sizeof(*p_vec));
+
+    if (NULL == p_vec)
+    {
+        return NULL;
+    }
+
+    p_vec->p_root = vec_node_new();
+
+    if (NULL == p_vec->p_root)
+    {
+        free(p_vec);
+        return NULL;
+    }
+
+    p_vec->header.refs   = 1u;
+    p_vec->header.kind   = KIND_VEC;
+    p_vec->shift         = BITS;
+    p_vec->value_retain  = value_retain;
+    p_vec->value_release = value_release;
+
+    return p_vec;
+}
+
+pvec_t *
+pvec_retain(pvec_t * p_vec)
+{
+    if (NULL != p_vec)
+    {
+        refs_retain(&p_vec->header.refs);
+    }
+
+    return p_vec;
+}
+
+void
+pvec_release(pvec_t * p_vec)
+{
+    if (NULL != p_vec)
+    {
+        version_release(p_vec, 1u);
+    }
+}
+
+pvec_t *
+pvec_push(const pvec_t * p_vec, void * p_data)
+{
+    if ((NULL == p_vec) || (UINT32_MAX == p_vec->size))
+    {
+        return NULL;
+    }
+
+    pvec_t * p_new = vec_version(p_vec);
+
+    if (NULL == p_new)
+    {
+        return NULL;
+    }
+
+    uint32_t tail_count = p_vec->size - vec_tail_offset(p_vec->size);
+
+    if ((NULL != p_vec->p_tail) && (tail_count < WIDTH))
+    {
+        // Room in the tail: only the tail is copied
+        refs_retain(&p_vec->p_root->refs);
+        p_new->p_root = p_vec->p_root;
+        p_new->p_tail = vec_node_copy(p_vec, p_vec->p_tail, 0u, NO_SLOT);
+
+        if (NULL == p_new->p_tail)
+        {
+            pvec_release(p_new);
+            return NULL;
+        }
+
+        p_new->p_tail->p_slots[tail_count] = p_data;
+    }
+    else
+    {
+        // The full tail moves into the trie, shared, as a leaf
+        if (NULL == p_vec->p_tail)
+        {
+            refs_retain(&p_vec->p_root->refs);
+            p_new->p_root = p_vec->p_root;
+        }
+        else if ((p_vec->size >> BITS) > (1u << p_vec->shift))
+        {
+            p_new->p_root = vec_node_new();
+
+            if (NULL != p_new->p_root)
+            {
+                refs_retain(&p_vec->p_root->refs);
+                p_new->p_root->p_slots[0] = p_vec->p_root;
+                p_new->p_root->p_slots[1] = vec_new_path(p_vec->shift,
+                                                         p_vec->p_tail);
+                p_new->shift += BITS;
+
+                if (NULL == p_new->p_root->p_slots[1])
+                {
+                    pvec_release(p_new);
+                    return NULL;
+                }
+            }
+        }
+        else
+        {
+            p_new->p_root = vec_push_tail(p_vec, p_vec->shift, p_vec->p_root,
+                                          p_vec->p_tail);
+        }
+
+        p_new->p_tail = vec_node_new();
+
+        if ((NULL == p_new->p_root) || (NULL == p_new->p_tail))
+        {
+            pvec_release(p_new);
+            return NULL;
+        }
+
+        p_new->p_tail->p_slots[0] = p_data;
+    }
+
+    if ((NULL != p_data) && (NULL != p_vec->value_retain))
+    {
+        p_vec->value_retain(p_data);
+    }
+
+    p_new->size = p_vec->size + 1u;
+
+    return p_new;
+}
+
+pvec_t *
+pvec_set(const pvec_t * p_vec, uint32_t position, void * p_data)
+{
+    if ((NULL == p_vec) || (position >= p_vec->size))
+    {
+        return NULL;
+    }
+
+    pvec_t * p_new = vec_version(p_vec);
+
+    if (NULL == p_new)
+    {
+        return NULL;
+    }
+
+    p_new->size = p_vec->size;
+
+    if (position >= vec_tail_offset(p_vec->size))
+    {
+        refs_retain(&p_vec->p_root->refs);
+        p_new->p_root = p_vec->p_root;
+        p_new->p_tail = vec_node_copy(p_vec, p_vec->p_tail, 0u,
+                                      position & MASK);
+
+        if (NULL != p_new->p_tail)
+        {
+            p_new->p_tail->p_slots[position & MASK] = p_data;
+        }
+    }
+    else
+    {
+        refs_retain(&p_vec->p_tail->refs);
+        p_new->p_tail = p_vec->p_tail;
+        p_new->p_root = vec_assoc(p_vec, p_vec->shift, p_vec->p_root,
+                                  position, p_data);
+    }
+
+    if ((NULL == p_new->p_root) || (NULL == p_new->p_tail))
+    {
+        pvec_release(p_new);
+        return NULL;
+    }
+
+    if ((NULL != p_data) && (NULL != p_vec->value_retain))
+    {
+        p_vec->value_retain(p_data);
+    }
+
+    return p_new;
+}
+
+pvec_t *
+pvec_pop(const pvec_t * p_vec)
+{
+    if ((NULL == p_vec) || (0u == p_vec->size))
+    {
+        return NULL;
+    }
+
+    pvec_t * p_new = vec_version(p_vec);
+
+    if (NULL == p_new)
+    {
+        return NULL;
+    }
+
+    uint32_t tail_count = p_vec->size - vec_tail_offset(p_vec->size);
+
+    p_new->size = p_vec->size - 1u;
+
+    if (1u == p_vec->size)
+    {
+        refs_retain(&p_vec->p_root->refs);
+        p_new->p_root = p_vec->p_root;
+    }
+    else if (tail_count > 1u)
+    {
+        refs_retain(&p_vec->p_root->refs);
+        p_new->p_root = p_vec->p_root;
+        p_new->p_tail = vec_node_copy(p_vec, p_vec->p_tail, 0u,
+                                      tail_count - 1u);
+
+        if (NULL == p_new->p_tail)
+        {
+            pvec_release(p_new);
+            return NULL;
+        }
+
+        p_new->p_tail->p_slots[tail_count - 1u] = NULL;
+    }
+    else
+    {
+        // The last leaf of the trie becomes the tail
+        p_new->p_tail = vec_leaf_for(p_vec, p_vec->size - 2u);
+        refs_retain(&p_new->p_tail->refs);
+
+        if (!vec_pop_tail(p_vec, p_vec->shift, p_vec->p_root, &p_new->p_root))
+        {
+            pvec_release(p_new);
+            return NULL;
+        }
+
+        if (NULL == p_new->p_root)
+        {
+            p_new->p_root = vec_node_new();
+
+            if (NULL == p_new->p_root)
+            {
+                pvec_release(p_new);
+                return NULL;
+            }
+        }
+        else if ((p_new->shift > BITS) && (NULL == p_new->p_root->p_slots[1]))
+        {
+            pvec_node_t * p_child = p_new->p_root->p_slots[0];
+
+            refs_retain(&p_child->refs);
+            vec_node_release(p_new, p_new->p_root, p_new->shift);
+            p_new->p_root = p_child;
+            p_new->shift -= BITS;
+        }
+    }
+
+    return p_new;
+}
+
+void *
+pvec_get(const pvec_t * p_vec, uint32_t position)
+{
+    if ((NULL == p_vec) || (position >= p_vec->size))
+    {
+        return NULL;
+    }
+
+    return vec_leaf_for(p_vec, position)->p_slots[position & MASK];
+}
+
+uint32_t
+pvec_size(const pvec_t * p_vec)
+{
+    return (NULL == p_vec) ? 0u : p_vec->size;
+}
+
+/*************************************************************************
+ * Public Functions: hash map
+ *************************************************************************/
+
+pmap_t *
+pmap_create(uint32_t (*hash_function)(const void * p_key, uint32_t capacity),
+            bool (*key_equals)(const void * p_key1, const void * p_key2),
+            void * (*key_copy)(const void * p_key),
+            void (*key_free)(void * p_key),
+            void (*value_retain)(void * p_value),
+            void (*value_release)(void * p_value))
+{
+    if ((NULL == hash_function) || (NULL == key_equals))
+    {
+        return NULL;
+    }
+
+    pmap_t * p_map = calloc(1u, sizeof(*p_map));
+
+    if (NULL == p_map)
+    {
+        return NULL;
+    }
+
+    p_map->p_root = map_node_new(0u);
+
+    if (NULL == p_map->p_root)
+    {
+        free(p_map);
+        return NULL;
+    }
+
+    p_map->header.refs   = 1u;
+    p_map->header.kind   = KIND_MAP;
+    p_map->hash_function = hash_function;
+    p_map->key_equals    = key_equals;
+    p_map->key_copy      = key_copy;
+    p_map->key_free      = key_free;
+    p_map->value_retain  = value_retain;
+    p_map->value_release = value_release;
+
+    return p_map;
+}
+
+pmap_t *
+pmap_retain(pmap_t * p_map)
+{
+    if (NULL != p_map)
+    {
+        refs_retain(&p_map->header.refs);
+    }
+
+    return p_map;
+}
+
+void
+pmap_release(pmap_t * p_map)
+{
+    if (NULL != p_map)
+    {
+        version_release(p_map, 1u);
+    }
+}
+
+pmap_t *
+pmap_put(const pmap_t * p_map, const void * p_key, void * p_value)
+{
+    if ((NULL == p_map) || (NULL == p_key) || (UINT32_MAX == p_map->size))
+    {
+        return NULL;
+    }
+
+    pmap_t * p_new = map_version(p_map);
+
+    if (NULL == p_new)
+    {
+        return NULL;
+    }
+
+    uint32_t       hash    = p_map->hash_function(p_key, UINT32_MAX);
+    pmap_entry_t * p_entry = map_entry_new(p_map, p_key, p_value, hash);
+    bool           b_added = false;
+
+    if (NULL == p_entry)
+    {
+        free(p_new);
+        return NULL;
+    }
+
+    // The trie takes references of its own to the entry
+    p_new->p_root = map_put_node(p_map, p_map->p_root, 0u, p_entry,
+                                 &b_added);
+    map_entry_release(p_map, p_entry);
+
+    if (NULL == p_new->p_root)
+    {
+        free(p_new);
+        return NULL;
+    }
+
+    p_new->size += b_added ? 1u : 0u;
+
+    return p_new;
+}
+
+pmap_t *
+pmap_remove(const pmap_t * p_map, const void * p_key)
+{
+    if ((NULL == p_map) || (NULL == p_key))
+    {
+        return NULL;
+    }
+
+    pmap_node_t * p_root  = NULL;
+    bool          b_found = false;
+
+    if (!map_remove_node(p_map, p_map->p_root, 0u, p_key,
+                         p_map->hash_function(p_key, UINT32_MAX), &p_root,
+                         &b_found))
+    {
+        return NULL;
+    }
+
+    if (!b_found)
+    {
+        return pmap_retain((pmap_t *)p_map);
+    }
+
+    pmap_t * p_new = map_version(p_map);
+
+    if (NULL == p_new)
+    {
+        map_node_release(p_map, p_root, 0u);
+        return NULL;
+    }
+
+    p_new->p_root = p_root;
+    p_new->size--;
+
+    return p_new;
+}
+
+void *
+pmap_get(const pmap_t * p_map, const void * p_key)
+{
+    const pmap_entry_t * p_entry = map_find(p_map, p_key);
+
+    return (NULL == p_entry) ? NULL : p_entry->p_value;
+}
+
+bool
+pmap_contains_key(const pmap_t * p_map, const void * p_key)
+{
+    return NULL != map_find(p_map, p_key);
+}
+
+uint32_t
+pmap_size(const pmap_t * p_map)
+{
+    return (NULL == p_map) ? 0u : p_map->size;
+}
+
+void
+pmap_for_each(const pmap_t * p_map,
+              bool (*visit)(void * p_arg, const void * p_key, void * p_value),
+              void * p_arg)
+{
+    if ((NULL != p_map) && (NULL != visit))
+    {
+        (void)map_visit(p_map->p_root, 0u, visit, p_arg);
+    }
+}
+
+/*************************************************************************
+ * Public Functions: publishing cell
+ *************************************************************************/
+
+void
+persist_cell_init(persist_cell_t * p_cell, void * p_version)
+{
+    if (NULL != p_cell)
+    {
+        p_cell->word = (uint64_t)(uintptr_t)p_version;
+    }
+}
+
+void *
+persist_cell_load(persist_cell_t * p_cell)
+{
+    if (NULL == p_cell)
+    {
+        return NULL;
+    }
+
+    // Counted in the cell, the version cannot be freed under us
+    uint64_t word      = __atomic_fetch_add(&p_cell->word, CELL_ONE,
+                                            __ATOMIC_ACQUIRE);
+    void *   p_version = (void *)(uintptr_t)(word & CELL_POINTER);
+
+    if (NULL != p_version)
+    {
+        refs_retain(&((persist_header_t *)p_version)->refs);
+    }
+
+    word = __atomic_load_n(&p_cell->word, __ATOMIC_RELAXED);
+
+    for (;;)
+    {
+        if ((void *)(uintptr_t)(word & CELL_POINTER) != p_version)
+        {
+            // A store moved our count onto the version; drop that instead
+            if (NULL != p_version)
+            {
+                version_release(p_version, 1u);
+            }
+            break;
+        }
+
+        if (__atomic_compare_exchange_n(&p_cell->word, &word, word - CELL_ONE,
+                                        true, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    return p_version;
+}
+
+void
+persist_cell_store(persist_cell_t * p_cell, void * p_version)
+{
+    if (NULL == p_cell)
+    {
+        return;
+    }
+
+    uint64_t word  = __atomic_exchange_n(&p_cell->word,
+                                         (uint64_t)(uintptr_t)p_version,
+                                         __ATOMIC_ACQ_REL);
+    void *   p_old = (void *)(uintptr_t)(word & CELL_POINTER);
+
+    if (NULL != p_old)
+    {
+        // Loads in progress become references; the cell's own one goes
+        int16_t loads = (int16_t)(uint16_t)(word >> CELL_SHIFT);
+        version_release(p_old, (uint32_t)(1 - (int32_t)loads));
+    }
+}
+
+void
+persist_cell_destroy(persist_cell_t * p_cell)
+{
+    persist_cell_store(p_cell, NULL);
+}
+
+/*************************************************************************
+ * Private Functions: reference counts
+ *************************************************************************/
+
+static void
+refs_retain(uint32_t * p_refs)
+{
+    (void)__atomic_fetch_add(p_refs, 1u, __ATOMIC_RELAXED);
+}
+
+/*!
+ * @brief Subtracts count, modulo 2^32, from a reference count.
+ *
+ * @return true if that was the last reference
+ */
+static bool
+refs_release(uint32_t * p_refs, uint32_t count)
+{
+    return 0u == __atomic_sub_fetch(p_refs, count, __ATOMIC_ACQ_REL);
+}
+
+static void
+version_release(void * p_version, uint32_t count)
+{
+    persist_header_t * p_header = p_version;
+
+    if (!refs_release(&p_header->refs, count))
+    {
+        return;
+    }
+
+    if (KIND_VEC == p_header->kind)
+    {
+        pvec_t * p_vec = p_version;
+
+        vec_node_release(p_vec, p_vec->p_root, p_vec->shift);
+        vec_node_release(p_vec, p_vec->p_tail, 0u);
+    }
+    else
+    {
+        pmap_t * p_map = p_version;
+
+        map_node_release(p_map, p_map->p_root, 0u);
+    }
+
+    free(p_version);
+}
+
+/*************************************************************************
+ * Private Functions: vector
+ *************************************************************************/
+
+static pvec_node_t *
+vec_node_new(void)
+{
+    pvec_node_t * p_node = calloc(1u, sizeof(*p_node));
+
+    if (NULL != p_node)
+    {
+        p_node->refs = 1u;
+    }
+
+    return p_node;
+}
+
+static void
+vec_node_release(const pvec_t * p_vec, pvec_node_t * p_node, uint32_t level)
+{
+    if ((NULL == p_node) || !refs_release(&p_node->refs, 1u))
+    {
+        return;
+    }
+
+    for (uint32_t slot = 0; slot < WIDTH; slot++)
+    {
+        if (NULL == p_node->p_slots[slot])
+        {
+            continue;
+        }
+
+        if (level > 0u)
+        {
+            vec_node_release(p_vec, p_node->p_slots[slot], level - BITS);
+        }
+        else if (NULL != p_vec->value_release)
+        {
+            p_vec->value_release(p_node->p_slots[slot]);
+        }
+    }
+
+    free(p_node);
+}
+
+/*!
+ * @brief Copies a node, taking a reference to everything in it but slot
+ *        skip, which the caller overwrites (NO_SLOT for none).
+ */
+static pvec_node_t *
+vec_node_copy(const pvec_t *      p_vec,
+              const pvec_node_t * p_node,
+              uint32_t            level,
+              uint32_t            skip)
+{
+    pvec_node_t * p_copy = malloc(sizeof(*p_copy));
+
+    if (NULL == p_copy)
+    {
+        return NULL;
+    }
+
+    memcpy(p_copy->p_slots, p_node->p_slots, sizeof(p_copy->p_slots));
+    p_copy->refs = 1u;
+
+    for (uint32_t slot = 0; slot < WIDTH; slot++)
+    {
+        if ((slot == skip) || (NULL == p_copy->p_slots[slot]))
+        {
+            continue;
+        }
+
+        if (level > 0u)
+        {
+            refs_retain(&((pvec_node_t *)p_copy->p_slots[slot])->refs);
+        }
+        else if (NULL != p_vec->value_retain)
+        {
+            p_vec->value_retain(p_copy->p_slots[slot]);
+        }
+    }
+
+    if (skip < WIDTH)
+    {
+        p_copy->p_slots[skip] = NULL;
+    }
+
+    return p_copy;
+}
+
+/* New version with p_vec's shape and callbacks, and no nodes yet */
+static pvec_t *
+vec_version(const pvec_t * p_vec)
+{
+    pvec_t * p_new = malloc(sizeof(*p_new));
+
+    if (NULL != p_new)
+    {
+        // Field by field: other threads may be changing p_vec's count
+        p_new->header.refs   = 1u;
+        p_new->header.kind   = p_vec->header.kind;
+        p_new->size          = p_vec->size;
+        p_new->shift         = p_vec->shift;
+        p_new->p_root        = NULL;
+        p_new->p_tail        = NULL;
+        p_new->value_retain  = p_vec->value_retain;
+        p_new->value_release = p_vec->value_release;
+    }
+
+    return p_new;
+}
+
+/* Index of the tail's first element */
+static uint32_t
+vec_tail_offset(uint32_t size)
+{
+    return (size < WIDTH) ? 0u : (((size - 1u) >> BITS) << BITS);
+}
+
+/*!
+ * @brief Chain of single-child nodes from level down to p_leaf, which
+ *        gains a reference.
+ */
+static pvec_node_t *
+vec_new_path(uint32_t level, pvec_node_t * p_leaf)
+{
+    if (0u == level)
+    {
+        refs_retain(&p_leaf->refs);
+        return p_leaf;
+    }
+
+    pvec_node_t * p_node = vec_node_new();
+
+    if (NULL == p_node)
+    {
+        return NULL;
+    }
+
+    p_node->p_slots[0] = vec_new_path(level - BITS, p_leaf);
+
+    if (NULL == p_node->p_slots[0])
+    {
+        free(p_node);
+        return NULL;
+    }
+
+    return p_node;
+}
+
+/*!
+ * @brief Copy of p_parent with the full tail p_leaf added as its last
+ *        leaf, p_vec->size - 1 being the leaf's last index.
+ */
+static pvec_node_t *
+vec_push_tail(const pvec_t *      p_vec,
+              uint32_t            level,
+              const pvec_node_t * p_parent,
+              pvec_node_t *       p_leaf)
+{
+    uint32_t      slot   = ((p_vec->size - 1u) >> level) & MASK;
+    pvec_node_t * p_copy = vec_node_copy(p_vec, p_parent, level, slot);
+
+    if (NULL == p_copy)
+    {
+        return NULL;
+    }
+
+    if (BITS == level)
+    {
+        refs_retain(&p_leaf->refs);
+        p_copy->p_slots[slot] = p_leaf;
+    }
+    else if (NULL != p_parent->p_slots[slot])
+    {
+        p_copy->p_slots[slot] = vec_push_tail(p_vec, level - BITS,
+                                              p_parent->p_slots[slot], p_leaf);
+    }
+    else
+    {
+        p_copy->p_slots[slot] = vec_new_path(level - BITS, p_leaf);
+    }
+
+    if (NULL == p_copy->p_slots[slot])
+    {
+        vec_node_release(p_vec, p_copy, level);
+        return NULL;
+    }
+
+    return p_copy;
+}
+
+/*!
+ * @brief Copy of the path from p_node to the element at position, with
+ *        that element replaced by p_data (not yet retained).
+ */
+static pvec_node_t *
+vec_assoc(const pvec_t *      p_vec,
+          uint32_t            level,
+          const pvec_node_t * p_node,
+          uint32_t            position,
+          void *              p_data)
+{
+    uint32_t      slot   = (position >> level) & MASK;
+    pvec_node_t * p_copy = vec_node_copy(p_vec, p_node, level, slot);
+
+    if (NULL == p_copy)
+    {
+        return NULL;
+    }
+
+    if (0u == level)
+    {
+        p_copy->p_slots[slot] = p_data;
+        return p_copy;
+    }
+
+    p_copy->p_slots[slot] = vec_assoc(p_vec, level - BITS,
+                                      p_node->p_slots[slot], position, p_data);
+
+    if (NULL == p_copy->p_slots[slot])
+    {
+        vec_node_release(p_vec, p_copy, level);
+        return NULL;
+    }
+
+    return p_copy;
+}
+
+/*!
+ * @brief Copy of p_node without its last leaf, p_vec->size - 2 being the
+ *        last index kept. *pp_out is NULL if nothing is left.
+ *
+ * @return false if memory ran out
+ */
+static bool
+vec_pop_tail(const pvec_t *      p_vec,
+             uint32_t            level,
+             const pvec_node_t * p_node,
+             pvec_node_t **      pp_out)
+{
+    uint32_t      slot    = ((p_vec->size - 2u) >> level) & MASK;
+    pvec_node_t * p_child = NULL;
+
+    if (level > BITS)
+    {
+        if (!vec_pop_tail(p_vec, level - BITS, p_node->p_slots[slot],
+                          &p_child))
+        {
+            return false;
+        }
+    }
+
+    if ((NULL == p_child) && (0u == slot))
+    {
+        *pp_out = NULL;
+        return true;
+    }
+
+    pvec_node_t * p_copy = vec_node_copy(p_vec, p_node, level, slot);
+
+    if (NULL == p_copy)
+    {
+        vec_node_release(p_vec, p_child, level - BITS);
+        return false;
+    }
+
+    p_copy->p_slots[slot] = p_child;
+    *pp_out               = p_copy;
+
+    return true;
+}
+
+/* Leaf holding the element at position, which must be in range */
+static pvec_node_t *
+vec_leaf_for(const pvec_t * p_vec, uint32_t position)
+{
+    if (position >= vec_tail_offset(p_vec->size))
+    {
+        return p_vec->p_tail;
+    }
+
+    pvec_node_t * p_node = p_vec->p_root;
+
+    for (uint32_t level = p_vec->shift; level > 0u; level -= BITS)
+    {
+        p_node = p_node->p_slots[(position >> level) & MASK];
+    }
+
+    return p_node;
+}
+
+/*************************************************************************
+ * Private Functions: hash map
+ *************************************************************************/
+
+static uint32_t
+popcount(uint32_t bits)
+{
+    return (uint32_t)__builtin_popcount(bits);
+}
+
+/* New version with p_map's size and callbacks, and no root yet */
+static pmap_t *
+map_version(const pmap_t * p_map)
+{
+    pmap_t * p_new = malloc(sizeof(*p_new));
+
+    if (NULL != p_new)
+    {
+        // Field by field: other threads may be changing p_map's count
+        p_new->header.refs   = 1u;
+        p_new->header.kind   = p_map->header.kind;
+        p_new->size          = p_map->size;
+        p_new->p_root        = NULL;
+        p_new->hash_function = p_map->hash_function;
+        p_new->key_equals    = p_map->key_equals;
+        p_new->key_copy      = p_map->key_copy;
+        p_new->key_free      = p_map->key_free;
+        p_new->value_retain  = p_map->value_retain;
+        p_new->value_release = p_map->value_release;
+    }
+
+    return p_new;
+}
+
+static pmap_entry_t *
+map_entry_new(const pmap_t * p_map,
+              const void *   p_key,
+              void *         p_value,
+              uint32_t       hash)
+{
+    pmap_entry_t * p_entry = malloc(sizeof(*p_entry));
+
+    if (NULL == p_entry)
+    {
+        return NULL;
+    }
+
+    p_entry->p_key = (NULL != p_map->key_copy) ? p_map->key_copy(p_key)
+                                               : (void *)p_key;
+
+    if (NULL == p_entry->p_key)
+    {
+        free(p_entry);
+        return NULL;
+    }
+
+    if ((NULL != p_value) && (NULL != p_map->value_retain))
+    {
+        p_map->value_retain(p_value);
+    }
+
+    p_entry->refs    = 1u;
+    p_entry->hash    = hash;
+    p_entry->p_value = p_value;
+
+    return p_entry;
+}
+
+static void
+map_entry_release(const pmap_t * p_map, pmap_entry_t * p_entry)
+{
+    if (!refs_release(&p_entry->refs, 1u))
+    {
+        return;
+    }
+
+    if ((NULL != p_map->key_copy) && (NULL != p_map->key_free))
+    {
+        p_map->key_free(p_entry->p_key);
+    }
+
+    if ((NULL != p_entry->p_value) && (NULL != p_map->value_release))
+    {
+        p_map->value_release(p_entry->p_value);
+    }
+
+    free(p_entry);
+}
+
+static pmap_node_t *
+map_node_new(uint32_t count)
+{
+    pmap_node_t * p_node = malloc(sizeof(*p_node)
+                                  + ((size_t)count * sizeof(void *)));
+
+    if (NULL != p_node)
+    {
+        p_node->refs    = 1u;
+        p_node->datamap = 0u;
+        p_node->nodemap = 0u;
+        p_node->count   = count;
+    }
+
+    return p_node;
+}
+
+static void
+map_node_release(const pmap_t * p_map, pmap_node_t * p_node, uint32_t shift)
+{
+    if ((NULL == p_node) || !refs_release(&p_node->refs, 1u))
+    {
+        return;
+    }
+
+    uint32_t entries = (shift >= HASH_BITS) ? p_node->count
+                                            : popcount(p_node->datamap);
+
+    for (uint32_t slot = 0; slot < p_node->count; slot++)
+    {
+        if (slot < entries)
+        {
+            map_entry_release(p_map, p_node->p_slots[slot]);
+        }
+        else
+        {
+            map_node_release(p_map, p_node->p_slots[slot], shift + BITS);
+        }
+    }
+
+    free(p_node);
+}
+
+/*!
+ * @brief New node with the given maps and count, holding p_old's slots in
+ *        order less slot skip, with p_insert placed at slot insert_at of
+ *        the new node. Kept slots gain a reference; p_insert does not.
+ *        NO_SLOT for skip or insert_at means none.
+ */
+static pmap_node_t *
+map_node_rebuild(const pmap_node_t * p_old,
+                 uint32_t            datamap,
+                 uint32_t            nodemap,
+                 uint32_t            count,
+                 uint32_t            skip,
+                 uint32_t            insert_at,
+                 void *              p_insert)
+{
+    pmap_node_t * p_node = map_node_new(count);
+
+    if (NULL == p_node)
+    {
+        return NULL;
+    }
+
+    uint32_t old = 0;
+
+    p_node->datamap = datamap;
+    p_node->nodemap = nodemap;
+
+    for (uint32_t slot = 0; slot < count; slot++)
+    {
+        if (slot == insert_at)
+        {
+            p_node->p_slots[slot] = p_insert;
+            continue;
+        }
+
+        if (old == skip)
+        {
+            old++;
+        }
+
+        // Entries and nodes both start with their reference count
+        refs_retain((uint32_t *)p_old->p_slots[old]);
+        p_node->p_slots[slot] = p_old->p_slots[old++];
+    }
+
+    return p_node;
+}
+
+/*!
+ * @brief Smallest subtrie at shift holding two entries of different keys,
+ *        each of which gains a reference.
+ */
+static pmap_node_t *
+map_merge(const pmap_t * p_map,
+          pmap_entry_t * p_entry1,
+          pmap_entry_t * p_entry2,
+          uint32_t       shift)
+{
+    pmap_node_t * p_node = NULL;
+
+    if (shift >= HASH_BITS)
+    {
+        p_node = map_node_new(2u);
+
+        if (NULL != p_node)
+        {
+            refs_retain(&p_entry1->refs);
+            refs_retain(&p_entry2->refs);
+            p_node->p_slots[0] = p_entry1;
+            p_node->p_slots[1] = p_entry2;
+        }
+
+        return p_node;
+    }
+
+    uint32_t bit1 = (p_entry1->hash >> shift) & MASK;
+    uint32_t bit2 = (p_entry2->hash >> shift) & MASK;
+
+    if (bit1 == bit2)
+    {
+        pmap_node_t * p_child = map_merge(p_map, p_entry1, p_entry2,
+                                          shift + BITS);
+
+        if (NULL == p_child)
+        {
+            return NULL;
+        }
+
+        p_node = map_node_new(1u);
+
+        if (NULL == p_node)
+        {
+            map_node_release(p_map, p_child, shift + BITS);
+            return NULL;
+        }
+
+        p_node->nodemap    = 1u << bit1;
+        p_node->p_slots[0] = p_child;
+
+        return p_node;
+    }
+
+    p_node = map_node_new(2u);
+
+    if (NULL != p_node)
+    {
+        refs_retain(&p_entry1->refs);
+        refs_retain(&p_entry2->refs);
+        p_node->datamap                  = (1u << bit1) | (1u << bit2);
+        p_node->p_slots[(bit1 < bit2) ? 0 : 1] = p_entry1;
+        p_node->p_slots[(bit1 < bit2) ? 1 : 0] = p_entry2;
+    }
+
+    return p_node;
+}
+
+/*!
+ * @brief Copy of the path from p_node to where p_entry belongs, with
+ *        p_entry there. p_entry gains a reference if it is placed.
+ */
+static pmap_node_t *
+map_put_node(const pmap_t *      p_map,
+             const pmap_node_t * p_node,
+             uint32_t            shift,
+             pmap_entry_t *      p_entry,
+             bool *              p_b_added)
+{
+    pmap_node_t * p_new = NULL;
+
+    if (shift >= HASH_BITS)
+    {
+        uint32_t slot = 0;
+
+        while ((slot < p_node->count)
+               && !p_map->key_equals(
+                   ((const pmap_entry_t *)p_node->p_slots[slot])->p_key,
+                   p_entry->p_key))
+        {
+            slot++;
+        }
+
+        // Replace the equal key, or append
+        *p_b_added = (slot == p_node->count);
+        p_new      = map_node_rebuild(p_node, 0u, 0u,
+                                      p_node->count + (*p_b_added ? 1u : 0u),
+                                      *p_b_added ? NO_SLOT : slot, slot,
+                                      p_entry);
+
+        if (NULL != p_new)
+        {
+            refs_retain(&p_entry->refs);
+        }
+
+        return p_new;
+    }
+
+    uint32_t bit     = 1u << ((p_entry->hash >> shift) & MASK);
+    uint32_t below   = bit - 1u;
+    uint32_t entries = popcount(p_node->datamap);
+
+    if (0u != (p_node->datamap & bit))
+    {
+        uint32_t       slot  = popcount(p_node->datamap & below);
+        pmap_entry_t * p_old = p_node->p_slots[slot];
+
+        if ((p_old->hash == p_entry->hash)
+            && p_map->key_equals(p_old->p_key, p_entry->p_key))
+        {
+            *p_b_added = false;
+            p_new      = map_node_rebuild(p_node, p_node->datamap,
+                                          p_node->nodemap, p_node->count,
+                                          slot, slot, p_entry);
+
+            if (NULL != p_new)
+            {
+                refs_retain(&p_entry->refs);
+            }
+
+            return p_new;
+        }
+
+        // Two keys on one bit: they move down into a new subtrie
+        pmap_node_t * p_child = map_merge(p_map, p_old, p_entry, shift + BITS);
+
+        if (NULL == p_child)
+        {
+            return NULL;
+        }
+
+        uint32_t nodemap = p_node->nodemap | bit;
+
+        *p_b_added = true;
+        p_new      = map_node_rebuild(p_node, p_node->datamap ^ bit,
+                                      nodemap, p_node->count, slot,
+                                      (entries - 1u) + popcount(nodemap & below),
+                                      p_child);
+
+        if (NULL == p_new)
+        {
+            map_node_release(p_map, p_child, shift + BITS);
+        }
+
+        return p_new;
+    }
+
+    if (0u != (p_node->nodemap & bit))
+    {
+        uint32_t      slot    = entries + popcount(p_node->nodemap & below);
+        pmap_node_t * p_child = map_put_node(p_map, p_node->p_slots[slot],
+                                             shift + BITS, p_entry, p_b_added);
+
+        if (NULL == p_child)
+        {
+            return NULL;
+        }
+
+        p_new = map_node_rebuild(p_node, p_node->datamap,
+                                 p_node->nodemap, p_node->count, slot, slot,
+                                 p_child);
+
+        if (NULL == p_new)
+        {
+            map_node_release(p_map, p_child, shift + BITS);
+        }
+
+        return p_new;
+    }
+
+    *p_b_added = true;
+    p_new      = map_node_rebuild(p_node, p_node->datamap | bit,
+                                  p_node->nodemap, p_node->count + 1u, NO_SLOT,
+                                  popcount(p_node->datamap & below), p_entry);
+
+    if (NULL != p_new)
+    {
+        refs_retain(&p_entry->refs);
+    }
+
+    return p_new;
+}
+
+/*!
+ * @brief Copy of the path from p_node to p_key, without it. A child left
+ *        with one entry is replaced by that entry. *pp_out is set only if
+ *        the key was found.
+ *
+ * @return false if memory ran out
+ */
+static bool
+map_remove_node(const pmap_t *      p_map,
+                const pmap_node_t * p_node,
+                uint32_t            shift,
+                const void *        p_key,
+                uint32_t            hash,
+                pmap_node_t **      pp_out,
+                bool *              p_b_found)
+{
+    *p_b_found = false;
+
+    if (shift >= HASH_BITS)
+    {
+        for (uint32_t slot = 0; slot < p_node->count; slot++)
+        {
+            const pmap_entry_t * p_old = p_node->p_slots[slot];
+
+            if (p_map->key_equals(p_old->p_key, p_key))
+            {
+                *p_b_found = true;
+                *pp_out    = map_node_rebuild(p_node, 0u, 0u,
+                                              p_node->count - 1u, slot,
+                                              NO_SLOT, NULL);
+                return NULL != *pp_out;
+            }
+        }
+
+        return true;
+    }
+
+    uint32_t bit     = 1u << ((hash >> shift) & MASK);
+    uint32_t below   = bit - 1u;
+    uint32_t entries = popcount(p_node->datamap);
+
+    if (0u != (p_node->datamap & bit))
+    {
+        uint32_t             slot  = popcount(p_node->datamap & below);
+        const pmap_entry_t * p_old = p_node->p_slots[slot];
+
+        if ((p_old->hash != hash) || !p_map->key_equals(p_old->p_key, p_key))
+        {
+            return true;
+        }
+
+        *p_b_found = true;
+        *pp_out    = map_node_rebuild(p_node, p_node->datamap ^ bit,
+                                      p_node->nodemap, p_node->count - 1u,
+                                      slot, NO_SLOT, NULL);
+        return NULL != *pp_out;
+    }
+
+    if (0u == (p_node->nodemap & bit))
+    {
+        return true;
+    }
+
+    uint32_t      slot    = entries + popcount(p_node->nodemap & below);
+    pmap_node_t * p_child = NULL;
+
+    if (!map_remove_node(p_map, p_node->p_slots[slot], shift + BITS, p_key,
+                         hash, &p_child, p_b_found))
+    {
+        return false;
+    }
+
+    if (!*p_b_found)
+    {
+        return true;
+    }
+
+    if ((1u == p_child->count) && (0u == p_child->nodemap))
+    {
+        // A lone entry moves up into this node
+        pmap_entry_t * p_last = p_child->p_slots[0];
+
+        refs_retain(&p_last->refs);
+        *pp_out = map_node_rebuild(p_node, p_node->datamap | bit,
+                                   p_node->nodemap ^ bit, p_node->count, slot,
+                                   popcount(p_node->datamap & below), p_last);
+
+        if (NULL == *pp_out)
+        {
+            map_entry_release(p_map, p_last);
+        }
+
+        map_node_release(p_map, p_child, shift + BITS);
+    }
+    else
+    {
+        *pp_out = map_node_rebuild(p_node, p_node->datamap,
+                                   p_node->nodemap, p_node->count, slot, slot,
+                                   p_child);
+
+        if (NULL == *pp_out)
+        {
+            map_node_release(p_map, p_child, shift + BITS);
+        }
+    }
+
+    return NULL != *pp_out;
+}
+
+static const pmap_entry_t *
+map_find(const pmap_t * p_map, const void * p_key)
+{
+    if ((NULL == p_map) || (NULL == p_key))
+    {
+        return NULL;
+    }
+
+    uint32_t            hash   = p_map->hash_function(p_key, UINT32_MAX);
+    const pmap_node_t * p_node = p_map->p_root;
+
+    for (uint32_t shift = 0; shift < HASH_BITS; shift += BITS)
+    {
+        uint32_t bit   = 1u << ((hash >> shift) & MASK);
+        uint32_t below = bit - 1u;
+
+        if (0u != (p_node->datamap & bit))
+        {
+            const pmap_entry_t * p_entry =
+                p_node->p_slots[popcount(p_node->datamap & below)];
+
+            return ((p_entry->hash == hash)
+                    && p_map->key_equals(p_entry->p_key, p_key))
+                       ? p_entry
+                       : NULL;
+        }
+
+        if (0u == (p_node->nodemap & bit))
+        {
+            return NULL;
+        }
+
+        p_node = p_node->p_slots[popcount(p_node->datamap)
+                                 + popcount(p_node->nodemap & below)];
+    }
+
+    for (uint32_t slot = 0; slot < p_node->count; slot++)
+    {
+        const pmap_entry_t * p_entry = p_node->p_slots[slot];
+
+        if (p_map->key_equals(p_entry->p_key, p_key))
+        {
+            return p_entry;
+        }
+    }
+
+    return NULL;
+}
+
+static bool
+map_visit(const pmap_node_t * p_node,
+          uint32_t            shift,
+          bool (*visit)(void * p_arg, const void * p_key, void * p_value),
+          void *              p_arg)
+{
+    uint32_t entries = (shift >= HASH_BITS) ? p_node->count
+                                            : popcount(p_node->datamap);
+
+    for (uint32_t slot = 0; slot < p_node->count; slot++)
+    {
+        if (slot < entries)
+        {
+            const pmap_entry_t * p_entry = p_node->p_slots[slot];
+
+            if (!visit(p_arg, p_entry->p_key, p_entry->p_value))
+            {
+                return false;
+            }
+        }
+        else if (!map_visit(p_node->p_slots[slot], shift + BITS, visit, p_arg))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*** end of file ***/
@@ -16,18 +16,31 @@
  #include <netinet/in.h>
  #include <arpa/inet.h>
  #include <errno.h>
+ #include <time.h>
  
  #include "initialize.h"
  #include "poll.h"
- #include "thread_pool.h"
+ #include "fiber.h"
  #include "syslog.h"
  #include "cleanup.h"
+ #include "user_db.h"
+ #include "traffic_stats.h"
  
  /*************************************************************************
   * Constants and Macros
   *************************************************************************/
  
  #define POLL_TIMEOUT_MS     (1000)
+ #define SESSION_THREADS     (4)    /* Workers shared by all client fibers */
+ #define CLIENT_IDLE_MS      (30000) /* Silent clients are disconnected */
+ #define REQUEST_DEADLINE_MS (60000) /* Whole request, read to reply */
+ 
+ /*************************************************************************
+  * Private Data
+  *************************************************************************/
+ 
+ /* Each client connection is served by a fiber on this scheduler */
+ static fiber_sched_t *gp_sessions = NULL;
  
  /*************************************************************************
   * Static Function Prototypes
@@ -43,12 +56,26 @@
  static void handle_new_connection(int fd, uint16_t events, void *user_data);
  
  /**
-  * @brief Thread pool job function to handle a client request
+  * @brief Fiber that handles a client request
   *
   * @param p_arg Pointer to client socket file descriptor
   */
  static void handle_client_request(void *p_arg);
  
+ /**
+  * @brief Cleanup function that waits for client fibers and stops them
+  *
+  * @param p_arg Unused
+  */
+ static void sessions_cleanup_wrapper(void *p_arg);
+ 
+ /**
+  * @brief Cleanup function that stops recording traffic statistics
+  *
+  * @param p_arg Unused
+  */
+ static void traffic_stats_cleanup_wrapper(void *p_arg);
+ 
  /*************************************************************************
   * Main Function
   *************************************************************************/
@@ -65,6 +92,26 @@
          return EXIT_FAILURE;
      }
  
+     /* Start the fibers that serve client connections */
+     gp_sessions = fiber_sched_create(SESSION_THREADS, 0);
+     if ((gp_sessions == NULL) ||
+         !cleanup_add_void(sessions_cleanup_wrapper, NULL, 5))
+     {
+         syslog_write(ERROR, SYSLOG_DEST_NONE, "Failed to start client sessions");
+         fiber_sched_destroy(&gp_sessions);
+         cleanup_execute();
+         return EXIT_FAILURE;
+     }
+ 
+     /* Traffic statistics are optional; the server runs without them */
+     if (!traffic_stats_init() ||
+         !cleanup_add_void(traffic_stats_cleanup_wrapper, NULL, 5))
+     {
+         syslog_write(WARNING, SYSLOG_DEST_NONE, "Traffic statistics disabled");
+         traffic_stats_shutdown();
+     }
+     time_t next_report = time(NULL) + TRAFFIC_STATS_REPORT_SECS;
+ 
      /* Get server socket */
      int server_socket = server_get_socket();
      
@@ -84,6 +131,16 @@
              syslog_write(ERROR, SYSLOG_DEST_NONE, "Error processing poll events");
              break;
          }
+ 
+         /* Lift account lockouts that have run out; only due ones are touched */
+         (void)user_db_expire_lockouts();
+ 
+         /* Fold the per-thread traffic counts together and log them */
+         if (time(NULL) >= next_report)
+         {
+             traffic_stats_report();
+             next_report = time(NULL) + TRAFFIC_STATS_REPORT_SECS;
+         }
      }
  
      syslog_write(INFO, SYSLOG_DEST_NONE, "Server shutting down...");
@@ -125,6 +182,7 @@
      
      char client_ip[INET_ADDRSTRLEN];
      inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
+     traffic_stats_client(client_ip);
      syslog_write(INFO, SYSLOG_DEST_NONE, "New connection from %s:%d", client_ip, ntohs(client_addr.sin_port));
      
      /* Allocate memory for the client socket file descriptor */
@@ -137,22 +195,17 @@
      
      *p_client_fd = client_fd;
      
-     /* Create a job for the thread pool */
-     thread_job_t job = {
-         .job_fn = handle_client_request,
-         .p_arg = p_client_fd
-     };
-     
-     /* Submit job to the thread pool */
-     if (thread_pool_submit(NULL, &job) != 0) {
-         syslog_write(ERROR, SYSLOG_DEST_NONE, "Failed to submit job to thread pool");
+     /* Serve the client on its own fiber; waiting on the socket does not
+      * hold a worker thread */
+     if (fiber_spawn(gp_sessions, handle_client_request, p_client_fd) != FIBER_SUCCESS) {
+         syslog_write(ERROR, SYSLOG_DEST_NONE, "Failed to start client session");
          free(p_client_fd);
          close(client_fd);
      }
  }
  
  /**
-  * @brief Thread pool job function to handle a client request
+  * @brief Fiber that handles a client request
   */
  static void handle_client_request(void *p_arg)
  {
@@ -163,10 +216,18 @@
      /* Free the allocated memory for the file descriptor */
      free(p_arg);
      
+     /* Time out idle clients and slow requests; the scheduler's timer
+      * wheel wakes the fiber with ETIMEDOUT */
+     fiber_set_idle_timeout(CLIENT_IDLE_MS);
+     fiber_set_deadline(REQUEST_DEADLINE_MS);
+     
      /* Read client request */
-     bytes_read = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+     bytes_read = fiber_recv(client_fd, buffer, sizeof(buffer) - 1, 0);
      if (bytes_read <= 0) {
-         if (bytes_read < 0) {
+         if ((bytes_read < 0) && (errno == ETIMEDOUT)) {
+             syslog_write(INFO, SYSLOG_DEST_NONE, "Closing idle client connection");
+         }
+         else if (bytes_read < 0) {
              syslog_write(ERROR, SYSLOG_DEST_NONE, "Error reading from client: %s", strerror(errno));
          }
          close(client_fd);
@@ -180,10 +241,28 @@
      /* ... */
      
      /* For this example, just echo the request back */
-     if (send(client_fd, buffer, bytes_read, 0) != bytes_read) {
+     if (fiber_send(client_fd, buffer, bytes_read, 0) != bytes_read) {
          syslog_write(ERROR, SYSLOG_DEST_NONE, "Error sending response to client: %s", strerror(errno));
      }
      
      /* Close the connection */
      close(client_fd);
+ }
+ 
+ /**
+  * @brief Cleanup function that waits for client fibers and stops them
+  */
+ static void sessions_cleanup_wrapper(void *p_arg)
+ {
+     (void)p_arg;
+     fiber_sched_destroy(&gp_sessions);
+ }
+ 
+ /**
+  * @brief Cleanup function that stops recording traffic statistics
+  */
+ static void traffic_stats_cleanup_wrapper(void *p_arg)
+ {
+     (void)p_arg;
+     traffic_stats_shutdown();
  }
\ No newline at end of file
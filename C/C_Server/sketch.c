@@ -0,0 +1,1042 @@
+/** @file sketch.c
+ *
+ * @brief Implementation of the HyperLogLog, Count-Min and Space-Saving
+ *        sketches.
+ *
+ * HyperLogLog: the hash's top precision bits pick a register, and the
+ * register keeps the highest rank (leading zeros + 1) seen in the rest.
+ * Sparse, the set registers sit in an open-addressed table of 32-bit
+ * entries, (index + 1) << 6 | rank, sized at a quarter of the dense
+ * array's bytes; it turns dense when three quarters full. Dense merges
+ * are a byte-wise max, done 32 or 16 bytes at a time with __AVX2__ or
+ * __SSE2__.
+ *
+ * Count-Min: row i indexes its counters with h1 + i * h2, two halves of
+ * the one hash (Kirsch and Mitzenmacher), over a power-of-two width.
+ *
+ * Space-Saving: the k entries sit in a min-heap on count, so the entry to
+ * evict is at the root, and in a linear-probing index on the key hash.
+ * The counts live in the heap nodes, so sifting does not visit entries.
+ * An evicted entry's count becomes the error of the key that replaces it.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/sketch.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define HLL_MIN_SPARSE    (8u)   /* Lower precisions start dense */
+#define HLL_RANK_BITS     (6u)
+#define HLL_RANK_MASK     ((1u << HLL_RANK_BITS) - 1u)
+
+#define CMS_MAX_DEPTH     (16u)
+#define CMS_MAX_WIDTH     (1u << 28)
+#define EULER             (2.718281828459045)
+
+#define TOPK_MAX_K        (1u << 24)
+#define NONE              (UINT32_MAX)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+struct hll
+{
+    uint8_t *  p_registers;  /* Dense form, NULL while sparse */
+    uint32_t * p_sparse;     /* Sparse form, NULL once dense */
+    uint32_t   sparse_shift; /* 32 - log2 of the sparse table size */
+    uint32_t   sparse_count;
+    uint32_t   precision;
+};
+
+struct cms
+{
+    uint32_t * p_counters;   /* depth rows of width counters */
+    uint32_t   width_mask;
+    uint32_t   depth;
+    uint64_t   total;
+};
+
+typedef struct
+{
+    uint64_t hash;
+    uint64_t error;
+    uint32_t heap_pos;
+    uint32_t key_len;
+    char     key[TOPK_KEY_MAX];
+} topk_entry_t;
+
+typedef struct
+{
+    uint64_t count;
+    uint32_t entry;
+} topk_node_t;
+
+struct topk
+{
+    topk_entry_t * p_entries;
+    topk_node_t *  p_heap;   /* Least count at the root */
+    uint32_t *     p_index;  /* Entry numbers by key hash, NONE if empty */
+    uint32_t       index_mask;
+    uint32_t       k;
+    uint32_t       size;
+};
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static uint64_t mix64(uint64_t value);
+static uint32_t hll_sparse_size(const hll_t * p_hll);
+static int      hll_set(hll_t * p_hll, uint32_t index, uint32_t rank);
+static bool     hll_sparse_set(hll_t * p_hll, uint32_t index, uint32_t rank);
+static int      hll_make_dense(hll_t * p_hll);
+static void     max_bytes(uint8_t * p_dst, const uint8_t * p_src, size_t len);
+static uint32_t saturating_add(uint32_t lhs, uint32_t rhs);
+static uint64_t topk_count(const topk_t * p_topk, uint32_t entry);
+static void     topk_insert(topk_t *     p_topk,
+                            uint64_t     hash,
+                            const void * p_key,
+                            uint32_t     len,
+                            uint64_t     count,
+                            uint64_t     error);
+static uint32_t topk_find(const topk_t * p_topk,
+                          uint64_t       hash,
+                          const void *   p_key,
+                          uint32_t       len);
+static void     topk_index_add(topk_t * p_topk, uint32_t entry);
+static void     topk_index_remove(topk_t * p_topk, uint32_t entry);
+static void     topk_sift_up(topk_t * p_topk, uint32_t pos);
+static void     topk_sift_down(topk_t * p_topk, uint32_t pos);
+static void     topk_heap_swap(topk_t * p_topk, uint32_t pos_a, uint32_t pos_b);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+uint64_t
+sketch_hash(const void * p_key, size_t len)
+{
+    const uint8_t * p_bytes = p_key;
+    uint64_t        hash    = 0x9E3779B97F4A7C15ull ^ (uint64_t)len;
+
+    if (NULL == p_key)
+    {
+        return mix64(hash);
+    }
+
+    while (len >= 8u)
+    {
+        uint64_t word;
+
+        memcpy(&word, p_bytes, sizeof(word));
+        hash     = (hash ^ mix64(word)) * 0xFF51AFD7ED558CCDull;
+        p_bytes += 8u;
+        len     -= 8u;
+    }
+
+    if (len > 0u)
+    {
+        uint64_t word = 0u;
+
+        memcpy(&word, p_bytes, len);
+        hash = (hash ^ mix64(word)) * 0xFF51AFD7ED558CCDull;
+    }
+
+    return mix64(hash);
+}
+
+hll_t *
+hll_create(uint32_t precision)
+{
+    hll_t * p_hll = NULL;
+
+    if ((precision < HLL_MIN_PRECISION) || (precision > HLL_MAX_PRECISION))
+    {
+        return NULL;
+    }
+
+    p_hll = calloc(1u, sizeof(*p_hll));
+
+    if (NULL == p_hll)
+    {
+        return NULL;
+    }
+
+    p_hll->precision = precision;
+
+    if (precision < HLL_MIN_SPARSE)
+    {
+        p_hll->p_registers = calloc((size_t)1u << precision, 1u);
+    }
+    else
+    {
+        // Entries are 4 bytes, so m / 16 of them take m / 4 bytes
+        p_hll->sparse_shift = 32u - (precision - 4u);
+        p_hll->p_sparse     = calloc(hll_sparse_size(p_hll), sizeof(uint32_t));
+    }
+
+    if ((NULL == p_hll->p_registers) && (NULL == p_hll->p_sparse))
+    {
+        free(p_hll);
+        return NULL;
+    }
+
+    return p_hll;
+}
+
+void
+hll_destroy(hll_t ** pp_hll)
+{
+    if ((NULL == pp_hll) || (NULL == *pp_hll))
+    {
+        return;
+    }
+
+    free((*pp_hll)->p_registers);
+    free((*pp_hll)->p_sparse);
+    free(*pp_hll);
+    *pp_hll = NULL;
+}
+
+int
+hll_add(hll_t * p_hll, uint64_t hash)
+{
+    if (NULL == p_hll)
+    {
+        return SKETCH_ERROR_PARAM;
+    }
+
+    uint32_t index = (uint32_t)(hash >> (64u - p_hll->precision));
+    uint64_t rest  = hash << p_hll->precision;
+    uint32_t rank  = (0u == rest)
+                         ? (65u - p_hll->precision)
+                         : ((uint32_t)__builtin_clzll(rest) + 1u);
+
+    return hll_set(p_hll, index, rank);
+}
+
+int
+hll_merge(hll_t * p_dst, const hll_t * p_src)
+{
+    if ((NULL == p_dst) || (NULL == p_src) || (p_dst == p_src))
+    {
+        return SKETCH_ERROR_PARAM;
+    }
+
+    if (p_dst->precision != p_src->precision)
+    {
+        return SKETCH_ERROR_SHAPE;
+    }
+
+    if (NULL != p_src->p_sparse)
+    {
+        for (uint32_t slot = 0u; slot < hll_sparse_size(p_src); slot++)
+        {
+            uint32_t entry = p_src->p_sparse[slot];
+
+            if ((0u != entry)
+                && (SKETCH_SUCCESS
+                    != hll_set(p_dst,
+                               (entry >> HLL_RANK_BITS) - 1u,
+                               entry & HLL_RANK_MASK)))
+            {
+                return SKETCH_ERROR_MEMORY;
+            }
+        }
+
+        return SKETCH_SUCCESS;
+    }
+
+    if ((NULL != p_dst->p_sparse) && (SKETCH_SUCCESS != hll_make_dense(p_dst)))
+    {
+        return SKETCH_ERROR_MEMORY;
+    }
+
+    max_bytes(p_dst->p_registers,
+              p_src->p_registers,
+              (size_t)1u << p_dst->precision);
+    return SKETCH_SUCCESS;
+}
+
+uint64_t
+hll_estimate(const hll_t * p_hll)
+{
+    double sum   = 0.0;
+    double zeros = 0.0;
+
+    if (NULL == p_hll)
+    {
+        return 0u;
+    }
+
+    double m = (double)((uint64_t)1u << p_hll->precision);
+
+    if (NULL != p_hll->p_sparse)
+    {
+        zeros = m - (double)p_hll->sparse_count;
+        sum   = zeros;
+
+        for (uint32_t slot = 0u; slot < hll_sparse_size(p_hll); slot++)
+        {
+            uint32_t rank = p_hll->p_sparse[slot] & HLL_RANK_MASK;
+
+            if (0u != p_hll->p_sparse[slot])
+            {
+                sum += 1.0 / (double)(1ull << rank);
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t reg = 0u; reg < (1u << p_hll->precision); reg++)
+        {
+            uint8_t rank = p_hll->p_registers[reg];
+
+            sum   += 1.0 / (double)(1ull << rank);
+            zeros += (0u == rank) ? 1.0 : 0.0;
+        }
+    }
+
+    // Bias correction; tabulated for 16, 32 and 64 registers
+    double alpha;
+    switch (p_hll->precision)
+    {
+        case 4:
+            alpha = 0.673;
+            break;
+        case 5:
+            alpha = 0.697;
+            break;
+        case 6:
+            alpha = 0.709;
+            break;
+        default:
+            alpha = 0.7213 / (1.0 + (1.079 / m));
+            break;
+    }
+    double estimate = alpha * m * m / sum;
+
+    // Small counts: linear counting on the empty registers is better
+    if ((estimate <= 2.5 * m) && (zeros > 0.0))
+    {
+        estimate = m * log(m / zeros);
+    }
+
+    return (uint64_t)(estimate + 0.5);
+}
+
+void
+hll_clear(hll_t * p_hll)
+{
+    if (NULL == p_hll)
+    {
+        return;
+    }
+
+    if (NULL != p_hll->p_sparse)
+    {
+        memset(p_hll->p_sparse, 0, hll_sparse_size(p_hll) * sizeof(uint32_t));
+        p_hll->sparse_count = 0u;
+    }
+    else
+    {
+        memset(p_hll->p_registers, 0, (size_t)1u << p_hll->precision);
+    }
+}
+
+bool
+hll_is_sparse(const hll_t * p_hll)
+{
+    return (NULL != p_hll) && (NULL != p_hll->p_sparse);
+}
+
+cms_t *
+cms_create(double epsilon, double delta)
+{
+    cms_t *  p_cms  = NULL;
+    uint32_t width  = 1u;
+    uint32_t depth  = 1u;
+    double   missed = 1.0 / EULER;
+
+    if (!(epsilon > 0.0) || !(epsilon < 1.0) || !(delta > 0.0)
+        || !(delta < 1.0))
+    {
+        return NULL;
+    }
+
+    while (((double)width < EULER / epsilon) && (width < CMS_MAX_WIDTH))
+    {
+        width <<= 1;
+    }
+
+    while ((missed > delta) && (depth < CMS_MAX_DEPTH))
+    {
+        missed /= EULER;
+        depth++;
+    }
+
+    p_cms = calloc(1u, sizeof(*p_cms));
+
+    if (NULL == p_cms)
+    {
+        return NULL;
+    }
+
+    p_cms->p_counters = calloc((size_t)width * depth, sizeof(uint32_t));
+
+    if (NULL == p_cms->p_counters)
+    {
+        free(p_cms);
+        return NULL;
+    }
+
+    p_cms->width_mask = width - 1u;
+    p_cms->depth      = depth;
+    return p_cms;
+}
+
+void
+cms_destroy(cms_t ** pp_cms)
+{
+    if ((NULL == pp_cms) || (NULL == *pp_cms))
+    {
+        return;
+    }
+
+    free((*pp_cms)->p_counters);
+    free(*pp_cms);
+    *pp_cms = NULL;
+}
+
+uint32_t
+cms_add(cms_t * p_cms, uint64_t hash, uint32_t count)
+{
+    if (NULL == p_cms)
+    {
+        return 0u;
+    }
+
+    uint32_t h1     = (uint32_t)hash;
+    uint32_t h2     = (uint32_t)(hash >> 32) | 1u;
+    size_t   width  = (size_t)p_cms->width_mask + 1u;
+    uint32_t target = saturating_add(cms_estimate(p_cms, hash), count);
+
+    // Conservative update: no counter is raised past the new estimate
+    for (uint32_t row = 0u; row < p_cms->depth; row++)
+    {
+        uint32_t * p_counter = &p_cms->p_counters[(row * width)
+                                                  + ((h1 + (row * h2))
+                                                     & p_cms->width_mask)];
+
+        if (*p_counter < target)
+        {
+            *p_counter = target;
+        }
+    }
+
+    p_cms->total += count;
+    return target;
+}
+
+uint32_t
+cms_estimate(const cms_t * p_cms, uint64_t hash)
+{
+    uint32_t estimate = UINT32_MAX;
+
+    if (NULL == p_cms)
+    {
+        return 0u;
+    }
+
+    uint32_t h1    = (uint32_t)hash;
+    uint32_t h2    = (uint32_t)(hash >> 32) | 1u;
+    size_t   width = (size_t)p_cms->width_mask + 1u;
+
+    for (uint32_t row = 0u; row < p_cms->depth; row++)
+    {
+        uint32_t counter = p_cms->p_counters[(row * width)
+                                             + ((h1 + (row * h2))
+                                                & p_cms->width_mask)];
+
+        if (counter < estimate)
+        {
+            estimate = counter;
+        }
+    }
+
+    return estimate;
+}
+
+int
+cms_merge(cms_t * p_dst, const cms_t * p_src)
+{
+    if ((NULL == p_dst) || (NULL == p_src) || (p_dst == p_src))
+    {
+        return SKETCH_ERROR_PARAM;
+    }
+
+    if ((p_dst->width_mask != p_src->width_mask)
+        || (p_dst->depth != p_src->depth))
+    {
+        return SKETCH_ERROR_SHAPE;
+    }
+
+    size_t counters = ((size_t)p_dst->width_mask + 1u) * p_dst->depth;
+
+    for (size_t idx = 0u; idx < counters; idx++)
+    {
+        p_dst->p_counters[idx] = saturating_add(p_dst->p_counters[idx],
+                                                p_src->p_counters[idx]);
+    }
+
+    p_dst->total += p_src->total;
+    return SKETCH_SUCCESS;
+}
+
+uint64_t
+cms_total(const cms_t * p_cms)
+{
+    return (NULL == p_cms) ? 0u : p_cms->total;
+}
+
+void
+cms_clear(cms_t * p_cms)
+{
+    if (NULL == p_cms)
+    {
+        return;
+    }
+
+    memset(p_cms->p_counters,
+           0,
+           ((size_t)p_cms->width_mask + 1u) * p_cms->depth * sizeof(uint32_t));
+    p_cms->total = 0u;
+}
+
+topk_t *
+topk_create(uint32_t k)
+{
+    topk_t * p_topk = NULL;
+    uint32_t slots  = 2u;
+
+    if ((0u == k) || (k > TOPK_MAX_K))
+    {
+        return NULL;
+    }
+
+    // Index at most half full, so probes stay short
+    while (slots < 2u * k)
+    {
+        slots <<= 1;
+    }
+
+    p_topk = calloc(1u, sizeof(*p_topk));
+
+    if (NULL == p_topk)
+    {
+        return NULL;
+    }
+
+    p_topk->p_entries  = calloc(k, sizeof(topk_entry_t));
+    p_topk->p_heap     = calloc(k, sizeof(topk_node_t));
+    p_topk->p_index    = malloc((size_t)slots * sizeof(uint32_t));
+    p_topk->index_mask = slots - 1u;
+    p_topk->k          = k;
+
+    if ((NULL == p_topk->p_entries) || (NULL == p_topk->p_heap)
+        || (NULL == p_topk->p_index))
+    {
+        topk_destroy(&p_topk);
+        return NULL;
+    }
+
+    topk_clear(p_topk);
+    return p_topk;
+}
+
+void
+topk_destroy(topk_t ** pp_topk)
+{
+    if ((NULL == pp_topk) || (NULL == *pp_topk))
+    {
+        return;
+    }
+
+    free((*pp_topk)->p_entries);
+    free((*pp_topk)->p_heap);
+    free((*pp_topk)->p_index);
+    free(*pp_topk);
+    *pp_topk = NULL;
+}
+
+int
+topk_add(topk_t * p_topk, const void * p_key, size_t len, uint64_t count)
+{
+    if ((NULL == p_topk) || ((NULL == p_key) && (len > 0u)))
+    {
+        return SKETCH_ERROR_PARAM;
+    }
+
+    uint32_t key_len = (len > TOPK_KEY_MAX) ? TOPK_KEY_MAX : (uint32_t)len;
+
+    topk_insert(p_topk, sketch_hash(p_key, key_len), p_key, key_len, count,
+                0u);
+    return SKETCH_SUCCESS;
+}
+
+int
+topk_merge(topk_t * p_dst, const topk_t * p_src)
+{
+    if ((NULL == p_dst) || (NULL == p_src) || (p_dst == p_src))
+    {
+        return SKETCH_ERROR_PARAM;
+    }
+
+    for (uint32_t entry = 0u; entry < p_src->size; entry++)
+    {
+        const topk_entry_t * p_entry = &p_src->p_entries[entry];
+
+        topk_insert(p_dst, p_entry->hash, p_entry->key, p_entry->key_len,
+                    p_src->p_heap[p_entry->heap_pos].count, p_entry->error);
+    }
+
+    return SKETCH_SUCCESS;
+}
+
+uint32_t
+topk_list(const topk_t * p_topk, topk_item_t * p_items, uint32_t max_items)
+{
+    uint32_t listed = 0u;
+    uint32_t last   = NONE;
+
+    if ((NULL == p_topk) || (NULL == p_items))
+    {
+        return 0u;
+    }
+
+    // Selection by (count descending, entry ascending): k is small and no
+    // memory is needed, unlike sorting a copy
+    while ((listed < max_items) && (listed < p_topk->size))
+    {
+        uint32_t best = NONE;
+
+        for (uint32_t entry = 0u; entry < p_topk->size; entry++)
+        {
+            uint64_t count = topk_count(p_topk, entry);
+
+            if ((NONE != last)
+                && ((count > topk_count(p_topk, last))
+                    || ((count == topk_count(p_topk, last))
+                        && (entry <= last))))
+            {
+                continue;
+            }
+
+            if ((NONE == best) || (count > topk_count(p_topk, best)))
+            {
+                best = entry;
+            }
+        }
+
+        const topk_entry_t * p_best = &p_topk->p_entries[best];
+        topk_item_t *        p_item = &p_items[listed];
+
+        memcpy(p_item->key, p_best->key, p_best->key_len);
+        p_item->key[p_best->key_len] = '\0';
+        p_item->key_len              = p_best->key_len;
+        p_item->count                = topk_count(p_topk, best);
+        p_item->error                = p_best->error;
+        last                         = best;
+        listed++;
+    }
+
+    return listed;
+}
+
+void
+topk_clear(topk_t * p_topk)
+{
+    if (NULL == p_topk)
+    {
+        return;
+    }
+
+    for (uint32_t slot = 0u; slot <= p_topk->index_mask; slot++)
+    {
+        p_topk->p_index[slot] = NONE;
+    }
+
+    p_topk->size = 0u;
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Finalizer from MurmurHash3: every input bit affects every output
+ *        bit.
+ */
+static uint64_t
+mix64(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+static uint32_t
+hll_sparse_size(const hll_t * p_hll)
+{
+    return 1u << (32u - p_hll->sparse_shift);
+}
+
+/*!
+ * @brief Raises a register to rank, in whichever form the sketch is in.
+ */
+static int
+hll_set(hll_t * p_hll, uint32_t index, uint32_t rank)
+{
+    if (NULL != p_hll->p_sparse)
+    {
+        if (hll_sparse_set(p_hll, index, rank))
+        {
+            return SKETCH_SUCCESS;
+        }
+
+        if (SKETCH_SUCCESS != hll_make_dense(p_hll))
+        {
+            return SKETCH_ERROR_MEMORY;
+        }
+    }
+
+    if (p_hll->p_registers[index] < rank)
+    {
+        p_hll->p_registers[index] = (uint8_t)rank;
+    }
+
+    return SKETCH_SUCCESS;
+}
+
+/*!
+ * @brief Raises a register in the sparse table.
+ *
+ * @return false if the register is new and the table has no room
+ */
+static bool
+hll_sparse_set(hll_t * p_hll, uint32_t index, uint32_t rank)
+{
+    uint32_t mask = hll_sparse_size(p_hll) - 1u;
+    uint32_t slot = (index * 0x9E3779B1u) >> p_hll->sparse_shift;
+
+    for (;;)
+    {
+        uint32_t entry = p_hll->p_sparse[slot];
+
+        if (0u == entry)
+        {
+            if (p_hll->sparse_count >= (hll_sparse_size(p_hll) / 4u) * 3u)
+            {
+                return false;
+            }
+
+            p_hll->p_sparse[slot] = ((index + 1u) << HLL_RANK_BITS) | rank;
+            p_hll->sparse_count++;
+            return true;
+        }
+
+        if ((entry >> HLL_RANK_BITS) == (index + 1u))
+        {
+            if ((entry & HLL_RANK_MASK) < rank)
+            {
+                p_hll->p_sparse[slot] = ((index + 1u) << HLL_RANK_BITS) | rank;
+            }
+
+            return true;
+        }
+
+        slot = (slot + 1u) & mask;
+    }
+}
+
+static int
+hll_make_dense(hll_t * p_hll)
+{
+    uint8_t * p_registers = calloc((size_t)1u << p_hll->precision, 1u);
+
+    if (NULL == p_registers)
+    {
+        return SKETCH_ERROR_MEMORY;
+    }
+
+    for (uint32_t slot = 0u; slot < hll_sparse_size(p_hll); slot++)
+    {
+        uint32_t entry = p_hll->p_sparse[slot];
+
+        if (0u != entry)
+        {
+            p_registers[(entry >> HLL_RANK_BITS) - 1u]
+                = (uint8_t)(entry & HLL_RANK_MASK);
+        }
+    }
+
+    free(p_hll->p_sparse);
+    p_hll->p_sparse     = NULL;
+    p_hll->sparse_count = 0u;
+    p_hll->p_registers  = p_registers;
+    return SKETCH_SUCCESS;
+}
+
+/*!
+ * @brief p_dst[i] = max(p_dst[i], p_src[i]) for len bytes.
+ */
+static void
+max_bytes(uint8_t * p_dst, const uint8_t * p_src, size_t len)
+{
+    size_t idx = 0u;
+
+#if defined(__AVX2__)
+    for (; (idx + 32u) <= len; idx += 32u)
+    {
+        __m256i dst = _mm256_loadu_si256((const __m256i *)(p_dst + idx));
+        __m256i src = _mm256_loadu_si256((const __m256i *)(p_src + idx));
+
+        _mm256_storeu_si256((__m256i *)(p_dst + idx),
+                            _mm256_max_epu8(dst, src));
+    }
+#elif defined(__SSE2__)
+    for (; (idx + 16u) <= len; idx += 16u)
+    {
+        __m128i dst = _mm_loadu_si128((const __m128i *)(p_dst + idx));
+        __m128i src = _mm_loadu_si128((const __m128i *)(p_src + idx));
+
+        _mm_storeu_si128((__m128i *)(p_dst + idx), _mm_max_epu8(dst, src));
+    }
+#endif
+
+    for (; idx < len; idx++)
+    {
+        if (p_dst[idx] < p_src[idx])
+        {
+            p_dst[idx] = p_src[idx];
+        }
+    }
+}
+
+static uint32_t
+saturating_add(uint32_t lhs, uint32_t rhs)
+{
+    return (lhs > UINT32_MAX - rhs) ? UINT32_MAX : (lhs + rhs);
+}
+
+static uint64_t
+topk_count(const topk_t * p_topk, uint32_t entry)
+{
+    return p_topk->p_heap[p_topk->p_entries[entry].heap_pos].count;
+}
+
+/*!
+ * @brief Adds a key with a count and a known error: to its entry if it
+ *        has one, else to a free entry, else in place of the least count,
+ *        which it inherits.
+ */
+static void
+topk_insert(topk_t *     p_topk,
+            uint64_t     hash,
+            const void * p_key,
+            uint32_t     len,
+            uint64_t     count,
+            uint64_t     error)
+{
+    uint32_t entry = topk_find(p_topk, hash, p_key, len);
+
+    if (NONE != entry)
+    {
+        uint32_t pos = p_topk->p_entries[entry].heap_pos;
+
+        p_topk->p_heap[pos].count      += count;
+        p_topk->p_entries[entry].error += error;
+        topk_sift_down(p_topk, pos);
+        return;
+    }
+
+    topk_entry_t * p_entry = NULL;
+
+    if (p_topk->size < p_topk->k)
+    {
+        entry             = p_topk->size;
+        p_entry           = &p_topk->p_entries[entry];
+        p_entry->error    = error;
+        p_entry->heap_pos = entry;
+
+        p_topk->p_heap[entry].count = count;
+        p_topk->p_heap[entry].entry = entry;
+        p_topk->size++;
+    }
+    else
+    {
+        entry   = p_topk->p_heap[0].entry;
+        p_entry = &p_topk->p_entries[entry];
+        topk_index_remove(p_topk, entry);
+
+        p_entry->error          = p_topk->p_heap[0].count + error;
+        p_topk->p_heap[0].count += count;
+    }
+
+    p_entry->hash    = hash;
+    p_entry->key_len = len;
+
+    if (len > 0u)
+    {
+        memcpy(p_entry->key, p_key, len);
+    }
+
+    topk_index_add(p_topk, entry);
+    topk_sift_up(p_topk, p_entry->heap_pos);
+    topk_sift_down(p_topk, p_entry->heap_pos);
+}
+
+static uint32_t
+topk_find(const topk_t * p_topk,
+          uint64_t       hash,
+          const void *   p_key,
+          uint32_t       len)
+{
+    uint32_t slot = (uint32_t)hash & p_topk->index_mask;
+
+    while (NONE != p_topk->p_index[slot])
+    {
+        const topk_entry_t * p_entry
+            = &p_topk->p_entries[p_topk->p_index[slot]];
+
+        if ((p_entry->hash == hash) && (p_entry->key_len == len)
+            && (0 == memcmp(p_entry->key, p_key, len)))
+        {
+            return p_topk->p_index[slot];
+        }
+
+        slot = (slot + 1u) & p_topk->index_mask;
+    }
+
+    return NONE;
+}
+
+static void
+topk_index_add(topk_t * p_topk, uint32_t entry)
+{
+    uint32_t slot = (uint32_t)p_topk->p_entries[entry].hash
+                    & p_topk->index_mask;
+
+    while (NONE != p_topk->p_index[slot])
+    {
+        slot = (slot + 1u) & p_topk->index_mask;
+    }
+
+    p_topk->p_index[slot] = entry;
+}
+
+/*!
+ * @brief Removes an entry from the index, shifting back later entries of
+ *        the probe run so that no tombstones are needed.
+ */
+static void
+topk_index_remove(topk_t * p_topk, uint32_t entry)
+{
+    uint32_t mask = p_topk->index_mask;
+    uint32_t hole = (uint32_t)p_topk->p_entries[entry].hash & mask;
+
+    while (entry != p_topk->p_index[hole])
+    {
+        hole = (hole + 1u) & mask;
+    }
+
+    for (uint32_t next = (hole + 1u) & mask; NONE != p_topk->p_index[next];
+         next = (next + 1u) & mask)
+    {
+        uint32_t home
+            = (uint32_t)p_topk->p_entries[p_topk->p_index[next]].hash & mask;
+
+        // Move it back unless its home lies in (hole, next]
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            p_topk->p_index[hole] = p_topk->p_index[next];
+            hole                  = next;
+        }
+    }
+
+    p_topk->p_index[hole] = NONE;
+}
+
+static void
+topk_sift_up(topk_t * p_topk, uint32_t pos)
+{
+    while (pos > 0u)
+    {
+        uint32_t parent = (pos - 1u) / 2u;
+
+        if (p_topk->p_heap[parent].count <= p_topk->p_heap[pos].count)
+        {
+            break;
+        }
+
+        topk_heap_swap(p_topk, pos, parent);
+        pos = parent;
+    }
+}
+
+static void
+topk_sift_down(topk_t * p_topk, uint32_t pos)
+{
+    for (;;)
+    {
+        uint32_t least = pos;
+        uint32_t left  = (2u * pos) + 1u;
+
+        for (uint32_t child = left;
+             (child < left + 2u) && (child < p_topk->size);
+             child++)
+        {
+            if (p_topk->p_heap[child].count < p_topk->p_heap[least].count)
+            {
+                least = child;
+            }
+        }
+
+        if (least == pos)
+        {
+            return;
+        }
+
+        topk_heap_swap(p_topk, pos, least);
+        pos = least;
+    }
+}
+
+static void
+topk_heap_swap(topk_t * p_topk, uint32_t pos_a, uint32_t pos_b)
+{
+    topk_node_t node = p_topk->p_heap[pos_a];
+
+    p_topk->p_heap[pos_a] = p_topk->p_heap[pos_b];
+    p_topk->p_heap[pos_b] = node;
+
+    p_topk->p_entries[p_topk->p_heap[pos_a].entry].heap_pos = pos_a;
+    p_topk->p_entries[p_topk->p_heap[pos_b].entry].heap_pos = pos_b;
+}
+
+/*** end of file ***/
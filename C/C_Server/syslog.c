@@ -9,6 +9,7 @@
  */
 
  #include "syslog.h"
+ #include "traffic_stats.h"
  #include <pthread.h>
  #include <stdarg.h>
  #include <stdio.h>
@@ -218,6 +219,9 @@
          return false;
      }
  
+     // Count messages by kind for the traffic statistics
+     traffic_stats_log(p_format);
+ 
      // Format message with variable arguments 
      va_start(args, p_format);
      if (vsnprintf(formatted_message, sizeof(formatted_message), p_format, args) < 0)
@@ -20,9 +20,11 @@
  #include <sys/wait.h>
  #include <signal.h>
  #include <stdbool.h>
+ #include <time.h>
  
  #include "signal_handler.h"
  #include "syslog.h"
+ #include "traffic_stats.h"
  
  /*************************************************************************
   * Constants and Macros
@@ -92,6 +94,8 @@
          g_socket_fd = -1;
      }
      
+     traffic_stats_report();
+     traffic_stats_shutdown();
      syslog_shutdown();
  }
  
@@ -128,6 +132,7 @@
          client_ip, sizeof(client_ip));
      
      syslog_write(INFO, SYSLOG_DEST_NONE, "Connection from %s", client_ip);
+     traffic_stats_client(client_ip);
      
      // Send a welcome message
      if (send(client_fd, SERVER_MSG, strlen(SERVER_MSG), 0) == -1)
@@ -266,6 +271,13 @@
      
      syslog_write(INFO, SYSLOG_DEST_NONE, "TCP Server starting up");
      
+     // Traffic statistics are optional; the server runs without them
+     if (!traffic_stats_init())
+     {
+         syslog_write(WARNING, SYSLOG_DEST_NONE, "Traffic statistics disabled");
+     }
+     time_t next_report = time(NULL) + TRAFFIC_STATS_REPORT_SECS;
+     
      // Register signal handlers
      signal_config_t sig_configs[] = {
          {SIGINT, sigint_handler},
@@ -316,6 +328,14 @@
          
          // Handle the client connection
          handle_client_connection(new_fd, &client_addr);
+         
+         // Log the traffic counts now and then; accept() blocks, so this
+         // runs on the first connection after each period
+         if (time(NULL) >= next_report)
+         {
+             traffic_stats_report();
+             next_report = time(NULL) + TRAFFIC_STATS_REPORT_SECS;
+         }
      }
      
      syslog_write(INFO, SYSLOG_DEST_NONE, "TCP Server shutting down gracefully");
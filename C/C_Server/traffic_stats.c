@@ -0,0 +1,470 @@
+/** @file traffic_stats.c
+ *
+ * @brief Traffic statistics built from streaming sketches.
+ *
+ * Every thread records into a shard of its own sketches, so recording
+ * takes only the shard's lock, which is uncontended except while a
+ * report merges it. A report folds each shard into the totals and clears
+ * it, then logs a summary once every lock is released, since the summary
+ * goes through syslog_write(), which records into the shards. The
+ * summary's own messages are not counted.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <stdint.h>
+ #include <pthread.h>
+ 
+ #include "traffic_stats.h"
+ #include "syslog.h"
+ 
+ /*************************************************************************
+  * Constants and Macros
+  *************************************************************************/
+ 
+ #define TRAFFIC_STATS_SHARDS     (8)      /* Later threads share shards */
+ #define TRAFFIC_HLL_PRECISION    (14)     /* About 0.8% distinct error */
+ #define TRAFFIC_CMS_EPSILON      (0.001)  /* Overcount bound, of total */
+ #define TRAFFIC_CMS_DELTA        (0.01)
+ #define TRAFFIC_TOPK_CLIENTS     (64)
+ #define TRAFFIC_TOPK_LOGS        (64)
+ 
+ /*************************************************************************
+  * Private Data Structures
+  *************************************************************************/
+ 
+ /* One set of sketches; a shard's or the totals */
+ typedef struct
+ {
+     hll_t*  p_clients;      /* Distinct client addresses */
+     cms_t*  p_connections;  /* Connections per address */
+     topk_t* p_top_clients;  /* Busiest addresses */
+     topk_t* p_top_logs;     /* Most frequent log formats */
+ } traffic_sketches_t;
+ 
+ typedef struct
+ {
+     pthread_mutex_t    mutex;
+     traffic_sketches_t sketches;
+ } traffic_shard_t;
+ 
+ /*************************************************************************
+  * Static Variables
+  *************************************************************************/
+ 
+ static traffic_shard_t g_shards[TRAFFIC_STATS_SHARDS];
+ 
+ /* Merged counts as of the last report; also guards shard assignment */
+ static traffic_sketches_t g_totals;
+ static pthread_mutex_t g_totals_mutex = PTHREAD_MUTEX_INITIALIZER;
+ static uint32_t g_next_shard = 0;
+ 
+ /* Read without g_totals_mutex on the recording paths, so it is only
+    touched through __atomic builtins */
+ static bool g_b_initialized = false;
+ 
+ /* The shard this thread records into */
+ static __thread traffic_shard_t* gp_shard = NULL;
+ 
+ /* Set while this thread logs a summary, whose messages are not counted */
+ static __thread bool g_b_reporting = false;
+ 
+ /*************************************************************************
+  * Static Function Prototypes
+  *************************************************************************/
+ 
+ static bool sketches_create(traffic_sketches_t* p_sketches);
+ static void sketches_destroy(traffic_sketches_t* p_sketches);
+ static bool sketches_merge(traffic_sketches_t* p_dst,
+                            const traffic_sketches_t* p_src);
+ static void sketches_clear(traffic_sketches_t* p_sketches);
+ static traffic_shard_t* current_shard(void);
+ static void log_top(const char* p_title, const topk_item_t* p_items,
+                     uint32_t count);
+ 
+ /*************************************************************************
+  * Public Functions
+  *************************************************************************/
+ 
+ /**
+  * @brief Initialize the traffic statistics
+  *
+  * @return true on success, false if the sketches could not be allocated
+  */
+ bool
+ traffic_stats_init(void)
+ {
+     bool b_ok = true;
+ 
+     if (__atomic_load_n(&g_b_initialized, __ATOMIC_ACQUIRE))
+     {
+         return true;
+     }
+ 
+     pthread_mutex_lock(&g_totals_mutex);
+     if (__atomic_load_n(&g_b_initialized, __ATOMIC_RELAXED))
+     {
+         pthread_mutex_unlock(&g_totals_mutex);
+         return true;
+     }
+ 
+     b_ok = sketches_create(&g_totals);
+     for (uint32_t idx = 0; b_ok && (idx < TRAFFIC_STATS_SHARDS); idx++)
+     {
+         pthread_mutex_init(&g_shards[idx].mutex, NULL);
+         b_ok = sketches_create(&g_shards[idx].sketches);
+     }
+ 
+     if (!b_ok)
+     {
+         sketches_destroy(&g_totals);
+         for (uint32_t idx = 0; idx < TRAFFIC_STATS_SHARDS; idx++)
+         {
+             sketches_destroy(&g_shards[idx].sketches);
+         }
+     }
+ 
+     __atomic_store_n(&g_b_initialized, b_ok, __ATOMIC_RELEASE);
+     pthread_mutex_unlock(&g_totals_mutex);
+ 
+     return b_ok;
+ }
+ 
+ /**
+  * @brief Record a connection from a client
+  *
+  * @param[in] p_ip Client address as text
+  */
+ void
+ traffic_stats_client(const char* p_ip)
+ {
+     if ((NULL == p_ip) || !__atomic_load_n(&g_b_initialized, __ATOMIC_ACQUIRE))
+     {
+         return;
+     }
+ 
+     size_t len = strlen(p_ip);
+     uint64_t hash = sketch_hash(p_ip, len);
+     traffic_shard_t* p_shard = current_shard();
+ 
+     pthread_mutex_lock(&p_shard->mutex);
+     if (NULL != p_shard->sketches.p_clients)
+     {
+         (void)hll_add(p_shard->sketches.p_clients, hash);
+         (void)cms_add(p_shard->sketches.p_connections, hash, 1);
+         (void)topk_add(p_shard->sketches.p_top_clients, p_ip, len, 1);
+     }
+     pthread_mutex_unlock(&p_shard->mutex);
+ }
+ 
+ /**
+  * @brief Record a log message by its format string
+  *
+  * @param[in] p_format Format string of the message
+  */
+ void
+ traffic_stats_log(const char* p_format)
+ {
+     if ((NULL == p_format) || g_b_reporting
+         || !__atomic_load_n(&g_b_initialized, __ATOMIC_ACQUIRE))
+     {
+         return;
+     }
+ 
+     traffic_shard_t* p_shard = current_shard();
+ 
+     pthread_mutex_lock(&p_shard->mutex);
+     if (NULL != p_shard->sketches.p_top_logs)
+     {
+         (void)topk_add(p_shard->sketches.p_top_logs, p_format,
+                        strlen(p_format), 1);
+     }
+     pthread_mutex_unlock(&p_shard->mutex);
+ }
+ 
+ /**
+  * @brief Merge every thread's counts into the totals and log a summary
+  */
+ void
+ traffic_stats_report(void)
+ {
+     topk_item_t top_clients[TRAFFIC_STATS_REPORT_TOP];
+     topk_item_t top_logs[TRAFFIC_STATS_REPORT_TOP];
+     uint32_t client_count = 0;
+     uint32_t log_count = 0;
+     uint64_t distinct = 0;
+     uint64_t connections = 0;
+     bool b_merged = true;
+ 
+     if (!__atomic_load_n(&g_b_initialized, __ATOMIC_ACQUIRE))
+     {
+         return;
+     }
+ 
+     pthread_mutex_lock(&g_totals_mutex);
+     if (NULL == g_totals.p_clients)
+     {
+         pthread_mutex_unlock(&g_totals_mutex);
+         return;
+     }
+ 
+     for (uint32_t idx = 0; idx < TRAFFIC_STATS_SHARDS; idx++)
+     {
+         pthread_mutex_lock(&g_shards[idx].mutex);
+         if (!sketches_merge(&g_totals, &g_shards[idx].sketches))
+         {
+             b_merged = false;
+         }
+         sketches_clear(&g_shards[idx].sketches);
+         pthread_mutex_unlock(&g_shards[idx].mutex);
+     }
+ 
+     distinct = hll_estimate(g_totals.p_clients);
+     connections = cms_total(g_totals.p_connections);
+     client_count = topk_list(g_totals.p_top_clients, top_clients,
+                              TRAFFIC_STATS_REPORT_TOP);
+     log_count = topk_list(g_totals.p_top_logs, top_logs,
+                           TRAFFIC_STATS_REPORT_TOP);
+     pthread_mutex_unlock(&g_totals_mutex);
+ 
+     /* Logged without locks held: syslog_write() records into a shard */
+     g_b_reporting = true;
+     if (!b_merged)
+     {
+         syslog_write(WARNING, SYSLOG_DEST_NONE,
+                      "Traffic stats: out of memory merging client counts");
+     }
+     syslog_write(INFO, SYSLOG_DEST_NONE,
+                  "Traffic: %llu connections from about %llu clients",
+                  (unsigned long long)connections,
+                  (unsigned long long)distinct);
+     log_top("Top client", top_clients, client_count);
+     log_top("Top log", top_logs, log_count);
+     g_b_reporting = false;
+ }
+ 
+ /**
+  * @brief Estimated number of distinct clients, as of the last report
+  */
+ uint64_t
+ traffic_stats_distinct_clients(void)
+ {
+     uint64_t distinct = 0;
+ 
+     pthread_mutex_lock(&g_totals_mutex);
+     if (NULL != g_totals.p_clients)
+     {
+         distinct = hll_estimate(g_totals.p_clients);
+     }
+     pthread_mutex_unlock(&g_totals_mutex);
+ 
+     return distinct;
+ }
+ 
+ /**
+  * @brief Estimated connections from a client, as of the last report
+  *
+  * @param[in] p_ip Client address as text
+  *
+  * @return Count, never below the true one
+  */
+ uint32_t
+ traffic_stats_client_connections(const char* p_ip)
+ {
+     uint32_t count = 0;
+ 
+     if (NULL == p_ip)
+     {
+         return 0;
+     }
+ 
+     pthread_mutex_lock(&g_totals_mutex);
+     if (NULL != g_totals.p_connections)
+     {
+         count = cms_estimate(g_totals.p_connections,
+                              sketch_hash(p_ip, strlen(p_ip)));
+     }
+     pthread_mutex_unlock(&g_totals_mutex);
+ 
+     return count;
+ }
+ 
+ /**
+  * @brief Busiest clients, as of the last report, highest first
+  */
+ uint32_t
+ traffic_stats_top_clients(topk_item_t* p_items, uint32_t max_items)
+ {
+     uint32_t count = 0;
+ 
+     pthread_mutex_lock(&g_totals_mutex);
+     if (NULL != g_totals.p_top_clients)
+     {
+         count = topk_list(g_totals.p_top_clients, p_items, max_items);
+     }
+     pthread_mutex_unlock(&g_totals_mutex);
+ 
+     return count;
+ }
+ 
+ /**
+  * @brief Most frequent log formats, as of the last report, highest first
+  */
+ uint32_t
+ traffic_stats_top_logs(topk_item_t* p_items, uint32_t max_items)
+ {
+     uint32_t count = 0;
+ 
+     pthread_mutex_lock(&g_totals_mutex);
+     if (NULL != g_totals.p_top_logs)
+     {
+         count = topk_list(g_totals.p_top_logs, p_items, max_items);
+     }
+     pthread_mutex_unlock(&g_totals_mutex);
+ 
+     return count;
+ }
+ 
+ /**
+  * @brief Stop recording and free the sketches
+  *
+  * The shard locks stay usable, so threads still recording see the
+  * sketches gone and return.
+  */
+ void
+ traffic_stats_shutdown(void)
+ {
+     pthread_mutex_lock(&g_totals_mutex);
+     if (__atomic_load_n(&g_b_initialized, __ATOMIC_RELAXED))
+     {
+         __atomic_store_n(&g_b_initialized, false, __ATOMIC_RELEASE);
+         for (uint32_t idx = 0; idx < TRAFFIC_STATS_SHARDS; idx++)
+         {
+             pthread_mutex_lock(&g_shards[idx].mutex);
+             sketches_destroy(&g_shards[idx].sketches);
+             pthread_mutex_unlock(&g_shards[idx].mutex);
+         }
+         sketches_destroy(&g_totals);
+     }
+     pthread_mutex_unlock(&g_totals_mutex);
+ }
+ 
+ /*************************************************************************
+  * Private Functions
+  *************************************************************************/
+ 
+ /**
+  * @brief Allocate one set of sketches
+  *
+  * @param[out] p_sketches Sketches to fill in
+  *
+  * @return true on success; on failure nothing stays allocated
+  */
+ static bool
+ sketches_create(traffic_sketches_t* p_sketches)
+ {
+     p_sketches->p_clients = hll_create(TRAFFIC_HLL_PRECISION);
+     p_sketches->p_connections = cms_create(TRAFFIC_CMS_EPSILON,
+                                            TRAFFIC_CMS_DELTA);
+     p_sketches->p_top_clients = topk_create(TRAFFIC_TOPK_CLIENTS);
+     p_sketches->p_top_logs = topk_create(TRAFFIC_TOPK_LOGS);
+ 
+     if ((NULL == p_sketches->p_clients) ||
+         (NULL == p_sketches->p_connections) ||
+         (NULL == p_sketches->p_top_clients) ||
+         (NULL == p_sketches->p_top_logs))
+     {
+         sketches_destroy(p_sketches);
+         return false;
+     }
+ 
+     return true;
+ }
+ 
+ /**
+  * @brief Free one set of sketches; the pointers are set to NULL
+  */
+ static void
+ sketches_destroy(traffic_sketches_t* p_sketches)
+ {
+     hll_destroy(&p_sketches->p_clients);
+     cms_destroy(&p_sketches->p_connections);
+     topk_destroy(&p_sketches->p_top_clients);
+     topk_destroy(&p_sketches->p_top_logs);
+ }
+ 
+ /**
+  * @brief Add one set of sketches into another of the same shape
+  *
+  * @return false if the distinct count could not be merged for lack of
+  *         memory; the other sketches are merged regardless
+  */
+ static bool
+ sketches_merge(traffic_sketches_t* p_dst, const traffic_sketches_t* p_src)
+ {
+     bool b_ok = true;
+ 
+     if (NULL == p_src->p_clients)
+     {
+         return true;
+     }
+ 
+     b_ok = (SKETCH_SUCCESS == hll_merge(p_dst->p_clients, p_src->p_clients));
+     (void)cms_merge(p_dst->p_connections, p_src->p_connections);
+     (void)topk_merge(p_dst->p_top_clients, p_src->p_top_clients);
+     (void)topk_merge(p_dst->p_top_logs, p_src->p_top_logs);
+ 
+     return b_ok;
+ }
+ 
+ /**
+  * @brief Empty one set of sketches, starting a new period
+  */
+ static void
+ sketches_clear(traffic_sketches_t* p_sketches)
+ {
+     if (NULL == p_sketches->p_clients)
+     {
+         return;
+     }
+ 
+     hll_clear(p_sketches->p_clients);
+     cms_clear(p_sketches->p_connections);
+     topk_clear(p_sketches->p_top_clients);
+     topk_clear(p_sketches->p_top_logs);
+ }
+ 
+ /**
+  * @brief The calling thread's shard, assigned on first use
+  */
+ static traffic_shard_t*
+ current_shard(void)
+ {
+     if (NULL == gp_shard)
+     {
+         pthread_mutex_lock(&g_totals_mutex);
+         gp_shard = &g_shards[g_next_shard % TRAFFIC_STATS_SHARDS];
+         g_next_shard++;
+         pthread_mutex_unlock(&g_totals_mutex);
+     }
+ 
+     return gp_shard;
+ }
+ 
+ /**
+  * @brief Log the entries of a top list, one line each
+  */
+ static void
+ log_top(const char* p_title, const topk_item_t* p_items, uint32_t count)
+ {
+     for (uint32_t idx = 0; idx < count; idx++)
+     {
+         syslog_write(INFO, SYSLOG_DEST_NONE, "%s %u: %llu x \"%s\"",
+                      p_title, idx + 1,
+                      (unsigned long long)p_items[idx].count,
+                      p_items[idx].key);
+     }
+ }
+ 
+ /*** end of file ***/
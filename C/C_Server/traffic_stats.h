@@ -0,0 +1,103 @@
+/** @file traffic_stats.h
+ *
+ * @brief Fixed-memory traffic statistics for the server.
+ *
+ * Counts distinct client addresses, connections per address, the busiest
+ * clients and the most frequent log messages with streaming sketches.
+ * Each thread records into its own shard; traffic_stats_report() merges
+ * the shards into running totals, which the query functions read.
+ */
+
+ #ifndef TRAFFIC_STATS_H
+ #define TRAFFIC_STATS_H
+ 
+ #include <stdint.h>
+ #include <stdbool.h>
+ 
+ #include "../include/sketch.h"
+ 
+ /*************************************************************************
+  * Constants
+  *************************************************************************/
+ 
+ #define TRAFFIC_STATS_REPORT_SECS (60)  /* How often the server reports */
+ #define TRAFFIC_STATS_REPORT_TOP  (5)   /* Entries logged per top list */
+ 
+ /*************************************************************************
+  * Function Prototypes
+  *************************************************************************/
+ 
+ /**
+  * @brief Initialize the traffic statistics
+  *
+  * Recording calls made before this, or after traffic_stats_shutdown(),
+  * are ignored.
+  *
+  * @return true on success, false if the sketches could not be allocated
+  */
+ bool traffic_stats_init(void);
+ 
+ /**
+  * @brief Record a connection from a client
+  *
+  * @param[in] p_ip Client address as text
+  */
+ void traffic_stats_client(const char* p_ip);
+ 
+ /**
+  * @brief Record a log message by its format string
+  *
+  * Called by syslog_write(), so messages of one kind count together
+  * whatever their arguments.
+  *
+  * @param[in] p_format Format string of the message
+  */
+ void traffic_stats_log(const char* p_format);
+ 
+ /**
+  * @brief Merge every thread's counts into the totals and log a summary
+  */
+ void traffic_stats_report(void);
+ 
+ /**
+  * @brief Estimated number of distinct clients, as of the last report
+  */
+ uint64_t traffic_stats_distinct_clients(void);
+ 
+ /**
+  * @brief Estimated connections from a client, as of the last report
+  *
+  * @param[in] p_ip Client address as text
+  *
+  * @return Count, never below the true one
+  */
+ uint32_t traffic_stats_client_connections(const char* p_ip);
+ 
+ /**
+  * @brief Busiest clients, as of the last report, highest first
+  *
+  * @param[out] p_items   Array for the entries
+  * @param[in]  max_items Size of the array
+  *
+  * @return Number of entries written
+  */
+ uint32_t traffic_stats_top_clients(topk_item_t* p_items, uint32_t max_items);
+ 
+ /**
+  * @brief Most frequent log formats, as of the last report, highest first
+  *
+  * @param[out] p_items   Array for the entries
+  * @param[in]  max_items Size of the array
+  *
+  * @return Number of entries written
+  */
+ uint32_t traffic_stats_top_logs(topk_item_t* p_items, uint32_t max_items);
+ 
+ /**
+  * @brief Stop recording and free the sketches
+  */
+ void traffic_stats_shutdown(void);
+ 
+ #endif /* TRAFFIC_STATS_H */
+ 
+ /*** end of file ***/
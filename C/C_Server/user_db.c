@@ -18,12 +18,18 @@
  #include "db_storage.h"
  #include "syslog.h"
  #include "cleanup.h"
+ #include "../include/timer_wheel.h"
+ #include "../include/filter.h"
+ #include "../include/intern.h"
+ #include "../include/persistent.h"
  
  /*************************************************************************
   * Constants and Macros
   *************************************************************************/
  
  #define USER_DB_DEFAULT_PATH "users.db"
+ #define USER_DB_LOCK_DURATION_SECS (USER_DB_LOCK_DURATION_MINS * 60)
+ #define USER_DB_NAME_FILTER_FPR (0.001)
  
  /*************************************************************************
   * Static Variables
@@ -47,6 +53,27 @@
  /* Mutex for thread-safety */
  static pthread_mutex_t g_db_mutex = PTHREAD_MUTEX_INITIALIZER;
  
+ /* Lockout expiry, one timer per user slot, in seconds of time() */
+ static timer_wheel_t g_lockouts;
+ static wheel_timer_t g_lockout_timers[USER_DB_MAX_USERS];
+ 
+ /* Usernames of the active users, so unknown names skip the scan */
+ static cuckoo_filter_t* g_p_username_filter = NULL;
+ 
+ /* Interned usernames, one per user slot, so the scan compares pointers */
+ static intern_pool_t* g_p_username_pool = NULL;
+ static const char* g_p_usernames[USER_DB_MAX_USERS];
+ 
+ /* Listing of the users, one entry per user slot and NULL for inactive
+  * ones, published so user_db_list() reads a snapshot without the mutex */
+ typedef struct
+ {
+     uint32_t refs;
+     user_db_user_record_t record;
+ } user_list_entry_t;
+ 
+ static persist_cell_t g_user_list;
+ 
  /*************************************************************************
   * Static Function Prototypes
   *************************************************************************/
@@ -54,6 +81,18 @@
  static uint32_t user_db_find_by_username_internal(const char* p_username);
  static int cleanup_user_db(void);
  static bool is_account_locked(const user_db_user_t* p_user);
+ static bool arm_lockout(uint32_t user_index);
+ static void cancel_lockouts(void);
+ static void unlock_account(wheel_timer_t* p_timer, void* p_arg);
+ static void build_username_filter(void);
+ static void build_username_pool(void);
+ static void intern_username(uint32_t user_index);
+ static uint64_t username_hash(const char* p_username);
+ static void build_user_list(void);
+ static void publish_user(uint32_t user_index);
+ static pvec_t* user_list_with(const pvec_t* p_list, uint32_t user_index);
+ static void user_list_entry_retain(void* p_data);
+ static void user_list_entry_release(void* p_data);
  
  /*************************************************************************
   * Public Functions
@@ -101,6 +140,23 @@
                     g_db_path);
      }
      
+     /* Lockouts loaded from the file expire on their original schedule */
+     timer_wheel_init(&g_lockouts, (uint64_t)time(NULL));
+     
+     for (uint32_t i = 0; i < USER_DB_MAX_USERS; i++)
+     {
+         wheel_timer_init(&g_lockout_timers[i], unlock_account, &g_users[i]);
+         
+         if ((i < g_user_count) && (g_users[i].lockout_time > 0))
+         {
+             arm_lockout(i);
+         }
+     }
+     
+     build_username_filter();
+     build_username_pool();
+     build_user_list();
+     
      /* Register cleanup function */
      cleanup_add_int(cleanup_user_db, NULL, 10);
      
@@ -134,6 +190,10 @@
          status = USER_DB_INVALID_DATA;
      }
      
+     cancel_lockouts();
+     cuckoo_filter_destroy(&g_p_username_filter);
+     intern_destroy(&g_p_username_pool);
+     persist_cell_store(&g_user_list, NULL);
      g_b_initialized = false;
      
      pthread_mutex_unlock(&g_db_mutex);
@@ -223,6 +283,16 @@
      
      g_user_count++;
      *p_user_id = p_new_user->id;
+     intern_username(new_user_index);
+     publish_user(new_user_index);
+     
+     /* On failure the filter is dropped and lookups fall back to the scan */
+     if (NULL != g_p_username_filter &&
+         FILTER_SUCCESS != cuckoo_filter_add(g_p_username_filter,
+                                             username_hash(p_new_user->username)))
+     {
+         cuckoo_filter_destroy(&g_p_username_filter);
+     }
      
      /* Save changes to file */
      user_db_status_t status = USER_DB_SUCCESS;
@@ -274,7 +344,9 @@
      
      user_db_user_t* p_user = &g_users[user_index - 1];
      
-     /* Check if account is locked */
+     /* Check if account is locked, lifting any lockout that has run out */
+     timer_wheel_advance(&g_lockouts, (uint64_t)time(NULL));
+     
      if (is_account_locked(p_user))
      {
          pthread_mutex_unlock(&g_db_mutex);
@@ -291,6 +363,7 @@
          if (p_user->login_attempts >= USER_DB_MAX_LOGIN_ATTEMPTS)
          {
              p_user->lockout_time = time(NULL);
+             arm_lockout(user_index - 1);
              syslog_write(WARNING, SYSLOG_DEST_NONE, 
                         "Account '%s' locked due to too many failed login attempts",
                         p_username);
@@ -470,8 +543,18 @@
      }
      
      /* Update user data */
+     cuckoo_filter_remove(g_p_username_filter,
+                          username_hash(g_users[user_index].username));
      strncpy(g_users[user_index].username, p_record->username, USER_DB_MAX_USERNAME_LEN - 1);
      g_users[user_index].username[USER_DB_MAX_USERNAME_LEN - 1] = '\0';
+     intern_username((uint32_t)user_index);
+     
+     if (NULL != g_p_username_filter &&
+         FILTER_SUCCESS != cuckoo_filter_add(g_p_username_filter,
+                                             username_hash(g_users[user_index].username)))
+     {
+         cuckoo_filter_destroy(&g_p_username_filter);
+     }
      
      /* If password field is not empty, update password */
      if (p_record->password[0] != '\0')
@@ -480,12 +563,15 @@
                          g_users[user_index].salt, 
                          g_users[user_index].password_hash))
          {
+             /* The new username is kept, so the listing shows it */
+             publish_user((uint32_t)user_index);
              pthread_mutex_unlock(&g_db_mutex);
              return USER_DB_INVALID_DATA;
          }
      }
      
      g_users[user_index].role = p_record->role;
+     publish_user((uint32_t)user_index);
      
      /* Save changes to file */
      user_db_status_t status = USER_DB_SUCCESS;
@@ -619,6 +705,10 @@
      
      /* Mark user as inactive (soft delete) */
      g_users[user_index].b_active = false;
+     timer_wheel_cancel(&g_lockouts, &g_lockout_timers[user_index]);
+     cuckoo_filter_remove(g_p_username_filter,
+                          username_hash(g_users[user_index].username));
+     publish_user((uint32_t)user_index);
      
      /* Save changes to file */
      user_db_status_t status = USER_DB_SUCCESS;
@@ -652,6 +742,29 @@
          return USER_DB_INVALID_PARAM;
      }
      
+     /* Copy from a snapshot of the listing, so writers never wait on it */
+     pvec_t* p_list = persist_cell_load(&g_user_list);
+     
+     if (NULL != p_list)
+     {
+         uint32_t count = 0;
+         
+         for (uint32_t i = 0; i < pvec_size(p_list) && count < max_users; i++)
+         {
+             const user_list_entry_t* p_entry = pvec_get(p_list, i);
+             
+             if (NULL != p_entry)
+             {
+                 p_users[count++] = p_entry->record;
+             }
+         }
+         
+         pvec_release(p_list);
+         *p_count = count;
+         return USER_DB_SUCCESS;
+     }
+     
+     /* No listing was published; copy under the mutex instead */
      pthread_mutex_lock(&g_db_mutex);
      
      if (!g_b_initialized)
@@ -713,6 +826,35 @@
      return status;
  }
  
+ /**
+  * @brief Lift account lockouts whose lock duration has run out
+  *
+  * @return Status code indicating success or error
+  */
+ user_db_status_t
+ user_db_expire_lockouts(void)
+ {
+     pthread_mutex_lock(&g_db_mutex);
+     
+     if (!g_b_initialized)
+     {
+         pthread_mutex_unlock(&g_db_mutex);
+         return USER_DB_NOT_INITIALIZED;
+     }
+     
+     /* Only the lockouts that are due are visited, not every user */
+     user_db_status_t status = USER_DB_SUCCESS;
+     
+     if ((timer_wheel_advance(&g_lockouts, (uint64_t)time(NULL)) > 0) &&
+         !db_storage_save(g_db_path, g_users, g_user_count, g_next_user_id))
+     {
+         status = USER_DB_INVALID_DATA;
+     }
+     
+     pthread_mutex_unlock(&g_db_mutex);
+     return status;
+ }
+ 
  /*************************************************************************
   * Static Functions
   *************************************************************************/
@@ -730,6 +872,8 @@
      if (g_b_initialized)
      {
          db_storage_save(g_db_path, g_users, g_user_count, g_next_user_id);
+         cancel_lockouts();
+         persist_cell_store(&g_user_list, NULL);
          g_b_initialized = false;
      }
      
@@ -745,6 +889,8 @@
   * @param[in] p_user  Pointer to user entry
   *
   * @return true if account is locked, false otherwise
+  * @note The lockout timer clears lockout_time when the lock runs out, so
+  *       the wheel must have been advanced to the current time
   */
  static bool
  is_account_locked(const user_db_user_t* p_user)
@@ -754,19 +900,276 @@
          return false;
      }
      
-     /* Account is locked if lockout time is set and lockout period hasn't expired */
-     if (p_user->lockout_time > 0)
+     return (p_user->lockout_time > 0);
+ }
+ 
+ /**
+  * @brief Schedule the end of a user's lockout
+  *
+  * @param[in] user_index  Index of the locked user in g_users
+  *
+  * @return true if the timer is armed, false if the lockout will not lift
+  *
+  * @note Assumes mutex is already locked
+  */
+ static bool
+ arm_lockout(uint32_t user_index)
+ {
+     uint64_t expires = (uint64_t)g_users[user_index].lockout_time + 
+                        USER_DB_LOCK_DURATION_SECS;
+     
+     timer_wheel_cancel(&g_lockouts, &g_lockout_timers[user_index]);
+     
+     if (!timer_wheel_add(&g_lockouts, &g_lockout_timers[user_index], expires))
+     {
+         syslog_write(WARNING, SYSLOG_DEST_NONE, 
+                    "Failed to schedule the end of the lockout for '%s'",
+                    g_users[user_index].username);
+         return false;
+     }
+     
+     return true;
+ }
+ 
+ /**
+  * @brief Cancel every pending lockout timer
+  *
+  * Leaves no timer linked into g_lockouts, which the next user_db_init
+  * resets.
+  *
+  * @note Assumes mutex is already locked
+  */
+ static void
+ cancel_lockouts(void)
+ {
+     for (uint32_t i = 0; i < USER_DB_MAX_USERS; i++)
+     {
+         timer_wheel_cancel(&g_lockouts, &g_lockout_timers[i]);
+     }
+ }
+ 
+ /**
+  * @brief Lockout timer callback: the lock duration has run out
+  *
+  * @param[in] p_timer  Lockout timer of the user (unused)
+  * @param[in] p_arg    Pointer to user entry
+  *
+  * @note Runs from timer_wheel_advance with the mutex locked
+  */
+ static void
+ unlock_account(wheel_timer_t* p_timer, void* p_arg)
+ {
+     user_db_user_t* p_user = (user_db_user_t*)p_arg;
+     
+     (void)p_timer;
+     
+     /* Start counting failed attempts afresh, or one more would relock */
+     p_user->lockout_time = 0;
+     p_user->login_attempts = 0;
+     
+     syslog_write(INFO, SYSLOG_DEST_NONE, "Account '%s' unlocked", p_user->username);
+ }
+ 
+ /**
+  * @brief Build the username filter from the active users
+  *
+  * @note Leaves the filter NULL if it cannot be built; lookups then scan
+  * @note Assumes mutex is already locked
+  */
+ static void
+ build_username_filter(void)
+ {
+     cuckoo_filter_destroy(&g_p_username_filter);
+     g_p_username_filter = cuckoo_filter_create(USER_DB_MAX_USERS,
+                                                USER_DB_NAME_FILTER_FPR);
+     
+     for (uint32_t i = 0; (NULL != g_p_username_filter) && (i < g_user_count); i++)
+     {
+         if (g_users[i].b_active &&
+             FILTER_SUCCESS != cuckoo_filter_add(g_p_username_filter,
+                                                 username_hash(g_users[i].username)))
+         {
+             cuckoo_filter_destroy(&g_p_username_filter);
+         }
+     }
+ }
+ 
+ /**
+  * @brief Intern the usernames of all users
+  *
+  * @note Leaves the pool NULL if it cannot be built; lookups then use strcmp
+  * @note Assumes mutex is already locked
+  */
+ static void
+ build_username_pool(void)
+ {
+     intern_destroy(&g_p_username_pool);
+     g_p_username_pool = intern_create(USER_DB_MAX_USERS);
+     
+     for (uint32_t i = 0; (NULL != g_p_username_pool) && (i < g_user_count); i++)
+     {
+         intern_username(i);
+     }
+ }
+ 
+ /**
+  * @brief Point a user slot at the interned copy of its username
+  *
+  * @param[in] user_index  Index of the user in the array
+  *
+  * @note On failure the pool is dropped and lookups fall back to strcmp
+  * @note Assumes mutex is already locked
+  */
+ static void
+ intern_username(uint32_t user_index)
+ {
+     if (NULL == g_p_username_pool)
+     {
+         return;
+     }
+     
+     g_p_usernames[user_index] = intern_string(g_p_username_pool,
+                                               g_users[user_index].username);
+     
+     if (NULL == g_p_usernames[user_index])
+     {
+         intern_destroy(&g_p_username_pool);
+     }
+ }
+ 
+ /**
+  * @brief Publish the listing of all users
+  *
+  * @note Leaves the listing empty if it cannot be built; user_db_list()
+  *       then copies under the mutex
+  * @note Assumes mutex is already locked
+  */
+ static void
+ build_user_list(void)
+ {
+     pvec_t* p_list = pvec_create(user_list_entry_retain, user_list_entry_release);
+     
+     for (uint32_t i = 0; (NULL != p_list) && (i < g_user_count); i++)
+     {
+         pvec_t* p_next = user_list_with(p_list, i);
+         
+         pvec_release(p_list);
+         p_list = p_next;
+     }
+     
+     persist_cell_store(&g_user_list, p_list);
+ }
+ 
+ /**
+  * @brief Publish a new listing with one user slot brought up to date
+  *
+  * @param[in] user_index  Index of the user in the array
+  *
+  * @note On failure the listing is emptied and user_db_list() copies under
+  *       the mutex
+  * @note Assumes mutex is already locked
+  */
+ static void
+ publish_user(uint32_t user_index)
+ {
+     pvec_t* p_list = persist_cell_load(&g_user_list);
+     
+     if (NULL == p_list)
+     {
+         return;
+     }
+     
+     pvec_t* p_next = user_list_with(p_list, user_index);
+     
+     pvec_release(p_list);
+     persist_cell_store(&g_user_list, p_next);
+ }
+ 
+ /**
+  * @brief Version of a listing with the entry for one user slot replaced,
+  *        or appended for a new slot
+  *
+  * @param[in] p_list      Listing
+  * @param[in] user_index  Index of the user in the array
+  *
+  * @return New version, or NULL on failure
+  */
+ static pvec_t*
+ user_list_with(const pvec_t* p_list, uint32_t user_index)
+ {
+     user_list_entry_t* p_entry = NULL;
+     
+     /* Inactive users have no entry */
+     if (g_users[user_index].b_active)
      {
-         time_t now = time(NULL);
-         time_t lockout_end = p_user->lockout_time + (USER_DB_LOCK_DURATION_MINS * 60);
+         p_entry = malloc(sizeof(*p_entry));
          
-         if (now < lockout_end)
+         if (NULL == p_entry)
          {
-             return true;
+             return NULL;
          }
+         
+         memset(p_entry, 0, sizeof(*p_entry));
+         p_entry->refs = 1;
+         p_entry->record.id = g_users[user_index].id;
+         strncpy(p_entry->record.username, g_users[user_index].username,
+                 USER_DB_MAX_USERNAME_LEN - 1);
+         p_entry->record.role = g_users[user_index].role;
      }
      
-     return false;
+     pvec_t* p_next = (user_index < pvec_size(p_list))
+                          ? pvec_set(p_list, user_index, p_entry)
+                          : pvec_push(p_list, p_entry);
+     
+     /* The listing holds its own reference */
+     if (NULL != p_entry)
+     {
+         user_list_entry_release(p_entry);
+     }
+     
+     return p_next;
+ }
+ 
+ /**
+  * @brief Take a reference to a listing entry
+  *
+  * @param[in] p_data  Entry
+  */
+ static void
+ user_list_entry_retain(void* p_data)
+ {
+     user_list_entry_t* p_entry = p_data;
+     
+     (void)__atomic_fetch_add(&p_entry->refs, 1, __ATOMIC_RELAXED);
+ }
+ 
+ /**
+  * @brief Drop a reference to a listing entry, freeing it with the last one
+  *
+  * @param[in] p_data  Entry
+  */
+ static void
+ user_list_entry_release(void* p_data)
+ {
+     user_list_entry_t* p_entry = p_data;
+     
+     if (0 == __atomic_sub_fetch(&p_entry->refs, 1, __ATOMIC_ACQ_REL))
+     {
+         free(p_entry);
+     }
+ }
+ 
+ /**
+  * @brief Hash of a username for the username filter
+  *
+  * @param[in] p_username  Username
+  *
+  * @return Hash
+  */
+ static uint64_t
+ username_hash(const char* p_username)
+ {
+     return filter_hash(p_username, strlen(p_username));
  }
  
  /**
@@ -786,10 +1189,32 @@
          return 0;
      }
      
+     /* A name the filter has never seen cannot match */
+     if (NULL != g_p_username_filter &&
+         !cuckoo_filter_may_contain(g_p_username_filter, username_hash(p_username)))
+     {
+         return 0;
+     }
+     
+     /* A name that was never interned is no user's; one that was is
+        matched by its canonical pointer */
+     const char* p_interned = NULL;
+     
+     if (NULL != g_p_username_pool)
+     {
+         p_interned = intern_find(g_p_username_pool, p_username, strlen(p_username));
+         
+         if (NULL == p_interned)
+         {
+             return 0;
+         }
+     }
+     
      for (uint32_t i = 0; i < g_user_count; i++)
      {
          if (g_users[i].b_active && 
-             strcmp(g_users[i].username, p_username) == 0)
+             ((NULL != p_interned) ? (g_p_usernames[i] == p_interned)
+                                   : (strcmp(g_users[i].username, p_username) == 0)))
          {
              return i + 1;  /* Return index+1 (0 means not found) */
          }
@@ -201,6 +201,17 @@
   */
  user_db_status_t user_db_save(void);
  
+ /**
+  * @brief Lift account lockouts whose lock duration has run out
+  *
+  * Lockouts are kept in a timer wheel, so only the ones that are due are
+  * visited. Authentication also lifts them, so calling this is only needed
+  * to persist unlocks promptly.
+  *
+  * @return Status code indicating success or error
+  */
+ user_db_status_t user_db_expire_lockouts(void);
+ 
  #endif /* USER_DB_H */
  
  /*** end of file ***/
\ No newline at end of file
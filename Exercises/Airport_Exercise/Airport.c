@@ -1,133 +1,199 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <regex.h>
-#include "../Hash_Table/hash_table.h"
-#include "../Linked_List/linked_list.h"
+#include "../../C/1 - Basic_Data_Structures/5 - Hash_Table/hash_table.h"
+#include "../../C/1 - Basic_Data_Structures/2 - Linked List/linked_list.h"
+#include "edge_parser.h"
 
 #define STARTING_SIZE (256)
-#define FILE_ERROR (0)
-#define LINE_SIZE (20)
+#define LOAD_FACTOR (0.75f)
+#define AIRPORT_FILE "airports.txt"
 #define ACK_LEN (3)
-#define DST_IDX (7)
 
 typedef struct airport
 {
     char * name;
-    llist_node_t * connection;
+    linked_list_t connection;
 } airport_t;
 
-uint64_t simple_hash(const char *str, size_t size);
+uint32_t simple_hash(const void *p_key, uint32_t capacity);
+bool airport_code_equals(const void *p_key1, const void *p_key2);
+void *airport_code_copy(const void *p_key);
 airport_t * airport_create (const char *p_name);
+airport_t * airport_find_or_add (hash_table_t *p_htable, const char *p_code);
+void airport_destroy (airport_t *p_airport);
+void print_airports (const hash_table_t *p_htable);
 
 int main(void)
 {
-    FILE * fptr = fopen("airports.txt", "r");
-    if (NULL == fptr)
-    {
-        perror("Error opening file");
-        return FILE_ERROR; 
-    }
-    
-    hash_table_t * airport_htable = create_hash_table(STARTING_SIZE, simple_hash);
-    
-    if (airport_htable == NULL)
+    hash_table_t airport_htable;
+
+    if (!hash_table_init(&airport_htable, STARTING_SIZE, LOAD_FACTOR, simple_hash,
+                         airport_code_equals, airport_code_copy, free))
     {
         fprintf(stderr, "Failed to create hash table\n");
-        fclose(fptr);
         return 1;
     }
 
-    regex_t regex  = { 0 };
-    int b_is_regex = regcomp(&regex, "^[A-Z]{3} -- [A-Z]{3}$", REG_EXTENDED);
-    if (0 != b_is_regex)
+    edge_format_t format = edge_format_airport();
+    edge_list_t   edges  = { 0 };
+    int result = edge_parse_file(AIRPORT_FILE, &format, 0, &edges);
+    if (EDGE_PARSER_SUCCESS != result)
     {
-        fprintf(stderr, "[ERR]: Could not compile regex\n");
-        fclose(fptr);
-        hash_table_destroy(airport_htable);
+        fprintf(stderr, "[ERR]: Could not parse %s (%d)\n", AIRPORT_FILE, result);
+        hash_table_destroy(&airport_htable, false);
         return 1;
     }
 
-    char buffer[LINE_SIZE];
-    while (fgets(buffer, sizeof(buffer), fptr)) 
+    for (size_t idx = 0; idx < edges.error_count; idx++)
     {
-        size_t len = strlen(buffer);
-        if (len > 0 && '\n' == buffer[len - 1])
-        {
-            buffer[len - 1] = '\0';
-        }
-        
-        b_is_regex = regexec(&regex, buffer, 0, NULL, 0);
-        if (REG_NOMATCH == b_is_regex)
-        {
-            fprintf(stderr, "[ERR]: Invalid Line: %s\n", buffer);
-            continue;
-        }
-        
+        const edge_error_t *p_error = &edges.p_errors[idx];
+        fprintf(stderr, "[ERR]: Invalid Line %llu (offset %llu): %.*s\n",
+                (unsigned long long)p_error->line,
+                (unsigned long long)p_error->offset,
+                (int)p_error->length,
+                edges.p_data + p_error->offset);
+    }
+
+    for (size_t idx = 0; idx < edges.edge_count; idx++)
+    {
+        const edge_t *p_edge = &edges.p_edges[idx];
+
         char src_code[ACK_LEN + 1];
         char dst_code[ACK_LEN + 1];
-        strncpy(src_code, buffer, ACK_LEN);
+        memcpy(src_code, p_edge->p_src, ACK_LEN);
         src_code[ACK_LEN] = '\0';
-        strncpy(dst_code, buffer + DST_IDX, ACK_LEN);
+        memcpy(dst_code, p_edge->p_dst, ACK_LEN);
         dst_code[ACK_LEN] = '\0';
 
-        airport_t *p_src = hash_table_lookup(airport_htable, src_code);
-        if (NULL == p_src)
+        airport_t *p_src = airport_find_or_add(&airport_htable, src_code);
+        airport_t *p_dst = airport_find_or_add(&airport_htable, dst_code);
+        if ((NULL == p_src) || (NULL == p_dst))
         {
-            p_src = airport_create(src_code);
-            if (NULL == p_src)
-            {
-                fprintf(stderr, "[ERR]: Creating Airport: %s\n", src_code);
-                continue;
-            }
-            hash_table_insert(airport_htable, src_code, p_src);
+            continue;
         }
 
-        airport_t *p_dst = hash_table_lookup(airport_htable, dst_code);
-        if (NULL == p_dst)
+        if (!linked_list_append(&p_src->connection, p_dst) ||
+            !linked_list_append(&p_dst->connection, p_src))
         {
-            p_dst = airport_create(dst_code);
-            if (NULL == p_dst)
-            {
-                fprintf(stderr, "[ERR]: Creating Airport: %s\n", dst_code);
-                continue;
-            }
-            hash_table_insert(airport_htable, dst_code, p_dst);
+            fprintf(stderr, "[ERR]: Connecting %s and %s\n", src_code, dst_code);
         }
+    }
 
-        llist_insert_back(p_src->connection, p_dst);
-        llist_insert_back(p_dst->connection, p_src);
+    print_airports(&airport_htable);
+
+    hash_table_iter_t iter = { 0 };
+    void *p_key;
+    void *p_value;
+    while (hash_table_next(&airport_htable, &iter, &p_key, &p_value))
+    {
+        airport_destroy(p_value);
     }
 
-    print_hash_table(airport_htable);
-    destroy_hash_table(airport_htable);
-    regfree(&regex);
-    fclose(fptr);
+    hash_table_destroy(&airport_htable, false);
+    edge_list_destroy(&edges);
     return 0;
 }
 
+uint32_t
+simple_hash(const void *p_key, uint32_t capacity)
+{
+    const unsigned char *p_str = p_key;
+    uint32_t hash = 5381;
+
+    while ('\0' != *p_str)
+    {
+        hash = (hash * 33) ^ *p_str++;
+    }
+
+    return hash % capacity;
+}
+
+bool
+airport_code_equals(const void *p_key1, const void *p_key2)
+{
+    return 0 == strcmp(p_key1, p_key2);
+}
+
+void *
+airport_code_copy(const void *p_key)
+{
+    return strdup(p_key);
+}
+
 airport_t *
 airport_create (const char *p_name)
 {
     airport_t *p_airport = NULL;
-    llist_node_t   *p_llist   = NULL;
 
     if (NULL != p_name)
     {
         char *p_air_name = strdup(p_name);
         p_airport        = calloc(1, sizeof(*p_airport));
-        p_llist          = create_list();
 
-        if ((NULL == p_airport) || (NULL == p_llist) || (NULL == p_air_name))
+        if ((NULL == p_airport) || (NULL == p_air_name) ||
+            !linked_list_init(&p_airport->connection))
         {
+           free(p_air_name);
+           free(p_airport);
            return NULL;
         }
-        else
+
+        p_airport->name = p_air_name;
+    }
+
+    return p_airport;
+}
+
+airport_t *
+airport_find_or_add (hash_table_t *p_htable, const char *p_code)
+{
+    airport_t *p_airport = hash_table_get(p_htable, p_code);
+
+    if (NULL == p_airport)
+    {
+        p_airport = airport_create(p_code);
+        if ((NULL == p_airport) ||
+            ((NULL == hash_table_put(p_htable, p_code, p_airport)) &&
+             (p_airport != hash_table_get(p_htable, p_code))))
         {
-            p_airport->name      = p_air_name;
-            p_airport->connection = p_llist;
+            fprintf(stderr, "[ERR]: Creating Airport: %s\n", p_code);
+            airport_destroy(p_airport);
+            return NULL;
         }
     }
 
     return p_airport;
 }
+
+void
+airport_destroy (airport_t *p_airport)
+{
+    if (NULL != p_airport)
+    {
+        linked_list_destroy(&p_airport->connection, false);
+        free(p_airport->name);
+        free(p_airport);
+    }
+}
+
+void
+print_airports (const hash_table_t *p_htable)
+{
+    hash_table_iter_t iter = { 0 };
+    void *p_key;
+    void *p_value;
+
+    while (hash_table_next(p_htable, &iter, &p_key, &p_value))
+    {
+        const airport_t *p_airport = p_value;
+
+        printf("%s:", p_airport->name);
+        for (const list_node_t *p_node = p_airport->connection.p_head;
+             NULL != p_node; p_node = p_node->p_next)
+        {
+            printf(" %s", ((const airport_t *)p_node->p_data)->name);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,673 @@
+/** @file edge_parser.c
+ *
+ * @brief Implementation of the parallel, memory mapped edge-list parser.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "edge_parser.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define AIRPORT_CODE_LEN     (3)
+#define AIRPORT_DELIMITER    " -- "
+#define MIN_CHUNK_BYTES      (1u << 16) /* Smaller chunks are not worth a thread */
+#define INITIAL_ERROR_CAP    (16)
+
+/*************************************************************************
+ * Private Data Structures
+ *************************************************************************/
+
+/* Work and results for one newline-aligned slice of the input */
+typedef struct
+{
+    const char *          p_data;      /* Start of the whole buffer */
+    size_t                begin;       /* First byte of the slice */
+    size_t                end;         /* One past the last byte of the slice */
+    const edge_format_t * p_format;    /* Line format to accept */
+    edge_t *              p_edges;     /* Edges found in this slice */
+    size_t                edge_count;  /* Entries used in p_edges */
+    edge_error_t *        p_errors;    /* Malformed lines in this slice */
+    size_t                error_count; /* Entries used in p_errors */
+    size_t                error_cap;   /* Entries allocated in p_errors */
+    uint64_t              line_count;  /* Lines started in this slice */
+    int                   status;      /* EDGE_PARSER_* result */
+} parse_chunk_t;
+
+/*************************************************************************
+ * Static Function Prototypes
+ *************************************************************************/
+
+static bool   token_is_valid(const char *       p_token,
+                             size_t             len,
+                             edge_token_class_t token_class);
+static bool   parse_line(const char *          p_line,
+                         size_t                len,
+                         const edge_format_t * p_format,
+                         edge_t *              p_edge);
+static void * parse_chunk(void * p_arg);
+static int    merge_chunks(parse_chunk_t * p_chunks,
+                           uint32_t        num_chunks,
+                           edge_list_t *   p_list);
+
+/*************************************************************************
+ * Public Functions
+ *************************************************************************/
+
+/*!
+ * @brief Returns the "AAA -- BBB" format used by airports.txt.
+ *
+ * @return Format describing two 3-letter upper case codes joined by " -- "
+ */
+edge_format_t
+edge_format_airport(void)
+{
+    edge_format_t format = {
+        .p_delimiter   = AIRPORT_DELIMITER,
+        .delimiter_len = sizeof(AIRPORT_DELIMITER) - 1,
+        .min_token_len = AIRPORT_CODE_LEN,
+        .max_token_len = AIRPORT_CODE_LEN,
+        .token_class   = EDGE_TOKEN_UPPER_ALPHA,
+    };
+
+    return format;
+}
+
+/*!
+ * @brief Parses an in-memory buffer of edges.
+ *
+ * The buffer is cut into one slice per thread. Every cut is moved forward
+ * to the next line start so no line is split between two threads. Each
+ * thread writes into private arrays which are concatenated in slice order
+ * afterwards, which keeps the output in input order.
+ *
+ * @param[in]  p_data      Buffer to parse
+ * @param[in]  data_len    Length of the buffer in bytes
+ * @param[in]  p_format    Line format to accept
+ * @param[in]  num_threads Parser threads (0 selects the online CPU count)
+ * @param[out] p_list      Receives the parsed edges and errors
+ *
+ * @return EDGE_PARSER_SUCCESS on success, negative error code on failure
+ */
+int
+edge_parse_buffer(const char *          p_data,
+                  size_t                data_len,
+                  const edge_format_t * p_format,
+                  uint32_t              num_threads,
+                  edge_list_t *         p_list)
+{
+    if ((NULL == p_list) || (NULL == p_format)
+        || (NULL == p_format->p_delimiter) || (0 == p_format->delimiter_len)
+        || (0 == p_format->min_token_len)
+        || (p_format->min_token_len > p_format->max_token_len)
+        || ((NULL == p_data) && (0 != data_len)))
+    {
+        return EDGE_PARSER_ERROR_PARAM;
+    }
+
+    memset(p_list, 0, sizeof(*p_list));
+    p_list->p_data   = p_data;
+    p_list->data_len = data_len;
+
+    if (0 == data_len)
+    {
+        return EDGE_PARSER_SUCCESS;
+    }
+
+    // Pick a thread count that leaves every thread a worthwhile slice
+    if (0 == num_threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (online > 0) ? (uint32_t)online : 1;
+    }
+
+    if (num_threads > EDGE_PARSER_MAX_THREADS)
+    {
+        num_threads = EDGE_PARSER_MAX_THREADS;
+    }
+
+    size_t max_useful = (data_len / MIN_CHUNK_BYTES) + 1;
+    if (num_threads > max_useful)
+    {
+        num_threads = (uint32_t)max_useful;
+    }
+
+    parse_chunk_t * chunks  = calloc(num_threads, sizeof(parse_chunk_t));
+    pthread_t *     threads = calloc(num_threads, sizeof(pthread_t));
+    if ((NULL == chunks) || (NULL == threads))
+    {
+        free(chunks);
+        free(threads);
+        return EDGE_PARSER_ERROR_MEMORY;
+    }
+
+    // Align every slice boundary to the start of a line
+    size_t begin = 0;
+    for (uint32_t idx = 0; idx < num_threads; idx++)
+    {
+        size_t end = data_len;
+
+        if ((idx + 1) < num_threads)
+        {
+            end = (data_len / num_threads) * (idx + 1);
+
+            if (end <= begin)
+            {
+                end = begin;
+            }
+            else
+            {
+                const char * p_nl
+                    = memchr(p_data + end - 1, '\n', data_len - end + 1);
+                end = (NULL == p_nl) ? data_len : (size_t)(p_nl - p_data) + 1;
+            }
+        }
+
+        chunks[idx].p_data   = p_data;
+        chunks[idx].begin    = begin;
+        chunks[idx].end      = end;
+        chunks[idx].p_format = p_format;
+        begin                = end;
+    }
+
+    // Slice 0 runs on the calling thread
+    uint32_t started = 1;
+    int      result  = EDGE_PARSER_SUCCESS;
+
+    for (uint32_t idx = 1; idx < num_threads; idx++)
+    {
+        if (0 != pthread_create(&threads[idx], NULL, parse_chunk, &chunks[idx]))
+        {
+            result = EDGE_PARSER_ERROR_THREAD;
+            break;
+        }
+        started++;
+    }
+
+    parse_chunk(&chunks[0]);
+
+    for (uint32_t idx = 1; idx < started; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+
+    for (uint32_t idx = 0; idx < started; idx++)
+    {
+        if (EDGE_PARSER_SUCCESS != chunks[idx].status)
+        {
+            result = chunks[idx].status;
+        }
+    }
+
+    if (EDGE_PARSER_SUCCESS == result)
+    {
+        result = merge_chunks(chunks, started, p_list);
+    }
+
+    for (uint32_t idx = 0; idx < num_threads; idx++)
+    {
+        free(chunks[idx].p_edges);
+        free(chunks[idx].p_errors);
+    }
+
+    free(chunks);
+    free(threads);
+
+    if (EDGE_PARSER_SUCCESS != result)
+    {
+        edge_list_destroy(p_list);
+    }
+
+    return result;
+}
+
+/*!
+ * @brief Memory maps a file and parses it as an edge list.
+ *
+ * @param[in]  p_path      Path of the file to parse
+ * @param[in]  p_format    Line format to accept
+ * @param[in]  num_threads Parser threads (0 selects the online CPU count)
+ * @param[out] p_list      Receives the parsed edges, errors and mapping
+ *
+ * @return EDGE_PARSER_SUCCESS on success, negative error code on failure
+ */
+int
+edge_parse_file(const char *          p_path,
+                const edge_format_t * p_format,
+                uint32_t              num_threads,
+                edge_list_t *         p_list)
+{
+    if ((NULL == p_path) || (NULL == p_list))
+    {
+        return EDGE_PARSER_ERROR_PARAM;
+    }
+
+    int fd = open(p_path, O_RDONLY);
+    if (fd < 0)
+    {
+        return EDGE_PARSER_ERROR_IO;
+    }
+
+    struct stat file_stat;
+    if (0 != fstat(fd, &file_stat))
+    {
+        close(fd);
+        return EDGE_PARSER_ERROR_IO;
+    }
+
+    size_t data_len = (size_t)file_stat.st_size;
+    char * p_map    = NULL;
+
+    if (data_len > 0)
+    {
+        p_map = mmap(NULL, data_len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == p_map)
+        {
+            close(fd);
+            return EDGE_PARSER_ERROR_IO;
+        }
+
+        // Every slice is read front to back by a different thread
+        madvise(p_map, data_len, MADV_WILLNEED);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+
+    int result
+        = edge_parse_buffer(p_map, data_len, p_format, num_threads, p_list);
+
+    if (EDGE_PARSER_SUCCESS != result)
+    {
+        if (NULL != p_map)
+        {
+            munmap(p_map, data_len);
+        }
+        return result;
+    }
+
+    p_list->b_mapped = (NULL != p_map);
+    return EDGE_PARSER_SUCCESS;
+}
+
+/*!
+ * @brief Releases the arrays and mapping owned by an edge list.
+ *
+ * @param[in,out] p_list List to destroy; reset to all zeroes
+ */
+void
+edge_list_destroy(edge_list_t * p_list)
+{
+    if (NULL == p_list)
+    {
+        return;
+    }
+
+    free(p_list->p_edges);
+    free(p_list->p_errors);
+
+    if (p_list->b_mapped)
+    {
+        munmap((void *)p_list->p_data, p_list->data_len);
+    }
+
+    memset(p_list, 0, sizeof(*p_list));
+}
+
+/*************************************************************************
+ * Private Functions
+ *************************************************************************/
+
+/*!
+ * @brief Checks that every character of a token belongs to a token class.
+ *
+ * @param[in] p_token     First character of the token
+ * @param[in] len         Token length
+ * @param[in] token_class Accepted characters
+ *
+ * @return true if every character is accepted, false otherwise
+ */
+static bool
+token_is_valid(const char * p_token, size_t len, edge_token_class_t token_class)
+{
+    const unsigned char * p_char = (const unsigned char *)p_token;
+
+    switch (token_class)
+    {
+        case EDGE_TOKEN_UPPER_ALPHA:
+            for (size_t idx = 0; idx < len; idx++)
+            {
+                if ((unsigned)(p_char[idx] - 'A') >= 26u)
+                {
+                    return false;
+                }
+            }
+            break;
+
+        case EDGE_TOKEN_ALNUM:
+            for (size_t idx = 0; idx < len; idx++)
+            {
+                unsigned char ch = p_char[idx];
+                if (((unsigned)((ch | 0x20u) - 'a') >= 26u)
+                    && ((unsigned)(ch - '0') >= 10u) && ('_' != ch))
+                {
+                    return false;
+                }
+            }
+            break;
+
+        case EDGE_TOKEN_PRINTABLE:
+            for (size_t idx = 0; idx < len; idx++)
+            {
+                if ((unsigned)(p_char[idx] - 0x21u) >= (0x7Fu - 0x21u))
+                {
+                    return false;
+                }
+            }
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief Splits one line into an edge and validates both tokens.
+ *
+ * Fixed width formats such as airports.txt are checked at fixed positions
+ * without searching for the delimiter.
+ *
+ * @param[in]  p_line   First character of the line
+ * @param[in]  len      Line length without terminator
+ * @param[in]  p_format Line format to accept
+ * @param[out] p_edge   Receives the tokens on success
+ *
+ * @return true if the line matches the format, false otherwise
+ */
+static bool
+parse_line(const char *          p_line,
+           size_t                len,
+           const edge_format_t * p_format,
+           edge_t *              p_edge)
+{
+    const char * p_delim   = p_format->p_delimiter;
+    size_t       delim_len = p_format->delimiter_len;
+    size_t       src_len   = 0;
+
+    if (p_format->min_token_len == p_format->max_token_len)
+    {
+        src_len = p_format->min_token_len;
+
+        if ((len != ((2 * src_len) + delim_len))
+            || (0 != memcmp(p_line + src_len, p_delim, delim_len)))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // Locate the first occurrence of the delimiter
+        const char * p_found = NULL;
+        const char * p_scan  = p_line;
+        const char * p_last  = p_line + len;
+
+        while ((size_t)(p_last - p_scan) >= delim_len)
+        {
+            p_scan = memchr(p_scan, p_delim[0], (size_t)(p_last - p_scan));
+            if ((NULL == p_scan) || ((size_t)(p_last - p_scan) < delim_len))
+            {
+                break;
+            }
+            if (0 == memcmp(p_scan, p_delim, delim_len))
+            {
+                p_found = p_scan;
+                break;
+            }
+            p_scan++;
+        }
+
+        if (NULL == p_found)
+        {
+            return false;
+        }
+
+        src_len = (size_t)(p_found - p_line);
+    }
+
+    size_t dst_len = len - src_len - delim_len;
+
+    if ((src_len < p_format->min_token_len)
+        || (src_len > p_format->max_token_len)
+        || (dst_len < p_format->min_token_len)
+        || (dst_len > p_format->max_token_len))
+    {
+        return false;
+    }
+
+    const char * p_dst = p_line + src_len + delim_len;
+
+    if (!token_is_valid(p_line, src_len, p_format->token_class)
+        || !token_is_valid(p_dst, dst_len, p_format->token_class))
+    {
+        return false;
+    }
+
+    p_edge->p_src   = p_line;
+    p_edge->p_dst   = p_dst;
+    p_edge->src_len = (uint32_t)src_len;
+    p_edge->dst_len = (uint32_t)dst_len;
+
+    return true;
+}
+
+/*!
+ * @brief Thread body: parses every line of one slice.
+ *
+ * Line numbers in p_errors are slice-relative (0-based) until the slices
+ * are merged.
+ *
+ * @param[in,out] p_arg Pointer to the parse_chunk_t to process
+ *
+ * @return NULL in all cases
+ */
+static void *
+parse_chunk(void * p_arg)
+{
+    parse_chunk_t *       p_chunk  = (parse_chunk_t *)p_arg;
+    const edge_format_t * p_format = p_chunk->p_format;
+    const char *          p_data   = p_chunk->p_data;
+    size_t                pos      = p_chunk->begin;
+    size_t                end      = p_chunk->end;
+
+    p_chunk->status = EDGE_PARSER_SUCCESS;
+
+    if (pos >= end)
+    {
+        return NULL;
+    }
+
+    // A valid edge line is never shorter than this, so the cap is exact
+    size_t min_line
+        = (2 * (size_t)p_format->min_token_len) + p_format->delimiter_len + 1;
+    size_t edge_cap = ((end - pos) / min_line) + 1;
+
+    p_chunk->p_edges = malloc(edge_cap * sizeof(edge_t));
+    if (NULL == p_chunk->p_edges)
+    {
+        p_chunk->status = EDGE_PARSER_ERROR_MEMORY;
+        return NULL;
+    }
+
+    // Fixed width lines are usually parsed without scanning for '\n'
+    size_t fixed_len = 0;
+    if (p_format->min_token_len == p_format->max_token_len)
+    {
+        fixed_len = min_line - 1;
+    }
+
+    while (pos < end)
+    {
+        const char * p_line = p_data + pos;
+        edge_t *     p_edge = &p_chunk->p_edges[p_chunk->edge_count];
+
+        if ((0 != fixed_len) && ((end - pos) > fixed_len)
+            && ('\n' == p_line[fixed_len])
+            && parse_line(p_line, fixed_len, p_format, p_edge))
+        {
+            p_chunk->edge_count++;
+            p_chunk->line_count++;
+            pos += fixed_len + 1;
+            continue;
+        }
+
+        const char * p_nl = memchr(p_line, '\n', end - pos);
+        size_t len  = (NULL == p_nl) ? (end - pos) : (size_t)(p_nl - p_line);
+        size_t next = pos + len + 1;
+
+        if ((len > 0) && ('\r' == p_line[len - 1]))
+        {
+            len--;
+        }
+
+        if (len > 0)
+        {
+            if (parse_line(p_line, len, p_format, p_edge))
+            {
+                p_chunk->edge_count++;
+            }
+            else
+            {
+                if (p_chunk->error_count == p_chunk->error_cap)
+                {
+                    size_t new_cap = (0 == p_chunk->error_cap)
+                                       ? INITIAL_ERROR_CAP
+                                       : (2 * p_chunk->error_cap);
+                    edge_error_t * p_new = realloc(
+                        p_chunk->p_errors, new_cap * sizeof(edge_error_t));
+                    if (NULL == p_new)
+                    {
+                        p_chunk->status = EDGE_PARSER_ERROR_MEMORY;
+                        return NULL;
+                    }
+                    p_chunk->p_errors  = p_new;
+                    p_chunk->error_cap = new_cap;
+                }
+
+                edge_error_t * p_error
+                    = &p_chunk->p_errors[p_chunk->error_count++];
+                p_error->offset = pos;
+                p_error->line   = p_chunk->line_count;
+                p_error->length = (uint32_t)len;
+            }
+        }
+
+        p_chunk->line_count++;
+        pos = next;
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief Concatenates per-slice results into the output list.
+ *
+ * Also converts slice-relative error line numbers into 1-based file line
+ * numbers.
+ *
+ * @param[in]  p_chunks   Parsed slices, in input order
+ * @param[in]  num_chunks Number of slices
+ * @param[out] p_list     Receives the merged arrays
+ *
+ * @return EDGE_PARSER_SUCCESS on success, negative error code on failure
+ */
+static int
+merge_chunks(parse_chunk_t * p_chunks, uint32_t num_chunks, edge_list_t * p_list)
+{
+    size_t total_edges  = 0;
+    size_t total_errors = 0;
+
+    for (uint32_t idx = 0; idx < num_chunks; idx++)
+    {
+        total_edges += p_chunks[idx].edge_count;
+        total_errors += p_chunks[idx].error_count;
+    }
+
+    // A single slice already holds the final arrays
+    if (1 == num_chunks)
+    {
+        p_list->p_edges     = p_chunks[0].p_edges;
+        p_list->edge_count  = p_chunks[0].edge_count;
+        p_list->p_errors    = p_chunks[0].p_errors;
+        p_list->error_count = p_chunks[0].error_count;
+        p_list->line_count  = p_chunks[0].line_count;
+        p_chunks[0].p_edges  = NULL;
+        p_chunks[0].p_errors = NULL;
+
+        for (size_t err = 0; err < p_list->error_count; err++)
+        {
+            p_list->p_errors[err].line++;
+        }
+
+        return EDGE_PARSER_SUCCESS;
+    }
+
+    if (total_edges > 0)
+    {
+        p_list->p_edges = malloc(total_edges * sizeof(edge_t));
+        if (NULL == p_list->p_edges)
+        {
+            return EDGE_PARSER_ERROR_MEMORY;
+        }
+    }
+
+    if (total_errors > 0)
+    {
+        p_list->p_errors = malloc(total_errors * sizeof(edge_error_t));
+        if (NULL == p_list->p_errors)
+        {
+            return EDGE_PARSER_ERROR_MEMORY;
+        }
+    }
+
+    uint64_t first_line = 1;
+
+    for (uint32_t idx = 0; idx < num_chunks; idx++)
+    {
+        parse_chunk_t * p_chunk = &p_chunks[idx];
+
+        if (p_chunk->edge_count > 0)
+        {
+            memcpy(&p_list->p_edges[p_list->edge_count],
+                   p_chunk->p_edges,
+                   p_chunk->edge_count * sizeof(edge_t));
+            p_list->edge_count += p_chunk->edge_count;
+        }
+
+        for (size_t err = 0; err < p_chunk->error_count; err++)
+        {
+            edge_error_t * p_error = &p_list->p_errors[p_list->error_count++];
+            *p_error               = p_chunk->p_errors[err];
+            p_error->line += first_line;
+        }
+
+        first_line += p_chunk->line_count;
+    }
+
+    p_list->line_count = first_line - 1;
+
+    return EDGE_PARSER_SUCCESS;
+}
+
+/*** end of file ***/
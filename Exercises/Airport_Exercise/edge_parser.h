@@ -0,0 +1,146 @@
+/** @file edge_parser.h
+ *
+ * @brief Parallel parser for delimited edge-list files such as airports.txt.
+ *
+ * The input is memory mapped and split into chunks at newline boundaries.
+ * Each chunk is parsed by its own thread with a hand-written validator, so
+ * no per-line regex or copy is needed. Parsed edges point straight into the
+ * mapping and malformed lines are reported with their byte offset and line
+ * number.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#ifndef EDGE_PARSER_H
+#define EDGE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define EDGE_PARSER_SUCCESS      (0)
+#define EDGE_PARSER_ERROR_PARAM  (-1)
+#define EDGE_PARSER_ERROR_IO     (-2)
+#define EDGE_PARSER_ERROR_MEMORY (-3)
+#define EDGE_PARSER_ERROR_THREAD (-4)
+
+#define EDGE_PARSER_MAX_THREADS  (64)
+
+/*************************************************************************
+ * Type Definitions
+ *************************************************************************/
+
+/* Characters accepted inside a vertex token */
+typedef enum
+{
+    EDGE_TOKEN_UPPER_ALPHA = 0, /* 'A'..'Z' only, e.g. IATA codes */
+    EDGE_TOKEN_ALNUM,           /* ASCII letters, digits and '_' */
+    EDGE_TOKEN_PRINTABLE        /* Any printable ASCII except space */
+} edge_token_class_t;
+
+/* Description of one "<src><delimiter><dst>" line format */
+typedef struct
+{
+    const char *       p_delimiter;   /* Separator between the two tokens */
+    size_t             delimiter_len; /* Length of p_delimiter */
+    uint32_t           min_token_len; /* Shortest accepted token */
+    uint32_t           max_token_len; /* Longest accepted token */
+    edge_token_class_t token_class;   /* Accepted token characters */
+} edge_format_t;
+
+/* A parsed edge; both tokens point into the parsed buffer, unterminated */
+typedef struct
+{
+    const char * p_src;   /* Source vertex token */
+    const char * p_dst;   /* Destination vertex token */
+    uint32_t     src_len; /* Length of the source token */
+    uint32_t     dst_len; /* Length of the destination token */
+} edge_t;
+
+/* A line that did not match the format */
+typedef struct
+{
+    uint64_t offset; /* Byte offset of the first character of the line */
+    uint64_t line;   /* 1-based line number */
+    uint32_t length; /* Line length excluding the line terminator */
+} edge_error_t;
+
+/* Result of a parse; owns the edge/error arrays and, for files, the mapping */
+typedef struct
+{
+    const char *   p_data;      /* Start of the parsed buffer */
+    size_t         data_len;    /* Length of the parsed buffer */
+    bool           b_mapped;    /* True if p_data is an mmap owned by us */
+    edge_t *       p_edges;     /* Edges in input order */
+    size_t         edge_count;  /* Number of entries in p_edges */
+    edge_error_t * p_errors;    /* Malformed lines in input order */
+    size_t         error_count; /* Number of entries in p_errors */
+    uint64_t       line_count;  /* Total lines seen, including blank ones */
+} edge_list_t;
+
+/*************************************************************************
+ * Function Declarations
+ *************************************************************************/
+
+/*!
+ * @brief Returns the "AAA -- BBB" format used by airports.txt.
+ *
+ * @return Format describing two 3-letter upper case codes joined by " -- "
+ */
+edge_format_t
+edge_format_airport(void);
+
+/*!
+ * @brief Parses an in-memory buffer of edges.
+ *
+ * Lines may end in "\n" or "\r\n"; the final line needs no terminator.
+ * Blank lines are counted but neither parsed nor reported. The buffer must
+ * outlive the list because edges point into it.
+ *
+ * @param[in]  p_data      Buffer to parse
+ * @param[in]  data_len    Length of the buffer in bytes
+ * @param[in]  p_format    Line format to accept
+ * @param[in]  num_threads Parser threads (0 selects the online CPU count)
+ * @param[out] p_list      Receives the parsed edges and errors
+ *
+ * @return EDGE_PARSER_SUCCESS on success, negative error code on failure
+ */
+int
+edge_parse_buffer(const char *          p_data,
+                  size_t                data_len,
+                  const edge_format_t * p_format,
+                  uint32_t              num_threads,
+                  edge_list_t *         p_list);
+
+/*!
+ * @brief Memory maps a file and parses it as an edge list.
+ *
+ * @param[in]  p_path      Path of the file to parse
+ * @param[in]  p_format    Line format to accept
+ * @param[in]  num_threads Parser threads (0 selects the online CPU count)
+ * @param[out] p_list      Receives the parsed edges, errors and mapping
+ *
+ * @return EDGE_PARSER_SUCCESS on success, negative error code on failure
+ */
+int
+edge_parse_file(const char *          p_path,
+                const edge_format_t * p_format,
+                uint32_t              num_threads,
+                edge_list_t *         p_list);
+
+/*!
+ * @brief Releases the arrays and mapping owned by an edge list.
+ *
+ * @param[in,out] p_list List to destroy; reset to all zeroes
+ */
+void
+edge_list_destroy(edge_list_t * p_list);
+
+#endif /* EDGE_PARSER_H */
+
+/*** end of file ***/
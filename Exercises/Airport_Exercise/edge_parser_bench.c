@@ -0,0 +1,201 @@
+/** @file edge_parser_bench.c
+ *
+ * @brief Ingest benchmark: regex-per-line loading versus edge_parser.
+ *
+ * Writes a synthetic "AAA -- BBB" route file (with a small share of
+ * malformed lines), then times the original fgets + regexec loop and the
+ * mmapped parser at several thread counts.
+ *
+ * Usage: edge_parser_bench [lines] [path]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025. All rights reserved.
+ */
+
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "edge_parser.h"
+
+/*************************************************************************
+ * Constants and Macros
+ *************************************************************************/
+
+#define DEFAULT_LINES      (20000000ull)
+#define DEFAULT_PATH       "/tmp/edge_parser_bench.txt"
+#define BAD_LINE_EVERY     (1000u)
+#define LINE_SIZE          (20)
+#define BYTES_PER_MB       (1024.0 * 1024.0)
+
+/*************************************************************************
+ * Static Functions
+ *************************************************************************/
+
+static double
+now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+static int
+write_route_file(const char * p_path, unsigned long long lines)
+{
+    FILE * p_file = fopen(p_path, "w");
+    if (NULL == p_file)
+    {
+        return -1;
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (unsigned long long idx = 0; idx < lines; idx++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        char src[4] = { (char)('A' + (state % 26)),
+                        (char)('A' + ((state >> 8) % 26)),
+                        (char)('A' + ((state >> 16) % 26)), '\0' };
+        char dst[4] = { (char)('A' + ((state >> 24) % 26)),
+                        (char)('A' + ((state >> 32) % 26)),
+                        (char)('A' + ((state >> 40) % 26)), '\0' };
+
+        if (0 == (idx % BAD_LINE_EVERY))
+        {
+            fprintf(p_file, "%s - %s\n", src, dst);
+        }
+        else
+        {
+            fprintf(p_file, "%s -- %s\n", src, dst);
+        }
+    }
+
+    fclose(p_file);
+    return 0;
+}
+
+static size_t
+regex_ingest(const char * p_path, size_t * p_errors)
+{
+    FILE * p_file = fopen(p_path, "r");
+    if (NULL == p_file)
+    {
+        return 0;
+    }
+
+    regex_t regex = { 0 };
+    regcomp(&regex, "^[A-Z]{3} -- [A-Z]{3}$", REG_EXTENDED);
+
+    char   buffer[LINE_SIZE];
+    size_t edges = 0;
+    *p_errors    = 0;
+
+    while (fgets(buffer, sizeof(buffer), p_file))
+    {
+        size_t len = strlen(buffer);
+        if ((len > 0) && ('\n' == buffer[len - 1]))
+        {
+            buffer[len - 1] = '\0';
+        }
+
+        if (REG_NOMATCH == regexec(&regex, buffer, 0, NULL, 0))
+        {
+            (*p_errors)++;
+            continue;
+        }
+        edges++;
+    }
+
+    regfree(&regex);
+    fclose(p_file);
+    return edges;
+}
+
+/*************************************************************************
+ * Main Function
+ *************************************************************************/
+
+int
+main(int argc, char ** argv)
+{
+    unsigned long long lines  = DEFAULT_LINES;
+    const char *       p_path = DEFAULT_PATH;
+
+    if (argc > 1)
+    {
+        lines = strtoull(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        p_path = argv[2];
+    }
+
+    if (0 != write_route_file(p_path, lines))
+    {
+        perror("write_route_file");
+        return EXIT_FAILURE;
+    }
+
+    edge_format_t format = edge_format_airport();
+    edge_list_t   list   = { 0 };
+
+    // Warm the page cache and record the file size
+    if (EDGE_PARSER_SUCCESS != edge_parse_file(p_path, &format, 1, &list))
+    {
+        fprintf(stderr, "edge_parse_file failed\n");
+        return EXIT_FAILURE;
+    }
+    double mb = (double)list.data_len / BYTES_PER_MB;
+    edge_list_destroy(&list);
+
+    printf("%llu lines, %.1f MB\n", lines, mb);
+    printf("%-18s %10s %10s %10s %10s\n",
+           "method", "seconds", "MB/s", "edges", "errors");
+
+    size_t regex_errors = 0;
+    double start        = now_seconds();
+    size_t regex_edges  = regex_ingest(p_path, &regex_errors);
+    double elapsed      = now_seconds() - start;
+    printf("%-18s %10.3f %10.1f %10zu %10zu\n",
+           "regex", elapsed, mb / elapsed, regex_edges, regex_errors);
+
+    long     online      = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t max_threads = (online > 0) ? (uint32_t)online : 1;
+
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        start = now_seconds();
+        if (EDGE_PARSER_SUCCESS
+            != edge_parse_file(p_path, &format, threads, &list))
+        {
+            fprintf(stderr, "edge_parse_file failed\n");
+            return EXIT_FAILURE;
+        }
+        elapsed = now_seconds() - start;
+
+        char label[32];
+        snprintf(label, sizeof(label), "edge_parser x%u", threads);
+        printf("%-18s %10.3f %10.1f %10zu %10zu\n",
+               label, elapsed, mb / elapsed, list.edge_count, list.error_count);
+
+        if ((list.edge_count != regex_edges)
+            || (list.error_count != regex_errors))
+        {
+            fprintf(stderr, "result mismatch against regex baseline\n");
+            edge_list_destroy(&list);
+            return EXIT_FAILURE;
+        }
+        edge_list_destroy(&list);
+    }
+
+    unlink(p_path);
+    return EXIT_SUCCESS;
+}
+
+/*** end of file ***/
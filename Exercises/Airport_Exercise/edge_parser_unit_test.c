@@ -0,0 +1,392 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "edge_parser.h"
+
+#define LARGE_LINES  (60000u)
+#define MAX_THREADS  (8u)
+
+static char * gp_large     = NULL;
+static size_t g_large_len  = 0;
+
+// "<src>,<dst>" with alphanumeric tokens of 1 to 16 characters
+static edge_format_t
+csv_format(void)
+{
+    edge_format_t format = {
+        .p_delimiter   = ",",
+        .delimiter_len = 1,
+        .min_token_len = 1,
+        .max_token_len = 16,
+        .token_class   = EDGE_TOKEN_ALNUM,
+    };
+
+    return format;
+}
+
+// Builds lines of varying length, so slice cuts land inside lines, with
+// the odd malformed and blank line mixed in
+static void
+large_setup(void)
+{
+    uint64_t state = 88172645463325252ull;
+    size_t   cap   = (size_t)LARGE_LINES * 40;
+
+    gp_large    = malloc(cap);
+    g_large_len = 0;
+    ck_assert_ptr_nonnull(gp_large);
+
+    for (uint32_t line = 0; line < LARGE_LINES; line++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        uint32_t src_len = 1 + (uint32_t)(state % 16);
+        uint32_t dst_len = 1 + (uint32_t)((state >> 8) % 16);
+        uint32_t kind    = (uint32_t)((state >> 16) % 100);
+        char *   p_out   = gp_large + g_large_len;
+
+        if (0 == kind)
+        {
+            p_out[0] = '\n';
+            g_large_len++;
+            continue;
+        }
+
+        memset(p_out, 'a' + (int)(line % 26), src_len);
+        p_out[src_len] = (1 == kind) ? ';' : ',';
+        memset(p_out + src_len + 1, 'Z', dst_len);
+        p_out[src_len + 1 + dst_len] = '\n';
+        g_large_len += src_len + dst_len + 2;
+    }
+}
+
+static void
+large_teardown(void)
+{
+    free(gp_large);
+    gp_large = NULL;
+}
+
+// Returns the 1-based number of the line starting at offset
+static uint64_t
+line_at(const char * p_data, uint64_t offset)
+{
+    uint64_t line = 1;
+
+    for (uint64_t pos = 0; pos < offset; pos++)
+    {
+        line += ('\n' == p_data[pos]) ? 1 : 0;
+    }
+
+    return line;
+}
+
+static void
+assert_same_lists(const edge_list_t * p_expected, const edge_list_t * p_actual)
+{
+    ck_assert_uint_eq(p_actual->edge_count, p_expected->edge_count);
+    ck_assert_uint_eq(p_actual->error_count, p_expected->error_count);
+    ck_assert_uint_eq(p_actual->line_count, p_expected->line_count);
+
+    for (size_t idx = 0; idx < p_expected->edge_count; idx++)
+    {
+        ck_assert_ptr_eq(p_actual->p_edges[idx].p_src,
+                         p_expected->p_edges[idx].p_src);
+        ck_assert_ptr_eq(p_actual->p_edges[idx].p_dst,
+                         p_expected->p_edges[idx].p_dst);
+        ck_assert_uint_eq(p_actual->p_edges[idx].src_len,
+                          p_expected->p_edges[idx].src_len);
+        ck_assert_uint_eq(p_actual->p_edges[idx].dst_len,
+                          p_expected->p_edges[idx].dst_len);
+    }
+
+    for (size_t idx = 0; idx < p_expected->error_count; idx++)
+    {
+        ck_assert_uint_eq(p_actual->p_errors[idx].offset,
+                          p_expected->p_errors[idx].offset);
+        ck_assert_uint_eq(p_actual->p_errors[idx].line,
+                          p_expected->p_errors[idx].line);
+        ck_assert_uint_eq(p_actual->p_errors[idx].length,
+                          p_expected->p_errors[idx].length);
+    }
+}
+
+START_TEST(test_threads_match_single_thread)
+{
+    edge_format_t format = csv_format();
+    edge_list_t   single = { 0 };
+
+    ck_assert_int_eq(edge_parse_buffer(gp_large, g_large_len, &format, 1,
+                                       &single),
+                     EDGE_PARSER_SUCCESS);
+    ck_assert_uint_gt(single.error_count, 0);
+    ck_assert_uint_eq(single.line_count, LARGE_LINES);
+
+    // Error line numbers are file line numbers, not slice line numbers
+    for (size_t idx = 0; idx < single.error_count; idx++)
+    {
+        ck_assert_uint_eq(single.p_errors[idx].line,
+                          line_at(gp_large, single.p_errors[idx].offset));
+    }
+
+    for (uint32_t threads = 2; threads <= MAX_THREADS; threads++)
+    {
+        edge_list_t multi = { 0 };
+
+        ck_assert_int_eq(edge_parse_buffer(gp_large, g_large_len, &format,
+                                           threads, &multi),
+                         EDGE_PARSER_SUCCESS);
+        assert_same_lists(&single, &multi);
+        edge_list_destroy(&multi);
+    }
+
+    edge_list_destroy(&single);
+}
+END_TEST
+
+START_TEST(test_malformed_line_across_slice_cut)
+{
+    edge_format_t format = csv_format();
+    edge_list_t   single = { 0 };
+    edge_list_t   split  = { 0 };
+    size_t        cut    = g_large_len / 2;
+
+    // Make sure the cut two threads use lands inside a line, then break
+    // that line so it must be reported once, at its own start
+    while ((',' == gp_large[cut - 1]) || ('\n' == gp_large[cut - 1])
+           || ('\n' == gp_large[cut]))
+    {
+        cut++;
+    }
+    g_large_len = 2 * cut;
+
+    size_t start = cut;
+    while ('\n' != gp_large[start - 1])
+    {
+        start--;
+    }
+    char * p_comma = memchr(gp_large + start, ',', g_large_len - start);
+    ck_assert_ptr_nonnull(p_comma);
+    *p_comma = ';';
+
+    ck_assert_int_eq(edge_parse_buffer(gp_large, g_large_len, &format, 1,
+                                       &single),
+                     EDGE_PARSER_SUCCESS);
+    ck_assert_int_eq(edge_parse_buffer(gp_large, g_large_len, &format, 2,
+                                       &split),
+                     EDGE_PARSER_SUCCESS);
+    assert_same_lists(&single, &split);
+
+    uint32_t reported = 0;
+    for (size_t idx = 0; idx < split.error_count; idx++)
+    {
+        if (split.p_errors[idx].offset == start)
+        {
+            ck_assert_uint_eq(split.p_errors[idx].line,
+                              line_at(gp_large, start));
+            reported++;
+        }
+        ck_assert_uint_ne(split.p_errors[idx].offset, cut);
+    }
+    ck_assert_uint_eq(reported, 1);
+
+    edge_list_destroy(&single);
+    edge_list_destroy(&split);
+}
+END_TEST
+
+START_TEST(test_malformed_offsets_and_lines)
+{
+    static const char data[] = "ATL -- ORD\n" // 0, line 1
+                               "\n"           // 11, line 2, blank
+                               "atl -- ORD\n" // 12, line 3
+                               "ATL - ORD\n"  // 23, line 4
+                               "ATLX -- ORD\n" // 33, line 5
+                               "JFK -- LAX";  // 45, line 6
+    edge_format_t format = edge_format_airport();
+    edge_list_t   list   = { 0 };
+
+    ck_assert_int_eq(edge_parse_buffer(data, sizeof(data) - 1, &format, 1,
+                                       &list),
+                     EDGE_PARSER_SUCCESS);
+
+    ck_assert_uint_eq(list.line_count, 6);
+    ck_assert_uint_eq(list.edge_count, 2);
+    ck_assert_ptr_eq(list.p_edges[0].p_src, data);
+    ck_assert_ptr_eq(list.p_edges[0].p_dst, data + 7);
+    ck_assert_ptr_eq(list.p_edges[1].p_src, data + 45);
+    ck_assert_ptr_eq(list.p_edges[1].p_dst, data + 52);
+
+    const edge_error_t expected[] = { { 12, 3, 10 }, { 23, 4, 9 },
+                                      { 33, 5, 11 } };
+    ck_assert_uint_eq(list.error_count, 3);
+    for (size_t idx = 0; idx < 3; idx++)
+    {
+        ck_assert_uint_eq(list.p_errors[idx].offset, expected[idx].offset);
+        ck_assert_uint_eq(list.p_errors[idx].line, expected[idx].line);
+        ck_assert_uint_eq(list.p_errors[idx].length, expected[idx].length);
+    }
+
+    edge_list_destroy(&list);
+}
+END_TEST
+
+START_TEST(test_no_trailing_newline)
+{
+    static const char terminated[]   = "ATL -- ORD\nJFK -- LAX\n";
+    static const char unterminated[] = "ATL -- ORD\nJFK -- LAX";
+    edge_format_t     format         = edge_format_airport();
+    edge_list_t       list           = { 0 };
+
+    ck_assert_int_eq(edge_parse_buffer(unterminated, sizeof(unterminated) - 1,
+                                       &format, 1, &list),
+                     EDGE_PARSER_SUCCESS);
+    ck_assert_uint_eq(list.edge_count, 2);
+    ck_assert_uint_eq(list.error_count, 0);
+    ck_assert_uint_eq(list.line_count, 2);
+    ck_assert_ptr_eq(list.p_edges[1].p_dst, unterminated + 18);
+    edge_list_destroy(&list);
+
+    // A final terminator adds no empty line
+    ck_assert_int_eq(edge_parse_buffer(terminated, sizeof(terminated) - 1,
+                                       &format, 1, &list),
+                     EDGE_PARSER_SUCCESS);
+    ck_assert_uint_eq(list.edge_count, 2);
+    ck_assert_uint_eq(list.line_count, 2);
+    edge_list_destroy(&list);
+
+    // A last line cut short is reported, not read past the end
+    ck_assert_int_eq(edge_parse_buffer(unterminated, sizeof(unterminated) - 2,
+                                       &format, 1, &list),
+                     EDGE_PARSER_SUCCESS);
+    ck_assert_uint_eq(list.edge_count, 1);
+    ck_assert_uint_eq(list.error_count, 1);
+    ck_assert_uint_eq(list.p_errors[0].offset, 11);
+    ck_assert_uint_eq(list.p_errors[0].line, 2);
+    ck_assert_uint_eq(list.p_errors[0].length, 9);
+    edge_list_destroy(&list);
+}
+END_TEST
+
+START_TEST(test_crlf)
+{
+    static const char data[] = "ATL -- ORD\r\n"   // 0, line 1
+                               "JFK -- LAX\r\n"   // 12, line 2
+                               "\r\n"             // 24, line 3, blank
+                               "BAD\r\n"          // 26, line 4
+                               "SEA -- BOS";      // 31, line 5
+    edge_format_t format = edge_format_airport();
+    edge_list_t   list   = { 0 };
+
+    ck_assert_int_eq(edge_parse_buffer(data, sizeof(data) - 1, &format, 1,
+                                       &list),
+                     EDGE_PARSER_SUCCESS);
+
+    ck_assert_uint_eq(list.line_count, 5);
+    ck_assert_uint_eq(list.edge_count, 3);
+    ck_assert_uint_eq(list.p_edges[1].dst_len, 3);
+    ck_assert_ptr_eq(list.p_edges[2].p_src, data + 31);
+
+    // The reported length leaves the "\r\n" out
+    ck_assert_uint_eq(list.error_count, 1);
+    ck_assert_uint_eq(list.p_errors[0].offset, 26);
+    ck_assert_uint_eq(list.p_errors[0].line, 4);
+    ck_assert_uint_eq(list.p_errors[0].length, 3);
+
+    edge_list_destroy(&list);
+}
+END_TEST
+
+START_TEST(test_parse_file)
+{
+    char          path[] = "/tmp/edge_parser_testXXXXXX";
+    int           fd     = mkstemp(path);
+    edge_format_t format = csv_format();
+    edge_list_t   buffer = { 0 };
+    edge_list_t   file   = { 0 };
+
+    ck_assert_int_ge(fd, 0);
+    ck_assert_int_eq(write(fd, gp_large, g_large_len), (ssize_t)g_large_len);
+    close(fd);
+
+    ck_assert_int_eq(edge_parse_buffer(gp_large, g_large_len, &format, 1,
+                                       &buffer),
+                     EDGE_PARSER_SUCCESS);
+    ck_assert_int_eq(edge_parse_file(path, &format, 4, &file),
+                     EDGE_PARSER_SUCCESS);
+    unlink(path);
+
+    ck_assert_uint_eq(file.data_len, g_large_len);
+    ck_assert_uint_eq(file.edge_count, buffer.edge_count);
+    ck_assert_uint_eq(file.error_count, buffer.error_count);
+    ck_assert_uint_eq(file.line_count, buffer.line_count);
+    for (size_t idx = 0; idx < buffer.error_count; idx++)
+    {
+        ck_assert_uint_eq(file.p_errors[idx].offset,
+                          buffer.p_errors[idx].offset);
+        ck_assert_uint_eq(file.p_errors[idx].line, buffer.p_errors[idx].line);
+    }
+
+    edge_list_destroy(&buffer);
+    edge_list_destroy(&file);
+
+    ck_assert_int_eq(edge_parse_file("/nonexistent/edges.txt", &format, 1,
+                                     &file),
+                     EDGE_PARSER_ERROR_IO);
+    ck_assert_int_eq(edge_parse_buffer(gp_large, g_large_len, NULL, 1, &file),
+                     EDGE_PARSER_ERROR_PARAM);
+}
+END_TEST
+
+// Define test suite and add test cases
+//
+Suite *
+edge_parser_suite(void)
+{
+    Suite * s;
+    TCase * tc_core;
+    TCase * tc_large;
+
+    s = suite_create("Edge_Parser");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, test_malformed_offsets_and_lines);
+    tcase_add_test(tc_core, test_no_trailing_newline);
+    tcase_add_test(tc_core, test_crlf);
+
+    tc_large = tcase_create("Large");
+
+    tcase_add_checked_fixture(tc_large, large_setup, large_teardown);
+    tcase_add_test(tc_large, test_threads_match_single_thread);
+    tcase_add_test(tc_large, test_malformed_line_across_slice_cut);
+    tcase_add_test(tc_large, test_parse_file);
+
+    suite_add_tcase(s, tc_core);
+    suite_add_tcase(s, tc_large);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int       number_failed;
+    Suite *   s;
+    SRunner * sr;
+
+    s  = edge_parser_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* main() */
+
+/*** end of file ***/
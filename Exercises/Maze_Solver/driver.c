@@ -1,5 +1,4 @@
 #include "maze.h"
-#include "../Priority_Queue/priority_queue.h"
 #include <stdbool.h>
 #include <getopt.h>
 #include <stdio.h>
@@ -80,17 +79,30 @@ main (int argc, char * argv[])
 
     maze_t * maze = read_file_and_create_matrix(filename); 
    
-    if (maze != NULL) 
+    if (maze == NULL) 
     {
+        fprintf(stderr, "Failed to create maze.\n");
+        return EXIT_FAILURE;
+    }
+
+    print_maze(maze);
+
+    // Mark the shortest path from S to G with '*'
+    //
+    int status = EXIT_SUCCESS;
+    if (find_maze_path(maze) != NULL)
+    {
+        printf("\n");
         print_maze(maze);
-        // Use the maze for pathfinding or other operations
-        free_maze(maze);
-    } 
-    else 
+    }
+    else
     {
-        fprintf(stderr, "Failed to create maze.\n");
+        fprintf(stderr, "No path found.\n");
+        status = EXIT_FAILURE;
     }
+
+    free_maze(maze);
     
-    return 0;
+    return status;
 }
 
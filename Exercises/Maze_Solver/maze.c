@@ -2,9 +2,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <float.h>
-#include "../Priority_Queue/priority_queue.h"
 #include "maze.h"
 
+static int32_t compare_open_vertices(const heap_hook_t* a, const heap_hook_t* b);
+
+static void init_vertex(vertex_t* vertex, char symbol, int row, int col)
+{
+    vertex->symbol = symbol;
+    vertex->row = row;
+    vertex->col = col;
+    vertex->parent = NULL;
+    vertex->g_cost = FLT_MAX;
+    vertex->h_cost = 0;
+    vertex->f_cost = FLT_MAX;
+    vertex->visited = false;
+    heap_hook_init(&vertex->open_hook);
+}
 
 bool is_valid_char(char c) {
     return (c == WALL || c == SPACE || c == START || c == END);
@@ -27,6 +40,23 @@ maze_t* read_file_and_create_matrix(const char* filename)
     int current_row = 0;
     int allocated_rows = 10;  // Start with 10 rows, expand as needed
     
+    // First pass finds the widest row, so every row can be padded to it
+    while ((read = getline(&line, &len, file)) != -1) {
+        int valid_cols = 0;
+        for (int i = 0; i < read; i++) {
+            if (is_valid_char(line[i])) 
+            {
+                valid_cols++;
+            }
+        }
+
+        if (valid_cols > max_cols) 
+        {
+            max_cols = valid_cols;
+        }
+    }
+    rewind(file);
+
     vertex_t** matrix = calloc(allocated_rows, sizeof(vertex_t*));
     if (matrix == NULL) 
     {
@@ -37,18 +67,13 @@ maze_t* read_file_and_create_matrix(const char* filename)
 
     while ((read = getline(&line, &len, file)) != -1) {
         int valid_cols = 0;
-        for (int i = 0; i < read - 1; i++) {
+        for (int i = 0; i < read; i++) {
             if (is_valid_char(line[i])) 
             {
                 valid_cols++;
             }
         }
 
-        if (valid_cols > max_cols) 
-        {
-            max_cols = valid_cols;
-        }
-
         if (valid_cols > 0) {  // Only create a row if there are valid characters
             if (current_row >= allocated_rows) 
             {
@@ -69,7 +94,7 @@ maze_t* read_file_and_create_matrix(const char* filename)
                 matrix = new_matrix;
             }
 
-            matrix[current_row] = malloc(valid_cols * sizeof(vertex_t));
+            matrix[current_row] = malloc(max_cols * sizeof(vertex_t));
             
             if (matrix[current_row] == NULL) 
             {
@@ -85,20 +110,19 @@ maze_t* read_file_and_create_matrix(const char* filename)
             }
 
             int col = 0;
-            for (int i = 0; i < read - 1; i++) 
+            for (int i = 0; i < read; i++) 
             {
                 if (is_valid_char(line[i])) 
                 {
-                    matrix[current_row][col].symbol = line[i];
-                    matrix[current_row][col].row = current_row;
-                    matrix[current_row][col].col = col;
-                    matrix[current_row][col].parent = NULL;
-                    matrix[current_row][col].g_cost = FLT_MAX;
-                    matrix[current_row][col].h_cost = 0;
-                    matrix[current_row][col].f_cost = FLT_MAX;
+                    init_vertex(&matrix[current_row][col], line[i], current_row, col);
                     col++;
                 }
             }
+            // Short rows are walled off on the right
+            for (; col < max_cols; col++) 
+            {
+                init_vertex(&matrix[current_row][col], WALL, current_row, col);
+            }
             current_row++;
         }
     }
@@ -192,16 +216,21 @@ maze_t * find_maze_path(maze_t * maze)
     start->f_cost = start->g_cost + start->h_cost;
     start->parent = NULL;
 
-    pqueue_t* priority_queue = pqueue_create((int (*)(const void*, const void*))compare_vertices);
-    pqueue_insert(priority_queue, start->f_cost, start);
+    // The open set links the vertices themselves, so it never allocates
+    iheap_t open_set;
+    iheap_init(&open_set, compare_open_vertices);
+    iheap_insert(&open_set, &start->open_hook);
 
-    while(!pqueue_is_empty(priority_queue))
+    while(!iheap_is_empty(&open_set))
     {
-        vertex_t *current = pqueue_extract(priority_queue);
+        vertex_t *current = CONTAINER_OF(iheap_extract_top(&open_set), vertex_t, open_hook);
         
         if (current->symbol == END) 
         {
-            pqueue_destroy(priority_queue);
+            // Unlink what is left so the hooks are clear for the next search
+            while (iheap_extract_top(&open_set) != NULL)
+            {
+            }
             return reconstruct_path(maze, current);
         }
         
@@ -236,19 +265,19 @@ maze_t * find_maze_path(maze_t * maze)
                 neighbor->h_cost = calculate_heuristic(neighbor, end);
                 neighbor->f_cost = neighbor->g_cost + neighbor->h_cost;
                 
-                if (!pqueue_contains(priority_queue, neighbor)) 
+                if (!iheap_contains(&open_set, &neighbor->open_hook)) 
                 {
-                    pqueue_insert(priority_queue, neighbor->f_cost, neighbor);
+                    iheap_insert(&open_set, &neighbor->open_hook);
                 } 
                 else 
                 {
-                    pqueue_change_priority(priority_queue, neighbor, neighbor->f_cost);
+                    // A lower g_cost only ever lowers f_cost
+                    iheap_decrease_key(&open_set, &neighbor->open_hook);
                 }
             }
         }
     }
 
-    pqueue_destroy(priority_queue);
     return NULL; // No path found
 }
 
@@ -261,6 +290,12 @@ int compare_vertices(const void* a, const void* b)
     return 0;
 }
 
+static int32_t compare_open_vertices(const heap_hook_t* a, const heap_hook_t* b)
+{
+    return compare_vertices(CONTAINER_OF(a, vertex_t, open_hook),
+                            CONTAINER_OF(b, vertex_t, open_hook));
+}
+
 float calculate_heuristic(vertex_t* a, vertex_t* b) 
 {
     // Manhattan distance
@@ -2,13 +2,14 @@
 #define MAZE_H
 
 #include <stdbool.h>
+#include "../../C/1 - Basic_Data_Structures/9 - Intrusive/intrusive.h"
 
 #define WALL ('#')
 #define SPACE (' ')
 #define START ('S')
 #define END ('G')
 
-typedef struct {
+typedef struct vertex_t {
     char symbol;
     int row;
     int col;
@@ -17,6 +18,7 @@ typedef struct {
     float h_cost;
     float f_cost;
     bool visited;
+    heap_hook_t open_hook; // Links the vertex into the open set
 } vertex_t;
 
 typedef struct {
@@ -32,6 +34,7 @@ void free_maze(maze_t* maze);
 int compare_vertices(const void* a, const void* b);
 float calculate_heuristic(vertex_t* a, vertex_t* b);
 maze_t* reconstruct_path(maze_t* maze, vertex_t* end);
+maze_t* find_maze_path(maze_t* maze);
  
 
 #endif // MAZE_H
\ No newline at end of file
@@ -0,0 +1,82 @@
+import json
+import os
+import random
+import sys
+import tempfile
+import time
+
+import traffic_jam
+from td_engine import TdEngine
+
+# Queries/sec of traffic_jam's per-call Python Dijkstra against the C
+# engine, one query at a time and as a parallel batch.
+#
+# Usage: python3 td_bench.py [grid_side] [queries]
+# The city is a grid_side x grid_side street grid in the
+# traffic_routes.json shape; travel times change per period.
+
+PERIODS = {"0500": 1.0, "0800": 2.5, "1200": 1.4, "1700": 2.8, "2400": 0.8}
+
+
+def grid_city(side, seed=1):
+    rng = random.Random(seed)
+    base = {}
+    for row in range(side):
+        for col in range(side):
+            here = f"{row}/{col}"
+            base[here] = {}
+            for d_row, d_col in ((0, 1), (1, 0), (0, -1), (-1, 0)):
+                n_row, n_col = row + d_row, col + d_col
+                if 0 <= n_row < side and 0 <= n_col < side:
+                    base[here][f"{n_row}/{n_col}"] = rng.randint(1, 10)
+
+    return {period: {street: {to: max(1, round(minutes * scale))
+                              for to, minutes in roads.items()}
+                     for street, roads in base.items()}
+            for period, scale in PERIODS.items()}
+
+
+def timed(label, count, fn):
+    start = time.perf_counter()
+    fn()
+    elapsed = time.perf_counter() - start
+    print(f"{label:<24} {count / elapsed:>12.0f} queries/s")
+
+
+def main():
+    side = int(sys.argv[1]) if len(sys.argv) > 1 else 100
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 200
+
+    with tempfile.NamedTemporaryFile('w', suffix='.json',
+                                     delete=False) as handle:
+        json.dump(grid_city(side), handle)
+        path = handle.name
+
+    try:
+        rng = random.Random(7)
+        streets = [f"{row}/{col}" for row in range(side)
+                   for col in range(side)]
+        periods = list(PERIODS)
+        queries = [(rng.choice(streets), rng.choice(streets),
+                    rng.choice(periods)) for _ in range(count)]
+
+        print(f"{side * side} streets, {count} queries")
+        city_map = traffic_jam.load_city_data(path)
+        timed("python dijkstra", count, lambda: [
+            traffic_jam.find_shortest_path(city_map, *query)
+            for query in queries])
+
+        with TdEngine(path) as engine:
+            timed("c engine, single", count, lambda: [
+                engine.find_shortest_path(*query) for query in queries])
+
+            # The batch is cheap enough that it needs more work to time
+            batch = queries * 20
+            timed(f"c engine, batch x{engine.workers}", len(batch),
+                  lambda: engine.travel_times(batch))
+    finally:
+        os.unlink(path)
+
+
+if __name__ == "__main__":
+    main()
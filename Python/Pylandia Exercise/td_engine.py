@@ -0,0 +1,147 @@
+import ctypes
+import math
+import os
+
+# Thin ctypes binding for the C time-dependent route engine in
+# C/3 - Adv_Data_Structures/Graph (build it with `make libtd_graph.so`).
+# Set TD_GRAPH_LIB to use a library somewhere else.
+
+_DEFAULT_LIB = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                            '..', '..', 'C', '3 - Adv_Data_Structures',
+                            'Graph', 'libtd_graph.so')
+
+TD_NO_VERTEX = 0xFFFFFFFF
+TD_INFINITY = 0xFFFFFFFF
+MAX_PATH = 4096
+
+
+class TdQuery(ctypes.Structure):
+    _fields_ = [("source", ctypes.c_uint32),
+                ("target", ctypes.c_uint32),
+                ("depart", ctypes.c_uint32),
+                ("arrival", ctypes.c_uint32)]
+
+
+def period_to_minutes(time_period):
+    # Accepts "HHMM" like traffic_jam.py or a minute of the day
+    if isinstance(time_period, str):
+        return (int(time_period[:2]) * 60 + int(time_period[2:])) % 1440
+    return int(time_period) % 1440
+
+
+def _load_library(lib_path):
+    lib = ctypes.CDLL(lib_path or os.environ.get('TD_GRAPH_LIB', _DEFAULT_LIB))
+    ptr = ctypes.c_void_p
+    u32 = ctypes.c_uint32
+
+    lib.td_graph_load.argtypes = [ctypes.c_char_p]
+    lib.td_graph_load.restype = ptr
+    lib.td_graph_find.argtypes = [ptr, ctypes.c_char_p]
+    lib.td_graph_find.restype = u32
+    lib.td_graph_name.argtypes = [ptr, u32]
+    lib.td_graph_name.restype = ctypes.c_char_p
+    lib.td_graph_destroy.argtypes = [ctypes.POINTER(ptr)]
+    lib.td_graph_destroy.restype = None
+    lib.td_workspace_create.argtypes = [ptr]
+    lib.td_workspace_create.restype = ptr
+    lib.td_workspace_destroy.argtypes = [ctypes.POINTER(ptr)]
+    lib.td_workspace_destroy.restype = None
+    lib.td_earliest_arrival.argtypes = [ptr, ptr, u32, u32, u32,
+                                        ctypes.POINTER(u32)]
+    lib.td_earliest_arrival.restype = ctypes.c_int
+    lib.td_workspace_path.argtypes = [ptr, ctypes.POINTER(u32), u32]
+    lib.td_workspace_path.restype = u32
+    lib.td_batch.argtypes = [ptr, ptr, u32, ctypes.POINTER(TdQuery),
+                             ctypes.c_size_t]
+    lib.td_batch.restype = ctypes.c_int
+    lib.thread_pool_initialize.argtypes = [ctypes.c_int]
+    lib.thread_pool_initialize.restype = ptr
+    lib.thread_pool_shutdown.argtypes = [ptr]
+    lib.thread_pool_shutdown.restype = ctypes.c_int
+    lib.thread_pool_destroy.argtypes = [ptr]
+    lib.thread_pool_destroy.restype = None
+    return lib
+
+
+class TdEngine:
+    def __init__(self, file_path, lib_path=None, workers=None):
+        self.lib = _load_library(lib_path)
+        self.workers = max(1, min(64, workers or os.cpu_count() or 1))
+        self.pool = None
+        self.graph = self.lib.td_graph_load(os.fsencode(file_path))
+        if not self.graph:
+            raise ValueError(f"could not load {file_path}")
+        self.work = self.lib.td_workspace_create(self.graph)
+        if not self.work:
+            self.close()
+            raise MemoryError("could not allocate search workspace")
+        self.path = (ctypes.c_uint32 * MAX_PATH)()
+
+    def vertex(self, street):
+        return self.lib.td_graph_find(self.graph, street.encode())
+
+    def find_shortest_path(self, start_street, end_street, time_period):
+        # Same return shape as traffic_jam.find_shortest_path
+        source = self.vertex(start_street)
+        target = self.vertex(end_street)
+        if TD_NO_VERTEX in (source, target):
+            return None, math.inf
+
+        depart = period_to_minutes(time_period)
+        arrival = ctypes.c_uint32()
+        self.lib.td_earliest_arrival(self.graph, self.work, source, target,
+                                     depart, ctypes.byref(arrival))
+        if arrival.value == TD_INFINITY:
+            return None, math.inf
+
+        length = self.lib.td_workspace_path(self.work, self.path, MAX_PATH)
+        path = [self.lib.td_graph_name(self.graph, self.path[idx]).decode()
+                for idx in range(min(length, MAX_PATH))]
+        return path, arrival.value - depart
+
+    def travel_times(self, queries):
+        # queries: iterable of (start_street, end_street, time_period);
+        # answered in parallel on the C thread pool
+        queries = list(queries)
+        batch = (TdQuery * len(queries))()
+        for idx, (start, end, period) in enumerate(queries):
+            batch[idx].source = self.vertex(start)
+            batch[idx].target = self.vertex(end)
+            batch[idx].depart = period_to_minutes(period)
+
+        if self.pool is None and self.workers > 1:
+            self.pool = self.lib.thread_pool_initialize(self.workers)
+        if self.lib.td_batch(self.graph, self.pool, self.workers, batch,
+                             len(queries)) != 0:
+            raise RuntimeError("batch query failed")
+
+        return [math.inf if query.arrival == TD_INFINITY
+                else query.arrival - query.depart for query in batch]
+
+    def close(self):
+        if self.pool:
+            self.lib.thread_pool_shutdown(self.pool)
+            self.lib.thread_pool_destroy(self.pool)
+            self.pool = None
+        if self.work:
+            work = ctypes.c_void_p(self.work)
+            self.lib.td_workspace_destroy(ctypes.byref(work))
+            self.work = None
+        if self.graph:
+            graph = ctypes.c_void_p(self.graph)
+            self.lib.td_graph_destroy(ctypes.byref(graph))
+            self.graph = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+if __name__ == "__main__":
+    with TdEngine('traffic_routes.json') as engine:
+        path, total_time = engine.find_shortest_path("Snake Loop",
+                                                     "Debug Drive", "0800")
+        print(" -> ".join(path) if path else "No path found")
+        print(f"Total travel time: {total_time} minutes")
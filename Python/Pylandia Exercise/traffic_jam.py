@@ -106,19 +106,20 @@ def load_city_data(file_path):
     return city_map
 
 # Usage
-city_map = load_city_data('traffic_routes.json')
-
-# Example: Find the shortest path between two streets at a specific time
-start_street = "Snake Loop"
-end_street = "Debug Drive"
-time_period = "0800"
-
-path, total_time = find_shortest_path(city_map, start_street, end_street, time_period)
-
-if path:
-    print(f"Shortest path from {start_street} to {end_street} at {time_period}:")
-    print(" -> ".join(path))
-    print(f"Total travel time: {total_time} minutes")
-else:
-    print(f"No path found from {start_street} to {end_street} at {time_period}")
+if __name__ == "__main__":
+    city_map = load_city_data('traffic_routes.json')
+
+    # Example: Find the shortest path between two streets at a specific time
+    start_street = "Snake Loop"
+    end_street = "Debug Drive"
+    time_period = "0800"
+
+    path, total_time = find_shortest_path(city_map, start_street, end_street, time_period)
+
+    if path:
+        print(f"Shortest path from {start_street} to {end_street} at {time_period}:")
+        print(" -> ".join(path))
+        print(f"Total travel time: {total_time} minutes")
+    else:
+        print(f"No path found from {start_street} to {end_street} at {time_period}")
 